@@ -110,6 +110,9 @@ typedef uint32_t VAR_HANDLE;
 /*! negate query results for flags */
 #define QUERY_NEGATE_FLAGS ( 1 << 7 )
 
+/*! name prefix match (uses the server name index) */
+#define QUERY_PREFIX ( 1 << 8 )
+
 /*! Variable flags */
 typedef enum _VarFlags
 {
@@ -141,7 +144,10 @@ typedef enum _VarFlags
     VARFLAG_PASSWORD = 128,
 
     /*! variable has aliases */
-    VARFLAG_ALIAS = 256
+    VARFLAG_ALIAS = 256,
+
+    /*! keep a history of the variable values in the server */
+    VARFLAG_HISTORY = 512
 
 } VarFlags;
 
@@ -184,10 +190,173 @@ typedef enum _NotificationType
     NOTIFY_PRINT = 4,
 
     /*! request for queue notification */
-    NOTIFY_MODIFIED_QUEUE = 5
+    NOTIFY_MODIFIED_QUEUE = 5,
+
+    /*! request for shared change ring notification */
+    NOTIFY_MODIFIED_RING = 6
 
 } NotificationType;
 
+/*! NOTIFY_MODIFIED option: at most one notification is outstanding per
+    subscriber.  Further changes are suppressed until the subscriber
+    reads the variable from the server */
+#define NOTIFY_OPT_COALESCE     ( 1 << 0 )
+
+/*! NOTIFY_MODIFIED option: notifications are sent no more often than
+    the minimum interval.  A suppressed change is sent when the
+    interval expires */
+#define NOTIFY_OPT_RATE_LIMIT   ( 1 << 1 )
+
+/*! NOTIFY_MODIFIED option: numeric changes smaller than the deadband
+    from the last notified value are suppressed */
+#define NOTIFY_OPT_DEADBAND     ( 1 << 2 )
+
+/*! NOTIFY_CALC option: a calculated value is reused for the cache TTL
+    before the calculation handler is asked for a new one */
+#define NOTIFY_OPT_CACHE_TTL    ( 1 << 3 )
+
+/*! NOTIFY_MODIFIED_QUEUE policies applied when the notification queue
+    of the subscriber is full */
+typedef enum _NotifyOverflowPolicy
+{
+    /*! the new change is discarded */
+    NOTIFY_OVERFLOW_DROP_NEWEST = 0,
+
+    /*! the oldest queued change is discarded to make room */
+    NOTIFY_OVERFLOW_DROP_OLDEST = 1,
+
+    /*! the latest value is sent once there is room in the queue */
+    NOTIFY_OVERFLOW_COALESCE = 2,
+
+    /*! the server waits up to the block timeout for room in the queue,
+        and then discards the new change */
+    NOTIFY_OVERFLOW_BLOCK = 3
+
+} NotifyOverflowPolicy;
+
+/*! The VarNotifyOptions object specifies the options of a
+    notification subscription */
+typedef struct _VarNotifyOptions
+{
+    /*! NOTIFY_OPT_xxx option flags */
+    uint32_t flags;
+
+    /*! minimum interval between notifications (NOTIFY_OPT_RATE_LIMIT) */
+    uint32_t minInterval_ms;
+
+    /*! minimum change of a numeric value (NOTIFY_OPT_DEADBAND) */
+    double deadband;
+
+    /*! lifetime of a calculated value (NOTIFY_OPT_CACHE_TTL) */
+    uint32_t cacheTTL_ms;
+
+    /*! queue overflow policy (NOTIFY_MODIFIED_QUEUE) */
+    NotifyOverflowPolicy overflow;
+
+    /*! maximum time to wait for room in the queue (NOTIFY_OVERFLOW_BLOCK) */
+    uint32_t blockTimeout_ms;
+
+} VarNotifyOptions;
+
+/*! Atomic read-modify-write operations performed by the server */
+typedef enum _VarModifyOp
+{
+    /*! add the operand to a number */
+    VAR_MODIFY_ADD = 0,
+
+    /*! subtract the operand from a number */
+    VAR_MODIFY_SUB = 1,
+
+    /*! add one to a number */
+    VAR_MODIFY_INC = 2,
+
+    /*! subtract one from a number */
+    VAR_MODIFY_DEC = 3,
+
+    /*! set the bits of the operand in an integer */
+    VAR_MODIFY_OR = 4,
+
+    /*! clear the bits which are not in the operand from an integer */
+    VAR_MODIFY_AND = 5,
+
+    /*! clear the bits of the operand from an integer */
+    VAR_MODIFY_CLEAR = 6,
+
+    /*! replace a number or string if it holds the expected value */
+    VAR_MODIFY_CAS = 7
+
+} VarModifyOp;
+
+/*! VAR_GetHistory option to calculate the minimum, maximum and mean
+    of the selected samples */
+#define VAR_HISTORY_STATS   ( 1 )
+
+/*! The VarHistoryQuery object selects the samples returned from
+    the history ring of a variable by VAR_GetHistory */
+typedef struct _VarHistoryQuery
+{
+    /*! start of the time window (CLOCK_REALTIME nanoseconds),
+        0=from the oldest sample */
+    uint64_t start;
+
+    /*! end of the time window (CLOCK_REALTIME nanoseconds),
+        0=up to the newest sample */
+    uint64_t end;
+
+    /*! maximum number of samples to return.  The newest samples in
+        the window are returned.  0=all samples in the window */
+    uint32_t last;
+
+    /*! query options, eg VAR_HISTORY_STATS */
+    uint32_t options;
+
+} VarHistoryQuery;
+
+/*! The VarHistorySample object is one sample from the history
+    ring of a variable */
+typedef struct _VarHistorySample
+{
+    /*! time the value was set (CLOCK_REALTIME nanoseconds) */
+    uint64_t timestamp;
+
+    /*! value of the variable */
+    VarData val;
+
+} VarHistorySample;
+
+/*! The VarHistory object describes the samples returned by
+    VAR_GetHistory */
+typedef struct _VarHistory
+{
+    /*! type of the sample values */
+    VarType type;
+
+    /*! number of samples returned */
+    uint32_t count;
+
+    /*! smallest selected sample value (VAR_HISTORY_STATS) */
+    double min;
+
+    /*! largest selected sample value (VAR_HISTORY_STATS) */
+    double max;
+
+    /*! mean of the selected sample values (VAR_HISTORY_STATS) */
+    double mean;
+
+} VarHistory;
+
+/*! The VarMemUsage object reports the server memory used by a variable */
+typedef struct _VarMemUsage
+{
+    /*! handle of the variable */
+    VAR_HANDLE hVar;
+
+    /*! bytes of server memory used by the variable, including its
+        value, notifications and history */
+    uint64_t bytes;
+
+} VarMemUsage;
+
 
 /*! The VarInfo object is used to contain variable information for
     interaction with the variable server */
@@ -232,6 +401,9 @@ typedef struct _VarInfo
     /* number of credentials */
     size_t ncreds;
 
+    /*! permission set of the credentials, resolved by the server */
+    uint64_t groupset;
+
 } VarInfo;
 
 /*! VarQuery object used to search for variables by
@@ -264,6 +436,71 @@ typedef struct _VarQuery
 
     /*! OUT: Variable handle */
     VAR_HANDLE hVar;
+
+    /*! shard being searched */
+    int shard;
+
+    /*! instance ID match of the query, used to continue the search
+        on the next shard */
+    uint32_t shardInstanceID;
 } VarQuery;
 
+/*! alignment of the records in a page of query results */
+#define VARQUERY_RECORD_ALIGN ( 8 )
+
+/*! VarQueryPage is the header of a page of variable query results.
+    It is followed by the page records */
+typedef struct _VarQueryPage
+{
+    /*! IN: query type used when a new query is started */
+    int type;
+
+    /*! OUT: number of records in the page */
+    uint32_t count;
+
+    /*! IN: maximum size of the page, OUT: size of the page.
+        Both include this header */
+    uint32_t size;
+
+    /*! reserved to keep the page records aligned */
+    uint32_t reserved;
+
+} VarQueryPage;
+
+/*! VarQueryRecord is a single variable in a page of query results.
+    The variable name is followed by its format specifier and, for
+    string variables, its value, all NUL terminated */
+typedef struct _VarQueryRecord
+{
+    /*! size of the record including its strings, a multiple of
+        VARQUERY_RECORD_ALIGN */
+    uint32_t size;
+
+    /*! EOK if the value is included in the record, otherwise it must be
+        retrieved individually (eg using VAR_Get or VAR_Print) */
+    int result;
+
+    /*! variable handle */
+    VAR_HANDLE hVar;
+
+    /*! variable instance identifier */
+    uint32_t instanceID;
+
+    /*! variable flags */
+    uint32_t flags;
+
+    /*! offset of the format specifier from the start of the record */
+    uint16_t formatOffset;
+
+    /*! offset of the string value from the start of the record, 0=none */
+    uint16_t valueOffset;
+
+    /*! variable value */
+    VarObject var;
+
+    /*! first byte of the variable name */
+    char name[];
+
+} VarQueryRecord;
+
 #endif
@@ -31,6 +31,7 @@ SOFTWARE.
 
 #include <sys/types.h>
 #include "var.h"
+#include "varserver.h"
 
 /*============================================================================
         Public definitions
@@ -73,4 +74,13 @@ int VARCACHE_Clear( VarCache *pVarCache );
 
 int VARCACHE_Free( VarCache **ppVarCache );
 
+int VARCACHE_EnableValues( VarCache *pVarCache );
+
+int VARCACHE_Refresh( VARSERVER_HANDLE hVarServer, VarCache *pVarCache );
+
+int VARCACHE_GetValue( VARSERVER_HANDLE hVarServer,
+                       VarCache *pVarCache,
+                       VAR_HANDLE hVar,
+                       VarObject *pVarObject );
+
 #endif
@@ -53,6 +53,9 @@ SOFTWARE.
 /*! Signal used to pass a client notification */
 #define SIG_VARCLIENT_NOTIFICATION SIGRTMIN+4
 
+/*! Signal used to wake the server to drain the request ring */
+#define SIG_CLIENT_DOORBELL SIGRTMIN+11
+
 /*! Success response */
 #ifndef EOK
 #define EOK 0
@@ -61,6 +64,42 @@ SOFTWARE.
 /*! Name of the server API endpoint */
 #define SERVER_SHAREDMEM "/varserver"
 
+/*! Name of the shared variable value segment */
+#define SERVER_SHAREDVALUES "/varserver_values"
+
+/*! Name of the shared variable version segment */
+#define SERVER_VARVERSIONS "/varserver_versions"
+
+/*! Name of the shared client request ring */
+#define SERVER_REQUESTRING "/varserver_requests"
+
+/*! Name prefix of the zero-copy blob segments.  The storage reference
+    of the blob is appended, for example /varserver_blob_42 */
+#define SERVER_SHAREDBLOB "/varserver_blob"
+
+/*! identifier of a zero-copy blob segment ("VBLB") */
+#define SHARED_BLOB_MAGIC ( 0x424C4256 )
+
+/*! alignment of the zero-copy blob buffers */
+#define SHARED_BLOB_ALIGN ( 64 )
+
+#ifndef VARSERVER_MAX_SHARDS
+/*! maximum number of variable server instances (shards), including the
+    root server which owns every name not claimed by another shard */
+#define VARSERVER_MAX_SHARDS ( 16 )
+#endif
+
+/*! bit position of the shard index in a variable handle.  Handles
+    issued by the root server have a shard index of 0, so they are
+    unchanged */
+#define VARSERVER_SHARD_SHIFT ( 28 )
+
+/*! mask of the server local part of a variable handle */
+#define VARSERVER_SHARD_HANDLE_MASK ( ( 1U << VARSERVER_SHARD_SHIFT ) - 1 )
+
+/*! query page context which starts the query on the next shard server */
+#define VARSERVER_SHARD_NEXT_QUERY ( -1 )
+
 /*! identifier for the var server */
 #define VARSERVER_ID  ( 0x56415253 )
 
@@ -72,9 +111,118 @@ SOFTWARE.
 #define VARSERVER_MAX_GROUPS 10
 #endif
 
+#ifndef VARSERVER_MAX_SHARED_VALUES
+/*! maximum number of variable values which can be published in the
+    shared variable value segment */
+#define VARSERVER_MAX_SHARED_VALUES ( 4096 )
+#endif
+
+#ifndef VARSERVER_MAX_SHARED_HANDLES
+/*! number of variable handles indexed by the shared variable value segment */
+#define VARSERVER_MAX_SHARED_HANDLES ( 65536 )
+#endif
+
+#ifndef VARSERVER_MAX_VERSIONED_HANDLES
+/*! number of variable handles (and storage references) tracked by the
+    shared variable version segment */
+#define VARSERVER_MAX_VERSIONED_HANDLES ( 65536 )
+#endif
+
+/*! version flag indicating the variable value may not be cached by
+    clients, since it is calculated or modified outside the server */
+#define VARVERSION_UNCACHEABLE ( 0x80000000 )
+
+#ifndef VARSERVER_REQUEST_RING_SIZE
+/*! number of entries in the client request ring.  This must be a power
+    of two, and larger than the maximum number of clients since each
+    client has at most one request in flight */
+#define VARSERVER_REQUEST_RING_SIZE ( 8192 )
+#endif
+
+#ifndef VARSERVER_FAILOVER_POLL_MS
+/*! interval at which a blocked client checks that its server is still
+    running, and at which it looks for a restarted server */
+#define VARSERVER_FAILOVER_POLL_MS ( 10 )
+#endif
+
+#ifndef VARSERVER_FAILOVER_TIMEOUT_MS
+/*! time a client without a request timeout waits for a stopped server
+    to be restarted before failing the request */
+#define VARSERVER_FAILOVER_TIMEOUT_MS ( 5000 )
+#endif
+
+/*! Name of the shared change ring */
+#define SERVER_CHANGERING "/varserver_changes"
+
+#ifndef VARSERVER_CHANGE_RING_SIZE
+/*! size in bytes of the data area of the shared change ring.  This
+    must be a power of two */
+#define VARSERVER_CHANGE_RING_SIZE ( 256 * 1024 )
+#endif
+
+/*! alignment of records in the shared change ring */
+#define VARSERVER_CHANGE_RECORD_ALIGN ( 8 )
+
+/*! Name of the shared request trace ring */
+#define SERVER_TRACERING "/varserver_trace"
+
+/*! Name of the variable which enables the request trace ring */
+#define SERVER_TRACE_ENABLE "/varserver/trace/enable"
+
+#ifndef VARSERVER_TRACE_RING_SIZE
+/*! number of records in the shared request trace ring.  This must be
+    a power of two */
+#define VARSERVER_TRACE_RING_SIZE ( 16384 )
+#endif
+
+/*! maximum number of request type names in the trace ring */
+#define VARSERVER_TRACE_MAX_REQUESTS ( 64 )
+
+/*! maximum length of a request type name in the trace ring */
+#define VARSERVER_TRACE_NAME_LEN ( 32 )
+
+/*! snapshot file identifier ("VSNP") */
+#define SNAPSHOT_MAGIC ( 0x504E5356 )
+
+/*! snapshot file format version */
+#define SNAPSHOT_VERSION ( 1 )
+
+/*! alignment of the snapshot records */
+#define SNAPSHOT_ALIGN ( 8 )
+
+/*! variable definition record */
+#define SNAPSHOT_RECORD_VAR ( 1 )
+
+/*! variable alias record */
+#define SNAPSHOT_RECORD_ALIAS ( 2 )
+
+/*! FNV-1a offset basis */
+#define SNAPSHOT_FNV_OFFSET ( 2166136261U )
+
+/*! FNV-1a prime */
+#define SNAPSHOT_FNV_PRIME ( 16777619U )
+
+#ifndef VARSERVER_MAX_RING_SUBSCRIPTIONS
+/*! maximum number of change ring subscriptions per client */
+#define VARSERVER_MAX_RING_SUBSCRIPTIONS ( 64 )
+#endif
+
 /*! handle to the variable server */
 typedef void * VARSERVER_HANDLE;
 
+/*! the VarTransport enumeration specifies how client requests
+    are delivered to the server */
+typedef enum _varTransport
+{
+    /*! one real-time signal per request */
+    VARSERVER_TRANSPORT_SIGNAL=0,
+
+    /*! shared memory request ring with a doorbell signal which is
+        only sent when the server is idle */
+    VARSERVER_TRANSPORT_RING
+
+} VarTransport;
+
 /*! the VarRequest enumeration specifies the type of requests that can
     be made from the client to the server */
 typedef enum _varRequest
@@ -158,6 +306,63 @@ typedef enum _varRequest
     /*! Set variable flags */
     VARREQUEST_CLEAR_FLAGS,
 
+    /*! Publish a variable value in the shared value segment */
+    VARREQUEST_SHARE_VALUE,
+
+    /*! Get the values of multiple variables */
+    VARREQUEST_GET_MANY,
+
+    /*! Set the values of multiple variables */
+    VARREQUEST_SET_MANY,
+
+    /*! Get a page of variable query results */
+    VARREQUEST_GET_PAGE,
+
+    /*! Subscribe to modifications of all variables matching a query */
+    VARREQUEST_NOTIFY_QUERY,
+
+    /*! Cancel a query subscription */
+    VARREQUEST_NOTIFY_QUERY_CANCEL,
+
+    /*! Write a snapshot of the variable store to a file */
+    VARREQUEST_SNAPSHOT,
+
+    /*! Create multiple variables */
+    VARREQUEST_NEW_MANY,
+
+    /*! Move a blob value into a zero-copy blob segment */
+    VARREQUEST_SHARE_BLOB,
+
+    /*! Publish a value written into a zero-copy blob segment */
+    VARREQUEST_COMMIT_BLOB,
+
+    /*! Remap a working buffer which the client has grown */
+    VARREQUEST_RESIZE_WORKBUF,
+
+    /*! Set the validation policy of a validator */
+    VARREQUEST_VALIDATION_POLICY,
+
+    /*! Get a batch of pending validation requests */
+    VARREQUEST_GET_VALIDATION_BATCH,
+
+    /*! Send a batch of validation responses */
+    VARREQUEST_SEND_VALIDATION_BATCH,
+
+    /*! Atomically read and modify a variable */
+    VARREQUEST_MODIFY,
+
+    /*! Atomically set a group of variables */
+    VARREQUEST_SET_GROUP,
+
+    /*! Get samples from the history ring of a variable */
+    VARREQUEST_GET_HISTORY,
+
+    /*! Resolve the client credentials again after a change of user */
+    VARREQUEST_UPDATE_USER,
+
+    /*! Get the variables using the most server memory */
+    VARREQUEST_GET_LARGEST,
+
     /*! End request type marker */
     VARREQUEST_END_MARKER
 
@@ -170,8 +375,502 @@ typedef struct _serverInfo
     /*! server process identifier */
     pid_t pid;
 
+    /*! name resolution generation.  This changes when the server
+        restarts or a variable alias is moved, and invalidates any
+        name to handle mappings cached by clients */
+    uint64_t generation;
+
+    /*! shard index of the server, 0 for the root server */
+    int shard;
+
+    /*! variable name prefix owned by a shard server, empty for the
+        root server */
+    char prefix[MAX_NAME_LEN+1];
+
+    /*! identifier of the variable store.  A server which resumes the
+        variable store of the previous server from the warm standby
+        arena keeps its identifier, so the variable handles held by
+        the clients remain valid when they reconnect */
+    uint64_t storeID;
+
+    /*! indicates the server keeps a warm standby arena, so its clients
+        wait for a replacement server if it stops */
+    bool standby;
+
 } ServerInfo;
 
+/*! The SharedValue object holds a single primitive variable value
+    published by the server.  It is protected by a sequence counter
+    which is odd while the server is updating the value */
+typedef struct _sharedValue
+{
+    /*! sequence counter */
+    uint32_t seq;
+
+    /*! variable type, VARTYPE_INVALID if the value may not be
+        read directly from shared memory */
+    uint32_t type;
+
+    /*! variable length */
+    uint32_t len;
+
+    /*! storage reference of the variable which owns this value */
+    uint32_t storageRef;
+
+    /*! variable value */
+    VarData val;
+
+} SharedValue;
+
+/*! The SharedValues object is the layout of the read-only
+    shared variable value segment */
+typedef struct _sharedValues
+{
+    /*! number of allocated shared values */
+    uint32_t count;
+
+    /*! map variable handles to shared value slots, 0=not shared */
+    uint16_t index[VARSERVER_MAX_SHARED_HANDLES];
+
+    /*! shared values. Slot 0 is never used */
+    SharedValue values[VARSERVER_MAX_SHARED_VALUES];
+
+} SharedValues;
+
+/*! The VarVersions object is the layout of the read-only shared
+    variable version segment.  The server increments the version of
+    a variable's storage every time its value is changed, so clients
+    can tell if a cached copy of the value is still current */
+typedef struct _varVersions
+{
+    /*! map variable handles to storage references, 0=not versioned */
+    uint32_t index[VARSERVER_MAX_VERSIONED_HANDLES];
+
+    /*! modification counters indexed by storage reference */
+    uint32_t version[VARSERVER_MAX_VERSIONED_HANDLES];
+
+} VarVersions;
+
+/*! The SharedBlob object is the header of a zero-copy blob segment.
+    It is followed by two buffers, each large enough to hold the blob.
+    The low bit of the generation counter selects the buffer holding
+    the current value.  A writer locks the other buffer, fills it in
+    place, and asks the server to commit it, which stores its length
+    and increments the generation counter */
+typedef struct _SharedBlob
+{
+    /*! segment identifier, SHARED_BLOB_MAGIC */
+    uint32_t magic;
+
+    /*! storage reference of the blob variable */
+    uint32_t storageRef;
+
+    /*! size of each buffer */
+    uint32_t capacity;
+
+    /*! offset of each buffer from the start of the segment */
+    uint32_t offset[2];
+
+    /*! length of the value held in each buffer */
+    uint32_t len[2];
+
+    /*! process identifier of the writer holding the other buffer,
+        0 if it is not locked */
+    int32_t writer;
+
+    /*! incremented each time a new value is committed */
+    uint64_t generation;
+
+} SharedBlob;
+
+/*! The VarBlob object is a client mapping of a zero-copy blob segment,
+    created by VAR_OpenBlob */
+typedef struct _VarBlob
+{
+    /*! handle of the blob variable */
+    VAR_HANDLE hVar;
+
+    /*! pointer to the mapped blob segment */
+    SharedBlob *pSharedBlob;
+
+    /*! size of the mapping */
+    size_t size;
+
+} VarBlob;
+
+/*! The VarBatchItem object is one entry in a GET_MANY or SET_MANY
+    request.  The items are packed at the start of the client working
+    buffer, followed by the data for any string or blob values */
+typedef struct _varBatchItem
+{
+    /*! handle of the variable to get or set */
+    VAR_HANDLE hVar;
+
+    /*! result of the get or set operation on this item */
+    int result;
+
+    /*! offset of the string or blob data from the start of the
+        working buffer */
+    uint32_t offset;
+
+    /*! variable value */
+    VarObject var;
+
+} VarBatchItem;
+
+/*! The ValidationPolicy object specifies how the server delivers
+    validation requests to a validator, and what happens to the
+    requests the validator does not answer in time */
+typedef struct _validationPolicy
+{
+    /*! queue the validation requests so they can be fetched and
+        answered in batches, signalling the validator only when its
+        queue becomes non-empty */
+    bool batch;
+
+    /*! time in milliseconds the validator has to answer a validation
+        request, or 0 to wait indefinitely */
+    uint32_t deadline_ms;
+
+    /*! response applied to a validation request when the deadline
+        expires.  EOK accepts the change, any other value rejects it
+        and is returned to the writer */
+    int defaultResponse;
+
+} ValidationPolicy;
+
+/*! The VarValidationItem object is one entry in a GET_VALIDATION_BATCH
+    or SEND_VALIDATION_BATCH request.  The items are packed at the start
+    of the client working buffer, followed by the data for any string
+    or blob values */
+typedef struct _varValidationItem
+{
+    /*! identifier of the validation request */
+    uint32_t id;
+
+    /*! handle, proposed value and response of the validation request.
+        The item result holds the validator's response */
+    VarBatchItem item;
+
+} VarValidationItem;
+
+/*! The VarModify object holds the operands of a MODIFY request at the
+    start of the client working buffer, followed by the data for any
+    string operands.  The VarModifyOp is passed in requestVal, and the
+    previous value of the variable is returned as for a GET request */
+typedef struct _varModify
+{
+    /*! operand, or the new value of a VAR_MODIFY_CAS */
+    VarObject operand;
+
+    /*! expected value of a VAR_MODIFY_CAS */
+    VarObject expected;
+
+    /*! offset of the operand string from the start of the
+        working buffer */
+    uint32_t operandOffset;
+
+    /*! offset of the expected string from the start of the
+        working buffer */
+    uint32_t expectedOffset;
+
+} VarModify;
+
+/*! alignment of the items in a NEW_MANY request */
+#define VARCREATE_ITEM_ALIGN ( 8 )
+
+/*! The VarCreateItem object is one variable definition in a NEW_MANY
+    request.  The items are packed one after another in the client
+    working buffer.  Each variable name is followed by its NUL terminated
+    tag specifier and, for string and blob variables, its initial value */
+typedef struct _varCreateItem
+{
+    /*! size of the item including its strings and value, a multiple of
+        VARCREATE_ITEM_ALIGN */
+    uint32_t size;
+
+    /*! OUT: result of creating this variable */
+    int result;
+
+    /*! OUT: handle of the new variable */
+    VAR_HANDLE hVar;
+
+    /*! variable instance identifier */
+    uint32_t instanceID;
+
+    /*! globally unique identifier for the variable */
+    uint32_t guid;
+
+    /*! variable flags */
+    uint32_t flags;
+
+    /*! offset of the tag specifier from the start of the item */
+    uint32_t tagspecOffset;
+
+    /*! offset of the initial string or blob value from the start of
+        the item, 0=none */
+    uint32_t valueOffset;
+
+    /*! variable type, length and numeric initial value */
+    VarObject var;
+
+    /*! variable permissions */
+    VarPermissions permissions;
+
+    /*! variable format specifier */
+    char formatspec[MAX_FORMATSPEC_LEN];
+
+    /*! first byte of the variable name */
+    char name[];
+
+} VarCreateItem;
+
+/*! The RequestRing object is the layout of the shared client request
+    ring.  Clients reserve an entry by incrementing the tail, and store
+    their process identifier and client identifier in it.  The server
+    consumes entries from the head.  The head and tail are free running
+    counters */
+typedef struct _requestRing
+{
+    /*! non-zero when the server is waiting for a doorbell */
+    uint32_t idle;
+
+    /*! index of the next entry to be consumed by the server */
+    uint32_t head __attribute__((aligned(64)));
+
+    /*! index of the next entry to be reserved by a client */
+    uint32_t tail __attribute__((aligned(64)));
+
+    /*! process identifier (upper 32 bits) and client identifier (lower
+        32 bits) of the queued requests, 0=not yet written */
+    uint64_t entries[VARSERVER_REQUEST_RING_SIZE] __attribute__((aligned(64)));
+
+} RequestRing;
+
+/*! The ChangeRecord object is the header of each record written to the
+    shared change ring.  It is followed by the string or blob data of the
+    variable (if any), and padded to VARSERVER_CHANGE_RECORD_ALIGN */
+typedef struct _changeRecord
+{
+    /*! total size of the record including this header and padding */
+    uint32_t size;
+
+    /*! storage reference of the variable which was changed */
+    uint32_t storageRef;
+
+    /*! handle of the variable which was changed */
+    VAR_HANDLE hVar;
+
+    /*! length of the string or blob data following the header */
+    uint32_t len;
+
+    /*! variable value. The string/blob pointer is not valid
+        in the reader's address space */
+    VarObject obj;
+
+} ChangeRecord;
+
+/*! The ChangeRing object is the layout of the shared change ring.  The
+    server is the only writer, and clients map the ring read-only and keep
+    their own read cursor.  A reader whose cursor is more than
+    VARSERVER_CHANGE_RING_SIZE bytes behind the reserve offset has been
+    overrun */
+typedef struct _changeRing
+{
+    /*! free running byte offset of the next record to be written */
+    uint64_t head __attribute__((aligned(64)));
+
+    /*! free running byte offset of the end of the record being written.
+        This is advanced before the record data is written */
+    uint64_t reserve;
+
+    /*! futex word incremented each time a record is published */
+    uint32_t seq __attribute__((aligned(64)));
+
+    /*! record data */
+    uint8_t data[VARSERVER_CHANGE_RING_SIZE] __attribute__((aligned(64)));
+
+} ChangeRing;
+
+/*! trace record events */
+typedef enum _traceEvent
+{
+    /*! invalid trace event */
+    TRACE_EVENT_INVALID=0,
+
+    /*! a client request was completed */
+    TRACE_EVENT_REQUEST,
+
+    /*! a notification signal was sent to a client */
+    TRACE_EVENT_SIGNAL,
+
+    /*! a notification payload was sent to a client's message queue */
+    TRACE_EVENT_QUEUE
+
+} TraceEvent;
+
+/*! The TraceRecord object is a single entry in the shared request trace
+    ring.  The sequence number is cleared while the server is writing
+    the record, and is set to the record's position in the ring plus one
+    once the record is complete */
+typedef struct _traceRecord
+{
+    /*! sequence number of the record, 0 while the record is written */
+    uint64_t seq;
+
+    /*! time the request was started (CLOCK_MONOTONIC nanoseconds) */
+    uint64_t timestamp;
+
+    /*! duration of the request in nanoseconds (saturated) */
+    uint32_t duration;
+
+    /*! requesting client identifier, or the client notified */
+    int32_t clientid;
+
+    /*! handle of the variable the request referred to */
+    VAR_HANDLE hVar;
+
+    /*! result code of the request */
+    int32_t result;
+
+    /*! TraceEvent identifying the kind of record */
+    uint16_t event;
+
+    /*! VarRequest of a request record, or the signal number sent */
+    uint16_t type;
+
+    /*! reserved for future use */
+    uint32_t reserved;
+
+} TraceRecord;
+
+/*! The TraceRing object is the layout of the shared request trace ring.
+    The server is the only writer, and overwrites the oldest records
+    when the ring is full.  Readers map the ring read-only */
+typedef struct _traceRing
+{
+    /*! free running count of the records written */
+    uint64_t head __attribute__((aligned(64)));
+
+    /*! names of the request types, indexed by VarRequest */
+    char requestNames[VARSERVER_TRACE_MAX_REQUESTS][VARSERVER_TRACE_NAME_LEN];
+
+    /*! trace records */
+    TraceRecord records[VARSERVER_TRACE_RING_SIZE] __attribute__((aligned(64)));
+
+} TraceRing;
+
+/*! snapshot file header */
+typedef struct _SnapshotHeader
+{
+    /*! snapshot file identifier */
+    uint32_t magic;
+
+    /*! snapshot file format version */
+    uint16_t version;
+
+    /*! size of the header */
+    uint16_t headerSize;
+
+    /*! number of records in the snapshot */
+    uint32_t count;
+
+    /*! FNV-1a checksum of the records */
+    uint32_t checksum;
+
+    /*! total length of the records */
+    uint64_t length;
+
+} SnapshotHeader;
+
+/*! fixed part of a snapshot record */
+typedef struct _SnapshotRecord
+{
+    /*! total length of the record including padding */
+    uint32_t length;
+
+    /*! record type: SNAPSHOT_RECORD_VAR or SNAPSHOT_RECORD_ALIAS */
+    uint16_t kind;
+
+    /*! variable type */
+    uint16_t type;
+
+    /*! variable instance identifier */
+    uint32_t instanceID;
+
+    /*! variable globally unique identifier */
+    uint32_t guid;
+
+    /*! variable flags */
+    uint32_t flags;
+
+    /*! variable length */
+    uint32_t len;
+
+    /*! numeric variable value */
+    uint64_t value;
+
+    /*! length of the string or blob data */
+    uint32_t dataLen;
+
+    /*! instance identifier of the alias target */
+    uint32_t targetInstanceID;
+
+    /*! length of the name including the NUL terminator */
+    uint16_t nameLen;
+
+    /*! length of the alias target name including the NUL terminator */
+    uint16_t targetLen;
+
+    /*! length of the tag specification including the NUL terminator */
+    uint16_t tagspecLen;
+
+    /*! number of read permissions */
+    uint8_t nreads;
+
+    /*! number of write permissions */
+    uint8_t nwrites;
+
+    /*! read permissions */
+    uint32_t read[VARSERVER_MAX_UIDS];
+
+    /*! write permissions */
+    uint32_t write[VARSERVER_MAX_UIDS];
+
+    /*! variable format specifier */
+    char formatspec[MAX_FORMATSPEC_LEN];
+
+} SnapshotRecord;
+
+/*! The RingSubscription object maps a change ring storage reference
+    to the variable handle the client subscribed with */
+typedef struct _ringSubscription
+{
+    /*! storage reference of the subscribed variable */
+    uint32_t storageRef;
+
+    /*! variable handle reported to the client */
+    VAR_HANDLE hVar;
+
+} RingSubscription;
+
+#ifndef VARSERVER_NAME_CACHE_DEFAULT_SIZE
+/*! default number of entries in a client name resolution cache */
+#define VARSERVER_NAME_CACHE_DEFAULT_SIZE ( 1024 )
+#endif
+
+/*! The NameCacheEntry object maps a variable name (including any
+    instance identifier prefix) to its variable handle */
+typedef struct _nameCacheEntry
+{
+    /*! handle of the variable, VAR_INVALID if the entry is unused */
+    VAR_HANDLE hVar;
+
+    /*! name of the variable as passed to VAR_FindByName */
+    char name[MAX_NAME_LEN+1];
+
+} NameCacheEntry;
+
 
 /*! The VarClient structure is used as the primary data structure
     for client/server interactions */
@@ -244,12 +943,97 @@ typedef struct _varClient
     /*! pointer to the server information */
     ServerInfo *pServerInfo;
 
+    /*! shard index of the server this client is connected to */
+    int shard;
+
+    /*! channel index of an additional connection opened by the same
+        process, 0 for the primary connection */
+    int channel;
+
+    /*! indicates the server sends SIG_VAR_ASYNC to the client when
+        a request completes */
+    bool asyncCompletion;
+
+    /*! request priority class (VARSERVER_PRIORITY_*) requested by the
+        client, and replaced by the class granted by the server */
+    int priority;
+
+    /*! number of changes which found the notification queue full,
+        maintained by the server */
+    uint64_t queueOverflows;
+
+    /*! process identifier of the server the client is registered with */
+    pid_t serverPID;
+
+    /*! identifier of the variable store of that server */
+    uint64_t storeID;
+
+    /*! server information of the shard servers which were running when
+        the root connection was opened, NULL if the shard is not running */
+    ServerInfo *pShardInfo[VARSERVER_MAX_SHARDS];
+
+    /*! connections to the shard servers, opened when they are first
+        used.  Only the root connection has shard connections */
+    struct _varClient *pShards[VARSERVER_MAX_SHARDS];
+
+    /*! pointer to the client's mapping of the shared value segment */
+    SharedValues *pSharedValues;
+
+    /*! bitmap of variable handles the client may read from
+        the shared value segment */
+    uint8_t *pSharedGrants;
+
+    /*! pointer to the client's mapping of the variable version segment */
+    VarVersions *pVarVersions;
+
+    /*! name to handle resolution cache, NULL if it is not enabled */
+    NameCacheEntry *pNameCache;
+
+    /*! number of entries in the name cache.  This is a power of two */
+    size_t nameCacheSize;
+
+    /*! server generation the name cache entries belong to */
+    uint64_t nameCacheGeneration;
+
+    /*! pointer to the shared request ring, NULL if requests are
+        sent via real-time signals */
+    RequestRing *pRequestRing;
+
+    /*! pointer to the read-only mapping of the shared change ring,
+        NULL if the client has not opened it */
+    ChangeRing *pChangeRing;
+
+    /*! byte offset of the next change ring record to read */
+    uint64_t changeCursor;
+
+    /*! number of active change ring subscriptions */
+    uint32_t numRingSubscriptions;
+
+    /*! change ring subscriptions */
+    RingSubscription ringSubscriptions[VARSERVER_MAX_RING_SUBSCRIPTIONS];
+
     /*! client transaction counter */
     uint64_t transactionCount;
 
+    /*! time the current request was sent (CLOCK_MONOTONIC ns), used by
+        the server to measure the request queueing delay */
+    uint64_t requestTime;
+
     /*! client blocked 0=not blocked non-zero=blocked */
     int blocked;
 
+    /*! non-zero while a request has been sent but not yet accepted
+        by the server */
+    uint32_t pending;
+
+    /*! number of items of the client's SET_MANY request which are
+        waiting for a batched validator */
+    uint32_t pendingValidations;
+
+    /*! largest length the working buffer can grow to.  The client
+        reserves the address space for it so its mapping never moves */
+    size_t workbufmax;
+
     /*! specifies the length of the working buffer */
     size_t workbufsize;
 
@@ -265,6 +1049,16 @@ typedef struct _varClient
 
 VarClient *ValidateHandle( VARSERVER_HANDLE hVarServer );
 
+int ClientSubmit( VarClient *pVarClient, int signal );
+
 int ClientRequest( VarClient *pVarClient, int signal );
 
+int ShardName( char *buf, size_t len, char *name, int shard );
+
+int ClientName( char *buf, size_t len, pid_t pid, int channel, int shard );
+
+int SharedBlobLock( SharedBlob *pSharedBlob, pid_t pid );
+
+void SharedBlobUnlock( SharedBlob *pSharedBlob, pid_t pid );
+
 #endif
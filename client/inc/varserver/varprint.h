@@ -29,6 +29,7 @@ SOFTWARE.
         Includes
 ============================================================================*/
 
+#include <stdint.h>
 #include <sys/types.h>
 
 /*============================================================================
@@ -54,4 +55,12 @@ int VARPRINT_SetupListener( pid_t requestorPID, int *sock, gid_t gid );
 
 int VARPRINT_ShutdownListener( pid_t requestorPID, int sock );
 
+int VARPRINT_OpenChannelListener( gid_t gid );
+
+int VARPRINT_SendToChannel( pid_t responderPID, uint32_t id, int fd );
+
+int VARPRINT_ReceiveFromChannel( pid_t requestorPID, uint32_t id, int *fd );
+
+int VARPRINT_CloseChannels( void );
+
 #endif
@@ -55,6 +55,14 @@ int VARQUERY_Search( VARSERVER_HANDLE hVarServer,
                      uint32_t flags,
                      int fd );
 
+int VARQUERY_Dump( VARSERVER_HANDLE hVarServer,
+                   int searchType,
+                   char *match,
+                   char *tagspec,
+                   uint32_t instanceID,
+                   uint32_t flags,
+                   int fd );
+
 int VARQUERY_Map( VARSERVER_HANDLE hVarServer,
                   VarQuery *pVarQuery,
                   int (*mapfn)( VARSERVER_HANDLE hVarServer,
@@ -42,11 +42,46 @@ SOFTWARE.
 #define VARSERVER_DEFAULT_WORKBUF_SIZE  ( BUFSIZ )
 #endif
 
+#ifndef VARSERVER_MAX_WORKBUF_SIZE
+/*! largest size the client/server working buffer can grow to when
+    transferring large strings and blobs */
+#define VARSERVER_MAX_WORKBUF_SIZE  ( 16 * 1024 * 1024 )
+#endif
+
+#ifndef VARSERVER_MAX_BATCH_ITEMS
+/*! maximum number of variables sent to the server in a single
+    VAR_GetMany or VAR_SetMany request */
+#define VARSERVER_MAX_BATCH_ITEMS   ( 256 )
+#endif
+
 #ifndef VARSERVER_MAX_NOTIFICATION_MSG_SIZE
 /*! default size of notification messages */
 #define VARSERVER_MAX_NOTIFICATION_MSG_SIZE    ( 4096 )
 #endif
 
+#ifndef VARSERVER_MAX_ASYNC_DEPTH
+/*! maximum number of requests in flight in an asynchronous
+    request context */
+#define VARSERVER_MAX_ASYNC_DEPTH   ( 64 )
+#endif
+
+#ifndef VARSERVER_HISTORY_DEPTH
+/*! number of samples kept in the history ring of a variable
+    with the VARFLAG_HISTORY flag */
+#define VARSERVER_HISTORY_DEPTH     ( 256 )
+#endif
+
+/*! requests are serviced in arrival order, after any high priority
+    requests */
+#define VARSERVER_PRIORITY_NORMAL   ( 0 )
+
+/*! requests are serviced ahead of normal priority requests.  Only
+    root and the user running the variable server are granted it */
+#define VARSERVER_PRIORITY_HIGH     ( 1 )
+
+/*! number of request priority classes */
+#define VARSERVER_NUM_PRIORITIES    ( 2 )
+
 #ifndef VARSERVER_MAX_NOTIFICATION_MSG_COUNT
 /*! default max number of notification messages per client */
 #define VARSERVER_MAX_NOTIFICATION_MSG_COUNT   ( 10 )
@@ -57,6 +92,10 @@ SOFTWARE.
 #define VARSERVER_GROUP_NAME "varserver"
 #endif
 
+/*! VAR_Snapshot option to only save the non-volatile variables
+    which have the dirty flag set */
+#define VAR_SNAPSHOT_DIRTY  ( 1 )
+
 /*! signal indicating a timer has fired  */
 #define SIG_VAR_TIMER    ( SIGRTMIN + 5 )
 
@@ -75,6 +114,9 @@ SOFTWARE.
 /*! signal indicating the variable notification queue has been modified */
 #define SIG_VAR_QUEUE_MODIFIED ( SIGRTMIN + 10 )
 
+/*! signal indicating an asynchronous request has completed */
+#define SIG_VAR_ASYNC    ( SIGRTMIN + 12 )
+
 /*! The VarNotification object is used to retrieve
     variable notifications from the Variable Server
     via the Notification message queue */
@@ -88,12 +130,36 @@ typedef struct _VarNotification
 
 } VarNotification;
 
+/*! opaque asynchronous request context */
+typedef struct _VarAsync VarAsync;
+
+/*! The VarAsyncCompletion object describes a completed
+    asynchronous request */
+typedef struct _VarAsyncCompletion
+{
+    /*! caller defined tag supplied with the request */
+    void *tag;
+
+    /*! handle of the variable */
+    VAR_HANDLE hVar;
+
+    /*! result of the request */
+    int result;
+
+    /*! var object supplied with the request.  It holds the value
+        of a successful VAR_AsyncGet request */
+    VarObject *pVarObject;
+
+} VarAsyncCompletion;
+
 /*============================================================================
         Public function declarations
 ============================================================================*/
 
 VARSERVER_HANDLE VARSERVER_Open( void );
 VARSERVER_HANDLE VARSERVER_OpenExt( size_t workbufsize );
+VARSERVER_HANDLE VARSERVER_OpenPriority( size_t workbufsize, int priority );
+int VARSERVER_GetPriority( VARSERVER_HANDLE hVarServer );
 int VARSERVER_UpdateUser( VARSERVER_HANDLE hVarServer );
 int VARSERVER_SetGroup( void );
 
@@ -106,6 +172,11 @@ int VARSERVER_Close( VARSERVER_HANDLE hVarServer );
 int VARSERVER_Test( VARSERVER_HANDLE hVarServer );
 int VARSERVER_CreateVar( VARSERVER_HANDLE hVarServer,
                          VarInfo *pVarInfo );
+
+int VARSERVER_CreateVars( VARSERVER_HANDLE hVarServer,
+                          VarInfo *pVarInfo,
+                          int *results,
+                          size_t n );
 int VARSERVER_WaitSignal( int *sigval );
 
 /* Flag functions */
@@ -131,6 +202,8 @@ int VARSERVER_ParseValueString( VarObject *var, char *valueString );
 /* variable functions */
 VAR_HANDLE VAR_FindByName( VARSERVER_HANDLE hVarServer, char *pName );
 
+int VAR_EnableNameCache( VARSERVER_HANDLE hVarServer, size_t size );
+
 int VAR_GetLength( VARSERVER_HANDLE hVarServer,
                    VAR_HANDLE hVar,
                    size_t *len );
@@ -151,6 +224,41 @@ int VAR_Get( VARSERVER_HANDLE hVarServer,
              VAR_HANDLE hVar,
              VarObject *pVarObject );
 
+int VAR_GetMany( VARSERVER_HANDLE hVarServer,
+                 VAR_HANDLE *hVars,
+                 VarObject *pVarObjects,
+                 int *results,
+                 size_t n );
+
+int VAR_ShareValue( VARSERVER_HANDLE hVarServer, VAR_HANDLE hVar );
+
+int VAR_OpenBlob( VARSERVER_HANDLE hVarServer,
+                  VAR_HANDLE hVar,
+                  VarBlob **ppVarBlob );
+
+int VAR_CloseBlob( VarBlob *pVarBlob );
+
+int VAR_BlobReadBegin( VarBlob *pVarBlob,
+                       const void **ppData,
+                       size_t *pLen,
+                       uint64_t *pGeneration );
+
+int VAR_BlobReadEnd( VarBlob *pVarBlob, uint64_t generation );
+
+int VAR_BlobWriteBegin( VarBlob *pVarBlob,
+                        void **ppData,
+                        size_t *pCapacity );
+
+int VAR_BlobWriteCommit( VARSERVER_HANDLE hVarServer,
+                         VarBlob *pVarBlob,
+                         size_t len );
+
+int VAR_BlobWriteAbort( VarBlob *pVarBlob );
+
+int VAR_GetVersion( VARSERVER_HANDLE hVarServer,
+                    VAR_HANDLE hVar,
+                    uint64_t *pVersion );
+
 int VAR_GetStrByName( VARSERVER_HANDLE hVarServer,
                       char *name,
                       char *buf,
@@ -187,6 +295,63 @@ int VAR_Set( VARSERVER_HANDLE hVarServer,
              VAR_HANDLE hVar,
              VarObject *pVarObject );
 
+int VAR_Modify( VARSERVER_HANDLE hVarServer,
+                VAR_HANDLE hVar,
+                VarModifyOp op,
+                VarObject *pOperand,
+                VarObject *pOld );
+
+int VAR_CompareAndSwap( VARSERVER_HANDLE hVarServer,
+                        VAR_HANDLE hVar,
+                        VarObject *pExpected,
+                        VarObject *pNew,
+                        VarObject *pOld );
+
+int VAR_SetMany( VARSERVER_HANDLE hVarServer,
+                 VAR_HANDLE *hVars,
+                 VarObject *pVarObjects,
+                 int *results,
+                 size_t n );
+
+int VAR_SetGroup( VARSERVER_HANDLE hVarServer,
+                  VAR_HANDLE *hVars,
+                  VarObject *pVarObjects,
+                  int *results,
+                  size_t n );
+
+VarAsync *VAR_AsyncOpen( VARSERVER_HANDLE hVarServer, size_t depth );
+
+int VAR_AsyncFd( VarAsync *pVarAsync );
+
+int VAR_AsyncGet( VarAsync *pVarAsync,
+                  VAR_HANDLE hVar,
+                  VarObject *pVarObject,
+                  void *tag );
+
+int VAR_AsyncSet( VarAsync *pVarAsync,
+                  VAR_HANDLE hVar,
+                  VarObject *pVarObject,
+                  void *tag );
+
+int VAR_AsyncComplete( VarAsync *pVarAsync,
+                       VarAsyncCompletion *pCompletions,
+                       size_t max,
+                       size_t *pCount );
+
+int VAR_AsyncClose( VarAsync *pVarAsync );
+
+int VAR_GetHistory( VARSERVER_HANDLE hVarServer,
+                    VAR_HANDLE hVar,
+                    VarHistoryQuery *pQuery,
+                    VarHistory *pHistory,
+                    VarHistorySample *pSamples,
+                    size_t maxSamples );
+
+int VARSERVER_GetLargestVars( VARSERVER_HANDLE hVarServer,
+                              VarMemUsage *pUsage,
+                              size_t n,
+                              size_t *pCount );
+
 int VAR_SetStr( VARSERVER_HANDLE hVarServer,
                 VAR_HANDLE hVar,
                 VarType type,
@@ -217,6 +382,23 @@ int VAR_SendValidationResponse( VARSERVER_HANDLE hVarServer,
                                 uint32_t id,
                                 int response  );
 
+int VAR_SetValidationPolicy( VARSERVER_HANDLE hVarServer,
+                             ValidationPolicy *pPolicy );
+
+int VAR_GetValidationRequests( VARSERVER_HANDLE hVarServer,
+                               uint32_t *ids,
+                               VAR_HANDLE *hVars,
+                               VarObject *pVarObjects,
+                               int *results,
+                               size_t max,
+                               size_t *n );
+
+int VAR_SendValidationResponses( VARSERVER_HANDLE hVarServer,
+                                 uint32_t *ids,
+                                 int *responses,
+                                 int *results,
+                                 size_t n );
+
 int VAR_OpenPrintSession( VARSERVER_HANDLE hVarServer,
                          uint32_t id,
                          VAR_HANDLE *hVar,
@@ -233,6 +415,18 @@ int VAR_GetNext( VARSERVER_HANDLE hVarServer,
                  VarQuery *query,
                  VarObject *obj );
 
+int VAR_GetPage( VARSERVER_HANDLE hVarServer,
+                 VarQuery *query,
+                 VarQueryPage *pPage,
+                 size_t len );
+
+VarQueryRecord *VAR_GetPageRecord( VarQueryPage *pPage,
+                                   VarQueryRecord *pRecord );
+
+int VAR_PrintRecord( VARSERVER_HANDLE hVarServer,
+                     VarQueryRecord *pRecord,
+                     int fd );
+
 int VARSERVER_CreateClientQueue( VARSERVER_HANDLE hVarServer,
                                  long queuelen,
                                  long msgsize );
@@ -242,9 +436,37 @@ int VAR_GetFromQueue( VARSERVER_HANDLE hVarServer,
                       char *buf,
                       size_t len );
 
+int VARSERVER_ClientQueuefd( VARSERVER_HANDLE hVarServer );
+
+int VAR_GetQueueOverflows( VARSERVER_HANDLE hVarServer, uint64_t *pCount );
+
+int VAR_NotifyEx( VARSERVER_HANDLE hVarServer,
+                  VAR_HANDLE hVar,
+                  NotificationType notificationType,
+                  const VarNotifyOptions *pOptions );
+
+int VAR_NotifyQuery( VARSERVER_HANDLE hVarServer, VarQuery *query );
+
+int VAR_NotifyQueryCancel( VARSERVER_HANDLE hVarServer, VarQuery *query );
+
+int VAR_Snapshot( VARSERVER_HANDLE hVarServer,
+                  const char *path,
+                  uint32_t options,
+                  size_t *pCount );
+
+int VARSERVER_CreateClientRing( VARSERVER_HANDLE hVarServer );
+
+int VAR_GetFromRing( VARSERVER_HANDLE hVarServer,
+                     VarNotification *pVarNotification );
+
+int VAR_WaitRing( VARSERVER_HANDLE hVarServer, int timeout_ms );
+
 int VARSERVER_SetRequestTimeout( VARSERVER_HANDLE hVarServer,
                                  uint32_t timeout_s );
 
+int VARSERVER_SetTransport( VARSERVER_HANDLE hVarServer,
+                            VarTransport transport );
+
 int VARSERVER_Signalfd( int flags );
 
 int VARSERVER_WaitSignalfd( int fd, int32_t *sigval );
@@ -46,6 +46,9 @@ SOFTWARE.
         Public Types
 ============================================================================*/
 
+/*! opaque compiled template object */
+typedef struct _VarTemplate VarTemplate;
+
 /*============================================================================
         Public Function Declarations
 ============================================================================*/
@@ -58,4 +61,23 @@ int TEMPLATE_StrToFile( VARSERVER_HANDLE hVarServer,
                         char *input,
                         int fd );
 
+int TEMPLATE_Compile( VARSERVER_HANDLE hVarServer,
+                      int fd_in,
+                      VarTemplate **ppVarTemplate );
+
+int TEMPLATE_CompileStr( VARSERVER_HANDLE hVarServer,
+                         char *input,
+                         VarTemplate **ppVarTemplate );
+
+int TEMPLATE_Render( VARSERVER_HANDLE hVarServer,
+                     VarTemplate *pVarTemplate,
+                     int fd );
+
+int TEMPLATE_Notify( VARSERVER_HANDLE hVarServer,
+                     VarTemplate *pVarTemplate );
+
+bool TEMPLATE_HasVar( VarTemplate *pVarTemplate, VAR_HANDLE hVar );
+
+int TEMPLATE_Free( VarTemplate **ppVarTemplate );
+
 #endif
\ No newline at end of file
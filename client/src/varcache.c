@@ -57,6 +57,15 @@ SOFTWARE.
     to the cache but cannot interrogate its content except via published
     API calls).
 
+    A cache can optionally hold a copy of the value of each of its
+    variables (see VARCACHE_EnableValues).  Each cached value is tagged
+    with the variable version published by the server in the shared
+    variable version segment.  VARCACHE_Refresh re-fetches only the
+    values whose version has changed, in a single batch request, and
+    VARCACHE_GetValue returns the cached value while it is current.
+    This avoids repeatedly transferring large strings and blobs which
+    rarely change.
+
 */
 /*============================================================================*/
 
@@ -84,6 +93,17 @@ SOFTWARE.
         Private type declarations
 ==============================================================================*/
 
+/*! cached variable value */
+typedef struct _VarCacheValue
+{
+    /*! version of the cached value, 0 if there is no cached value */
+    uint64_t version;
+
+    /*! cached copy of the variable value */
+    VarObject obj;
+
+} VarCacheValue;
+
 /*! VarCache object */
 typedef struct _VarCache
 {
@@ -99,12 +119,20 @@ typedef struct _VarCache
     /*! pointer to the variable handles in the cache */
     VAR_HANDLE *pVars;
 
+    /*! pointer to the cached values, NULL if values are not cached */
+    VarCacheValue *pValues;
+
 } VarCache;
 
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
 
+static int varcache_GrowValues( VarCache *pVarCache, size_t oldSize );
+static void varcache_FreeValue( VarCacheValue *pValue );
+static int varcache_Find( VarCache *pVarCache, VAR_HANDLE hVar, size_t *pIdx );
+static int varcache_CopyValue( VarObject *pSrc, VarObject *pDst );
+
 /*==============================================================================
         File scoped variables
 ==============================================================================*/
@@ -166,6 +194,7 @@ int VARCACHE_Init( VarCache **ppVarCache, size_t len, size_t growBy )
                 (*ppVarCache)->maxLength = len;
                 (*ppVarCache)->growBy = growBy;
                 (*ppVarCache)->pVars = pVars;
+                (*ppVarCache)->pValues = NULL;
 
                 /* indicate success */
                 result = EOK;
@@ -209,6 +238,7 @@ int VARCACHE_Add( VarCache *pVarCache, VAR_HANDLE hVar )
 {
     int result = EINVAL;
     VAR_HANDLE *pVars;
+    size_t oldSize;
     size_t newSize;
     size_t newLength;
 
@@ -239,8 +269,12 @@ int VARCACHE_Add( VarCache *pVarCache, VAR_HANDLE hVar )
             {
                 /* update the VarCache object with its new size and
                  * pointer to the Vars array */
+                oldSize = pVarCache->maxLength;
                 pVarCache->maxLength = newSize;
                 pVarCache->pVars = pVars;
+
+                /* grow the cached values to match */
+                result = varcache_GrowValues( pVarCache, oldSize );
             }
             else
             {
@@ -470,8 +504,8 @@ VAR_HANDLE VARCACHE_Get( VarCache *pVarCache, size_t idx )
     Clear the variable cache
 
     The VARCACHE_Clear function clears the variable cache data
-    and sets the variable cache length to zero.  The currently
-    allocated memory on the HEAP remains unchanged.
+    and sets the variable cache length to zero.  Any cached values
+    are discarded, but the variable handle list remains allocated.
 
 @param[in]
     pVarCache
@@ -485,10 +519,20 @@ int VARCACHE_Clear( VarCache *pVarCache )
 {
     int result = EINVAL;
     size_t length;
+    size_t idx;
 
     if ( ( pVarCache != NULL ) &&
          ( pVarCache->pVars != NULL ) )
     {
+        if ( pVarCache->pValues != NULL )
+        {
+            /* discard the cached values */
+            for ( idx = 0; idx < pVarCache->length; idx++ )
+            {
+                varcache_FreeValue( &pVarCache->pValues[idx] );
+            }
+        }
+
         /* calculate the cache length */
         length = pVarCache->length * sizeof( VAR_HANDLE );
 
@@ -534,6 +578,14 @@ int VARCACHE_Free( VarCache **ppVarCache )
         pVarCache = *ppVarCache;
         if ( pVarCache != NULL )
         {
+            /* discard the cached values */
+            VARCACHE_Clear( pVarCache );
+
+            if ( pVarCache->pValues != NULL )
+            {
+                free( pVarCache->pValues );
+            }
+
             if ( pVarCache->pVars != NULL )
             {
                 free( pVarCache->pVars );
@@ -550,5 +602,448 @@ int VARCACHE_Free( VarCache **ppVarCache )
     return result;
 }
 
+/*============================================================================*/
+/*  VARCACHE_EnableValues                                                     */
+/*!
+
+    Enable value caching on a variable cache
+
+    The VARCACHE_EnableValues function enables the variable cache to
+    hold a copy of the value of each of its variables.  The values
+    are retrieved using VARCACHE_Refresh or VARCACHE_GetValue.
+
+@param[in]
+    pVarCache
+        pointer to the VarCache object to enable value caching on
+
+@retval EOK value caching is enabled
+@retval ENOMEM memory allocation failed
+@retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARCACHE_EnableValues( VarCache *pVarCache )
+{
+    int result = EINVAL;
+
+    if ( pVarCache != NULL )
+    {
+        result = EOK;
+
+        if ( pVarCache->pValues == NULL )
+        {
+            pVarCache->pValues = calloc( pVarCache->maxLength,
+                                         sizeof( VarCacheValue ) );
+            if ( pVarCache->pValues == NULL )
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARCACHE_Refresh                                                          */
+/*!
+
+    Refresh the stale values in a variable cache
+
+    The VARCACHE_Refresh function checks the version of every variable
+    in the cache against the version published by the variable server,
+    and re-fetches the values of the variables which have changed since
+    they were cached, using a single VAR_GetMany batch request.
+    Variables which cannot be cached (for example those with a CALC
+    handler) are re-fetched every time.
+
+@param[in]
+    hVarServer
+        handle to the variable server
+
+@param[in]
+    pVarCache
+        pointer to the VarCache object to refresh
+
+@retval EOK the cached values are current
+@retval ENOTSUP value caching is not enabled on the cache
+@retval ENOMEM memory allocation failed
+@retval EINVAL invalid arguments
+@retval other the result of the first variable which could not be fetched
+
+==============================================================================*/
+int VARCACHE_Refresh( VARSERVER_HANDLE hVarServer, VarCache *pVarCache )
+{
+    int result = EINVAL;
+    VarCacheValue *pValue;
+    VAR_HANDLE *hVars = NULL;
+    VarObject *pObjs = NULL;
+    uint64_t *pVersions = NULL;
+    size_t *pIdx = NULL;
+    int *results = NULL;
+    uint64_t version;
+    size_t n = 0;
+    size_t idx;
+    size_t i;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pVarCache != NULL ) )
+    {
+        result = ( pVarCache->pValues != NULL ) ? EOK : ENOTSUP;
+    }
+
+    if ( ( result == EOK ) &&
+         ( pVarCache->length > 0 ) )
+    {
+        hVars = malloc( pVarCache->length * sizeof( VAR_HANDLE ) );
+        pObjs = calloc( pVarCache->length, sizeof( VarObject ) );
+        pVersions = malloc( pVarCache->length * sizeof( uint64_t ) );
+        pIdx = malloc( pVarCache->length * sizeof( size_t ) );
+        results = malloc( pVarCache->length * sizeof( int ) );
+        if ( ( hVars == NULL ) ||
+             ( pObjs == NULL ) ||
+             ( pVersions == NULL ) ||
+             ( pIdx == NULL ) ||
+             ( results == NULL ) )
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( ( result == EOK ) &&
+         ( pVarCache->length > 0 ) )
+    {
+        /* collect the stale entries.  The version is read before the
+           value so a change during the fetch is seen on the next check */
+        for ( idx = 0; idx < pVarCache->length; idx++ )
+        {
+            pValue = &pVarCache->pValues[idx];
+            if ( VAR_GetVersion( hVarServer,
+                                 pVarCache->pVars[idx],
+                                 &version ) != EOK )
+            {
+                /* the value cannot be cached */
+                version = 0;
+            }
+
+            if ( ( version == 0 ) ||
+                 ( version != pValue->version ) )
+            {
+                hVars[n] = pVarCache->pVars[idx];
+                pVersions[n] = version;
+                pIdx[n] = idx;
+                n++;
+            }
+        }
+
+        if ( n > 0 )
+        {
+            /* fetch all of the stale values in one batch */
+            result = VAR_GetMany( hVarServer, hVars, pObjs, results, n );
+
+            for ( i = 0; i < n; i++ )
+            {
+                pValue = &pVarCache->pValues[pIdx[i]];
+                varcache_FreeValue( pValue );
+
+                if ( results[i] == EOK )
+                {
+                    pValue->obj = pObjs[i];
+                    pValue->version = pVersions[i];
+                }
+                else if ( ( pObjs[i].type == VARTYPE_STR ) ||
+                          ( pObjs[i].type == VARTYPE_BLOB ) )
+                {
+                    free( pObjs[i].val.blob );
+                }
+            }
+        }
+    }
+
+    free( hVars );
+    free( pObjs );
+    free( pVersions );
+    free( pIdx );
+    free( results );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARCACHE_GetValue                                                         */
+/*!
+
+    Get a variable value from a variable cache
+
+    The VARCACHE_GetValue function gets the value of the specified
+    variable from the cache.  If the cached value is stale it is
+    re-fetched from the variable server first.  String and blob values
+    are copied into the buffer of the specified var object, as for
+    VAR_Get.  If the var object has no buffer, one is allocated and
+    must be freed by the caller.
+
+@param[in]
+    hVarServer
+        handle to the variable server
+
+@param[in]
+    pVarCache
+        pointer to the VarCache object containing the variable
+
+@param[in]
+    hVar
+        handle of the variable to get
+
+@param[in,out]
+    pVarObject
+        pointer to the var object to store the variable value in
+
+@retval EOK the variable value was retrieved
+@retval ENOENT the variable is not in the cache
+@retval ENOTSUP value caching is not enabled on the cache
+@retval E2BIG the var object buffer is too small for the value
+@retval ENOMEM memory allocation failed
+@retval EINVAL invalid arguments
+@retval other error retrieving the value from the variable server
+
+==============================================================================*/
+int VARCACHE_GetValue( VARSERVER_HANDLE hVarServer,
+                       VarCache *pVarCache,
+                       VAR_HANDLE hVar,
+                       VarObject *pVarObject )
+{
+    int result = EINVAL;
+    VarCacheValue *pValue;
+    VarObject obj;
+    uint64_t version;
+    size_t idx;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pVarCache != NULL ) &&
+         ( pVarObject != NULL ) )
+    {
+        result = ( pVarCache->pValues != NULL ) ? EOK : ENOTSUP;
+        if ( result == EOK )
+        {
+            result = varcache_Find( pVarCache, hVar, &idx );
+        }
+
+        if ( result == EOK )
+        {
+            pValue = &pVarCache->pValues[idx];
+            if ( VAR_GetVersion( hVarServer, hVar, &version ) != EOK )
+            {
+                /* the value cannot be cached */
+                version = 0;
+            }
+
+            if ( ( version == 0 ) ||
+                 ( version != pValue->version ) )
+            {
+                /* re-fetch the stale value */
+                memset( &obj, 0, sizeof( VarObject ) );
+                result = VAR_Get( hVarServer, hVar, &obj );
+                if ( result == EOK )
+                {
+                    varcache_FreeValue( pValue );
+                    pValue->obj = obj;
+                    pValue->version = version;
+                }
+                else if ( ( obj.type == VARTYPE_STR ) ||
+                          ( obj.type == VARTYPE_BLOB ) )
+                {
+                    free( obj.val.blob );
+                }
+            }
+        }
+
+        if ( result == EOK )
+        {
+            result = varcache_CopyValue( &pValue->obj, pVarObject );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varcache_GrowValues                                                       */
+/*!
+
+    Grow the cached values to match the variable cache size
+
+    The varcache_GrowValues function resizes the cached value array
+    after the variable handle array has grown.  It does nothing if
+    value caching is not enabled.
+
+@param[in]
+    pVarCache
+        pointer to the VarCache object which has grown
+
+@param[in]
+    oldSize
+        number of entries in the cached value array before growing
+
+@retval EOK the cached value array was resized
+@retval ENOMEM memory reallocation failed
+
+==============================================================================*/
+static int varcache_GrowValues( VarCache *pVarCache, size_t oldSize )
+{
+    int result = EOK;
+    VarCacheValue *pValues;
+
+    if ( pVarCache->pValues != NULL )
+    {
+        pValues = realloc( pVarCache->pValues,
+                           pVarCache->maxLength * sizeof( VarCacheValue ) );
+        if ( pValues != NULL )
+        {
+            /* clear the new entries */
+            memset( &pValues[oldSize],
+                    0,
+                    ( pVarCache->maxLength - oldSize ) *
+                        sizeof( VarCacheValue ) );
+            pVarCache->pValues = pValues;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varcache_FreeValue                                                        */
+/*!
+
+    Discard a cached value
+
+    The varcache_FreeValue function frees any string or blob buffer
+    held by the cached value and marks it as not cached.
+
+@param[in]
+    pValue
+        pointer to the cached value to discard
+
+==============================================================================*/
+static void varcache_FreeValue( VarCacheValue *pValue )
+{
+    if ( ( pValue->obj.type == VARTYPE_STR ) ||
+         ( pValue->obj.type == VARTYPE_BLOB ) )
+    {
+        free( pValue->obj.val.blob );
+    }
+
+    memset( pValue, 0, sizeof( VarCacheValue ) );
+}
+
+/*============================================================================*/
+/*  varcache_Find                                                             */
+/*!
+
+    Find the index of a variable in the variable cache
+
+@param[in]
+    pVarCache
+        pointer to the VarCache object to search
+
+@param[in]
+    hVar
+        handle of the variable to look for
+
+@param[out]
+    pIdx
+        pointer to a location to store the index of the variable
+
+@retval EOK the variable was found
+@retval ENOENT the variable is not in the cache
+
+==============================================================================*/
+static int varcache_Find( VarCache *pVarCache, VAR_HANDLE hVar, size_t *pIdx )
+{
+    int result = ENOENT;
+    size_t idx;
+
+    for ( idx = 0; idx < pVarCache->length ; idx++ )
+    {
+        if( pVarCache->pVars[idx] == hVar )
+        {
+            *pIdx = idx;
+            result = EOK;
+            break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varcache_CopyValue                                                        */
+/*!
+
+    Copy a cached value into a caller's var object
+
+    The varcache_CopyValue function copies the cached value into the
+    destination var object.  String and blob values are copied into
+    the destination buffer, which is allocated if it does not exist.
+
+@param[in]
+    pSrc
+        pointer to the cached var object
+
+@param[in,out]
+    pDst
+        pointer to the destination var object
+
+@retval EOK the value was copied
+@retval E2BIG the destination buffer is too small
+@retval ENOMEM memory allocation failed
+
+==============================================================================*/
+static int varcache_CopyValue( VarObject *pSrc, VarObject *pDst )
+{
+    int result = EOK;
+    size_t srclen;
+
+    if ( ( pSrc->type == VARTYPE_STR ) ||
+         ( pSrc->type == VARTYPE_BLOB ) )
+    {
+        srclen = ( pSrc->type == VARTYPE_STR ) ? strlen( pSrc->val.str ) + 1
+                                                : pSrc->len;
+
+        if ( pDst->val.blob == NULL )
+        {
+            pDst->val.blob = malloc( srclen );
+            pDst->len = srclen;
+        }
+
+        if ( pDst->val.blob == NULL )
+        {
+            result = ENOMEM;
+        }
+        else if ( pDst->len < srclen )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            memcpy( pDst->val.blob, pSrc->val.blob, srclen );
+            pDst->type = pSrc->type;
+            if ( pSrc->type == VARTYPE_BLOB )
+            {
+                pDst->len = srclen;
+            }
+        }
+    }
+    else
+    {
+        *pDst = *pSrc;
+    }
+
+    return result;
+}
+
 /*! @}
  * end of varcache group */
@@ -70,6 +70,16 @@ SOFTWARE.
         Private function declarations
 ==============================================================================*/
 
+static int client_RingRequest( VarClient *pVarClient, pid_t pid );
+static int client_Send( VarClient *pVarClient, int signal );
+static int client_Wait( VarClient *pVarClient, int signal );
+static bool client_ServerLost( VarClient *pVarClient );
+static bool client_Failover( VarClient *pVarClient, int signal );
+static bool client_Idempotent( VarRequest requestType );
+static int client_AwaitServer( VarClient *pVarClient );
+static int client_Reconnect( VarClient *pVarClient );
+static uint64_t client_Now( void );
+
 
 /*==============================================================================
         File scoped variables
@@ -117,6 +127,75 @@ VarClient *ValidateHandle( VARSERVER_HANDLE hVarServer )
     return pVarClient;
 }
 
+/*============================================================================*/
+/*  ClientSubmit                                                              */
+/*!
+    Send a request from the client to the server without waiting
+
+    The ClientSubmit function is used to send a client request from a
+    client to the Variable Server.  It returns as soon as the request
+    has been sent.  The server posts the client semaphore when the
+    request is complete.
+
+    If the server the client registered with has been replaced, the
+    client registers with its replacement before the request is sent.
+    If a server with a warm standby arena has stopped, the client waits
+    for its replacement.
+
+    @param[in]
+        pVarClient
+            pointer to the VarClient object belonging to the client
+
+    @param[in]
+        signal
+            specifies the real-time signal to be sent
+            from the client to the server
+
+    @retval EOK - the client request was sent to the server
+    @retval EINVAL - an invalid client was specified
+    @retval ECONNRESET - the server was restarted with a new variable store
+    @retval other - error code returned by sigqueue
+
+==============================================================================*/
+int ClientSubmit( VarClient *pVarClient, int signal )
+{
+    int result = EINVAL;
+
+    if( ( pVarClient != NULL ) && ( pVarClient->pServerInfo != NULL ) )
+    {
+        result = EOK;
+        if( ( signal == SIG_CLIENT_REQUEST ) &&
+            ( pVarClient->serverPID != 0 ) &&
+            ( __atomic_load_n( &pVarClient->pServerInfo->pid,
+                               __ATOMIC_ACQUIRE ) != pVarClient->serverPID ) )
+        {
+            /* the server has been restarted since the last request */
+            result = client_Reconnect( pVarClient );
+        }
+
+        if( result == EOK )
+        {
+            result = client_Send( pVarClient, signal );
+            if( ( result == ESRCH ) &&
+                ( client_Failover( pVarClient, signal ) == true ) )
+            {
+                /* the server has stopped, so wait for its replacement */
+                result = client_AwaitServer( pVarClient );
+                if( result == EOK )
+                {
+                    result = client_Reconnect( pVarClient );
+                }
+
+                result = ( result == EOK ) ? client_Send( pVarClient, signal )
+                       : ( result == ETIMEDOUT ) ? ESRCH
+                       : result;
+            }
+        }
+    }
+
+    return result;
+}
+
 /*============================================================================*/
 /*  ClientRequest                                                             */
 /*!
@@ -125,11 +204,21 @@ VarClient *ValidateHandle( VARSERVER_HANDLE hVarServer )
     The ClientRequest function is used to send a client request from a
     client to the Variable Server.
 
-    This is a blocking call with a fixed timeout of 5s. The client will wait
-    until explicitly released by the server or the timeout expires. If the
-    server dies, the call will exit with a timeout error code. If other
+    This is a blocking call. The client will wait until explicitly
+    released by the server or the client request timeout expires.  A
+    client without a request timeout waits indefinitely.  If other
     syncronization erros occur, a call will be retied.
 
+    If a server with a warm standby arena stops before completing the
+    request, the outcome of the request is unknown, since the server may
+    have applied it to the standby arena before it stopped.  A request
+    which may safely be applied twice, such as a get, a find or a plain
+    set, is sent once more to the replacement server.  Any other request
+    fails with ECONNABORTED, and the client registers with the new server
+    on its next request.  A request fails with ECONNRESET if the new
+    server did not resume the variable store of the old one, since the
+    variable handles held by the client are no longer valid.
+
     @param[in]
         pVarClient
             pointer to the VarClient object belonging to the client
@@ -141,95 +230,757 @@ VarClient *ValidateHandle( VARSERVER_HANDLE hVarServer )
 
     @retval EOK - the client request was handled successfully by the server
     @retval EINVAL - an invalid client was specified
+    @retval ECONNRESET - the server was restarted with a new variable store
+    @retval ECONNABORTED - the server stopped while processing the request,
+                           and the request may or may not have been applied
     @retval other - error code returned by sigqueue, or sem_wait
 
 ==============================================================================*/
 int ClientRequest( VarClient *pVarClient, int signal )
+{
+    int result;
+    VarRequest requestType = VARREQUEST_INVALID;
+
+    if( pVarClient != NULL )
+    {
+        requestType = pVarClient->requestType;
+    }
+
+    result = ClientSubmit( pVarClient, signal );
+    if( result == EOK )
+    {
+        result = client_Wait( pVarClient, signal );
+        if( ( result == ECONNABORTED ) &&
+            ( client_Idempotent( requestType ) == true ) )
+        {
+            /* the server stopped before the request was completed, and
+               it is safe to send it again to the replacement server */
+            result = client_AwaitServer( pVarClient );
+            if( result == EOK )
+            {
+                pVarClient->requestType = requestType;
+                result = ClientSubmit( pVarClient, signal );
+            }
+
+            if( result == EOK )
+            {
+                result = client_Wait( pVarClient, signal );
+            }
+        }
+    }
+
+    if( ( result == EOK ) && ( signal == SIG_NEWCLIENT ) )
+    {
+        /* remember the server and the variable store we registered with */
+        pVarClient->serverPID = __atomic_load_n( &pVarClient->pServerInfo->pid,
+                                                 __ATOMIC_ACQUIRE );
+        pVarClient->storeID = pVarClient->pServerInfo->storeID;
+    }
+
+    if( ( result != EOK ) &&
+        ( pVarClient != NULL ) &&
+        ( pVarClient->debug >= LOG_ERR ) )
+    {
+        printf("%s failed: (%d) %s\n", __func__, result, strerror(result));
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ShardName                                                                 */
+/*!
+    Build the name of a shared object for a server shard
+
+    The ShardName function builds the name of a shared memory object
+    or message queue belonging to the specified server shard.  The root
+    server (shard 0) uses the base name unchanged, and the other shards
+    append their shard index, for example /varserver.2.  The buffer
+    holds an empty name if the name cannot be built.
+
+    @param[out]
+        buf
+            pointer to the buffer to receive the name
+
+    @param[in]
+        len
+            size of the buffer
+
+    @param[in]
+        name
+            base name of the shared object
+
+    @param[in]
+        shard
+            shard index
+
+    @retval EOK - the name was built
+    @retval E2BIG - the buffer is too small
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int ShardName( char *buf, size_t len, char *name, int shard )
+{
+    int result = EINVAL;
+    int n;
+
+    if( ( buf != NULL ) &&
+        ( len > 0 ) )
+    {
+        buf[0] = 0;
+    }
+
+    if( ( buf != NULL ) &&
+        ( name != NULL ) &&
+        ( shard >= 0 ) &&
+        ( shard < VARSERVER_MAX_SHARDS ) )
+    {
+        if( shard == 0 )
+        {
+            n = snprintf( buf, len, "%s", name );
+        }
+        else
+        {
+            n = snprintf( buf, len, "%s.%d", name, shard );
+        }
+
+        result = ( ( n >= 0 ) && ( (size_t)n < len ) ) ? EOK : E2BIG;
+        if( ( result != EOK ) && ( len > 0 ) )
+        {
+            buf[0] = 0;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ClientName                                                                */
+/*!
+    Build the name of a client's shared memory object
+
+    The ClientName function builds the name of the shared memory object
+    holding a client connection.  The primary connection of a process is
+    /varclient_<pid>, and additional connections opened by the same
+    process append their channel index, for example /varclient_<pid>_3.
+    Connections to a shard server also append the shard index.
+
+    @param[out]
+        buf
+            pointer to the buffer to receive the name
+
+    @param[in]
+        len
+            size of the buffer
+
+    @param[in]
+        pid
+            process identifier of the client
+
+    @param[in]
+        channel
+            channel index of the connection, 0 for the primary connection
+
+    @param[in]
+        shard
+            shard index
+
+    @retval EOK - the name was built
+    @retval E2BIG - the buffer is too small
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int ClientName( char *buf, size_t len, pid_t pid, int channel, int shard )
+{
+    char basename[BUFSIZ];
+
+    if( channel == 0 )
+    {
+        snprintf( basename, sizeof( basename ), "/varclient_%d", pid );
+    }
+    else
+    {
+        snprintf( basename,
+                  sizeof( basename ),
+                  "/varclient_%d_%d",
+                  pid,
+                  channel );
+    }
+
+    return ShardName( buf, len, basename, shard );
+}
+
+/*============================================================================*/
+/*  SharedBlobLock                                                            */
+/*!
+    Lock the next buffer of a zero-copy blob for writing
+
+    The SharedBlobLock function gives the specified process exclusive
+    use of the buffer which will hold the next value of a zero-copy
+    blob.  A lock held by a process which no longer exists is taken
+    over.
+
+    @param[in]
+        pSharedBlob
+            pointer to the blob segment
+
+    @param[in]
+        pid
+            process identifier of the writer
+
+    @retval EOK - the buffer was locked
+    @retval EBUSY - another process is writing to the buffer
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int SharedBlobLock( SharedBlob *pSharedBlob, pid_t pid )
 {
     int result = EINVAL;
+    int32_t writer = 0;
+
+    if( ( pSharedBlob != NULL ) &&
+        ( pid > 0 ) )
+    {
+        result = EBUSY;
+
+        if( __atomic_compare_exchange_n( &pSharedBlob->writer,
+                                         &writer,
+                                         pid,
+                                         false,
+                                         __ATOMIC_ACQUIRE,
+                                         __ATOMIC_RELAXED ) )
+        {
+            result = EOK;
+        }
+        else if( ( writer == pid ) ||
+                 ( ( kill( writer, 0 ) == -1 ) && ( errno == ESRCH ) ) )
+        {
+            /* take over a lock we already hold or a dead writer's lock */
+            if( __atomic_compare_exchange_n( &pSharedBlob->writer,
+                                             &writer,
+                                             pid,
+                                             false,
+                                             __ATOMIC_ACQUIRE,
+                                             __ATOMIC_RELAXED ) )
+            {
+                result = EOK;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SharedBlobUnlock                                                          */
+/*!
+    Unlock the next buffer of a zero-copy blob
+
+    The SharedBlobUnlock function releases the lock taken by the
+    specified process with SharedBlobLock.  The lock is left alone if
+    it is held by another process.
+
+    @param[in]
+        pSharedBlob
+            pointer to the blob segment
+
+    @param[in]
+        pid
+            process identifier of the writer
+
+==============================================================================*/
+void SharedBlobUnlock( SharedBlob *pSharedBlob, pid_t pid )
+{
+    int32_t writer = pid;
+
+    if( pSharedBlob != NULL )
+    {
+        (void)__atomic_compare_exchange_n( &pSharedBlob->writer,
+                                           &writer,
+                                           0,
+                                           false,
+                                           __ATOMIC_RELEASE,
+                                           __ATOMIC_RELAXED );
+    }
+}
+
+/*============================================================================*/
+/*  client_RingRequest                                                        */
+/*!
+    Queue a client request on the shared request ring
+
+    The client_RingRequest function reserves an entry on the shared
+    request ring and stores the process and client identifiers in it.
+    The server is only signalled (via the doorbell signal) if it has
+    indicated that it is idle and waiting for a doorbell.
+
+    @param[in]
+        pVarClient
+            pointer to the VarClient object belonging to the client
+
+    @param[in]
+        pid
+            process identifier of the variable server
+
+    @retval EOK - the request was queued
+    @retval ENOSPC - the ring is full and the request was not queued
+    @retval other - error code returned by sigqueue
+
+==============================================================================*/
+static int client_RingRequest( VarClient *pVarClient, pid_t pid )
+{
+    int result = ENOSPC;
+    RequestRing *pRing = pVarClient->pRequestRing;
+    uint32_t head;
+    uint32_t tail;
+    uint64_t entry;
     union sigval val;
-    ServerInfo *pServerInfo = NULL;
 
-    if( pVarClient != NULL )
+    tail = __atomic_load_n( &pRing->tail, __ATOMIC_RELAXED );
+    do
     {
-         /* get a pointer to the server info */
-        pServerInfo = pVarClient->pServerInfo;
-        if( pServerInfo != NULL )
+        head = __atomic_load_n( &pRing->head, __ATOMIC_ACQUIRE );
+        if( (uint32_t)( tail - head ) >= VARSERVER_REQUEST_RING_SIZE )
         {
-            /* provide the client identifier to the var server */
-            val.sival_int = pVarClient->clientid;
+            /* ring is full */
+            break;
+        }
 
-            if( pVarClient->debug >= LOG_DEBUG )
+        if( __atomic_compare_exchange_n( &pRing->tail,
+                                         &tail,
+                                         tail + 1,
+                                         false,
+                                         __ATOMIC_SEQ_CST,
+                                         __ATOMIC_RELAXED ) )
+        {
+            result = EOK;
+        }
+    } while( result != EOK );
+
+    if( result == EOK )
+    {
+        /* publish the submitter in the reserved entry */
+        entry = ( (uint64_t)(uint32_t)pVarClient->client_pid << 32 ) |
+                (uint32_t)pVarClient->clientid;
+        __atomic_store_n( &pRing->entries[tail % VARSERVER_REQUEST_RING_SIZE],
+                          entry,
+                          __ATOMIC_RELEASE );
+
+        /* ring the doorbell if the server is waiting for one */
+        if( __atomic_exchange_n( &pRing->idle, 0, __ATOMIC_SEQ_CST ) != 0 )
+        {
+            val.sival_int = pVarClient->clientid;
+            if( sigqueue( pid, SIG_CLIENT_DOORBELL, val ) != 0 )
             {
-                printf("CLIENT: Sending client request signal (%d) to %d\n",
-                       signal,
-                       pServerInfo->pid );
+                result = errno;
             }
+        }
+    }
 
-            /* copy the client grouplist into the VarInfo credentials */
-            memcpy( pVarClient->variableInfo.creds,
-                    pVarClient->grouplist,
-                    pVarClient->ngroups * sizeof( gid_t ) );
+    return result;
+}
 
-            /*! set the number of groups to check */
-            pVarClient->variableInfo.ncreds = pVarClient->ngroups;
+/*============================================================================*/
+/*  client_Send                                                               */
+/*!
+    Send a request signal to the server
 
-            result = sigqueue( pServerInfo->pid, signal, val );
-            if( result == EOK )
+    The client_Send function timestamps the client request and passes
+    it to the server through the shared request ring, or with a
+    real-time signal if the ring is not available or is full.  A
+    request is marked pending until the server accepts it, and the
+    server discards any request of the client which is not pending.
+
+    @param[in]
+        pVarClient
+            pointer to the VarClient object belonging to the client
+
+    @param[in]
+        signal
+            specifies the real-time signal to be sent
+            from the client to the server
+
+    @retval EOK - the client request was sent to the server
+    @retval other - error code returned by sigqueue
+
+==============================================================================*/
+static int client_Send( VarClient *pVarClient, int signal )
+{
+    int result = ENOSPC;
+    union sigval val;
+    ServerInfo *pServerInfo = pVarClient->pServerInfo;
+
+    /* provide the client identifier to the var server, or the
+       channel index of a connection which is not registered */
+    val.sival_int = ( signal == SIG_NEWCLIENT )
+                        ? pVarClient->channel
+                        : pVarClient->clientid;
+
+    if( pVarClient->debug >= LOG_DEBUG )
+    {
+        printf("CLIENT: Sending client request signal (%d) to %d\n",
+               signal,
+               pServerInfo->pid );
+    }
+
+    /* timestamp the request so the server can measure how long
+       it was queued */
+    if( clock_gettime( CLOCK_MONOTONIC, &pVarClient->ts ) == 0 )
+    {
+        pVarClient->requestTime =
+            (uint64_t)pVarClient->ts.tv_sec * 1000000000ULL +
+            (uint64_t)pVarClient->ts.tv_nsec;
+    }
+
+    if( signal == SIG_CLIENT_REQUEST )
+    {
+        __atomic_store_n( &pVarClient->pending, 1, __ATOMIC_RELEASE );
+    }
+
+    if( ( pVarClient->pRequestRing != NULL ) &&
+        ( signal == SIG_CLIENT_REQUEST ) )
+    {
+        /* try the shared request ring first */
+        result = client_RingRequest( pVarClient, pServerInfo->pid );
+    }
+
+    if( result == ENOSPC )
+    {
+        result = ( sigqueue( pServerInfo->pid, signal, val ) == 0 )
+                    ? EOK
+                    : errno;
+    }
+
+    if( result != EOK )
+    {
+        /* the request did not reach the server */
+        __atomic_store_n( &pVarClient->pending, 0, __ATOMIC_RELEASE );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  client_Wait                                                               */
+/*!
+    Wait for the server to complete a client request
+
+    The client_Wait function waits on the client semaphore until the
+    server completes the request or the client request timeout expires.
+    While it waits for a request of a client registered with a server
+    which keeps a warm standby arena, it checks every
+    VARSERVER_FAILOVER_POLL_MS that the server is still running.
+
+    @param[in]
+        pVarClient
+            pointer to the VarClient object belonging to the client
+
+    @param[in]
+        signal
+            specifies the real-time signal which was sent to the server
+
+    @retval EOK - the server completed the request
+    @retval ETIMEDOUT - the client request timeout expired
+    @retval ECONNABORTED - the server stopped before completing the request
+
+==============================================================================*/
+static int client_Wait( VarClient *pVarClient, int signal )
+{
+    int result = EINTR;
+    bool failover;
+    uint64_t deadline = 0;
+    uint64_t due;
+    struct timespec ts;
+
+    failover = client_Failover( pVarClient, signal );
+
+    if( pVarClient->requestTimeout_s > 0 )
+    {
+        deadline = client_Now() +
+                   (uint64_t)pVarClient->requestTimeout_s * 1000000000ULL;
+    }
+
+    do
+    {
+        pVarClient->blocked = 1;
+        if( ( deadline == 0 ) && ( failover == false ) )
+        {
+            result = sem_wait( &pVarClient->sem );
+        }
+        else
+        {
+            /* wake up periodically to check on the server */
+            due = ( failover == true )
+                    ? client_Now() + VARSERVER_FAILOVER_POLL_MS * 1000000ULL
+                    : deadline;
+            if( ( deadline != 0 ) && ( due > deadline ) )
             {
-                do
-                {
-                    if ( pVarClient->requestTimeout_s > 0)
-                    {
-                        result = clock_gettime(CLOCK_REALTIME, &pVarClient->ts);
-                        if( result == -1)
-                        {
-                            continue;
-                        }
-
-                        /* add the timeout to the current time */
-                        pVarClient->ts.tv_sec += pVarClient->requestTimeout_s;
-
-                        pVarClient->blocked = 1;
-                        result = sem_timedwait( &pVarClient->sem, &pVarClient->ts );
-                    }
-                    else
-                    {
-                        pVarClient->blocked = 1;
-                        result = sem_wait( &pVarClient->sem );
-                    }
-
-                    if( result == EOK )
-                    {
-                        if( pVarClient->debug >= LOG_DEBUG )
-                        {
-                            printf("CLIENT: Received response\n");
-                        }
-                    }
-                    else
-                    {
-                        printf("sem_wait failed\n");
-                        result = errno;
-                    }
-                    pVarClient->blocked = 0;
-                }
-                while ( result != EOK && result != ETIMEDOUT );
+                due = deadline;
+            }
+
+            ts.tv_sec = (time_t)( due / 1000000000ULL );
+            ts.tv_nsec = (long)( due % 1000000000ULL );
+            result = sem_timedwait( &pVarClient->sem, &ts );
+        }
+        pVarClient->blocked = 0;
+
+        if( result == EOK )
+        {
+            if( pVarClient->debug >= LOG_DEBUG )
+            {
+                printf("CLIENT: Received response\n");
+            }
+        }
+        else
+        {
+            result = errno;
+            if( ( result == ETIMEDOUT ) &&
+                ( ( deadline == 0 ) || ( client_Now() < deadline ) ) )
+            {
+                /* the polling interval expired, not the request */
+                result = ( client_ServerLost( pVarClient ) == true )
+                            ? ECONNABORTED
+                            : EINTR;
             }
             else
             {
-                result = errno;
+                printf("sem_wait failed\n");
             }
         }
     }
+    while ( ( result != EOK ) &&
+            ( result != ETIMEDOUT ) &&
+            ( result != ECONNABORTED ) );
 
-    if( ( result != EOK ) &&
-        ( pVarClient->debug >= LOG_ERR ) )
+    return result;
+}
+
+/*============================================================================*/
+/*  client_ServerLost                                                         */
+/*!
+    Check if the server the client registered with has stopped
+
+    The client_ServerLost function checks if the server the client
+    registered with has been replaced by a new server, or is no longer
+    running.
+
+    @param[in]
+        pVarClient
+            pointer to the VarClient object belonging to the client
+
+    @retval true - the server has stopped
+    @retval false - the server is running
+
+==============================================================================*/
+static bool client_ServerLost( VarClient *pVarClient )
+{
+    pid_t pid;
+
+    pid = __atomic_load_n( &pVarClient->pServerInfo->pid, __ATOMIC_ACQUIRE );
+
+    return ( pid != pVarClient->serverPID ) ||
+           ( ( kill( pid, 0 ) == -1 ) && ( errno == ESRCH ) );
+}
+
+/*============================================================================*/
+/*  client_Failover                                                           */
+/*!
+    Check if a request can be failed over to a replacement server
+
+    The client_Failover function checks if a client request can be
+    completed by a replacement server should the server stop.  This is
+    the case for the requests of a registered client whose server keeps
+    a warm standby arena.
+
+    @param[in]
+        pVarClient
+            pointer to the VarClient object belonging to the client
+
+    @param[in]
+        signal
+            specifies the real-time signal which was sent to the server
+
+    @retval true - the request can be failed over
+    @retval false - the request cannot be failed over
+
+==============================================================================*/
+static bool client_Failover( VarClient *pVarClient, int signal )
+{
+    return ( signal == SIG_CLIENT_REQUEST ) &&
+           ( pVarClient->serverPID != 0 ) &&
+           ( pVarClient->pServerInfo->standby == true );
+}
+
+/*============================================================================*/
+/*  client_Idempotent                                                         */
+/*!
+    Check if a request may be applied more than once
+
+    The client_Idempotent function checks if a request gives the same
+    result when it is applied a second time, so it can be sent again
+    to a replacement server when the outcome of the first attempt is
+    unknown.
+
+    @param[in]
+        requestType
+            type of the request
+
+    @retval true - the request may be sent again
+    @retval false - the request must not be sent again
+
+==============================================================================*/
+static bool client_Idempotent( VarRequest requestType )
+{
+    bool result;
+
+    switch( requestType )
     {
-        printf("%s failed: (%d) %s\n", __func__, result, strerror(result));
+        case VARREQUEST_ECHO:
+        case VARREQUEST_GET_ALIASES:
+        case VARREQUEST_FIND:
+        case VARREQUEST_GET:
+        case VARREQUEST_SET:
+        case VARREQUEST_TYPE:
+        case VARREQUEST_NAME:
+        case VARREQUEST_LENGTH:
+        case VARREQUEST_FLAGS:
+        case VARREQUEST_INFO:
+        case VARREQUEST_SET_FLAGS:
+        case VARREQUEST_CLEAR_FLAGS:
+        case VARREQUEST_GET_MANY:
+        case VARREQUEST_SET_MANY:
+        case VARREQUEST_GET_HISTORY:
+        case VARREQUEST_GET_LARGEST:
+            result = true;
+            break;
+
+        default:
+            result = false;
+            break;
     }
 
     return result;
 }
 
+/*============================================================================*/
+/*  client_AwaitServer                                                        */
+/*!
+    Wait for a stopped server to be replaced
+
+    The client_AwaitServer function waits for a new server to publish
+    its process identifier in the server information segment.  It waits
+    for up to the client request timeout, or VARSERVER_FAILOVER_TIMEOUT_MS
+    for a client without a request timeout.
+
+    @param[in]
+        pVarClient
+            pointer to the VarClient object belonging to the client
+
+    @retval EOK - a new server is running
+    @retval ETIMEDOUT - no new server was started
+
+==============================================================================*/
+static int client_AwaitServer( VarClient *pVarClient )
+{
+    int result = EAGAIN;
+    pid_t pid;
+    uint64_t deadline;
+    struct timespec ts;
+
+    deadline = client_Now() +
+               ( ( pVarClient->requestTimeout_s > 0 )
+                   ? (uint64_t)pVarClient->requestTimeout_s * 1000000000ULL
+                   : VARSERVER_FAILOVER_TIMEOUT_MS * 1000000ULL );
+
+    ts.tv_sec = 0;
+    ts.tv_nsec = VARSERVER_FAILOVER_POLL_MS * 1000000L;
+
+    while( result == EAGAIN )
+    {
+        pid = __atomic_load_n( &pVarClient->pServerInfo->pid,
+                               __ATOMIC_ACQUIRE );
+        if( ( pid != pVarClient->serverPID ) &&
+            ( ( kill( pid, 0 ) == 0 ) || ( errno == EPERM ) ) )
+        {
+            result = EOK;
+        }
+        else if( client_Now() >= deadline )
+        {
+            result = ETIMEDOUT;
+        }
+        else
+        {
+            nanosleep( &ts, NULL );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  client_Reconnect                                                          */
+/*!
+    Register the client with a replacement server
+
+    The client_Reconnect function registers the client with the server
+    which replaced the server it was registered with.  The registration
+    only succeeds if the new server resumed the variable store of the
+    old server, since otherwise the variable handles held by the client
+    refer to different variables, or to no variable at all.
+
+    @param[in]
+        pVarClient
+            pointer to the VarClient object belonging to the client
+
+    @retval EOK - the client is registered with the new server
+    @retval ECONNRESET - the new server has a different variable store
+    @retval other - error from ClientRequest
+
+==============================================================================*/
+static int client_Reconnect( VarClient *pVarClient )
+{
+    int result;
+    uint64_t storeID = pVarClient->storeID;
+
+    result = ClientRequest( pVarClient, SIG_NEWCLIENT );
+    if( ( result == EOK ) && ( pVarClient->storeID != storeID ) )
+    {
+        result = ECONNRESET;
+    }
+
+    if( pVarClient->debug >= LOG_INFO )
+    {
+        printf("CLIENT: reconnected to server %d: %s\n",
+               pVarClient->serverPID,
+               strerror( result ) );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  client_Now                                                                */
+/*!
+    Get the current time
+
+    The client_Now function gets the current time in nanoseconds on the
+    realtime clock used by sem_timedwait.
+
+    @retval the current time in nanoseconds
+
+==============================================================================*/
+static uint64_t client_Now( void )
+{
+    struct timespec ts;
+    uint64_t now = 0;
+
+    if( clock_gettime( CLOCK_REALTIME, &ts ) == 0 )
+    {
+        now = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    }
+
+    return now;
+}
+
 /*! @}
  * end of varclient group */
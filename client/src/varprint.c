@@ -47,6 +47,13 @@ SOFTWARE.
     The requesting client remains blocked until the responding client
     has completed generating the string output to the requestor's stream.
 
+    The file descriptors are passed over print channels which persist
+    across print requests.  Each responder listens for channels on a
+    long-lived socket ( /tmp/varprint_<pid> ), and each requestor
+    keeps one connected channel per responder.  Each message carries
+    the print transaction identifier so a file descriptor left behind
+    by an abandoned print session is never used for the next one.
+
 */
 /*============================================================================*/
 
@@ -55,6 +62,7 @@ SOFTWARE.
         Includes
 ==============================================================================*/
 
+#define _GNU_SOURCE
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
@@ -66,6 +74,8 @@ SOFTWARE.
 #include <sys/stat.h>
 #include <fcntl.h>
 #include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <errno.h>
 #include <varserver/varobject.h>
 #include <varserver/varclient.h>
@@ -73,16 +83,72 @@ SOFTWARE.
 #include <varserver/var.h>
 #include <varserver/varprint.h>
 
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! initial number of entries in a print channel table */
+#define VARPRINT_INITIAL_CHANNELS ( 8 )
+
+/*! format of the print channel listener path of a responder */
+#define VARPRINT_CHANNEL_PATH "/tmp/varprint_%d"
+
+/*! The PrintChannel object holds a connection between a requestor
+    and a responder which is reused across print requests */
+typedef struct _printChannel
+{
+    /*! process identifier of the peer, 0 if the entry is unused */
+    pid_t pid;
+
+    /*! connected socket */
+    int sock;
+
+} PrintChannel;
+
+/*! The PrintChannels object is a table of print channels
+    which grows as channels are added to it */
+typedef struct _printChannels
+{
+    /*! pointer to the array of print channels */
+    PrintChannel *pChannels;
+
+    /*! number of entries in the print channel array */
+    size_t n;
+
+} PrintChannels;
+
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
-static int varprint_SendFd( int sock, int fd );
-static int varprint_ReceiveFd( int sock, int *fd );
+static int varprint_SendFd( int sock, void *data, size_t len, int fd );
+static int varprint_ReceiveFd( int sock, void *data, size_t len, int *fd );
+static void varprint_CheckOwner( void );
+static PrintChannel *varprint_FindChannel( PrintChannels *pTable, pid_t pid );
+static PrintChannel *varprint_AddChannel( PrintChannels *pTable,
+                                          pid_t pid,
+                                          int sock );
+static void varprint_DropChannel( PrintChannel *pChannel );
+static void varprint_CloseTable( PrintChannels *pTable );
+static int varprint_Connect( pid_t responderPID, int *sock );
+static int varprint_Accept( pid_t requestorPID, PrintChannel **ppChannel );
 
 /*==============================================================================
         File scoped variables
 ==============================================================================*/
 
+/*! process which owns the print channels.  The channels inherited
+    across a fork are discarded by the child */
+static pid_t channelOwner = 0;
+
+/*! socket listening for print channels from requestors */
+static int channelListener = -1;
+
+/*! print channels to the responders this client has requested prints from */
+static PrintChannels responders;
+
+/*! print channels from the requestors this client has printed for */
+static PrintChannels requestors;
+
 /*==============================================================================
         Function definitions
 ==============================================================================*/
@@ -114,6 +180,7 @@ int VARPRINT_GetFileDescriptor( int sock,
 {
     int result = EINVAL;
     int conn;
+    char data[1];
 
     while ( 1 )
     {
@@ -122,7 +189,7 @@ int VARPRINT_GetFileDescriptor( int sock,
         if( conn != -1 )
         {
             /* receive the file descriptor */
-            result = varprint_ReceiveFd( conn, fd );
+            result = varprint_ReceiveFd( conn, data, sizeof(data), fd );
             if( result == EOK )
             {
                 /* close the connection after the credentials are sent */
@@ -158,25 +225,36 @@ int VARPRINT_GetFileDescriptor( int sock,
     sock
         socket used to receive the file descriptor
 
+@param[out]
+    data
+        pointer to a buffer to store the message data sent with the
+        file descriptor
+
+@param[in]
+    len
+        length of the message data buffer
+
 @param[in]
     fd
         pointer to the location to store the received file descriptor
 
 @retval EOK the file descriptor was successfully received
+@retval ECONNRESET the peer closed the connection
+@retval EBADMSG the message did not contain a file descriptor
 @retval other error result from recvmsg
 
 ==============================================================================*/
-static int varprint_ReceiveFd( int sock, int *fd )
+static int varprint_ReceiveFd( int sock, void *data, size_t len, int *fd )
 {
     int result = EINVAL;
     struct msghdr msg;
     struct iovec iov[1];
     struct cmsghdr *cmsg = NULL;
     char ctrl_buf[CMSG_SPACE(sizeof(int))];
-    char data[1];
     int n;
 
-    if( fd != NULL )
+    if( ( fd != NULL ) &&
+        ( data != NULL ) )
     {
         /* clear the message header */
         memset(&msg, 0, sizeof(struct msghdr));
@@ -186,7 +264,7 @@ static int varprint_ReceiveFd( int sock, int *fd )
 
         /* populate the message data */
         iov[0].iov_base = data;
-        iov[0].iov_len = sizeof(data);
+        iov[0].iov_len = len;
 
         /* populate the message */
         msg.msg_name = NULL;
@@ -200,15 +278,23 @@ static int varprint_ReceiveFd( int sock, int *fd )
         n = recvmsg( sock, &msg, 0 );
 
         /* determine if the receive was successful */
-        result = ( n >= 0 ) ? EOK : errno;
+        result = ( n > 0 ) ? EOK : ( n == 0 ) ? ECONNRESET : errno;
 
         if( result == EOK )
         {
             /* extract the CMSG object from the message */
             cmsg = CMSG_FIRSTHDR(&msg);
-
-            /* store the received file descriptor */
-            *fd = *((int *) CMSG_DATA(cmsg));
+            if( ( cmsg != NULL ) &&
+                ( cmsg->cmsg_level == SOL_SOCKET ) &&
+                ( cmsg->cmsg_type == SCM_RIGHTS ) )
+            {
+                /* store the received file descriptor */
+                *fd = *((int *) CMSG_DATA(cmsg));
+            }
+            else
+            {
+                result = EBADMSG;
+            }
         }
     }
 
@@ -243,6 +329,7 @@ int VARPRINT_SendFileDescriptor( int responderPID, int fd )
     int sock;
     struct sockaddr_un addr;
     int result = EINVAL;
+    char data[1];
 
     /* Create a unix domain socket */
     sock = socket( AF_UNIX, SOCK_STREAM, 0 );
@@ -263,8 +350,11 @@ int VARPRINT_SendFileDescriptor( int responderPID, int fd )
             }
             else
             {
+                /* we always have to send at least one dummy data byte */
+                data[0] = ' ';
+
                 /* Receive the file descriptor */
-                result = varprint_SendFd(sock, fd );
+                result = varprint_SendFd( sock, data, sizeof(data), fd );
                 break;
             }
         }
@@ -407,6 +497,284 @@ int VARPRINT_ShutdownListener( pid_t requestorPID, int sock )
     return result;
 }
 
+/*============================================================================*/
+/*  VARPRINT_OpenChannelListener                                              */
+/*!
+    Start listening for print channels from requestors
+
+    The VARPRINT_OpenChannelListener function creates the long-lived
+    socket on which requestors connect their print channels to this
+    client.  The socket is only created the first time it is needed,
+    and persists until VARPRINT_CloseChannels is called.
+    The responder calls this function.
+
+@param[in]
+    gid
+        group identifier of the variable server group which is given
+        access to the listening socket
+
+@retval EOK the listener is ready
+@retval other indicates an errno
+
+==============================================================================*/
+int VARPRINT_OpenChannelListener( gid_t gid )
+{
+    int result = EOK;
+    struct sockaddr_un addr;
+    int s;
+
+    varprint_CheckOwner();
+
+    if( channelListener == -1 )
+    {
+        /* Create a unix domain socket which preserves message boundaries */
+        s = socket( AF_UNIX, SOCK_SEQPACKET, 0 );
+        if( s != -1 )
+        {
+            memset( &addr, 0, sizeof(addr) );
+            addr.sun_family = AF_UNIX;
+            sprintf( addr.sun_path, VARPRINT_CHANNEL_PATH, channelOwner );
+
+            /* remove a socket file left behind by a previous process */
+            unlink( addr.sun_path );
+
+            if( ( bind( s, (struct sockaddr *)&addr, sizeof(addr) ) == -1 ) ||
+                ( chown( addr.sun_path, -1, gid ) != 0 ) ||
+                ( chmod( addr.sun_path,
+                         S_IWUSR | S_IRUSR | S_IXUSR |
+                         S_IWGRP | S_IRGRP | S_IXGRP ) != 0 ) ||
+                ( listen( s, SOMAXCONN ) == -1 ) )
+            {
+                result = errno;
+                close( s );
+                unlink( addr.sun_path );
+            }
+            else
+            {
+                channelListener = s;
+            }
+        }
+        else
+        {
+            result = errno;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARPRINT_SendToChannel                                                    */
+/*!
+    Send a file descriptor to a responder over a print channel
+
+    The VARPRINT_SendToChannel function sends the output file
+    descriptor for a print session to the responder over the print
+    channel to that responder.  The channel is connected the first
+    time it is needed and then reused for subsequent print requests.
+    If a reused channel has been closed by the responder, it is
+    connected again once.
+    The requestor calls this function.
+
+@param[in]
+    responderPID
+        process identifier of the responder
+
+@param[in]
+    id
+        transaction identifier of the print session
+
+@param[in]
+    fd
+        the file descriptor to send
+
+@retval EOK the file descriptor was sent to the responder
+@retval other indicates errno from socket, connect, or sendmsg
+
+==============================================================================*/
+int VARPRINT_SendToChannel( pid_t responderPID, uint32_t id, int fd )
+{
+    int result = EINVAL;
+    PrintChannel *pChannel;
+    bool reused;
+    int sock;
+
+    varprint_CheckOwner();
+
+    if( responderPID > 0 )
+    {
+        pChannel = varprint_FindChannel( &responders, responderPID );
+        reused = ( pChannel != NULL );
+
+        do
+        {
+            if( pChannel == NULL )
+            {
+                /* connect a new channel to the responder */
+                result = varprint_Connect( responderPID, &sock );
+                if( result == EOK )
+                {
+                    pChannel = varprint_AddChannel( &responders,
+                                                    responderPID,
+                                                    sock );
+                    if( pChannel == NULL )
+                    {
+                        close( sock );
+                        result = ENOMEM;
+                    }
+                }
+            }
+
+            if( pChannel != NULL )
+            {
+                result = varprint_SendFd( pChannel->sock,
+                                          &id,
+                                          sizeof(id),
+                                          fd );
+                if( result != EOK )
+                {
+                    /* discard the failed channel */
+                    varprint_DropChannel( pChannel );
+                    pChannel = NULL;
+
+                    if( reused )
+                    {
+                        /* try again on a new channel */
+                        reused = false;
+                        continue;
+                    }
+                }
+            }
+
+            break;
+
+        } while( 1 );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARPRINT_ReceiveFromChannel                                               */
+/*!
+    Receive a file descriptor from a requestor over a print channel
+
+    The VARPRINT_ReceiveFromChannel function receives the output file
+    descriptor for the specified print session from the print channel
+    of the requestor.  New channels are accepted from the listener until
+    the requestor's channel is found.  File descriptors sent for other
+    print sessions which were abandoned are closed and discarded.
+    VARPRINT_OpenChannelListener must have been called before the
+    requestor was released to send the file descriptor.
+    The responder calls this function.
+
+@param[in]
+    requestorPID
+        process identifier of the requestor
+
+@param[in]
+    id
+        transaction identifier of the print session
+
+@param[out]
+    fd
+        pointer to the location to store the received file descriptor
+
+@retval EOK the file descriptor was successfully received
+@retval EINVAL invalid arguments or no listener
+@retval other indicates an errno
+
+==============================================================================*/
+int VARPRINT_ReceiveFromChannel( pid_t requestorPID, uint32_t id, int *fd )
+{
+    int result = EINVAL;
+    PrintChannel *pChannel;
+    uint32_t msgid;
+    int rxfd;
+
+    varprint_CheckOwner();
+
+    if( ( requestorPID > 0 ) &&
+        ( fd != NULL ) &&
+        ( channelListener != -1 ) )
+    {
+        pChannel = varprint_FindChannel( &requestors, requestorPID );
+
+        do
+        {
+            if( pChannel == NULL )
+            {
+                /* wait for the requestor to connect its channel */
+                result = varprint_Accept( requestorPID, &pChannel );
+                if( result != EOK )
+                {
+                    break;
+                }
+            }
+
+            msgid = 0;
+            rxfd = -1;
+            result = varprint_ReceiveFd( pChannel->sock,
+                                         &msgid,
+                                         sizeof(msgid),
+                                         &rxfd );
+            if( result != EOK )
+            {
+                /* the requestor closed the channel, it will connect
+                   a new one */
+                varprint_DropChannel( pChannel );
+                pChannel = NULL;
+            }
+            else if( msgid != id )
+            {
+                /* discard a file descriptor from an abandoned session */
+                close( rxfd );
+            }
+            else
+            {
+                *fd = rxfd;
+                break;
+            }
+
+        } while( 1 );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARPRINT_CloseChannels                                                    */
+/*!
+    Close all of the print channels
+
+    The VARPRINT_CloseChannels function closes all of the print
+    channels held by this client and shuts down and removes its print
+    channel listener.
+
+@retval EOK the print channels were closed
+
+==============================================================================*/
+int VARPRINT_CloseChannels( void )
+{
+    char path[108];
+
+    varprint_CheckOwner();
+
+    if( channelListener != -1 )
+    {
+        close( channelListener );
+        channelListener = -1;
+
+        sprintf( path, VARPRINT_CHANNEL_PATH, channelOwner );
+        unlink( path );
+    }
+
+    varprint_CloseTable( &responders );
+    varprint_CloseTable( &requestors );
+
+    return EOK;
+}
+
 /*============================================================================*/
 /*  varprint_SendFd                                                           */
 /*!
@@ -421,18 +789,29 @@ int VARPRINT_ShutdownListener( pid_t requestorPID, int sock )
     sock
         socket on which to send the credentials for the file descriptor
 
+@param[in]
+    data
+        pointer to the message data to send with the file descriptor.
+        At least one data byte must always be sent.
+
+@param[in]
+    len
+        length of the message data
+
 @param[in]
     fd
         file descriptor to send the credentials for
 
+@retval EOK the file descriptor was sent
+@retval other error result from sendmsg
+
 ==============================================================================*/
-static int varprint_SendFd( int sock, int fd )
+static int varprint_SendFd( int sock, void *data, size_t len, int fd )
 {
     struct msghdr msg;
     struct iovec iov[1];
     struct cmsghdr *cmsg = NULL;
     char ctrl_buf[CMSG_SPACE(sizeof(int))];
-    char data[1];
     int n;
     int result = EINVAL;
 
@@ -440,10 +819,9 @@ static int varprint_SendFd( int sock, int fd )
     memset(&msg, 0, sizeof(struct msghdr));
     memset(ctrl_buf, 0, CMSG_SPACE(sizeof(int)));
 
-    /* we always have to send at least one dummy data byte */
-    data[0] = ' ';
+    /* populate the message data */
     iov[0].iov_base = data;
-    iov[0].iov_len = sizeof(data);
+    iov[0].iov_len = len;
 
     /* construct the message header */
     msg.msg_name = NULL;
@@ -462,8 +840,9 @@ static int varprint_SendFd( int sock, int fd )
     /* put the file descriptor in the to CMSG data object */
     *((int *) CMSG_DATA(cmsg)) = fd;
 
-    /* send the message to the peer */
-    n = sendmsg(sock, &msg, 0);
+    /* send the message to the peer without raising SIGPIPE if the
+       peer has gone away */
+    n = sendmsg(sock, &msg, MSG_NOSIGNAL);
 
     /* determine of the send was successful */
     result = ( n >= 0 ) ? EOK : errno;
@@ -471,5 +850,337 @@ static int varprint_SendFd( int sock, int fd )
     return result;
 }
 
+/*============================================================================*/
+/*  varprint_CheckOwner                                                       */
+/*!
+    Make sure the print channels belong to this process
+
+    The varprint_CheckOwner function discards the print channels and
+    listener inherited from a parent process, since they belong to the
+    parent's print sessions.  The parent's listener socket file is
+    left in place.
+
+==============================================================================*/
+static void varprint_CheckOwner( void )
+{
+    pid_t pid = getpid();
+
+    if( channelOwner != pid )
+    {
+        if( channelListener != -1 )
+        {
+            close( channelListener );
+            channelListener = -1;
+        }
+
+        varprint_CloseTable( &responders );
+        varprint_CloseTable( &requestors );
+
+        channelOwner = pid;
+    }
+}
+
+/*============================================================================*/
+/*  varprint_FindChannel                                                      */
+/*!
+    Find the print channel for a peer
+
+    The varprint_FindChannel function searches a print channel table
+    for the channel connected to the specified peer process.
+
+@param[in]
+    pTable
+        pointer to the print channel table to search
+
+@param[in]
+    pid
+        process identifier of the peer
+
+@retval pointer to the print channel
+@retval NULL no channel is connected to the peer
+
+==============================================================================*/
+static PrintChannel *varprint_FindChannel( PrintChannels *pTable, pid_t pid )
+{
+    PrintChannel *pChannel = NULL;
+    size_t i;
+
+    if( pTable != NULL )
+    {
+        for( i = 0; i < pTable->n; i++ )
+        {
+            if( pTable->pChannels[i].pid == pid )
+            {
+                pChannel = &pTable->pChannels[i];
+                break;
+            }
+        }
+    }
+
+    return pChannel;
+}
+
+/*============================================================================*/
+/*  varprint_AddChannel                                                       */
+/*!
+    Add a print channel to a print channel table
+
+    The varprint_AddChannel function stores a connected print channel
+    in a free entry of the print channel table.  When the table is full
+    the channels whose peers have closed them are discarded, and if
+    there are none the table is doubled in size.  Open channels are
+    never evicted since they may hold a file descriptor which has not
+    been received yet.
+
+@param[in]
+    pTable
+        pointer to the print channel table
+
+@param[in]
+    pid
+        process identifier of the peer
+
+@param[in]
+    sock
+        connected socket of the channel
+
+@retval pointer to the added print channel
+@retval NULL the table could not be grown
+
+==============================================================================*/
+static PrintChannel *varprint_AddChannel( PrintChannels *pTable,
+                                          pid_t pid,
+                                          int sock )
+{
+    PrintChannel *pChannel;
+    PrintChannel *pChannels;
+    size_t n;
+    size_t i;
+    char c;
+
+    pChannel = varprint_FindChannel( pTable, 0 );
+    if( pChannel == NULL )
+    {
+        /* discard the channels which have been closed by their peers */
+        for( i = 0; i < pTable->n; i++ )
+        {
+            if( recv( pTable->pChannels[i].sock,
+                      &c,
+                      sizeof(c),
+                      MSG_PEEK | MSG_DONTWAIT ) == 0 )
+            {
+                varprint_DropChannel( &pTable->pChannels[i] );
+            }
+        }
+
+        pChannel = varprint_FindChannel( pTable, 0 );
+    }
+
+    if( pChannel == NULL )
+    {
+        /* grow the table */
+        n = ( pTable->n == 0 ) ? VARPRINT_INITIAL_CHANNELS : 2 * pTable->n;
+        pChannels = realloc( pTable->pChannels, n * sizeof(PrintChannel) );
+        if( pChannels != NULL )
+        {
+            memset( &pChannels[pTable->n],
+                    0,
+                    ( n - pTable->n ) * sizeof(PrintChannel) );
+
+            pChannel = &pChannels[pTable->n];
+            pTable->pChannels = pChannels;
+            pTable->n = n;
+        }
+    }
+
+    if( pChannel != NULL )
+    {
+        pChannel->pid = pid;
+        pChannel->sock = sock;
+    }
+
+    return pChannel;
+}
+
+/*============================================================================*/
+/*  varprint_DropChannel                                                      */
+/*!
+    Close a print channel
+
+    The varprint_DropChannel function closes the socket of a print
+    channel and frees its print channel table entry.
+
+@param[in]
+    pChannel
+        pointer to the print channel to close
+
+==============================================================================*/
+static void varprint_DropChannel( PrintChannel *pChannel )
+{
+    if( ( pChannel != NULL ) &&
+        ( pChannel->pid != 0 ) )
+    {
+        close( pChannel->sock );
+        pChannel->sock = -1;
+        pChannel->pid = 0;
+    }
+}
+
+/*============================================================================*/
+/*  varprint_CloseTable                                                       */
+/*!
+    Close all the print channels in a print channel table
+
+    The varprint_CloseTable function closes every channel in the
+    print channel table and releases the table memory.
+
+@param[in]
+    pTable
+        pointer to the print channel table
+
+==============================================================================*/
+static void varprint_CloseTable( PrintChannels *pTable )
+{
+    size_t i;
+
+    for( i = 0; i < pTable->n; i++ )
+    {
+        varprint_DropChannel( &pTable->pChannels[i] );
+    }
+
+    free( pTable->pChannels );
+    pTable->pChannels = NULL;
+    pTable->n = 0;
+}
+
+/*============================================================================*/
+/*  varprint_Connect                                                          */
+/*!
+    Connect a print channel to a responder
+
+    The varprint_Connect function connects a new print channel to the
+    print channel listener of the responder.
+
+@param[in]
+    responderPID
+        process identifier of the responder
+
+@param[out]
+    sock
+        pointer to the location to store the connected socket
+
+@retval EOK the print channel was connected
+@retval other indicates errno from socket or connect
+
+==============================================================================*/
+static int varprint_Connect( pid_t responderPID, int *sock )
+{
+    int result = EINVAL;
+    struct sockaddr_un addr;
+    int s;
+
+    s = socket( AF_UNIX, SOCK_SEQPACKET, 0 );
+    if( s != -1 )
+    {
+        memset( &addr, 0, sizeof(addr) );
+        addr.sun_family = AF_UNIX;
+        sprintf( addr.sun_path, VARPRINT_CHANNEL_PATH, responderPID );
+
+        if( connect( s, (struct sockaddr *)&addr, sizeof(addr) ) != -1 )
+        {
+            *sock = s;
+            result = EOK;
+        }
+        else
+        {
+            result = errno;
+            close( s );
+        }
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varprint_Accept                                                           */
+/*!
+    Accept print channels until the requestor's channel arrives
+
+    The varprint_Accept function accepts new print channels from the
+    listener, and stores each one in the requestor channel table under
+    the process identifier of the peer which connected it, until the
+    channel of the specified requestor is accepted.
+
+@param[in]
+    requestorPID
+        process identifier of the requestor
+
+@param[out]
+    ppChannel
+        pointer to the location to store the requestor's print channel
+
+@retval EOK the requestor's print channel was accepted
+@retval ENOMEM the requestor channel table could not be grown
+@retval other indicates errno from accept
+
+==============================================================================*/
+static int varprint_Accept( pid_t requestorPID, PrintChannel **ppChannel )
+{
+    int result = EINVAL;
+    PrintChannel *pChannel = NULL;
+    struct ucred cred;
+    socklen_t len;
+    int conn;
+
+    while( pChannel == NULL )
+    {
+        conn = accept( channelListener, NULL, 0 );
+        if( conn == -1 )
+        {
+            result = errno;
+            break;
+        }
+
+        len = sizeof(cred);
+        if( getsockopt( conn,
+                        SOL_SOCKET,
+                        SO_PEERCRED,
+                        &cred,
+                        &len ) == -1 )
+        {
+            close( conn );
+            continue;
+        }
+
+        /* replace any older channel from the same peer */
+        varprint_DropChannel( varprint_FindChannel( &requestors, cred.pid ) );
+
+        pChannel = varprint_AddChannel( &requestors, cred.pid, conn );
+        if( pChannel == NULL )
+        {
+            close( conn );
+            result = ENOMEM;
+            break;
+        }
+
+        if( cred.pid != requestorPID )
+        {
+            /* keep the channel for a later print session */
+            pChannel = NULL;
+        }
+        else
+        {
+            *ppChannel = pChannel;
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
 /*! @}
  * end of varprint group */
@@ -82,6 +82,17 @@ static int varquery_AddCacheUnique( VARSERVER_HANDLE hVarServer,
 
 static int varquery_PrintType( int fd, VarType type );
 
+static void varquery_Init( VarQuery *pVarQuery,
+                           int searchType,
+                           char *match,
+                           char *tagspec,
+                           uint32_t instanceID,
+                           uint32_t flags );
+
+static void varquery_DumpRecord( VARSERVER_HANDLE hVarServer,
+                                 VarQueryRecord *pRecord,
+                                 FILE *fp );
+
 
 /*==============================================================================
         Function definitions
@@ -103,7 +114,7 @@ static int varquery_PrintType( int fd, VarType type );
         searchType
             a bitfield indicating the type of search to perform.
             Contains one or more of the following OR'd together:
-                QUERY_REGEX or QUERY_MATCH
+                QUERY_REGEX or QUERY_MATCH or QUERY_PREFIX
                 QUERY_FLAGS
                 QUERY_TAGS
                 QUERY_INSTANCEID
@@ -112,7 +123,9 @@ static int varquery_PrintType( int fd, VarType type );
         match
             string to use for variable name matching.  This is used
             if one of these search types is specified: QUERY_REGEX,
-            QUERY_MATCH, otherwise this parameter is ignored.
+            QUERY_MATCH, QUERY_PREFIX, otherwise this parameter is ignored.
+            A QUERY_MATCH string which starts with '/' is a literal path
+            and is searched as a QUERY_PREFIX using the server name index.
 
     @param[in]
         tagspec
@@ -142,52 +155,173 @@ int VARQUERY_Search( VARSERVER_HANDLE hVarServer,
 {
     int result = EINVAL;
     VarQuery query;
-    size_t len;
+    VarQueryPage *pPage;
+    VarQueryRecord *pRecord;
+    size_t pageSize;
+    int count = 0;
 
-    memset( &query, 0, sizeof( VarQuery ) );
+    varquery_Init( &query, searchType, match, tagspec, instanceID, flags );
 
-    query.type = searchType;
-    query.instanceID = instanceID;
-    query.match = match;
-    query.flags = flags;
+    /* get the results a page at a time */
+    pageSize = VARSERVER_GetWorkingBufferLength( hVarServer );
+    pPage = ( pageSize > 0 ) ? malloc( pageSize ) : NULL;
+    if ( pPage == NULL )
+    {
+        return ( pageSize > 0 ) ? ENOMEM : EINVAL;
+    }
 
-    if ( tagspec != NULL )
+    do
     {
-        len = strlen( tagspec );
-        if ( len < MAX_TAGSPEC_LEN )
+        result = VAR_GetPage( hVarServer, &query, pPage, pageSize );
+
+        pRecord = NULL;
+        while ( ( result == EOK ) &&
+                ( ( pRecord = VAR_GetPageRecord( pPage, pRecord ) ) != NULL ) )
         {
-            strcpy( query.tagspec, tagspec );
+            if ( pRecord->instanceID == 0 )
+            {
+                dprintf(fd, "%s", pRecord->name );
+            }
+            else
+            {
+                dprintf(fd, "[%d]%s", pRecord->instanceID, pRecord->name );
+            }
+
+            if ( searchType & QUERY_SHOWTYPE )
+            {
+                dprintf(fd, "(" );
+                varquery_PrintType( fd, pRecord->var.type );
+                dprintf(fd, ")" );
+            }
+
+            if( searchType & QUERY_SHOWVALUE )
+            {
+                dprintf(fd, "=" );
+                VAR_PrintRecord( hVarServer, pRecord, fd );
+            }
+
+            dprintf(fd, "\n");
+
+            count++;
         }
+    } while ( ( result == EOK ) && ( query.context != 0 ) );
+
+    free( pPage );
+
+    if ( ( result == EOK ) && ( count == 0 ) )
+    {
+        result = ENOENT;
     }
 
-    result = VAR_GetFirst( hVarServer, &query, NULL );
-    while ( result == EOK )
+    return result;
+}
+
+/*============================================================================*/
+/*  VARQUERY_Dump                                                             */
+/*!
+    Dump the values of variables
+
+    The VARQUERY_Dump function searches for variables using the
+    specified criteria and writes a name=value line for each of them
+    to the specified output.  The results are retrieved a page at a
+    time and written as each page arrives, using buffered output.
+    Values are written without their format specifiers, so the output
+    can be fed back into setvar -s.
+
+    @param[in]
+        hVarServer
+            handle to the Variable Server
+
+    @param[in]
+        searchType
+            a bitfield indicating the type of search to perform,
+            as for VARQUERY_Search.  A searchType of 0 matches all
+            variables.
+
+    @param[in]
+        match
+            string to use for variable name matching, as for
+            VARQUERY_Search
+
+    @param[in]
+        tagspec
+            comma separated list of tags to search for
+
+    @param[in]
+        instanceID
+            used for instance ID matching if QUERY_INSTANCEID is specified,
+            otherwise it is ignored.
+
+    @param[in]
+        flags
+            used for flags matching if QUERY_FLAGS is specified,
+            otherwise it is ignored.
+
+    @param[in]
+        fd
+            output stream for variable data
+
+    @retval EOK - variable dump was successful
+    @retval ENOMEM - memory allocation failed
+    @retval EINVAL - invalid arguments
+    @retval ENOENT - no variables matched the search criteria
+
+==============================================================================*/
+int VARQUERY_Dump( VARSERVER_HANDLE hVarServer,
+                   int searchType,
+                   char *match,
+                   char *tagspec,
+                   uint32_t instanceID,
+                   uint32_t flags,
+                   int fd )
+{
+    int result = EINVAL;
+    VarQuery query;
+    VarQueryPage *pPage;
+    VarQueryRecord *pRecord;
+    size_t pageSize;
+    FILE *fp;
+    int count = 0;
+
+    varquery_Init( &query, searchType, match, tagspec, instanceID, flags );
+
+    pageSize = VARSERVER_GetWorkingBufferLength( hVarServer );
+    if ( pageSize > 0 )
     {
-        if ( query.instanceID == 0 )
-        {
-            dprintf(fd, "%s", query.name );
-        }
-        else
-        {
-            dprintf(fd, "[%d]%s", query.instanceID, query.name );
-        }
+        pPage = malloc( pageSize );
+        fp = fdopen( dup( fd ), "w" );
+        result = ( ( pPage != NULL ) && ( fp != NULL ) ) ? EOK : ENOMEM;
 
-        if ( searchType & QUERY_SHOWTYPE )
+        while ( result == EOK )
         {
-            dprintf(fd, "(" );
-            varquery_PrintType( fd, query.vartype );
-            dprintf(fd, ")" );
+            result = VAR_GetPage( hVarServer, &query, pPage, pageSize );
+
+            pRecord = NULL;
+            while ( ( result == EOK ) &&
+                    ( ( pRecord = VAR_GetPageRecord( pPage,
+                                                     pRecord ) ) != NULL ) )
+            {
+                varquery_DumpRecord( hVarServer, pRecord, fp );
+                count++;
+            }
+
+            if ( query.context == 0 )
+            {
+                break;
+            }
         }
 
-        if( searchType & QUERY_SHOWVALUE )
+        if ( fp != NULL )
         {
-            dprintf(fd, "=" );
-            VAR_Print( hVarServer, query.hVar, fd );
+            fclose( fp );
         }
 
-        dprintf(fd, "\n");
+        free( pPage );
+    }
 
-        result = VAR_GetNext( hVarServer, &query, NULL );
+    if ( ( result == EOK ) && ( count == 0 ) )
+    {
+        result = ENOENT;
     }
 
     return result;
@@ -236,19 +370,42 @@ int VARQUERY_Map( VARSERVER_HANDLE hVarServer,
     int result = EINVAL;
     int errcount = 0;
     int count = 0;
-    int rc;
+    int rc = EINVAL;
+    VarQueryPage *pPage = NULL;
+    VarQueryRecord *pRecord;
+    size_t pageSize;
+
+    pageSize = VARSERVER_GetWorkingBufferLength( hVarServer );
+    if ( pageSize > 0 )
+    {
+        pPage = malloc( pageSize );
+    }
 
     if ( ( pVarQuery != NULL ) &&
-         ( mapfn != NULL ) )
+         ( mapfn != NULL ) &&
+         ( pPage != NULL ) )
     {
-        /* get the first variable which matches the search criteria */
-        result = VAR_GetFirst( hVarServer, pVarQuery, NULL );
-        while ( result == EOK )
+        /* get the variables which match the search criteria
+           a page at a time */
+        pVarQuery->context = 0;
+        do
         {
-            if ( pVarQuery->hVar != VAR_INVALID )
+            result = VAR_GetPage( hVarServer, pVarQuery, pPage, pageSize );
+
+            pRecord = NULL;
+            while ( ( result == EOK ) &&
+                    ( ( pRecord = VAR_GetPageRecord( pPage,
+                                                     pRecord ) ) != NULL ) )
             {
-                /* add the found variable to the cache */
-                rc = mapfn( hVarServer, pVarQuery->hVar, arg );
+                /* report the found variable in the query object */
+                pVarQuery->hVar = pRecord->hVar;
+                pVarQuery->instanceID = pRecord->instanceID;
+                pVarQuery->vartype = pRecord->var.type;
+                strncpy( pVarQuery->name, pRecord->name, MAX_NAME_LEN );
+                pVarQuery->name[MAX_NAME_LEN] = 0;
+
+                /* apply the map function to the found variable */
+                rc = mapfn( hVarServer, pRecord->hVar, arg );
                 if ( rc == EOK )
                 {
                     count++;
@@ -258,10 +415,12 @@ int VARQUERY_Map( VARSERVER_HANDLE hVarServer,
                     errcount++;
                 }
             }
+        } while ( ( result == EOK ) && ( pVarQuery->context != 0 ) );
+    }
 
-            /* get the next variable which matches the search criteria */
-            result = VAR_GetNext( hVarServer, pVarQuery, NULL );
-        }
+    if ( pPage != NULL )
+    {
+        free( pPage );
     }
 
     if ( errcount == 0 )
@@ -533,5 +692,157 @@ static int varquery_PrintType( int fd, VarType type )
     return result;
 }
 
+/*============================================================================*/
+/*  varquery_Init                                                             */
+/*!
+    Initialize a variable query
+
+    The varquery_Init function populates a VarQuery object from the
+    search criteria used by VARQUERY_Search and VARQUERY_Dump.  A
+    QUERY_MATCH string which starts with '/' is converted into a
+    QUERY_PREFIX search.
+
+    @param[out]
+        pVarQuery
+            pointer to the VarQuery object to initialize
+
+    @param[in]
+        searchType
+            a bitfield indicating the type of search to perform
+
+    @param[in]
+        match
+            string to use for variable name matching
+
+    @param[in]
+        tagspec
+            comma separated list of tags to search for, or NULL
+
+    @param[in]
+        instanceID
+            instance identifier to search for
+
+    @param[in]
+        flags
+            flags to search for
+
+==============================================================================*/
+static void varquery_Init( VarQuery *pVarQuery,
+                           int searchType,
+                           char *match,
+                           char *tagspec,
+                           uint32_t instanceID,
+                           uint32_t flags )
+{
+    size_t len;
+
+    memset( pVarQuery, 0, sizeof( VarQuery ) );
+
+    if ( ( searchType & QUERY_MATCH ) &&
+         ( match != NULL ) &&
+         ( match[0] == '/' ) )
+    {
+        /* a literal path is matched as a prefix of the variable name
+           so only the matching subtree of the name index is searched */
+        searchType &= ~QUERY_MATCH;
+        searchType |= QUERY_PREFIX;
+    }
+
+    pVarQuery->type = searchType;
+    pVarQuery->instanceID = instanceID;
+    pVarQuery->match = match;
+    pVarQuery->flags = flags;
+
+    if ( tagspec != NULL )
+    {
+        len = strlen( tagspec );
+        if ( len < MAX_TAGSPEC_LEN )
+        {
+            strcpy( pVarQuery->tagspec, tagspec );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  varquery_DumpRecord                                                       */
+/*!
+    Write a name=value line for a query result record
+
+    The varquery_DumpRecord function writes the name and unformatted
+    value of a query result record to the output stream.  If the
+    record does not contain the value (for example the variable is
+    calculated, or is a blob) the value is requested from the
+    variable server using VAR_Get.
+
+    @param[in]
+        hVarServer
+            handle to the Variable Server
+
+    @param[in]
+        pRecord
+            pointer to the query result record
+
+    @param[in]
+        fp
+            output stream
+
+==============================================================================*/
+static void varquery_DumpRecord( VARSERVER_HANDLE hVarServer,
+                                 VarQueryRecord *pRecord,
+                                 FILE *fp )
+{
+    VarObject obj;
+    VarObject *pVarObject = &pRecord->var;
+    char buf[64];
+    int rc = EOK;
+
+    if ( pRecord->instanceID == 0 )
+    {
+        fprintf( fp, "%s=", pRecord->name );
+    }
+    else
+    {
+        fprintf( fp, "[%d]%s=", pRecord->instanceID, pRecord->name );
+    }
+
+    if ( ( pRecord->result != EOK ) ||
+         ( pRecord->var.type == VARTYPE_BLOB ) )
+    {
+        memset( &obj, 0, sizeof( VarObject ) );
+        rc = VAR_Get( hVarServer, pRecord->hVar, &obj );
+        pVarObject = &obj;
+    }
+
+    if ( rc != EOK )
+    {
+        /* leave the value empty */
+    }
+    else if ( pVarObject->type == VARTYPE_STR )
+    {
+        if ( pVarObject->val.str != NULL )
+        {
+            fputs( pVarObject->val.str, fp );
+        }
+    }
+    else if ( VAROBJECT_ToString( pVarObject, buf, sizeof( buf ) ) == EOK )
+    {
+        fputs( buf, fp );
+    }
+
+    fputc( '\n', fp );
+
+    if ( ( pVarObject == &obj ) && ( rc == EOK ) )
+    {
+        if ( obj.type == VARTYPE_STR )
+        {
+            free( obj.val.str );
+        }
+        else if ( obj.type == VARTYPE_BLOB )
+        {
+            free( obj.val.blob );
+        }
+    }
+}
+
 /*! @}
  * end of varquery group */
@@ -58,6 +58,8 @@ SOFTWARE.
 #include <sys/syslog.h>
 #include <sys/stat.h>
 #include <sys/signalfd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include <fcntl.h>
 #include <ctype.h>
 #include <mqueue.h>
@@ -73,12 +75,76 @@ SOFTWARE.
 #include <varserver/varprint.h>
 #include <varserver/var.h>
 
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! the request is not in use */
+#define VAR_ASYNC_IDLE  ( 0 )
+
+/*! the request is waiting for the server */
+#define VAR_ASYNC_BUSY  ( 1 )
+
+/*! the request is complete and waiting to be collected */
+#define VAR_ASYNC_DONE  ( 2 )
+
+/*! The VarAsyncRequest object tracks a request of an asynchronous
+    request context.  Each request has its own server connection */
+typedef struct _VarAsyncRequest
+{
+    /*! connection the request is sent over */
+    VarClient *pVarClient;
+
+    /*! state of the request: VAR_ASYNC_IDLE, VAR_ASYNC_BUSY or
+        VAR_ASYNC_DONE */
+    int state;
+
+    /*! type of request */
+    VarRequest requestType;
+
+    /*! handle of the variable */
+    VAR_HANDLE hVar;
+
+    /*! var object supplied with the request */
+    VarObject *pVarObject;
+
+    /*! caller defined tag */
+    void *tag;
+
+    /*! result of the request */
+    int result;
+
+    /*! indicates the request has been sent again with a larger
+        working buffer */
+    bool retried;
+
+} VarAsyncRequest;
+
+/*! The VarAsync object is an asynchronous request context */
+struct _VarAsync
+{
+    /*! root connection of the client */
+    VarClient *pRoot;
+
+    /*! completion signal file descriptor */
+    int fd;
+
+    /*! number of requests */
+    size_t depth;
+
+    /*! number of requests which have not been collected */
+    size_t inflight;
+
+    /*! array of depth requests */
+    VarAsyncRequest *pRequests;
+};
+
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
 
 static int varserver_connect( VarClient *pVarClient );
-static VarClient *NewClient( size_t workbufsize );
+static VarClient *NewClient( size_t workbufsize, int shard, int channel );
 static int varserver_GetGroupList( VarClient *pVarClient );
 static int ClientCleanup( VarClient *pVarClient );
 static int DeleteClientSemaphore( VarClient *pVarClient );
@@ -90,18 +156,86 @@ static int var_GetBlobObjectFromWorkbuf( VarClient *pVarClient,
                                          VarObject *pVarObject );
 static int var_GetStringObjectFromWorkbuf( VarClient *pVarClient,
                                            VarObject *pVarObject );
+static int var_Modify( VarClient *pVarClient,
+                       VAR_HANDLE hVar,
+                       VarModifyOp op,
+                       VarObject *pOperand,
+                       VarObject *pExpected,
+                       VarObject *pOld );
 static int var_CopyStringVarObjectToWorkbuf( VarClient *pVarClient,
                                              VarObject *pVarObject );
 static int var_CopyBlobVarObjectToWorkbuf( VarClient *pVarClient,
                                         VarObject *pVarObject );
+static int var_GrowWorkbuf( VarClient *pVarClient, size_t len );
 
 static void DeleteClientQueue( VarClient *pVarClient );
 
 static int var_parseName( char *dst, size_t len, char *src, uint32_t *id );
+static int var_MapSharedValues( VarClient *pVarClient );
+static int var_MapVersions( VarClient *pVarClient );
+static NameCacheEntry *var_NameCacheEntry( VarClient *pVarClient,
+                                           const char *pName );
+static int var_GetSharedValue( VarClient *pVarClient,
+                               VAR_HANDLE hVar,
+                               VarObject *pVarObject );
+static int var_GetBatchObject( VarClient *pVarClient,
+                               VarBatchItem *pItem,
+                               VarObject *pVarObject );
+static size_t var_PackCreateBatch( VarClient *pVarClient,
+                                   VarInfo *pVarInfo,
+                                   size_t n );
+static size_t var_PackSetBatch( VarClient *pVarClient,
+                                VAR_HANDLE *hVars,
+                                VarObject *pVarObjects,
+                                size_t n );
+static void var_RingCopy( ChangeRing *pRing,
+                          uint64_t offset,
+                          void *dst,
+                          size_t len );
+static VAR_HANDLE var_FindRingSubscription( VarClient *pVarClient,
+                                            uint32_t storageRef );
+static int var_AddRingSubscription( VarClient *pVarClient,
+                                    VAR_HANDLE hVar,
+                                    uint32_t storageRef );
+static void var_RemoveRingSubscription( VarClient *pVarClient,
+                                        VAR_HANDLE hVar );
+static void var_DiscoverShards( VarClient *pVarClient );
+static void var_CloseShards( VarClient *pVarClient );
+static int var_NameShard( VarClient *pVarClient, char *pName );
+static VarClient *var_Shard( VarClient *pVarClient, int shard );
+static VarClient *var_Route( VarClient *pVarClient, VAR_HANDLE *phVar );
+static VAR_HANDLE var_ShardHandle( VarClient *pVarClient, VAR_HANDLE hVar );
+static int var_NextShard( VarClient *pVarClient, int shard );
+static void var_TagSignal( int sig, pid_t pid, int *sigval );
+static int var_GetFirst( VarClient *pVarClient,
+                         VarQuery *query,
+                         VarObject *obj );
+static int var_GetNext( VarClient *pVarClient,
+                        VarQuery *query,
+                        VarObject *obj );
+static int var_QueryShards( VarClient *pVarClient,
+                            VarQuery *query,
+                            VarObject *obj,
+                            int result );
+static int var_AsyncNewRequest( VarAsync *pVarAsync,
+                                VAR_HANDLE hVar,
+                                VarAsyncRequest **ppRequest );
+static int var_AsyncSubmit( VarAsync *pVarAsync, VarAsyncRequest *pRequest );
+static void var_AsyncFinish( VarAsyncRequest *pRequest );
+static void var_AsyncWake( void );
 
 /*==============================================================================
         File scoped variables
 ==============================================================================*/
+
+/*! process identifiers of the shard servers this process is connected
+    to, used to identify the shard which sent a signal */
+static pid_t shardPIDs[VARSERVER_MAX_SHARDS] = {0};
+
+/*! number of asynchronous request connections opened by this process,
+    used to give each connection a unique channel index */
+static int asyncChannels = 0;
+
 static const char *flagNames[] =
 {
     "none",
@@ -114,6 +248,7 @@ static const char *flagNames[] =
     "audit",
     "password",
     "alias",
+    "history",
     NULL
 };
 
@@ -184,14 +319,48 @@ VARSERVER_HANDLE VARSERVER_Open( void )
 
 ==============================================================================*/
 VARSERVER_HANDLE VARSERVER_OpenExt( size_t workbufsize )
+{
+    return VARSERVER_OpenPriority( workbufsize, VARSERVER_PRIORITY_NORMAL );
+}
+
+/*============================================================================*/
+/*  VARSERVER_OpenPriority                                                    */
+/*!
+    Open a connection to the variable server with a request priority
+
+    The VARSERVER_OpenPriority function is used by the variable server
+    clients to connect to the variable server with a custom working
+    buffer size and request priority class.  The server services the
+    requests of VARSERVER_PRIORITY_HIGH clients ahead of those of
+    VARSERVER_PRIORITY_NORMAL clients, so a control loop is not delayed
+    by bulk queries.  The high priority class is only granted to root
+    and the user running the variable server; other clients are
+    connected at normal priority.  VARSERVER_GetPriority reports the
+    class which was granted.
+
+    @param[in]
+        workbufsize
+            specifies the size of the client-server working buffer
+
+    @param[in]
+        priority
+            requested priority class (VARSERVER_PRIORITY_*)
+
+    @retval a handle to the variable server
+    @retval NULL if the variable server could not be opened
+
+==============================================================================*/
+VARSERVER_HANDLE VARSERVER_OpenPriority( size_t workbufsize, int priority )
 {
     VarClient *pTempVarClient = NULL;
     VarClient *pVarClient = NULL;
 
     /* create a new client instance */
-    pTempVarClient = NewClient( workbufsize );
+    pTempVarClient = NewClient( workbufsize, 0, 0 );
     if( pTempVarClient != NULL )
     {
+        pTempVarClient->priority = priority;
+
         sigemptyset(&pTempVarClient->mask);
         sigaddset(&pTempVarClient->mask, SIG_CLIENT_RESPONSE );
         sigprocmask(SIG_BLOCK, &pTempVarClient->mask, NULL );
@@ -208,6 +377,10 @@ VARSERVER_HANDLE VARSERVER_OpenExt( size_t workbufsize )
             if ( pTempVarClient->clientid != 0 )
             {
                 pVarClient = pTempVarClient;
+
+                /* find the shard servers which own parts of the
+                   variable name space */
+                var_DiscoverShards( pVarClient );
             }
         }
     }
@@ -287,129 +460,161 @@ static int varserver_connect( VarClient *pVarClient )
 }
 
 /*============================================================================*/
-/*  VARSERVER_UpdateUser                                                      */
+/*  var_DiscoverShards                                                        */
 /*!
-    Update the effective user id for the varserver client
+    Find the running shard servers
 
-    The VARSERVER_UpdateUser function updates the effective user identifier
-    for the varserver client.  This user is used to determine read/write
-    access to the varserver variables.
-
-    This is done automatically when the varserver client is created,
-    it is only necessary to change this if the effective user
-    needs to be changed at runtime.
+    The var_DiscoverShards function maps the server information of each
+    shard server which is running when the root connection is opened.
+    The connections to the shard servers are not opened until they are
+    first used.  Shard servers which are started later are not used by
+    this connection.
 
     @param[in]
-        hVarServer
-            handle to the variable server client
-
-    @retval EOK the user id update was successful
-    @retval E2BIG the user is a member of too many groups
-    @retval EINVAL invalid argument
+        pVarClient
+            pointer to the root connection
 
 ==============================================================================*/
-int VARSERVER_UpdateUser( VARSERVER_HANDLE hVarServer )
+static void var_DiscoverShards( VarClient *pVarClient )
 {
-    int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    char name[BUFSIZ];
+    ServerInfo *pServerInfo;
+    int shard;
+    int fd;
 
     if ( pVarClient != NULL )
     {
-        pVarClient->uid = geteuid();
-        result = varserver_GetGroupList( pVarClient );
+        for ( shard = 1; shard < VARSERVER_MAX_SHARDS; shard++ )
+        {
+            ShardName( name, sizeof( name ), SERVER_SHAREDMEM, shard );
+            fd = shm_open( name, O_RDONLY, S_IRUSR | S_IWUSR );
+            if ( fd != -1 )
+            {
+                pServerInfo = (ServerInfo *)mmap( NULL,
+                                                  sizeof(ServerInfo),
+                                                  PROT_READ,
+                                                  MAP_SHARED,
+                                                  fd,
+                                                  0 );
+                close( fd );
+
+                if ( pServerInfo == MAP_FAILED )
+                {
+                    /* the shard is not available */
+                }
+                else if ( ( pServerInfo->shard == shard ) &&
+                          ( pServerInfo->prefix[0] == '/' ) &&
+                          ( ( kill( pServerInfo->pid, 0 ) == 0 ) ||
+                            ( errno == EPERM ) ) )
+                {
+                    pVarClient->pShardInfo[shard] = pServerInfo;
+                }
+                else
+                {
+                    /* the shard server is no longer running */
+                    munmap( pServerInfo, sizeof(ServerInfo) );
+                }
+            }
+        }
     }
-
-    return result;
 }
 
 /*============================================================================*/
-/*  VARSERVER_SetGroup                                                        */
+/*  var_CloseShards                                                           */
 /*!
-    Set the calling process' group so we can access varserver client sockets
+    Close the connections to the shard servers
 
-    The VARSERVER_SetGroup function sets the effective group id of the
-    calling process so we can access varserver client sockets
-    (used for client variable rendering)
+    The var_CloseShards function closes the connections to the shard
+    servers which were opened by the root connection, and unmaps the
+    shard server information.
 
-    @retval EOK group set ok
-    @retval other error from setegid
+    @param[in]
+        pVarClient
+            pointer to the root connection
 
 ==============================================================================*/
-int VARSERVER_SetGroup( void )
+static void var_CloseShards( VarClient *pVarClient )
 {
-    int result = EINVAL;
-    struct group *grp;
+    VarClient *pShard;
+    int shard;
 
-    grp = getgrnam( VARSERVER_GROUP_NAME);
-    if ( grp != NULL )
+    if ( pVarClient != NULL )
     {
-        result = ( setegid( grp->gr_gid ) == 0 ) ? EOK : errno;
-    }
+        for ( shard = 1; shard < VARSERVER_MAX_SHARDS; shard++ )
+        {
+            pShard = pVarClient->pShards[shard];
+            if ( pShard != NULL )
+            {
+                pShard->requestType = VARREQUEST_CLOSE;
+                ClientRequest( pShard, SIG_CLIENT_REQUEST );
+                ClientCleanup( pShard );
 
-    return result;
+                pVarClient->pShards[shard] = NULL;
+                shardPIDs[shard] = 0;
+            }
+
+            if ( pVarClient->pShardInfo[shard] != NULL )
+            {
+                munmap( pVarClient->pShardInfo[shard], sizeof(ServerInfo) );
+                pVarClient->pShardInfo[shard] = NULL;
+            }
+        }
+    }
 }
 
 /*============================================================================*/
-/*  VARSERVER_CreateClientQueue                                               */
+/*  var_NameShard                                                             */
 /*!
-    Create a new client notification queue
-
-    The VARSERVER_CreateClientQueue function creates a new client notification
-    queue to receive variable modified notifications from the server.
+    Get the shard which owns a variable name
 
-    @param[in]
-        hVarServer
-            handle to the variable server
+    The var_NameShard function finds the shard server with the longest
+    name prefix which the specified variable name falls under.  Names
+    which are not owned by a shard server belong to the root server.
+    Any instance identifier prefix (eg [123]) on the name is ignored.
 
     @param[in]
-        queuelen
-            max number of queued messages.  -1 = use default
+        pVarClient
+            pointer to the root connection
 
     @param[in]
-        msgsize
-            max number of queueud messages. -1 = use default;
+        pName
+            pointer to the variable name
 
-    @retval EOK the new client queue was successfully created
-    @retval EINVAL an invalid variable client was specified
-    @retval other error from mq_open()
+    @retval index of the shard which owns the name
 
 ==============================================================================*/
-int VARSERVER_CreateClientQueue( VARSERVER_HANDLE hVarServer,
-                                 long queuelen,
-                                 long msgsize )
+static int var_NameShard( VarClient *pVarClient, char *pName )
 {
-    int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
-    char clientname[BUFSIZ];
-    struct mq_attr attr;
+    int result = 0;
+    size_t longest = 0;
+    ServerInfo *pServerInfo;
+    char *p;
+    size_t len;
+    int shard;
 
-    if( pVarClient != NULL )
+    if ( ( pVarClient != NULL ) &&
+         ( pName != NULL ) )
     {
-        /* build the varclient identifier */
-        sprintf(clientname, "/varclient_%d", pVarClient->client_pid);
-
-        attr.mq_flags = 0;
-        attr.mq_maxmsg = queuelen == -1 ? VARSERVER_MAX_NOTIFICATION_MSG_COUNT
-                                        : queuelen;
-        attr.mq_msgsize = msgsize == -1 ? VARSERVER_MAX_NOTIFICATION_MSG_SIZE
-                                        : msgsize;
-        attr.mq_curmsgs = 0;
-
-        pVarClient->notificationQ = mq_open( clientname,
-                                             O_RDONLY | O_CREAT | O_NONBLOCK,
-                                             0644,
-                                             &attr );
+        /* skip the instance identifier */
+        p = ( pName[0] == '[' ) ? strchr( pName, ']' ) : NULL;
+        pName = ( p != NULL ) ? p + 1 : pName;
 
-        if ( pVarClient->notificationQ == -1 )
-        {
-            printf( "Failed to create queue %s : %s\n",
-                    clientname,
-                    strerror(errno));
-            result = errno;
-        }
-        else
+        for ( shard = 1; shard < VARSERVER_MAX_SHARDS; shard++ )
         {
-            result = EOK;
+            pServerInfo = pVarClient->pShardInfo[shard];
+            if ( pServerInfo != NULL )
+            {
+                len = strnlen( pServerInfo->prefix, MAX_NAME_LEN );
+                if ( ( len > longest ) &&
+                     ( strncmp( pName, pServerInfo->prefix, len ) == 0 ) &&
+                     ( ( pName[len] == '/' ) ||
+                       ( pName[len] == 0 ) ||
+                       ( pServerInfo->prefix[len-1] == '/' ) ) )
+                {
+                    longest = len;
+                    result = shard;
+                }
+            }
         }
     }
 
@@ -417,296 +622,288 @@ int VARSERVER_CreateClientQueue( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  VARSERVER_Close                                                           */
+/*  var_Shard                                                                 */
 /*!
-    Close the connection to the variable server
+    Get the connection to a shard server
 
-    The VARSERVER_Close function is used by the variable server clients
-    to disconnect from the variable server and clean up all resources
-    used for the connection.
+    The var_Shard function gets the connection to the specified shard
+    server, opening it on first use.  The connection inherits the debug
+    level and request timeout of the root connection.
 
     @param[in]
-        hVarServer
-            handle to the Variable Server
+        pVarClient
+            pointer to the root connection
 
-    @retval EOK - the connection was successfully closed
-    @retval EINVAL - an invalid variable server handle was specified
+    @param[in]
+        shard
+            index of the shard
+
+    @retval pointer to the connection to the shard server
+    @retval NULL the shard server is not available
 
 ==============================================================================*/
-int VARSERVER_Close( VARSERVER_HANDLE hVarServer )
+static VarClient *var_Shard( VarClient *pVarClient, int shard )
 {
-    int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
-    if( pVarClient != NULL )
-    {
-        pVarClient->requestType = VARREQUEST_CLOSE;
-        ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+    VarClient *pShard = NULL;
 
-        /* clean up the Var client */
-        ClientCleanup( pVarClient );
+    if ( ( pVarClient != NULL ) &&
+         ( shard == 0 ) )
+    {
+        pShard = pVarClient;
+    }
+    else if ( ( pVarClient != NULL ) &&
+              ( shard > 0 ) &&
+              ( shard < VARSERVER_MAX_SHARDS ) )
+    {
+        pShard = pVarClient->pShards[shard];
+        if ( ( pShard == NULL ) &&
+             ( pVarClient->pShardInfo[shard] != NULL ) )
+        {
+            pShard = NewClient( pVarClient->workbufsize - 1, shard, 0 );
+            if ( pShard != NULL )
+            {
+                pShard->debug = pVarClient->debug;
+                pShard->requestTimeout_s = pVarClient->requestTimeout_s;
+                pShard->priority = pVarClient->priority;
 
-        /* indicate success */
-        result = EOK;
+                if ( ( InitServerInfo( pShard ) == EOK ) &&
+                     ( ClientRequest( pShard, SIG_NEWCLIENT ) == EOK ) &&
+                     ( pShard->clientid != 0 ) )
+                {
+                    pVarClient->pShards[shard] = pShard;
+                    shardPIDs[shard] = pShard->pServerInfo->pid;
+                }
+                else
+                {
+                    ClientCleanup( pShard );
+                    pShard = NULL;
+                }
+            }
+        }
     }
 
-    return result;
+    return pShard;
 }
 
 /*============================================================================*/
-/*  VARSERVER_GetWorkingBuffer                                                */
+/*  var_Route                                                                 */
 /*!
-    Get a pointer to the working buffer for the varserver
+    Route a variable handle to the shard server which issued it
 
-    The VARSERVER_GetWorkingBuffer gets a pointer to the client-server
-    working buffer and also gets its length.
+    The var_Route function gets the connection to the shard server
+    encoded in the high bits of the specified variable handle, and
+    converts the handle into the shard server's own handle.
 
     @param[in]
-        hVarServer
-            handle to the Variable Server
-
-    @param[out]
-        pBuf
-            pointer to the location to store the pointer to the
-            working buffer
+        pVarClient
+            pointer to the root connection
 
-    @param[out]
-        pLen
-            pointer to the location to store the working buffer length
+    @param[in,out]
+        phVar
+            pointer to the variable handle to route
 
-    @retval EOK - the working buffer pointer was successfully retrieved
-    @retval EINVAL - invalid arguments
+    @retval pointer to the connection to use for the variable
+    @retval NULL the shard server is not available
 
 ==============================================================================*/
-int VARSERVER_GetWorkingBuffer( VARSERVER_HANDLE hVarServer,
-                                char **pBuf,
-                                size_t *pLen )
+static VarClient *var_Route( VarClient *pVarClient, VAR_HANDLE *phVar )
 {
-    int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    int shard;
 
-    if( ( pVarClient != NULL ) &&
-        ( pBuf != NULL ) &&
-        ( pLen != NULL ))
+    if ( ( pVarClient != NULL ) &&
+         ( phVar != NULL ) )
     {
-        *pBuf = &(pVarClient->workbuf);
-        *pLen = pVarClient->workbufsize;
-
-        result = EOK;
+        shard = (int)( *phVar >> VARSERVER_SHARD_SHIFT );
+        if ( shard != 0 )
+        {
+            *phVar &= VARSERVER_SHARD_HANDLE_MASK;
+            pVarClient = var_Shard( pVarClient, shard );
+        }
     }
 
-    return result;
+    return pVarClient;
 }
 
 /*============================================================================*/
-/*  VARSERVER_GetWorkingBufferLength                                          */
+/*  var_ShardHandle                                                           */
 /*!
-    Get the length of the variable server working buffer
+    Convert a shard server's variable handle into a client handle
 
-    The VARSERVER_GetWorkingBufferLength function gets the length of the
-    working buffer, which is the maximum size for data transfers for this
-    client for transfering strings and blobs between the client and the
-    variable server.
+    The var_ShardHandle function encodes the shard index of the
+    specified connection in the high bits of a variable handle issued
+    by its server.
 
     @param[in]
-        hVarServer
-            handle to the Variable Server
+        pVarClient
+            pointer to the connection which issued the handle
 
-    @retval length of the working buffer
-    @retval 0 if the variable server handle is invalid
+    @param[in]
+        hVar
+            handle issued by the server
+
+    @retval the client variable handle
 
 ==============================================================================*/
-size_t VARSERVER_GetWorkingBufferLength( VARSERVER_HANDLE hVarServer )
+static VAR_HANDLE var_ShardHandle( VarClient *pVarClient, VAR_HANDLE hVar )
 {
-    size_t len = 0L;
-
-    VarClient *pVarClient = ValidateHandle( hVarServer );
-
-    if ( pVarClient != NULL )
+    if ( ( pVarClient != NULL ) &&
+         ( hVar != VAR_INVALID ) )
     {
-        len = pVarClient->workbufsize;
+        hVar |= (VAR_HANDLE)pVarClient->shard << VARSERVER_SHARD_SHIFT;
     }
 
-    return len;
+    return hVar;
 }
 
 /*============================================================================*/
-/*  VARSERVER_Debug                                                           */
+/*  var_NextShard                                                             */
 /*!
-    Set the Var Server debugging verbosity level
+    Get the next shard server to search
 
-    The VARSERVER_Debug function sets the verbosity level of the
-    variable server client interactions. It returns the previous
-    debug setting to support temporarily bumping up the debug
-    verbosity and then restoring it to its previous level.
+    The var_NextShard function gets the next available shard server
+    after the specified shard.  It is used to continue a query on the
+    next shard once the current shard has no more matches.
 
     @param[in]
-        hVarServer
-            handle to the Variable Server
+        pVarClient
+            pointer to the root connection
 
-    @param[out]
-        debug
-            debug verbosity level 0=no debug.  Higher number=more verbosity
+    @param[in]
+        shard
+            index of the shard which has been searched
 
-    @return the previous debug verbosity level
+    @retval index of the next shard to search
+    @retval 0 there are no more shards to search
 
 ==============================================================================*/
-int VARSERVER_Debug( VARSERVER_HANDLE hVarServer, int debug )
+static int var_NextShard( VarClient *pVarClient, int shard )
 {
-    VarClient *pVarClient = ValidateHandle( hVarServer );
-    int olddebug = 0;
+    int result = 0;
 
-    if( pVarClient != NULL )
+    if ( pVarClient != NULL )
     {
-        olddebug = pVarClient->debug;
-        pVarClient->debug = debug;
+        while ( ( result == 0 ) &&
+                ( ++shard < VARSERVER_MAX_SHARDS ) )
+        {
+            if ( var_Shard( pVarClient, shard ) != NULL )
+            {
+                result = shard;
+            }
+        }
     }
 
-    return olddebug;
+    return result;
 }
 
 /*============================================================================*/
-/*  VARSERVER_CreateVar                                                       */
+/*  var_TagSignal                                                             */
 /*!
-    Create a new variable
+    Identify the shard server which sent a signal
 
-    The VARSERVER_CreateVar function sends a request to the variable
-    server to create a new variable.
+    The var_TagSignal function encodes the shard index of the sender
+    in the high bits of the value of a signal sent by a shard server,
+    so the variable handle (or transaction identifier) it carries can
+    be routed back to that shard.  Signals from the root server are
+    unchanged.
 
     @param[in]
-        hVarServer
-            handle to the Variable Server
-
-    @param[in, out]
-        pVarInfo
-            pointer to the VarInfo object containing information
-            about the variable to be created.  After successful
-            creation pVarInfo->hVar contains the handle to the
-            created variable.
+        sig
+            the received signal
 
-    @param[out]
-        pLen
-            pointer to the location to store the working buffer length
+    @param[in]
+        pid
+            process identifier of the sender
 
-    @retval EOK - the working buffer pointer was successfully retrieved
-    @retval EMSGSIZE - the object is too large to create
-    @retval EINVAL - invalid arguments
+    @param[in,out]
+        sigval
+            pointer to the signal value
 
 ==============================================================================*/
-int VARSERVER_CreateVar( VARSERVER_HANDLE hVarServer,
-                         VarInfo *pVarInfo )
+static void var_TagSignal( int sig, pid_t pid, int *sigval )
 {
-    int result = EINVAL;
-    int rc;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
-    VarObject var;
+    int shard;
 
-    if( ( pVarClient != NULL ) &&
-        ( pVarInfo != NULL ) )
+    if ( ( sigval != NULL ) &&
+         ( ( sig == SIG_VAR_MODIFIED ) ||
+           ( sig == SIG_VAR_CALC ) ||
+           ( sig == SIG_VAR_PRINT ) ||
+           ( sig == SIG_VAR_VALIDATE ) ) )
     {
-        /* assume everything is ok until it is not */
-        result = EOK;
-
-        /* copy the VarObject */
-        memcpy( &var, &pVarInfo->var, sizeof( VarObject ) );
-
-        /* copy the variable information */
-        memcpy( &pVarClient->variableInfo, pVarInfo, sizeof( VarInfo ) );
-
-        /* strings have to be transferred via the working buffer */
-        if ( var.type == VARTYPE_STR )
-        {
-            if ( var.val.str != NULL )
-            {
-                result = var_CopyStringVarObjectToWorkbuf( pVarClient, &var );
-            }
-            else if ( var.len < pVarClient->workbufsize )
-            {
-                memset( &pVarClient->workbuf, 0, var.len );
-            }
-            else
-            {
-                result = E2BIG;
-            }
-        }
-
-        if ( var.type == VARTYPE_BLOB )
-        {
-            if ( var.val.blob != NULL )
-            {
-                result = var_CopyBlobVarObjectToWorkbuf( pVarClient, &var );
-            }
-            else if ( var.len <= pVarClient->workbufsize )
-            {
-                memset( &pVarClient->workbuf, 0, var.len );
-            }
-            else
-            {
-                result = E2BIG;
-            }
-        }
-
-        if ( result == EOK )
+        for ( shard = 1; shard < VARSERVER_MAX_SHARDS; shard++ )
         {
-            pVarClient->requestType = VARREQUEST_NEW;
-            rc = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-            if( rc == EOK )
-            {
-                pVarInfo->hVar = pVarClient->responseVal;
-                if ( pVarInfo->hVar != VAR_INVALID )
-                {
-                    result = EOK;
-                }
-            }
-            else
+            if ( ( shardPIDs[shard] != 0 ) &&
+                 ( shardPIDs[shard] == pid ) )
             {
-                pVarInfo->hVar = VAR_INVALID;
-                result = rc;
+                *sigval = (int)( (uint32_t)*sigval |
+                             ( (uint32_t)shard << VARSERVER_SHARD_SHIFT ) );
+                break;
             }
         }
-        else
-        {
-            pVarInfo->hVar = VAR_INVALID;
-        }
     }
-
-    return result;
 }
 
 /*============================================================================*/
-/*  VARSERVER_Test                                                            */
+/*  VARSERVER_UpdateUser                                                      */
 /*!
-    Test the connection to the variable server
+    Update the effective user id for the varserver client
 
-    The VARSERVER_Test function is used by the variable server clients
-    to test the connection to the variable server and exercise the
-    API.
+    The VARSERVER_UpdateUser function updates the effective user identifier
+    for the varserver client.  This user is used to determine read/write
+    access to the varserver variables.
+    The new group list is sent to each connected server, which resolves
+    it into the permission set used to check all subsequent requests.
+
+    This is done automatically when the varserver client is created,
+    it is only necessary to change this if the effective user
+    needs to be changed at runtime.
 
     @param[in]
         hVarServer
-            handle to the Variable Server
+            handle to the variable server client
 
-    @retval EOK - the connection was successfully closed
-    @retval EINVAL - an invalid variable server handle was specified
+    @retval EOK the user id update was successful
+    @retval E2BIG the user is a member of too many groups
+    @retval EINVAL invalid argument
 
 ==============================================================================*/
-int VARSERVER_Test( VARSERVER_HANDLE hVarServer )
+int VARSERVER_UpdateUser( VARSERVER_HANDLE hVarServer )
 {
     int result = EINVAL;
-
     VarClient *pVarClient = ValidateHandle( hVarServer );
-    if( pVarClient != NULL )
+    VarClient *pShard;
+    int shard;
+    int rc;
+
+    if ( pVarClient != NULL )
     {
-        /* use the handle as a cookie */
-        pVarClient->requestVal = (intptr_t)hVarServer;
-        pVarClient->requestType = VARREQUEST_ECHO;
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-        if( pVarClient->debug >= LOG_DEBUG )
+        result = EOK;
+
+        /* each shard server resolves the credentials of its own
+           connection */
+        for ( shard = 0; shard < VARSERVER_MAX_SHARDS; shard++ )
         {
-            printf("Client %d sent %d and received %d, result %d\n",
-                pVarClient->clientid,
-                pVarClient->requestVal,
-                pVarClient->responseVal,
-                result);
+            pShard = ( shard == 0 ) ? pVarClient
+                                    : pVarClient->pShards[shard];
+            if ( pShard != NULL )
+            {
+                pShard->uid = geteuid();
+                rc = varserver_GetGroupList( pShard );
+
+                pShard->requestType = VARREQUEST_UPDATE_USER;
+                if ( ClientRequest( pShard, SIG_CLIENT_REQUEST ) != EOK )
+                {
+                    rc = EINVAL;
+                }
+                else if ( rc == EOK )
+                {
+                    rc = pShard->responseVal;
+                }
+
+                if ( result == EOK )
+                {
+                    result = rc;
+                }
+            }
         }
     }
 
@@ -714,413 +911,470 @@ int VARSERVER_Test( VARSERVER_HANDLE hVarServer )
 }
 
 /*============================================================================*/
-/*  VARSERVER_WaitSignal                                                      */
+/*  VARSERVER_SetGroup                                                        */
 /*!
-    Wait for a VARSERVER signal
-
-    The VARSERVER_WaitSignal function sets up a signal mask for the following
-    varserver signals:
-
-        - SIG_VAR_MODIFIED
-        - SIG_VAR_QUEUE_MODIFIED
-        - SIG_VAR_CALC
-        - SIG_VAR_PRINT
-        - SIG_VAR_VALIDATE
-
-    It then waits until one of these signals occurs.
+    Set the calling process' group so we can access varserver client sockets
 
-    @param[in]
-        sigval
-            pointer to an integer to store the signal sival_int
+    The VARSERVER_SetGroup function sets the effective group id of the
+    calling process so we can access varserver client sockets
+    (used for client variable rendering)
 
-    @return the signal which occurred
+    @retval EOK group set ok
+    @retval other error from setegid
 
 ==============================================================================*/
-int VARSERVER_WaitSignal( int *sigval )
+int VARSERVER_SetGroup( void )
 {
-    sigset_t mask;
-    siginfo_t info;
-    int sig;
-
-    /* initialize empty signal set */
-    sigemptyset( &mask );
-
-    /* modified notification */
-    sigaddset( &mask, SIG_VAR_MODIFIED );
-    /* queue modified notification */
-    sigaddset( &mask, SIG_VAR_QUEUE_MODIFIED );
-    /* calc notification */
-    sigaddset( &mask, SIG_VAR_CALC );
-    /* validate notification */
-    sigaddset( &mask, SIG_VAR_PRINT );
-    /* print notification */
-    sigaddset( &mask, SIG_VAR_VALIDATE );
-    /* timer notification */
-    sigaddset( &mask, SIG_VAR_TIMER );
-
-    /* block on these signals */
-    sigprocmask( SIG_BLOCK, &mask, NULL );
-
-    /* wait for a signal */
-    sig = sigwaitinfo( &mask, &info );
+    int result = EINVAL;
+    struct group *grp;
 
-    if( sigval != NULL )
+    grp = getgrnam( VARSERVER_GROUP_NAME);
+    if ( grp != NULL )
     {
-        *sigval = info.si_value.sival_int;
+        result = ( setegid( grp->gr_gid ) == 0 ) ? EOK : errno;
     }
 
-    return sig;
+    return result;
 }
 
 /*============================================================================*/
-/*  VARSERVER_Signalfd                                                        */
+/*  VARSERVER_CreateClientQueue                                               */
 /*!
-    Create a signal file descriptor
+    Create a new client notification queue
 
-    The VARSERVER_Signalfd function sets up a file descriptor which can
-    be read to retrieve VarServer signals.  The signals which can be trapped
-    are:
+    The VARSERVER_CreateClientQueue function creates a new client notification
+    queue to receive variable modified notifications from the server.
 
-        - SIG_VAR_MODIFIED
-        - SIG_VAR_QUEUE_MODIFIED
-        - SIG_VAR_CALC
-        - SIG_VAR_PRINT
-        - SIG_VAR_VALIDATE
-        - SIG_VAR_TIMER
+    @param[in]
+        hVarServer
+            handle to the variable server
 
     @param[in]
-        flags
-            signalfd flags
+        queuelen
+            max number of queued messages.  -1 = use default
 
-    @retval the signal file descriptor
-    @retval -1 an error occurred (see errno)
+    @param[in]
+        msgsize
+            max number of queueud messages. -1 = use default;
 
-==============================================================================*/
-int VARSERVER_Signalfd( int flags )
+    @retval EOK the new client queue was successfully created
+    @retval EINVAL an invalid variable client was specified
+    @retval other error from mq_open()
+
+==============================================================================*/
+int VARSERVER_CreateClientQueue( VARSERVER_HANDLE hVarServer,
+                                 long queuelen,
+                                 long msgsize )
 {
-    sigset_t mask;
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    char clientname[BUFSIZ];
+    struct mq_attr attr;
 
-    /* initialize empty signal set */
-    sigemptyset( &mask );
+    if( pVarClient != NULL )
+    {
+        /* build the varclient identifier */
+        sprintf(clientname, "/varclient_%d", pVarClient->client_pid);
 
-    /* modified notification */
-    sigaddset( &mask, SIG_VAR_MODIFIED );
-    /* queue modified notification */
-    sigaddset( &mask, SIG_VAR_QUEUE_MODIFIED );
-    /* calc notification */
-    sigaddset( &mask, SIG_VAR_CALC );
-    /* validate notification */
-    sigaddset( &mask, SIG_VAR_PRINT );
-    /* print notification */
-    sigaddset( &mask, SIG_VAR_VALIDATE );
-    /* timer notification */
-    sigaddset( &mask, SIG_VAR_TIMER );
+        attr.mq_flags = 0;
+        attr.mq_maxmsg = queuelen == -1 ? VARSERVER_MAX_NOTIFICATION_MSG_COUNT
+                                        : queuelen;
+        attr.mq_msgsize = msgsize == -1 ? VARSERVER_MAX_NOTIFICATION_MSG_SIZE
+                                        : msgsize;
+        attr.mq_curmsgs = 0;
 
-    /* block on these signals */
-    sigprocmask( SIG_BLOCK, &mask, NULL );
+        pVarClient->notificationQ = mq_open( clientname,
+                                             O_RDONLY | O_CREAT | O_NONBLOCK,
+                                             0644,
+                                             &attr );
 
-    /* return the file descriptor to read to get signals */
-    return signalfd( -1, &mask, flags );
+        if ( pVarClient->notificationQ == -1 )
+        {
+            printf( "Failed to create queue %s : %s\n",
+                    clientname,
+                    strerror(errno));
+            result = errno;
+        }
+        else
+        {
+            result = EOK;
+        }
+    }
+
+    return result;
 }
 
 /*============================================================================*/
-/*  VARSERVER_WaitSignalfd                                                    */
+/*  VARSERVER_ClientQueuefd                                                   */
 /*!
-    Wait for a VarServer signal
+    Get the client notification queue descriptor
 
-    The VARSERVER_WaitSignalfd function waits for a signal using the
-    file descriptor provided by VARSERVER_Signalfd.
+    The VARSERVER_ClientQueuefd function gets the descriptor of the
+    client notification queue created by VARSERVER_CreateClientQueue.
+    The descriptor becomes readable when a notification is queued, so
+    it can be used with poll or epoll before calling VAR_GetFromQueue.
 
-    Signals which may be awaited are:
+    @param[in]
+        hVarServer
+            handle to the variable server
 
-        - SIG_VAR_MODIFIED
-        - SIG_VAR_QUEUE_MODIFIED
-        - SIG_VAR_CALC
-        - SIG_VAR_PRINT
-        - SIG_VAR_VALIDATE
-        - SIG_VAR_TIMER
+    @retval the notification queue descriptor
+    @retval -1 the client does not have a notification queue
 
-    The sigval field contains the payload value associated with the signal
+==============================================================================*/
+int VARSERVER_ClientQueuefd( VARSERVER_HANDLE hVarServer )
+{
+    int result = -1;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
 
-    @param[in]
-        fd
-            file descriptor provided by VARSERVER_Signalfd
+    if( ( pVarClient != NULL ) &&
+        ( pVarClient->notificationQ > 0 ) )
+    {
+        result = (int)pVarClient->notificationQ;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetQueueOverflows                                                     */
+/*!
+    Get the number of notification queue overflows
+
+    The VAR_GetQueueOverflows function gets the number of changes which
+    found the client notification queue full.  Depending on the overflow
+    policy of the subscription, the change was discarded, or discarded
+    in favour of a later value.  A consumer which sees the count change
+    has missed changes, and should read the variables it tracks again
+    rather than continue with stale values.
+
+    The count is maintained by the server in the client shared memory,
+    so reading it does not make a request.
 
     @param[in]
-        sigval
-            pointer to a location to store the associated signal value
+        hVarServer
+            handle to the variable server
 
-    @retval the received signal
-    @retval -1 an error occurred (see errno)
+    @param[out]
+        pCount
+            pointer to a location to store the overflow count
+
+    @retval EOK - the overflow count was retrieved
+    @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-int VARSERVER_WaitSignalfd( int fd, int32_t *sigval )
+int VAR_GetQueueOverflows( VARSERVER_HANDLE hVarServer, uint64_t *pCount )
 {
-    struct signalfd_siginfo info;
-    int n;
-    int sig = -1;
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
 
-    n = read( fd, &info, sizeof(struct signalfd_siginfo));
-    if ( n == sizeof( struct signalfd_siginfo ))
+    if( ( pVarClient != NULL ) &&
+        ( pCount != NULL ) )
     {
-        sig = info.ssi_signo;
-        if ( sigval != NULL )
-        {
-            *sigval = info.ssi_int;
-        }
+        *pCount = __atomic_load_n( &pVarClient->queueOverflows,
+                                   __ATOMIC_ACQUIRE );
+        result = EOK;
     }
 
-    return sig;
+    return result;
 }
+
 /*============================================================================*/
-/*  VARSERVER_SigMask                                                         */
+/*  VARSERVER_Close                                                           */
 /*!
-    Get the VARSERVER signal mask
+    Close the connection to the variable server
 
-    The VARSERVER_SigMask function sets up a signal mask for the following
-    varserver signals:
+    The VARSERVER_Close function is used by the variable server clients
+    to disconnect from the variable server and clean up all resources
+    used for the connection.
 
-        - SIG_VAR_MODIFIED
-        - SIG_VAR_QUEUE_MODIFIED
-        - SIG_VAR_CALC
-        - SIG_VAR_PRINT
-        - SIG_VAR_VALIDATE
-        - SIG_VAR_TIMER
+    @param[in]
+        hVarServer
+            handle to the Variable Server
 
-    @return the signal mask
+    @retval EOK - the connection was successfully closed
+    @retval EINVAL - an invalid variable server handle was specified
 
 ==============================================================================*/
-sigset_t VARSERVER_SigMask( void )
+int VARSERVER_Close( VARSERVER_HANDLE hVarServer )
 {
-    sigset_t mask;
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    if( pVarClient != NULL )
+    {
+        /* close the connections to the shard servers */
+        var_CloseShards( pVarClient );
 
-    /* initialize empty signal set */
-    sigemptyset( &mask );
+        pVarClient->requestType = VARREQUEST_CLOSE;
+        ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
 
-    /* modified notification */
-    sigaddset( &mask, SIG_VAR_MODIFIED );
-    /* queue modified notification */
-    sigaddset( &mask, SIG_VAR_QUEUE_MODIFIED );
-    /* calc notification */
-    sigaddset( &mask, SIG_VAR_CALC );
-    /* validate notification */
-    sigaddset( &mask, SIG_VAR_PRINT );
-    /* print notification */
-    sigaddset( &mask, SIG_VAR_VALIDATE );
-    /* timer notification */
-    sigaddset( &mask, SIG_VAR_TIMER );
+        /* clean up the Var client */
+        ClientCleanup( pVarClient );
 
-    /* block on these signals */
-    sigprocmask( SIG_BLOCK, &mask, NULL );
+        /* close the print channels */
+        VARPRINT_CloseChannels();
 
-    return mask;
+        /* indicate success */
+        result = EOK;
+    }
+
+    return result;
 }
 
 /*============================================================================*/
-/*  VARSERVER_ParsePermissionSpec                                             */
+/*  VARSERVER_GetWorkingBuffer                                                */
 /*!
-    Convert a comma separated list of UIDs to a UID array
+    Get a pointer to the working buffer for the varserver
 
-    The VARSERVER_ParsePermissionSpec function splits the specified
-    permission specifier string on commas, and converts the
-    permission UID strings into numeric UIDs for the permission UID
-    array.
+    The VARSERVER_GetWorkingBuffer gets a pointer to the client-server
+    working buffer and also gets its length.
 
     @param[in]
-        permissionSpec
-            Comma separated UID permission list
+        hVarServer
+            handle to the Variable Server
 
     @param[out]
-        permissions
-            pointer to the output array of permission UIDs
+        pBuf
+            pointer to the location to store the pointer to the
+            working buffer
 
-    @param[in,out]
-        len
-            pointer to size of the output permission UID array
-            and location to store the actual number of
-            permissions parsed
+    @param[out]
+        pLen
+            pointer to the location to store the working buffer length
 
-    @retval EOK - the permission parsing was successful
+    @retval EOK - the working buffer pointer was successfully retrieved
     @retval EINVAL - invalid arguments
-    @retval E2BIG - the specified permission list is too big
-    @retval ENOENT - one or more users/groups were not found
 
 ==============================================================================*/
-int VARSERVER_ParsePermissionSpec( char *permissionSpec,
-                                   gid_t *permissions,
-                                   size_t *len )
+int VARSERVER_GetWorkingBuffer( VARSERVER_HANDLE hVarServer,
+                                char **pBuf,
+                                size_t *pLen )
 {
-    size_t i = 0;
     int result = EINVAL;
-    char *permission;
-    char buf[ MAX_PERMISSIONSPEC_LEN + 1 ];
-    size_t permissionSpecLength;
-    char *r;
-    struct group *gr = NULL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
 
-    if( ( permissionSpec != NULL ) &&
-        ( permissions != NULL ) &&
-        ( len != NULL ) &&
-        ( *len > 0 ) &&
-        ( *len <= VARSERVER_MAX_UIDS ) )
+    if( ( pVarClient != NULL ) &&
+        ( pBuf != NULL ) &&
+        ( pLen != NULL ))
     {
-        /* initialize the result */
-        memset( permissions, 0, sizeof( gid_t) * *len );
+        *pBuf = &(pVarClient->workbuf);
+        *pLen = pVarClient->workbufsize;
+
         result = EOK;
+    }
 
-        /* get the length of the permission specifier string */
-        permissionSpecLength = strlen( permissionSpec );
-        if( permissionSpecLength <= MAX_PERMISSIONSPEC_LEN )
-        {
-            /* assume success until we exceed our output buffer size */
-            result = EOK;
+    return result;
+}
 
-            /* create a working copy of the permission specifier string */
-            memcpy( buf, permissionSpec, permissionSpecLength );
-            buf[ permissionSpecLength ] = 0;
+/*============================================================================*/
+/*  VARSERVER_GetWorkingBufferLength                                          */
+/*!
+    Get the length of the variable server working buffer
 
-            /* split on commas */
-            r = buf;
-            while( ( permission = strtok_r( r, ",", &r ) ) )
-            {
-                if( ( i < *len ) &&
-                    ( i < VARSERVER_MAX_UIDS ) )
-                {
-                    if (isdigit( *permission ))
-                    {
-                        permissions[i++] = atoi( permission );
-                    }
-                    else
-                    {
-                        gr = getgrnam( permission );
-                        if ( gr != NULL )
-                        {
-                            permissions[i++] = gr->gr_gid;
-                        }
-                        else
-                        {
-                            result = ENOENT;
-                        }
-                    }
-                }
-                else
-                {
-                    result = E2BIG;
-                    break;
-                }
-            }
+    The VARSERVER_GetWorkingBufferLength function gets the length of the
+    working buffer, which is the maximum size for data transfers for this
+    client for transfering strings and blobs between the client and the
+    variable server.
 
-            *len = i;
-        }
-        else
-        {
-            /* permission specifier string is too long */
-            result = E2BIG;
-        }
+    @param[in]
+        hVarServer
+            handle to the Variable Server
+
+    @retval length of the working buffer
+    @retval 0 if the variable server handle is invalid
+
+==============================================================================*/
+size_t VARSERVER_GetWorkingBufferLength( VARSERVER_HANDLE hVarServer )
+{
+    size_t len = 0L;
+
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+
+    if ( pVarClient != NULL )
+    {
+        len = pVarClient->workbufsize;
     }
 
-    return result;
+    return len;
 }
 
 /*============================================================================*/
-/*  VARSERVER_TypeNameToType                                                  */
+/*  VARSERVER_GetPriority                                                     */
 /*!
-    Convert a type name to its corresponding type
+    Get the request priority class of a variable server connection
 
-    The VARSERVER_TypeNameToType function converts the specified
-    type name into its corresponding enumerated type.
+    The VARSERVER_GetPriority function gets the request priority class
+    which the variable server granted to the connection.
 
     @param[in]
-        typeName
-            Name of the type to look up
-
-    @param[out]
-        type
-            pointer to the output type variable
+        hVarServer
+            handle to the Variable Server
 
-    @retval EOK - the type name lookup was successful
-    @retval EINVAL - invalid arguments
-    @retval ENOENT - the specified type name does not exist
+    @retval VARSERVER_PRIORITY_NORMAL normal priority requests
+    @retval VARSERVER_PRIORITY_HIGH high priority requests
+    @retval -1 if the variable server handle is invalid
 
 ==============================================================================*/
-int VARSERVER_TypeNameToType( char *typeName, VarType *type )
+int VARSERVER_GetPriority( VARSERVER_HANDLE hVarServer )
 {
-    int i = 0;
-    int result = EINVAL;
-
-    if( ( typeName != NULL ) &&
-        ( type != NULL ) )
-    {
-        /* populate invalid type in case we don't find a match */
-        *type = VARTYPE_INVALID;
-        result = ENOENT;
+    int priority = -1;
 
-        while( typeNames[i] != NULL )
-        {
-            if( strcmp( typeNames[i], typeName ) == 0 )
-            {
-                *type = i;
-                result = EOK;
-                break;
-            }
+    VarClient *pVarClient = ValidateHandle( hVarServer );
 
-            /* select the next type name */
-            i++;
-        }
+    if ( pVarClient != NULL )
+    {
+        priority = pVarClient->priority;
     }
 
-    return result;
+    return priority;
 }
 
 /*============================================================================*/
-/*  VARSERVER_TypeToTypeName                                                  */
+/*  VARSERVER_Debug                                                           */
 /*!
-    Get the name of a variable type
+    Set the Var Server debugging verbosity level
 
-    The VARSERVER_TypeToTypeName function converts the specified
-    enumerated type into its corresponding type name.
+    The VARSERVER_Debug function sets the verbosity level of the
+    variable server client interactions. It returns the previous
+    debug setting to support temporarily bumping up the debug
+    verbosity and then restoring it to its previous level.
 
     @param[in]
-        type
-            Enumerated type to convert
+        hVarServer
+            handle to the Variable Server
 
     @param[out]
-        typeName
-            pointer to an output buffer to copy the type name
+        debug
+            debug verbosity level 0=no debug.  Higher number=more verbosity
+
+    @return the previous debug verbosity level
+
+==============================================================================*/
+int VARSERVER_Debug( VARSERVER_HANDLE hVarServer, int debug )
+{
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    int olddebug = 0;
+
+    if( pVarClient != NULL )
+    {
+        olddebug = pVarClient->debug;
+        pVarClient->debug = debug;
+    }
+
+    return olddebug;
+}
+
+/*============================================================================*/
+/*  VARSERVER_CreateVar                                                       */
+/*!
+    Create a new variable
+
+    The VARSERVER_CreateVar function sends a request to the variable
+    server to create a new variable.
 
     @param[in]
-        len
-            length of the output buffer to receive the type name
+        hVarServer
+            handle to the Variable Server
 
-    @retval EOK - the type name lookup was successful
+    @param[in, out]
+        pVarInfo
+            pointer to the VarInfo object containing information
+            about the variable to be created.  After successful
+            creation pVarInfo->hVar contains the handle to the
+            created variable.
+
+    @param[out]
+        pLen
+            pointer to the location to store the working buffer length
+
+    @retval EOK - the working buffer pointer was successfully retrieved
+    @retval EMSGSIZE - the object is too large to create
     @retval EINVAL - invalid arguments
-    @retval ENOENT - the specified type name does not exist
-    @retval E2BIG - the output buffer is not big enough for the type name
 
 ==============================================================================*/
-int VARSERVER_TypeToTypeName( VarType type, char *typeName, size_t len )
+int VARSERVER_CreateVar( VARSERVER_HANDLE hVarServer,
+                         VarInfo *pVarInfo )
 {
     int result = EINVAL;
-    size_t typeNameLength;
+    int rc;
+    VarClient *pRoot = ValidateHandle( hVarServer );
+    VarClient *pVarClient = NULL;
+    VarObject var;
 
-    if( typeName != NULL )
+    if( ( pRoot != NULL ) &&
+        ( pVarInfo != NULL ) )
     {
-        if( type < VARTYPE_END_MARKER )
+        /* the variable is created by the server which owns its name */
+        pVarClient = var_Shard( pRoot, var_NameShard( pRoot, pVarInfo->name ) );
+    }
+
+    if( ( pVarClient != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        /* assume everything is ok until it is not */
+        result = EOK;
+
+        /* copy the VarObject */
+        memcpy( &var, &pVarInfo->var, sizeof( VarObject ) );
+
+        /* copy the variable information */
+        memcpy( &pVarClient->variableInfo, pVarInfo, sizeof( VarInfo ) );
+
+        /* strings have to be transferred via the working buffer */
+        if ( var.type == VARTYPE_STR )
         {
-            typeNameLength = strlen( typeNames[type] );
-            if( typeNameLength < len )
+            if ( var.val.str != NULL )
             {
-                strcpy( typeName, typeNames[type] );
-                result = EOK;
+                result = var_CopyStringVarObjectToWorkbuf( pVarClient, &var );
+            }
+            else if ( var_GrowWorkbuf( pVarClient, var.len + 1 ) == EOK )
+            {
+                memset( &pVarClient->workbuf, 0, var.len );
+            }
+            else
+            {
+                result = E2BIG;
+            }
+        }
+
+        if ( var.type == VARTYPE_BLOB )
+        {
+            if ( var.val.blob != NULL )
+            {
+                result = var_CopyBlobVarObjectToWorkbuf( pVarClient, &var );
+            }
+            else if ( var_GrowWorkbuf( pVarClient, var.len ) == EOK )
+            {
+                memset( &pVarClient->workbuf, 0, var.len );
             }
             else
             {
                 result = E2BIG;
             }
         }
+
+        if ( result == EOK )
+        {
+            pVarClient->requestType = VARREQUEST_NEW;
+            rc = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if( rc == EOK )
+            {
+                pVarInfo->hVar = var_ShardHandle( pVarClient,
+                                                  pVarClient->responseVal );
+                if ( pVarInfo->hVar != VAR_INVALID )
+                {
+                    result = EOK;
+                }
+            }
+            else
+            {
+                pVarInfo->hVar = VAR_INVALID;
+                result = rc;
+            }
+        }
         else
         {
-            result = ENOENT;
+            pVarInfo->hVar = VAR_INVALID;
         }
     }
 
@@ -1128,82 +1382,148 @@ int VARSERVER_TypeToTypeName( VarType type, char *typeName, size_t len )
 }
 
 /*============================================================================*/
-/*  VARSERVER_StrToFlags                                                      */
+/*  VARSERVER_CreateVars                                                      */
 /*!
-    Convert a comma separated list of flag names to a bitmap
+    Create multiple variables
 
-    The VARSERVER_StrToFlags function splits the specified flags string
-    on commas, and iterates through the flag names looking for a
-    match and setting the appropriate bits in the flags bitmap
+    The VARSERVER_CreateVars function creates the n variables defined
+    by the pVarInfo array.  As many definitions as will fit in the
+    client's working buffer are sent to the server in each request, so
+    a client with a larger working buffer (see VARSERVER_OpenExt) uses
+    fewer requests.  A definition which does not fit in the working
+    buffer by itself is created individually using VARSERVER_CreateVar.
+    A batch only contains consecutive definitions owned by the same
+    shard server.
+
+    The handle of each new variable is stored in its VarInfo object,
+    or VAR_INVALID if the variable could not be created.
 
     @param[in]
-        flagsString
-            Comma separated flag name string
+        hVarServer
+            handle to the variable server
+
+    @param[in,out]
+        pVarInfo
+            array of n variable definitions
 
     @param[out]
-        flags
-            pointer to a location to store the 32-bit flag bitmask
+        results
+            optional array of n locations to store the per-variable
+            result codes (EEXIST if the variable already exists).
+            May be NULL.
 
-    @retval EOK - the flags parsing was successful
+    @param[in]
+        n
+            number of variables to create
+
+    @retval EOK - all of the variables were created
     @retval EINVAL - invalid arguments
-    @retval E2BIG - the specified flagsString is too big
-    @retval ENOENT - one or more flags were not valid
+    @retval other - the result of the first variable which failed
 
 ==============================================================================*/
-int VARSERVER_StrToFlags( char *flagsString,
-                          uint32_t *flags )
+int VARSERVER_CreateVars( VARSERVER_HANDLE hVarServer,
+                          VarInfo *pVarInfo,
+                          int *results,
+                          size_t n )
 {
-    int i = 0;
-    char flagBuf[MAX_FLAGSPEC_LEN+1];
     int result = EINVAL;
-    size_t len;
-    char *flag;
-    char *r;
+    VarClient *pRoot = ValidateHandle( hVarServer );
+    VarClient *pVarClient;
+    VarCreateItem *pItem;
+    int rc[VARSERVER_MAX_BATCH_ITEMS];
+    int first = EOK;
+    size_t offset;
+    size_t count;
+    size_t run;
+    size_t i = 0;
+    size_t j;
+    int shard;
 
-    if( ( flagsString != NULL ) &&
-        ( flags != NULL ) )
+    if( ( pRoot != NULL ) &&
+        ( pVarInfo != NULL ) )
     {
-        /* initialize the result */
-        *flags = 0;
         result = EOK;
 
-        /* copy the flag specifier string into local storage */
-        len = strlen( flagsString );
-        if( len <= MAX_FLAGSPEC_LEN )
+        while( ( result == EOK ) && ( i < n ) )
         {
-            /* copy the specified flags string into a working buffer */
-            memcpy( flagBuf, flagsString, len );
-            flagBuf[len] = 0;
+            /* find the consecutive definitions owned by the same shard */
+            shard = var_NameShard( pRoot, pVarInfo[i].name );
+            run = 1;
+            while( ( i + run < n ) &&
+                   ( run < VARSERVER_MAX_BATCH_ITEMS ) &&
+                   ( var_NameShard( pRoot, pVarInfo[i+run].name ) == shard ) )
+            {
+                run++;
+            }
 
-            /* split on commas */
-            r = flagBuf;
-            while( ( flag = strtok_r( r, ",", &r ) ) )
+            /* pack as many definitions as will fit into the working buffer */
+            pVarClient = var_Shard( pRoot, shard );
+            count = ( pVarClient != NULL )
+                        ? var_PackCreateBatch( pVarClient, &pVarInfo[i], run )
+                        : 0;
+            if( count == 0 )
             {
-                /* iterate through the flag names looking for a match */
-                i = 1;
-                while( flagNames[i] != NULL )
+                /* the next definition does not fit in a batch by itself,
+                   so it is created individually */
+                count = 1;
+                rc[0] = VARSERVER_CreateVar( hVarServer, &pVarInfo[i] );
+                if( ( rc[0] == EOK ) && ( pVarInfo[i].hVar == VAR_INVALID ) )
                 {
-                    /* check for a case insensitive flag name match */
-                    if( strcmp( flagNames[i], flag ) == 0 )
+                    rc[0] = EEXIST;
+                }
+            }
+            else
+            {
+                pVarClient->requestType = VARREQUEST_NEW_MANY;
+                pVarClient->requestVal = count;
+
+                result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+                if( ( result == EOK ) &&
+                    ( pVarClient->responseVal != (int)count ) )
+                {
+                    result = EIO;
+                }
+
+                if( result == EOK )
+                {
+                    offset = 0;
+                    for( j = 0; j < count; j++ )
                     {
-                        /* set the corresponding bit in the flags bitmap */
-                        *flags |= ( 1 << ( i-1 ) );
-                        break;
+                        pItem = (VarCreateItem *)( &pVarClient->workbuf +
+                                                   offset );
+                        offset += pItem->size;
+
+                        rc[j] = pItem->result;
+                        pVarInfo[i+j].hVar =
+                            ( rc[j] == EOK )
+                                ? var_ShardHandle( pVarClient, pItem->hVar )
+                                : VAR_INVALID;
                     }
-
-                    /* move to the next flag name */
-                    i++;
                 }
+            }
 
-                if( flagNames[i] == NULL )
+            if( result == EOK )
+            {
+                for( j = 0; j < count; j++ )
                 {
-                    result = ENOENT;
+                    if( results != NULL )
+                    {
+                        results[i+j] = rc[j];
+                    }
+
+                    if( first == EOK )
+                    {
+                        first = rc[j];
+                    }
                 }
+
+                i += count;
             }
         }
-        else
+
+        if( result == EOK )
         {
-            result = E2BIG;
+            result = first;
         }
     }
 
@@ -1211,92 +1531,40 @@ int VARSERVER_StrToFlags( char *flagsString,
 }
 
 /*============================================================================*/
-/*  VARSERVER_FlagsToStr                                                      */
+/*  VARSERVER_Test                                                            */
 /*!
-    Convert a flags bitmap into a comma separated list of flag names
-
-    The VARSERVER_FlagsToStr function generates a comma separated
-    flag name string from the specified flags bitmap
-
-    @param[in]
-        flags
-            32-bit flags bitmap
+    Test the connection to the variable server
 
-    @param[out]
-        flagsString
-            pointer to a buffer to store the comma separated flag string
+    The VARSERVER_Test function is used by the variable server clients
+    to test the connection to the variable server and exercise the
+    API.
 
     @param[in]
-        len
-            size of the buffer to store the comma separated flag string
-
+        hVarServer
+            handle to the Variable Server
 
-    @retval EOK - the flags parsing was successful
-    @retval EINVAL - invalid arguments
-    @retval E2BIG - not enough space in the output buffer for the flag string
+    @retval EOK - the connection was successfully closed
+    @retval EINVAL - an invalid variable server handle was specified
 
 ==============================================================================*/
-int VARSERVER_FlagsToStr( uint32_t flags,
-                          char *flagsString,
-                          size_t len )
+int VARSERVER_Test( VARSERVER_HANDLE hVarServer )
 {
-    int i=1;
-    size_t remaining = len;
-    size_t offset = 0;
-    int count = 0;
     int result = EINVAL;
 
-    if( ( flagsString != NULL ) &&
-        ( len > 0 ) )
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    if( pVarClient != NULL )
     {
-        /* indicate success until we know otherwise */
-        result = EOK;
-
-        while( flagNames[i] != NULL )
+        /* use the handle as a cookie */
+        pVarClient->requestVal = (intptr_t)hVarServer;
+        pVarClient->requestType = VARREQUEST_ECHO;
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( pVarClient->debug >= LOG_DEBUG )
         {
-            if( flags & ( 1 << ( i-1 ) ) )
-            {
-                /* calculate length needed for the flag name */
-                len = strlen( flagNames[i] );
-
-                if( count > 0 )
-                {
-                    /* add one for the comma separator */
-                    len++;
-                }
-
-                /* check if we have enough space for the flag in the string */
-                if( remaining > len )
-                {
-                    /* check if this is not the first flag */
-                    if( count > 0 )
-                    {
-                        /* prepend a comma */
-                        flagsString[offset] = ',';
-                        offset++;
-                        remaining--;
-                    }
-
-                    /* build the flags string */
-                    strcpy( &flagsString[offset], flagNames[i] );
-
-                    /* adjust offset and remaining byte count by the
-                       length of the flag name */
-                    offset += len;
-                    remaining -= len;
-
-                    /* increment the flags count */
-                    count++;
-                }
-                else
-                {
-                    /* we have run out of space for the flags string */
-                    result = E2BIG;
-                }
-            }
-
-            /* move to the next flag */
-            i++;
+            printf("Client %d sent %d and received %d, result %d\n",
+                pVarClient->clientid,
+                pVarClient->requestVal,
+                pVarClient->responseVal,
+                result);
         }
     }
 
@@ -1304,121 +1572,4282 @@ int VARSERVER_FlagsToStr( uint32_t flags,
 }
 
 /*============================================================================*/
-/*  VARSERVER_ParseValueString                                                */
+/*  VARSERVER_WaitSignal                                                      */
 /*!
-    Parse a value string and assign a value to the VarObject
+    Wait for a VARSERVER signal
 
-    The VARSERVER_ParseValueString function parses a value string
-    and converts the string into an appropriate value depending on
-    the variable type.  The converted value is stored into the
-    specfied VarObject.
+    The VARSERVER_WaitSignal function sets up a signal mask for the following
+    varserver signals:
 
-    @param[out]
-        var
-            pointer to a VarObject to receive the parsed value
+        - SIG_VAR_MODIFIED
+        - SIG_VAR_QUEUE_MODIFIED
+        - SIG_VAR_CALC
+        - SIG_VAR_PRINT
+        - SIG_VAR_VALIDATE
 
-    @param[out]
-        valueString
-            pointer to a value string to be parsed
+    It then waits until one of these signals occurs.  The shard index
+    of a signal sent by a shard server is encoded in the signal value
+    (see var_TagSignal).
 
-    @retval EOK - the value string was successfully parsed and stored
-    @retval EINVAL - invalid arguments
-    @retval E2BIG - the specified string was too large
-    @retval ERANGE - the specified value does not fit in the variable type
-    @retval ENOTSUP - unsupported data type
+    @param[in]
+        sigval
+            pointer to an integer to store the signal sival_int
+
+    @return the signal which occurred
 
 ==============================================================================*/
-int VARSERVER_ParseValueString( VarObject *var, char *valueString )
+int VARSERVER_WaitSignal( int *sigval )
 {
-    int result = EINVAL;
-    size_t len;
-    int base = 0;
+    sigset_t mask;
+    siginfo_t info;
+    int sig;
 
-    if( ( var != NULL ) &&
-        ( valueString != NULL ) )
-    {
-        /* assume success until we determine otherwise */
-        result = EOK;
+    /* initialize empty signal set */
+    sigemptyset( &mask );
 
-        if( ( valueString[0] == '0' ) &&
-            ( tolower(valueString[1]) == 'x' ) )
-        {
-            base = 16;
-        }
+    /* modified notification */
+    sigaddset( &mask, SIG_VAR_MODIFIED );
+    /* queue modified notification */
+    sigaddset( &mask, SIG_VAR_QUEUE_MODIFIED );
+    /* calc notification */
+    sigaddset( &mask, SIG_VAR_CALC );
+    /* validate notification */
+    sigaddset( &mask, SIG_VAR_PRINT );
+    /* print notification */
+    sigaddset( &mask, SIG_VAR_VALIDATE );
+    /* timer notification */
+    sigaddset( &mask, SIG_VAR_TIMER );
 
-        switch( var->type )
-        {
-            case VARTYPE_INT16:
-                var->val.i = (int16_t)strtol( valueString, NULL, base );
-                break;
+    /* block on these signals */
+    sigprocmask( SIG_BLOCK, &mask, NULL );
 
-            case VARTYPE_UINT16:
-                var->val.ui = (uint16_t)strtoul( valueString, NULL, base );
-                break;
+    /* wait for a signal */
+    sig = sigwaitinfo( &mask, &info );
 
-            case VARTYPE_INT32:
-                var->val.l = strtol( valueString, NULL, base );
-                break;
+    if( sigval != NULL )
+    {
+        *sigval = info.si_value.sival_int;
 
-            case VARTYPE_UINT32:
-                var->val.ul = strtoul( valueString, NULL, base );
-                break;
+        /* identify signals from shard servers */
+        var_TagSignal( sig, info.si_pid, sigval );
+    }
 
-            case VARTYPE_INT64:
-                var->val.ll = strtoll( valueString, NULL, base );
-                break;
+    return sig;
+}
 
-            case VARTYPE_UINT64:
-                var->val.ull = strtoull( valueString, NULL, base );
-                break;
+/*============================================================================*/
+/*  VARSERVER_Signalfd                                                        */
+/*!
+    Create a signal file descriptor
 
-            case VARTYPE_FLOAT:
-                var->val.f = strtof( valueString, NULL );
-                break;
+    The VARSERVER_Signalfd function sets up a file descriptor which can
+    be read to retrieve VarServer signals.  The signals which can be trapped
+    are:
 
-            case VARTYPE_STR:
-                if( var->val.str != NULL)
-                {
-                    len = strlen( valueString );
-                    if( len < var->len )
-                    {
-                        strcpy( var->val.str, valueString );
-                    }
-                    else
-                    {
-                        result = E2BIG;
+        - SIG_VAR_MODIFIED
+        - SIG_VAR_QUEUE_MODIFIED
+        - SIG_VAR_CALC
+        - SIG_VAR_PRINT
+        - SIG_VAR_VALIDATE
+        - SIG_VAR_TIMER
+
+    @param[in]
+        flags
+            signalfd flags
+
+    @retval the signal file descriptor
+    @retval -1 an error occurred (see errno)
+
+==============================================================================*/
+int VARSERVER_Signalfd( int flags )
+{
+    sigset_t mask;
+
+    /* initialize empty signal set */
+    sigemptyset( &mask );
+
+    /* modified notification */
+    sigaddset( &mask, SIG_VAR_MODIFIED );
+    /* queue modified notification */
+    sigaddset( &mask, SIG_VAR_QUEUE_MODIFIED );
+    /* calc notification */
+    sigaddset( &mask, SIG_VAR_CALC );
+    /* validate notification */
+    sigaddset( &mask, SIG_VAR_PRINT );
+    /* print notification */
+    sigaddset( &mask, SIG_VAR_VALIDATE );
+    /* timer notification */
+    sigaddset( &mask, SIG_VAR_TIMER );
+
+    /* block on these signals */
+    sigprocmask( SIG_BLOCK, &mask, NULL );
+
+    /* return the file descriptor to read to get signals */
+    return signalfd( -1, &mask, flags );
+}
+
+/*============================================================================*/
+/*  VARSERVER_WaitSignalfd                                                    */
+/*!
+    Wait for a VarServer signal
+
+    The VARSERVER_WaitSignalfd function waits for a signal using the
+    file descriptor provided by VARSERVER_Signalfd.
+
+    Signals which may be awaited are:
+
+        - SIG_VAR_MODIFIED
+        - SIG_VAR_QUEUE_MODIFIED
+        - SIG_VAR_CALC
+        - SIG_VAR_PRINT
+        - SIG_VAR_VALIDATE
+        - SIG_VAR_TIMER
+
+    The sigval field contains the payload value associated with the signal
+
+    @param[in]
+        fd
+            file descriptor provided by VARSERVER_Signalfd
+
+    @param[in]
+        sigval
+            pointer to a location to store the associated signal value
+
+    @retval the received signal
+    @retval -1 an error occurred (see errno)
+
+==============================================================================*/
+int VARSERVER_WaitSignalfd( int fd, int32_t *sigval )
+{
+    struct signalfd_siginfo info;
+    int n;
+    int sig = -1;
+
+    n = read( fd, &info, sizeof(struct signalfd_siginfo));
+    if ( n == sizeof( struct signalfd_siginfo ))
+    {
+        sig = info.ssi_signo;
+        if ( sigval != NULL )
+        {
+            *sigval = info.ssi_int;
+
+            /* identify signals from shard servers */
+            var_TagSignal( sig, (pid_t)info.ssi_pid, sigval );
+        }
+    }
+
+    return sig;
+}
+/*============================================================================*/
+/*  VARSERVER_SigMask                                                         */
+/*!
+    Get the VARSERVER signal mask
+
+    The VARSERVER_SigMask function sets up a signal mask for the following
+    varserver signals:
+
+        - SIG_VAR_MODIFIED
+        - SIG_VAR_QUEUE_MODIFIED
+        - SIG_VAR_CALC
+        - SIG_VAR_PRINT
+        - SIG_VAR_VALIDATE
+        - SIG_VAR_TIMER
+
+    @return the signal mask
+
+==============================================================================*/
+sigset_t VARSERVER_SigMask( void )
+{
+    sigset_t mask;
+
+    /* initialize empty signal set */
+    sigemptyset( &mask );
+
+    /* modified notification */
+    sigaddset( &mask, SIG_VAR_MODIFIED );
+    /* queue modified notification */
+    sigaddset( &mask, SIG_VAR_QUEUE_MODIFIED );
+    /* calc notification */
+    sigaddset( &mask, SIG_VAR_CALC );
+    /* validate notification */
+    sigaddset( &mask, SIG_VAR_PRINT );
+    /* print notification */
+    sigaddset( &mask, SIG_VAR_VALIDATE );
+    /* timer notification */
+    sigaddset( &mask, SIG_VAR_TIMER );
+
+    /* block on these signals */
+    sigprocmask( SIG_BLOCK, &mask, NULL );
+
+    return mask;
+}
+
+/*============================================================================*/
+/*  VARSERVER_ParsePermissionSpec                                             */
+/*!
+    Convert a comma separated list of UIDs to a UID array
+
+    The VARSERVER_ParsePermissionSpec function splits the specified
+    permission specifier string on commas, and converts the
+    permission UID strings into numeric UIDs for the permission UID
+    array.
+
+    @param[in]
+        permissionSpec
+            Comma separated UID permission list
+
+    @param[out]
+        permissions
+            pointer to the output array of permission UIDs
+
+    @param[in,out]
+        len
+            pointer to size of the output permission UID array
+            and location to store the actual number of
+            permissions parsed
+
+    @retval EOK - the permission parsing was successful
+    @retval EINVAL - invalid arguments
+    @retval E2BIG - the specified permission list is too big
+    @retval ENOENT - one or more users/groups were not found
+
+==============================================================================*/
+int VARSERVER_ParsePermissionSpec( char *permissionSpec,
+                                   gid_t *permissions,
+                                   size_t *len )
+{
+    size_t i = 0;
+    int result = EINVAL;
+    char *permission;
+    char buf[ MAX_PERMISSIONSPEC_LEN + 1 ];
+    size_t permissionSpecLength;
+    char *r;
+    struct group *gr = NULL;
+
+    if( ( permissionSpec != NULL ) &&
+        ( permissions != NULL ) &&
+        ( len != NULL ) &&
+        ( *len > 0 ) &&
+        ( *len <= VARSERVER_MAX_UIDS ) )
+    {
+        /* initialize the result */
+        memset( permissions, 0, sizeof( gid_t) * *len );
+        result = EOK;
+
+        /* get the length of the permission specifier string */
+        permissionSpecLength = strlen( permissionSpec );
+        if( permissionSpecLength <= MAX_PERMISSIONSPEC_LEN )
+        {
+            /* assume success until we exceed our output buffer size */
+            result = EOK;
+
+            /* create a working copy of the permission specifier string */
+            memcpy( buf, permissionSpec, permissionSpecLength );
+            buf[ permissionSpecLength ] = 0;
+
+            /* split on commas */
+            r = buf;
+            while( ( permission = strtok_r( r, ",", &r ) ) )
+            {
+                if( ( i < *len ) &&
+                    ( i < VARSERVER_MAX_UIDS ) )
+                {
+                    if (isdigit( *permission ))
+                    {
+                        permissions[i++] = atoi( permission );
+                    }
+                    else
+                    {
+                        gr = getgrnam( permission );
+                        if ( gr != NULL )
+                        {
+                            permissions[i++] = gr->gr_gid;
+                        }
+                        else
+                        {
+                            result = ENOENT;
+                        }
                     }
                 }
                 else
                 {
-                    result = ENOMEM;
+                    result = E2BIG;
+                    break;
+                }
+            }
+
+            *len = i;
+        }
+        else
+        {
+            /* permission specifier string is too long */
+            result = E2BIG;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARSERVER_TypeNameToType                                                  */
+/*!
+    Convert a type name to its corresponding type
+
+    The VARSERVER_TypeNameToType function converts the specified
+    type name into its corresponding enumerated type.
+
+    @param[in]
+        typeName
+            Name of the type to look up
+
+    @param[out]
+        type
+            pointer to the output type variable
+
+    @retval EOK - the type name lookup was successful
+    @retval EINVAL - invalid arguments
+    @retval ENOENT - the specified type name does not exist
+
+==============================================================================*/
+int VARSERVER_TypeNameToType( char *typeName, VarType *type )
+{
+    int i = 0;
+    int result = EINVAL;
+
+    if( ( typeName != NULL ) &&
+        ( type != NULL ) )
+    {
+        /* populate invalid type in case we don't find a match */
+        *type = VARTYPE_INVALID;
+        result = ENOENT;
+
+        while( typeNames[i] != NULL )
+        {
+            if( strcmp( typeNames[i], typeName ) == 0 )
+            {
+                *type = i;
+                result = EOK;
+                break;
+            }
+
+            /* select the next type name */
+            i++;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARSERVER_TypeToTypeName                                                  */
+/*!
+    Get the name of a variable type
+
+    The VARSERVER_TypeToTypeName function converts the specified
+    enumerated type into its corresponding type name.
+
+    @param[in]
+        type
+            Enumerated type to convert
+
+    @param[out]
+        typeName
+            pointer to an output buffer to copy the type name
+
+    @param[in]
+        len
+            length of the output buffer to receive the type name
+
+    @retval EOK - the type name lookup was successful
+    @retval EINVAL - invalid arguments
+    @retval ENOENT - the specified type name does not exist
+    @retval E2BIG - the output buffer is not big enough for the type name
+
+==============================================================================*/
+int VARSERVER_TypeToTypeName( VarType type, char *typeName, size_t len )
+{
+    int result = EINVAL;
+    size_t typeNameLength;
+
+    if( typeName != NULL )
+    {
+        if( type < VARTYPE_END_MARKER )
+        {
+            typeNameLength = strlen( typeNames[type] );
+            if( typeNameLength < len )
+            {
+                strcpy( typeName, typeNames[type] );
+                result = EOK;
+            }
+            else
+            {
+                result = E2BIG;
+            }
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARSERVER_StrToFlags                                                      */
+/*!
+    Convert a comma separated list of flag names to a bitmap
+
+    The VARSERVER_StrToFlags function splits the specified flags string
+    on commas, and iterates through the flag names looking for a
+    match and setting the appropriate bits in the flags bitmap
+
+    @param[in]
+        flagsString
+            Comma separated flag name string
+
+    @param[out]
+        flags
+            pointer to a location to store the 32-bit flag bitmask
+
+    @retval EOK - the flags parsing was successful
+    @retval EINVAL - invalid arguments
+    @retval E2BIG - the specified flagsString is too big
+    @retval ENOENT - one or more flags were not valid
+
+==============================================================================*/
+int VARSERVER_StrToFlags( char *flagsString,
+                          uint32_t *flags )
+{
+    int i = 0;
+    char flagBuf[MAX_FLAGSPEC_LEN+1];
+    int result = EINVAL;
+    size_t len;
+    char *flag;
+    char *r;
+
+    if( ( flagsString != NULL ) &&
+        ( flags != NULL ) )
+    {
+        /* initialize the result */
+        *flags = 0;
+        result = EOK;
+
+        /* copy the flag specifier string into local storage */
+        len = strlen( flagsString );
+        if( len <= MAX_FLAGSPEC_LEN )
+        {
+            /* copy the specified flags string into a working buffer */
+            memcpy( flagBuf, flagsString, len );
+            flagBuf[len] = 0;
+
+            /* split on commas */
+            r = flagBuf;
+            while( ( flag = strtok_r( r, ",", &r ) ) )
+            {
+                /* iterate through the flag names looking for a match */
+                i = 1;
+                while( flagNames[i] != NULL )
+                {
+                    /* check for a case insensitive flag name match */
+                    if( strcmp( flagNames[i], flag ) == 0 )
+                    {
+                        /* set the corresponding bit in the flags bitmap */
+                        *flags |= ( 1 << ( i-1 ) );
+                        break;
+                    }
+
+                    /* move to the next flag name */
+                    i++;
+                }
+
+                if( flagNames[i] == NULL )
+                {
+                    result = ENOENT;
+                }
+            }
+        }
+        else
+        {
+            result = E2BIG;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARSERVER_FlagsToStr                                                      */
+/*!
+    Convert a flags bitmap into a comma separated list of flag names
+
+    The VARSERVER_FlagsToStr function generates a comma separated
+    flag name string from the specified flags bitmap
+
+    @param[in]
+        flags
+            32-bit flags bitmap
+
+    @param[out]
+        flagsString
+            pointer to a buffer to store the comma separated flag string
+
+    @param[in]
+        len
+            size of the buffer to store the comma separated flag string
+
+
+    @retval EOK - the flags parsing was successful
+    @retval EINVAL - invalid arguments
+    @retval E2BIG - not enough space in the output buffer for the flag string
+
+==============================================================================*/
+int VARSERVER_FlagsToStr( uint32_t flags,
+                          char *flagsString,
+                          size_t len )
+{
+    int i=1;
+    size_t remaining = len;
+    size_t offset = 0;
+    int count = 0;
+    int result = EINVAL;
+
+    if( ( flagsString != NULL ) &&
+        ( len > 0 ) )
+    {
+        /* indicate success until we know otherwise */
+        result = EOK;
+
+        while( flagNames[i] != NULL )
+        {
+            if( flags & ( 1 << ( i-1 ) ) )
+            {
+                /* calculate length needed for the flag name */
+                len = strlen( flagNames[i] );
+
+                if( count > 0 )
+                {
+                    /* add one for the comma separator */
+                    len++;
+                }
+
+                /* check if we have enough space for the flag in the string */
+                if( remaining > len )
+                {
+                    /* check if this is not the first flag */
+                    if( count > 0 )
+                    {
+                        /* prepend a comma */
+                        flagsString[offset] = ',';
+                        offset++;
+                        remaining--;
+                    }
+
+                    /* build the flags string */
+                    strcpy( &flagsString[offset], flagNames[i] );
+
+                    /* adjust offset and remaining byte count by the
+                       length of the flag name */
+                    offset += len;
+                    remaining -= len;
+
+                    /* increment the flags count */
+                    count++;
+                }
+                else
+                {
+                    /* we have run out of space for the flags string */
+                    result = E2BIG;
+                }
+            }
+
+            /* move to the next flag */
+            i++;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARSERVER_ParseValueString                                                */
+/*!
+    Parse a value string and assign a value to the VarObject
+
+    The VARSERVER_ParseValueString function parses a value string
+    and converts the string into an appropriate value depending on
+    the variable type.  The converted value is stored into the
+    specfied VarObject.
+
+    @param[out]
+        var
+            pointer to a VarObject to receive the parsed value
+
+    @param[out]
+        valueString
+            pointer to a value string to be parsed
+
+    @retval EOK - the value string was successfully parsed and stored
+    @retval EINVAL - invalid arguments
+    @retval E2BIG - the specified string was too large
+    @retval ERANGE - the specified value does not fit in the variable type
+    @retval ENOTSUP - unsupported data type
+
+==============================================================================*/
+int VARSERVER_ParseValueString( VarObject *var, char *valueString )
+{
+    int result = EINVAL;
+    size_t len;
+    int base = 0;
+
+    if( ( var != NULL ) &&
+        ( valueString != NULL ) )
+    {
+        /* assume success until we determine otherwise */
+        result = EOK;
+
+        if( ( valueString[0] == '0' ) &&
+            ( tolower(valueString[1]) == 'x' ) )
+        {
+            base = 16;
+        }
+
+        switch( var->type )
+        {
+            case VARTYPE_INT16:
+                var->val.i = (int16_t)strtol( valueString, NULL, base );
+                break;
+
+            case VARTYPE_UINT16:
+                var->val.ui = (uint16_t)strtoul( valueString, NULL, base );
+                break;
+
+            case VARTYPE_INT32:
+                var->val.l = strtol( valueString, NULL, base );
+                break;
+
+            case VARTYPE_UINT32:
+                var->val.ul = strtoul( valueString, NULL, base );
+                break;
+
+            case VARTYPE_INT64:
+                var->val.ll = strtoll( valueString, NULL, base );
+                break;
+
+            case VARTYPE_UINT64:
+                var->val.ull = strtoull( valueString, NULL, base );
+                break;
+
+            case VARTYPE_FLOAT:
+                var->val.f = strtof( valueString, NULL );
+                break;
+
+            case VARTYPE_STR:
+                if( var->val.str != NULL)
+                {
+                    len = strlen( valueString );
+                    if( len < var->len )
+                    {
+                        strcpy( var->val.str, valueString );
+                    }
+                    else
+                    {
+                        result = E2BIG;
+                    }
+                }
+                else
+                {
+                    result = ENOMEM;
+                }
+
+                break;
+
+            case VARTYPE_BLOB:
+                if( var->val.blob != NULL)
+                {
+                    len = strlen( valueString );
+                    if( len <= var->len )
+                    {
+                        memcpy( var->val.blob, valueString, len );
+                    }
+                    else
+                    {
+                        result = E2BIG;
+                    }
+                }
+                else
+                {
+                    result = ENOMEM;
+                }
+
+                break;
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_FindByName                                                            */
+/*!
+    Find a variable given its name
+
+    The VAR_FindByName function requests the handle for the specified
+    variable from the variable server.  If the client has enabled its
+    name cache (see VAR_EnableNameCache), previously resolved names
+    are returned from the cache without a round trip to the server.
+    Names owned by a shard server are resolved by that server, and
+    are not cached.
+
+    @param[in]
+        hVarServer
+            handle to the Variable Server
+
+    @param[in]
+        pName
+            pointer to the variable name
+
+    @retval handle of the variable
+    @retval VAR_INVALID if the variable cannot be found
+
+==============================================================================*/
+VAR_HANDLE VAR_FindByName( VARSERVER_HANDLE hVarServer, char *pName )
+{
+    VAR_HANDLE hVar = VAR_INVALID;
+    VarClient *pRoot = ValidateHandle( hVarServer );
+    VarClient *pVarClient = NULL;
+    NameCacheEntry *pEntry = NULL;
+    int rc;
+    size_t len;
+
+    if( ( pRoot != NULL ) &&
+        ( pName != NULL ) )
+    {
+        len = strlen(pName);
+
+        /* get the connection to the server which owns the name */
+        pVarClient = var_Shard( pRoot, var_NameShard( pRoot, pName ) );
+        if( ( len < MAX_NAME_LEN ) &&
+            ( pVarClient != NULL ) )
+        {
+            if( pVarClient == pRoot )
+            {
+                pEntry = var_NameCacheEntry( pVarClient, pName );
+            }
+
+            if( ( pEntry != NULL ) &&
+                ( pEntry->hVar != VAR_INVALID ) &&
+                ( strcmp( pEntry->name, pName ) == 0 ) )
+            {
+                /* the name was resolved previously */
+                hVar = pEntry->hVar;
+            }
+            else
+            {
+                pVarClient->variableInfo.instanceID = 0;
+
+                /* copy the name to the variable info request */
+                var_parseName( pVarClient->variableInfo.name,
+                               MAX_NAME_LEN,
+                               pName,
+                               &pVarClient->variableInfo.instanceID );
+
+                /* specify the request type */
+                pVarClient->requestType = VARREQUEST_FIND;
+
+                rc = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+                if( rc == EOK )
+                {
+                    hVar = var_ShardHandle( pVarClient,
+                                (VAR_HANDLE)pVarClient->responseVal );
+                }
+
+                if( ( pEntry != NULL ) &&
+                    ( hVar != VAR_INVALID ) )
+                {
+                    /* remember the name resolution */
+                    memcpy( pEntry->name, pName, len + 1 );
+                    pEntry->hVar = hVar;
+                }
+            }
+        }
+    }
+
+    return hVar;
+}
+
+/*============================================================================*/
+/*  VAR_EnableNameCache                                                       */
+/*!
+    Enable the client name resolution cache
+
+    The VAR_EnableNameCache function enables a cache of variable name
+    to handle mappings for the client.  Once enabled, repeated calls to
+    VAR_FindByName for the same name are resolved from local memory.
+    The cache is discarded whenever the server's name resolution
+    generation changes, which happens when the server restarts or a
+    variable alias is moved.  Names which cannot be found are not
+    cached.
+
+    The cache is direct mapped, so names which hash to the same entry
+    replace each other.
+
+    @param[in]
+        hVarServer
+            handle to the Variable Server
+
+    @param[in]
+        size
+            number of cache entries, rounded up to a power of two.
+            Specify 0 to use VARSERVER_NAME_CACHE_DEFAULT_SIZE
+
+    @retval EOK - the name cache is enabled
+    @retval EALREADY - the name cache was already enabled
+    @retval ENOMEM - memory allocation failed
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_EnableNameCache( VARSERVER_HANDLE hVarServer, size_t size )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    size_t n = 1;
+
+    if( ( pVarClient != NULL ) &&
+        ( pVarClient->pServerInfo != NULL ) )
+    {
+        if( pVarClient->pNameCache != NULL )
+        {
+            result = EALREADY;
+        }
+        else
+        {
+            if( size == 0 )
+            {
+                size = VARSERVER_NAME_CACHE_DEFAULT_SIZE;
+            }
+
+            while( n < size )
+            {
+                n <<= 1;
+            }
+
+            pVarClient->pNameCache = calloc( n, sizeof( NameCacheEntry ) );
+            if( pVarClient->pNameCache != NULL )
+            {
+                pVarClient->nameCacheSize = n;
+                pVarClient->nameCacheGeneration =
+                    __atomic_load_n( &pVarClient->pServerInfo->generation,
+                                     __ATOMIC_ACQUIRE );
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  var_NameCacheEntry                                                        */
+/*!
+    Get the name cache entry for a variable name
+
+    The var_NameCacheEntry function gets the name cache entry which the
+    specified variable name maps to.  If the server's name resolution
+    generation has changed since the cache was populated, every entry
+    in the cache is discarded first.
+
+    @param[in]
+        pVarClient
+            pointer to the Variable Client
+
+    @param[in]
+        pName
+            pointer to the variable name
+
+    @retval pointer to the name cache entry for the name
+    @retval NULL if the name cache is not enabled
+
+==============================================================================*/
+static NameCacheEntry *var_NameCacheEntry( VarClient *pVarClient,
+                                           const char *pName )
+{
+    NameCacheEntry *pEntry = NULL;
+    uint64_t generation;
+    uint32_t hash = 2166136261U;
+    const unsigned char *p = (const unsigned char *)pName;
+
+    if( pVarClient->pNameCache != NULL )
+    {
+        generation = __atomic_load_n( &pVarClient->pServerInfo->generation,
+                                      __ATOMIC_ACQUIRE );
+        if( generation != pVarClient->nameCacheGeneration )
+        {
+            /* the cached mappings may no longer be valid */
+            memset( pVarClient->pNameCache,
+                    0,
+                    pVarClient->nameCacheSize * sizeof( NameCacheEntry ) );
+            pVarClient->nameCacheGeneration = generation;
+        }
+
+        /* FNV-1a hash of the name */
+        while( *p != '\0' )
+        {
+            hash = ( hash ^ *p++ ) * 16777619U;
+        }
+
+        pEntry = &pVarClient->pNameCache[hash & (pVarClient->nameCacheSize-1)];
+    }
+
+    return pEntry;
+}
+
+/*============================================================================*/
+/*  var_parseName                                                             */
+/*!
+    Parse a variable name and extract its instance identifier
+
+    The var_parseName function processes a variable name and
+    extracts its instance identifier.
+
+    eg
+
+    [12345]/foo/baa/baz -> "/foo/baa/baz", 12345
+    /foo[12345]/baa/baz -> "/foo/baa/baz", 12345
+
+    @param[in,out]
+        dst
+            output buffer for variable name string
+
+    @param[in]
+        len
+            size of output buffer
+
+    @param[in]
+        src
+            pointer to input buffer
+
+    @param[in,out]
+        id
+            pointer to a uint32 to store the instance id
+
+    @retval EOK variable name processed ok
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int var_parseName( char *dst, size_t len, char *src, uint32_t *id )
+{
+    int result = EINVAL;
+    char idstr[32] = {0};
+    int i = 0;
+    int state = 0;
+    char *s = src;
+    char *d = dst;
+    size_t n = 0;
+    char c;
+
+    if ( ( s != NULL ) &&
+         ( d != NULL ) &&
+         ( id != NULL ) )
+    {
+        while( ( ( c = *s++ ) != 0 ) &&
+               ( n < len-1 ) )
+        {
+            switch( state )
+            {
+                case 0:
+                    /* looking for instanceID */
+                    if ( c == '[' )
+                    {
+                        /* start of instanceID */
+                        state = 1;
+                    }
+                    else
+                    {
+                        /* collect variable name character */
+                        *d++ = c;
+                        n++;
+                    }
+                    break;
+
+                case 1:
+                    /* collect instance ID */
+                    if ( c == ']' )
+                    {
+                        /* terminate instanceID */
+                        idstr[i] = 0;
+                        *id = atol(idstr);
+                        state = 2;
+                    }
+                    else
+                    {
+                        if ( i < 31 )
+                        {
+                            idstr[i++] = c;
+                        }
+                    }
+                    break;
+
+                case 2:
+                    /* collect variable name character */
+                    *d++ = c;
+                    n++;
+                    break;
+
+                default:
+                    /* should never get here */
+                    *d++ = c;
+                    n++;
+                    break;
+            }
+        }
+
+        /* NUL terminate the name */
+        *d = '\0';
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_Get                                                                   */
+/*!
+    Get a variable value and store it in the specified var object
+
+    The VAR_Get function gets the value of the variable
+    specified by hVar and puts it into the specified var object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to be retrieved
+
+    @param[in]
+        pVarObject
+            specifies the location where the variable value should be stored
+
+    @retval EOK - the variable was retrieved ok
+    @retval E2BIG - the value is too large for the working buffer
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_Get( VARSERVER_HANDLE hVarServer,
+             VAR_HANDLE hVar,
+             VarObject *pVarObject )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( ( pVarClient != NULL ) &&
+        ( pVarObject != NULL ) )
+    {
+        /* try to read the value directly from shared memory */
+        result = var_GetSharedValue( pVarClient, hVar, pVarObject );
+        if ( result != EOK )
+        {
+            pVarClient->requestType = VARREQUEST_GET;
+            pVarClient->variableInfo.hVar = hVar;
+
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if( ( result == EOK ) &&
+                ( pVarClient->responseVal == E2BIG ) )
+            {
+                /* the server has returned the length of the value which
+                   did not fit, so grow the working buffer and retry */
+                result = var_GrowWorkbuf(
+                                pVarClient,
+                                pVarClient->variableInfo.var.len + 1 );
+                if ( result == EOK )
+                {
+                    pVarClient->requestType = VARREQUEST_GET;
+                    pVarClient->variableInfo.hVar = hVar;
+
+                    result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+                }
+
+                if ( ( result == EOK ) &&
+                     ( pVarClient->responseVal == E2BIG ) )
+                {
+                    result = E2BIG;
+                }
+            }
+
+            if( result == EOK )
+            {
+                result = var_GetVarObject( pVarClient, pVarObject );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetMany                                                               */
+/*!
+    Get the values of multiple variables
+
+    The VAR_GetMany function gets the values of the n variables specified
+    by hVars and puts them into the corresponding var objects.  The
+    variables are retrieved from the server in batches of up to
+    VARSERVER_MAX_BATCH_ITEMS per request.
+
+    String and blob values are returned as for VAR_Get.  Variables which
+    cannot be retrieved in a batch (for example those with a CALC
+    handler, or large strings which do not fit in the working buffer)
+    are retrieved individually using VAR_Get.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVars
+            array of n handles of the variables to be retrieved
+
+    @param[in,out]
+        pVarObjects
+            array of n var objects to store the variable values
+
+    @param[out]
+        results
+            optional array of n locations to store the per-variable
+            result codes.  May be NULL.
+
+    @param[in]
+        n
+            number of variables to retrieve
+
+    @retval EOK - all of the variables were retrieved ok
+    @retval EINVAL - invalid arguments
+    @retval other - the result of the first variable which failed
+
+==============================================================================*/
+int VAR_GetMany( VARSERVER_HANDLE hVarServer,
+                 VAR_HANDLE *hVars,
+                 VarObject *pVarObjects,
+                 int *results,
+                 size_t n )
+{
+    int result = EINVAL;
+    VarClient *pRoot = ValidateHandle( hVarServer );
+    VarClient *pVarClient;
+    VarBatchItem *pItems;
+    int rc[VARSERVER_MAX_BATCH_ITEMS];
+    int first = EOK;
+    size_t maxItems;
+    size_t count;
+    size_t i = 0;
+    size_t j;
+
+    if( ( pRoot != NULL ) &&
+        ( hVars != NULL ) &&
+        ( pVarObjects != NULL ) )
+    {
+        maxItems = pRoot->workbufsize / sizeof( VarBatchItem );
+        if( maxItems > VARSERVER_MAX_BATCH_ITEMS )
+        {
+            maxItems = VARSERVER_MAX_BATCH_ITEMS;
+        }
+
+        result = ( maxItems > 0 ) ? EOK : E2BIG;
+
+        while( ( result == EOK ) && ( i < n ) )
+        {
+            /* find the consecutive variables owned by the same shard */
+            count = 1;
+            while( ( i + count < n ) &&
+                   ( count < maxItems ) &&
+                   ( ( hVars[i+count] >> VARSERVER_SHARD_SHIFT ) ==
+                     ( hVars[i] >> VARSERVER_SHARD_SHIFT ) ) )
+            {
+                count++;
+            }
+
+            pVarClient = var_Shard( pRoot,
+                                    hVars[i] >> VARSERVER_SHARD_SHIFT );
+            if( pVarClient == NULL )
+            {
+                /* the shard is not available */
+                for( j = 0; j < count; j++ )
+                {
+                    rc[j] = EINVAL;
+                }
+            }
+            else
+            {
+                /* pack the variable handles into the working buffer */
+                pItems = (VarBatchItem *)&pVarClient->workbuf;
+                for( j = 0; j < count; j++ )
+                {
+                    pItems[j].hVar = hVars[i+j] & VARSERVER_SHARD_HANDLE_MASK;
+                    pItems[j].result = EINVAL;
+                }
+
+                pVarClient->requestType = VARREQUEST_GET_MANY;
+                pVarClient->requestVal = count;
+
+                result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+                if( ( result == EOK ) &&
+                    ( pVarClient->responseVal != (int)count ) )
+                {
+                    result = EIO;
+                }
+
+                /* unpack the results before the working buffer is reused */
+                for( j = 0; ( result == EOK ) && ( j < count ); j++ )
+                {
+                    rc[j] = pItems[j].result;
+                    if( rc[j] == EOK )
+                    {
+                        rc[j] = var_GetBatchObject( pVarClient,
+                                                    &pItems[j],
+                                                    &pVarObjects[i+j] );
+                    }
+                }
+            }
+
+            if( result == EOK )
+            {
+                for( j = 0; j < count; j++ )
+                {
+                    if( ( rc[j] == EWOULDBLOCK ) || ( rc[j] == E2BIG ) )
+                    {
+                        /* retrieve the variable individually */
+                        rc[j] = VAR_Get( hVarServer,
+                                         hVars[i+j],
+                                         &pVarObjects[i+j] );
+                    }
+
+                    if( results != NULL )
+                    {
+                        results[i+j] = rc[j];
+                    }
+
+                    if( ( rc[j] != EOK ) && ( first == EOK ) )
+                    {
+                        first = rc[j];
+                    }
+                }
+
+                i += count;
+            }
+        }
+
+        if( result == EOK )
+        {
+            result = first;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_ShareValue                                                            */
+/*!
+    Request direct shared memory access to a variable value
+
+    The VAR_ShareValue function asks the variable server to publish the
+    value of the specified variable in the shared value segment.
+    Once shared, subsequent calls to VAR_Get for the variable handle
+    read the value directly from shared memory without a round trip
+    to the server.
+
+    Only primitive (non-string, non-blob) variables which the client
+    is permitted to read can be shared.  Password variables, variables
+    with a read permission list, and variables with a CALC handler are
+    always read via the server.  The shared value segment can only be
+    mapped by clients running as the server user.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to share
+
+    @retval EOK - the variable value can be read from shared memory
+    @retval ENOTSUP - the variable cannot be shared
+    @retval EACCES - the variable has a read permission list
+    @retval ENOENT - the variable does not exist, or the client cannot
+                     map the shared value segment
+    @retval ENOMEM - the shared value segment is full
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_ShareValue( VARSERVER_HANDLE hVarServer, VAR_HANDLE hVar )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( ( pVarClient != NULL ) &&
+        ( hVar != VAR_INVALID ) &&
+        ( hVar < VARSERVER_MAX_SHARED_HANDLES ) )
+    {
+        /* map the shared value segment on first use */
+        result = var_MapSharedValues( pVarClient );
+        if ( result == EOK )
+        {
+            pVarClient->requestType = VARREQUEST_SHARE_VALUE;
+            pVarClient->variableInfo.hVar = hVar;
+
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if ( result == EOK )
+            {
+                result = pVarClient->responseVal;
+                if ( result == EOK )
+                {
+                    /* grant direct access to the variable value */
+                    pVarClient->pSharedGrants[hVar / 8] |= ( 1 << (hVar % 8) );
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_OpenBlob                                                              */
+/*!
+    Map the zero-copy segment of a blob variable
+
+    The VAR_OpenBlob function asks the variable server to move the
+    value of the specified blob variable into its own zero-copy shared
+    memory segment, and maps the segment into the client's address
+    space.  The value can then be read in place with VAR_BlobReadBegin
+    and VAR_BlobReadEnd, and written in place with VAR_BlobWriteBegin
+    and VAR_BlobWriteCommit, without copying it through the working
+    buffer.  VAR_Get and VAR_Set continue to work on the variable.
+
+    Password variables and variables with a CALC or VALIDATE handler
+    cannot be mapped.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the blob variable
+
+    @param[out]
+        ppVarBlob
+            pointer to a location to store the blob mapping, which is
+            released with VAR_CloseBlob
+
+    @retval EOK - the blob segment was mapped
+    @retval ENOTSUP - the variable cannot be mapped
+    @retval ENOENT - the variable does not exist
+    @retval EACCES - the client may not write to the variable
+    @retval ENOMEM - the blob segment could not be mapped
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_OpenBlob( VARSERVER_HANDLE hVarServer,
+                  VAR_HANDLE hVar,
+                  VarBlob **ppVarBlob )
+{
+    int result = EINVAL;
+    VAR_HANDLE hRequest = hVar;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ),
+                                       &hRequest );
+    VarBlob *pVarBlob = NULL;
+    char base[BUFSIZ];
+    char name[BUFSIZ];
+    struct stat sb;
+    void *p = MAP_FAILED;
+    uint32_t storageRef;
+    int fd;
+
+    if( ( pVarClient != NULL ) &&
+        ( hRequest != VAR_INVALID ) &&
+        ( ppVarBlob != NULL ) )
+    {
+        pVarClient->requestType = VARREQUEST_SHARE_BLOB;
+        pVarClient->variableInfo.hVar = hRequest;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if ( result == EOK )
+        {
+            result = pVarClient->responseVal;
+        }
+
+        if ( result == EOK )
+        {
+            storageRef = pVarClient->variableInfo.storageRef;
+            snprintf( base,
+                      sizeof( base ),
+                      "%s_%" PRIu32,
+                      SERVER_SHAREDBLOB,
+                      storageRef );
+            result = ShardName( name, sizeof( name ), base, pVarClient->shard );
+        }
+
+        if ( result == EOK )
+        {
+            fd = shm_open( name, O_RDWR, S_IRUSR | S_IWUSR );
+            if ( fd != -1 )
+            {
+                if ( ( fstat( fd, &sb ) == 0 ) &&
+                     ( (size_t)sb.st_size >= sizeof( SharedBlob ) ) )
+                {
+                    p = mmap( NULL,
+                              sb.st_size,
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED,
+                              fd,
+                              0 );
+                }
+
+                close( fd );
+                result = ( p != MAP_FAILED ) ? EOK : ENOMEM;
+            }
+            else
+            {
+                result = errno;
+            }
+        }
+
+        if ( ( result == EOK ) &&
+             ( ( __atomic_load_n( &((SharedBlob *)p)->magic,
+                                  __ATOMIC_ACQUIRE ) != SHARED_BLOB_MAGIC ) ||
+               ( ((SharedBlob *)p)->storageRef != storageRef ) ) )
+        {
+            /* the segment does not belong to this variable */
+            result = ENOENT;
+        }
+
+        if ( result == EOK )
+        {
+            pVarBlob = calloc( 1, sizeof( VarBlob ) );
+            if ( pVarBlob != NULL )
+            {
+                pVarBlob->hVar = hVar;
+                pVarBlob->pSharedBlob = (SharedBlob *)p;
+                pVarBlob->size = sb.st_size;
+                *ppVarBlob = pVarBlob;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+
+        if ( ( result != EOK ) &&
+             ( p != MAP_FAILED ) )
+        {
+            munmap( p, sb.st_size );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_CloseBlob                                                             */
+/*!
+    Unmap the zero-copy segment of a blob variable
+
+    The VAR_CloseBlob function releases a blob mapping created by
+    VAR_OpenBlob, discarding any write in progress.
+
+    @param[in]
+        pVarBlob
+            pointer to the blob mapping
+
+    @retval EOK - the blob segment was unmapped
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_CloseBlob( VarBlob *pVarBlob )
+{
+    int result = EINVAL;
+
+    if ( pVarBlob != NULL )
+    {
+        SharedBlobUnlock( pVarBlob->pSharedBlob, getpid() );
+        munmap( pVarBlob->pSharedBlob, pVarBlob->size );
+        free( pVarBlob );
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_BlobReadBegin                                                         */
+/*!
+    Start reading a zero-copy blob value in place
+
+    The VAR_BlobReadBegin function gets a pointer to the current value
+    of a mapped blob, without a round trip to the server.  The value
+    stays intact while the next value is being written, and the read
+    must be confirmed with VAR_BlobReadEnd once the caller has finished
+    with the data.
+
+    @param[in]
+        pVarBlob
+            pointer to the blob mapping
+
+    @param[out]
+        ppData
+            pointer to a location to store a pointer to the value
+
+    @param[out]
+        pLen
+            pointer to a location to store the length of the value
+
+    @param[out]
+        pGeneration
+            pointer to a location to store the generation of the value,
+            to be passed to VAR_BlobReadEnd
+
+    @retval EOK - the value is available
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_BlobReadBegin( VarBlob *pVarBlob,
+                       const void **ppData,
+                       size_t *pLen,
+                       uint64_t *pGeneration )
+{
+    int result = EINVAL;
+    SharedBlob *pSharedBlob;
+    uint64_t generation;
+    int idx;
+
+    if ( ( pVarBlob != NULL ) &&
+         ( ppData != NULL ) &&
+         ( pLen != NULL ) &&
+         ( pGeneration != NULL ) )
+    {
+        pSharedBlob = pVarBlob->pSharedBlob;
+        generation = __atomic_load_n( &pSharedBlob->generation,
+                                      __ATOMIC_ACQUIRE );
+        idx = generation & 1;
+
+        *ppData = (char *)pSharedBlob + pSharedBlob->offset[idx];
+        *pLen = pSharedBlob->len[idx];
+        *pGeneration = generation;
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_BlobReadEnd                                                           */
+/*!
+    Confirm a zero-copy blob value read in place
+
+    The VAR_BlobReadEnd function checks that the value obtained from
+    VAR_BlobReadBegin was not overwritten while it was being read.
+    The buffer is only reused by the writer after the next one, so the
+    read is intact unless two or more new values were committed, or
+    one was committed and another write started, during the read.  If
+    the read was not intact, the caller should discard what it read
+    and start again.
+
+    @param[in]
+        pVarBlob
+            pointer to the blob mapping
+
+    @param[in]
+        generation
+            generation of the value returned by VAR_BlobReadBegin
+
+    @retval EOK - the value read was intact
+    @retval EAGAIN - the value was overwritten during the read
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_BlobReadEnd( VarBlob *pVarBlob, uint64_t generation )
+{
+    int result = EINVAL;
+    SharedBlob *pSharedBlob;
+    uint64_t current;
+    int32_t writer;
+
+    if ( pVarBlob != NULL )
+    {
+        pSharedBlob = pVarBlob->pSharedBlob;
+
+        /* order the data reads before the checks */
+        __atomic_thread_fence( __ATOMIC_ACQUIRE );
+        writer = __atomic_load_n( &pSharedBlob->writer, __ATOMIC_ACQUIRE );
+        current = __atomic_load_n( &pSharedBlob->generation,
+                                   __ATOMIC_ACQUIRE );
+
+        if ( ( current == generation ) ||
+             ( ( current == generation + 1 ) && ( writer == 0 ) ) )
+        {
+            result = EOK;
+        }
+        else
+        {
+            result = EAGAIN;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_BlobWriteBegin                                                        */
+/*!
+    Start writing a zero-copy blob value in place
+
+    The VAR_BlobWriteBegin function locks the buffer which will hold
+    the next value of a mapped blob, and gets a pointer to it.  The
+    caller fills the buffer and publishes it with VAR_BlobWriteCommit,
+    or gives it up with VAR_BlobWriteAbort.  Readers continue to see
+    the current value until the new one is committed.  The buffer
+    holds an old value, not the current one.
+
+    @param[in]
+        pVarBlob
+            pointer to the blob mapping
+
+    @param[out]
+        ppData
+            pointer to a location to store a pointer to the buffer
+
+    @param[out]
+        pCapacity
+            pointer to a location to store the size of the buffer
+
+    @retval EOK - the buffer was locked
+    @retval EBUSY - another client or the server is writing a new value
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_BlobWriteBegin( VarBlob *pVarBlob,
+                        void **ppData,
+                        size_t *pCapacity )
+{
+    int result = EINVAL;
+    SharedBlob *pSharedBlob;
+    uint64_t generation;
+
+    if ( ( pVarBlob != NULL ) &&
+         ( ppData != NULL ) &&
+         ( pCapacity != NULL ) )
+    {
+        pSharedBlob = pVarBlob->pSharedBlob;
+        result = SharedBlobLock( pSharedBlob, getpid() );
+        if ( result == EOK )
+        {
+            /* the generation cannot change while we hold the lock */
+            generation = __atomic_load_n( &pSharedBlob->generation,
+                                          __ATOMIC_ACQUIRE );
+
+            *ppData = (char *)pSharedBlob +
+                      pSharedBlob->offset[( generation + 1 ) & 1];
+            *pCapacity = pSharedBlob->capacity;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_BlobWriteCommit                                                       */
+/*!
+    Publish a zero-copy blob value written in place
+
+    The VAR_BlobWriteCommit function asks the variable server to make
+    the buffer filled after VAR_BlobWriteBegin the current value of the
+    blob.  Only the length of the value is sent to the server.  The
+    change is then handled as for VAR_Set, including the change
+    notifications, and the write lock is released.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pVarBlob
+            pointer to the blob mapping
+
+    @param[in]
+        len
+            length of the new value
+
+    @retval EOK - the new value was committed
+    @retval EPERM - the client had not locked the buffer
+    @retval E2BIG - the value is larger than the blob
+    @retval ENOTSUP - the variable has acquired a VALIDATE handler
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_BlobWriteCommit( VARSERVER_HANDLE hVarServer,
+                         VarBlob *pVarBlob,
+                         size_t len )
+{
+    int result = EINVAL;
+    VAR_HANDLE hVar = ( pVarBlob != NULL ) ? pVarBlob->hVar : VAR_INVALID;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( ( pVarClient != NULL ) &&
+        ( hVar != VAR_INVALID ) )
+    {
+        pVarClient->requestType = VARREQUEST_COMMIT_BLOB;
+        pVarClient->variableInfo.hVar = hVar;
+        pVarClient->variableInfo.var.type = VARTYPE_BLOB;
+        pVarClient->variableInfo.var.len = len;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if ( result == EOK )
+        {
+            result = pVarClient->responseVal;
+        }
+        else
+        {
+            /* the server did not see the request */
+            SharedBlobUnlock( pVarBlob->pSharedBlob, getpid() );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_BlobWriteAbort                                                        */
+/*!
+    Abandon a zero-copy blob value written in place
+
+    The VAR_BlobWriteAbort function releases the buffer locked by
+    VAR_BlobWriteBegin without changing the value of the blob.
+
+    @param[in]
+        pVarBlob
+            pointer to the blob mapping
+
+    @retval EOK - the buffer was released
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_BlobWriteAbort( VarBlob *pVarBlob )
+{
+    int result = EINVAL;
+
+    if ( pVarBlob != NULL )
+    {
+        SharedBlobUnlock( pVarBlob->pSharedBlob, getpid() );
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  var_GetSharedValue                                                        */
+/*!
+    Read a variable value from the shared value segment
+
+    The var_GetSharedValue function reads the value of the specified
+    variable directly from the shared value segment if the client has
+    been granted access to it via VAR_ShareValue.
+
+    The value is protected by a sequence counter.  The read is retried
+    if the server was updating the value while it was being read.
+
+    @param[in]
+        pVarClient
+            pointer to the Variable Client
+
+    @param[in]
+        hVar
+            handle of the variable to read
+
+    @param[out]
+        pVarObject
+            pointer to the VarObject to receive the value
+
+    @retval EOK - the value was read from shared memory
+    @retval ENOENT - the value is not available in shared memory
+    @retval EBUSY - a consistent value could not be read
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+static int var_GetSharedValue( VarClient *pVarClient,
+                               VAR_HANDLE hVar,
+                               VarObject *pVarObject )
+{
+    int result = EINVAL;
+    SharedValues *pSharedValues;
+    volatile SharedValue *pSharedValue;
+    uint16_t slot;
+    uint32_t seq;
+    uint32_t type;
+    uint32_t len;
+    VarData val;
+    int retries = 1000;
+
+    if ( ( pVarClient != NULL ) &&
+         ( pVarObject != NULL ) )
+    {
+        result = ENOENT;
+
+        pSharedValues = pVarClient->pSharedValues;
+        if ( ( pSharedValues != NULL ) &&
+             ( pVarClient->pSharedGrants != NULL ) &&
+             ( hVar < VARSERVER_MAX_SHARED_HANDLES ) &&
+             ( pVarClient->pSharedGrants[hVar / 8] & ( 1 << (hVar % 8) ) ) )
+        {
+            slot = __atomic_load_n( &pSharedValues->index[hVar],
+                                    __ATOMIC_ACQUIRE );
+            if ( ( slot != 0 ) &&
+                 ( slot < VARSERVER_MAX_SHARED_VALUES ) )
+            {
+                pSharedValue = &pSharedValues->values[slot];
+
+                result = EBUSY;
+                while ( retries-- > 0 )
+                {
+                    seq = __atomic_load_n( &pSharedValue->seq,
+                                           __ATOMIC_ACQUIRE );
+                    if ( seq & 1 )
+                    {
+                        /* the server is updating the value */
+                        continue;
+                    }
+
+                    type = pSharedValue->type;
+                    len = pSharedValue->len;
+                    val = pSharedValue->val;
+
+                    __atomic_thread_fence( __ATOMIC_ACQUIRE );
+                    if ( seq == __atomic_load_n( &pSharedValue->seq,
+                                                 __ATOMIC_RELAXED ) )
+                    {
+                        result = EOK;
+                        break;
+                    }
+                }
+
+                if ( result == EOK )
+                {
+                    if ( type == VARTYPE_INVALID )
+                    {
+                        /* the value must be obtained from the server */
+                        result = ENOENT;
+                    }
+                    else
+                    {
+                        pVarObject->type = type;
+                        pVarObject->len = len;
+                        pVarObject->val = val;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  var_GetBatchObject                                                        */
+/*!
+    Get a variable value from a GET_MANY batch item
+
+    The var_GetBatchObject function copies the value returned in a
+    GET_MANY batch item into the specified var object.  String and blob
+    values are copied from the working buffer following the same rules
+    as VAR_Get.
+
+    @param[in]
+        pVarClient
+            pointer to the Variable Client
+
+    @param[in]
+        pItem
+            pointer to the batch item containing the variable value
+
+    @param[in,out]
+        pVarObject
+            pointer to the var object to store the value in
+
+    @retval EOK - the value was copied
+    @retval E2BIG - the var object buffer is too small
+    @retval ENOMEM - memory could not be allocated for the value
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+static int var_GetBatchObject( VarClient *pVarClient,
+                               VarBatchItem *pItem,
+                               VarObject *pVarObject )
+{
+    int result = EINVAL;
+    char *pSrc;
+    size_t srclen;
+
+    if( ( pVarClient != NULL ) &&
+        ( pItem != NULL ) &&
+        ( pVarObject != NULL ) )
+    {
+        pVarObject->type = pItem->var.type;
+        pSrc = &pVarClient->workbuf + pItem->offset;
+
+        if( ( pItem->var.type == VARTYPE_STR ) ||
+            ( pItem->var.type == VARTYPE_BLOB ) )
+        {
+            if( pItem->var.type == VARTYPE_STR )
+            {
+                srclen = strlen( pSrc ) + 1;
+            }
+            else
+            {
+                srclen = pItem->var.len;
+            }
+
+            if( pVarObject->val.blob == NULL )
+            {
+                /* allocate memory for the target value */
+                pVarObject->len = ( pItem->var.len > srclen ) ? pItem->var.len
+                                                              : srclen;
+                pVarObject->val.blob = calloc( 1, pVarObject->len );
+            }
+
+            if( pVarObject->val.blob == NULL )
+            {
+                result = ENOMEM;
+            }
+            else if( pVarObject->len >= srclen )
+            {
+                memcpy( pVarObject->val.blob, pSrc, srclen );
+                result = EOK;
+            }
+            else
+            {
+                /* not enough space to store the value */
+                result = E2BIG;
+            }
+        }
+        else
+        {
+            /* copy primitive type */
+            pVarObject->val = pItem->var.val;
+            pVarObject->len = pItem->var.len;
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  var_PackCreateBatch                                                       */
+/*!
+    Pack variable definitions into a NEW_MANY batch
+
+    The var_PackCreateBatch function packs as many of the specified
+    variable definitions as will fit into the client's working buffer.
+    Each VarCreateItem is followed by the variable name, tag specifier
+    and initial string or blob value.
+
+    @param[in]
+        pVarClient
+            pointer to the Variable Client
+
+    @param[in]
+        pVarInfo
+            array of variable definitions
+
+    @param[in]
+        n
+            number of definitions available to be packed
+
+    @retval number of definitions packed into the batch
+
+==============================================================================*/
+static size_t var_PackCreateBatch( VarClient *pVarClient,
+                                   VarInfo *pVarInfo,
+                                   size_t n )
+{
+    VarCreateItem *pItem;
+    VarInfo *pInfo;
+    char *p;
+    size_t offset = 0;
+    size_t count = 0;
+    size_t nameLen;
+    size_t tagLen;
+    size_t valueLen;
+    size_t size;
+
+    while( ( count < n ) && ( count < VARSERVER_MAX_BATCH_ITEMS ) )
+    {
+        pInfo = &pVarInfo[count];
+
+        nameLen = strnlen( pInfo->name, MAX_NAME_LEN ) + 1;
+        tagLen = strnlen( pInfo->tagspec, MAX_TAGSPEC_LEN - 1 ) + 1;
+
+        valueLen = 0;
+        if( ( pInfo->var.type == VARTYPE_STR ) &&
+            ( pInfo->var.val.str != NULL ) )
+        {
+            valueLen = strnlen( pInfo->var.val.str, pInfo->var.len ) + 1;
+        }
+        else if( pInfo->var.type == VARTYPE_BLOB )
+        {
+            valueLen = pInfo->var.len;
+        }
+
+        size = ( sizeof( VarCreateItem ) + nameLen + tagLen + valueLen +
+                 VARCREATE_ITEM_ALIGN - 1 ) &
+               ~( (size_t)VARCREATE_ITEM_ALIGN - 1 );
+
+        if( size > pVarClient->workbufsize - offset )
+        {
+            /* no room for this definition */
+            break;
+        }
+
+        pItem = (VarCreateItem *)( &pVarClient->workbuf + offset );
+        memset( pItem, 0, size );
+
+        pItem->size = size;
+        pItem->result = EINVAL;
+        pItem->hVar = VAR_INVALID;
+        pItem->instanceID = pInfo->instanceID;
+        pItem->guid = pInfo->guid;
+        pItem->flags = pInfo->flags;
+        pItem->var = pInfo->var;
+        pItem->permissions = pInfo->permissions;
+        memcpy( pItem->formatspec, pInfo->formatspec, MAX_FORMATSPEC_LEN );
+        pItem->formatspec[MAX_FORMATSPEC_LEN - 1] = '\0';
+
+        /* the item was cleared, so the strings are NUL terminated */
+        p = pItem->name;
+        memcpy( p, pInfo->name, nameLen - 1 );
+        p += nameLen;
+
+        pItem->tagspecOffset = p - (char *)pItem;
+        memcpy( p, pInfo->tagspec, tagLen - 1 );
+        p += tagLen;
+
+        if( valueLen > 0 )
+        {
+            pItem->valueOffset = p - (char *)pItem;
+            if( pInfo->var.type == VARTYPE_STR )
+            {
+                memcpy( p, pInfo->var.val.str, valueLen - 1 );
+            }
+            else if( pInfo->var.val.blob != NULL )
+            {
+                memcpy( p, pInfo->var.val.blob, valueLen );
+            }
+        }
+
+        offset += size;
+        count++;
+    }
+
+    return count;
+}
+
+/*============================================================================*/
+/*  var_PackSetBatch                                                          */
+/*!
+    Pack variable values into a SET_MANY batch
+
+    The var_PackSetBatch function packs as many of the specified variable
+    values as will fit into the client's working buffer.  The VarBatchItem
+    array grows from the start of the working buffer, and any string or
+    blob data is packed from the end of the working buffer.
+
+    @param[in]
+        pVarClient
+            pointer to the Variable Client
+
+    @param[in]
+        hVars
+            array of variable handles
+
+    @param[in]
+        pVarObjects
+            array of variable values
+
+    @param[in]
+        n
+            number of variables available to be packed
+
+    @retval number of variables packed into the batch
+
+==============================================================================*/
+static size_t var_PackSetBatch( VarClient *pVarClient,
+                                VAR_HANDLE *hVars,
+                                VarObject *pVarObjects,
+                                size_t n )
+{
+    VarBatchItem *pItems = (VarBatchItem *)&pVarClient->workbuf;
+    VarObject *pVarObject;
+    size_t dataStart = pVarClient->workbufsize;
+    size_t count = 0;
+    size_t len;
+
+    while( ( count < n ) && ( count < VARSERVER_MAX_BATCH_ITEMS ) )
+    {
+        pVarObject = &pVarObjects[count];
+
+        len = 0;
+        if( pVarObject->type == VARTYPE_STR )
+        {
+            /* include space for the NUL terminator */
+            len = pVarObject->len + 1;
+        }
+        else if( pVarObject->type == VARTYPE_BLOB )
+        {
+            len = pVarObject->len;
+        }
+
+        if( ( count + 1 ) * sizeof( VarBatchItem ) + len > dataStart )
+        {
+            /* no room for this variable */
+            break;
+        }
+
+        dataStart -= len;
+
+        pItems[count].hVar = hVars[count] & VARSERVER_SHARD_HANDLE_MASK;
+        pItems[count].result = EINVAL;
+        pItems[count].offset = dataStart;
+        pItems[count].var = *pVarObject;
+
+        if( pVarObject->type == VARTYPE_STR )
+        {
+            memcpy( &pVarClient->workbuf + dataStart,
+                    pVarObject->val.str,
+                    pVarObject->len );
+            (&pVarClient->workbuf)[dataStart + pVarObject->len] = '\0';
+        }
+        else if( pVarObject->type == VARTYPE_BLOB )
+        {
+            memcpy( &pVarClient->workbuf + dataStart,
+                    pVarObject->val.blob,
+                    len );
+        }
+
+        count++;
+    }
+
+    return count;
+}
+
+/*============================================================================*/
+/*  var_MapSharedValues                                                       */
+/*!
+    Map the shared value segment
+
+    The var_MapSharedValues function maps the variable server's shared
+    value segment into the client's address space (read only) and
+    allocates the client's shared value access grants.  It does nothing
+    if the segment is already mapped.
+
+    @param[in]
+        pVarClient
+            pointer to the Variable Client
+
+    @retval EOK - the shared value segment is mapped
+    @retval ENOENT - the shared value segment does not exist
+    @retval ENOMEM - the shared value segment could not be mapped
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+static int var_MapSharedValues( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    int fd;
+    void *p;
+
+    if ( pVarClient != NULL )
+    {
+        result = EOK;
+
+        if ( pVarClient->pSharedGrants == NULL )
+        {
+            pVarClient->pSharedGrants =
+                    calloc( 1, VARSERVER_MAX_SHARED_HANDLES / 8 );
+            if ( pVarClient->pSharedGrants == NULL )
+            {
+                result = ENOMEM;
+            }
+        }
+
+        if ( ( result == EOK ) &&
+             ( pVarClient->pSharedValues == NULL ) )
+        {
+            fd = shm_open( SERVER_SHAREDVALUES, O_RDONLY, S_IRUSR | S_IWUSR );
+            if ( fd != -1 )
+            {
+                p = mmap( NULL,
+                          sizeof( SharedValues ),
+                          PROT_READ,
+                          MAP_SHARED,
+                          fd,
+                          0 );
+                if ( p != MAP_FAILED )
+                {
+                    pVarClient->pSharedValues = (SharedValues *)p;
+                }
+                else
+                {
+                    result = ENOMEM;
+                }
+
+                close( fd );
+            }
+            else
+            {
+                result = ENOENT;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetVersion                                                            */
+/*!
+    Get the modification version of a variable
+
+    The VAR_GetVersion function reads the modification version of the
+    specified variable from the shared variable version segment without
+    a round trip to the server.  The version changes every time the
+    variable value changes, so it can be used to check if a cached copy
+    of the value is still current.  The version token combines the
+    storage reference of the variable with its modification counter,
+    so re-pointing an alias also changes its version.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to check
+
+    @param[out]
+        pVersion
+            pointer to a location to store the version token
+
+    @retval EOK - the variable version was retrieved
+    @retval ENOTSUP - the variable value cannot be cached
+    @retval ENOENT - the version segment or variable does not exist
+    @retval ERANGE - the variable handle is not versioned
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_GetVersion( VARSERVER_HANDLE hVarServer,
+                    VAR_HANDLE hVar,
+                    uint64_t *pVersion )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+    VarVersions *pVarVersions;
+    uint32_t storageRef;
+    uint32_t version;
+
+    if( ( pVarClient != NULL ) &&
+        ( hVar != VAR_INVALID ) &&
+        ( pVersion != NULL ) )
+    {
+        /* map the version segment on first use */
+        result = var_MapVersions( pVarClient );
+        if ( result == EOK )
+        {
+            result = ERANGE;
+            if ( hVar < VARSERVER_MAX_VERSIONED_HANDLES )
+            {
+                pVarVersions = pVarClient->pVarVersions;
+                storageRef = __atomic_load_n( &pVarVersions->index[hVar],
+                                              __ATOMIC_ACQUIRE );
+                if ( ( storageRef == 0 ) ||
+                     ( storageRef >= VARSERVER_MAX_VERSIONED_HANDLES ) )
+                {
+                    result = ENOENT;
+                }
+                else
+                {
+                    version = __atomic_load_n(
+                                    &pVarVersions->version[storageRef],
+                                    __ATOMIC_ACQUIRE );
+                    if ( ( version == 0 ) ||
+                         ( version & VARVERSION_UNCACHEABLE ) )
+                    {
+                        result = ENOTSUP;
+                    }
+                    else
+                    {
+                        *pVersion = ( (uint64_t)storageRef << 32 ) | version;
+                        result = EOK;
+                    }
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  var_MapVersions                                                           */
+/*!
+    Map the shared variable version segment
+
+    The var_MapVersions function maps the variable server's shared
+    variable version segment into the client's address space (read only).
+    It does nothing if the segment is already mapped.
+
+    @param[in]
+        pVarClient
+            pointer to the Variable Client
+
+    @retval EOK - the version segment is mapped
+    @retval ENOENT - the version segment does not exist
+    @retval ENOMEM - the version segment could not be mapped
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+static int var_MapVersions( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    int fd;
+    void *p;
+
+    if ( pVarClient != NULL )
+    {
+        result = EOK;
+
+        if ( pVarClient->pVarVersions == NULL )
+        {
+            fd = shm_open( SERVER_VARVERSIONS, O_RDONLY, S_IRUSR | S_IWUSR );
+            if ( fd != -1 )
+            {
+                p = mmap( NULL,
+                          sizeof( VarVersions ),
+                          PROT_READ,
+                          MAP_SHARED,
+                          fd,
+                          0 );
+                if ( p != MAP_FAILED )
+                {
+                    pVarClient->pVarVersions = (VarVersions *)p;
+                }
+                else
+                {
+                    result = ENOMEM;
+                }
+
+                close( fd );
+            }
+            else
+            {
+                result = ENOENT;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetStrByName                                                          */
+/*!
+    Get a string variable value and store it in the specified buffer
+
+    The VAR_GetStrByName function gets the value of the string variable
+    specified by hVar and puts it into the specified buffer
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        name
+            name of the variable to be retrieved
+
+    @param[in,out]
+        buf
+            pointer to the buffer to store the string
+
+    @param[in]
+        len
+            length of the provided buffer to store the result
+
+    @retval EOK - the variable was retrieved ok
+    @retval EINVAL - invalid arguments
+    @retval ENOTSUP - invalid variable type
+    @retval ENOENT - variable not found
+    @retval other error as returned by VAR_Get
+
+==============================================================================*/
+int VAR_GetStrByName( VARSERVER_HANDLE hVarServer,
+                      char *name,
+                      char *buf,
+                      size_t len )
+{
+    int result = EINVAL;
+    VAR_HANDLE hVar;
+    VarObject obj;
+
+    if ( ( hVarServer != NULL ) &&
+         ( name != NULL ) &&
+         ( buf != NULL ) &&
+         ( len > 0 ) )
+    {
+        /* get a handle to the variable */
+        hVar = VAR_FindByName( hVarServer, name );
+        if ( hVar != VAR_INVALID )
+        {
+            /* specify the receive buffer and buffer length */
+            obj.val.str = buf;
+            obj.len = len;
+
+            /* get the (string) value of the variable */
+            result = VAR_Get( hVarServer, hVar, &obj );
+            if ( result == EOK )
+            {
+                if( obj.type != VARTYPE_STR )
+                {
+                    result = ENOTSUP;
+                }
+            }
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetBlobByName                                                         */
+/*!
+    Get a blob variable value and store it in the specified buffer
+
+    The VAR_GetBlobByName function gets the value of the blob variable
+    specified by hVar and puts it into the specified buffer
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        name
+            name of the variable to be retrieved
+
+    @param[in,out]
+        buf
+            pointer to the buffer to store the blob
+
+    @param[in]
+        len
+            length of the provided buffer to store the result
+
+    @retval EOK - the variable was retrieved ok
+    @retval EINVAL - invalid arguments
+    @retval ENOTSUP - invalid variable type
+    @retval ENOENT - variable not found
+    @retval other error as returned by VAR_Get
+
+==============================================================================*/
+int VAR_GetBlobByName( VARSERVER_HANDLE hVarServer,
+                       char *name,
+                       void *buf,
+                       size_t len )
+{
+    int result = EINVAL;
+    VAR_HANDLE hVar;
+    VarObject obj;
+
+    if ( ( hVarServer != NULL ) &&
+         ( name != NULL ) &&
+         ( buf != NULL ) &&
+         ( len > 0 ) )
+    {
+        /* get a handle to the variable */
+        hVar = VAR_FindByName( hVarServer, name );
+        if ( hVar != VAR_INVALID )
+        {
+            /* specify the receive buffer and buffer length */
+            obj.val.str = buf;
+            obj.len = len;
+
+            /* get the (blob) value of the variable */
+            result = VAR_Get( hVarServer, hVar, &obj );
+            if ( result == EOK )
+            {
+                if( obj.type != VARTYPE_BLOB )
+                {
+                    result = ENOTSUP;
+                }
+            }
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetValidationRequest                                                  */
+/*!
+    Get a information about a validation request
+
+    The VAR_GetValidationRequest function gets the the validation
+    request specified by the validation request identifier.
+    The returned VarObject will contain the proposed variable
+    change requested by the other client.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        id
+            identifier of the validation request
+
+    @param[out]
+        hVar
+            handle of the variable to be validated
+
+    @param[out]
+        pVarObject
+            specifies the location where the variable value should be stored
+
+    @retval EOK - the validation request was retrieved ok
+    @retval ENOMEM - cannot allocate memory for the string (string var only)
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_GetValidationRequest( VARSERVER_HANDLE hVarServer,
+                              uint32_t id,
+                              VAR_HANDLE *hVar,
+                              VarObject *pVarObject )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &id );
+
+    if( ( pVarClient != NULL ) &&
+        ( pVarObject != NULL ) &&
+        ( hVar != NULL ) )
+    {
+        pVarClient->requestType = VARREQUEST_GET_VALIDATION_REQUEST;
+        pVarClient->requestVal = id;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( result == EOK )
+        {
+            result = var_GetVarObject( pVarClient, pVarObject );
+            if( result == EOK )
+            {
+                /* get the handle of the variable to be validated */
+                *hVar = var_ShardHandle( pVarClient,
+                                         pVarClient->variableInfo.hVar );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_SendValidationResponse                                                */
+/*!
+    Send a Validation response
+
+    The VAR_SendValidationResponse function sends a validation response
+    for the specified validation reqeust.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        id
+            identifier of the validation request
+
+    @param[in]
+        response
+            EOK - the validation was successful
+            EINVAL - the validation was unsuccessful
+
+    @retval EOK - the validation request was retrieved ok
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_SendValidationResponse( VARSERVER_HANDLE hVarServer,
+                                uint32_t id,
+                                int response  )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &id );
+
+    if( pVarClient != NULL )
+    {
+        pVarClient->requestType = VARREQUEST_SEND_VALIDATION_RESPONSE;
+        pVarClient->requestVal = id;
+        pVarClient->responseVal = response;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_SetValidationPolicy                                                   */
+/*!
+    Set the validation policy of a validator
+
+    The VAR_SetValidationPolicy function specifies how the server
+    delivers validation requests to this client, and what happens to
+    the requests it does not answer in time.
+
+    With batched validation, the server queues the validation requests
+    and only sends a SIG_VAR_VALIDATE signal when the queue becomes
+    non-empty.  The validator then fetches the queued requests with
+    VAR_GetValidationRequests until fewer than the requested number are
+    returned, and answers them with VAR_SendValidationResponses.
+    Variables with a batched validator can also be set in a
+    VAR_SetMany batch.
+
+    When a deadline is set, a validation request which is not answered
+    within deadline_ms milliseconds is completed with the default
+    response: EOK accepts the change, and any other value rejects it
+    with that error.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pPolicy
+            pointer to the validation policy
+
+    @retval EOK - the validation policy was set
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_SetValidationPolicy( VARSERVER_HANDLE hVarServer,
+                             ValidationPolicy *pPolicy )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+
+    if( ( pVarClient != NULL ) &&
+        ( pPolicy != NULL ) )
+    {
+        result = var_GrowWorkbuf( pVarClient, sizeof( ValidationPolicy ) );
+        if( result == EOK )
+        {
+            memcpy( &pVarClient->workbuf, pPolicy, sizeof( ValidationPolicy ) );
+
+            pVarClient->requestType = VARREQUEST_VALIDATION_POLICY;
+
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if( result == EOK )
+            {
+                result = pVarClient->responseVal;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetValidationRequests                                                 */
+/*!
+    Get a batch of validation requests
+
+    The VAR_GetValidationRequests function fetches up to max of the
+    validation requests queued for this client by a batched validation
+    policy.  For each request it returns the validation request
+    identifier, the handle of the variable to be validated and the
+    proposed value.  String and blob values are returned as for
+    VAR_Get.
+
+    A request whose value is too large to be fetched in a batch is
+    returned with an E2BIG result, and can be fetched individually
+    with VAR_GetValidationRequest.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[out]
+        ids
+            array of max locations to store the validation request
+            identifiers
+
+    @param[out]
+        hVars
+            array of max locations to store the handles of the
+            variables to be validated
+
+    @param[in,out]
+        pVarObjects
+            array of max var objects to store the proposed values
+
+    @param[out]
+        results
+            optional array of max locations to store the per-request
+            result codes.  May be NULL.
+
+    @param[in]
+        max
+            maximum number of validation requests to fetch
+
+    @param[out]
+        n
+            pointer to a location to store the number of validation
+            requests fetched
+
+    @retval EOK - the validation requests were fetched
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_GetValidationRequests( VARSERVER_HANDLE hVarServer,
+                               uint32_t *ids,
+                               VAR_HANDLE *hVars,
+                               VarObject *pVarObjects,
+                               int *results,
+                               size_t max,
+                               size_t *n )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    VarValidationItem *pItems;
+    size_t count;
+    size_t i;
+    int rc;
+
+    if( ( pVarClient != NULL ) &&
+        ( ids != NULL ) &&
+        ( hVars != NULL ) &&
+        ( pVarObjects != NULL ) &&
+        ( n != NULL ) )
+    {
+        *n = 0;
+
+        if( max > VARSERVER_MAX_BATCH_ITEMS )
+        {
+            max = VARSERVER_MAX_BATCH_ITEMS;
+        }
+
+        pVarClient->requestType = VARREQUEST_GET_VALIDATION_BATCH;
+        pVarClient->requestVal = max;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( ( result == EOK ) &&
+            ( ( pVarClient->responseVal < 0 ) ||
+              ( (size_t)pVarClient->responseVal > max ) ) )
+        {
+            result = EIO;
+        }
+
+        if( result == EOK )
+        {
+            count = (size_t)pVarClient->responseVal;
+            pItems = (VarValidationItem *)&pVarClient->workbuf;
+
+            /* unpack the requests before the working buffer is reused */
+            for( i = 0; i < count; i++ )
+            {
+                ids[i] = pItems[i].id;
+                hVars[i] = var_ShardHandle( pVarClient, pItems[i].item.hVar );
+
+                rc = pItems[i].item.result;
+                if( rc == EOK )
+                {
+                    rc = var_GetBatchObject( pVarClient,
+                                             &pItems[i].item,
+                                             &pVarObjects[i] );
+                }
+
+                if( results != NULL )
+                {
+                    results[i] = rc;
+                }
+            }
+
+            *n = count;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_SendValidationResponses                                               */
+/*!
+    Send a batch of validation responses
+
+    The VAR_SendValidationResponses function answers n validation
+    requests in a single round trip.  A response of EOK accepts the
+    proposed change, and any other value rejects it and is returned
+    to the writer.  Requests whose deadline has already expired are
+    reported with an ENOENT result.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        ids
+            array of n validation request identifiers
+
+    @param[in]
+        responses
+            array of n responses
+
+    @param[out]
+        results
+            optional array of n locations to store the per-request
+            result codes.  May be NULL.
+
+    @param[in]
+        n
+            number of responses to send
+
+    @retval EOK - all of the responses were applied
+    @retval EINVAL - invalid arguments
+    @retval other - the result of the first response which failed
+
+==============================================================================*/
+int VAR_SendValidationResponses( VARSERVER_HANDLE hVarServer,
+                                 uint32_t *ids,
+                                 int *responses,
+                                 int *results,
+                                 size_t n )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    VarValidationItem *pItems;
+    int first = EOK;
+    size_t count;
+    size_t i = 0;
+    size_t j;
+
+    if( ( pVarClient != NULL ) &&
+        ( ids != NULL ) &&
+        ( responses != NULL ) )
+    {
+        result = EOK;
+
+        while( ( result == EOK ) && ( i < n ) )
+        {
+            count = n - i;
+            if( count > VARSERVER_MAX_BATCH_ITEMS )
+            {
+                count = VARSERVER_MAX_BATCH_ITEMS;
+            }
+
+            result = var_GrowWorkbuf( pVarClient,
+                                      count * sizeof( VarValidationItem ) );
+            if( result == EOK )
+            {
+                pItems = (VarValidationItem *)&pVarClient->workbuf;
+                for( j = 0; j < count; j++ )
+                {
+                    pItems[j].id = ids[i+j];
+                    pItems[j].item.result = responses[i+j];
+                }
+
+                pVarClient->requestType = VARREQUEST_SEND_VALIDATION_BATCH;
+                pVarClient->requestVal = count;
+
+                result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+                if( ( result == EOK ) &&
+                    ( pVarClient->responseVal != (int)count ) )
+                {
+                    result = EIO;
+                }
+            }
+
+            for( j = 0; ( result == EOK ) && ( j < count ); j++ )
+            {
+                if( results != NULL )
+                {
+                    results[i+j] = pItems[j].item.result;
+                }
+
+                if( ( pItems[j].item.result != EOK ) && ( first == EOK ) )
+                {
+                    first = pItems[j].item.result;
+                }
+            }
+
+            i += count;
+        }
+
+        if( result == EOK )
+        {
+            result = first;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  var_GetVarObject                                                          */
+/*!
+    Get a variable object from the variable client
+
+    The var_GetVarObject function retrieves a copy of the client's
+    VarObject which is returned from the server.  If the object
+    type is a string, and the destination VarObject has an existing
+    string buffer, the string is copied into the VarObject's string buffer.
+    If the VarObject does not have a string buffer, one is automatically
+    allocated and is the responsibility of the caller to deallocate
+    the string buffer.
+
+    If the object type is a blob, and the destination VarObject has an
+    existing blob buffer, then the blob is copied into the VarObject's blob
+    buffer.  If the VarObject does not have a blob buffer, one is automatically
+    allocated and is the responsibility of the caller to deallocate
+    the blob buffer.
+
+    @param[in]
+        pVarClient
+            pointer to the Variable Client which contains the source VarObject
+
+    @param[in]
+        VarObject
+            pointer to the destination VarObject
+
+    @retval EOK - the validation request was retrieved ok
+    @retval ENOMEM - cannot allocate memory for the object (string/blob only)
+    @retval E23BIG - not enough space to store the string/blob variable
+    @retval ENOTSUP - incorrect type match
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+static int var_GetVarObject( VarClient *pVarClient, VarObject *pVarObject )
+{
+    int result = EINVAL;
+    size_t srclen;
+
+    if( ( pVarClient != NULL ) &&
+        ( pVarObject != NULL ) )
+    {
+        /* set the destination object type */
+        pVarObject->type = pVarClient->variableInfo.var.type;
+        if( pVarObject->type == VARTYPE_STR )
+        {
+            /* get the string from the work buffer */
+            result = var_GetStringObjectFromWorkbuf( pVarClient, pVarObject );
+        }
+        else if ( pVarObject->type == VARTYPE_BLOB )
+        {
+            /* get the blob from the work buffer */
+            result = var_GetBlobObjectFromWorkbuf( pVarClient, pVarObject );
+        }
+        else
+        {
+            /* copy primitive type */
+            pVarObject->val = pVarClient->variableInfo.var.val;
+
+            /* get the source object length */
+            srclen = pVarClient->variableInfo.var.len;
+
+            pVarObject->len = srclen;
+
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  var_GetStringObjectFromWorkbuf                                            */
+/*!
+    Get a string object from the variable client work buffer
+
+    The var_GetStringObjectFromWorkbuf function retrieves a copy of the client's
+    VarObject which is returned from the server.  If the object
+    type is a string, and the destination VarObject has an existing
+    string buffer, the string is copied into the VarObject's string buffer.
+    If the VarObject does not have a string buffer, one is automatically
+    allocated and is the responsibility of the caller to deallocate
+    the string buffer.
+
+    @param[in]
+        pVarClient
+            pointer to the Variable Client which contains the source VarObject
+
+    @param[in]
+        VarObject
+            pointer to the destination VarObject
+
+    @retval EOK - the validation request was retrieved ok
+    @retval ENOMEM - cannot allocate memory for the object (string/blob only)
+    @retval E23BIG - not enough space to store the string/blob variable
+    @retval ENOTSUP - incorrect type match
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+static int var_GetStringObjectFromWorkbuf( VarClient *pVarClient,
+                                           VarObject *pVarObject )
+{
+    int result = EINVAL;
+    size_t srclen;
+    char *pSrcString;
+
+    if ( ( pVarClient != NULL ) &&
+         ( pVarObject != NULL ) )
+    {
+        /* set the destination object type */
+        pVarObject->type = pVarClient->variableInfo.var.type;
+        if ( pVarObject->type == VARTYPE_STR )
+        {
+            /* get the source string */
+            pVarClient->variableInfo.var.val.str = &pVarClient->workbuf;
+            pSrcString = pVarClient->variableInfo.var.val.str;
+
+            if( pSrcString != NULL )
+            {
+                /* get the source object length */
+                srclen = pVarClient->variableInfo.var.len;
+
+                if( pVarObject->val.str == NULL )
+                {
+                    /* allocate memory for the target string */
+                    pVarObject->val.str = calloc( 1, srclen );
+                    pVarObject->len = srclen;
+                }
+                else
+                {
+                    /* calculate the length of the source string */
+                    srclen = strlen( pSrcString ) + 1;
+                }
+
+                if( pVarObject->val.str != NULL )
+                {
+                    if( pVarObject->len >= srclen )
+                    {
+                        /* get string from the working buffer */
+                        strcpy( pVarObject->val.str,
+                                &pVarClient->workbuf );
+                        result = EOK;
+                    }
+                    else
+                    {
+                        /* not enough space to store the string */
+                        result = E2BIG;
+                    }
+                }
+                else
+                {
+                    /* no memory available for the string result */
+                    result = ENOMEM;
+                }
+            }
+            else
+            {
+                /* should not see this.  The source object says it is a string
+                    but it does not have a string pointer */
+                result = ENOTSUP;
+            }
+        }
+        else
+        {
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  var_GetBlobObjectFromWorkbuf                                              */
+/*!
+    Get a blob object from the variable client work buffer
+
+    The var_GetBlobObjectFromWorkbuf function retrieves a copy of the client's
+    VarObject which is returned from the server.  If the object
+    type is a blob, and the destination VarObject has an existing
+    blob buffer, the blob is copied into the VarObject's blob buffer.
+    If the VarObject does not have a blob buffer, one is automatically
+    allocated and is the responsibility of the caller to deallocate
+    the blob buffer.
+
+    @param[in]
+        pVarClient
+            pointer to the Variable Client which contains the source VarObject
+
+    @param[in]
+        VarObject
+            pointer to the destination VarObject
+
+    @retval EOK - the validation request was retrieved ok
+    @retval ENOMEM - cannot allocate memory for the object (string/blob only)
+    @retval E23BIG - not enough space to store the string/blob variable
+    @retval ENOTSUP - incorrect type match
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+static int var_GetBlobObjectFromWorkbuf( VarClient *pVarClient,
+                                         VarObject *pVarObject )
+{
+    int result = EINVAL;
+    size_t srclen;
+    void *pSrcBlob;
+
+    if ( ( pVarClient != NULL ) &&
+         ( pVarObject != NULL ) )
+    {
+        /* set the destination object type */
+        pVarObject->type = pVarClient->variableInfo.var.type;
+        if ( pVarObject->type == VARTYPE_BLOB )
+        {
+            /* get the source blob */
+            pVarClient->variableInfo.var.val.blob = &pVarClient->workbuf;
+            pSrcBlob = pVarClient->variableInfo.var.val.blob;
+
+            if( pSrcBlob != NULL )
+            {
+                /* get the source object length */
+                srclen = pVarClient->variableInfo.var.len;
+
+                if( pVarObject->val.blob == NULL )
+                {
+                    /* allocate memory for the target blob */
+                    pVarObject->val.blob = calloc( 1, srclen );
+                    pVarObject->len = srclen;
+                }
+
+                if( pVarObject->val.blob != NULL )
+                {
+                    if( pVarObject->len >= srclen )
+                    {
+                        /* get blob from the working buffer */
+                        memcpy( pVarObject->val.blob,
+                                &pVarClient->workbuf,
+                                srclen );
+                        result = EOK;
+                    }
+                    else
+                    {
+                        /* not enough space to store the blob */
+                        result = E2BIG;
+                    }
+                }
+                else
+                {
+                    /* no memory available for the blob result */
+                    result = ENOMEM;
+                }
+            }
+            else
+            {
+                /* should not see this.  The source object says it is a blob
+                    but it does not have a blob pointer */
+                result = ENOTSUP;
+            }
+        }
+        else
+        {
+            /* not a blob type */
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetLength                                                             */
+/*!
+    Get the length of the specified variable
+
+    The VAR_GetLength function queries the variable server for the
+    length of the specified variable.  Typically this is only useful
+    for strings and blobs because the lengths of the other data types could
+    easily be calculated directly.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to be retrieved
+
+    @param[in]
+        len
+            specifies the location where the length should be stored
+
+    @retval EOK - the length was retrieved ok
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_GetLength( VARSERVER_HANDLE hVarServer,
+                   VAR_HANDLE hVar,
+                   size_t *len )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( ( pVarClient != NULL ) &&
+        ( len != NULL ) )
+    {
+        pVarClient->requestType = VARREQUEST_LENGTH;
+        pVarClient->variableInfo.hVar = hVar;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( result == EOK )
+        {
+            *len = pVarClient->variableInfo.var.len;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetFlags                                                              */
+/*!
+    Get the flags of the specified variable
+
+    The VAR_GetFlags function queries the variable server for the
+    flags of the specified variable.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to be retrieved
+
+    @param[in]
+        flags
+            specifies the location where the flags should be stored
+
+    @retval EOK - the flags were retrieved ok
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_GetFlags( VARSERVER_HANDLE hVarServer,
+                  VAR_HANDLE hVar,
+                  uint32_t *flags )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( ( pVarClient != NULL ) &&
+        ( flags != NULL ) )
+    {
+        pVarClient->requestType = VARREQUEST_FLAGS;
+        pVarClient->variableInfo.hVar = hVar;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( result == EOK )
+        {
+            *flags = pVarClient->variableInfo.flags;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetInfo                                                               */
+/*!
+    Get the info of the specified variable
+
+    The VAR_GetInfo function queries the variable server for the
+    information of the specified variable.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to be retrieved
+
+    @param[in]
+        pVarInfo
+            pointer to a VarInfo object to store the variable info
+
+    @retval EOK - the flags were retrieved ok
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_GetInfo( VARSERVER_HANDLE hVarServer,
+                 VAR_HANDLE hVar,
+                 VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( ( pVarClient != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        pVarClient->requestType = VARREQUEST_INFO;
+        pVarClient->variableInfo.hVar = hVar;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( result == EOK )
+        {
+            memcpy( pVarInfo, &pVarClient->variableInfo, sizeof( VarInfo ));
+            pVarInfo->hVar = var_ShardHandle( pVarClient, pVarInfo->hVar );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetType                                                               */
+/*!
+    Get the variable data type
+
+    The VAR_GetType function gets the type of the variable
+    specified by hVar and puts it into the specified VarType object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to be retrieved
+
+    @param[out]
+        pVarType
+            pointer to the VarType object to populate
+
+    @retval EOK - the variable type was retrieved ok
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_GetType( VARSERVER_HANDLE hVarServer,
+                 VAR_HANDLE hVar,
+                 VarType *pVarType )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( ( pVarClient != NULL ) &&
+        ( pVarType != NULL ) )
+    {
+        pVarClient->requestType = VARREQUEST_TYPE;
+        pVarClient->variableInfo.hVar = hVar;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( result == EOK )
+        {
+            *pVarType = pVarClient->variableInfo.var.type;
+        }
+        else
+        {
+            *pVarType = VARTYPE_INVALID;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetName                                                               */
+/*!
+    Get the variable name given its handle
+
+    The VAR_GetName function gets the name of the variable
+    specified by hVar and puts it into the specified buffer
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to be retrieved
+
+    @param[in,out]
+        buf
+            pointer to the buffer to store the variable name
+
+    @param[in]
+        buflen
+            the length of the buffer to store the variable name
+
+    @retval EOK - the variable name was retrieved ok
+    @retval E2BIG - the variable name is too big for the specified buffer
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_GetName( VARSERVER_HANDLE hVarServer,
+                 VAR_HANDLE hVar,
+                 char *buf,
+                 size_t buflen )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( ( pVarClient != NULL ) &&
+        ( buf != NULL ) &&
+        ( buflen > 0 ) &&
+        ( hVar != VAR_INVALID ) )
+    {
+        pVarClient->requestType = VARREQUEST_NAME;
+        pVarClient->variableInfo.hVar = hVar;
+
+        /* make a request to the server to get the variable name */
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( result == EOK )
+        {
+            /* check if the specified buffer is large enough for the name */
+            if ( buflen >= strlen( pVarClient->variableInfo.name ) )
+            {
+                /* copy the variable name into the supplied buffer */
+                strcpy( buf, pVarClient->variableInfo.name );
+
+                /* indicate success */
+                result = EOK;
+            }
+            else
+            {
+                /* the buffer is not big enough for the variable name */
+                result = E2BIG;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_SetNameValue                                                          */
+/*!
+    Set a variable value
+
+    The VAR_SetNameValue function sets the value of the specified variable.
+    The value of the variable is specified as a string and is converted
+    to the appropriate type by this function.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        name
+            pointer to the name of the variable
+
+    @param[in]
+        value
+            pointer to the value of the variable
+
+    @retval EOK - the variable was set ok
+    @retval E2BIG - the variable string is too big
+    @retval ERANGE - the variable is out of range for the specified type
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_SetNameValue( VARSERVER_HANDLE hVarServer,
+                      char *name,
+                      char *value )
+{
+    int result = EINVAL;
+    VAR_HANDLE hVar;
+    VarType type;
+
+    if( ( hVarServer != NULL ) &&
+        ( name != NULL ) &&
+        ( value != NULL ) )
+    {
+        /* get a handle to the variable given its name */
+        hVar = VAR_FindByName( hVarServer, name );
+        if( hVar != VAR_INVALID )
+        {
+            /* get the variable type so we can convert the
+               string to a VarObject */
+            result = VAR_GetType( hVarServer, hVar, &type );
+            if( result == EOK )
+            {
+                /* set the variable value from the string */
+                result = VAR_SetStr( hVarServer, hVar, type, value );
+            }
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_SetStr                                                                */
+/*!
+    Set a variable value
+
+    The VAR_Set function sets the value of the variable
+    specified by hVar to the value contained in the string
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to be set
+
+    @param[in]
+        pVarObject
+            pointer to the variable value object to set
+
+    @retval EOK - the variable was set ok
+    @retval E2BIG - the variable string is too big
+    @retval ERANGE - the variable is out of range for the specified type
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_SetStr( VARSERVER_HANDLE hVarServer,
+                VAR_HANDLE hVar,
+                VarType type,
+                char *str )
+{
+    int result = EINVAL;
+    VarObject varObject = {0};
+
+    if( str != NULL )
+    {
+        /* populate the VarObject */
+        result = VAROBJECT_CreateFromString( str,
+                                             type,
+                                             &varObject,
+                                             VAROBJECT_OPTION_NONE );
+        if( result == EOK )
+        {
+            /* set the sysvar using the VarObject */
+            result = VAR_Set( hVarServer, hVar, &varObject );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_Set                                                                   */
+/*!
+    Set a variable value in the specified var object
+
+    The VAR_Set function sets the value of the variable
+    specified by hVar to the value specified by the var object
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to be set
+
+    @param[in]
+        pVarObject
+            pointer to the variable value object to set
+
+    @retval EOK - the variable was set ok
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_Set( VARSERVER_HANDLE hVarServer,
+             VAR_HANDLE hVar,
+             VarObject *pVarObject )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( ( pVarClient != NULL ) &&
+        ( pVarObject != NULL ) )
+    {
+        pVarClient->requestType = VARREQUEST_SET;
+        pVarClient->variableInfo.hVar = hVar;
+        pVarClient->variableInfo.var.type = pVarObject->type;
+        pVarClient->variableInfo.var.val = pVarObject->val;
+        pVarClient->variableInfo.var.len = pVarObject->len;
+
+        /* strings have to be transferred via the working buffer */
+        if( pVarObject->type == VARTYPE_STR )
+        {
+            result = var_CopyStringVarObjectToWorkbuf( pVarClient,
+                                                       pVarObject );
+        }
+
+        if ( pVarObject->type == VARTYPE_BLOB )
+        {
+            result = var_CopyBlobVarObjectToWorkbuf( pVarClient, pVarObject );
+        }
+
+        if ( result != E2BIG )
+        {
+            /* send the request to the server */
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if( result == EOK )
+            {
+                result = pVarClient->responseVal;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_Modify                                                                */
+/*!
+    Atomically modify the value of a variable
+
+    The VAR_Modify function asks the server to read, modify and store
+    the value of the specified variable in a single request, so no other
+    change can come between the read and the write.  The change raises
+    the normal notifications.
+
+    VAR_MODIFY_ADD, VAR_MODIFY_SUB, VAR_MODIFY_INC and VAR_MODIFY_DEC
+    are supported on the integer and float variables, and fail with
+    ERANGE if the result does not fit in the variable.  VAR_MODIFY_OR,
+    VAR_MODIFY_AND and VAR_MODIFY_CLEAR are supported on the integer
+    variables.  Use VAR_CompareAndSwap to perform a VAR_MODIFY_CAS.
+
+    Variables with a CALC or VALIDATE handler cannot be modified.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to modify
+
+    @param[in]
+        op
+            the operation to perform
+
+    @param[in]
+        pOperand
+            pointer to the integer or float operand, or NULL for
+            VAR_MODIFY_INC and VAR_MODIFY_DEC
+
+    @param[out]
+        pOld
+            optional pointer to a VarObject to receive the value of the
+            variable before it was modified.  May be NULL.
+
+    @retval EOK - the variable was modified
+    @retval ERANGE - the result does not fit in the variable
+    @retval ENOTSUP - the operation is not supported on the variable
+    @retval EACCES - the variable cannot be modified by this client
+    @retval ENOENT - the variable does not exist
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_Modify( VARSERVER_HANDLE hVarServer,
+                VAR_HANDLE hVar,
+                VarModifyOp op,
+                VarObject *pOperand,
+                VarObject *pOld )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+    VarObject none;
+
+    if( ( pVarClient != NULL ) &&
+        ( op != VAR_MODIFY_CAS ) &&
+        ( ( pOperand != NULL ) ||
+          ( op == VAR_MODIFY_INC ) ||
+          ( op == VAR_MODIFY_DEC ) ) )
+    {
+        memset( &none, 0, sizeof( VarObject ) );
+        result = var_Modify( pVarClient,
+                             hVar,
+                             op,
+                             ( pOperand != NULL ) ? pOperand : &none,
+                             &none,
+                             pOld );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_CompareAndSwap                                                        */
+/*!
+    Atomically replace the value of a variable if it is unchanged
+
+    The VAR_CompareAndSwap function asks the server to store a new value
+    in the specified variable only if it currently holds the expected
+    value.  Numbers are compared after converting the expected value to
+    the type of the variable, and strings are compared exactly.  The
+    previous value of the variable is returned in either case, so a
+    failed exchange can be retried with it.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable to exchange
+
+    @param[in]
+        pExpected
+            pointer to the value the variable is expected to hold
+
+    @param[in]
+        pNew
+            pointer to the value to store in the variable
+
+    @param[out]
+        pOld
+            optional pointer to a VarObject to receive the value of the
+            variable before the exchange.  String values are returned
+            as for VAR_Get.  May be NULL.
+
+    @retval EOK - the variable held the expected value and was replaced
+    @retval EAGAIN - the variable did not hold the expected value
+    @retval ENOTSUP - the values cannot be compared, or the variable
+                      has a CALC or VALIDATE handler
+    @retval EACCES - the variable cannot be modified by this client
+    @retval ENOENT - the variable does not exist
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_CompareAndSwap( VARSERVER_HANDLE hVarServer,
+                        VAR_HANDLE hVar,
+                        VarObject *pExpected,
+                        VarObject *pNew,
+                        VarObject *pOld )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( ( pVarClient != NULL ) &&
+        ( pExpected != NULL ) &&
+        ( pNew != NULL ) )
+    {
+        result = var_Modify( pVarClient,
+                             hVar,
+                             VAR_MODIFY_CAS,
+                             pNew,
+                             pExpected,
+                             pOld );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_GetHistory                                                            */
+/*!
+    Get samples from the history ring of a variable
+
+    The VAR_GetHistory function fetches recent values of a variable
+    which has the VARFLAG_HISTORY flag set, with a single request.
+    The samples in the query time window are selected, limited to the
+    newest pQuery->last samples, and up to maxSamples of the newest
+    selected samples are returned oldest first.  If the
+    VAR_HISTORY_STATS option is specified the server also calculates
+    the minimum, maximum and mean of the selected samples, so
+    specifying a maxSamples of 0 returns only the statistics.
+
+    Only numeric variables keep a history.  Up to
+    VARSERVER_HISTORY_DEPTH samples are kept for each variable.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVar
+            handle to the variable
+
+    @param[in]
+        pQuery
+            pointer to the history query
+
+    @param[out]
+        pHistory
+            pointer to a VarHistory object to receive the number of
+            samples returned, and their statistics
+
+    @param[out]
+        pSamples
+            pointer to an array of maxSamples samples to receive the
+            selected samples
+
+    @param[in]
+        maxSamples
+            maximum number of samples to return
+
+    @retval EOK - the history was retrieved
+    @retval ENOTSUP - the variable does not keep a history
+    @retval EACCES - the history of the variable cannot be read
+    @retval ENOENT - the variable does not exist
+    @retval ENOMEM - the working buffer could not be grown
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_GetHistory( VARSERVER_HANDLE hVarServer,
+                    VAR_HANDLE hVar,
+                    VarHistoryQuery *pQuery,
+                    VarHistory *pHistory,
+                    VarHistorySample *pSamples,
+                    size_t maxSamples )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+    VarHistory *pOut;
+    size_t n;
+
+    if( ( pVarClient != NULL ) &&
+        ( pQuery != NULL ) &&
+        ( pHistory != NULL ) &&
+        ( ( pSamples != NULL ) || ( maxSamples == 0 ) ) )
+    {
+        n = ( maxSamples < VARSERVER_HISTORY_DEPTH )
+                ? maxSamples
+                : VARSERVER_HISTORY_DEPTH;
+
+        result = var_GrowWorkbuf( pVarClient,
+                                  sizeof( VarHistory ) +
+                                  n * sizeof( VarHistorySample ) );
+        if( result == EOK )
+        {
+            memcpy( &pVarClient->workbuf, pQuery, sizeof( VarHistoryQuery ) );
+
+            pVarClient->requestType = VARREQUEST_GET_HISTORY;
+            pVarClient->requestVal = (int)n;
+            pVarClient->variableInfo.hVar = hVar;
+
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if( result == EOK )
+            {
+                result = pVarClient->responseVal;
+            }
+        }
+
+        if( result == EOK )
+        {
+            pOut = (VarHistory *)&pVarClient->workbuf;
+            *pHistory = *pOut;
+            if( pHistory->count > n )
+            {
+                pHistory->count = n;
+            }
+
+            if( pHistory->count > 0 )
+            {
+                memcpy( pSamples,
+                        &pOut[1],
+                        pHistory->count * sizeof( VarHistorySample ) );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARSERVER_GetLargestVars                                                  */
+/*!
+    Get the variables which use the most server memory
+
+    The VARSERVER_GetLargestVars function gets up to n of the variables
+    which use the most memory in the server, largest first, for capacity
+    planning.  The memory used by a variable includes its value, its
+    notification registrations and its history.  Only the variables
+    which the client can read are reported.  When the name space is
+    sharded, the variables of the root server are reported.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[out]
+        pUsage
+            pointer to an array of n entries to receive the variables
+
+    @param[in]
+        n
+            maximum number of variables to report
+
+    @param[out]
+        pCount
+            pointer to a location to store the number of variables
+            reported
+
+    @retval EOK - the variables were reported
+    @retval ENOMEM - the working buffer could not be grown
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VARSERVER_GetLargestVars( VARSERVER_HANDLE hVarServer,
+                              VarMemUsage *pUsage,
+                              size_t n,
+                              size_t *pCount )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+
+    if( ( pVarClient != NULL ) &&
+        ( pUsage != NULL ) &&
+        ( n > 0 ) &&
+        ( n <= INT32_MAX ) &&
+        ( pCount != NULL ) )
+    {
+        *pCount = 0;
+
+        result = var_GrowWorkbuf( pVarClient, n * sizeof( VarMemUsage ) );
+        if( result == EOK )
+        {
+            pVarClient->requestType = VARREQUEST_GET_LARGEST;
+            pVarClient->requestVal = (int)n;
+
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        }
+
+        if( result == EOK )
+        {
+            if( pVarClient->responseVal < 0 )
+            {
+                result = -pVarClient->responseVal;
+            }
+            else if( (size_t)pVarClient->responseVal <= n )
+            {
+                *pCount = (size_t)pVarClient->responseVal;
+                memcpy( pUsage,
+                        &pVarClient->workbuf,
+                        *pCount * sizeof( VarMemUsage ) );
+            }
+            else
+            {
+                result = EINVAL;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_SetMany                                                               */
+/*!
+    Set the values of multiple variables
+
+    The VAR_SetMany function sets the values of the n variables specified
+    by hVars to the values in the corresponding var objects.  The
+    variables are sent to the server in batches of up to
+    VARSERVER_MAX_BATCH_ITEMS per request.  A batch only contains
+    consecutive variables owned by the same shard server.  Change
+    notifications for the variables in a batch are sent once the whole
+    batch has been applied.
+
+    Variables which cannot be set in a batch (for example those with a
+    VALIDATE handler, or strings too large for the working buffer)
+    are set individually using VAR_Set after the batch.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVars
+            array of n handles of the variables to be set
+
+    @param[in]
+        pVarObjects
+            array of n var objects containing the values to set
+
+    @param[out]
+        results
+            optional array of n locations to store the per-variable
+            result codes.  May be NULL.
+
+    @param[in]
+        n
+            number of variables to set
+
+    @retval EOK - all of the variables were set ok
+    @retval EINVAL - invalid arguments
+    @retval other - the result of the first variable which failed
+
+==============================================================================*/
+int VAR_SetMany( VARSERVER_HANDLE hVarServer,
+                 VAR_HANDLE *hVars,
+                 VarObject *pVarObjects,
+                 int *results,
+                 size_t n )
+{
+    int result = EINVAL;
+    VarClient *pRoot = ValidateHandle( hVarServer );
+    VarClient *pVarClient;
+    VarBatchItem *pItems;
+    int rc[VARSERVER_MAX_BATCH_ITEMS];
+    int first = EOK;
+    size_t count;
+    size_t run;
+    size_t i = 0;
+    size_t j;
+
+    if( ( pRoot != NULL ) &&
+        ( hVars != NULL ) &&
+        ( pVarObjects != NULL ) )
+    {
+        result = EOK;
+
+        while( ( result == EOK ) && ( i < n ) )
+        {
+            /* find the consecutive variables owned by the same shard */
+            run = 1;
+            while( ( i + run < n ) &&
+                   ( run < VARSERVER_MAX_BATCH_ITEMS ) &&
+                   ( ( hVars[i+run] >> VARSERVER_SHARD_SHIFT ) ==
+                     ( hVars[i] >> VARSERVER_SHARD_SHIFT ) ) )
+            {
+                run++;
+            }
+
+            /* pack as many variables as will fit into the working buffer */
+            pVarClient = var_Shard( pRoot,
+                                    hVars[i] >> VARSERVER_SHARD_SHIFT );
+            count = ( pVarClient != NULL )
+                        ? var_PackSetBatch( pVarClient,
+                                            &hVars[i],
+                                            &pVarObjects[i],
+                                            run )
+                        : 0;
+            if( count == 0 )
+            {
+                /* the next variable does not fit in a batch by itself,
+                   so it will be set individually */
+                rc[0] = E2BIG;
+                count = 1;
+            }
+            else
+            {
+                pVarClient->requestType = VARREQUEST_SET_MANY;
+                pVarClient->requestVal = count;
+
+                result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+                if( ( result == EOK ) &&
+                    ( pVarClient->responseVal != (int)count ) )
+                {
+                    result = EIO;
                 }
 
-                break;
+                /* get the results before the working buffer is reused */
+                pItems = (VarBatchItem *)&pVarClient->workbuf;
+                for( j = 0; j < count; j++ )
+                {
+                    rc[j] = pItems[j].result;
+                }
+            }
 
-            case VARTYPE_BLOB:
-                if( var->val.blob != NULL)
+            if( result == EOK )
+            {
+                for( j = 0; j < count; j++ )
                 {
-                    len = strlen( valueString );
-                    if( len <= var->len )
+                    if( ( rc[j] == EWOULDBLOCK ) || ( rc[j] == E2BIG ) )
                     {
-                        memcpy( var->val.blob, valueString, len );
+                        /* set the variable individually */
+                        rc[j] = VAR_Set( hVarServer,
+                                         hVars[i+j],
+                                         &pVarObjects[i+j] );
                     }
-                    else
+
+                    if( results != NULL )
                     {
-                        result = E2BIG;
+                        results[i+j] = rc[j];
+                    }
+
+                    if( ( rc[j] != EOK ) && ( first == EOK ) )
+                    {
+                        first = rc[j];
                     }
                 }
-                else
+
+                i += count;
+            }
+        }
+
+        if( result == EOK )
+        {
+            result = first;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_SetGroup                                                              */
+/*!
+    Atomically set the values of a group of variables
+
+    The VAR_SetGroup function sets the values of the n variables specified
+    by hVars to the values in the corresponding var objects as a single
+    atomic group.  All of the values are checked, and validated by the
+    VALIDATE handlers of the variables, before any of them are applied.
+    If any value is rejected, none of the variables are changed.
+    Otherwise all of the values are applied together, and each
+    subscriber receives a single change notification for the group.
+
+    All of the variables must be owned by the same shard server, and
+    the whole group is sent in a single request, growing the working
+    buffer if necessary.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        hVars
+            array of n handles of the variables to be set
+
+    @param[in]
+        pVarObjects
+            array of n var objects containing the values to set
+
+    @param[out]
+        results
+            optional array of n locations to store the per-variable
+            result codes.  Variables which were not rejected, but were
+            not changed because another variable was rejected, have an
+            ECANCELED result.  May be NULL.
+
+    @param[in]
+        n
+            number of variables to set
+
+    @retval EOK - all of the variables were set ok
+    @retval E2BIG - the group has more than VARSERVER_MAX_BATCH_ITEMS
+            variables, or does not fit in the working buffer
+    @retval EXDEV - the variables are owned by different shard servers
+    @retval EINVAL - invalid arguments
+    @retval other - the result of the first variable which was rejected
+
+==============================================================================*/
+int VAR_SetGroup( VARSERVER_HANDLE hVarServer,
+                  VAR_HANDLE *hVars,
+                  VarObject *pVarObjects,
+                  int *results,
+                  size_t n )
+{
+    int result = EINVAL;
+    VarClient *pRoot = ValidateHandle( hVarServer );
+    VarClient *pVarClient = NULL;
+    VarBatchItem *pItems;
+    int first = EOK;
+    size_t len;
+    size_t i;
+
+    if( ( pRoot != NULL ) &&
+        ( hVars != NULL ) &&
+        ( pVarObjects != NULL ) &&
+        ( n > 0 ) )
+    {
+        result = ( n <= VARSERVER_MAX_BATCH_ITEMS ) ? EOK : E2BIG;
+
+        /* get the size of the group request */
+        len = n * sizeof( VarBatchItem );
+        for( i = 0; ( i < n ) && ( result == EOK ); i++ )
+        {
+            if( ( hVars[i] >> VARSERVER_SHARD_SHIFT ) !=
+                ( hVars[0] >> VARSERVER_SHARD_SHIFT ) )
+            {
+                result = EXDEV;
+            }
+            else if( pVarObjects[i].type == VARTYPE_STR )
+            {
+                len += pVarObjects[i].len + 1;
+            }
+            else if( pVarObjects[i].type == VARTYPE_BLOB )
+            {
+                len += pVarObjects[i].len;
+            }
+        }
+
+        if( result == EOK )
+        {
+            pVarClient = var_Shard( pRoot,
+                                    hVars[0] >> VARSERVER_SHARD_SHIFT );
+            result = ( pVarClient == NULL ) ? EINVAL
+                   : ( len > UINT32_MAX ) ? E2BIG
+                   : var_GrowWorkbuf( pVarClient, len );
+        }
+
+        if( ( result == EOK ) &&
+            ( var_PackSetBatch( pVarClient, hVars, pVarObjects, n ) != n ) )
+        {
+            result = E2BIG;
+        }
+
+        if( result == EOK )
+        {
+            pVarClient->requestType = VARREQUEST_SET_GROUP;
+            pVarClient->requestVal = n;
+
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if( ( result == EOK ) &&
+                ( pVarClient->responseVal != (int)n ) )
+            {
+                result = EIO;
+            }
+        }
+
+        if( result == EOK )
+        {
+            pItems = (VarBatchItem *)&pVarClient->workbuf;
+            for( i = 0; i < n; i++ )
+            {
+                if( results != NULL )
                 {
-                    result = ENOMEM;
+                    results[i] = pItems[i].result;
                 }
 
-                break;
+                /* report the cause of the failure in preference to
+                   the cancelled items */
+                if( ( pItems[i].result != EOK ) &&
+                    ( ( first == EOK ) || ( first == ECANCELED ) ) )
+                {
+                    first = pItems[i].result;
+                }
+            }
 
-            default:
-                result = ENOTSUP;
-                break;
+            result = first;
         }
     }
 
@@ -1426,163 +5855,372 @@ int VARSERVER_ParseValueString( VarObject *var, char *valueString )
 }
 
 /*============================================================================*/
-/*  VAR_FindByName                                                            */
+/*  VAR_AsyncOpen                                                             */
 /*!
-    Find a variable given its name
+    Open an asynchronous request context
 
-    The VAR_FindByName function requests the handle for the specified
-    variable from the variable server.
+    The VAR_AsyncOpen function opens a context which can have up to
+    depth requests in flight at the same time.  Each request is sent
+    over its own connection to the variable server, so the requests do
+    not wait for each other.  Requests are submitted with VAR_AsyncGet
+    and VAR_AsyncSet, which return as soon as the request has been sent.
+
+    Completions wake the file descriptor returned by VAR_AsyncFd, which
+    can be added to an epoll set.  It is a signalfd for SIG_VAR_ASYNC,
+    which is blocked in the calling thread.  Once it is readable, the
+    completed requests are collected with VAR_AsyncComplete.
+
+    Only variables owned by the root server can be accessed via an
+    asynchronous request context.
 
     @param[in]
         hVarServer
-            handle to the Variable Server
+            handle to the variable server
 
     @param[in]
-        pName
-            pointer to the variable name
+        depth
+            maximum number of requests in flight, up to
+            VARSERVER_MAX_ASYNC_DEPTH
 
-    @retval handle of the variable
-    @retval VAR_INVALID if the variable cannot be found
+    @retval pointer to the asynchronous request context
+    @retval NULL the context could not be opened
 
 ==============================================================================*/
-VAR_HANDLE VAR_FindByName( VARSERVER_HANDLE hVarServer, char *pName )
+VarAsync *VAR_AsyncOpen( VARSERVER_HANDLE hVarServer, size_t depth )
 {
-    VAR_HANDLE hVar = VAR_INVALID;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
-    int rc;
-    size_t len;
+    VarClient *pRoot = ValidateHandle( hVarServer );
+    VarAsync *pVarAsync = NULL;
+    VarClient *pChannel;
+    sigset_t mask;
+    bool ok = true;
+    size_t i;
 
-    if( ( pVarClient != NULL ) &&
-        ( pName != NULL ) )
+    if( ( pRoot != NULL ) &&
+        ( depth > 0 ) &&
+        ( depth <= VARSERVER_MAX_ASYNC_DEPTH ) )
     {
-        len = strlen(pName);
-        if( len < MAX_NAME_LEN )
+        pVarAsync = calloc( 1, sizeof( VarAsync ) );
+        if( pVarAsync != NULL )
         {
-            pVarClient->variableInfo.instanceID = 0;
+            pVarAsync->pRoot = pRoot;
+            pVarAsync->pRequests = calloc( depth, sizeof( VarAsyncRequest ) );
 
-            /* copy the name to the variable info request */
-            var_parseName( pVarClient->variableInfo.name,
-                           MAX_NAME_LEN,
-                           pName,
-                           &pVarClient->variableInfo.instanceID );
+            /* the completion signals are read via a signalfd */
+            sigemptyset( &mask );
+            sigaddset( &mask, SIG_VAR_ASYNC );
+            sigprocmask( SIG_BLOCK, &mask, NULL );
+            pVarAsync->fd = signalfd( -1, &mask, SFD_NONBLOCK | SFD_CLOEXEC );
 
-            /* specify the request type */
-            pVarClient->requestType = VARREQUEST_FIND;
+            ok = ( pVarAsync->pRequests != NULL ) &&
+                 ( pVarAsync->fd != -1 );
+        }
 
-            rc = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-            if( rc == EOK )
+        /* open a connection for each request which can be in flight */
+        for( i = 0; ( pVarAsync != NULL ) && ok && ( i < depth ); i++ )
+        {
+            pChannel = NewClient( pRoot->workbufsize - 1,
+                                  0,
+                                  ++asyncChannels );
+            if( pChannel != NULL )
+            {
+                pChannel->debug = pRoot->debug;
+                pChannel->priority = pRoot->priority;
+                pVarAsync->pRequests[pVarAsync->depth++].pVarClient =
+                                                                pChannel;
+
+                ok = ( InitServerInfo( pChannel ) == EOK ) &&
+                     ( ClientRequest( pChannel, SIG_NEWCLIENT ) == EOK ) &&
+                     ( pChannel->clientid != 0 );
+
+                pChannel->asyncCompletion = ok;
+            }
+            else
             {
-                hVar = (VAR_HANDLE)pVarClient->responseVal;
+                ok = false;
             }
         }
+
+        if( ( pVarAsync != NULL ) && ( ok == false ) )
+        {
+            VAR_AsyncClose( pVarAsync );
+            pVarAsync = NULL;
+        }
     }
 
-    return hVar;
+    return pVarAsync;
+}
+
+/*============================================================================*/
+/*  VAR_AsyncFd                                                               */
+/*!
+    Get the completion file descriptor of an asynchronous request context
+
+    The VAR_AsyncFd function gets the file descriptor which becomes
+    readable when a request submitted to the asynchronous request
+    context completes.  It should not be read directly; call
+    VAR_AsyncComplete once it is readable.
+
+    @param[in]
+        pVarAsync
+            pointer to the asynchronous request context
+
+    @retval the completion file descriptor
+    @retval -1 invalid arguments
+
+==============================================================================*/
+int VAR_AsyncFd( VarAsync *pVarAsync )
+{
+    return ( pVarAsync != NULL ) ? pVarAsync->fd : -1;
+}
+
+/*============================================================================*/
+/*  VAR_AsyncGet                                                              */
+/*!
+    Submit an asynchronous request to get a variable value
+
+    The VAR_AsyncGet function submits a request to get the value of the
+    specified variable, and returns without waiting for the response.
+    The value is stored in the var object when the request completes,
+    as for VAR_Get, so the var object must remain valid until then.
+
+    @param[in]
+        pVarAsync
+            pointer to the asynchronous request context
+
+    @param[in]
+        hVar
+            handle to the variable to be retrieved
+
+    @param[in]
+        pVarObject
+            specifies the location where the variable value should be stored
+
+    @param[in]
+        tag
+            caller defined tag which is returned with the completion
+
+    @retval EOK - the request was submitted
+    @retval EBUSY - the maximum number of requests are already in flight
+    @retval EXDEV - the variable is not owned by the root server
+    @retval EINVAL - invalid arguments
+    @retval other - the request could not be sent
+
+==============================================================================*/
+int VAR_AsyncGet( VarAsync *pVarAsync,
+                  VAR_HANDLE hVar,
+                  VarObject *pVarObject,
+                  void *tag )
+{
+    int result = EINVAL;
+    VarAsyncRequest *pRequest;
+    VarClient *pVarClient;
+
+    if( ( pVarAsync != NULL ) &&
+        ( pVarObject != NULL ) )
+    {
+        result = var_AsyncNewRequest( pVarAsync, hVar, &pRequest );
+        if( result == EOK )
+        {
+            pRequest->requestType = VARREQUEST_GET;
+            pRequest->hVar = hVar;
+            pRequest->pVarObject = pVarObject;
+            pRequest->tag = tag;
+            pRequest->retried = false;
+
+            /* try to read the value directly from shared memory */
+            if( var_GetSharedValue( pVarAsync->pRoot,
+                                    hVar,
+                                    pVarObject ) == EOK )
+            {
+                pRequest->result = EOK;
+                pRequest->state = VAR_ASYNC_DONE;
+                pVarAsync->inflight++;
+                var_AsyncWake();
+            }
+            else
+            {
+                pVarClient = pRequest->pVarClient;
+                pVarClient->requestType = VARREQUEST_GET;
+                pVarClient->variableInfo.hVar = hVar;
+
+                result = var_AsyncSubmit( pVarAsync, pRequest );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_AsyncSet                                                              */
+/*!
+    Submit an asynchronous request to set a variable value
+
+    The VAR_AsyncSet function submits a request to set the value of the
+    specified variable, and returns without waiting for the response.
+    The value is copied when the request is submitted.
+
+    @param[in]
+        pVarAsync
+            pointer to the asynchronous request context
+
+    @param[in]
+        hVar
+            handle to the variable to be set
+
+    @param[in]
+        pVarObject
+            pointer to the var object containing the value to set
+
+    @param[in]
+        tag
+            caller defined tag which is returned with the completion
+
+    @retval EOK - the request was submitted
+    @retval EBUSY - the maximum number of requests are already in flight
+    @retval EXDEV - the variable is not owned by the root server
+    @retval E2BIG - the value does not fit in the working buffer
+    @retval EINVAL - invalid arguments
+    @retval other - the request could not be sent
+
+==============================================================================*/
+int VAR_AsyncSet( VarAsync *pVarAsync,
+                  VAR_HANDLE hVar,
+                  VarObject *pVarObject,
+                  void *tag )
+{
+    int result = EINVAL;
+    VarAsyncRequest *pRequest;
+    VarClient *pVarClient;
+
+    if( ( pVarAsync != NULL ) &&
+        ( pVarObject != NULL ) )
+    {
+        result = var_AsyncNewRequest( pVarAsync, hVar, &pRequest );
+        if( result == EOK )
+        {
+            pRequest->requestType = VARREQUEST_SET;
+            pRequest->hVar = hVar;
+            pRequest->pVarObject = pVarObject;
+            pRequest->tag = tag;
+
+            pVarClient = pRequest->pVarClient;
+            pVarClient->requestType = VARREQUEST_SET;
+            pVarClient->variableInfo.hVar = hVar;
+            pVarClient->variableInfo.var.type = pVarObject->type;
+            pVarClient->variableInfo.var.val = pVarObject->val;
+            pVarClient->variableInfo.var.len = pVarObject->len;
+
+            /* strings have to be transferred via the working buffer */
+            if( pVarObject->type == VARTYPE_STR )
+            {
+                result = var_CopyStringVarObjectToWorkbuf( pVarClient,
+                                                           pVarObject );
+            }
+            else if( pVarObject->type == VARTYPE_BLOB )
+            {
+                result = var_CopyBlobVarObjectToWorkbuf( pVarClient,
+                                                         pVarObject );
+            }
+
+            if( result == EOK )
+            {
+                result = var_AsyncSubmit( pVarAsync, pRequest );
+            }
+        }
+    }
+
+    return result;
 }
 
 /*============================================================================*/
-/*  var_parseName                                                             */
+/*  VAR_AsyncComplete                                                         */
 /*!
-    Parse a variable name and extract its instance identifier
-
-    The var_parseName function processes a variable name and
-    extracts its instance identifier.
-
-    eg
+    Collect the completed asynchronous requests
 
-    [12345]/foo/baa/baz -> "/foo/baa/baz", 12345
-    /foo[12345]/baa/baz -> "/foo/baa/baz", 12345
-
-    @param[in,out]
-        dst
-            output buffer for variable name string
+    The VAR_AsyncComplete function collects up to max completed requests
+    of the asynchronous request context, without waiting.  It should be
+    called when the completion file descriptor is readable.  If more
+    than max requests have completed, the completion file descriptor
+    remains readable.
 
     @param[in]
-        len
-            size of output buffer
+        pVarAsync
+            pointer to the asynchronous request context
+
+    @param[out]
+        pCompletions
+            array of max completion objects to populate
 
     @param[in]
-        src
-            pointer to input buffer
+        max
+            maximum number of completions to collect
 
-    @param[in,out]
-        id
-            pointer to a uint32 to store the instance id
+    @param[out]
+        pCount
+            pointer to a location to store the number of completions
 
-    @retval EOK variable name processed ok
-    @retval EINVAL invalid arguments
+    @retval EOK - the completions were collected
+    @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-static int var_parseName( char *dst, size_t len, char *src, uint32_t *id )
+int VAR_AsyncComplete( VarAsync *pVarAsync,
+                       VarAsyncCompletion *pCompletions,
+                       size_t max,
+                       size_t *pCount )
 {
     int result = EINVAL;
-    char idstr[32] = {0};
-    int i = 0;
-    int state = 0;
-    char *s = src;
-    char *d = dst;
-    size_t n = 0;
-    char c;
+    VarAsyncRequest *pRequest;
+    struct signalfd_siginfo info;
+    size_t count = 0;
+    bool more = false;
+    size_t i;
 
-    if ( ( s != NULL ) &&
-         ( d != NULL ) &&
-         ( id != NULL ) )
+    if( ( pVarAsync != NULL ) &&
+        ( pCompletions != NULL ) &&
+        ( pCount != NULL ) )
     {
-        while( ( ( c = *s++ ) != 0 ) &&
-               ( n < len-1 ) )
+        /* drain the completion signals */
+        while( read( pVarAsync->fd,
+                     &info,
+                     sizeof( info ) ) == sizeof( info ) );
+
+        for( i = 0; i < pVarAsync->depth; i++ )
         {
-            switch( state )
+            pRequest = &pVarAsync->pRequests[i];
+            if( ( pRequest->state == VAR_ASYNC_BUSY ) &&
+                ( sem_trywait( &pRequest->pVarClient->sem ) == 0 ) )
             {
-                case 0:
-                    /* looking for instanceID */
-                    if ( c == '[' )
-                    {
-                        /* start of instanceID */
-                        state = 1;
-                    }
-                    else
-                    {
-                        /* collect variable name character */
-                        *d++ = c;
-                        n++;
-                    }
-                    break;
-
-                case 1:
-                    /* collect instance ID */
-                    if ( c == ']' )
-                    {
-                        /* terminate instanceID */
-                        idstr[i] = 0;
-                        *id = atol(idstr);
-                        state = 2;
-                    }
-                    else
-                    {
-                        if ( i < 31 )
-                        {
-                            idstr[i++] = c;
-                        }
-                    }
-                    break;
+                var_AsyncFinish( pRequest );
+            }
 
-                case 2:
-                    /* collect variable name character */
-                    *d++ = c;
-                    n++;
-                    break;
+            if( pRequest->state == VAR_ASYNC_DONE )
+            {
+                if( count < max )
+                {
+                    pCompletions[count].tag = pRequest->tag;
+                    pCompletions[count].hVar = pRequest->hVar;
+                    pCompletions[count].result = pRequest->result;
+                    pCompletions[count].pVarObject = pRequest->pVarObject;
+                    count++;
 
-                default:
-                    /* should never get here */
-                    *d++ = c;
-                    n++;
-                    break;
+                    pRequest->state = VAR_ASYNC_IDLE;
+                    pVarAsync->inflight--;
+                }
+                else
+                {
+                    more = true;
+                }
             }
         }
 
-        /* NUL terminate the name */
-        *d = '\0';
+        if( more == true )
+        {
+            /* keep the completion file descriptor readable */
+            var_AsyncWake();
+        }
 
+        *pCount = count;
         result = EOK;
     }
 
@@ -1590,251 +6228,372 @@ static int var_parseName( char *dst, size_t len, char *src, uint32_t *id )
 }
 
 /*============================================================================*/
-/*  VAR_Get                                                                   */
+/*  VAR_AsyncClose                                                            */
 /*!
-    Get a variable value and store it in the specified var object
-
-    The VAR_Get function gets the value of the variable
-    specified by hVar and puts it into the specified var object
-
-    @param[in]
-        hVarServer
-            handle to the variable server
+    Close an asynchronous request context
 
-    @param[in]
-        hVar
-            handle to the variable to be retrieved
+    The VAR_AsyncClose function waits for the requests which are still
+    in flight, closes the connections of the asynchronous request
+    context, and releases its resources.  The completions of requests
+    which were not collected are discarded.
 
     @param[in]
-        pVarObject
-            specifies the location where the variable value should be stored
+        pVarAsync
+            pointer to the asynchronous request context
 
-    @retval EOK - the variable was retrieved ok
+    @retval EOK - the context was closed
     @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-int VAR_Get( VARSERVER_HANDLE hVarServer,
-             VAR_HANDLE hVar,
-             VarObject *pVarObject )
+int VAR_AsyncClose( VarAsync *pVarAsync )
 {
     int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    struct signalfd_siginfo info;
+    VarClient *pVarClient;
+    size_t i;
 
-    if( ( pVarClient != NULL ) &&
-        ( pVarObject != NULL ) )
+    if( pVarAsync != NULL )
     {
-        pVarClient->requestType = VARREQUEST_GET;
-        pVarClient->variableInfo.hVar = hVar;
+        for( i = 0; i < pVarAsync->depth; i++ )
+        {
+            pVarClient = pVarAsync->pRequests[i].pVarClient;
+            if( pVarAsync->pRequests[i].state == VAR_ASYNC_BUSY )
+            {
+                /* wait for the server to finish with the connection */
+                while( ( sem_wait( &pVarClient->sem ) == -1 ) &&
+                       ( errno == EINTR ) );
+            }
 
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-        if( result == EOK )
+            if( pVarClient->clientid != 0 )
+            {
+                pVarClient->asyncCompletion = false;
+                pVarClient->requestType = VARREQUEST_CLOSE;
+                ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            }
+
+            ClientCleanup( pVarClient );
+        }
+
+        if( pVarAsync->fd != -1 )
         {
-            result = var_GetVarObject( pVarClient, pVarObject );
+            /* discard any completion signals which are still pending */
+            while( read( pVarAsync->fd,
+                         &info,
+                         sizeof( info ) ) == sizeof( info ) );
+            close( pVarAsync->fd );
         }
+
+        free( pVarAsync->pRequests );
+        free( pVarAsync );
+
+        result = EOK;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  VAR_GetStrByName                                                          */
+/*  VAR_Alias                                                                 */
 /*!
-    Get a string variable value and store it in the specified buffer
+    Create a variable alias
 
-    The VAR_GetStrByName function gets the value of the string variable
-    specified by hVar and puts it into the specified buffer
+    The VAR_Alias function creates a variable alias which is another name
+    for an already existing variable which references the same storage
+    object.
 
     @param[in]
         hVarServer
             handle to the variable server
 
     @param[in]
-        name
-            name of the variable to be retrieved
+        hVar
+            handle to the variable to be aliased
 
-    @param[in,out]
-        buf
-            pointer to the buffer to store the string
+    @param[in]
+        alias
+            pointer to the alias name for the variable
 
     @param[in]
-        len
-            length of the provided buffer to store the result
+        hAlias
+            pointer to a location to store the handle to the alias
 
-    @retval EOK - the variable was retrieved ok
+    @retval EOK - the variable was set ok
+    @retval EXDEV - the alias belongs to a different shard than the variable
     @retval EINVAL - invalid arguments
-    @retval ENOTSUP - invalid variable type
-    @retval ENOENT - variable not found
-    @retval other error as returned by VAR_Get
 
 ==============================================================================*/
-int VAR_GetStrByName( VARSERVER_HANDLE hVarServer,
-                      char *name,
-                      char *buf,
-                      size_t len )
+int VAR_Alias( VARSERVER_HANDLE hVarServer,
+               VAR_HANDLE hVar,
+               char *alias,
+               VAR_HANDLE *hAlias )
 {
     int result = EINVAL;
-    VAR_HANDLE hVar;
-    VarObject obj;
+    VarClient *pRoot = ValidateHandle( hVarServer );
+    VarClient *pVarClient = var_Route( pRoot, &hVar );
+    VarInfo *pVarInfo;
 
-    if ( ( hVarServer != NULL ) &&
-         ( name != NULL ) &&
-         ( buf != NULL ) &&
-         ( len > 0 ) )
+    if( ( pVarClient != NULL ) &&
+        ( alias != NULL ) &&
+        ( var_NameShard( pRoot, alias ) != pVarClient->shard ) )
     {
-        /* get a handle to the variable */
-        hVar = VAR_FindByName( hVarServer, name );
-        if ( hVar != VAR_INVALID )
-        {
-            /* specify the receive buffer and buffer length */
-            obj.val.str = buf;
-            obj.len = len;
+        /* an alias must be owned by the same server as its variable */
+        result = EXDEV;
+    }
+    else if( ( pVarClient != NULL ) &&
+             ( alias != NULL ) )
+    {
+        pVarInfo = &pVarClient->variableInfo;
+        pVarClient->requestType = VARREQUEST_ALIAS;
+        pVarInfo->hVar = hVar;
 
-            /* get the (string) value of the variable */
-            result = VAR_Get( hVarServer, hVar, &obj );
-            if ( result == EOK )
+        /* copy the alias to the variable info request */
+        var_parseName( pVarClient->variableInfo.name,
+                       MAX_NAME_LEN,
+                       alias,
+                       &pVarClient->variableInfo.instanceID );
+
+        /* send the request to the server */
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( result == EOK )
+        {
+            pVarInfo->hVar = pVarClient->responseVal;
+            if ( pVarInfo->hVar != VAR_INVALID )
             {
-                if( obj.type != VARTYPE_STR )
+                if ( hAlias != NULL )
                 {
-                    result = ENOTSUP;
+                    *hAlias = var_ShardHandle( pVarClient, pVarInfo->hVar );
                 }
+                result = EOK;
+            }
+            else
+            {
+                result = EINVAL;
+                pVarInfo->hVar = VAR_INVALID;
             }
-        }
-        else
-        {
-            result = ENOENT;
         }
     }
 
     return result;
 }
 
+
 /*============================================================================*/
-/*  VAR_GetBlobByName                                                         */
+/*  VAR_GetAliases                                                            */
 /*!
-    Get a blob variable value and store it in the specified buffer
+    Get Aliases of the specified variable
 
-    The VAR_GetBlobByName function gets the value of the blob variable
-    specified by hVar and puts it into the specified buffer
+    The VAR_GetAliases function gets the aliases of the specified variable.
 
     @param[in]
         hVarServer
             handle to the variable server
 
     @param[in]
-        name
-            name of the variable to be retrieved
+        hVar
+            handle to the variable to get the aliases for
 
-    @param[in,out]
-        buf
-            pointer to the buffer to store the blob
+    @param[in]
+        aliases
+            pointer to a buffer to store the aliases
 
     @param[in]
         len
-            length of the provided buffer to store the result
+            length of the buffer to store the aliases
 
-    @retval EOK - the variable was retrieved ok
+    @param[in,out]
+        n
+            pointer to a location to store the number of retrieved aliases
+
+    @retval EOK - the aliases were retrieved ok
     @retval EINVAL - invalid arguments
-    @retval ENOTSUP - invalid variable type
-    @retval ENOENT - variable not found
-    @retval other error as returned by VAR_Get
 
 ==============================================================================*/
-int VAR_GetBlobByName( VARSERVER_HANDLE hVarServer,
-                       char *name,
-                       void *buf,
-                       size_t len )
+int VAR_GetAliases( VARSERVER_HANDLE hVarServer,
+                    VAR_HANDLE hVar,
+                    VAR_HANDLE *aliases,
+                    size_t len,
+                    size_t *n )
 {
     int result = EINVAL;
-    VAR_HANDLE hVar;
-    VarObject obj;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+    VarInfo *pVarInfo;
+    VAR_HANDLE *pVarHandle;
+    size_t count = 0;
 
-    if ( ( hVarServer != NULL ) &&
-         ( name != NULL ) &&
-         ( buf != NULL ) &&
-         ( len > 0 ) )
+    if( ( pVarClient != NULL ) &&
+        ( aliases != NULL ) &&
+        ( n != NULL ) &&
+        ( len > 0 ) )
     {
-        /* get a handle to the variable */
-        hVar = VAR_FindByName( hVarServer, name );
-        if ( hVar != VAR_INVALID )
-        {
-            /* specify the receive buffer and buffer length */
-            obj.val.str = buf;
-            obj.len = len;
+        pVarInfo = &pVarClient->variableInfo;
+        pVarClient->requestType = VARREQUEST_GET_ALIASES;
+        pVarInfo->hVar = hVar;
 
-            /* get the (blob) value of the variable */
-            result = VAR_Get( hVarServer, hVar, &obj );
+        /* send the request to the server */
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( result == EOK )
+        {
+            result = pVarClient->responseVal;
             if ( result == EOK )
             {
-                if( obj.type != VARTYPE_BLOB )
+                /* the aliases are returned in the working buffer */
+                pVarHandle = (VAR_HANDLE *)&(pVarClient->workbuf);
+                while ( ( *pVarHandle != VAR_INVALID ) && ( count < len ) )
                 {
-                    result = ENOTSUP;
+                    /* copy the alias handle */
+                    aliases[count] = var_ShardHandle( pVarClient,
+                                                      pVarHandle[count] );
+                    count++;
                 }
+
+                /* return the number of aliases */
+                *n = count;
             }
         }
-        else
-        {
-            result = ENOENT;
-        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  VAR_GetValidationRequest                                                  */
+/*  var_Modify                                                                */
 /*!
-    Get a information about a validation request
+    Send a MODIFY request to the server
 
-    The VAR_GetValidationRequest function gets the the validation
-    request specified by the validation request identifier.
-    The returned VarObject will contain the proposed variable
-    change requested by the other client.
+    The var_Modify function packs the operands of a read-modify-write
+    request into the client's working buffer, followed by the data for
+    any string operands, and sends the request to the server.  If the
+    previous value of a string variable does not fit in the working
+    buffer, the buffer is grown and the request is sent again.  The
+    server only returns E2BIG when the variable was not changed.
 
     @param[in]
-        hVarServer
-            handle to the variable server
+        pVarClient
+            pointer to the VarClient of the server owning the variable
 
     @param[in]
-        id
-            identifier of the validation request
-
-    @param[out]
         hVar
-            handle of the variable to be validated
+            handle to the variable to modify
+
+    @param[in]
+        op
+            the operation to perform
+
+    @param[in]
+        pOperand
+            pointer to the operand, or the new value for VAR_MODIFY_CAS
+
+    @param[in]
+        pExpected
+            pointer to the expected value for VAR_MODIFY_CAS
 
     @param[out]
-        pVarObject
-            specifies the location where the variable value should be stored
+        pOld
+            optional pointer to a VarObject to receive the previous value
 
-    @retval EOK - the validation request was retrieved ok
-    @retval ENOMEM - cannot allocate memory for the string (string var only)
-    @retval EINVAL - invalid arguments
+    @retval EOK - the variable was modified
+    @retval E2BIG - the operands do not fit in the working buffer
+    @retval other - error from the server
 
 ==============================================================================*/
-int VAR_GetValidationRequest( VARSERVER_HANDLE hVarServer,
-                              uint32_t id,
-                              VAR_HANDLE *hVar,
-                              VarObject *pVarObject )
+static int var_Modify( VarClient *pVarClient,
+                       VAR_HANDLE hVar,
+                       VarModifyOp op,
+                       VarObject *pOperand,
+                       VarObject *pExpected,
+                       VarObject *pOld )
 {
     int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    VarModify *pModify;
+    size_t operandLen = 0;
+    size_t expectedLen = 0;
+    size_t len;
+    int attempt;
 
-    if( ( pVarClient != NULL ) &&
-        ( pVarObject != NULL ) &&
-        ( hVar != NULL ) )
+    if( pOperand->type == VARTYPE_STR )
     {
-        pVarClient->requestType = VARREQUEST_GET_VALIDATION_REQUEST;
-        pVarClient->requestVal = id;
+        operandLen = ( pOperand->val.str != NULL )
+                        ? strlen( pOperand->val.str ) + 1
+                        : 0;
+    }
+
+    if( pExpected->type == VARTYPE_STR )
+    {
+        expectedLen = ( pExpected->val.str != NULL )
+                        ? strlen( pExpected->val.str ) + 1
+                        : 0;
+    }
+
+    len = sizeof( VarModify ) + operandLen + expectedLen;
+
+    if( ( ( pOperand->type == VARTYPE_STR ) && ( operandLen == 0 ) ) ||
+        ( ( pExpected->type == VARTYPE_STR ) && ( expectedLen == 0 ) ) )
+    {
+        result = EINVAL;
+    }
+    else if( len > UINT32_MAX )
+    {
+        result = E2BIG;
+    }
+    else
+    {
+        result = var_GrowWorkbuf( pVarClient, len );
+    }
+
+    for( attempt = 0; ( attempt < 2 ) && ( result == EOK ); attempt++ )
+    {
+        /* pack the operands, followed by the string operands */
+        pModify = (VarModify *)&pVarClient->workbuf;
+        pModify->operand = *pOperand;
+        pModify->expected = *pExpected;
+        pModify->operandOffset = sizeof( VarModify );
+        pModify->expectedOffset = sizeof( VarModify ) + operandLen;
+
+        if( operandLen > 0 )
+        {
+            memcpy( &pVarClient->workbuf + pModify->operandOffset,
+                    pOperand->val.str,
+                    operandLen );
+        }
+
+        if( expectedLen > 0 )
+        {
+            memcpy( &pVarClient->workbuf + pModify->expectedOffset,
+                    pExpected->val.str,
+                    expectedLen );
+        }
+
+        pVarClient->requestType = VARREQUEST_MODIFY;
+        pVarClient->requestVal = op;
+        pVarClient->variableInfo.hVar = hVar;
 
         result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
         if( result == EOK )
         {
-            result = var_GetVarObject( pVarClient, pVarObject );
-            if( result == EOK )
-            {
-                /* get the handle of the variable to be validated */
-                *hVar = pVarClient->variableInfo.hVar;
-            }
+            result = pVarClient->responseVal;
+        }
+
+        if( ( result == E2BIG ) &&
+            ( attempt == 0 ) )
+        {
+            /* the server has returned the length of the previous value
+               which did not fit, so grow the working buffer and retry */
+            result = var_GrowWorkbuf(
+                            pVarClient,
+                            pVarClient->variableInfo.var.len + 1 );
+        }
+        else
+        {
+            break;
+        }
+    }
+
+    if( ( ( result == EOK ) || ( result == EAGAIN ) ) &&
+        ( pOld != NULL ) )
+    {
+        if( var_GetVarObject( pVarClient, pOld ) != EOK )
+        {
+            result = ENOMEM;
         }
     }
 
@@ -1842,114 +6601,124 @@ int VAR_GetValidationRequest( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  VAR_SendValidationResponse                                                */
+/*  var_CopyStringVarObjectToWorkbuf                                          */
 /*!
-    Send a Validation response
-
-    The VAR_SendValidationResponse function sends a validation response
-    for the specified validation reqeust.
+    Copy a string object to the working buffer
 
-    @param[in]
-        hVarServer
-            handle to the variable server
+    The var_CopyStringVarObjectToWorkbuf function copies the string
+    object into the client's working buffer for transfer to the server.
 
     @param[in]
-        id
-            identifier of the validation request
+        pVarClient
+            pointer to the VarClient object containing the working buffer
 
     @param[in]
-        response
-            EOK - the validation was successful
-            EINVAL - the validation was unsuccessful
+        pVarObject
+            pointer to the VarObject containing the string to copy
 
-    @retval EOK - the validation request was retrieved ok
+    @retval EOK - the string was copied successfully
     @retval EINVAL - invalid arguments
+    @retval E2BIG - the working buffer cannot grow to fit the string
+    @retval ENOTSUP - not a string object
 
 ==============================================================================*/
-int VAR_SendValidationResponse( VARSERVER_HANDLE hVarServer,
-                                uint32_t id,
-                                int response  )
+static int var_CopyStringVarObjectToWorkbuf( VarClient *pVarClient,
+                                             VarObject *pVarObject )
 {
     int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    size_t len;
+    char *p;
 
-    if( pVarClient != NULL )
+    if ( ( pVarClient != NULL ) &&
+         ( pVarObject != NULL ) )
     {
-        pVarClient->requestType = VARREQUEST_SEND_VALIDATION_RESPONSE;
-        pVarClient->requestVal = id;
-        pVarClient->responseVal = response;
+        if ( pVarObject->type == VARTYPE_STR )
+        {
+            /* get the string length */
+            len = pVarObject->len;
+            if ( len >= pVarClient->workbufsize )
+            {
+                /* grow the working buffer to fit the string */
+                result = var_GrowWorkbuf( pVarClient, len + 1 );
+            }
 
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if( ( len > 0 ) &&
+                ( len < pVarClient->workbufsize ) )
+            {
+                /* copy the string into the working buffer */
+                p = &pVarClient->workbuf;
+                memcpy( p, pVarObject->val.str, len );
+
+                /* NUL terminate the string */
+                p[len] = 0;
+
+                result = EOK;
+            }
+        }
+        else
+        {
+            result = ENOTSUP;
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  var_GetVarObject                                                          */
+/*  var_CopyBlobVarObjectToWorkbuf                                            */
 /*!
-    Get a variable object from the variable client
-
-    The var_GetVarObject function retrieves a copy of the client's
-    VarObject which is returned from the server.  If the object
-    type is a string, and the destination VarObject has an existing
-    string buffer, the string is copied into the VarObject's string buffer.
-    If the VarObject does not have a string buffer, one is automatically
-    allocated and is the responsibility of the caller to deallocate
-    the string buffer.
+    Copy a blob object to the working buffer
 
-    If the object type is a blob, and the destination VarObject has an
-    existing blob buffer, then the blob is copied into the VarObject's blob
-    buffer.  If the VarObject does not have a blob buffer, one is automatically
-    allocated and is the responsibility of the caller to deallocate
-    the blob buffer.
+    The var_CopyBlobVarObjectToWorkbuf function copies the blob
+    object into the client's working buffer for transfer to the server.
 
     @param[in]
         pVarClient
-            pointer to the Variable Client which contains the source VarObject
+            pointer to the VarClient object containing the working buffer
 
     @param[in]
-        VarObject
-            pointer to the destination VarObject
+        pVarObject
+            pointer to the VarObject containing the blob to copy
 
-    @retval EOK - the validation request was retrieved ok
-    @retval ENOMEM - cannot allocate memory for the object (string/blob only)
-    @retval E23BIG - not enough space to store the string/blob variable
-    @retval ENOTSUP - incorrect type match
+    @retval EOK - the blob was copied successfully
     @retval EINVAL - invalid arguments
+    @retval E2BIG - the working buffer cannot grow to fit the blob
+    @retval ENOTSUP - not a string object
 
 ==============================================================================*/
-static int var_GetVarObject( VarClient *pVarClient, VarObject *pVarObject )
+static int var_CopyBlobVarObjectToWorkbuf( VarClient *pVarClient,
+                                           VarObject *pVarObject )
 {
     int result = EINVAL;
-    size_t srclen;
+    size_t len;
+    char *p;
 
-    if( ( pVarClient != NULL ) &&
-        ( pVarObject != NULL ) )
+    if ( ( pVarClient != NULL ) &&
+         ( pVarObject != NULL ) )
     {
-        /* set the destination object type */
-        pVarObject->type = pVarClient->variableInfo.var.type;
-        if( pVarObject->type == VARTYPE_STR )
-        {
-            /* get the string from the work buffer */
-            result = var_GetStringObjectFromWorkbuf( pVarClient, pVarObject );
-        }
-        else if ( pVarObject->type == VARTYPE_BLOB )
-        {
-            /* get the blob from the work buffer */
-            result = var_GetBlobObjectFromWorkbuf( pVarClient, pVarObject );
-        }
-        else
+        if ( pVarObject->type == VARTYPE_BLOB )
         {
-            /* copy primitive type */
-            pVarObject->val = pVarClient->variableInfo.var.val;
-
-            /* get the source object length */
-            srclen = pVarClient->variableInfo.var.len;
+            /* get the blob length */
+            len = pVarObject->len;
+            if ( len >= pVarClient->workbufsize )
+            {
+                /* grow the working buffer to fit the blob */
+                result = var_GrowWorkbuf( pVarClient, len + 1 );
+            }
 
-            pVarObject->len = srclen;
+            if( ( len > 0 ) &&
+                ( len < pVarClient->workbufsize ) )
+            {
+                /* copy the blob into the working buffer */
+                p = &pVarClient->workbuf;
+                memcpy( p, pVarObject->val.blob, len );
 
-            result = EOK;
+                result = EOK;
+            }
+        }
+        else
+        {
+            result = ENOTSUP;
         }
     }
 
@@ -1957,245 +6726,322 @@ static int var_GetVarObject( VarClient *pVarClient, VarObject *pVarObject )
 }
 
 /*============================================================================*/
-/*  var_GetStringObjectFromWorkbuf                                            */
+/*  var_GrowWorkbuf                                                           */
 /*!
-    Get a string object from the variable client work buffer
+    Grow the client working buffer
 
-    The var_GetStringObjectFromWorkbuf function retrieves a copy of the client's
-    VarObject which is returned from the server.  If the object
-    type is a string, and the destination VarObject has an existing
-    string buffer, the string is copied into the VarObject's string buffer.
-    If the VarObject does not have a string buffer, one is automatically
-    allocated and is the responsibility of the caller to deallocate
-    the string buffer.
+    The var_GrowWorkbuf function makes sure the client working buffer
+    can hold a transfer of the specified length.  The buffer size is
+    doubled until it is large enough, the client shared memory object
+    is extended and remapped in place inside the range reserved by
+    NewClient, and the server is asked to remap its view of it.
+
+    The request type and request value of a request which is being
+    prepared are preserved, so the working buffer can be grown part
+    way through building a request.
 
     @param[in]
         pVarClient
-            pointer to the Variable Client which contains the source VarObject
+            pointer to the VarClient object containing the working buffer
 
     @param[in]
-        VarObject
-            pointer to the destination VarObject
+        len
+            number of bytes required in the working buffer
 
-    @retval EOK - the validation request was retrieved ok
-    @retval ENOMEM - cannot allocate memory for the object (string/blob only)
-    @retval E23BIG - not enough space to store the string/blob variable
-    @retval ENOTSUP - incorrect type match
+    @retval EOK - the working buffer is large enough
+    @retval E2BIG - the working buffer cannot grow to the required length
     @retval EINVAL - invalid arguments
+    @retval other - error from shm_open, ftruncate, mmap or the server
 
 ==============================================================================*/
-static int var_GetStringObjectFromWorkbuf( VarClient *pVarClient,
-                                           VarObject *pVarObject )
+static int var_GrowWorkbuf( VarClient *pVarClient, size_t len )
 {
     int result = EINVAL;
-    size_t srclen;
-    char *pSrcString;
+    char clientname[BUFSIZ];
+    VarRequest requestType;
+    int requestVal;
+    size_t size;
+    void *p;
+    int fd;
 
-    if ( ( pVarClient != NULL ) &&
-         ( pVarObject != NULL ) )
+    if ( pVarClient != NULL )
     {
-        /* set the destination object type */
-        pVarObject->type = pVarClient->variableInfo.var.type;
-        if ( pVarObject->type == VARTYPE_STR )
+        if ( len <= pVarClient->workbufsize )
         {
-            /* get the source string */
-            pVarClient->variableInfo.var.val.str = &pVarClient->workbuf;
-            pSrcString = pVarClient->variableInfo.var.val.str;
+            result = EOK;
+        }
+        else if ( len > pVarClient->workbufmax )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            /* double the buffer to avoid growing it on every transfer */
+            size = pVarClient->workbufsize;
+            while ( size < len )
+            {
+                size *= 2;
+            }
 
-            if( pSrcString != NULL )
+            if ( size > pVarClient->workbufmax )
             {
-                /* get the source object length */
-                srclen = pVarClient->variableInfo.var.len;
+                size = pVarClient->workbufmax;
+            }
 
-                if( pVarObject->val.str == NULL )
+            ClientName( clientname,
+                        sizeof( clientname ),
+                        pVarClient->client_pid,
+                        pVarClient->channel,
+                        pVarClient->shard );
+
+            fd = shm_open( clientname, O_RDWR, S_IRUSR | S_IWUSR );
+            if ( fd == -1 )
+            {
+                result = errno;
+            }
+            else
+            {
+                result = EOK;
+                if ( ftruncate( fd, sizeof(VarClient) + size - 1 ) == -1 )
                 {
-                    /* allocate memory for the target string */
-                    pVarObject->val.str = calloc( 1, srclen );
-                    pVarObject->len = srclen;
+                    result = errno;
                 }
                 else
                 {
-                    /* calculate the length of the source string */
-                    srclen = strlen( pSrcString ) + 1;
-                }
-
-                if( pVarObject->val.str != NULL )
-                {
-                    if( pVarObject->len >= srclen )
-                    {
-                        /* get string from the working buffer */
-                        strcpy( pVarObject->val.str,
-                                &pVarClient->workbuf );
-                        result = EOK;
-                    }
-                    else
+                    /* extend the mapping over the reserved address space */
+                    p = mmap( pVarClient,
+                              sizeof(VarClient) + size - 1,
+                              PROT_WRITE,
+                              MAP_SHARED | MAP_FIXED,
+                              fd,
+                              0 );
+                    if ( p == MAP_FAILED )
                     {
-                        /* not enough space to store the string */
-                        result = E2BIG;
+                        result = errno;
                     }
                 }
-                else
-                {
-                    /* no memory available for the string result */
-                    result = ENOMEM;
-                }
+
+                close( fd );
             }
-            else
+
+            if ( result == EOK )
             {
-                /* should not see this.  The source object says it is a string
-                    but it does not have a string pointer */
-                result = ENOTSUP;
+                /* ask the server to remap the client object.  The server
+                   updates workbufsize once it can see the new buffer */
+                requestType = pVarClient->requestType;
+                requestVal = pVarClient->requestVal;
+
+                pVarClient->requestType = VARREQUEST_RESIZE_WORKBUF;
+                pVarClient->requestVal = (int)size;
+
+                result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+                if ( result == EOK )
+                {
+                    result = pVarClient->responseVal;
+                }
+
+                pVarClient->requestType = requestType;
+                pVarClient->requestVal = requestVal;
             }
         }
-        else
-        {
-            result = ENOTSUP;
-        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  var_GetBlobObjectFromWorkbuf                                              */
-/*!
-    Get a blob object from the variable client work buffer
+/*  VAR_GetFirst                                                              */
+/*
+    Start a variable query
 
-    The var_GetBlobObjectFromWorkbuf function retrieves a copy of the client's
-    VarObject which is returned from the server.  If the object
-    type is a blob, and the destination VarObject has an existing
-    blob buffer, the blob is copied into the VarObject's blob buffer.
-    If the VarObject does not have a blob buffer, one is automatically
-    allocated and is the responsibility of the caller to deallocate
-    the blob buffer.
+    The VAR_GetFirst function initiates a variable query with the variable
+    server.
+
+    Variable queries can be made using a combination of the following:
+
+    - variable name
+    - variable instance ID
+    - variable flags
+    - variable tags
+
+    The query searches the root server first, and then each of the
+    shard servers in turn.
 
     @param[in]
-        pVarClient
-            pointer to the Variable Client which contains the source VarObject
+        hVarServer
+            handle to the variable server
 
     @param[in]
-        VarObject
-            pointer to the destination VarObject
+        query
+            pointer to the query to be made
 
-    @retval EOK - the validation request was retrieved ok
-    @retval ENOMEM - cannot allocate memory for the object (string/blob only)
-    @retval E23BIG - not enough space to store the string/blob variable
-    @retval ENOTSUP - incorrect type match
+    @param[in]
+        obj
+            pointer to the found variable information
+
+    @retval EOK - a match was found
     @retval EINVAL - invalid arguments
+    @retval ENOENT - no matching variable was found
 
 ==============================================================================*/
-static int var_GetBlobObjectFromWorkbuf( VarClient *pVarClient,
-                                         VarObject *pVarObject )
+int VAR_GetFirst( VARSERVER_HANDLE hVarServer,
+                  VarQuery *query,
+                  VarObject *obj )
 {
     int result = EINVAL;
-    size_t srclen;
-    void *pSrcBlob;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
 
-    if ( ( pVarClient != NULL ) &&
-         ( pVarObject != NULL ) )
+    if( ( pVarClient != NULL ) &&
+        ( query != NULL ) )
     {
-        /* set the destination object type */
-        pVarObject->type = pVarClient->variableInfo.var.type;
-        if ( pVarObject->type == VARTYPE_BLOB )
-        {
-            /* get the source blob */
-            pVarClient->variableInfo.var.val.blob = &pVarClient->workbuf;
-            pSrcBlob = pVarClient->variableInfo.var.val.blob;
+        /* start the search on the root server */
+        query->shard = 0;
+        query->shardInstanceID = query->instanceID;
 
-            if( pSrcBlob != NULL )
-            {
-                /* get the source object length */
-                srclen = pVarClient->variableInfo.var.len;
+        result = var_GetFirst( pVarClient, query, obj );
+        result = var_QueryShards( pVarClient, query, obj, result );
+    }
 
-                if( pVarObject->val.blob == NULL )
-                {
-                    /* allocate memory for the target blob */
-                    pVarObject->val.blob = calloc( 1, srclen );
-                    pVarObject->len = srclen;
-                }
+    return result;
+}
 
-                if( pVarObject->val.blob != NULL )
-                {
-                    if( pVarObject->len >= srclen )
-                    {
-                        /* get blob from the working buffer */
-                        memcpy( pVarObject->val.blob,
-                                &pVarClient->workbuf,
-                                srclen );
-                        result = EOK;
-                    }
-                    else
-                    {
-                        /* not enough space to store the blob */
-                        result = E2BIG;
-                    }
-                }
-                else
-                {
-                    /* no memory available for the blob result */
-                    result = ENOMEM;
-                }
-            }
-            else
-            {
-                /* should not see this.  The source object says it is a blob
-                    but it does not have a blob pointer */
-                result = ENOTSUP;
-            }
-        }
-        else
-        {
-            /* not a blob type */
-            result = ENOTSUP;
-        }
+/*============================================================================*/
+/*  VAR_GetNext                                                               */
+/*
+    Continue a variable query
+
+    The VAR_GetNext function continues a variable search and tries to get
+    the next result in the set of variable which match the initial variable
+    query defined when calling VAR_GetFirst
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        query
+            pointer to the query to be made.  This must be the same
+            object that was passed to VAR_GetFirst as it refers to the
+            query context established when the search was initiated.
+
+    @param[in]
+        obj
+            pointer to the found variable information
+
+    @retval EOK - a match was found
+    @retval EINVAL - invalid arguments
+    @retval ENOENT - no matching variable was found. Search is terminated.
+
+==============================================================================*/
+int VAR_GetNext( VARSERVER_HANDLE hVarServer,
+                 VarQuery *query,
+                 VarObject *obj )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+
+    if( ( pVarClient != NULL ) &&
+        ( query != NULL ) )
+    {
+        result = var_GetNext( var_Shard( pVarClient, query->shard ),
+                              query,
+                              obj );
+        result = var_QueryShards( pVarClient, query, obj, result );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  VAR_GetLength                                                             */
+/*  var_GetFirst                                                              */
 /*!
-    Get the length of the specified variable
+    Start a variable query on a server connection
 
-    The VAR_GetLength function queries the variable server for the
-    length of the specified variable.  Typically this is only useful
-    for strings and blobs because the lengths of the other data types could
-    easily be calculated directly.
+    The var_GetFirst function starts a variable query on the server
+    of the specified connection, as for VAR_GetFirst.
 
     @param[in]
-        hVarServer
-            handle to the variable server
+        pVarClient
+            pointer to the server connection
 
     @param[in]
-        hVar
-            handle to the variable to be retrieved
+        query
+            pointer to the query to be made
 
     @param[in]
-        len
-            specifies the location where the length should be stored
+        obj
+            pointer to the found variable information
 
-    @retval EOK - the length was retrieved ok
+    @retval EOK - a match was found
     @retval EINVAL - invalid arguments
+    @retval ENOENT - no matching variable was found
 
 ==============================================================================*/
-int VAR_GetLength( VARSERVER_HANDLE hVarServer,
-                   VAR_HANDLE hVar,
-                   size_t *len )
+static int var_GetFirst( VarClient *pVarClient,
+                         VarQuery *query,
+                         VarObject *obj )
 {
     int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    char *p;
+    size_t len;
 
     if( ( pVarClient != NULL ) &&
-        ( len != NULL ) )
+        ( query != NULL ) )
     {
-        pVarClient->requestType = VARREQUEST_LENGTH;
-        pVarClient->variableInfo.hVar = hVar;
+        pVarClient->requestType = VARREQUEST_GET_FIRST;
+        pVarClient->requestVal = query->type;
+        pVarClient->variableInfo.instanceID = query->instanceID;
+        pVarClient->variableInfo.flags = query->flags;
+        memcpy( &pVarClient->variableInfo.tagspec,
+                &query->tagspec,
+                MAX_TAGSPEC_LEN );
+
+        if ( query->match != NULL )
+        {
+            len = strlen(query->match);
+            if( ( len > 0 ) && ( len < pVarClient->workbufsize ) )
+            {
+                /* copy the sxearch string into the working buffer */
+                p = &pVarClient->workbuf;
+                memcpy( p, query->match, len );
+
+                /* NUL terminate the string */
+                p[len] = 0;
+            }
+        }
 
+        /* send the request to the server */
         result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
         if( result == EOK )
         {
-            *len = pVarClient->variableInfo.var.len;
+            query->context = pVarClient->responseVal;
+            if( query->context > 0 )
+            {
+                /* get the name of the variable we found */
+                memcpy( query->name,
+                        pVarClient->variableInfo.name,
+                        MAX_NAME_LEN+1 );
+
+                /* get the instanceID */
+                query->instanceID = pVarClient->variableInfo.instanceID;
+
+                /* get the variable data type */
+                query->vartype = pVarClient->variableInfo.var.type;
+
+                /* get the handle of the variable we found */
+                query->hVar = pVarClient->variableInfo.hVar;
+
+                /* copy the variable object */
+                if ( obj != NULL )
+                {
+                    var_GetVarObject( pVarClient, obj );
+                }
+            }
+            else
+            {
+                /* nothing found which matches the query */
+                result = ENOENT;
+            }
         }
     }
 
@@ -2203,46 +7049,74 @@ int VAR_GetLength( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  VAR_GetFlags                                                              */
+/*  var_GetNext                                                               */
 /*!
-    Get the flags of the specified variable
+    Continue a variable query on a server connection
 
-    The VAR_GetFlags function queries the variable server for the
-    flags of the specified variable.
+    The var_GetNext function continues a variable query on the server
+    of the specified connection, as for VAR_GetNext.
 
     @param[in]
-        hVarServer
-            handle to the variable server
+        pVarClient
+            pointer to the server connection
 
     @param[in]
-        hVar
-            handle to the variable to be retrieved
+        query
+            pointer to the query context
 
     @param[in]
-        flags
-            specifies the location where the flags should be stored
+        obj
+            pointer to the found variable information
 
-    @retval EOK - the flags were retrieved ok
+    @retval EOK - a match was found
     @retval EINVAL - invalid arguments
+    @retval ENOENT - no matching variable was found
 
 ==============================================================================*/
-int VAR_GetFlags( VARSERVER_HANDLE hVarServer,
-                  VAR_HANDLE hVar,
-                  uint32_t *flags )
+static int var_GetNext( VarClient *pVarClient,
+                        VarQuery *query,
+                        VarObject *obj )
 {
     int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
 
     if( ( pVarClient != NULL ) &&
-        ( flags != NULL ) )
+        ( query != NULL ) )
     {
-        pVarClient->requestType = VARREQUEST_FLAGS;
-        pVarClient->variableInfo.hVar = hVar;
+        pVarClient->requestType = VARREQUEST_GET_NEXT;
+        pVarClient->requestVal = query->context;
 
+        /* send the request to the server */
         result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
         if( result == EOK )
         {
-            *flags = pVarClient->variableInfo.flags;
+            query->context = pVarClient->responseVal;
+            if( query->context > 0 )
+            {
+                /* get the name of the variable we found */
+                memcpy( query->name,
+                        pVarClient->variableInfo.name,
+                        MAX_NAME_LEN+1 );
+
+                /* get the instance ID */
+                query->instanceID = pVarClient->variableInfo.instanceID;
+
+                /* get the variable data type */
+                query->vartype = pVarClient->variableInfo.var.type;
+
+                /* get the handle of the variable we found */
+                query->hVar = pVarClient->variableInfo.hVar;
+
+                /* copy the variable object */
+                if ( obj != NULL )
+                {
+                    var_GetVarObject( pVarClient, obj );
+                }
+            }
+            else
+            {
+                /* nothing found which matches the query */
+                result = ENOENT;
+            }
         }
     }
 
@@ -2250,97 +7124,222 @@ int VAR_GetFlags( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  VAR_GetInfo                                                               */
+/*  var_QueryShards                                                           */
 /*!
-    Get the info of the specified variable
+    Continue a variable query on the shard servers
 
-    The VAR_GetInfo function queries the variable server for the
-    information of the specified variable.
+    The var_QueryShards function starts the query again on each of the
+    following shard servers in turn once the current server has no more
+    matches, and converts the handle of a found variable into a client
+    handle.
 
     @param[in]
-        hVarServer
-            handle to the variable server
+        pVarClient
+            pointer to the root connection
+
+    @param[in,out]
+        query
+            pointer to the query context
 
     @param[in]
-        hVar
-            handle to the variable to be retrieved
+        obj
+            pointer to the found variable information
 
     @param[in]
-        pVarInfo
-            pointer to a VarInfo object to store the variable info
+        result
+            result of the query on the current server
 
-    @retval EOK - the flags were retrieved ok
+    @retval EOK - a match was found
     @retval EINVAL - invalid arguments
+    @retval ENOENT - no matching variable was found on any server
 
 ==============================================================================*/
-int VAR_GetInfo( VARSERVER_HANDLE hVarServer,
-                 VAR_HANDLE hVar,
-                 VarInfo *pVarInfo )
+static int var_QueryShards( VarClient *pVarClient,
+                            VarQuery *query,
+                            VarObject *obj,
+                            int result )
 {
-    int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    int shard;
 
-    if( ( pVarClient != NULL ) &&
-        ( pVarInfo != NULL ) )
+    while( ( result == ENOENT ) &&
+           ( ( shard = var_NextShard( pVarClient, query->shard ) ) != 0 ) )
     {
-        pVarClient->requestType = VARREQUEST_INFO;
-        pVarClient->variableInfo.hVar = hVar;
+        /* start the same query on the next shard */
+        query->shard = shard;
+        query->instanceID = query->shardInstanceID;
+        result = var_GetFirst( var_Shard( pVarClient, shard ), query, obj );
+    }
 
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-        if( result == EOK )
-        {
-            memcpy( pVarInfo, &pVarClient->variableInfo, sizeof( VarInfo ));
-        }
+    if( result == EOK )
+    {
+        query->hVar = var_ShardHandle( var_Shard( pVarClient, query->shard ),
+                                       query->hVar );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  VAR_GetType                                                               */
+/*  VAR_GetPage                                                               */
 /*!
-    Get the variable data type
+    Get a page of variable query results
 
-    The VAR_GetType function gets the type of the variable
-    specified by hVar and puts it into the specified VarType object
+    The VAR_GetPage function gets as many variables matching a query
+    as will fit in the client working buffer (or the specified page
+    buffer if it is smaller) in a single request to the server.  The page
+    is copied into the caller's page buffer so it remains valid while
+    other variable server requests are made.
+
+    A new query is started if the query context is 0.  On return, the
+    query context is non-zero if there are more results to retrieve with
+    subsequent calls to VAR_GetPage, or 0 if the query is complete.
+    The root server is searched first, followed by each of the shard
+    servers in turn, so a page may be empty while the query continues.
 
     @param[in]
         hVarServer
             handle to the variable server
 
-    @param[in]
-        hVar
-            handle to the variable to be retrieved
+    @param[in,out]
+        query
+            pointer to the query to be made
 
     @param[out]
-        pVarType
-            pointer to the VarType object to populate
+        pPage
+            pointer to the buffer to receive the page of results
 
-    @retval EOK - the variable type was retrieved ok
+    @param[in]
+        len
+            size of the page buffer
+
+    @retval EOK - a page of results was retrieved (it may be empty)
     @retval EINVAL - invalid arguments
+    @retval ENOENT - no variables match the query
 
 ==============================================================================*/
-int VAR_GetType( VARSERVER_HANDLE hVarServer,
-                 VAR_HANDLE hVar,
-                 VarType *pVarType )
+int VAR_GetPage( VARSERVER_HANDLE hVarServer,
+                 VarQuery *query,
+                 VarQueryPage *pPage,
+                 size_t len )
 {
     int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    VarQueryPage *pWorkPage;
+    VarQueryRecord *pRecord = NULL;
+    char *p;
+    size_t n;
+    bool newQuery;
+    bool firstPage = false;
+    int shard;
+
+    VarClient *pRoot = ValidateHandle( hVarServer );
+    VarClient *pVarClient = NULL;
+
+    if( ( pRoot != NULL ) &&
+        ( query != NULL ) )
+    {
+        firstPage = ( query->context == 0 ) ? true : false;
+        if( firstPage == true )
+        {
+            /* start the search on the root server */
+            query->shard = 0;
+            query->shardInstanceID = query->instanceID;
+        }
+
+        pVarClient = var_Shard( pRoot, query->shard );
+    }
 
     if( ( pVarClient != NULL ) &&
-        ( pVarType != NULL ) )
+        ( pPage != NULL ) &&
+        ( len >= sizeof( VarQueryPage ) ) &&
+        ( pVarClient->workbufsize >= sizeof( VarQueryPage ) + 1 ) )
     {
-        pVarClient->requestType = VARREQUEST_TYPE;
-        pVarClient->variableInfo.hVar = hVar;
+        pWorkPage = (VarQueryPage *)&pVarClient->workbuf;
+        newQuery = ( ( query->context == 0 ) ||
+                     ( query->context == VARSERVER_SHARD_NEXT_QUERY ) )
+                    ? true
+                    : false;
 
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-        if( result == EOK )
+        pVarClient->requestType = VARREQUEST_GET_PAGE;
+        pVarClient->requestVal = ( newQuery == true ) ? 0 : query->context;
+
+        memset( pWorkPage, 0, sizeof( VarQueryPage ) );
+        pWorkPage->size = ( len < pVarClient->workbufsize )
+                            ? len
+                            : pVarClient->workbufsize;
+
+        if( newQuery == true )
         {
-            *pVarType = pVarClient->variableInfo.var.type;
+            pWorkPage->type = query->type;
+            pVarClient->variableInfo.instanceID = query->shardInstanceID;
+            pVarClient->variableInfo.flags = query->flags;
+            memcpy( &pVarClient->variableInfo.tagspec,
+                    &query->tagspec,
+                    MAX_TAGSPEC_LEN );
+
+            /* the search string follows the page header */
+            p = &pVarClient->workbuf + sizeof( VarQueryPage );
+            p[0] = 0;
+            if ( query->match != NULL )
+            {
+                n = strlen( query->match );
+                if( n < pVarClient->workbufsize - sizeof( VarQueryPage ) )
+                {
+                    memcpy( p, query->match, n + 1 );
+                }
+            }
         }
-        else
+
+        /* send the request to the server */
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( result == EOK )
         {
-            *pVarType = VARTYPE_INVALID;
+            query->context = pVarClient->responseVal;
+
+            n = pWorkPage->size;
+            if( ( n < sizeof( VarQueryPage ) ) || ( n > len ) )
+            {
+                /* ignore a malformed page */
+                n = sizeof( VarQueryPage );
+                pWorkPage->count = 0;
+            }
+
+            memcpy( pPage, pWorkPage, n );
+            pPage->size = n;
+
+            /* point the string values at their copies in the page */
+            while( ( pRecord = VAR_GetPageRecord( pPage, pRecord ) ) != NULL )
+            {
+                pRecord->hVar = var_ShardHandle( pVarClient, pRecord->hVar );
+
+                if( ( pRecord->var.type == VARTYPE_STR ) &&
+                    ( pRecord->valueOffset != 0 ) )
+                {
+                    pRecord->var.val.str = (char *)pRecord +
+                                           pRecord->valueOffset;
+                }
+                else if( ( pRecord->var.type == VARTYPE_STR ) ||
+                         ( pRecord->var.type == VARTYPE_BLOB ) )
+                {
+                    pRecord->var.val.str = NULL;
+                }
+            }
+
+            shard = ( query->context == 0 )
+                        ? var_NextShard( pRoot, query->shard )
+                        : 0;
+            if( shard != 0 )
+            {
+                /* continue the search on the next shard */
+                query->shard = shard;
+                query->context = VARSERVER_SHARD_NEXT_QUERY;
+            }
+            else if( ( firstPage == true ) &&
+                     ( pPage->count == 0 ) &&
+                     ( query->context == 0 ) )
+            {
+                /* nothing found which matches the query */
+                result = ENOENT;
+            }
         }
     }
 
@@ -2348,129 +7347,116 @@ int VAR_GetType( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  VAR_GetName                                                               */
+/*  VAR_GetPageRecord                                                         */
 /*!
-    Get the variable name given its handle
-
-    The VAR_GetName function gets the name of the variable
-    specified by hVar and puts it into the specified buffer
+    Iterate through the records in a page of query results
 
-    @param[in]
-        hVarServer
-            handle to the variable server
+    The VAR_GetPageRecord function gets the first record of a page
+    of query results, or the record following the specified record.
 
     @param[in]
-        hVar
-            handle to the variable to be retrieved
-
-    @param[in,out]
-        buf
-            pointer to the buffer to store the variable name
+        pPage
+            pointer to the page of query results from VAR_GetPage
 
     @param[in]
-        buflen
-            the length of the buffer to store the variable name
+        pRecord
+            pointer to the current record, or NULL to get the first record
 
-    @retval EOK - the variable name was retrieved ok
-    @retval E2BIG - the variable name is too big for the specified buffer
-    @retval EINVAL - invalid arguments
+    @retval pointer to the next record in the page
+    @retval NULL there are no more records in the page
 
 ==============================================================================*/
-int VAR_GetName( VARSERVER_HANDLE hVarServer,
-                 VAR_HANDLE hVar,
-                 char *buf,
-                 size_t buflen )
+VarQueryRecord *VAR_GetPageRecord( VarQueryPage *pPage,
+                                   VarQueryRecord *pRecord )
 {
-    int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    size_t offset;
+    VarQueryRecord *pNext = NULL;
 
-    if( ( pVarClient != NULL ) &&
-        ( buf != NULL ) &&
-        ( buflen > 0 ) &&
-        ( hVar != VAR_INVALID ) )
+    if( pPage != NULL )
     {
-        pVarClient->requestType = VARREQUEST_NAME;
-        pVarClient->variableInfo.hVar = hVar;
+        offset = ( pRecord == NULL )
+                    ? sizeof( VarQueryPage )
+                    : (size_t)( (char *)pRecord - (char *)pPage ) +
+                      pRecord->size;
 
-        /* make a request to the server to get the variable name */
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-        if( result == EOK )
+        if( ( pRecord != NULL ) && ( pRecord->size == 0 ) )
         {
-            /* check if the specified buffer is large enough for the name */
-            if ( buflen >= strlen( pVarClient->variableInfo.name ) )
-            {
-                /* copy the variable name into the supplied buffer */
-                strcpy( buf, pVarClient->variableInfo.name );
+            /* malformed record */
+            offset = pPage->size;
+        }
 
-                /* indicate success */
-                result = EOK;
-            }
-            else
+        if( offset + sizeof( VarQueryRecord ) <= pPage->size )
+        {
+            pNext = (VarQueryRecord *)( (char *)pPage + offset );
+            if( offset + pNext->size > pPage->size )
             {
-                /* the buffer is not big enough for the variable name */
-                result = E2BIG;
+                pNext = NULL;
             }
         }
     }
 
-    return result;
+    return pNext;
 }
 
 /*============================================================================*/
-/*  VAR_SetNameValue                                                          */
+/*  VAR_PrintRecord                                                           */
 /*!
-    Set a variable value
+    Print the value of a variable from a page of query results
 
-    The VAR_SetNameValue function sets the value of the specified variable.
-    The value of the variable is specified as a string and is converted
-    to the appropriate type by this function.
+    The VAR_PrintRecord function prints the value contained in a
+    query result record using the variable's format specifier.  If the
+    record does not contain the value (for example the variable is
+    calculated, or rendered by a PRINT handler), the value is requested
+    from the variable server using VAR_Print.
 
     @param[in]
         hVarServer
             handle to the variable server
 
     @param[in]
-        name
-            pointer to the name of the variable
+        pRecord
+            pointer to the query result record
 
     @param[in]
-        value
-            pointer to the value of the variable
+        fd
+            output file descriptor
 
-    @retval EOK - the variable was set ok
-    @retval E2BIG - the variable string is too big
-    @retval ERANGE - the variable is out of range for the specified type
+    @retval EOK - the variable was printed
     @retval EINVAL - invalid arguments
+    @retval other - error from var_PrintValue or VAR_Print
 
 ==============================================================================*/
-int VAR_SetNameValue( VARSERVER_HANDLE hVarServer,
-                      char *name,
-                      char *value )
+int VAR_PrintRecord( VARSERVER_HANDLE hVarServer,
+                     VarQueryRecord *pRecord,
+                     int fd )
 {
     int result = EINVAL;
-    VAR_HANDLE hVar;
-    VarType type;
+    VarInfo info;
+    char *str = "";
 
-    if( ( hVarServer != NULL ) &&
-        ( name != NULL ) &&
-        ( value != NULL ) )
+    if( pRecord != NULL )
     {
-        /* get a handle to the variable given its name */
-        hVar = VAR_FindByName( hVarServer, name );
-        if( hVar != VAR_INVALID )
+        if( pRecord->result == EOK )
         {
-            /* get the variable type so we can convert the
-               string to a VarObject */
-            result = VAR_GetType( hVarServer, hVar, &type );
-            if( result == EOK )
+            memset( &info, 0, sizeof( VarInfo ) );
+            info.hVar = pRecord->hVar;
+            info.flags = pRecord->flags;
+            info.var = pRecord->var;
+            strncpy( info.formatspec,
+                     (char *)pRecord + pRecord->formatOffset,
+                     MAX_FORMATSPEC_LEN - 1 );
+
+            if( ( pRecord->var.type == VARTYPE_STR ) &&
+                ( pRecord->var.val.str != NULL ) )
             {
-                /* set the variable value from the string */
-                result = VAR_SetStr( hVarServer, hVar, type, value );
+                str = pRecord->var.val.str;
             }
+
+            result = var_PrintValue( fd, &info, str );
         }
         else
         {
-            result = ENOENT;
+            result = VAR_Print( hVarServer, pRecord->hVar, fd );
         }
     }
 
@@ -2478,12 +7464,12 @@ int VAR_SetNameValue( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  VAR_SetStr                                                                */
+/*  VAR_Notify                                                                */
 /*!
-    Set a variable value
+    Register a notification for a specific variable
 
-    The VAR_Set function sets the value of the variable
-    specified by hVar to the value contained in the string
+    The VAR_Notify function requests a notification for an action
+    on the specified variable.
 
     @param[in]
         hVarServer
@@ -2491,50 +7477,44 @@ int VAR_SetNameValue( VARSERVER_HANDLE hVarServer,
 
     @param[in]
         hVar
-            handle to the variable to be set
+            handle to the variable to be notified on
 
     @param[in]
-        pVarObject
-            pointer to the variable value object to set
+        notification
+            the type of notification requested
 
-    @retval EOK - the variable was set ok
-    @retval E2BIG - the variable string is too big
-    @retval ERANGE - the variable is out of range for the specified type
+
+    @retval EOK - the notification request was registered successfully
+    @retval ENOSPC - too many NOTIFY_MODIFIED_RING subscriptions
     @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-int VAR_SetStr( VARSERVER_HANDLE hVarServer,
+int VAR_Notify( VARSERVER_HANDLE hVarServer,
                 VAR_HANDLE hVar,
-                VarType type,
-                char *str )
+                NotificationType notificationType )
 {
-    int result = EINVAL;
-    VarObject varObject = {0};
-
-    if( str != NULL )
-    {
-        /* populate the VarObject */
-        result = VAROBJECT_CreateFromString( str,
-                                             type,
-                                             &varObject,
-                                             VAROBJECT_OPTION_NONE );
-        if( result == EOK )
-        {
-            /* set the sysvar using the VarObject */
-            result = VAR_Set( hVarServer, hVar, &varObject );
-        }
-    }
-
-    return result;
+    return VAR_NotifyEx( hVarServer, hVar, notificationType, NULL );
 }
 
 /*============================================================================*/
-/*  VAR_Set                                                                   */
+/*  VAR_NotifyEx                                                              */
 /*!
-    Set a variable value in the specified var object
+    Register a notification with delivery options
 
-    The VAR_Set function sets the value of the variable
-    specified by hVar to the value specified by the var object
+    The VAR_NotifyEx function requests a notification for an action
+    on the specified variable, optionally specifying delivery options
+    which suppress redundant NOTIFY_MODIFIED signals.
+
+    NOTIFY_OPT_COALESCE sends at most one notification until the
+    variable is read again.  NOTIFY_OPT_RATE_LIMIT sends at most one
+    notification per minInterval_ms, with the last change in an interval
+    delivered at the end of that interval.  NOTIFY_OPT_DEADBAND
+    suppresses numeric changes smaller than deadband from the last
+    notified value.
+
+    NOTIFY_OPT_CACHE_TTL applies to NOTIFY_CALC handlers.  Each value
+    set by the handler is returned to readers for cacheTTL_ms before
+    the handler is asked to calculate it again.
 
     @param[in]
         hVarServer
@@ -2542,48 +7522,71 @@ int VAR_SetStr( VARSERVER_HANDLE hVarServer,
 
     @param[in]
         hVar
-            handle to the variable to be set
+            handle to the variable to be notified on
 
     @param[in]
-        pVarObject
-            pointer to the variable value object to set
+        notification
+            the type of notification requested
 
-    @retval EOK - the variable was set ok
+    @param[in]
+        pOptions
+            pointer to the notification options, or NULL for none
+
+    @retval EOK - the notification request was registered successfully
+    @retval ENOSPC - too many NOTIFY_MODIFIED_RING subscriptions
+    @retval ENOTSUP - options are not supported for this notification type,
+                      or a queue or ring notification was requested for
+                      a variable owned by a shard server
     @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-int VAR_Set( VARSERVER_HANDLE hVarServer,
-             VAR_HANDLE hVar,
-             VarObject *pVarObject )
+int VAR_NotifyEx( VARSERVER_HANDLE hVarServer,
+                  VAR_HANDLE hVar,
+                  NotificationType notificationType,
+                  const VarNotifyOptions *pOptions )
 {
     int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
 
     if( ( pVarClient != NULL ) &&
-        ( pVarObject != NULL ) )
+        ( pVarClient->shard != 0 ) &&
+        ( ( notificationType == NOTIFY_MODIFIED_QUEUE ) ||
+          ( notificationType == NOTIFY_MODIFIED_RING ) ) )
     {
-        pVarClient->requestType = VARREQUEST_SET;
+        /* the notification queue and change ring are only
+           served by the root server */
+        result = ENOTSUP;
+    }
+    else if( pVarClient != NULL )
+    {
+        pVarClient->requestType = VARREQUEST_NOTIFY;
         pVarClient->variableInfo.hVar = hVar;
-        pVarClient->variableInfo.var.type = pVarObject->type;
-        pVarClient->variableInfo.var.val = pVarObject->val;
-        pVarClient->variableInfo.var.len = pVarObject->len;
+        pVarClient->variableInfo.notificationType = notificationType;
+        pVarClient->requestVal = 0;
 
-        /* strings have to be transferred via the working buffer */
-        if( pVarObject->type == VARTYPE_STR )
+        if( pOptions != NULL )
         {
-            var_CopyStringVarObjectToWorkbuf( pVarClient, pVarObject );
+            /* the notification options are passed in the working buffer */
+            memcpy( &pVarClient->workbuf, pOptions, sizeof( VarNotifyOptions ) );
+            pVarClient->requestVal = sizeof( VarNotifyOptions );
         }
 
-        if ( pVarObject->type == VARTYPE_BLOB )
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( ( result == EOK ) &&
+            ( ( pOptions != NULL ) ||
+              ( notificationType == NOTIFY_MODIFIED_RING ) ) )
         {
-            var_CopyBlobVarObjectToWorkbuf( pVarClient, pVarObject );
+            result = pVarClient->responseVal;
         }
 
-        /* send the request to the server */
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-        if( result == EOK )
+        if( ( result == EOK ) &&
+            ( notificationType == NOTIFY_MODIFIED_RING ) )
         {
-            result = pVarClient->responseVal;
+            /* change ring records are identified by storage reference */
+            result = var_AddRingSubscription(
+                                pVarClient,
+                                hVar,
+                                pVarClient->variableInfo.storageRef );
         }
     }
 
@@ -2591,13 +7594,12 @@ int VAR_Set( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  VAR_Alias                                                                 */
+/*  VAR_NotifyCancel                                                          */
 /*!
-    Create a variable alias
+    Cancel a notification for a specific variable
 
-    The VAR_Alias function creates a variable alias which is another name
-    for an already existing variable which references the same storage
-    object.
+    The VAR_NotifyCancel function cancels a notification for an action
+    on the specified variable.
 
     @param[in]
         hVarServer
@@ -2605,137 +7607,170 @@ int VAR_Set( VARSERVER_HANDLE hVarServer,
 
     @param[in]
         hVar
-            handle to the variable to be aliased
+            handle to the variable to be notified on
 
     @param[in]
-        alias
-            pointer to the alias name for the variable
+        notification
+            the type of notification to be cancelled
+
+
+    @retval EOK - the notification request was cancelled successfully
+    @retval ENOENT - the notification request was not found
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VAR_NotifyCancel( VARSERVER_HANDLE hVarServer,
+                      VAR_HANDLE hVar,
+                      NotificationType notificationType )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( pVarClient != NULL )
+    {
+        pVarClient->requestType = VARREQUEST_NOTIFY_CANCEL;
+        pVarClient->variableInfo.hVar = hVar;
+        pVarClient->variableInfo.notificationType = notificationType;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( ( result == EOK ) &&
+            ( notificationType == NOTIFY_MODIFIED_RING ) )
+        {
+            var_RemoveRingSubscription( pVarClient, hVar );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VAR_NotifyQuery                                                           */
+/*!
+    Register a notification for all variables matching a query
+
+    The VAR_NotifyQuery function registers a single NOTIFY_MODIFIED
+    subscription covering every variable which matches the specified
+    query (name match, prefix, regex, flags, tags and instance ID),
+    including variables created after the subscription was registered.
+    The SIG_VAR_MODIFIED signal carries the handle of the modified
+    variable.
+
+    On success the subscription identifier is stored in the query
+    context, and is used to cancel the subscription with
+    VAR_NotifyQueryCancel.
 
     @param[in]
-        hAlias
-            pointer to a location to store the handle to the alias
+        hVarServer
+            handle to the variable server
 
-    @retval EOK - the variable was set ok
+    @param[in,out]
+        query
+            pointer to the query to subscribe to
+
+    @retval EOK - the query subscription was registered successfully
+    @retval ENOMEM - the server could not allocate the subscription
+    @retval E2BIG - the match string does not fit in the working buffer
     @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-int VAR_Alias( VARSERVER_HANDLE hVarServer,
-               VAR_HANDLE hVar,
-               char *alias,
-               VAR_HANDLE *hAlias )
+int VAR_NotifyQuery( VARSERVER_HANDLE hVarServer, VarQuery *query )
 {
     int result = EINVAL;
     VarClient *pVarClient = ValidateHandle( hVarServer );
-    VarInfo *pVarInfo;
+    char *p;
+    size_t len = 0;
 
     if( ( pVarClient != NULL ) &&
-        ( alias != NULL ) )
+        ( query != NULL ) )
     {
-        pVarInfo = &pVarClient->variableInfo;
-        pVarClient->requestType = VARREQUEST_ALIAS;
-        pVarInfo->hVar = hVar;
+        pVarClient->requestType = VARREQUEST_NOTIFY_QUERY;
+        pVarClient->requestVal = query->type;
+        pVarClient->variableInfo.instanceID = query->instanceID;
+        pVarClient->variableInfo.flags = query->flags;
+        memcpy( &pVarClient->variableInfo.tagspec,
+                &query->tagspec,
+                MAX_TAGSPEC_LEN );
 
-        /* copy the alias to the variable info request */
-        var_parseName( pVarClient->variableInfo.name,
-                       MAX_NAME_LEN,
-                       alias,
-                       &pVarClient->variableInfo.instanceID );
+        if( query->match != NULL )
+        {
+            len = strlen( query->match );
+        }
 
-        /* send the request to the server */
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-        if( result == EOK )
+        if( len < pVarClient->workbufsize )
         {
-            pVarInfo->hVar = pVarClient->responseVal;
-            if ( pVarInfo->hVar != VAR_INVALID )
+            /* copy the match string into the working buffer */
+            p = &pVarClient->workbuf;
+            if( len > 0 )
             {
-                if ( hAlias != NULL )
-                {
-                    *hAlias = pVarInfo->hVar;
-                }
-                result = EOK;
+                memcpy( p, query->match, len );
             }
-            else
+
+            p[len] = 0;
+
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if( result == EOK )
             {
-                result = EINVAL;
-                pVarInfo->hVar = VAR_INVALID;
+                if( pVarClient->responseVal > 0 )
+                {
+                    query->context = pVarClient->responseVal;
+                }
+                else
+                {
+                    result = ( pVarClient->responseVal < 0 )
+                                ? -pVarClient->responseVal
+                                : EINVAL;
+                }
             }
         }
+        else
+        {
+            result = E2BIG;
+        }
     }
 
     return result;
 }
 
-
 /*============================================================================*/
-/*  VAR_GetAliases                                                            */
+/*  VAR_NotifyQueryCancel                                                     */
 /*!
-    Get Aliases of the specified variable
+    Cancel a query subscription
 
-    The VAR_GetAliases function gets the aliases of the specified variable.
+    The VAR_NotifyQueryCancel function cancels a query subscription
+    registered with VAR_NotifyQuery, and clears the query context.
 
     @param[in]
         hVarServer
-            handle to the variable server
-
-    @param[in]
-        hVar
-            handle to the variable to get the aliases for
-
-    @param[in]
-        aliases
-            pointer to a buffer to store the aliases
-
-    @param[in]
-        len
-            length of the buffer to store the aliases
+            handle to the variable server
 
     @param[in,out]
-        n
-            pointer to a location to store the number of retrieved aliases
+        query
+            pointer to the query whose subscription is to be cancelled
 
-    @retval EOK - the aliases were retrieved ok
+    @retval EOK - the query subscription was cancelled successfully
+    @retval ENOENT - the query subscription was not found
     @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-int VAR_GetAliases( VARSERVER_HANDLE hVarServer,
-                    VAR_HANDLE hVar,
-                    VAR_HANDLE *aliases,
-                    size_t len,
-                    size_t *n )
+int VAR_NotifyQueryCancel( VARSERVER_HANDLE hVarServer, VarQuery *query )
 {
     int result = EINVAL;
     VarClient *pVarClient = ValidateHandle( hVarServer );
-    VarInfo *pVarInfo;
-    VAR_HANDLE *pVarHandle;
-    size_t count = 0;
 
     if( ( pVarClient != NULL ) &&
-        ( aliases != NULL ) &&
-        ( n != NULL ) &&
-        ( len > 0 ) )
+        ( query != NULL ) &&
+        ( query->context > 0 ) )
     {
-        pVarInfo = &pVarClient->variableInfo;
-        pVarClient->requestType = VARREQUEST_GET_ALIASES;
-        pVarInfo->hVar = hVar;
+        pVarClient->requestType = VARREQUEST_NOTIFY_QUERY_CANCEL;
+        pVarClient->requestVal = query->context;
 
-        /* send the request to the server */
         result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
         if( result == EOK )
         {
             result = pVarClient->responseVal;
-            if ( result == EOK )
+            if( result == EOK )
             {
-                /* the aliases are returned in the working buffer */
-                pVarHandle = (VAR_HANDLE *)&(pVarClient->workbuf);
-                while ( ( *pVarHandle != VAR_INVALID ) && ( count < len ) )
-                {
-                    /* copy the alias handle */
-                    aliases[count] = pVarHandle[count];
-                    count++;
-                }
-
-                /* return the number of aliases */
-                *n = count;
+                query->context = 0;
             }
         }
     }
@@ -2744,56 +7779,82 @@ int VAR_GetAliases( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  var_CopyStringVarObjectToWorkbuf                                          */
+/*  VAR_Snapshot                                                              */
 /*!
-    Copy a string object to the working buffer
+    Write a snapshot of the variable store to a file
 
-    The var_CopyStringVarObjectToWorkbuf function copies the string
-    object into the client's working buffer for transfer to the server.
+    The VAR_Snapshot function requests the variable server to write the
+    definitions and values of its variables to a binary snapshot file.
+    The snapshot can be restored when the server is started using the
+    varserver -r option.  Only root (or the user running the variable
+    server) may request a snapshot.
 
     @param[in]
-        pVarClient
-            pointer to the VarClient object containing the working buffer
+        hVarServer
+            handle to the variable server
 
     @param[in]
-        pVarObject
-            pointer to the VarObject containing the string to copy
+        path
+            path of the snapshot file to be written by the server
 
-    @retval EOK - the string was copied successfully
+    @param[in]
+        options
+            snapshot options.  VAR_SNAPSHOT_DIRTY only saves the
+            non-volatile variables which have the dirty flag set.
+
+    @param[out]
+        pCount
+            optional pointer to a location to store the number of
+            variables written to the snapshot
+
+    @retval EOK - the snapshot was written
+    @retval EACCES - the client is not permitted to write a snapshot
+    @retval E2BIG - the path does not fit in the working buffer
     @retval EINVAL - invalid arguments
-    @retval ENOTSUP - not a string object
+    @retval other - error writing the snapshot file
 
 ==============================================================================*/
-static int var_CopyStringVarObjectToWorkbuf( VarClient *pVarClient,
-                                             VarObject *pVarObject )
+int VAR_Snapshot( VARSERVER_HANDLE hVarServer,
+                  const char *path,
+                  uint32_t options,
+                  size_t *pCount )
 {
     int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
     size_t len;
-    char *p;
 
-    if ( ( pVarClient != NULL ) &&
-         ( pVarObject != NULL ) )
+    if( ( pVarClient != NULL ) &&
+        ( path != NULL ) )
     {
-        if ( pVarObject->type == VARTYPE_STR )
+        len = strlen( path );
+        if( ( len > 0 ) &&
+            ( len < pVarClient->workbufsize ) )
         {
-            /* get the string length */
-            len = pVarObject->len;
-            if( ( len > 0 ) &&
-                ( len < pVarClient->workbufsize ) )
-            {
-                /* copy the string into the working buffer */
-                p = &pVarClient->workbuf;
-                memcpy( p, pVarObject->val.str, len );
+            /* copy the path into the working buffer */
+            memcpy( &pVarClient->workbuf, path, len + 1 );
 
-                /* NUL terminate the string */
-                p[len] = 0;
+            pVarClient->requestType = VARREQUEST_SNAPSHOT;
+            pVarClient->requestVal = options;
 
-                result = EOK;
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if( result == EOK )
+            {
+                if( pVarClient->responseVal >= 0 )
+                {
+                    if( pCount != NULL )
+                    {
+                        *pCount = pVarClient->responseVal;
+                    }
+                }
+                else
+                {
+                    result = -pVarClient->responseVal;
+                }
             }
         }
-        else
+        else if( len > 0 )
         {
-            result = ENOTSUP;
+            result = E2BIG;
         }
     }
 
@@ -2801,158 +7862,157 @@ static int var_CopyStringVarObjectToWorkbuf( VarClient *pVarClient,
 }
 
 /*============================================================================*/
-/*  var_CopyBlobVarObjectToWorkbuf                                            */
+/*  VAR_Print                                                                 */
 /*!
-    Copy a blob object to the working buffer
+    Print a variable value to the specified output stream
 
-    The var_CopyBlobVarObjectToWorkbuf function copies the blob
-    object into the client's working buffer for transfer to the server.
+    The VAR_Print function prints out the value of the variable
+    specified by hVar to the output stream specified by fp.
 
     @param[in]
-        pVarClient
-            pointer to the VarClient object containing the working buffer
+        hVarServer
+            handle to the variable server
 
     @param[in]
-        pVarObject
-            pointer to the VarObject containing the blob to copy
+        hVar
+            handle to the variable to be printed
 
-    @retval EOK - the blob was copied successfully
+    @param[in]
+        fd
+            specifies the output file descriptor to print to
+
+    @retval EOK - the variable was printed ok
+    @retval ENOTSUP - the variable data type is not supported for printing
     @retval EINVAL - invalid arguments
-    @retval ENOTSUP - not a string object
 
 ==============================================================================*/
-static int var_CopyBlobVarObjectToWorkbuf( VarClient *pVarClient,
-                                           VarObject *pVarObject )
+int VAR_Print( VARSERVER_HANDLE hVarServer,
+               VAR_HANDLE hVar,
+               int fd )
 {
     int result = EINVAL;
-    size_t len;
-    char *p;
+    pid_t responderPID;
 
-    if ( ( pVarClient != NULL ) &&
-         ( pVarObject != NULL ) )
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &hVar );
+
+    if( pVarClient != NULL )
     {
-        if ( pVarObject->type == VARTYPE_BLOB )
+        pVarClient->requestType = VARREQUEST_PRINT;
+        pVarClient->variableInfo.hVar = hVar;
+
+        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        if( ( result == EOK ) &&
+            ( pVarClient->responseVal == E2BIG ) &&
+            ( var_GrowWorkbuf( pVarClient,
+                               pVarClient->variableInfo.var.len + 1 ) == EOK ) )
         {
-            /* get the blob length */
-            len = pVarObject->len;
-            if( ( len > 0 ) &&
-                ( len < pVarClient->workbufsize ) )
-            {
-                /* copy the blob into the working buffer */
-                p = &pVarClient->workbuf;
-                memcpy( p, pVarObject->val.blob, len );
+            /* retry with a working buffer large enough for the value */
+            pVarClient->requestType = VARREQUEST_PRINT;
+            pVarClient->variableInfo.hVar = hVar;
 
-                result = EOK;
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        }
+
+        if( pVarClient->responseVal == E2BIG )
+        {
+            result = E2BIG;
+        }
+        else if( pVarClient->responseVal == ESTRPIPE)
+        {
+            /* get the PID of the client doing the printing */
+            responderPID = (pid_t)(pVarClient->peer_pid);
+
+            /* send the file descriptor to the responder over the
+               print channel, tagged with the print session identifier */
+            result = VARPRINT_SendToChannel( responderPID,
+                                             (uint32_t)pVarClient->requestVal,
+                                             fd );
+            if( result == EOK )
+            {
+                /* block client until printing is complete */
+                pVarClient->blocked = 1;
+                do
+                {
+                    result = sem_wait( &pVarClient->sem );
+                    if ( result == -1 )
+                    {
+                        result = errno;
+                    }
+                } while ( result != EOK );
+                pVarClient->blocked = 0;
             }
         }
         else
         {
-            result = ENOTSUP;
+            result = var_PrintValue( fd,
+                                     &pVarClient->variableInfo,
+                                     &pVarClient->workbuf );
         }
     }
 
     return result;
 }
 
-
 /*============================================================================*/
-/*  VAR_GetFirst                                                              */
-/*
-    Start a variable query
-
-    The VAR_GetFirst function initiates a variable query with the variable
-    server.
-
-    Variable queries can be made using a combination of the following:
+/*  VAR_OpenPrintSession                                                      */
+/*!
+    Open a new print session
 
-    - variable name
-    - variable instance ID
-    - variable flags
-    - variable tags
+    The VAR_OpenPrintSession creates a new print session,
+    creating a link to the requesting client's output stream
+    and returning a handle to the variable that should be output.
 
     @param[in]
         hVarServer
             handle to the variable server
 
     @param[in]
-        query
-            pointer to the query to be made
+        id
+            transaction identifier for the print session
 
     @param[in]
-        obj
-            pointer to the found variable information
+        hVar
+            pointer to the location to store the handle of the variable
+            to be output
 
-    @retval EOK - a match was found
+    @param[in]
+        fd
+            pointer to the location to store the fd for the output stream
+
+    @retval EOK - the print session was successfully created
     @retval EINVAL - invalid arguments
-    @retval ENOENT - no matching variable was found
 
 ==============================================================================*/
-int VAR_GetFirst( VARSERVER_HANDLE hVarServer,
-                  VarQuery *query,
-                  VarObject *obj )
+int VAR_OpenPrintSession( VARSERVER_HANDLE hVarServer,
+                         uint32_t id,
+                         VAR_HANDLE *hVar,
+                         int *fd )
 {
     int result = EINVAL;
-    char *p;
-    size_t len;
-
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &id );
 
     if( ( pVarClient != NULL ) &&
-        ( query != NULL ) )
+        ( hVar != NULL ) &&
+        ( fd != NULL ) )
     {
-        pVarClient->requestType = VARREQUEST_GET_FIRST;
-        pVarClient->requestVal = query->type;
-        pVarClient->variableInfo.instanceID = query->instanceID;
-        pVarClient->variableInfo.flags = query->flags;
-        memcpy( &pVarClient->variableInfo.tagspec,
-                &query->tagspec,
-                MAX_TAGSPEC_LEN );
-
-        if ( query->match != NULL )
-        {
-            len = strlen(query->match);
-            if( ( len > 0 ) && ( len < pVarClient->workbufsize ) )
-            {
-                /* copy the sxearch string into the working buffer */
-                p = &pVarClient->workbuf;
-                memcpy( p, query->match, len );
-
-                /* NUL terminate the string */
-                p[len] = 0;
-            }
-        }
-
-        /* send the request to the server */
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+        /* make sure the requestor can connect a print channel */
+        result = VARPRINT_OpenChannelListener( pVarClient->varserver_gid );
         if( result == EOK )
         {
-            query->context = pVarClient->responseVal;
-            if( query->context > 0 )
-            {
-                /* get the name of the variable we found */
-                memcpy( query->name,
-                        pVarClient->variableInfo.name,
-                        MAX_NAME_LEN+1 );
-
-                /* get the instanceID */
-                query->instanceID = pVarClient->variableInfo.instanceID;
-
-                /* get the variable data type */
-                query->vartype = pVarClient->variableInfo.var.type;
-
-                /* get the handle of the variable we found */
-                query->hVar = pVarClient->variableInfo.hVar;
+            pVarClient->requestType = VARREQUEST_OPEN_PRINT_SESSION;
+            pVarClient->requestVal = id;
 
-                /* copy the variable object */
-                if ( obj != NULL )
-                {
-                    var_GetVarObject( pVarClient, obj );
-                }
-            }
-            else
+            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+            if( result == EOK )
             {
-                /* nothing found which matches the query */
-                result = ENOENT;
+                /* get a handle to the variable we are printing */
+                *hVar = var_ShardHandle( pVarClient,
+                                         pVarClient->variableInfo.hVar );
+
+                /* get the file descriptor we are printing to */
+                result = VARPRINT_ReceiveFromChannel( pVarClient->peer_pid,
+                                                      id,
+                                                      fd );
             }
         }
     }
@@ -2961,79 +8021,45 @@ int VAR_GetFirst( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  VAR_GetNext                                                               */
-/*
-    Continue a variable query
+/*  VAR_ClosePrintSession                                                     */
+/*!
+    Conclude a print session
 
-    The VAR_GetNext function continues a variable search and tries to get
-    the next result in the set of variable which match the initial variable
-    query defined when calling VAR_GetFirst
+    The VAR_ClosePrintSession terminates an active print session
+    and unblocks the requesting client.
 
     @param[in]
         hVarServer
             handle to the variable server
 
     @param[in]
-        query
-            pointer to the query to be made.  This must be the same
-            object that was passed to VAR_GetFirst as it refers to the
-            query context established when the search was initiated.
+        id
+            transaction identifier for the print session
 
     @param[in]
-        obj
-            pointer to the found variable information
+        fd
+            file descriptor for the print session output stream
 
-    @retval EOK - a match was found
+    @retval EOK - the print session was successfully completed
     @retval EINVAL - invalid arguments
-    @retval ENOENT - no matching variable was found. Search is terminated.
 
 ==============================================================================*/
-int VAR_GetNext( VARSERVER_HANDLE hVarServer,
-                 VarQuery *query,
-                 VarObject *obj )
+int VAR_ClosePrintSession( VARSERVER_HANDLE hVarServer,
+                           uint32_t id,
+                           int fd )
 {
     int result = EINVAL;
+    VarClient *pVarClient = var_Route( ValidateHandle( hVarServer ), &id );
 
-    VarClient *pVarClient = ValidateHandle( hVarServer );
-
-    if( ( pVarClient != NULL ) &&
-        ( query != NULL ) )
+    if( pVarClient != NULL )
     {
-        pVarClient->requestType = VARREQUEST_GET_NEXT;
-        pVarClient->requestVal = query->context;
+        pVarClient->requestType = VARREQUEST_CLOSE_PRINT_SESSION;
+        pVarClient->requestVal = id;
 
-        /* send the request to the server */
         result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
         if( result == EOK )
         {
-            query->context = pVarClient->responseVal;
-            if( query->context > 0 )
-            {
-                /* get the name of the variable we found */
-                memcpy( query->name,
-                        pVarClient->variableInfo.name,
-                        MAX_NAME_LEN+1 );
-
-                /* get the instance ID */
-                query->instanceID = pVarClient->variableInfo.instanceID;
-
-                /* get the variable data type */
-                query->vartype = pVarClient->variableInfo.var.type;
-
-                /* get the handle of the variable we found */
-                query->hVar = pVarClient->variableInfo.hVar;
-
-                /* copy the variable object */
-                if ( obj != NULL )
-                {
-                    var_GetVarObject( pVarClient, obj );
-                }
-            }
-            else
-            {
-                /* nothing found which matches the query */
-                result = ENOENT;
-            }
+            close( fd );
         }
     }
 
@@ -3041,232 +8067,404 @@ int VAR_GetNext( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  VAR_Notify                                                                */
+/*  var_PrintValue                                                            */
 /*!
-    Register a notification for a specific variable
+    Print a variable value to the specified output stream
 
-    The VAR_Notify function requests a notification for an action
-    on the specified variable.
+    The var_PrintValue function prints out the value specified in
+    the VarInfo structure.  It uses the format specifier associated
+    with the variable (if it exists), or a generic %f, %ul, %d etc
+    if it does not.
 
     @param[in]
-        hVarServer
-            handle to the variable server
+        fd
+            file descriptor to print to
 
     @param[in]
-        hVar
-            handle to the variable to be notified on
+        pInfo
+            pointer to the VarInfo object that contains the variable
+            value to be printed
 
     @param[in]
-        notification
-            the type of notification requested
-
+        workbuf
+            pointer to the working buffer where string to be
+            printed is located.  Only applicable if the variable
+            type is VARTYPE_STR
 
-    @retval EOK - the notification request was registered successfully
+    @retval EOK - the variable was printed ok
+    @retval ENOTSUP - the variable data type is not supported for printing
     @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-int VAR_Notify( VARSERVER_HANDLE hVarServer,
-                VAR_HANDLE hVar,
-                NotificationType notificationType )
+static int var_PrintValue( int fd, VarInfo *pInfo, char *workbuf )
 {
+    char *fmt;
     int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
 
-    if( pVarClient != NULL )
+    if( ( fd >= 0 ) &&
+        ( pInfo != NULL ) &&
+        ( workbuf != NULL ) )
     {
-        pVarClient->requestType = VARREQUEST_NOTIFY;
-        pVarClient->variableInfo.hVar = hVar;
-        pVarClient->variableInfo.notificationType = notificationType;
+        if ( pInfo->flags & VARFLAG_PASSWORD )
+        {
+            dprintf(fd, "********" );
+            result = EOK;
+        }
+        else
+        {
+            switch( pInfo->var.type )
+            {
+                case VARTYPE_FLOAT:
+                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%f"
+                                                        : pInfo->formatspec;
+                    dprintf(fd, fmt, pInfo->var.val.f );
+                    result = EOK;
+                    break;
 
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+                case VARTYPE_BLOB:
+                    dprintf( fd,
+                            "%s len=%"PRIu32">",
+                            "<object:",
+                            (uint32_t)(pInfo->var.len));
+                    result = EOK;
+                    break;
+
+                case VARTYPE_STR:
+                    /* string variable values are transferred via the workbuf */
+                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%s"
+                                                        : pInfo->formatspec;
+                    dprintf(fd, fmt, workbuf );
+                    result = EOK;
+                    break;
+
+                case VARTYPE_UINT16:
+                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%u"
+                                                        : pInfo->formatspec;
+                    dprintf(fd, fmt, pInfo->var.val.ui );
+                    result = EOK;
+                    break;
+
+                case VARTYPE_INT16:
+                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%d"
+                                                        : pInfo->formatspec;
+                    dprintf(fd, fmt, pInfo->var.val.i );
+                    result = EOK;
+                    break;
+
+                case VARTYPE_UINT32:
+                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%lu"
+                                                        : pInfo->formatspec;
+                    dprintf(fd, fmt, pInfo->var.val.ul );
+                    result = EOK;
+                    break;
+
+                case VARTYPE_INT32:
+                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%d"
+                                                        : pInfo->formatspec;
+                    dprintf(fd, fmt, pInfo->var.val.l );
+                    result = EOK;
+                    break;
+
+                case VARTYPE_UINT64:
+                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%llu"
+                                                        : pInfo->formatspec;
+                    dprintf(fd, fmt, pInfo->var.val.ull );
+                    result = EOK;
+                    break;
+
+                case VARTYPE_INT64:
+                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%lld"
+                                                        : pInfo->formatspec;
+                    dprintf(fd, fmt, pInfo->var.val.ll );
+                    result = EOK;
+                    break;
+
+                default:
+                    result = ENOTSUP;
+                    break;
+            }
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  VAR_NotifyCancel                                                          */
+/*  InitServerInfo                                                            */
 /*!
-    Cancel a notification for a specific variable
-
-    The VAR_NotifyCancel function cancels a notification for an action
-    on the specified variable.
-
-    @param[in]
-        hVarServer
-            handle to the variable server
-
-    @param[in]
-        hVar
-            handle to the variable to be notified on
-
-    @param[in]
-        notification
-            the type of notification to be cancelled
+    Initialize the VarServer information
 
+    The InitServerInfo function opens a shared memory block owned by the
+    variable server in which public variable server status is stored.
+    The shared memory block is opened in a read-only mode to allow clients
+    to get information about the server including the server's process
+    identifier which is used to send signals from the client to the server.
 
-    @retval EOK - the notification request was cancelled successfully
-    @retval ENOENT - the notification request was not found
-    @retval EINVAL - invalid arguments
+    @retval EOK got a pointer to the server info
+    @retval ENOMEM cannot allocate server info
+    @retval ENOENT the server info could not be read
 
 ==============================================================================*/
-int VAR_NotifyCancel( VARSERVER_HANDLE hVarServer,
-                      VAR_HANDLE hVar,
-                      NotificationType notificationType )
+static int InitServerInfo( VarClient *pVarClient )
 {
+    int fd;
     int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    ServerInfo *pServerInfo = NULL;
+    char name[BUFSIZ];
 
     if( pVarClient != NULL )
     {
-        pVarClient->requestType = VARREQUEST_NOTIFY_CANCEL;
-        pVarClient->variableInfo.hVar = hVar;
-        pVarClient->variableInfo.notificationType = notificationType;
+        ShardName( name, sizeof( name ), SERVER_SHAREDMEM, pVarClient->shard );
+
+        /* get shared memory file descriptor (NOT a file) */
+        fd = shm_open( name, O_RDONLY, S_IRUSR | S_IWUSR);
+        if (fd != -1)
+        {
+            /* map shared memory to process address space */
+            pServerInfo = (ServerInfo *)mmap( NULL,
+                                            sizeof(ServerInfo),
+                                            PROT_READ,
+                                            MAP_SHARED,
+                                            fd,
+                                            0);
+            if (pServerInfo != MAP_FAILED)
+            {
+                pVarClient->pServerInfo = pServerInfo;
+                if( pVarClient->debug >= LOG_INFO )
+                {
+                    printf("CLIENT: Server PID: %d\n", pServerInfo->pid);
+                }
+
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
 
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
+                if( pVarClient->debug >= LOG_ERR )
+                {
+                    perror("mmap");
+                }
+            }
+        }
+        else
+        {
+            result = ENOENT;
+            if( pVarClient->debug >= LOG_ERR )
+            {
+                perror("shm_open");
+            }
+        }
     }
 
     return result;
 }
 
+
 /*============================================================================*/
-/*  VAR_Print                                                                 */
+/*  NewClient                                                                 */
 /*!
-    Print a variable value to the specified output stream
+    Create a new Variable Server client
 
-    The VAR_Print function prints out the value of the variable
-    specified by hVar to the output stream specified by fp.
+    The NewClient function creates a shared memory VarClient object
+    and semaphore used to communicate with the Variable Server.
+    The semaphore is used to block the client while it is awaiting a
+    response from the server.  The VarClient object is used to
+    send data to the variable server, and receive responses from the
+    variable server.
+
+    The variable client shared memory object is accessible via
+    /varclient_<client pid>, or /varclient_<client pid>.<shard> for
+    a connection to a shard server (see ClientName)
+
+    The object is mapped at the start of an address range reserved for
+    a working buffer of up to VARSERVER_MAX_WORKBUF_SIZE bytes, so the
+    working buffer can be grown later without moving the VarClient.
 
     @param[in]
-        hVarServer
-            handle to the variable server
+        workbufsize
+            specifies the initial size of the working buffer interface
+            between the client and the server
 
     @param[in]
-        hVar
-            handle to the variable to be printed
+        shard
+            shard index of the server the client connects to
 
     @param[in]
-        fd
-            specifies the output file descriptor to print to
+        channel
+            channel index of the connection, 0 for the primary connection
 
-    @retval EOK - the variable was printed ok
-    @retval ENOTSUP - the variable data type is not supported for printing
-    @retval EINVAL - invalid arguments
+    @retval pointer to the newly created VarClient object
+    @retval NULL if the VarClient object could not be created
 
 ==============================================================================*/
-int VAR_Print( VARSERVER_HANDLE hVarServer,
-               VAR_HANDLE hVar,
-               int fd )
+static VarClient *NewClient( size_t workbufsize, int shard, int channel )
 {
-    int result = EINVAL;
-    pid_t responderPID;
+    int res;
+	int fd;
+	pid_t pid;
+    char clientname[BUFSIZ];
+    VarClient *pVarClient = NULL;
+    size_t sharedMemSize;
+    size_t workbufmax;
+    void *pReserved;
+    struct group *gr;
 
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    /* calculate the size of the client-server interface working buffer */
+    sharedMemSize = sizeof(VarClient) + workbufsize;
 
-    if( pVarClient != NULL )
-    {
-        pVarClient->requestType = VARREQUEST_PRINT;
-        pVarClient->variableInfo.hVar = hVar;
+    /* calculate the size of the largest working buffer */
+    workbufmax = ( workbufsize < VARSERVER_MAX_WORKBUF_SIZE )
+                    ? VARSERVER_MAX_WORKBUF_SIZE
+                    : workbufsize;
 
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-        if( pVarClient->responseVal == ESTRPIPE)
-        {
-            /* get the PID of the client doing the printing */
-            responderPID = (pid_t)(pVarClient->peer_pid);
+    /* build the varclient identifier */
+	pid = getpid();
+    ClientName( clientname, sizeof( clientname ), pid, channel, shard );
 
-            /* send the file descriptor to the responder */
-            result = VARPRINT_SendFileDescriptor( responderPID, fd );
-            if( result == EOK )
+	/* get shared memory file descriptor (NOT a file) */
+	fd = shm_open(clientname, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	if (fd != -1)
+	{
+    	/* extend shared memory object as by default
+           it is initialized with size 0 */
+	    res = ftruncate(fd, sharedMemSize );
+	    if (res != -1)
+	    {
+            /* reserve the address space for the largest working buffer */
+            pReserved = mmap( NULL,
+                              sizeof(VarClient) + workbufmax,
+                              PROT_NONE,
+                              MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                              -1,
+                              0 );
+
+            /* map shared memory to process address space */
+            pVarClient = ( pReserved != MAP_FAILED )
+                            ? mmap( pReserved,
+                                    sharedMemSize ,
+                                    PROT_WRITE,
+                                    MAP_SHARED | MAP_FIXED,
+                                    fd,
+                                    0)
+                            : MAP_FAILED;
+
+            if( pVarClient != MAP_FAILED )
             {
-                /* block client until printing is complete */
-                pVarClient->blocked = 1;
-                do
+                /* populate the VarClient object */
+                pVarClient->id = VARSERVER_ID;
+                pVarClient->version = VARSERVER_VERSION;
+                pVarClient->client_pid = pid;
+                pVarClient->shard = shard;
+                pVarClient->channel = channel;
+                pVarClient->workbufsize = workbufsize + 1;
+                pVarClient->workbufmax = workbufmax + 1;
+
+                /* get the varserver group id */
+                gr = getgrnam( VARSERVER_GROUP_NAME );
+                if ( gr != NULL )
                 {
-                    result = sem_wait( &pVarClient->sem );
-                    if ( result == -1 )
-                    {
-                        result = errno;
-                    }
-                } while ( result != EOK );
-                pVarClient->blocked = 0;
+                    pVarClient->varserver_gid = gr->gr_gid;
+                }
+
+                /* clear the working buffer */
+                memset( &pVarClient->workbuf, 0, pVarClient->workbufsize );
+
+                /* initialize the VarClient semaphore */
+                NewClientSemaphore( pVarClient );
+
+                /* get the varclient user and group info */
+                pVarClient->uid = geteuid();
+                if ( varserver_GetGroupList( pVarClient ) != EOK )
+                {
+                    syslog( LOG_ERR,
+                            "Cannot get group list for user %d",
+                            pVarClient->uid );
+                }
+            }
+            else
+            {
+                perror("mmap");
+                pVarClient = NULL;
+
+                if ( pReserved != MAP_FAILED )
+                {
+                    munmap( pReserved, sizeof(VarClient) + workbufmax );
+                }
             }
         }
         else
         {
-            result = var_PrintValue( fd,
-                                     &pVarClient->variableInfo,
-                                     &pVarClient->workbuf );
+            perror("ftruncate");
         }
+
+        /* close the file descriptor since we don't need it for anything */
+        close( fd );
+	}
+    else
+    {
+        perror("shm_open");
     }
 
-    return result;
+    return pVarClient;
 }
 
 /*============================================================================*/
-/*  VAR_OpenPrintSession                                                      */
+/*  varserver_GetGroupList                                                    */
 /*!
-    Open a new print session
-
-    The VAR_OpenPrintSession creates a new print session,
-    creating a link to the requesting client's output stream
-    and returning a handle to the variable that should be output.
-
-    @param[in]
-        hVarServer
-            handle to the variable server
-
-    @param[in]
-        id
-            transaction identifier for the print session
+    Get the current user's group list
 
-    @param[in]
-        hVar
-            pointer to the location to store the handle of the variable
-            to be output
+    The varserver_GetGroupList function gets the group and group list
+    of the current varserver user.  The user and group ids are used
+    to determine if the current user has read/write permissions on the
+    varserver variables.
 
     @param[in]
-        fd
-            pointer to the location to store the fd for the output stream
+        pVarClient
+            pointer to the VarClient that contains the current effective user
+            identifier of the varserver client.
 
-    @retval EOK - the print session was successfully created
-    @retval EINVAL - invalid arguments
+    @retval EOK the group list was retrieved
+    @retval E2BIG the current user is a member of too many groups
+    @retval EINVAL invalid argument
 
 ==============================================================================*/
-int VAR_OpenPrintSession( VARSERVER_HANDLE hVarServer,
-                         uint32_t id,
-                         VAR_HANDLE *hVar,
-                         int *fd )
+static int varserver_GetGroupList( VarClient *pVarClient )
 {
     int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
-    int sock;
-    pid_t pid;
+    struct passwd *pw;
+    int rc;
 
-    if( ( pVarClient != NULL ) &&
-        ( hVar != NULL ) &&
-        ( fd != NULL ) )
+    if ( pVarClient != NULL )
     {
-        /* set up a socket to get the file descriptor to print to */
-        pid = pVarClient->client_pid;
-        result = VARPRINT_SetupListener( pid, &sock, pVarClient->varserver_gid);
-        if( result == EOK )
+        pw = getpwuid (pVarClient->uid);
+        if ( pw != NULL )
         {
-            pVarClient->requestType = VARREQUEST_OPEN_PRINT_SESSION;
-            pVarClient->requestVal = id;
+            pVarClient->gid = pw->pw_gid;
 
-            result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-            if( result == EOK )
+            /* get the group list */
+            pVarClient->ngroups = VARSERVER_MAX_CLIENT_GIDS;
+
+            rc = getgrouplist( pw->pw_name,
+                               pw->pw_gid,
+                               pVarClient->grouplist,
+                               &pVarClient->ngroups );
+            if ( rc == -1 )
             {
-                /* get a handle to the variable we are printing */
-                *hVar = pVarClient->variableInfo.hVar;
+                memset( pVarClient->grouplist,
+                        -1,
+                        sizeof( pVarClient->grouplist ));
 
-                /* get the file descriptor we are printing to */
-                result = VARPRINT_GetFileDescriptor( sock,
-                                                     fd );
-            }
+                /* fall back to basic user only access (no groups) */
+                pVarClient->ngroups = 1;
+                pVarClient->grouplist[0] = pVarClient->uid;
 
-            /* shut down the listener */
-            VARPRINT_ShutdownListener( pid, sock );
+                result = E2BIG;
+            }
+            else
+            {
+                result = EOK;
+            }
         }
     }
 
@@ -3274,235 +8472,248 @@ int VAR_OpenPrintSession( VARSERVER_HANDLE hVarServer,
 }
 
 /*============================================================================*/
-/*  VAR_ClosePrintSession                                                     */
+/*  NewClientSemaphore                                                        */
 /*!
-    Conclude a print session
+    Initialize a new Variable Client semaphore
 
-    The VAR_ClosePrintSession terminates an active print session
-    and unblocks the requesting client.
+    The NewClientSemaphore function initializes the Variable Client
+    semaphore before it is first used.
 
-    @param[in]
-        hVarServer
-            handle to the variable server
+    The semaphore is used to block the client while it is awaiting a
+    response from the server.
 
-    @param[in]
-        id
-            transaction identifier for the print session
+    @retval EOK the new client semaphore was successfully initialized
+    @retval EINVAL an invalid variable client was specified
 
-    @param[in]
-        fd
-            file descriptor for the print session output stream
+==============================================================================*/
+static int NewClientSemaphore( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    if( pVarClient != NULL )
+    {
+        sem_init( &pVarClient->sem, 1, 0 );
+
+        /* infinite timeout by default */
+        pVarClient->requestTimeout_s = 0;
+
+        result = EOK;
+    }
+
+    return result;
+}
 
-    @retval EOK - the print session was successfully completed
-    @retval EINVAL - invalid arguments
+/*============================================================================*/
+/*  DeleteClientQueue                                                         */
+/*!
+    Delete a client notification queue
+
+    The DeleteClientQueue function deletes a client notification
+    queue.
 
 ==============================================================================*/
-int VAR_ClosePrintSession( VARSERVER_HANDLE hVarServer,
-                           uint32_t id,
-                           int fd )
+static void DeleteClientQueue( VarClient *pVarClient )
 {
-    int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
+    char clientname[BUFSIZ];
 
-    if( pVarClient != NULL )
+    if ( pVarClient != NULL )
     {
-        pVarClient->requestType = VARREQUEST_CLOSE_PRINT_SESSION;
-        pVarClient->requestVal = id;
+        /* build the varclient identifier */
+        sprintf(clientname, "/varclient_%d", pVarClient->client_pid);
 
-        result = ClientRequest( pVarClient, SIG_CLIENT_REQUEST );
-        if( result == EOK )
-        {
-            close( fd );
-        }
+        mq_close( pVarClient->notificationQ );
+        mq_unlink( clientname );
     }
-
-    return result;
 }
 
 /*============================================================================*/
-/*  var_PrintValue                                                            */
+/*  VAR_GetFromQueue                                                          */
 /*!
-    Print a variable value to the specified output stream
+    Get a variable notification from the notification queue
 
-    The var_PrintValue function prints out the value specified in
-    the VarInfo structure.  It uses the format specifier associated
-    with the variable (if it exists), or a generic %f, %ul, %d etc
-    if it does not.
+    The VAR_GetFromQueue function gets the value of the variable
+    from the notification queue and puts it into the specified
+    VarNotification object.
+
+    The caller should provide an appropriately sized buffer
+    in pVarNotification->obj.val.blob to receive the maximum
+    expected blob or string data.
+
+    If a buffer is not provided, one will be created, and the
+    caller must be responsible for deallocating the buffer
+    when they are done with it.
 
     @param[in]
-        fd
-            file descriptor to print to
+        hVarServer
+            handle to the variable server
 
     @param[in]
-        pInfo
-            pointer to the VarInfo object that contains the variable
-            value to be printed
+        pVarNotification
+            specifies the location where the variable value should be stored
 
     @param[in]
-        workbuf
-            pointer to the working buffer where string to be
-            printed is located.  Only applicable if the variable
-            type is VARTYPE_STR
+        buf
+            pointer to a working buffer to receive a message
 
-    @retval EOK - the variable was printed ok
-    @retval ENOTSUP - the variable data type is not supported for printing
+    @param[in]
+        len
+            length of the working buffer
+
+    @retval EOK - the variable was retrieved ok
+    @retval EAGAIN - no data is available
+    @retval E2BIG - the received data is too big to fit in the supplied buffer
+    @retval ENOMEM - memory allocation failed
     @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-static int var_PrintValue( int fd, VarInfo *pInfo, char *workbuf )
+int VAR_GetFromQueue( VARSERVER_HANDLE hVarServer,
+                      VarNotification *pVarNotification,
+                      char *buf,
+                      size_t len )
 {
-    char *fmt;
     int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    ssize_t n;
+    void *p;
+    size_t varlen;
+    VarNotification *pSrc;
 
-    if( ( fd >= 0 ) &&
-        ( pInfo != NULL ) &&
-        ( workbuf != NULL ) )
+    if( ( pVarClient != NULL ) &&
+        ( pVarNotification != NULL ) &&
+        ( buf != NULL ) &&
+        ( len > sizeof(VarNotification) ) )
     {
-        if ( pInfo->flags & VARFLAG_PASSWORD )
-        {
-            dprintf(fd, "********" );
-            result = EOK;
-        }
-        else
+        n = mq_receive( pVarClient->notificationQ,
+                        buf,
+                        len,
+                        NULL );
+        if ( n >= 0 )
         {
-            switch( pInfo->var.type )
-            {
-                case VARTYPE_FLOAT:
-                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%f"
-                                                        : pInfo->formatspec;
-                    dprintf(fd, fmt, pInfo->var.val.f );
-                    result = EOK;
-                    break;
-
-                case VARTYPE_BLOB:
-                    dprintf( fd,
-                            "%s len=%"PRIu32">",
-                            "<object:",
-                            (uint32_t)(pInfo->var.len));
-                    result = EOK;
-                    break;
-
-                case VARTYPE_STR:
-                    /* string variable values are transferred via the workbuf */
-                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%s"
-                                                        : pInfo->formatspec;
-                    dprintf(fd, fmt, workbuf );
-                    result = EOK;
-                    break;
-
-                case VARTYPE_UINT16:
-                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%u"
-                                                        : pInfo->formatspec;
-                    dprintf(fd, fmt, pInfo->var.val.ui );
-                    result = EOK;
-                    break;
+            /* get a pointer to the received VarObject */
+            pSrc = (VarNotification *)buf;
 
-                case VARTYPE_INT16:
-                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%d"
-                                                        : pInfo->formatspec;
-                    dprintf(fd, fmt, pInfo->var.val.i );
-                    result = EOK;
-                    break;
+            if ( n > (ssize_t)sizeof( VarNotification ) )
+            {
+                /* calculate the length of the variable part of the message */
+                varlen = n - sizeof(VarNotification);
 
-                case VARTYPE_UINT32:
-                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%lu"
-                                                        : pInfo->formatspec;
-                    dprintf(fd, fmt, pInfo->var.val.ul );
-                    result = EOK;
-                    break;
+                /* see if the caller has provided a blob/string buffer */
+                if ( pVarNotification->obj.val.blob == NULL )
+                {
+                    /* no user supplied buffer, create one */
+                    pVarNotification->obj.val.blob = calloc(1, varlen );
+                    if( pVarNotification->obj.val.blob == NULL )
+                    {
+                        /* failed to allocate memory for blob/string data */
+                        result = ENOMEM;
+                    }
+                }
 
-                case VARTYPE_INT32:
-                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%d"
-                                                        : pInfo->formatspec;
-                    dprintf(fd, fmt, pInfo->var.val.l );
-                    result = EOK;
-                    break;
+                if ( pVarNotification->obj.val.blob != NULL )
+                {
+                    if ( ( varlen > 0 ) &&
+                         ( varlen <= pVarNotification->obj.len ) )
+                    {
+                        /* copy the blob data */
+                        p = &buf[sizeof(VarNotification)];
+                        memcpy( pVarNotification->obj.val.blob, p, varlen );
 
-                case VARTYPE_UINT64:
-                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%llu"
-                                                        : pInfo->formatspec;
-                    dprintf(fd, fmt, pInfo->var.val.ull );
-                    result = EOK;
-                    break;
+                        /* copy the blob metadata */
+                        pVarNotification->obj.len = varlen;
+                        pVarNotification->hVar = pSrc->hVar;
+                        pVarNotification->obj.type = pSrc->obj.type;
 
-                case VARTYPE_INT64:
-                    fmt = ( pInfo->formatspec[0] == 0 ) ? "%lld"
-                                                        : pInfo->formatspec;
-                    dprintf(fd, fmt, pInfo->var.val.ll );
-                    result = EOK;
-                    break;
+                        result = EOK;
+                    }
+                    else
+                    {
+                        /* received blob/string data will not fit into
+                           the supplied buffer */
+                        result = E2BIG;
+                    }
+                }
+            }
+            else
+            {
+                /* copy primitive type */
+                memcpy( pVarNotification, buf, sizeof(VarNotification));
 
-                default:
-                    result = ENOTSUP;
-                    break;
+                result = EOK;
             }
         }
+        else
+        {
+            result = errno;
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  InitServerInfo                                                            */
+/*  VARSERVER_CreateClientRing                                                */
 /*!
-    Initialize the VarServer information
+    Open the shared change ring
 
-    The InitServerInfo function opens a shared memory block owned by the
-    variable server in which public variable server status is stored.
-    The shared memory block is opened in a read-only mode to allow clients
-    to get information about the server including the server's process
-    identifier which is used to send signals from the client to the server.
+    The VARSERVER_CreateClientRing function maps the server's shared
+    change ring read-only into the client's address space.  Variables
+    registered with a NOTIFY_MODIFIED_RING notification have their
+    changes published on the ring once for all subscribers, and are
+    read with VAR_GetFromRing instead of a per-client message queue
+    and signal.
 
-    @retval EOK got a pointer to the server info
-    @retval ENOMEM cannot allocate server info
-    @retval ENOENT the server info could not be read
+    The client's read cursor starts at the current head of the ring,
+    so only changes published after this call are seen.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @retval EOK the change ring was opened
+    @retval ENOENT the server change ring is not available
+    @retval ENOMEM the server change ring could not be mapped
+    @retval EINVAL an invalid variable client was specified
 
 ==============================================================================*/
-static int InitServerInfo( VarClient *pVarClient )
+int VARSERVER_CreateClientRing( VARSERVER_HANDLE hVarServer )
 {
-    int fd;
     int result = EINVAL;
-    ServerInfo *pServerInfo = NULL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    int fd;
+    void *p;
 
     if( pVarClient != NULL )
     {
-        /* get shared memory file descriptor (NOT a file) */
-        fd = shm_open( SERVER_SHAREDMEM, O_RDONLY, S_IRUSR | S_IWUSR);
-        if (fd != -1)
+        result = EOK;
+
+        if( pVarClient->pChangeRing == NULL )
         {
-            /* map shared memory to process address space */
-            pServerInfo = (ServerInfo *)mmap( NULL,
-                                            sizeof(ServerInfo),
-                                            PROT_READ,
-                                            MAP_SHARED,
-                                            fd,
-                                            0);
-            if (pServerInfo != MAP_FAILED)
+            fd = shm_open( SERVER_CHANGERING, O_RDONLY, S_IRUSR | S_IWUSR );
+            if( fd != -1 )
             {
-                pVarClient->pServerInfo = pServerInfo;
-                if( pVarClient->debug >= LOG_INFO )
+                p = mmap( NULL,
+                          sizeof( ChangeRing ),
+                          PROT_READ,
+                          MAP_SHARED,
+                          fd,
+                          0 );
+                if( p != MAP_FAILED )
+                {
+                    pVarClient->pChangeRing = (ChangeRing *)p;
+                    pVarClient->changeCursor =
+                        __atomic_load_n( &pVarClient->pChangeRing->head,
+                                         __ATOMIC_ACQUIRE );
+                }
+                else
                 {
-                    printf("CLIENT: Server PID: %d\n", pServerInfo->pid);
+                    result = ENOMEM;
                 }
 
-                result = EOK;
+                close( fd );
             }
             else
             {
-                result = ENOMEM;
-
-                if( pVarClient->debug >= LOG_ERR )
-                {
-                    perror("mmap");
-                }
-            }
-        }
-        else
-        {
-            result = ENOENT;
-            if( pVarClient->debug >= LOG_ERR )
-            {
-                perror("shm_open");
+                result = ENOENT;
             }
         }
     }
@@ -3510,171 +8721,208 @@ static int InitServerInfo( VarClient *pVarClient )
     return result;
 }
 
-
 /*============================================================================*/
-/*  NewClient                                                                 */
+/*  VAR_GetFromRing                                                           */
 /*!
-    Create a new Variable Server client
+    Get a variable notification from the shared change ring
 
-    The NewClient function creates a shared memory VarClient object
-    and semaphore used to communicate with the Variable Server.
-    The semaphore is used to block the client while it is awaiting a
-    response from the server.  The VarClient object is used to
-    send data to the variable server, and receive responses from the
-    variable server.
+    The VAR_GetFromRing function reads change records from the shared
+    change ring, skipping records for variables the client has not
+    subscribed to with NOTIFY_MODIFIED_RING, and puts the next
+    subscribed change into the specified VarNotification object.
+    The notification handle is the handle the client subscribed with.
 
-    The variable client shared memory object is accessible via
-    /varclient_<client pid>
+    As with VAR_GetFromQueue, the caller should provide a buffer in
+    pVarNotification->obj.val.blob (with its size in obj.len) to receive
+    string or blob data.  If a buffer is not provided, one will be
+    created and the caller is responsible for deallocating it.
+
+    If the client falls so far behind that unread records have been
+    overwritten, EOVERFLOW is returned and the client's cursor is moved
+    to the head of the ring.  The client should then re-read the current
+    values of the variables it is interested in.
 
     @param[in]
-        workbufsize
-            specifies the size of the working buffer interface
-            between the client and the server
+        hVarServer
+            handle to the variable server
 
-    @retval pointer to the newly created VarClient object
-    @retval NULL if the VarClient object could not be created
+    @param[in,out]
+        pVarNotification
+            specifies the location where the variable value should be stored
+
+    @retval EOK - the variable was retrieved ok
+    @retval EAGAIN - no data is available
+    @retval EOVERFLOW - the client was overrun and changes have been lost
+    @retval E2BIG - the received data is too big to fit in the supplied buffer
+    @retval ENOMEM - memory allocation failed
+    @retval ENOENT - the change ring has not been opened
+    @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-static VarClient *NewClient( size_t workbufsize )
+int VAR_GetFromRing( VARSERVER_HANDLE hVarServer,
+                     VarNotification *pVarNotification )
 {
-    int res;
-	int fd;
-	pid_t pid;
-    char clientname[BUFSIZ];
-    VarClient *pVarClient = NULL;
-    size_t sharedMemSize;
-    struct group *gr;
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    ChangeRing *pRing;
+    ChangeRecord record;
+    uint64_t cursor;
+    VAR_HANDLE hVar;
 
-    /* calculate the size of the client-server interface working buffer */
-    sharedMemSize = sizeof(VarClient) + workbufsize;
+    if( ( pVarClient != NULL ) &&
+        ( pVarNotification != NULL ) )
+    {
+        pRing = pVarClient->pChangeRing;
+        result = ( pRing != NULL ) ? EAGAIN : ENOENT;
 
-    /* build the varclient identifier */
-	pid = getpid();
-	sprintf(clientname, "/varclient_%d", pid);
+        while( ( result == EAGAIN ) &&
+               ( pVarClient->changeCursor !=
+                 __atomic_load_n( &pRing->head, __ATOMIC_ACQUIRE ) ) )
+        {
+            cursor = pVarClient->changeCursor;
 
-	/* get shared memory file descriptor (NOT a file) */
-	fd = shm_open(clientname, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
-	if (fd != -1)
-	{
-    	/* extend shared memory object as by default
-           it is initialized with size 0 */
-	    res = ftruncate(fd, sharedMemSize );
-	    if (res != -1)
-	    {
-            /* map shared memory to process address space */
-            pVarClient = mmap( NULL,
-                               sharedMemSize ,
-                               PROT_WRITE,
-                               MAP_SHARED,
-                               fd,
-                               0);
+            /* read the record header */
+            var_RingCopy( pRing, cursor, &record, sizeof( record ) );
 
-            if( pVarClient != NULL )
+            hVar = var_FindRingSubscription( pVarClient, record.storageRef );
+            if( hVar != VAR_INVALID )
             {
-                /* populate the VarClient object */
-                pVarClient->id = VARSERVER_ID;
-                pVarClient->version = VARSERVER_VERSION;
-                pVarClient->client_pid = pid;
-                pVarClient->workbufsize = workbufsize + 1;
-
-                /* get the varserver group id */
-                gr = getgrnam( VARSERVER_GROUP_NAME );
-                if ( gr != NULL )
+                if( record.len > 0 )
                 {
-                    pVarClient->varserver_gid = gr->gr_gid;
-                }
-
-                /* clear the working buffer */
-                memset( &pVarClient->workbuf, 0, pVarClient->workbufsize );
-
-                /* initialize the VarClient semaphore */
-                NewClientSemaphore( pVarClient );
+                    if( pVarNotification->obj.val.blob == NULL )
+                    {
+                        /* no user supplied buffer, create one */
+                        pVarNotification->obj.val.blob = calloc( 1,
+                                                                 record.len );
+                        pVarNotification->obj.len = record.len;
+                    }
 
-                /* get the varclient user and group info */
-                pVarClient->uid = geteuid();
-                if ( varserver_GetGroupList( pVarClient ) != EOK )
+                    if( pVarNotification->obj.val.blob == NULL )
+                    {
+                        result = ENOMEM;
+                    }
+                    else if( record.len > pVarNotification->obj.len )
+                    {
+                        result = E2BIG;
+                    }
+                    else
+                    {
+                        /* copy the string/blob data */
+                        var_RingCopy( pRing,
+                                      cursor + sizeof( record ),
+                                      pVarNotification->obj.val.blob,
+                                      record.len );
+
+                        pVarNotification->hVar = hVar;
+                        pVarNotification->obj.type = record.obj.type;
+                        pVarNotification->obj.len = record.len;
+                        result = EOK;
+                    }
+                }
+                else
                 {
-                    syslog( LOG_ERR,
-                            "Cannot get group list for user %d",
-                            pVarClient->uid );
+                    /* copy primitive type */
+                    pVarNotification->hVar = hVar;
+                    pVarNotification->obj = record.obj;
+                    result = EOK;
                 }
             }
+
+            /* check that the server did not overwrite the record
+               while we were reading it */
+            __atomic_thread_fence( __ATOMIC_ACQUIRE );
+            if( ( __atomic_load_n( &pRing->reserve, __ATOMIC_RELAXED ) -
+                  cursor ) > VARSERVER_CHANGE_RING_SIZE )
+            {
+                pVarClient->changeCursor =
+                    __atomic_load_n( &pRing->head, __ATOMIC_ACQUIRE );
+                result = EOVERFLOW;
+            }
             else
             {
-                perror("mmap");
+                /* move to the next record */
+                pVarClient->changeCursor = cursor + record.size;
             }
         }
-        else
-        {
-            perror("ftruncate");
-        }
-
-        /* close the file descriptor since we don't need it for anything */
-        close( fd );
-	}
-    else
-    {
-        perror("shm_open");
     }
 
-    return pVarClient;
+    return result;
 }
 
 /*============================================================================*/
-/*  varserver_GetGroupList                                                    */
+/*  VAR_WaitRing                                                              */
 /*!
-    Get the current user's group list
+    Wait for records to be published on the shared change ring
 
-    The varserver_GetGroupList function gets the group and group list
-    of the current varserver user.  The user and group ids are used
-    to determine if the current user has read/write permissions on the
-    varserver variables.
+    The VAR_WaitRing function blocks until there are unread records on
+    the shared change ring, or until the timeout expires.  The server
+    wakes all waiting clients with a single futex wake per record.
 
     @param[in]
-        pVarClient
-            pointer to the VarClient that contains the current effective user
-            identifier of the varserver client.
+        hVarServer
+            handle to the variable server
 
-    @retval EOK the group list was retrieved
-    @retval E2BIG the current user is a member of too many groups
-    @retval EINVAL invalid argument
+    @param[in]
+        timeout_ms
+            maximum time to wait in milliseconds. -1 = wait forever
+
+    @retval EOK - there are unread records on the change ring
+    @retval ETIMEDOUT - the timeout expired
+    @retval EINTR - the wait was interrupted by a signal
+    @retval ENOENT - the change ring has not been opened
+    @retval EINVAL - invalid arguments
 
 ==============================================================================*/
-static int varserver_GetGroupList( VarClient *pVarClient )
+int VAR_WaitRing( VARSERVER_HANDLE hVarServer, int timeout_ms )
 {
     int result = EINVAL;
-    struct passwd *pw;
-    int rc;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    ChangeRing *pRing;
+    struct timespec ts;
+    struct timespec *pts = NULL;
+    uint32_t seq;
 
-    if ( pVarClient != NULL )
+    if( pVarClient != NULL )
     {
-        pw = getpwuid (pVarClient->uid);
-        if ( pw != NULL )
+        pRing = pVarClient->pChangeRing;
+        if( pRing == NULL )
         {
-            pVarClient->gid = pw->pw_gid;
-
-            /* get the group list */
-            pVarClient->ngroups = VARSERVER_MAX_CLIENT_GIDS;
-
-            rc = getgrouplist( pw->pw_name,
-                               pw->pw_gid,
-                               pVarClient->grouplist,
-                               &pVarClient->ngroups );
-            if ( rc == -1 )
+            result = ENOENT;
+        }
+        else
+        {
+            /* get the sequence number before checking for new records
+               so a record published after the check ends the wait */
+            seq = __atomic_load_n( &pRing->seq, __ATOMIC_ACQUIRE );
+            if( __atomic_load_n( &pRing->head, __ATOMIC_ACQUIRE ) !=
+                pVarClient->changeCursor )
             {
-                memset( pVarClient->grouplist,
-                        -1,
-                        sizeof( pVarClient->grouplist ));
-
-                /* fall back to basic user only access (no groups) */
-                pVarClient->ngroups = 1;
-                pVarClient->grouplist[0] = pVarClient->uid;
-
-                result = E2BIG;
+                result = EOK;
             }
             else
             {
-                result = EOK;
+                if( timeout_ms >= 0 )
+                {
+                    ts.tv_sec = timeout_ms / 1000;
+                    ts.tv_nsec = ( timeout_ms % 1000 ) * 1000000L;
+                    pts = &ts;
+                }
+
+                if( ( syscall( SYS_futex,
+                               &pRing->seq,
+                               FUTEX_WAIT,
+                               seq,
+                               pts,
+                               NULL,
+                               0 ) == 0 ) ||
+                    ( errno == EAGAIN ) )
+                {
+                    result = EOK;
+                }
+                else
+                {
+                    result = errno;
+                }
             }
         }
     }
@@ -3683,182 +8931,178 @@ static int varserver_GetGroupList( VarClient *pVarClient )
 }
 
 /*============================================================================*/
-/*  NewClientSemaphore                                                        */
+/*  var_RingCopy                                                              */
 /*!
-    Initialize a new Variable Client semaphore
+    Copy data out of the shared change ring
 
-    The NewClientSemaphore function initializes the Variable Client
-    semaphore before it is first used.
+    The var_RingCopy function copies data from the change ring data
+    area at the specified free running offset, wrapping around the end
+    of the data area if required.
 
-    The semaphore is used to block the client while it is awaiting a
-    response from the server.
+    @param[in]
+        pRing
+            pointer to the shared change ring
 
-    @retval EOK the new client semaphore was successfully initialized
-    @retval EINVAL an invalid variable client was specified
+    @param[in]
+        offset
+            free running byte offset to read from
+
+    @param[in]
+        dst
+            location to copy the data to
+
+    @param[in]
+        len
+            number of bytes to copy
 
 ==============================================================================*/
-static int NewClientSemaphore( VarClient *pVarClient )
+static void var_RingCopy( ChangeRing *pRing,
+                          uint64_t offset,
+                          void *dst,
+                          size_t len )
 {
-    int result = EINVAL;
+    size_t idx = offset & ( VARSERVER_CHANGE_RING_SIZE - 1 );
+    size_t n = VARSERVER_CHANGE_RING_SIZE - idx;
 
-    if( pVarClient != NULL )
+    if( n > len )
     {
-        sem_init( &pVarClient->sem, 1, 0 );
-
-        /* infinite timeout by default */
-        pVarClient->requestTimeout_s = 0;
-
-        result = EOK;
+        n = len;
     }
 
-    return result;
+    memcpy( dst, &pRing->data[idx], n );
+    memcpy( (char *)dst + n, pRing->data, len - n );
 }
 
 /*============================================================================*/
-/*  DeleteClientQueue                                                         */
+/*  var_FindRingSubscription                                                  */
 /*!
-    Delete a client notification queue
+    Look up a change ring subscription
 
-    The DeleteClientQueue function deletes a client notification
-    queue.
+    The var_FindRingSubscription function gets the variable handle the
+    client used to subscribe to the variable with the specified storage
+    reference.
+
+    @param[in]
+        pVarClient
+            pointer to the variable client
+
+    @param[in]
+        storageRef
+            storage reference of the changed variable
+
+    @retval handle of the subscribed variable
+    @retval VAR_INVALID the client is not subscribed to the variable
 
 ==============================================================================*/
-static void DeleteClientQueue( VarClient *pVarClient )
+static VAR_HANDLE var_FindRingSubscription( VarClient *pVarClient,
+                                            uint32_t storageRef )
 {
-    char clientname[BUFSIZ];
+    VAR_HANDLE hVar = VAR_INVALID;
+    uint32_t i;
 
-    if ( pVarClient != NULL )
+    for( i = 0; i < pVarClient->numRingSubscriptions; i++ )
     {
-        /* build the varclient identifier */
-        sprintf(clientname, "/varclient_%d", pVarClient->client_pid);
-
-        mq_close( pVarClient->notificationQ );
-        mq_unlink( clientname );
+        if( pVarClient->ringSubscriptions[i].storageRef == storageRef )
+        {
+            hVar = pVarClient->ringSubscriptions[i].hVar;
+            break;
+        }
     }
+
+    return hVar;
 }
 
 /*============================================================================*/
-/*  VAR_GetFromQueue                                                          */
-/*!
-    Get a variable notification from the notification queue
-
-    The VAR_GetFromQueue function gets the value of the variable
-    from the notification queue and puts it into the specified
-    VarNotification object.
-
-    The caller should provide an appropriately sized buffer
-    in pVarNotification->obj.val.blob to receive the maximum
-    expected blob or string data.
-
-    If a buffer is not provided, one will be created, and the
-    caller must be responsible for deallocating the buffer
-    when they are done with it.
-
-    @param[in]
-        hVarServer
-            handle to the variable server
+/*  var_AddRingSubscription                                                   */
+/*!
+    Record a change ring subscription
+
+    The var_AddRingSubscription function records the storage reference
+    of a variable registered for NOTIFY_MODIFIED_RING so its records
+    can be picked out of the change ring.
 
     @param[in]
-        pVarNotification
-            specifies the location where the variable value should be stored
+        pVarClient
+            pointer to the variable client
 
     @param[in]
-        buf
-            pointer to a working buffer to receive a message
+        hVar
+            handle the client subscribed with
 
     @param[in]
-        len
-            length of the working buffer
+        storageRef
+            storage reference of the subscribed variable
 
-    @retval EOK - the variable was retrieved ok
-    @retval EAGAIN - no data is available
-    @retval E2BIG - the received data is too big to fit in the supplied buffer
-    @retval ENOMEM - memory allocation failed
-    @retval EINVAL - invalid arguments
+    @retval EOK the subscription was recorded
+    @retval ENOSPC the subscription table is full
 
 ==============================================================================*/
-int VAR_GetFromQueue( VARSERVER_HANDLE hVarServer,
-                      VarNotification *pVarNotification,
-                      char *buf,
-                      size_t len )
+static int var_AddRingSubscription( VarClient *pVarClient,
+                                    VAR_HANDLE hVar,
+                                    uint32_t storageRef )
 {
-    int result = EINVAL;
-    VarClient *pVarClient = ValidateHandle( hVarServer );
-    ssize_t n;
-    void *p;
-    size_t varlen;
-    VarNotification *pSrc;
+    int result = ENOSPC;
+    uint32_t i;
+    RingSubscription *pSubscription;
 
-    if( ( pVarClient != NULL ) &&
-        ( pVarNotification != NULL ) &&
-        ( buf != NULL ) &&
-        ( len > sizeof(VarNotification) ) )
+    for( i = 0; i < pVarClient->numRingSubscriptions; i++ )
     {
-        n = mq_receive( pVarClient->notificationQ,
-                        buf,
-                        len,
-                        NULL );
-        if ( n >= 0 )
+        pSubscription = &pVarClient->ringSubscriptions[i];
+        if( pSubscription->hVar == hVar )
         {
-            /* get a pointer to the received VarObject */
-            pSrc = (VarNotification *)buf;
+            /* already subscribed */
+            pSubscription->storageRef = storageRef;
+            result = EOK;
+            break;
+        }
+    }
 
-            if ( n > (ssize_t)sizeof( VarNotification ) )
-            {
-                /* calculate the length of the variable part of the message */
-                varlen = n - sizeof(VarNotification);
+    if( ( result != EOK ) &&
+        ( pVarClient->numRingSubscriptions < VARSERVER_MAX_RING_SUBSCRIPTIONS ) )
+    {
+        i = pVarClient->numRingSubscriptions++;
+        pVarClient->ringSubscriptions[i].hVar = hVar;
+        pVarClient->ringSubscriptions[i].storageRef = storageRef;
+        result = EOK;
+    }
 
-                /* see if the caller has provided a blob/string buffer */
-                if ( pVarNotification->obj.val.blob == NULL )
-                {
-                    /* no user supplied buffer, create one */
-                    pVarNotification->obj.val.blob = calloc(1, varlen );
-                    if( pVarNotification->obj.val.blob == NULL )
-                    {
-                        /* failed to allocate memory for blob/string data */
-                        result = ENOMEM;
-                    }
-                }
+    return result;
+}
 
-                if ( pVarNotification->obj.val.blob != NULL )
-                {
-                    if ( ( varlen > 0 ) &&
-                         ( varlen <= pVarNotification->obj.len ) )
-                    {
-                        /* copy the blob data */
-                        p = &buf[sizeof(VarNotification)];
-                        memcpy( pVarNotification->obj.val.blob, p, varlen );
+/*============================================================================*/
+/*  var_RemoveRingSubscription                                                */
+/*!
+    Remove a change ring subscription
 
-                        /* copy the blob metadata */
-                        pVarNotification->obj.len = varlen;
-                        pVarNotification->hVar = pSrc->hVar;
-                        pVarNotification->obj.type = pSrc->obj.type;
+    The var_RemoveRingSubscription function removes the change ring
+    subscription for the specified variable handle.
 
-                        result = EOK;
-                    }
-                    else
-                    {
-                        /* received blob/string data will not fit into
-                           the supplied buffer */
-                        result = E2BIG;
-                    }
-                }
-            }
-            else
-            {
-                /* copy primitive type */
-                memcpy( pVarNotification, buf, sizeof(VarNotification));
+    @param[in]
+        pVarClient
+            pointer to the variable client
 
-                result = EOK;
-            }
-        }
-        else
+    @param[in]
+        hVar
+            handle the client subscribed with
+
+==============================================================================*/
+static void var_RemoveRingSubscription( VarClient *pVarClient,
+                                        VAR_HANDLE hVar )
+{
+    uint32_t i;
+    uint32_t n = pVarClient->numRingSubscriptions;
+
+    for( i = 0; i < n; i++ )
+    {
+        if( pVarClient->ringSubscriptions[i].hVar == hVar )
         {
-            result = errno;
+            /* replace the removed subscription with the last one */
+            pVarClient->ringSubscriptions[i] =
+                pVarClient->ringSubscriptions[n - 1];
+            pVarClient->numRingSubscriptions = n - 1;
+            break;
         }
     }
-
-    return result;
 }
 
 /*============================================================================*/
@@ -3897,6 +9141,89 @@ int VARSERVER_SetRequestTimeout( VARSERVER_HANDLE hVarServer,
     return result;
 }
 
+/*============================================================================*/
+/*  VARSERVER_SetTransport                                                    */
+/*!
+    Select the client request transport
+
+    The VARSERVER_SetTransport function selects how the client's requests
+    are delivered to the variable server.  With VARSERVER_TRANSPORT_RING
+    requests are queued on a shared memory ring and the server is only
+    signalled when it is idle, which avoids a real-time signal per
+    request under load.  If the ring is ever full, requests fall back
+    to the signal transport.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        transport
+            the request transport to use
+
+    @retval EOK - the request transport was successfully selected
+    @retval ENOENT - the server request ring is not available
+    @retval ENOMEM - the server request ring could not be mapped
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int VARSERVER_SetTransport( VARSERVER_HANDLE hVarServer,
+                            VarTransport transport )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = ValidateHandle( hVarServer );
+    int fd;
+    void *p;
+
+    if( pVarClient != NULL )
+    {
+        if( transport == VARSERVER_TRANSPORT_SIGNAL )
+        {
+            if( pVarClient->pRequestRing != NULL )
+            {
+                munmap( pVarClient->pRequestRing, sizeof(RequestRing) );
+                pVarClient->pRequestRing = NULL;
+            }
+
+            result = EOK;
+        }
+        else if( transport == VARSERVER_TRANSPORT_RING )
+        {
+            result = EOK;
+
+            if( pVarClient->pRequestRing == NULL )
+            {
+                fd = shm_open( SERVER_REQUESTRING, O_RDWR, S_IRUSR | S_IWUSR );
+                if( fd != -1 )
+                {
+                    p = mmap( NULL,
+                              sizeof( RequestRing ),
+                              PROT_READ | PROT_WRITE,
+                              MAP_SHARED,
+                              fd,
+                              0 );
+                    if( p != MAP_FAILED )
+                    {
+                        pVarClient->pRequestRing = (RequestRing *)p;
+                    }
+                    else
+                    {
+                        result = ENOMEM;
+                    }
+
+                    close( fd );
+                }
+                else
+                {
+                    result = ENOENT;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
 /*============================================================================*/
 /*  DeleteClientSemaphore                                                     */
 /*!
@@ -3959,11 +9286,20 @@ static int ClientCleanup( VarClient *pVarClient )
         /* delete the client semaphore */
         DeleteClientSemaphore( pVarClient );
 
-        /* delete the client notification queue */
-        DeleteClientQueue( pVarClient );
+        /* delete the client notification queue.  It belongs to the
+           root connection */
+        if ( ( pVarClient->shard == 0 ) &&
+             ( pVarClient->channel == 0 ) )
+        {
+            DeleteClientQueue( pVarClient );
+        }
 
         /* build the varclient identifier */
-        sprintf(clientname, "/varclient_%d", pVarClient->client_pid);
+        ClientName( clientname,
+                    sizeof( clientname ),
+                    pVarClient->client_pid,
+                    pVarClient->channel,
+                    pVarClient->shard );
 
         /* clean up the server info structure */
         pServerInfo = pVarClient->pServerInfo;
@@ -3977,8 +9313,50 @@ static int ClientCleanup( VarClient *pVarClient )
             }
         }
 
-        /* mmap cleanup */
-        res = munmap( pVarClient, sizeof(VarClient) );
+        /* clean up the shared value segment */
+        if ( pVarClient->pSharedValues != NULL )
+        {
+            munmap( pVarClient->pSharedValues, sizeof(SharedValues) );
+            pVarClient->pSharedValues = NULL;
+        }
+
+        if ( pVarClient->pSharedGrants != NULL )
+        {
+            free( pVarClient->pSharedGrants );
+            pVarClient->pSharedGrants = NULL;
+        }
+
+        /* clean up the name resolution cache */
+        if ( pVarClient->pNameCache != NULL )
+        {
+            free( pVarClient->pNameCache );
+            pVarClient->pNameCache = NULL;
+        }
+
+        /* clean up the variable version segment */
+        if ( pVarClient->pVarVersions != NULL )
+        {
+            munmap( pVarClient->pVarVersions, sizeof(VarVersions) );
+            pVarClient->pVarVersions = NULL;
+        }
+
+        /* clean up the request ring */
+        if ( pVarClient->pRequestRing != NULL )
+        {
+            munmap( pVarClient->pRequestRing, sizeof(RequestRing) );
+            pVarClient->pRequestRing = NULL;
+        }
+
+        /* clean up the change ring */
+        if ( pVarClient->pChangeRing != NULL )
+        {
+            munmap( pVarClient->pChangeRing, sizeof(ChangeRing) );
+            pVarClient->pChangeRing = NULL;
+        }
+
+        /* mmap cleanup, including the reserved working buffer space */
+        res = munmap( pVarClient,
+                      sizeof(VarClient) + pVarClient->workbufmax - 1 );
         if ( res != -1 )
         {
             /* shm_open cleanup */
@@ -4001,5 +9379,163 @@ static int ClientCleanup( VarClient *pVarClient )
     return result;
 }
 
+/*============================================================================*/
+/*  var_AsyncNewRequest                                                       */
+/*!
+    Get an idle request of an asynchronous request context
+
+    @param[in]
+        pVarAsync
+            pointer to the asynchronous request context
+
+    @param[in]
+        hVar
+            handle of the variable the request is for
+
+    @param[out]
+        ppRequest
+            pointer to a location to store a pointer to the request
+
+    @retval EOK - an idle request was found
+    @retval EBUSY - the maximum number of requests are already in flight
+    @retval EXDEV - the variable is not owned by the root server
+
+==============================================================================*/
+static int var_AsyncNewRequest( VarAsync *pVarAsync,
+                                VAR_HANDLE hVar,
+                                VarAsyncRequest **ppRequest )
+{
+    int result = EBUSY;
+    size_t i;
+
+    if( ( hVar >> VARSERVER_SHARD_SHIFT ) != 0 )
+    {
+        result = EXDEV;
+    }
+    else
+    {
+        for( i = 0; i < pVarAsync->depth; i++ )
+        {
+            if( pVarAsync->pRequests[i].state == VAR_ASYNC_IDLE )
+            {
+                *ppRequest = &pVarAsync->pRequests[i];
+                result = EOK;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  var_AsyncSubmit                                                           */
+/*!
+    Send an asynchronous request to the server
+
+    The var_AsyncSubmit function sends the request prepared in the
+    request's connection to the server without waiting for it.
+
+    @param[in]
+        pVarAsync
+            pointer to the asynchronous request context
+
+    @param[in]
+        pRequest
+            pointer to the asynchronous request
+
+    @retval EOK - the request was sent
+    @retval other - the request could not be sent
+
+==============================================================================*/
+static int var_AsyncSubmit( VarAsync *pVarAsync, VarAsyncRequest *pRequest )
+{
+    int result;
+
+    result = ClientSubmit( pRequest->pVarClient, SIG_CLIENT_REQUEST );
+    if( result == EOK )
+    {
+        pRequest->state = VAR_ASYNC_BUSY;
+        pVarAsync->inflight++;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  var_AsyncFinish                                                           */
+/*!
+    Handle the server's response to an asynchronous request
+
+    The var_AsyncFinish function gets the result of an asynchronous
+    request which the server has completed.  A GET request whose value
+    did not fit in the working buffer is sent again once the working
+    buffer has been grown.
+
+    @param[in]
+        pRequest
+            pointer to the asynchronous request
+
+==============================================================================*/
+static void var_AsyncFinish( VarAsyncRequest *pRequest )
+{
+    VarClient *pVarClient = pRequest->pVarClient;
+    int result = pVarClient->responseVal;
+
+    if( ( pRequest->requestType == VARREQUEST_GET ) &&
+        ( result == E2BIG ) &&
+        ( pRequest->retried == false ) )
+    {
+        /* the server has returned the length of the value which
+           did not fit, so grow the working buffer and retry */
+        pRequest->retried = true;
+        result = var_GrowWorkbuf( pVarClient,
+                                  pVarClient->variableInfo.var.len + 1 );
+        if( result == EOK )
+        {
+            pVarClient->requestType = VARREQUEST_GET;
+            pVarClient->variableInfo.hVar = pRequest->hVar;
+            result = ClientSubmit( pVarClient, SIG_CLIENT_REQUEST );
+        }
+    }
+    else if( ( pRequest->requestType == VARREQUEST_GET ) &&
+             ( result == EOK ) )
+    {
+        result = var_GetVarObject( pVarClient, pRequest->pVarObject );
+        pRequest->state = VAR_ASYNC_DONE;
+    }
+    else
+    {
+        pRequest->state = VAR_ASYNC_DONE;
+    }
+
+    if( ( pRequest->state == VAR_ASYNC_BUSY ) &&
+        ( result != EOK ) )
+    {
+        /* the retry could not be sent */
+        pRequest->state = VAR_ASYNC_DONE;
+    }
+
+    pRequest->result = result;
+}
+
+/*============================================================================*/
+/*  var_AsyncWake                                                             */
+/*!
+    Wake the asynchronous completion file descriptors
+
+    The var_AsyncWake function makes the completion file descriptors of
+    the process readable when a request completes without being sent
+    to the server.
+
+==============================================================================*/
+static void var_AsyncWake( void )
+{
+    union sigval val;
+
+    val.sival_int = 0;
+    sigqueue( getpid(), SIG_VAR_ASYNC, val );
+}
+
 /*! @}
  * end of varserver_api group */
@@ -38,6 +38,13 @@ SOFTWARE.
     a string or a file from an input template containing external
     variable references
 
+    A template can also be compiled once into a VarTemplate object,
+    which holds the literal text spans and the pre-resolved handles of
+    the referenced variables.  Rendering a compiled template fetches
+    all of the changed variable values in a single batch request, and
+    the template can register for modification notifications on its
+    variables so it is only rendered again when one of them changes.
+
 */
 /*============================================================================*/
 
@@ -54,14 +61,23 @@ SOFTWARE.
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <unistd.h>
+#include <inttypes.h>
 #include <varserver/var.h>
 #include <varserver/varserver.h>
+#include <varserver/varcache.h>
 #include <varserver/vartemplate.h>
 
 /*==============================================================================
         Private definitions
 ==============================================================================*/
 
+/*! maximum length of a variable name in a compiled template, which
+    matches the variable name buffer of the template engine */
+#define TEMPLATE_MAX_VARNAME_LEN    ( BUFSIZ - 2 )
+
+/*! number of spans to grow a compiled template by */
+#define TEMPLATE_SPANS_GROW_BY      ( 32 )
+
 /*==============================================================================
         Type Definitions
 ==============================================================================*/
@@ -101,6 +117,70 @@ typedef struct tState
 
 } TState;
 
+/*! literal text span or variable reference in a compiled template */
+typedef struct _TemplateSpan
+{
+    /*! offset of the literal text or variable name in the template text */
+    size_t offset;
+
+    /*! length of the literal text, 0 for a variable reference */
+    size_t len;
+
+    /*! true if the span is a variable reference */
+    bool isVar;
+
+    /*! handle of the variable, VAR_INVALID if it is not resolved yet */
+    VAR_HANDLE hVar;
+
+    /*! variable flags */
+    uint32_t flags;
+
+    /*! true if the variable is rendered by the variable server because
+        it has a PRINT handler or is a blob */
+    bool print;
+
+    /*! variable format specifier */
+    char formatspec[MAX_FORMATSPEC_LEN];
+
+} TemplateSpan;
+
+/*! compiled template */
+struct _VarTemplate
+{
+    /*! literal text and variable names of the template */
+    char *text;
+
+    /*! number of bytes used in the text buffer */
+    size_t textLength;
+
+    /*! size of the text buffer */
+    size_t textSize;
+
+    /*! template spans in output order */
+    TemplateSpan *pSpans;
+
+    /*! number of template spans */
+    size_t numSpans;
+
+    /*! number of template spans allocated */
+    size_t maxSpans;
+
+    /*! all of the resolved variables */
+    VarCache *pVars;
+
+    /*! the variables whose values are cached for rendering */
+    VarCache *pValues;
+
+    /*! true if modification notifications have been requested */
+    bool notify;
+
+    /*! parser state: 0=text, 1=found '$', 2=variable name */
+    int state;
+
+    /*! length of the variable name being parsed */
+    size_t k;
+};
+
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
@@ -124,6 +204,32 @@ static int CheckEndVariable( VARSERVER_HANDLE hVarServer,
 
 static int CheckOutputBuffer( TState *pTState );
 
+static int template_New( VarTemplate **ppVarTemplate );
+
+static int template_Parse( VarTemplate *pVarTemplate,
+                           char *input,
+                           size_t len );
+
+static int template_AppendText( VarTemplate *pVarTemplate,
+                                const char *text,
+                                size_t len );
+
+static int template_AppendLiteral( VarTemplate *pVarTemplate,
+                                   const char *text,
+                                   size_t len );
+
+static int template_AddSpan( VarTemplate *pVarTemplate, bool isVar );
+
+static int template_Resolve( VARSERVER_HANDLE hVarServer,
+                             VarTemplate *pVarTemplate,
+                             TemplateSpan *pSpan );
+
+static int template_NotifyVar( VAR_HANDLE hVar, void *arg );
+
+static int template_PrintValue( FILE *fp,
+                                TemplateSpan *pSpan,
+                                VarObject *pVarObject );
+
 /*==============================================================================
         Function definitions
 ==============================================================================*/
@@ -275,10 +381,896 @@ int TEMPLATE_StrToFile( VARSERVER_HANDLE hVarServer,
     return result;
 }
 
+/*============================================================================*/
+/*  TEMPLATE_Compile                                                          */
+/*!
+    Compile a template read from a file
+
+    The TEMPLATE_Compile function reads a template from an input file
+    and compiles it into a VarTemplate object which can be rendered
+    repeatedly with TEMPLATE_Render without parsing the template or
+    looking up the variables again.
+
+    @param[in]
+        hVarServer
+            handle to the Variable Server to resolve the variables with
+
+    @param[in]
+        fd_in
+            open file handle of the template file to compile
+
+    @param[out]
+        ppVarTemplate
+            pointer to a location to store the compiled template, which
+            must be released with TEMPLATE_Free
+
+    @retval EOK - the template was compiled
+    @retval ENOTSUP - one or more variables could not be resolved yet
+    @retval ENOMEM - memory allocation failed
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int TEMPLATE_Compile( VARSERVER_HANDLE hVarServer,
+                      int fd_in,
+                      VarTemplate **ppVarTemplate )
+{
+    int result = EINVAL;
+    VarTemplate *pVarTemplate = NULL;
+    char buf[BUFSIZ];
+    ssize_t n;
+    size_t i;
+
+    if ( ( hVarServer != NULL ) &&
+         ( fd_in >= 0 ) &&
+         ( ppVarTemplate != NULL ) )
+    {
+        result = template_New( &pVarTemplate );
+        while ( ( result == EOK ) &&
+                ( ( n = read( fd_in, buf, sizeof( buf ) ) ) > 0 ) )
+        {
+            result = template_Parse( pVarTemplate, buf, n );
+        }
+
+        if ( result == EOK )
+        {
+            for ( i = 0; i < pVarTemplate->numSpans; i++ )
+            {
+                if ( ( pVarTemplate->pSpans[i].isVar == true ) &&
+                     ( template_Resolve( hVarServer,
+                                         pVarTemplate,
+                                         &pVarTemplate->pSpans[i] ) != EOK ) )
+                {
+                    /* the variable may be created later */
+                    result = ENOTSUP;
+                }
+            }
+        }
+
+        if ( ( result == EOK ) ||
+             ( result == ENOTSUP ) )
+        {
+            *ppVarTemplate = pVarTemplate;
+        }
+        else
+        {
+            TEMPLATE_Free( &pVarTemplate );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TEMPLATE_CompileStr                                                       */
+/*!
+    Compile a template string
+
+    The TEMPLATE_CompileStr function compiles a template held in a
+    NUL terminated string into a VarTemplate object.
+
+    @param[in]
+        hVarServer
+            handle to the Variable Server to resolve the variables with
+
+    @param[in]
+        input
+            pointer to the template string
+
+    @param[out]
+        ppVarTemplate
+            pointer to a location to store the compiled template, which
+            must be released with TEMPLATE_Free
+
+    @retval EOK - the template was compiled
+    @retval ENOTSUP - one or more variables could not be resolved yet
+    @retval ENOMEM - memory allocation failed
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int TEMPLATE_CompileStr( VARSERVER_HANDLE hVarServer,
+                         char *input,
+                         VarTemplate **ppVarTemplate )
+{
+    int result = EINVAL;
+    VarTemplate *pVarTemplate = NULL;
+    size_t i;
+
+    if ( ( hVarServer != NULL ) &&
+         ( input != NULL ) &&
+         ( ppVarTemplate != NULL ) )
+    {
+        result = template_New( &pVarTemplate );
+        if ( result == EOK )
+        {
+            result = template_Parse( pVarTemplate, input, strlen( input ) );
+        }
+
+        if ( result == EOK )
+        {
+            for ( i = 0; i < pVarTemplate->numSpans; i++ )
+            {
+                if ( ( pVarTemplate->pSpans[i].isVar == true ) &&
+                     ( template_Resolve( hVarServer,
+                                         pVarTemplate,
+                                         &pVarTemplate->pSpans[i] ) != EOK ) )
+                {
+                    /* the variable may be created later */
+                    result = ENOTSUP;
+                }
+            }
+        }
+
+        if ( ( result == EOK ) ||
+             ( result == ENOTSUP ) )
+        {
+            *ppVarTemplate = pVarTemplate;
+        }
+        else
+        {
+            TEMPLATE_Free( &pVarTemplate );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TEMPLATE_Render                                                           */
+/*!
+    Render a compiled template to an output file
+
+    The TEMPLATE_Render function writes the compiled template to the
+    output file with its variable references replaced by their values.
+    The values which have changed since the last render are fetched in
+    a single batch request.  Variables with a PRINT handler and blobs
+    are printed by the variable server, and password variables are
+    masked.  Variables which could not be resolved when the template
+    was compiled are looked up again, and are left out of the output
+    if they still do not exist.
+
+    @param[in]
+        hVarServer
+            handle to the Variable Server to get the variable values
+
+    @param[in]
+        pVarTemplate
+            pointer to the compiled template
+
+    @param[in]
+        fd
+            output file descriptor to write to
+
+    @retval EOK - output generation was successful
+    @retval ENOTSUP - one or more substitutions failed
+    @retval EIO - the output could not be written
+    @retval ENOMEM - memory allocation failed
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int TEMPLATE_Render( VARSERVER_HANDLE hVarServer,
+                     VarTemplate *pVarTemplate,
+                     int fd )
+{
+    int result = EINVAL;
+    TemplateSpan *pSpan;
+    VarObject obj;
+    FILE *fp = NULL;
+    size_t i;
+    int rc;
+    int fd_dup;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pVarTemplate != NULL ) &&
+         ( fd >= 0 ) )
+    {
+        /* buffer the output on a duplicate of the output descriptor
+           which shares its file offset with the variable server output */
+        fd_dup = dup( fd );
+        if ( fd_dup != -1 )
+        {
+            fp = fdopen( fd_dup, "w" );
+            if ( fp == NULL )
+            {
+                close( fd_dup );
+            }
+        }
+
+        result = ( fp != NULL ) ? EOK : ENOMEM;
+    }
+
+    if ( result == EOK )
+    {
+        /* fetch all of the changed values in one batch */
+        rc = VARCACHE_Refresh( hVarServer, pVarTemplate->pValues );
+        if ( rc == ENOMEM )
+        {
+            result = rc;
+        }
+
+        for ( i = 0;
+              ( result != ENOMEM ) && ( i < pVarTemplate->numSpans );
+              i++ )
+        {
+            pSpan = &pVarTemplate->pSpans[i];
+            if ( pSpan->isVar == false )
+            {
+                fwrite( &pVarTemplate->text[pSpan->offset],
+                        1,
+                        pSpan->len,
+                        fp );
+            }
+            else if ( ( pSpan->hVar == VAR_INVALID ) &&
+                      ( template_Resolve( hVarServer,
+                                          pVarTemplate,
+                                          pSpan ) != EOK ) )
+            {
+                /* could not substitute the variable */
+                result = ENOTSUP;
+            }
+            else if ( pSpan->flags & VARFLAG_PASSWORD )
+            {
+                fputs( "********", fp );
+            }
+            else if ( pSpan->print == true )
+            {
+                /* keep the output in order with the server output */
+                fflush( fp );
+                VAR_Print( hVarServer, pSpan->hVar, fd );
+            }
+            else
+            {
+                memset( &obj, 0, sizeof( VarObject ) );
+                rc = VARCACHE_GetValue( hVarServer,
+                                        pVarTemplate->pValues,
+                                        pSpan->hVar,
+                                        &obj );
+                if ( rc == EOK )
+                {
+                    template_PrintValue( fp, pSpan, &obj );
+                }
+                else
+                {
+                    result = ENOTSUP;
+                }
+
+                if ( ( obj.type == VARTYPE_STR ) ||
+                     ( obj.type == VARTYPE_BLOB ) )
+                {
+                    free( obj.val.blob );
+                }
+            }
+        }
+    }
+
+    if ( ( fp != NULL ) &&
+         ( fclose( fp ) != 0 ) &&
+         ( result == EOK ) )
+    {
+        result = EIO;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TEMPLATE_Notify                                                           */
+/*!
+    Request modification notifications for a compiled template
+
+    The TEMPLATE_Notify function requests a SIG_VAR_MODIFIED
+    notification for every variable referenced by the compiled
+    template, so the caller can render the template again only when
+    one of its variables changes (see TEMPLATE_HasVar).  Variables
+    which are resolved later are registered when they are resolved.
+
+    @param[in]
+        hVarServer
+            handle to the Variable Server
+
+    @param[in]
+        pVarTemplate
+            pointer to the compiled template
+
+    @retval EOK - the notifications were requested
+    @retval EINVAL - invalid arguments
+    @retval other - the notification for a variable could not be requested
+
+==============================================================================*/
+int TEMPLATE_Notify( VARSERVER_HANDLE hVarServer,
+                     VarTemplate *pVarTemplate )
+{
+    int result = EINVAL;
+
+    if ( ( hVarServer != NULL ) &&
+         ( pVarTemplate != NULL ) )
+    {
+        pVarTemplate->notify = true;
+        result = VARCACHE_Map( pVarTemplate->pVars,
+                               template_NotifyVar,
+                               hVarServer );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TEMPLATE_HasVar                                                           */
+/*!
+    Check if a compiled template references a variable
+
+    The TEMPLATE_HasVar function checks if the specified variable is
+    referenced by the compiled template.  It is used to decide if a
+    modification notification requires the template to be rendered
+    again.
+
+    @param[in]
+        pVarTemplate
+            pointer to the compiled template
+
+    @param[in]
+        hVar
+            handle of the variable to look for
+
+    @retval true - the template references the variable
+    @retval false - the template does not reference the variable
+
+==============================================================================*/
+bool TEMPLATE_HasVar( VarTemplate *pVarTemplate, VAR_HANDLE hVar )
+{
+    bool result = false;
+
+    if ( pVarTemplate != NULL )
+    {
+        result = VARCACHE_HasVar( pVarTemplate->pVars, hVar );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TEMPLATE_Free                                                             */
+/*!
+    Release a compiled template
+
+    The TEMPLATE_Free function releases all of the resources of a
+    compiled template.  Any modification notifications which were
+    requested remain registered with the variable server.
+
+    @param[in,out]
+        ppVarTemplate
+            pointer to the location of the compiled template, which is
+            cleared
+
+    @retval EOK - the template was released
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+int TEMPLATE_Free( VarTemplate **ppVarTemplate )
+{
+    int result = EINVAL;
+    VarTemplate *pVarTemplate;
+
+    if ( ( ppVarTemplate != NULL ) &&
+         ( *ppVarTemplate != NULL ) )
+    {
+        pVarTemplate = *ppVarTemplate;
+
+        VARCACHE_Free( &pVarTemplate->pVars );
+        VARCACHE_Free( &pVarTemplate->pValues );
+        free( pVarTemplate->pSpans );
+        free( pVarTemplate->text );
+        free( pVarTemplate );
+
+        *ppVarTemplate = NULL;
+        result = EOK;
+    }
+
+    return result;
+}
+
 /*==============================================================================
         Private Function definitions
 ==============================================================================*/
 
+/*============================================================================*/
+/*  template_New                                                              */
+/*!
+    Create an empty compiled template
+
+    @param[out]
+        ppVarTemplate
+            pointer to a location to store the new compiled template
+
+    @retval EOK - the template was created
+    @retval ENOMEM - memory allocation failed
+
+==============================================================================*/
+static int template_New( VarTemplate **ppVarTemplate )
+{
+    int result = ENOMEM;
+    VarTemplate *pVarTemplate;
+
+    pVarTemplate = calloc( 1, sizeof( VarTemplate ) );
+    if ( pVarTemplate != NULL )
+    {
+        result = VARCACHE_Init( &pVarTemplate->pVars, 0, 0 );
+
+        if ( result == EOK )
+        {
+            result = VARCACHE_Init( &pVarTemplate->pValues, 0, 0 );
+        }
+
+        if ( result == EOK )
+        {
+            result = VARCACHE_EnableValues( pVarTemplate->pValues );
+        }
+
+        if ( result == EOK )
+        {
+            *ppVarTemplate = pVarTemplate;
+        }
+        else
+        {
+            TEMPLATE_Free( &pVarTemplate );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  template_Parse                                                            */
+/*!
+    Parse a chunk of a template into spans
+
+    The template_Parse function splits a chunk of template text into
+    literal text spans and variable reference spans using the same
+    rules as the template engine.  The parser state is kept in the
+    compiled template, so a template can be parsed in several chunks.
+
+    @param[in]
+        pVarTemplate
+            pointer to the compiled template
+
+    @param[in]
+        input
+            pointer to the template text to parse
+
+    @param[in]
+        len
+            length of the template text
+
+    @retval EOK - the template text was parsed
+    @retval ENOMEM - memory allocation failed
+
+==============================================================================*/
+static int template_Parse( VarTemplate *pVarTemplate,
+                           char *input,
+                           size_t len )
+{
+    int result = EOK;
+    size_t i;
+    char c;
+
+    for ( i = 0; ( result == EOK ) && ( i < len ); i++ )
+    {
+        c = input[i];
+
+        switch( pVarTemplate->state )
+        {
+            case 0:
+            default:
+                if ( c == '$' )
+                {
+                    /* possible start of a directive */
+                    pVarTemplate->state = 1;
+                }
+                else
+                {
+                    result = template_AppendLiteral( pVarTemplate, &c, 1 );
+                }
+                break;
+
+            case 1:
+                if ( c == '{' )
+                {
+                    /* start of a variable reference */
+                    result = template_AddSpan( pVarTemplate, true );
+                    pVarTemplate->k = 0;
+                    pVarTemplate->state = 2;
+                }
+                else
+                {
+                    /* the '$' was not part of a directive */
+                    result = template_AppendLiteral( pVarTemplate, "$", 1 );
+                    if ( ( result == EOK ) &&
+                         ( c != '$' ) )
+                    {
+                        result = template_AppendLiteral( pVarTemplate,
+                                                         &c,
+                                                         1 );
+                        pVarTemplate->state = 0;
+                    }
+                }
+                break;
+
+            case 2:
+                if ( ( c == '}' ) ||
+                     ( pVarTemplate->k == TEMPLATE_MAX_VARNAME_LEN ) )
+                {
+                    /* NUL terminate the variable name */
+                    result = template_AppendText( pVarTemplate, "", 1 );
+                    pVarTemplate->state = 0;
+                }
+                else
+                {
+                    result = template_AppendText( pVarTemplate, &c, 1 );
+                    pVarTemplate->k++;
+                }
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  template_AppendText                                                       */
+/*!
+    Append text to the compiled template text buffer
+
+    @param[in]
+        pVarTemplate
+            pointer to the compiled template
+
+    @param[in]
+        text
+            pointer to the text to append
+
+    @param[in]
+        len
+            number of bytes to append
+
+    @retval EOK - the text was appended
+    @retval ENOMEM - memory allocation failed
+
+==============================================================================*/
+static int template_AppendText( VarTemplate *pVarTemplate,
+                                const char *text,
+                                size_t len )
+{
+    int result = EOK;
+    size_t size;
+    char *p;
+
+    if ( pVarTemplate->textLength + len > pVarTemplate->textSize )
+    {
+        size = ( pVarTemplate->textSize > 0 ) ? pVarTemplate->textSize * 2
+                                              : BUFSIZ;
+        while ( size < pVarTemplate->textLength + len )
+        {
+            size *= 2;
+        }
+
+        p = realloc( pVarTemplate->text, size );
+        if ( p != NULL )
+        {
+            pVarTemplate->text = p;
+            pVarTemplate->textSize = size;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        memcpy( &pVarTemplate->text[pVarTemplate->textLength], text, len );
+        pVarTemplate->textLength += len;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  template_AppendLiteral                                                    */
+/*!
+    Append literal text to a compiled template
+
+    The template_AppendLiteral function appends literal text to the
+    last span of the compiled template, or starts a new literal span
+    if the last span is a variable reference.
+
+    @param[in]
+        pVarTemplate
+            pointer to the compiled template
+
+    @param[in]
+        text
+            pointer to the literal text to append
+
+    @param[in]
+        len
+            number of bytes to append
+
+    @retval EOK - the literal text was appended
+    @retval ENOMEM - memory allocation failed
+
+==============================================================================*/
+static int template_AppendLiteral( VarTemplate *pVarTemplate,
+                                   const char *text,
+                                   size_t len )
+{
+    int result = EOK;
+
+    if ( ( pVarTemplate->numSpans == 0 ) ||
+         ( pVarTemplate->pSpans[pVarTemplate->numSpans - 1].isVar == true ) )
+    {
+        result = template_AddSpan( pVarTemplate, false );
+    }
+
+    if ( result == EOK )
+    {
+        result = template_AppendText( pVarTemplate, text, len );
+    }
+
+    if ( result == EOK )
+    {
+        pVarTemplate->pSpans[pVarTemplate->numSpans - 1].len += len;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  template_AddSpan                                                          */
+/*!
+    Start a new span in a compiled template
+
+    The template_AddSpan function adds a new span which starts at the
+    end of the template text buffer.
+
+    @param[in]
+        pVarTemplate
+            pointer to the compiled template
+
+    @param[in]
+        isVar
+            true for a variable reference, false for literal text
+
+    @retval EOK - the span was added
+    @retval ENOMEM - memory allocation failed
+
+==============================================================================*/
+static int template_AddSpan( VarTemplate *pVarTemplate, bool isVar )
+{
+    int result = EOK;
+    TemplateSpan *pSpans;
+    TemplateSpan *pSpan;
+    size_t n;
+
+    if ( pVarTemplate->numSpans == pVarTemplate->maxSpans )
+    {
+        n = pVarTemplate->maxSpans + TEMPLATE_SPANS_GROW_BY;
+        pSpans = realloc( pVarTemplate->pSpans, n * sizeof( TemplateSpan ) );
+        if ( pSpans != NULL )
+        {
+            pVarTemplate->pSpans = pSpans;
+            pVarTemplate->maxSpans = n;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        pSpan = &pVarTemplate->pSpans[pVarTemplate->numSpans++];
+        memset( pSpan, 0, sizeof( TemplateSpan ) );
+        pSpan->offset = pVarTemplate->textLength;
+        pSpan->isVar = isVar;
+        pSpan->hVar = VAR_INVALID;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  template_Resolve                                                          */
+/*!
+    Resolve a variable reference in a compiled template
+
+    The template_Resolve function looks up the variable named by a
+    variable reference span, and records its handle, flags and format
+    specifier so they do not have to be retrieved again on each render.
+    The variable is added to the template's value cache unless it is
+    rendered by the variable server or masked.
+
+    @param[in]
+        hVarServer
+            handle to the Variable Server
+
+    @param[in]
+        pVarTemplate
+            pointer to the compiled template
+
+    @param[in]
+        pSpan
+            pointer to the variable reference span
+
+    @retval EOK - the variable was resolved
+    @retval ENOENT - the variable was not found
+    @retval ENOMEM - memory allocation failed
+
+==============================================================================*/
+static int template_Resolve( VARSERVER_HANDLE hVarServer,
+                             VarTemplate *pVarTemplate,
+                             TemplateSpan *pSpan )
+{
+    int result = ENOENT;
+    VAR_HANDLE hVar;
+    VarInfo info;
+    VarType type = VARTYPE_INVALID;
+    bool known;
+
+    hVar = VAR_FindByName( hVarServer, &pVarTemplate->text[pSpan->offset] );
+    if ( hVar != VAR_INVALID )
+    {
+        memset( &info, 0, sizeof( VarInfo ) );
+        VAR_GetInfo( hVarServer, hVar, &info );
+        VAR_GetType( hVarServer, hVar, &type );
+
+        pSpan->hVar = hVar;
+        pSpan->flags = info.flags;
+        pSpan->print = ( info.notificationType == NOTIFY_PRINT ) ||
+                       ( type == VARTYPE_BLOB ) ||
+                       ( type == VARTYPE_INVALID );
+        memcpy( pSpan->formatspec, info.formatspec, MAX_FORMATSPEC_LEN );
+        pSpan->formatspec[MAX_FORMATSPEC_LEN - 1] = 0;
+
+        known = VARCACHE_HasVar( pVarTemplate->pVars, hVar );
+        result = VARCACHE_AddUnique( pVarTemplate->pVars, hVar );
+
+        if ( ( result == EOK ) &&
+             ( pSpan->print == false ) &&
+             ( ! ( pSpan->flags & VARFLAG_PASSWORD ) ) )
+        {
+            result = VARCACHE_AddUnique( pVarTemplate->pValues, hVar );
+        }
+
+        if ( ( result == EOK ) &&
+             ( known == false ) &&
+             ( pVarTemplate->notify == true ) )
+        {
+            template_NotifyVar( hVar, hVarServer );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  template_NotifyVar                                                        */
+/*!
+    Request a modification notification for a template variable
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        arg
+            handle to the Variable Server
+
+    @retval EOK - the notification was requested
+    @retval other - error from VAR_Notify
+
+==============================================================================*/
+static int template_NotifyVar( VAR_HANDLE hVar, void *arg )
+{
+    return VAR_Notify( (VARSERVER_HANDLE)arg, hVar, NOTIFY_MODIFIED );
+}
+
+/*============================================================================*/
+/*  template_PrintValue                                                       */
+/*!
+    Print a variable value to the template output
+
+    The template_PrintValue function formats a variable value the same
+    way the variable server prints it, using the format specifier
+    recorded when the variable was resolved.
+
+    @param[in]
+        fp
+            output stream
+
+    @param[in]
+        pSpan
+            pointer to the variable reference span
+
+    @param[in]
+        pVarObject
+            pointer to the variable value
+
+    @retval EOK - the value was printed
+    @retval ENOTSUP - the variable type is not supported
+
+==============================================================================*/
+static int template_PrintValue( FILE *fp,
+                                TemplateSpan *pSpan,
+                                VarObject *pVarObject )
+{
+    int result = EOK;
+    char *fmt = pSpan->formatspec;
+
+    switch( pVarObject->type )
+    {
+        case VARTYPE_FLOAT:
+            fprintf( fp, ( fmt[0] == 0 ) ? "%f" : fmt, pVarObject->val.f );
+            break;
+
+        case VARTYPE_STR:
+            fprintf( fp, ( fmt[0] == 0 ) ? "%s" : fmt, pVarObject->val.str );
+            break;
+
+        case VARTYPE_UINT16:
+            fprintf( fp, ( fmt[0] == 0 ) ? "%u" : fmt, pVarObject->val.ui );
+            break;
+
+        case VARTYPE_INT16:
+            fprintf( fp, ( fmt[0] == 0 ) ? "%d" : fmt, pVarObject->val.i );
+            break;
+
+        case VARTYPE_UINT32:
+            fprintf( fp, ( fmt[0] == 0 ) ? "%" PRIu32 : fmt,
+                     pVarObject->val.ul );
+            break;
+
+        case VARTYPE_INT32:
+            fprintf( fp, ( fmt[0] == 0 ) ? "%d" : fmt, pVarObject->val.l );
+            break;
+
+        case VARTYPE_UINT64:
+            fprintf( fp, ( fmt[0] == 0 ) ? "%" PRIu64 : fmt,
+                     pVarObject->val.ull );
+            break;
+
+        case VARTYPE_INT64:
+            fprintf( fp, ( fmt[0] == 0 ) ? "%" PRId64 : fmt,
+                     pVarObject->val.ll );
+            break;
+
+        default:
+            result = ENOTSUP;
+            break;
+    }
+
+    return result;
+}
+
+
 /*============================================================================*/
 /*  ProcessInputChunk                                                         */
 /*!
@@ -481,9 +1473,10 @@ static int CheckStartDirective( TState *pTState, char c )
     If the '{' symbol is found, the template engine state machine is updated
     to begin collecting the variable name characters
 
-    If the '{' symbol is not found, the character is a regular text character
-    and is copied to the output buffer, prefixed with the '$' character which
-    was encountered in the previous iteration.
+    If the '{' symbol is not found, the '$' character which was encountered
+    in the previous iteration is copied to the output buffer.  A second '$'
+    could start a directive, any other character is a regular text
+    character and is copied to the output buffer too.
 
     @param[in]
         pTState
@@ -525,11 +1518,21 @@ static int CheckStartVariable( TState *pTState, char c )
             /* check output buffer overflow */
             CheckOutputBuffer( pTState );
 
-            /* append the character to the output buffer since it
-             * was not part of the variable substitution directive ${ } */
-            pTState->output[pTState->j++] = c;
+            if( c == '$' )
+            {
+                /* this may be the start of a directive */
+                result = EOK;
+            }
+            else
+            {
+                /* append the character to the output buffer since it
+                 * was not part of the variable substitution directive ${ }
+                 * and look for the next directive */
+                pTState->output[pTState->j++] = c;
+                pTState->state = 0;
 
-            result = ENOENT;
+                result = ENOENT;
+            }
         }
     }
 
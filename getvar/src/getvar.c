@@ -37,6 +37,10 @@ SOFTWARE.
     The Get Variable Application gets the value for the specified
     variable from the variable server
 
+    In streaming mode (-s) the application reads variable names from
+    its standard input, one per line, and writes name=value lines for
+    them using batched get requests over a single connection.
+
 */
 /*============================================================================*/
 
@@ -102,8 +106,34 @@ typedef struct _get_var_state
     /*! signal mask */
     sigset_t mask;
 
+    /*! read variable names from the standard input */
+    bool stream;
+
 } GetVarState;
 
+/*! batch of streamed variable names waiting to be retrieved */
+typedef struct _get_var_batch
+{
+    /*! handles of the variables to get */
+    VAR_HANDLE hVars[VARSERVER_MAX_BATCH_ITEMS];
+
+    /*! retrieved variable values */
+    VarObject objs[VARSERVER_MAX_BATCH_ITEMS];
+
+    /*! per-variable results */
+    int results[VARSERVER_MAX_BATCH_ITEMS];
+
+    /*! input lines holding the variable names */
+    char *lines[VARSERVER_MAX_BATCH_ITEMS];
+
+    /*! number of variables in the batch */
+    size_t n;
+
+    /*! number of variables which could not be retrieved */
+    size_t errors;
+
+} GetVarBatch;
+
 /*==============================================================================
         Private file scoped variables
 ==============================================================================*/
@@ -122,6 +152,10 @@ static int GetOutputFileDescriptor( GetVarState *pState );
 static int ProcessQuery( GetVarState *pState );
 static int PrintVar( GetVarState *pState, VAR_HANDLE hVar, int fd );
 static int TimingTest( GetVarState *pState, VAR_HANDLE hVar );
+static int ProcessStream( GetVarState *pState, int fd );
+static int StreamAdd( GetVarState *pState, GetVarBatch *pBatch, char *line );
+static void StreamFlush( GetVarState *pState, GetVarBatch *pBatch, FILE *fp );
+static void StreamValue( FILE *fp, VarObject *pVarObject );
 static int SetUser( GetVarState *pState );
 static int SetupTimer( GetVarState *pState );
 static void CreateTimer( uint32_t timeoutms );
@@ -236,6 +270,7 @@ int main(int argc, char **argv)
     -t : timing test mode
     -N : no newline
     -u : set username (to allow permissions testing)
+    -s : read variable names from the standard input
 
     @param[in]
         argc
@@ -256,7 +291,7 @@ int main(int argc, char **argv)
 ==============================================================================*/
 static int ProcessOptions( int argc, char **argv, GetVarState *pState )
 {
-    const char *options = "hvo:n:d:rcNtu:";
+    const char *options = "hvo:n:d:rcNtsu:";
     int c;
     int errcount = 0;
     bool display_help = false;
@@ -314,6 +349,10 @@ static int ProcessOptions( int argc, char **argv, GetVarState *pState )
                         pState->username = optarg;
                         break;
 
+                    case 's':
+                        pState->stream = true;
+                        break;
+
                     default:
                         errcount++;
                         break;
@@ -326,7 +365,7 @@ static int ProcessOptions( int argc, char **argv, GetVarState *pState )
                 /* get the variable name */
                 pState->varname = argv[optind];
             }
-            else
+            else if( pState->stream == false )
             {
                 errcount++;
             }
@@ -366,7 +405,8 @@ static void usage( char *name )
     {
         printf("usage: %s [-h] [-v] [-c] [-N] [-t] [-n <num>] [-o <outfile> ] "
                "[-u user] "
-               "[-w <wait time>] <variable name>\n\n", name );
+               "[-w <wait time>] <variable name>\n", name );
+        printf("       %s [-h] [-o <outfile>] [-u user] -s\n\n", name );
         printf("-h : display this help\n");
         printf("-v : enable verbose (debugging) output\n");
         printf("-n : specify the number of times to make the query\n");
@@ -377,6 +417,7 @@ static void usage( char *name )
         printf("-c : show query count\n");
         printf("-N : suppress newline\n");
         printf("-u : set user\n");
+        printf("-s : read variable names from standard input\n");
     }
 }
 
@@ -505,7 +546,17 @@ static int ProcessQuery( GetVarState *pState )
         /* get the output file descriptor for the query results */
         fd = GetOutputFileDescriptor( pState );
 
-        if( fd != -1 )
+        if( ( fd != -1 ) && ( pState->stream == true ) )
+        {
+            result = ProcessStream( pState, fd );
+
+            if( fd != STDOUT_FILENO )
+            {
+                /* close the opened file descriptor */
+                close( fd );
+            }
+        }
+        else if( fd != -1 )
         {
             /* get the handle to the specified variable */
             hVar = VAR_FindByName( pState->hVarServer, pState->varname );
@@ -776,5 +827,245 @@ static int TimingTest( GetVarState *pState, VAR_HANDLE hVar )
 
 }
 
+/*============================================================================*/
+/*  ProcessStream                                                             */
+/*!
+    Get variables named on the standard input
+
+    The ProcessStream function reads variable names from the standard
+    input, one per line, and writes a name=value line for each of them
+    to the output file descriptor.  The variables are retrieved in
+    batches of up to VARSERVER_MAX_BATCH_ITEMS per request.  Empty
+    lines and lines starting with '#' are ignored.  Values are written
+    unformatted, so the output can be fed back into setvar -s.
+
+    @param[in]
+        pState
+            pointer to the GetVarState object
+
+    @param[in]
+        fd
+            output file descriptor
+
+    @retval EOK all of the variables were retrieved
+    @retval ENOMEM memory allocation failed
+    @retval ENOENT one or more variables could not be retrieved
+
+==============================================================================*/
+static int ProcessStream( GetVarState *pState, int fd )
+{
+    int result = ENOMEM;
+    GetVarBatch *pBatch;
+    FILE *fp;
+    char *line;
+    size_t len;
+
+    pBatch = calloc( 1, sizeof( GetVarBatch ) );
+    fp = fdopen( dup( fd ), "w" );
+    if ( ( pBatch != NULL ) && ( fp != NULL ) )
+    {
+        result = EOK;
+
+        do
+        {
+            line = NULL;
+            len = 0;
+            if ( getline( &line, &len, stdin ) == -1 )
+            {
+                free( line );
+                line = NULL;
+            }
+            else if ( StreamAdd( pState, pBatch, line ) != EOK )
+            {
+                free( line );
+            }
+
+            if ( ( pBatch->n == VARSERVER_MAX_BATCH_ITEMS ) ||
+                 ( ( line == NULL ) && ( pBatch->n > 0 ) ) )
+            {
+                StreamFlush( pState, pBatch, fp );
+            }
+        } while ( line != NULL );
+
+        if ( pBatch->errors > 0 )
+        {
+            result = ENOENT;
+        }
+    }
+
+    if ( fp != NULL )
+    {
+        fclose( fp );
+    }
+
+    free( pBatch );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StreamAdd                                                                 */
+/*!
+    Add a variable name to the current batch
+
+    The StreamAdd function looks up the variable named on the line and
+    adds it to the batch.  The batch takes ownership of the line until
+    the batch is flushed.
+
+    @param[in]
+        pState
+            pointer to the GetVarState object
+
+    @param[in]
+        pBatch
+            pointer to the batch to add the variable to
+
+    @param[in]
+        line
+            pointer to the line read from the standard input
+
+    @retval EOK the variable was added to the batch
+    @retval ENODATA the line is empty or a comment
+    @retval ENOENT the variable was not found
+
+==============================================================================*/
+static int StreamAdd( GetVarState *pState, GetVarBatch *pBatch, char *line )
+{
+    int result = ENOENT;
+    VAR_HANDLE hVar;
+
+    /* strip the line terminator */
+    line[strcspn( line, "\r\n" )] = '\0';
+
+    if ( ( line[0] == '\0' ) || ( line[0] == '#' ) )
+    {
+        result = ENODATA;
+    }
+    else
+    {
+        hVar = VAR_FindByName( pState->hVarServer, line );
+        if ( hVar != VAR_INVALID )
+        {
+            pBatch->hVars[pBatch->n] = hVar;
+            pBatch->lines[pBatch->n] = line;
+            pBatch->n++;
+            result = EOK;
+        }
+        else
+        {
+            fprintf( stderr, "%s: Variable not found\n", line );
+            pBatch->errors++;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  StreamFlush                                                               */
+/*!
+    Retrieve and output the current batch of variables
+
+    The StreamFlush function gets all of the variables in the batch
+    with a single batched get request, writes a name=value line for
+    each variable which was retrieved, reports the variables which
+    could not be retrieved, and empties the batch.
+
+    @param[in]
+        pState
+            pointer to the GetVarState object
+
+    @param[in]
+        pBatch
+            pointer to the batch to retrieve
+
+    @param[in]
+        fp
+            output stream
+
+==============================================================================*/
+static void StreamFlush( GetVarState *pState, GetVarBatch *pBatch, FILE *fp )
+{
+    VarObject *pVarObject;
+    size_t i;
+
+    /* let the client library allocate the string and blob buffers */
+    memset( pBatch->objs, 0, pBatch->n * sizeof( VarObject ) );
+
+    (void)VAR_GetMany( pState->hVarServer,
+                       pBatch->hVars,
+                       pBatch->objs,
+                       pBatch->results,
+                       pBatch->n );
+
+    for ( i = 0; i < pBatch->n; i++ )
+    {
+        pVarObject = &pBatch->objs[i];
+
+        if ( pBatch->results[i] == EOK )
+        {
+            fprintf( fp, "%s=", pBatch->lines[i] );
+            StreamValue( fp, pVarObject );
+            fputc( '\n', fp );
+        }
+        else
+        {
+            fprintf( stderr,
+                     "%s: GETVAR: %s\n",
+                     pBatch->lines[i],
+                     strerror( pBatch->results[i] ) );
+            pBatch->errors++;
+        }
+
+        if ( pVarObject->type == VARTYPE_STR )
+        {
+            free( pVarObject->val.str );
+        }
+        else if ( pVarObject->type == VARTYPE_BLOB )
+        {
+            free( pVarObject->val.blob );
+        }
+
+        free( pBatch->lines[i] );
+        pBatch->lines[i] = NULL;
+    }
+
+    pBatch->n = 0;
+}
+
+/*============================================================================*/
+/*  StreamValue                                                               */
+/*!
+    Write an unformatted variable value
+
+    The StreamValue function writes the value of a retrieved variable
+    to the output stream without applying its format specifier.
+
+    @param[in]
+        fp
+            output stream
+
+    @param[in]
+        pVarObject
+            pointer to the retrieved variable value
+
+==============================================================================*/
+static void StreamValue( FILE *fp, VarObject *pVarObject )
+{
+    char buf[64];
+
+    if ( pVarObject->type == VARTYPE_STR )
+    {
+        if ( pVarObject->val.str != NULL )
+        {
+            fputs( pVarObject->val.str, fp );
+        }
+    }
+    else if ( VAROBJECT_ToString( pVarObject, buf, sizeof( buf ) ) == EOK )
+    {
+        fputs( buf, fp );
+    }
+}
+
 /*! @}
  * end of getvar group */
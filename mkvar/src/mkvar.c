@@ -37,6 +37,17 @@ SOFTWARE.
     The Make Variable Application creates a new variable in the variable
     server
 
+    With the -m option, the variables are read from a manifest file
+    instead.  Each line of the manifest contains the mkvar options for
+    one variable, for example:
+
+        -t uint32 -n /sys/test/a -v 1 -f volatile
+        -t str -l 64 -n /sys/test/b -v "hello world" -T config
+
+    Blank lines and lines starting with # are ignored.  The variables are
+    sent to the server in large batches so a whole manifest is created
+    in a few requests.
+
 */
 /*============================================================================*/
 
@@ -46,6 +57,7 @@ SOFTWARE.
 
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 #include <errno.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -58,6 +70,18 @@ SOFTWARE.
         Private definitions
 ==============================================================================*/
 
+/*! maximum number of variable definitions created in one batch */
+#define MKVAR_BATCH_SIZE ( 1024 )
+
+/*! working buffer size used to send the manifest batches */
+#define MKVAR_WORKBUF_SIZE ( 256 * 1024 )
+
+/*! maximum number of arguments on a manifest line */
+#define MKVAR_MAX_ARGS ( 64 )
+
+/*! maximum length of a manifest line */
+#define MKVAR_MAX_LINE ( 4096 )
+
 /*! MakeVarState object used to customize the behavior of the application */
 typedef struct _make_var_state
 {
@@ -73,8 +97,31 @@ typedef struct _make_var_state
     /*! verbose mode */
     bool verbose;
 
+    /*! name of the manifest file */
+    char *manifest;
+
 } MakeVarState;
 
+/*! ManifestBatch object holds a batch of manifest variable definitions */
+typedef struct _manifest_batch
+{
+    /*! variable definitions */
+    VarInfo variableInfo[MKVAR_BATCH_SIZE];
+
+    /*! variable values referenced by the definitions */
+    char *value[MKVAR_BATCH_SIZE];
+
+    /*! manifest line number of each definition */
+    int line[MKVAR_BATCH_SIZE];
+
+    /*! result of creating each variable */
+    int results[MKVAR_BATCH_SIZE];
+
+    /*! number of definitions in the batch */
+    size_t count;
+
+} ManifestBatch;
+
 /*==============================================================================
         Private file scoped variables
 ==============================================================================*/
@@ -87,6 +134,13 @@ int main( int argc, char **argv );
 static int ProcessOptions( int argc, char **argv, MakeVarState *pState );
 static void usage( char *name );
 static int MakeVar( MakeVarState *pState );
+static void ReportError( char *name, int result );
+static int MakeVars( MakeVarState *pState );
+static int ParseManifestLine( char *line,
+                              MakeVarState *pState,
+                              MakeVarState *pLineState );
+static int SplitArgs( char *line, char **argv, int maxArgs );
+static int CreateBatch( MakeVarState *pState, ManifestBatch *pBatch );
 
 /*==============================================================================
         Function definitions
@@ -122,12 +176,16 @@ int main(int argc, char **argv)
     /*! process the command line options */
     if( ProcessOptions( argc, argv, &state ) == EOK )
     {
-        /* get a handle to the VAR server */
-        state.hVarServer = VARSERVER_Open();
+        /* get a handle to the VAR server.  A manifest uses a large
+           working buffer to batch the variable definitions */
+        state.hVarServer = ( state.manifest != NULL )
+                            ? VARSERVER_OpenExt( MKVAR_WORKBUF_SIZE )
+                            : VARSERVER_Open();
         if( state.hVarServer != NULL )
         {
-            /* process the vars query */
-            result = MakeVar( &state );
+            /* create the variable(s) */
+            result = ( state.manifest != NULL ) ? MakeVars( &state )
+                                                : MakeVar( &state );
             if ( state.verbose == true )
             {
                 printf( "%s\n", result == EOK ? "EOK" : strerror(result));
@@ -172,6 +230,7 @@ int main(int argc, char **argv)
     -l : variable length (string variables)
     -r : read user list
     -w : write user list
+    -m : manifest of variables to create ('-' for stdin)
     -V : enable verbose output
 
     @param[in]
@@ -193,7 +252,7 @@ int main(int argc, char **argv)
 ==============================================================================*/
 static int ProcessOptions( int argc, char **argv, MakeVarState *pState )
 {
-    const char *options = "hn:i:v:g:f:F:t:T:l:Vr:w:";
+    const char *options = "hn:i:v:g:f:F:t:T:l:Vr:w:m:";
     int c;
     int errcount = 0;
     size_t len;
@@ -227,6 +286,18 @@ static int ProcessOptions( int argc, char **argv, MakeVarState *pState )
                         pState->verbose = true;
                         break;
 
+                    case 'm':
+                        if ( pState->manifest == NULL )
+                        {
+                            pState->manifest = optarg;
+                        }
+                        else
+                        {
+                            fprintf( stderr, "ERR: nested manifest\n");
+                            errcount++;
+                        }
+                        break;
+
                     case 'n':
                         if ( strlen( optarg ) <= MAX_NAME_LEN )
                         {
@@ -375,7 +446,11 @@ static int ProcessOptions( int argc, char **argv, MakeVarState *pState )
 
         if( errcount > 0 )
         {
-            usage( argv[0] );
+            /* errors in a manifest line are reported by line number */
+            if ( pState->manifest == NULL )
+            {
+                usage( argv[0] );
+            }
         }
         else
         {
@@ -443,7 +518,7 @@ static void usage( char *name )
                "[-g <guid>] [-l <length>] "
                "[ -r <readers list> ]"
                "[ -w <writers list> ]"
-               "[-v <value>] [<name>]\n\n", name );
+               "[-v <value>] [-m <manifest>] [<name>]\n\n", name );
         printf("-n : variable name\n");
         printf("-i : variable instance identifier\n");
         printf("-v : variable initial value\n");
@@ -454,7 +529,8 @@ static void usage( char *name )
         printf("-T : variable tags\n");
         printf("-r : readers list (UIDs or Names)\n");
         printf("-w : writers list (UIDs or Names)\n");
-        printf("-l : variable length\n\n");
+        printf("-l : variable length\n");
+        printf("-m : create the variables listed in a manifest file\n\n");
         printf("Note: The name can either be specified using the -n argument ");
         printf("or as the final argument on the command line - but not both\n");
         printf("\n");
@@ -520,21 +596,342 @@ static int MakeVar( MakeVarState *pState )
 
         if ( result != EOK )
         {
+            ReportError( pState->variableInfo.name, result );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReportError                                                               */
+/*!
+    Report a variable creation failure
+
+    The ReportError function describes a variable creation failure on
+    the standard error stream.
+
+    @param[in]
+        name
+            name of the variable which could not be created
+
+    @param[in]
+        result
+            error code from the variable creation
+
+==============================================================================*/
+static void ReportError( char *name, int result )
+{
+    fprintf( stderr, "Failed to create variable: %s : ", name );
+
+    switch( result )
+    {
+        case EEXIST:
+            fprintf( stderr, "Variable already exists\n");
+            break;
+
+        default:
+            fprintf( stderr, "%s\n", strerror( result ) );
+            break;
+    }
+}
+
+/*============================================================================*/
+/*  MakeVars                                                                  */
+/*!
+    Create the variables listed in a manifest
+
+    The MakeVars function reads the variable definitions from the
+    manifest file and creates them in batches of up to MKVAR_BATCH_SIZE
+    variables.  Every line of the manifest is processed even if some
+    of them fail.
+
+    @param[in]
+        pState
+            pointer to the MakeVarState object containing the manifest name
+
+    @retval EOK all of the variables were created
+    @retval ENOMEM not enough memory for a batch
+    @retval other the first error encountered
+
+==============================================================================*/
+static int MakeVars( MakeVarState *pState )
+{
+    int result = EINVAL;
+    int rc;
+    FILE *fp;
+    ManifestBatch *pBatch;
+    MakeVarState lineState;
+    char line[MKVAR_MAX_LINE];
+    int lineno = 0;
+
+    if( ( pState != NULL ) &&
+        ( pState->manifest != NULL ) )
+    {
+        result = EOK;
+
+        fp = ( strcmp( pState->manifest, "-" ) == 0 )
+                ? stdin
+                : fopen( pState->manifest, "r" );
+        pBatch = calloc( 1, sizeof( ManifestBatch ) );
+
+        if( fp == NULL )
+        {
+            result = errno;
             fprintf( stderr,
-                     "Failed to create variable: %s : ",
-                     pState->variableInfo.name );
+                     "ERR: cannot open %s: %s\n",
+                     pState->manifest,
+                     strerror( result ) );
+        }
+        else if( pBatch == NULL )
+        {
+            result = ENOMEM;
+        }
+        else
+        {
+            while( fgets( line, sizeof( line ), fp ) != NULL )
+            {
+                lineno++;
+
+                rc = ParseManifestLine( line, pState, &lineState );
+                if( rc == EOK )
+                {
+                    pBatch->variableInfo[pBatch->count] =
+                                                    lineState.variableInfo;
+                    pBatch->value[pBatch->count] = lineState.value;
+                    pBatch->line[pBatch->count] = lineno;
+                    pBatch->count++;
+                }
+                else if( rc != ENOENT )
+                {
+                    fprintf( stderr,
+                             "ERR: %s line %d is not valid\n",
+                             pState->manifest,
+                             lineno );
+                    free( lineState.value );
+                    result = ( result == EOK ) ? rc : result;
+                }
+
+                if( pBatch->count == MKVAR_BATCH_SIZE )
+                {
+                    rc = CreateBatch( pState, pBatch );
+                    result = ( result == EOK ) ? rc : result;
+                }
+            }
 
-            switch( result )
+            rc = CreateBatch( pState, pBatch );
+            result = ( result == EOK ) ? rc : result;
+        }
+
+        if( ( fp != NULL ) && ( fp != stdin ) )
+        {
+            fclose( fp );
+        }
+
+        free( pBatch );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseManifestLine                                                         */
+/*!
+    Parse the variable definition on a manifest line
+
+    The ParseManifestLine function splits a manifest line into arguments
+    and processes them as mkvar command line options.
+
+    @param[in]
+        line
+            pointer to the manifest line.  The line is modified.
+
+    @param[in]
+        pState
+            pointer to the MakeVarState object for the whole manifest
+
+    @param[out]
+        pLineState
+            pointer to the MakeVarState object to populate with the
+            variable definition
+
+    @retval EOK the line contains a variable definition
+    @retval ENOENT the line is blank or a comment
+    @retval EINVAL the line is not a valid variable definition
+
+==============================================================================*/
+static int ParseManifestLine( char *line,
+                              MakeVarState *pState,
+                              MakeVarState *pLineState )
+{
+    int result = EINVAL;
+    char *argv[MKVAR_MAX_ARGS + 1];
+    int argc;
+
+    memset( pLineState, 0, sizeof( MakeVarState ) );
+    pLineState->manifest = pState->manifest;
+    pLineState->verbose = pState->verbose;
+
+    argv[0] = "mkvar";
+    argc = SplitArgs( line, &argv[1], MKVAR_MAX_ARGS - 1 );
+    if( argc == 0 )
+    {
+        result = ENOENT;
+    }
+    else if( argc > 0 )
+    {
+        argv[argc + 1] = NULL;
+
+        /* restart the option scanner for each line */
+        optind = 0;
+        result = ProcessOptions( argc + 1, argv, pLineState );
+        if( ( result == EOK ) &&
+            ( pLineState->variableInfo.name[0] == '\0' ) )
+        {
+            fprintf( stderr, "ERR: no variable name\n" );
+            result = EINVAL;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SplitArgs                                                                 */
+/*!
+    Split a manifest line into arguments
+
+    The SplitArgs function splits a line into whitespace separated
+    arguments.  An argument containing whitespace can be enclosed in
+    single or double quotes.  Splitting stops at an unquoted # which
+    starts a comment.
+
+    @param[in]
+        line
+            pointer to the line to split.  The line is modified.
+
+    @param[out]
+        argv
+            array of pointers to the arguments
+
+    @param[in]
+        maxArgs
+            maximum number of arguments
+
+    @retval number of arguments
+    @retval -1 there are too many arguments or an unterminated quote
+
+==============================================================================*/
+static int SplitArgs( char *line, char **argv, int maxArgs )
+{
+    int argc = 0;
+    char *p = line;
+    char quote;
+
+    while( argc >= 0 )
+    {
+        while( isspace( (unsigned char)*p ) )
+        {
+            p++;
+        }
+
+        if( ( *p == '\0' ) || ( *p == '#' ) )
+        {
+            break;
+        }
+
+        if( argc == maxArgs )
+        {
+            argc = -1;
+            break;
+        }
+
+        if( ( *p == '"' ) || ( *p == '\'' ) )
+        {
+            quote = *p++;
+            argv[argc++] = p;
+            p = strchr( p, quote );
+            if( p == NULL )
+            {
+                argc = -1;
+                break;
+            }
+        }
+        else
+        {
+            argv[argc++] = p;
+            while( ( *p != '\0' ) && !isspace( (unsigned char)*p ) )
             {
-                case EEXIST:
-                    fprintf( stderr, "Variable already exists\n");
-                    break;
+                p++;
+            }
+
+            if( *p == '\0' )
+            {
+                break;
+            }
+        }
+
+        *p++ = '\0';
+    }
 
-                default:
-                    fprintf( stderr, "%s\n", strerror( result ) );
-                    break;
+    return argc;
+}
+
+/*============================================================================*/
+/*  CreateBatch                                                               */
+/*!
+    Create a batch of manifest variables
+
+    The CreateBatch function requests the variable server to create all
+    of the variables in the batch, reports any which failed, and then
+    empties the batch.
+
+    @param[in]
+        pState
+            pointer to the MakeVarState object for the whole manifest
+
+    @param[in,out]
+        pBatch
+            pointer to the batch of variable definitions
+
+    @retval EOK all of the variables in the batch were created
+    @retval other the first error encountered
+
+==============================================================================*/
+static int CreateBatch( MakeVarState *pState, ManifestBatch *pBatch )
+{
+    int result = EOK;
+    size_t i;
+
+    if( pBatch->count > 0 )
+    {
+        result = VARSERVER_CreateVars( pState->hVarServer,
+                                       pBatch->variableInfo,
+                                       pBatch->results,
+                                       pBatch->count );
+
+        for( i = 0; i < pBatch->count; i++ )
+        {
+            if( pBatch->results[i] != EOK )
+            {
+                fprintf( stderr,
+                         "%s line %d: ",
+                         pState->manifest,
+                         pBatch->line[i] );
+                ReportError( pBatch->variableInfo[i].name,
+                             pBatch->results[i] );
+            }
+            else if( pState->verbose == true )
+            {
+                printf( "Created variable: %s\n",
+                        pBatch->variableInfo[i].name );
             }
+
+            free( pBatch->value[i] );
+            pBatch->value[i] = NULL;
         }
+
+        pBatch->count = 0;
     }
 
     return result;
@@ -37,10 +37,14 @@ SOFTWARE.
 ============================================================================*/
 
 int BlockClient( VarClient *pVarClient, NotificationType notifyType );
-int UnblockClients( VAR_HANDLE hVar,
+int UnblockClients( uint32_t storageRef,
                     NotificationType notifyType,
                     int (*cb)( VarClient *pVarClient, void *arg ),
                     void *arg );
+bool HasBlockedClients( uint32_t storageRef, NotificationType notifyType );
+
+size_t RemoveBlockedClient( VarClient *pVarClient );
 void SetBlockedClientMetric( uint64_t *pMetric );
+void SetBlockedListMaxMetric( uint64_t *pMetric );
 
 #endif
\ No newline at end of file
@@ -30,6 +30,7 @@ SOFTWARE.
 ==============================================================================*/
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <varserver/var.h>
 
@@ -41,14 +42,41 @@ SOFTWARE.
 #define EOK 0
 #endif
 
+/*! function used to check if a hash table object matches a search key */
+typedef bool (*HashMatchFn)( void *object, void *key );
+
+/*! hash table statistics */
+typedef struct _HashStats
+{
+    /*! number of objects in the hash table */
+    size_t count;
+
+    /*! number of slots in the hash table */
+    size_t size;
+
+    /*! number of deleted slots in the hash table */
+    size_t tombstones;
+
+    /*! number of objects still to be migrated from the old table */
+    size_t migrating;
+
+} HashStats;
+
 /*==============================================================================
         Public function declarations
 ==============================================================================*/
 
 int HASH_Init( size_t n );
 
-int HASH_Add( char *name, void *object );
+uint32_t HASH_Key( const char *name, size_t len, uint32_t instanceID );
+
+int HASH_Add( uint32_t hash, void *object );
+
+void *HASH_Find( uint32_t hash, HashMatchFn match, void *key );
+void *HASH_Peek( uint32_t hash, HashMatchFn match, void *key );
+
+int HASH_Delete( uint32_t hash, void *object );
 
-void *HASH_Find( char *name );
+int HASH_GetStats( HashStats *pStats );
 
 #endif
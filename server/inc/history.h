@@ -0,0 +1,67 @@
+/*============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+============================================================================*/
+
+#ifndef HISTORY_H
+#define HISTORY_H
+
+/*============================================================================
+        Includes
+============================================================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <varserver/varserver.h>
+
+/*============================================================================
+        Public definitions
+============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! handle to the history ring of a variable */
+typedef struct _HistoryRing HistoryRing;
+
+/*============================================================================
+        Public function declarations
+============================================================================*/
+
+int HISTORY_Init( void );
+
+HistoryRing *HISTORY_Create( void );
+
+void HISTORY_Delete( HistoryRing *pRing );
+
+size_t HISTORY_Size( HistoryRing *pRing );
+
+void HISTORY_Append( HistoryRing *pRing, const VarObject *pVarObject );
+
+int HISTORY_Fetch( HistoryRing *pRing,
+                   VarType type,
+                   const VarHistoryQuery *pQuery,
+                   void *buf,
+                   size_t len );
+
+#endif
@@ -0,0 +1,75 @@
+/*============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+============================================================================*/
+
+
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+/*============================================================================
+        Includes
+============================================================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <varserver/var.h>
+
+/*============================================================================
+        Public definitions
+============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+#ifndef JOURNAL_COMPACT_SIZE
+/*! journal length which triggers a compaction into the snapshot */
+#define JOURNAL_COMPACT_SIZE ( 4 * 1024 * 1024 )
+#endif
+
+/*! function used to create a statistics metric */
+typedef uint64_t *(*JournalMetricFn)( char *name );
+
+/*============================================================================
+        Public function declarations
+============================================================================*/
+
+int JOURNAL_Replay( const char *path, size_t *pCount );
+
+int JOURNAL_Open( const char *path );
+
+void JOURNAL_Append( const char *name,
+                     uint32_t instanceID,
+                     const VarObject *pVarObject );
+
+void JOURNAL_Define( VAR_HANDLE hVar, VAR_HANDLE hTarget );
+
+int JOURNAL_Flush( void );
+
+int JOURNAL_Reset( void );
+
+size_t JOURNAL_Length( void );
+
+void JOURNAL_SetMetrics( JournalMetricFn fn );
+
+#endif
@@ -30,6 +30,7 @@ SOFTWARE.
 ============================================================================*/
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <varserver/var.h>
 
 /*============================================================================
@@ -72,6 +73,27 @@ SOFTWARE.
     with queue notification */
 #define NOTIFY_MASK_MODIFIED_QUEUE ( 1 << 8 )
 
+/*! bitmask to indicate if a variable has clients
+    with change ring notification */
+#define NOTIFY_MASK_MODIFIED_RING ( 1 << 9 )
+
+/*! bitmask to indicate if a variable has NOTIFY_MODIFIED
+    subscribers with the NOTIFY_OPT_COALESCE option */
+#define NOTIFY_MASK_COALESCE ( 1 << 10 )
+
+/*! bitmask of all the notification mask bits which are derived
+    from the contents of a notification list */
+#define NOTIFY_MASK_TYPES ( NOTIFY_MASK_MODIFIED | \
+                            NOTIFY_MASK_CALC | \
+                            NOTIFY_MASK_VALIDATE | \
+                            NOTIFY_MASK_PRINT | \
+                            NOTIFY_MASK_MODIFIED_QUEUE | \
+                            NOTIFY_MASK_MODIFIED_RING | \
+                            NOTIFY_MASK_COALESCE )
+
+/*! number of notification types (including NOTIFY_NONE) */
+#define NOTIFY_NUM_TYPES ( NOTIFY_MODIFIED_RING + 1 )
+
 /*! The Notification object is used for storing notifications
     associated with each variable */
 typedef struct _Notification
@@ -94,51 +116,131 @@ typedef struct _Notification
     /*! The type of notification being requested */
     NotificationType type;
 
-    /*! pointer to the next notification for this variable */
-    struct _Notification *pNext;
+    /*! NOTIFY_OPT_xxx subscription options */
+    uint32_t options;
+
+    /*! minimum interval between notifications in nanoseconds */
+    uint64_t minInterval;
+
+    /*! minimum change of a numeric value to be notified */
+    double deadband;
+
+    /*! time of the last notification (CLOCK_MONOTONIC nanoseconds) */
+    uint64_t lastSent;
+
+    /*! numeric value at the time of the last notification */
+    double lastValue;
+
+    /*! a rate limited or coalesced change is waiting to be sent */
+    bool deferred;
+
+    /*! NOTIFY_MODIFIED_QUEUE overflow policy */
+    NotifyOverflowPolicy overflow;
+
+    /*! maximum time to wait for room in the queue in nanoseconds */
+    uint64_t blockTimeout;
 
 } Notification;
 
+/*! The NotificationList object stores the notifications associated
+    with a variable in a separate contiguous array for each notification
+    type, so a notification fan-out only visits the subscribers of
+    the type being sent */
+typedef struct _NotificationList
+{
+    /*! notification arrays indexed by notification type */
+    Notification *pEntries[NOTIFY_NUM_TYPES];
+
+    /*! number of notifications in each array */
+    size_t count[NOTIFY_NUM_TYPES];
+
+    /*! allocated capacity of each array */
+    size_t size[NOTIFY_NUM_TYPES];
+
+} NotificationList;
+
+/*! function called by NOTIFY_ForEach for each notification registration */
+typedef int (*NotifyFn)( VAR_HANDLE hVar,
+                         NotificationType type,
+                         pid_t pid,
+                         const VarNotifyOptions *pOptions,
+                         void *arg );
+
 /*==============================================================================
         Public function declarations
 ==============================================================================*/
 
 int NOTIFY_Signal( pid_t pid,
-                   Notification **ppNotification,
+                   NotificationList *pList,
                    NotificationType type,
                    int handle,
                    pid_t *sentTo );
 
-int NOTIFY_Payload( Notification **ppNotification,
+int NOTIFY_Payload( NotificationList *pList,
                     void *buf,
-                    size_t len );
+                    size_t len,
+                    bool deferred,
+                    uint64_t *pDue );
 
-Notification *NOTIFY_Find( Notification *pNotification,
+Notification *NOTIFY_Find( NotificationList *pList,
                            NotificationType type,
                            pid_t pid );
 
-int NOTIFY_Add( Notification **ppNotification,
+int NOTIFY_Add( NotificationList *pList,
                 NotificationType type,
                 VAR_HANDLE hVar,
-                pid_t pid );
+                pid_t pid,
+                const VarNotifyOptions *pOptions );
+
+int NOTIFY_Modified( NotificationList *pList,
+                     VarObject *pVarObject,
+                     bool deferred,
+                     uint64_t *pDue );
+
+void NOTIFY_Rearm( NotificationList *pList, pid_t pid );
+
+uint64_t NOTIFY_Now( void );
+
+void NOTIFY_SetSuppressionMetrics( uint64_t *pCoalesced,
+                                   uint64_t *pRateLimited,
+                                   uint64_t *pDeadband );
+
+void NOTIFY_SetOverflowMetrics( uint64_t *pDropped, uint64_t *pCoalesced );
 
-int NOTIFY_Cancel( Notification **ppNotification,
+void NOTIFY_SetOverflowHandler( void (*handler)( pid_t pid ) );
+
+void NOTIFY_BeginGroup( void );
+
+void NOTIFY_EndGroup( void );
+
+int NOTIFY_Cancel( NotificationList *pList,
                    NotificationType type,
                    VAR_HANDLE hVar,
                    pid_t pid,
                    int *count );
 
-VAR_HANDLE NOTIFY_GetVarHandle( Notification *pNotification,
+size_t NOTIFY_RemovePID( NotificationList *pList, pid_t pid );
+
+VAR_HANDLE NOTIFY_GetVarHandle( NotificationList *pList,
                                 NotificationType type );
 
+pid_t NOTIFY_GetPID( NotificationList *pList, NotificationType type );
+
 int NOTIFY_CheckMove( VAR_HANDLE hVar,
-                      Notification *pSrc,
-                      Notification *pDst );
+                      NotificationList *pSrc,
+                      NotificationList *pDst );
 
 int NOTIFY_Move( VAR_HANDLE hVar,
-                 Notification **ppSrc,
-                 Notification **ppDst );
+                 NotificationList *pSrc,
+                 NotificationList *pDst );
+
+uint16_t NOTIFY_GetMask( NotificationList *pList );
+
+size_t NOTIFY_Size( NotificationList *pList );
 
-uint16_t NOTIFY_GetMask( Notification *pNotification );
+int NOTIFY_ForEach( NotificationList *pList,
+                    VAR_HANDLE hVar,
+                    NotifyFn fn,
+                    void *arg );
 
 #endif
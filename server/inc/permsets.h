@@ -0,0 +1,76 @@
+/*============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+============================================================================*/
+
+#ifndef PERMSETS_H
+#define PERMSETS_H
+
+/*============================================================================
+        Includes
+============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <varserver/var.h>
+
+/*============================================================================
+        Public definitions
+============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! number of group identifiers which can be assigned a permission bit */
+#define PERMSET_MAX_GROUPS      ( 62 )
+
+/*! bits of a permission set which are assigned to group identifiers */
+#define PERMSET_GROUPS          ( ( (uint64_t)1 << PERMSET_MAX_GROUPS ) - 1 )
+
+/*! the client is privileged and may access every variable */
+#define PERMSET_PRIVILEGED      ( (uint64_t)1 << 62 )
+
+/*! the set includes a group identifier which was not assigned a bit */
+#define PERMSET_OVERFLOW        ( (uint64_t)1 << 63 )
+
+/*============================================================================
+        Public function declarations
+============================================================================*/
+
+int PERMSETS_Init( size_t maxClients, uid_t uid );
+
+uint64_t PERMSETS_FromPermissions( const gid_t *gids, size_t n );
+
+uint64_t PERMSETS_Resolve( const gid_t *gids, size_t n );
+
+uint64_t PERMSETS_Generation( void );
+
+int PERMSETS_SetClient( int clientid, const gid_t *gids, int n );
+
+int PERMSETS_Apply( int clientid, VarInfo *pVarInfo );
+
+bool PERMSETS_IsPrivileged( int clientid );
+
+#endif
@@ -0,0 +1,69 @@
+/*============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+============================================================================*/
+
+#ifndef SLAB_H
+#define SLAB_H
+
+/*============================================================================
+        Includes
+============================================================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*============================================================================
+        Public definitions
+============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! handle to a slab allocator size class */
+typedef struct _SlabClass SlabClass;
+
+/*! function used to create a statistics metric */
+typedef uint64_t *(*SlabMetricFn)( char *name );
+
+/*============================================================================
+        Public function declarations
+============================================================================*/
+
+int SLAB_Init( void );
+
+SlabClass *SLAB_Create( const char *name, size_t size );
+
+void *SLAB_Alloc( SlabClass *pClass );
+
+void SLAB_Free( SlabClass *pClass, void *p );
+
+void *SLAB_AllocBuffer( size_t len );
+
+void SLAB_FreeBuffer( void *p, size_t len );
+
+void *SLAB_ResizeBuffer( void *p, size_t oldlen, size_t len );
+
+void SLAB_SetMetrics( SlabMetricFn fn );
+
+#endif
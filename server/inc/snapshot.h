@@ -0,0 +1,59 @@
+/*============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+============================================================================*/
+
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+/*============================================================================
+        Includes
+============================================================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <varserver/var.h>
+
+/*============================================================================
+        Public definitions
+============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*============================================================================
+        Public function declarations
+============================================================================*/
+
+int SNAPSHOT_Save( const char *path, uint32_t options, size_t *pCount );
+int SNAPSHOT_Write( FILE *fp, uint32_t options, size_t *pCount );
+
+int SNAPSHOT_Load( const char *path, size_t *pCount );
+int SNAPSHOT_LoadImage( const void *p, size_t len, size_t *pCount );
+
+int SNAPSHOT_WriteDefinition( FILE *fp, VAR_HANDLE hVar, VAR_HANDLE hTarget );
+int SNAPSHOT_LoadRecord( const void *p, size_t len );
+
+#endif
@@ -0,0 +1,82 @@
+/*============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+============================================================================*/
+
+#ifndef STANDBY_H
+#define STANDBY_H
+
+/*============================================================================
+        Includes
+============================================================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <varserver/var.h>
+
+/*============================================================================
+        Public definitions
+============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! Name of the warm standby arena */
+#define SERVER_STANDBY "/varserver_standby"
+
+/*! Directory holding the POSIX shared memory objects */
+#ifndef STANDBY_SHM_DIR
+#define STANDBY_SHM_DIR "/dev/shm"
+#endif
+
+#ifndef STANDBY_SYNC_INTERVAL_MS
+/*! minimum time between rebuilds of the warm standby arena */
+#define STANDBY_SYNC_INTERVAL_MS ( 100 )
+#endif
+
+/*! function used to create a statistics metric */
+typedef uint64_t *(*StandbyMetricFn)( char *name );
+
+/*============================================================================
+        Public function declarations
+============================================================================*/
+
+int STANDBY_Init( int shard );
+
+int STANDBY_Restore( uint64_t *pStoreID, size_t *pCount );
+
+void STANDBY_SetStoreID( uint64_t storeID );
+
+int STANDBY_Sync( void );
+
+uint64_t STANDBY_Due( void );
+
+void STANDBY_Changed( void );
+
+void STANDBY_Update( uint32_t storageRef,
+                     VAR_HANDLE hVar,
+                     const VarObject *pVarObject );
+
+void STANDBY_SetMetrics( StandbyMetricFn fn );
+
+#endif
@@ -30,6 +30,7 @@ SOFTWARE.
 ============================================================================*/
 
 #include <stdint.h>
+#include <stddef.h>
 #include <sys/types.h>
 #include <unistd.h>
 
@@ -37,6 +38,51 @@ SOFTWARE.
         Public definitions
 ============================================================================*/
 
+#ifndef STATS_MAX_HISTOGRAMS
+/*! maximum number of latency histograms */
+#define STATS_MAX_HISTOGRAMS ( 64 )
+#endif
+
+/*! function used to create a statistics metric */
+typedef uint64_t *(*StatsMetricFn)( char *name );
+
+/*! server memory accounting categories */
+typedef enum _StatsMem
+{
+    /*! variable storage and metadata objects */
+    STATS_MEM_VARIABLES = 0,
+
+    /*! variable alias references */
+    STATS_MEM_ALIASES,
+
+    /*! string variable values */
+    STATS_MEM_STRINGS,
+
+    /*! blob variable values held in the server heap */
+    STATS_MEM_BLOBS,
+
+    /*! notification registrations */
+    STATS_MEM_NOTIFICATIONS,
+
+    /*! blocked client records */
+    STATS_MEM_BLOCKED_CLIENTS,
+
+    /*! validation and calculation transactions */
+    STATS_MEM_TRANSACTIONS,
+
+    /*! search contexts and query subscriptions */
+    STATS_MEM_SEARCH_CONTEXTS,
+
+    /*! variable history rings */
+    STATS_MEM_HISTORY,
+
+    /*! mapped client objects and working buffers */
+    STATS_MEM_CLIENTS,
+
+    /*! number of memory accounting categories */
+    STATS_MEM_END
+
+} StatsMem;
 
 /*============================================================================
         File Scoped Variables
@@ -51,5 +97,12 @@ void STATS_IncrementRequestCount( void );
 void STATS_Process( void );
 void STATS_SetRequestsPerSecPtr( uint64_t *p );
 void STATS_SetTotalRequestsPtr( uint64_t *p );
+void STATS_SetMemoryPtrs( uint64_t *pResident, uint64_t *pResidentPerVar );
+int STATS_NewHistogram( char *prefix, StatsMetricFn fn );
+void STATS_RecordLatency( int histogram, uint64_t ns );
+uint64_t STATS_Now( void );
+void STATS_MemAlloc( StatsMem type, size_t objects, size_t bytes );
+void STATS_MemFree( StatsMem type, size_t objects, size_t bytes );
+void STATS_SetMemMetrics( StatsMetricFn fn );
 
 #endif
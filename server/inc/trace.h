@@ -0,0 +1,71 @@
+/*============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+============================================================================*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/*============================================================================
+        Includes
+============================================================================*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <varserver/varclient.h>
+#include <varserver/varserver.h>
+
+/*============================================================================
+        Public definitions
+============================================================================*/
+
+/*! check if request tracing is enabled.  This is a single load and
+    branch, so it can be used on the request path when tracing is off */
+#define TRACE_ENABLED() ( __builtin_expect( *pTraceEnable != 0, 0 ) )
+
+/*============================================================================
+        Public variables
+============================================================================*/
+
+/*! pointer to the trace enable flag.  This always points to valid
+    memory, even if the trace ring could not be created */
+extern uint32_t *pTraceEnable;
+
+/*============================================================================
+        Public function declarations
+============================================================================*/
+
+int TRACE_Init( int shard );
+
+int TRACE_SetEnable( uint32_t *pEnable );
+
+int TRACE_SetRequestName( int type, const char *name );
+
+void TRACE_Record( TraceEvent event,
+                   int type,
+                   int clientid,
+                   VAR_HANDLE hVar,
+                   int result,
+                   uint64_t timestamp,
+                   uint64_t duration );
+
+#endif
@@ -48,4 +48,6 @@ void *TRANSACTION_Remove( uint32_t transactionID );
 
 void *TRANSACTION_FindByRequestor( pid_t requestor, VAR_HANDLE *hVar );
 
+size_t TRANSACTION_RemoveByRequestor( pid_t requestor );
+
 #endif
\ No newline at end of file
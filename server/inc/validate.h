@@ -30,7 +30,9 @@ SOFTWARE.
 ============================================================================*/
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <varserver/var.h>
+#include <varserver/varclient.h>
 
 /*============================================================================
         Public function declarations
@@ -44,4 +46,26 @@ int VALIDATE_GetRequest( uint32_t requestHandle,
                          pid_t *pPID,
                          VarInfo **ppVarInfo );
 
+int VALIDATE_SetPolicy( pid_t pid, ValidationPolicy *pPolicy );
+
+int VALIDATE_SetDefaultPolicy( ValidationPolicy *pPolicy );
+
+int VALIDATE_RemoveValidator( pid_t pid );
+
+bool VALIDATE_IsBatched( pid_t pid );
+
+void VALIDATE_SetBatchItem( int item );
+
+int VALIDATE_Queue( pid_t validator, uint32_t id, bool *pSignal );
+
+int VALIDATE_Next( pid_t validator, uint32_t *pID, int *pItem );
+
+int VALIDATE_GetItem( uint32_t id, int *pItem );
+
+int VALIDATE_Complete( uint32_t id, int *pItem );
+
+int VALIDATE_Expired( uint64_t now, uint32_t *pID, int *pResponse );
+
+uint64_t VALIDATE_Due( void );
+
 #endif
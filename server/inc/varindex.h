@@ -0,0 +1,69 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+#ifndef VARINDEX_H
+#define VARINDEX_H
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <varserver/var.h>
+
+/*==============================================================================
+        Public definitions
+==============================================================================*/
+
+#ifndef EOK
+#define EOK 0
+#endif
+
+/*! function called for each variable handle found by an index query */
+typedef int (*VarIndexFn)( VAR_HANDLE hVar, void *arg );
+
+/*==============================================================================
+        Public function declarations
+==============================================================================*/
+
+int VARINDEX_Init( size_t n );
+
+int VARINDEX_SetFlags( VAR_HANDLE hVar, uint32_t flags );
+
+int VARINDEX_SetTags( VAR_HANDLE hVar,
+                      uint16_t *pTags,
+                      size_t len,
+                      bool set );
+
+int VARINDEX_Query( int searchType,
+                    uint32_t flags,
+                    uint16_t *pTags,
+                    size_t len,
+                    VAR_HANDLE maxHandle,
+                    VarIndexFn fn,
+                    void *arg );
+
+#endif
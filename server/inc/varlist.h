@@ -30,6 +30,7 @@ SOFTWARE.
 ============================================================================*/
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <sys/types.h>
 #include <unistd.h>
 #include <varserver/var.h>
@@ -38,15 +39,32 @@ SOFTWARE.
         Public definitions
 ============================================================================*/
 
-/*! Maximum number of clients */
+/*! Default maximum number of variables */
 #ifndef VARSERVER_MAX_VARIABLES
 #define VARSERVER_MAX_VARIABLES                 ( 65535 )
 #endif
 
+/*! Upper limit of the configurable maximum number of variables */
+#ifndef VARSERVER_VARIABLE_LIMIT
+#define VARSERVER_VARIABLE_LIMIT                ( 16 * 1024 * 1024 )
+#endif
+
+/*! function called by VARLIST_ForEachNotification for each
+    notification registration */
+typedef int (*VarNotifyFn)( VAR_HANDLE hVar,
+                            NotificationType type,
+                            pid_t pid,
+                            const VarNotifyOptions *pOptions,
+                            void *arg );
+
 /*============================================================================
         Public function declarations
 ============================================================================*/
 
+int VARLIST_Init( size_t capacity );
+size_t VARLIST_Capacity( void );
+size_t VARLIST_Count( void );
+
 int VARLIST_AddNew( VarInfo *pVarInfo, uint32_t *pVarHandle );
 int VARLIST_Alias( VarInfo *pVarInfo, uint32_t *pVarHandle );
 
@@ -66,14 +84,58 @@ int VARLIST_Set( pid_t clientPID,
                  bool *validationInProgress,
                  void *clientInfo );
 
+int VARLIST_CheckSet( pid_t clientPID,
+                      VarInfo *pVarInfo,
+                      bool *pValidate );
+
+int VARLIST_RequestValidation( pid_t clientPID,
+                               VarInfo *pVarInfo,
+                               void *clientInfo );
+
+int VARLIST_Modify( pid_t clientPID,
+                    VarInfo *pVarInfo,
+                    int op,
+                    VarObject *pOperand,
+                    const VarObject *pExpected,
+                    char *buf,
+                    size_t bufsize );
+
+int VARLIST_GetHistory( VarInfo *pVarInfo,
+                        const VarHistoryQuery *pQuery,
+                        char *buf,
+                        size_t bufsize );
+
+int VARLIST_GetLargest( VarInfo *pVarInfo,
+                        VarMemUsage *pUsage,
+                        size_t n,
+                        size_t *pCount );
+
 int VARLIST_GetType( VarInfo *pVarInfo );
 int VARLIST_GetName( VarInfo *pVarInfo );
 int VARLIST_GetLength( VarInfo *pVarInfo );
 int VARLIST_GetFlags( VarInfo *pVarInfo );
 int VARLIST_GetInfo( VarInfo *pVarInfo );
 
-int VARLIST_RequestNotify( VarInfo *pVarInfo, pid_t pid );
+int VARLIST_RequestNotify( VarInfo *pVarInfo,
+                           pid_t pid,
+                           const VarNotifyOptions *pOptions );
 int VARLIST_NotifyCancel( VarInfo *pVarInfo, pid_t pid );
+int VARLIST_ForEachNotification( VarNotifyFn fn, void *arg );
+
+int VARLIST_NotifyQuery( pid_t clientPID,
+                         int searchType,
+                         VarInfo *pVarInfo,
+                         char *searchText,
+                         int *pId );
+int VARLIST_NotifyQueryCancel( pid_t clientPID, int id );
+
+int VARLIST_PurgeClient( pid_t clientPID,
+                         size_t *pNotifications,
+                         size_t *pContexts );
+
+uint64_t VARLIST_SendRateLimited( void );
+uint64_t VARLIST_RateLimitedDue( void );
+void VARLIST_SetCalcMetrics( uint64_t *pCacheHits, uint64_t *pCoalesced );
 
 int VARLIST_GetByHandle( pid_t clientPID,
                          VarInfo *pVarInfo,
@@ -94,13 +156,32 @@ int VARLIST_GetNext( pid_t clientPID,
                      size_t bufsize,
                      int *response );
 
+int VARLIST_GetPage( pid_t clientPID,
+                     int context,
+                     VarInfo *pVarInfo,
+                     char *buf,
+                     size_t bufsize,
+                     int *response );
+
 VarObject *VARLIST_GetObj( VAR_HANDLE hVar );
+const VarObject *VARLIST_PeekObj( VAR_HANDLE hVar );
 
 void VARLIST_SetUser( void );
+void VARLIST_SetGeneration( uint64_t *pCounter );
+void VARLIST_SetReadOnly( bool readOnly );
 
 int VARLIST_SetFlags( VarInfo *pVarInfo );
 int VARLIST_ClearFlags( VarInfo *pVarInfo );
 
+int VARLIST_ShareValue( VarInfo *pVarInfo );
+
+int VARLIST_ShareBlob( VarInfo *pVarInfo );
+
+int VARLIST_CommitBlob( pid_t clientPID, VarInfo *pVarInfo );
+
+void VARLIST_BeginBatch( void );
+void VARLIST_EndBatch( void );
+
 int VARLIST_GetAliases( VarInfo *pVarInfo, VAR_HANDLE *aliases, size_t len );
 
 #endif
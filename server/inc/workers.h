@@ -0,0 +1,51 @@
+/*============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+============================================================================*/
+
+#ifndef WORKERS_H
+#define WORKERS_H
+
+/*============================================================================
+        Includes
+============================================================================*/
+
+#include <stddef.h>
+#include <varserver/varclient.h>
+
+/*============================================================================
+        Public function declarations
+============================================================================*/
+
+int WORKERS_Init( size_t n, void (*fn)( VarClient *pVarClient ) );
+size_t WORKERS_Count( void );
+int WORKERS_Submit( VarClient *pVarClient );
+int WORKERS_Defer( VarClient *pVarClient );
+int WORKERS_GetDeferredFd( void );
+VarClient *WORKERS_NextDeferred( void );
+
+void WORKERS_ReadLock( void );
+void WORKERS_ReadUnlock( void );
+void WORKERS_WriteLock( void );
+void WORKERS_WriteUnlock( void );
+
+#endif
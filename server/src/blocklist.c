@@ -35,7 +35,10 @@ SOFTWARE.
     BlockList
 
     The Block List manages a list of clients which are currently
-    blocked waiting for a transaction to complete.
+    blocked waiting for a transaction to complete.  Blocked clients are
+    kept in a FIFO per variable storage reference, and the FIFOs are
+    stored in a hash table so a completed transaction only examines
+    the clients blocked on its own variable.
 
 */
 /*============================================================================*/
@@ -57,17 +60,22 @@ SOFTWARE.
 #include <string.h>
 #include <varserver/varclient.h>
 #include "blocklist.h"
+#include "stats.h"
 
 /*==============================================================================
         Private definitions
 ==============================================================================*/
 
+/*! number of blocked client hash table buckets (must be a power of 2) */
+#ifndef BLOCKLIST_HASH_SIZE
+#define BLOCKLIST_HASH_SIZE ( 256 )
+#endif
 
 /*==============================================================================
         Private types
 ==============================================================================*/
 
-/*! the RequestHandler object defines a request handler */
+/*! the BlockedClient object tracks a single blocked client */
 typedef struct _BlockedClient
 {
     /*! the type of request this handler is for */
@@ -84,24 +92,53 @@ typedef struct _BlockedClient
 
 } BlockedClient;
 
+/*! the BlockedQueue object is the FIFO of clients blocked on a
+    single VarStorage object */
+typedef struct _BlockedQueue
+{
+    /*! reference to the VarStorage object the clients are blocked on */
+    uint32_t storageRef;
+
+    /*! number of clients in the queue */
+    size_t length;
+
+    /*! first blocked client in the queue */
+    BlockedClient *pHead;
+
+    /*! last blocked client in the queue */
+    BlockedClient *pTail;
+
+    /*! pointer to the next queue in the hash bucket */
+    struct _BlockedQueue *pNext;
+
+} BlockedQueue;
+
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
 
+static BlockedQueue *blocklist_GetQueue( uint32_t storageRef, bool create );
+static void blocklist_ReleaseQueue( BlockedQueue *pQueue );
+
 /*==============================================================================
         Private file scoped variables
 ==============================================================================*/
 
-/*! blocked clients */
-static BlockedClient *blockedClientsHead = NULL;
-static BlockedClient *blockedClientsTail = NULL;
+/*! blocked client queues hashed by storage reference */
+static BlockedQueue *blockedQueues[BLOCKLIST_HASH_SIZE] = { NULL };
 
 /*! list of available BlockedClient objects */
 static BlockedClient *freelist = NULL;
 
+/*! list of available BlockedQueue objects */
+static BlockedQueue *queueFreelist = NULL;
+
 /*! pointer to the blocked client counter */
 static uint64_t *pBlockedClientCount = NULL;
 
+/*! pointer to the maximum blocked client queue length metric */
+static uint64_t *pBlockedListMax = NULL;
+
 /*==============================================================================
         Public function definitions
 ==============================================================================*/
@@ -111,8 +148,8 @@ static uint64_t *pBlockedClientCount = NULL;
 /*!
     Block a client while it waits for a transaction to complete
 
-    The BlockClient function adds the specified client to the
-    end of the blocked client list
+    The BlockClient function adds the specified client to the end
+    of the blocked client queue for the variable it is blocked on
 
     @param[in]
         pVarClient
@@ -130,20 +167,32 @@ static uint64_t *pBlockedClientCount = NULL;
 int BlockClient( VarClient *pVarClient, NotificationType notifyType )
 {
     int result = EINVAL;
-    BlockedClient *pBlockedClient;
+    BlockedClient *pBlockedClient = NULL;
+    BlockedQueue *pQueue;
 
     if( pVarClient != NULL )
     {
-        if( freelist != NULL )
+        pQueue = blocklist_GetQueue( pVarClient->variableInfo.storageRef,
+                                     true );
+        if( pQueue != NULL )
         {
-            /* get a new blocked client object from the free list */
-            pBlockedClient = freelist;
-            freelist = freelist->pNext;
-        }
-        else
-        {
-            /* allocate a new blocked client object */
-            pBlockedClient = calloc( 1, sizeof( BlockedClient ) );
+            if( freelist != NULL )
+            {
+                /* get a new blocked client object from the free list */
+                pBlockedClient = freelist;
+                freelist = freelist->pNext;
+            }
+            else
+            {
+                /* allocate a new blocked client object */
+                pBlockedClient = calloc( 1, sizeof( BlockedClient ) );
+                if( pBlockedClient != NULL )
+                {
+                    STATS_MemAlloc( STATS_MEM_BLOCKED_CLIENTS,
+                                    1,
+                                    sizeof( BlockedClient ) );
+                }
+            }
         }
 
         if( pBlockedClient != NULL )
@@ -154,27 +203,41 @@ int BlockClient( VarClient *pVarClient, NotificationType notifyType )
             pBlockedClient->storageRef = pVarClient->variableInfo.storageRef;
             pBlockedClient->pNext = NULL;
 
-            /* insert the blocked client on the tail of the blocked
-               client list */
-            if ( blockedClientsHead == NULL )
+            /* insert the blocked client on the tail of the
+               variable's blocked client queue */
+            if ( pQueue->pHead == NULL )
             {
-                blockedClientsHead = blockedClientsTail = pBlockedClient;
+                pQueue->pHead = pQueue->pTail = pBlockedClient;
             }
             else
             {
-                blockedClientsTail->pNext = pBlockedClient;
-                blockedClientsTail = pBlockedClient;
+                pQueue->pTail->pNext = pBlockedClient;
+                pQueue->pTail = pBlockedClient;
             }
 
+            pQueue->length++;
+
             if ( pBlockedClientCount != NULL )
             {
                 (*pBlockedClientCount)++;
             }
 
+            if ( ( pBlockedListMax != NULL ) &&
+                 ( pQueue->length > *pBlockedListMax ) )
+            {
+                *pBlockedListMax = pQueue->length;
+            }
+
             result = EOK;
         }
         else
         {
+            if( pQueue != NULL )
+            {
+                /* do not leave an empty queue behind */
+                blocklist_ReleaseQueue( pQueue );
+            }
+
             result = ENOMEM;
         }
     }
@@ -187,11 +250,11 @@ int BlockClient( VarClient *pVarClient, NotificationType notifyType )
 /*!
     Unblock clients which are waiting on the specified variable
 
-    The UnblockClients function iterates through the blocked clients
-    list looking for any clients which are blocked on the specified
-    variable waiting for the specified notification.
+    The UnblockClients function iterates through the blocked client
+    queue of the specified variable, looking for the first client
+    which is waiting for the specified notification.
 
-    Any matching blocked clients are unblocked
+    The matching blocked client is unblocked
 
     @param[in]
         storageRef
@@ -211,99 +274,217 @@ int UnblockClients( uint32_t storageRef,
                     void *arg )
 {
     int result = ENOENT;
-
-    BlockedClient *pBlockedClient = blockedClientsHead;
-    BlockedClient *pPrevClient = blockedClientsHead;
+    BlockedQueue *pQueue;
+    BlockedClient *pBlockedClient = NULL;
+    BlockedClient *pPrevClient = NULL;
     VarClient *pVarClient;
 
+    pQueue = blocklist_GetQueue( storageRef, false );
+    if( pQueue != NULL )
+    {
+        pBlockedClient = pQueue->pHead;
+    }
+
     while( pBlockedClient != NULL )
     {
-        if( pBlockedClient->pVarClient != NULL )
+        pVarClient = pBlockedClient->pVarClient;
+        if( ( pVarClient != NULL ) &&
+            ( pBlockedClient->notifyType == notifyType ) )
         {
-            /* get a pointer to the blocked varclient */
-            pVarClient = pBlockedClient->pVarClient;
-            if( ( pBlockedClient->notifyType == notifyType ) &&
-                ( pBlockedClient->storageRef == storageRef ) )
+            /* found a match */
+            if( pVarClient->debug >= LOG_DEBUG )
+            {
+                printf( "SERVER: unblocking client %d pid(%d)\n",
+                        pVarClient->clientid,
+                        pVarClient->client_pid );
+            }
+
+            if( cb != NULL )
+            {
+                cb( pVarClient, arg );
+            }
+
+            if ( pBlockedClientCount != NULL )
+            {
+                (*pBlockedClientCount)--;
+            }
+
+            /* remove the blocked client from the blocked client queue */
+            if( pPrevClient == NULL )
+            {
+                pQueue->pHead = pBlockedClient->pNext;
+            }
+            else
+            {
+                pPrevClient->pNext = pBlockedClient->pNext;
+            }
+
+            if( pQueue->pTail == pBlockedClient )
             {
-                /* found a match */
-                if( pVarClient->debug >= LOG_DEBUG )
+                pQueue->pTail = pPrevClient;
+            }
+
+            pQueue->length--;
+            if( pQueue->pHead == NULL )
+            {
+                blocklist_ReleaseQueue( pQueue );
+            }
+
+            /* move the blocked client to the free list */
+            pBlockedClient->notifyType = NOTIFY_NONE;
+            pBlockedClient->pVarClient = NULL;
+            pBlockedClient->storageRef = 0;
+
+            /* put the blocked client object back on the free list */
+            pBlockedClient->pNext = freelist;
+            freelist = pBlockedClient;
+
+            /* unblock the client by posting to the client semaphore */
+            sem_post( &pVarClient->sem );
+
+            /* indicate that a client was unblocked */
+            result = EOK;
+
+            break;
+        }
+
+        /* update the pointer to the previous client
+           which is still in the blocked client queue */
+        pPrevClient = pBlockedClient;
+
+        /* move on to the next blocked client */
+        pBlockedClient = pBlockedClient->pNext;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  HasBlockedClients                                                         */
+/*!
+    Check if any clients are waiting on the specified variable
+
+    The HasBlockedClients function checks the blocked client queue of
+    the specified variable for a client which is waiting for the
+    specified notification.
+
+    @param[in]
+        storageRef
+            reference to the VarStorage object to check
+
+    @param[in]
+        notifyType
+            the type of notification to check for
+
+    @retval true there is at least one matching blocked client
+    @retval false there are no matching blocked clients
+
+==============================================================================*/
+bool HasBlockedClients( uint32_t storageRef, NotificationType notifyType )
+{
+    BlockedQueue *pQueue;
+    BlockedClient *pBlockedClient = NULL;
+    bool found = false;
+
+    pQueue = blocklist_GetQueue( storageRef, false );
+    if( pQueue != NULL )
+    {
+        pBlockedClient = pQueue->pHead;
+    }
+
+    while( ( pBlockedClient != NULL ) && ( found == false ) )
+    {
+        if( pBlockedClient->notifyType == notifyType )
+        {
+            found = true;
+        }
+
+        pBlockedClient = pBlockedClient->pNext;
+    }
+
+    return found;
+}
+
+/*============================================================================*/
+/*  RemoveBlockedClient                                                       */
+/*!
+    Remove a client from the blocked client queues
+
+    The RemoveBlockedClient function removes every blocked client entry
+    of the specified client without unblocking it.  It is used when a
+    client has exited, so it is never unblocked after its memory has
+    been released.
+
+    @param[in]
+        pVarClient
+            pointer to the client to remove
+
+    @retval number of blocked client entries removed
+
+==============================================================================*/
+size_t RemoveBlockedClient( VarClient *pVarClient )
+{
+    BlockedQueue *pQueue;
+    BlockedQueue *pNextQueue;
+    BlockedClient **pp;
+    BlockedClient *pBlockedClient;
+    BlockedClient *pPrevClient;
+    size_t count = 0;
+    size_t i;
+
+    for( i = 0; ( pVarClient != NULL ) && ( i < BLOCKLIST_HASH_SIZE ); i++ )
+    {
+        pQueue = blockedQueues[i];
+        while( pQueue != NULL )
+        {
+            pNextQueue = pQueue->pNext;
+            pPrevClient = NULL;
+            pp = &pQueue->pHead;
+
+            while( *pp != NULL )
+            {
+                pBlockedClient = *pp;
+                if( pBlockedClient->pVarClient != pVarClient )
                 {
-                    printf( "SERVER: unblocking client %d pid(%d)\n",
-                            pVarClient->clientid,
-                            pVarClient->client_pid );
+                    pPrevClient = pBlockedClient;
+                    pp = &pBlockedClient->pNext;
+                    continue;
                 }
 
-                if( cb != NULL )
+                /* remove the blocked client from the queue */
+                *pp = pBlockedClient->pNext;
+                if( pQueue->pTail == pBlockedClient )
                 {
-                    cb( pVarClient, arg );
+                    pQueue->pTail = pPrevClient;
                 }
 
+                pQueue->length--;
+
                 if ( pBlockedClientCount != NULL )
                 {
                     (*pBlockedClientCount)--;
                 }
 
-                /* remove the blocked client from the blocked client list */
-                if ( ( pBlockedClient == blockedClientsHead ) &&
-                     ( blockedClientsHead == blockedClientsTail ) )
-                {
-                    blockedClientsHead = blockedClientsTail = NULL;
-                }
-                else if( pBlockedClient == blockedClientsHead )
-                {
-                    /* remove the blocked client from
-                       the head of the blocked client list */
-                    blockedClientsHead = pBlockedClient->pNext;
-                }
-                else if ( pBlockedClient == blockedClientsTail )
-                {
-                    blockedClientsTail = pPrevClient;
-                    blockedClientsTail->pNext = NULL;
-                }
-                else
-                {
-                    /* remove the blocked client from the interior
-                       of the blocked client list */
-                    pPrevClient->pNext = pBlockedClient->pNext;
-                }
-
-                /* move the blocked client to the free list */
+                /* put the blocked client object back on the free list */
                 pBlockedClient->notifyType = NOTIFY_NONE;
                 pBlockedClient->pVarClient = NULL;
                 pBlockedClient->storageRef = 0;
-
-                /* put the blocked client object back on the free list */
                 pBlockedClient->pNext = freelist;
                 freelist = pBlockedClient;
 
-                /* unblock the client by posting to the client semaphore */
-                sem_post( &pVarClient->sem );
-
-                /* indicate that a client was unblocked */
-                result = EOK;
-
-                break;
+                count++;
             }
-            else
-            {
-                /* update the pointer to the previous client
-                   which is still in the blocked client list */
-                pPrevClient = pBlockedClient;
 
-                /* move on to the next blocked client */
-                pBlockedClient = pBlockedClient->pNext;
+            if( pQueue->pHead == NULL )
+            {
+                blocklist_ReleaseQueue( pQueue );
             }
-        }
-        else
-        {
-            pPrevClient = pBlockedClient;
 
-            /* move on to the next blocked client */
-            pBlockedClient = pBlockedClient->pNext;
+            pQueue = pNextQueue;
         }
     }
 
-    return result;
+    return count;
 }
 
 /*============================================================================*/
@@ -325,5 +506,137 @@ void SetBlockedClientMetric( uint64_t *pMetric )
     pBlockedClientCount = pMetric;
 }
 
+/*============================================================================*/
+/*  SetBlockedListMaxMetric                                                   */
+/*!
+    Set up the pointer to the maximum blocked list length metric
+
+    The SetBlockedListMaxMetric sets up a pointer to the metric used to
+    track the largest number of clients that have been blocked on a
+    single variable at the same time
+
+    @param[in]
+        pMetric
+            pointer to the maximum blocked list length metric
+
+==============================================================================*/
+void SetBlockedListMaxMetric( uint64_t *pMetric )
+{
+    pBlockedListMax = pMetric;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  blocklist_GetQueue                                                        */
+/*!
+    Get the blocked client queue for a variable
+
+    The blocklist_GetQueue function looks up the blocked client queue
+    for the specified storage reference, optionally creating it if
+    it does not exist.
+
+    @param[in]
+        storageRef
+            reference to the VarStorage object
+
+    @param[in]
+        create
+            true to create the queue if it does not exist
+
+    @retval pointer to the blocked client queue
+    @retval NULL the queue does not exist or could not be created
+
+==============================================================================*/
+static BlockedQueue *blocklist_GetQueue( uint32_t storageRef, bool create )
+{
+    BlockedQueue **ppBucket;
+    BlockedQueue *pQueue;
+
+    ppBucket = &blockedQueues[storageRef & ( BLOCKLIST_HASH_SIZE - 1 )];
+
+    pQueue = *ppBucket;
+    while( ( pQueue != NULL ) &&
+           ( pQueue->storageRef != storageRef ) )
+    {
+        pQueue = pQueue->pNext;
+    }
+
+    if( ( pQueue == NULL ) &&
+        ( create == true ) )
+    {
+        if( queueFreelist != NULL )
+        {
+            /* get a new queue object from the free list */
+            pQueue = queueFreelist;
+            queueFreelist = queueFreelist->pNext;
+        }
+        else
+        {
+            /* allocate a new queue object */
+            pQueue = calloc( 1, sizeof( BlockedQueue ) );
+            if( pQueue != NULL )
+            {
+                STATS_MemAlloc( STATS_MEM_BLOCKED_CLIENTS,
+                                0,
+                                sizeof( BlockedQueue ) );
+            }
+        }
+
+        if( pQueue != NULL )
+        {
+            pQueue->storageRef = storageRef;
+            pQueue->length = 0;
+            pQueue->pHead = NULL;
+            pQueue->pTail = NULL;
+
+            /* insert the queue into the hash bucket */
+            pQueue->pNext = *ppBucket;
+            *ppBucket = pQueue;
+        }
+    }
+
+    return pQueue;
+}
+
+/*============================================================================*/
+/*  blocklist_ReleaseQueue                                                    */
+/*!
+    Release an empty blocked client queue
+
+    The blocklist_ReleaseQueue function removes an empty blocked client
+    queue from its hash bucket and puts it on the queue free list.
+
+    @param[in]
+        pQueue
+            pointer to the empty queue to release
+
+==============================================================================*/
+static void blocklist_ReleaseQueue( BlockedQueue *pQueue )
+{
+    BlockedQueue **pp;
+
+    pp = &blockedQueues[pQueue->storageRef & ( BLOCKLIST_HASH_SIZE - 1 )];
+    while( ( *pp != NULL ) &&
+           ( *pp != pQueue ) )
+    {
+        pp = &((*pp)->pNext);
+    }
+
+    if( *pp == pQueue )
+    {
+        *pp = pQueue->pNext;
+    }
+
+    pQueue->storageRef = 0;
+    pQueue->length = 0;
+    pQueue->pHead = NULL;
+    pQueue->pTail = NULL;
+    pQueue->pNext = queueFreelist;
+    queueFreelist = pQueue;
+}
+
 /*! @}
  * end of blocklist group */
@@ -0,0 +1,302 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup changering changering
+ * @brief Shared memory change broadcast ring
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file changering.c
+
+    Change Broadcast Ring
+
+    The Change Broadcast Ring module creates the shared memory change ring
+    ( /varserver_changes ).  When a variable with NOTIFY_MODIFIED_RING
+    subscribers changes, its notification payload is written to the ring
+    once, regardless of the number of subscribers, and a single futex
+    wake releases any clients waiting for new records.
+
+    Clients map the ring read-only and keep their own read cursor.  The
+    ring never waits for slow readers: a reader detects that it has been
+    overrun when the head has moved more than the ring size past its
+    cursor.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <varserver/varclient.h>
+#include <varserver/varserver.h>
+#include "changering.h"
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! pointer to the shared change ring */
+static ChangeRing *pChangeRing = NULL;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void changering_Copy( uint64_t offset, const void *src, size_t len );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  CHANGERING_Init                                                           */
+/*!
+    Create the shared change ring
+
+    The CHANGERING_Init function creates the /varserver_changes shared
+    memory object and maps it into the server's address space.  The
+    ring is initially empty.
+
+    @param[in]
+        shard
+            shard index of the server, which is appended to the name
+            of the shared memory object
+
+    @retval EOK the change ring was created
+    @retval ENOMEM the change ring could not be mapped
+    @retval other error from shm_open or ftruncate
+
+==============================================================================*/
+int CHANGERING_Init( int shard )
+{
+    int result = EINVAL;
+    int fd;
+    void *p;
+    char name[BUFSIZ];
+
+    /* get the name of the shared memory object for this shard */
+    ShardName( name, sizeof( name ), SERVER_CHANGERING, shard );
+
+    /* get shared memory file descriptor (NOT a file) */
+    fd = shm_open( name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR );
+    if ( fd != -1 )
+    {
+        /* extend shared memory object as it is initialized with size 0 */
+        if ( ftruncate( fd, sizeof( ChangeRing ) ) != -1 )
+        {
+            /* map shared memory to process address space */
+            p = mmap( NULL,
+                      sizeof( ChangeRing ),
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED,
+                      fd,
+                      0 );
+            if ( p != MAP_FAILED )
+            {
+                /* discard any records left over from a previous server */
+                pChangeRing = (ChangeRing *)p;
+                memset( pChangeRing, 0, sizeof( ChangeRing ) );
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            result = errno;
+        }
+
+        /* close the file descriptor since we don't need it for anything */
+        close( fd );
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CHANGERING_Write                                                          */
+/*!
+    Publish a notification payload on the change ring
+
+    The CHANGERING_Write function writes a notification payload (as
+    prepared for NOTIFY_MODIFIED_QUEUE subscribers) to the change ring
+    as a single record tagged with the variable's storage reference,
+    publishes it by advancing the ring head, and wakes any clients
+    waiting on the ring.
+
+    @param[in]
+        storageRef
+            storage reference of the variable which changed
+
+    @param[in]
+        pPayload
+            pointer to the notification payload.  Any string or blob
+            data immediately follows the VarNotification header
+
+    @param[in]
+        len
+            total length of the notification payload
+
+    @retval EOK the record was published
+    @retval ENOENT the change ring is not available
+    @retval E2BIG the payload is too big for the change ring
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int CHANGERING_Write( uint32_t storageRef,
+                      VarNotification *pPayload,
+                      size_t len )
+{
+    int result = EINVAL;
+    ChangeRecord record;
+    uint64_t head;
+    size_t datalen;
+    size_t size;
+
+    if ( pChangeRing == NULL )
+    {
+        result = ENOENT;
+    }
+    else if ( ( pPayload != NULL ) &&
+              ( len >= sizeof( VarNotification ) ) )
+    {
+        datalen = len - sizeof( VarNotification );
+        size = ( sizeof( ChangeRecord ) + datalen +
+                 VARSERVER_CHANGE_RECORD_ALIGN - 1 ) &
+               ~( (size_t)VARSERVER_CHANGE_RECORD_ALIGN - 1 );
+
+        if ( size <= VARSERVER_CHANGE_RING_SIZE / 2 )
+        {
+            memset( &record, 0, sizeof( record ) );
+            record.size = size;
+            record.storageRef = storageRef;
+            record.hVar = pPayload->hVar;
+            record.len = datalen;
+            record.obj = pPayload->obj;
+
+            /* reserve the space for the record so readers can tell if
+               the record they are reading is being overwritten */
+            head = __atomic_load_n( &pChangeRing->head, __ATOMIC_RELAXED );
+            __atomic_store_n( &pChangeRing->reserve,
+                              head + size,
+                              __ATOMIC_RELAXED );
+            __atomic_thread_fence( __ATOMIC_SEQ_CST );
+
+            /* write the record behind the head where readers
+               will not look for it until it is published */
+            changering_Copy( head, &record, sizeof( record ) );
+            changering_Copy( head + sizeof( record ),
+                             (char *)pPayload + sizeof( VarNotification ),
+                             datalen );
+
+            /* publish the record */
+            __atomic_store_n( &pChangeRing->head,
+                              head + size,
+                              __ATOMIC_RELEASE );
+
+            /* wake up all waiting readers */
+            __atomic_add_fetch( &pChangeRing->seq, 1, __ATOMIC_RELEASE );
+            syscall( SYS_futex,
+                     &pChangeRing->seq,
+                     FUTEX_WAKE,
+                     INT_MAX,
+                     NULL,
+                     NULL,
+                     0 );
+
+            result = EOK;
+        }
+        else
+        {
+            result = E2BIG;
+        }
+    }
+
+    return result;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  changering_Copy                                                           */
+/*!
+    Copy data into the change ring
+
+    The changering_Copy function copies data into the change ring data
+    area at the specified free running offset, wrapping around the end
+    of the data area if required.
+
+    @param[in]
+        offset
+            free running byte offset to write to
+
+    @param[in]
+        src
+            pointer to the data to copy
+
+    @param[in]
+        len
+            number of bytes to copy
+
+==============================================================================*/
+static void changering_Copy( uint64_t offset, const void *src, size_t len )
+{
+    size_t idx = offset & ( VARSERVER_CHANGE_RING_SIZE - 1 );
+    size_t n = VARSERVER_CHANGE_RING_SIZE - idx;
+
+    if ( n > len )
+    {
+        n = len;
+    }
+
+    memcpy( &pChangeRing->data[idx], src, n );
+    memcpy( pChangeRing->data, (const char *)src + n, len - n );
+}
+
+/*! @}
+ * end of changering group */
@@ -35,7 +35,22 @@ SOFTWARE.
     Hash Table Manager
 
     The Hash Table Manager maps variable names to their corresponding
-    VarStorage object.
+    VarID object.
+
+    The hash table is an open addressing (linear probing) table which
+    stores the precomputed hash of each key alongside a pointer to the
+    object.  The keys themselves are not copied, the caller supplies a
+    match function which compares a search key with a candidate object.
+
+    When the table becomes too full, a new table of twice the size is
+    allocated and the entries of the old table are migrated a few at a
+    time on each subsequent table operation, so there is no
+    stop-the-world rehash.  Until the migration is complete, lookups
+    search both tables.
+
+    Deleted entries are replaced with a tombstone so that probe
+    sequences are not broken.  Tombstones are discarded when the table
+    is next resized.
 
 */
 /*============================================================================*/
@@ -47,7 +62,7 @@ SOFTWARE.
 #include <unistd.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <search.h>
+#include <ctype.h>
 #include <errno.h>
 #include "hash.h"
 
@@ -55,14 +70,76 @@ SOFTWARE.
         Private definitions
 ==============================================================================*/
 
+/*! minimum number of slots in the hash table */
+#define HASH_MIN_SIZE ( 64 )
+
+/*! number of old table slots migrated on each table operation */
+#define HASH_MIGRATE_STEP ( 32 )
+
+/*! marker for a deleted hash table entry */
+#define HASH_TOMBSTONE ( (void *)&tombstone )
+
+/*==============================================================================
+        Private types
+==============================================================================*/
+
+/*! hash table entry */
+typedef struct _HashEntry
+{
+    /*! precomputed hash of the object's key */
+    uint32_t hash;
+
+    /*! pointer to the object, NULL if the slot is empty */
+    void *object;
+
+} HashEntry;
+
+/*! hash table */
+typedef struct _HashTable
+{
+    /*! pointer to the hash table slots */
+    HashEntry *pEntries;
+
+    /*! number of slots in the table (a power of two) */
+    size_t size;
+
+    /*! number of objects in the table */
+    size_t count;
+
+    /*! number of deleted slots in the table */
+    size_t tombstones;
+
+} HashTable;
+
 /*==============================================================================
         Private file scoped variables
 ==============================================================================*/
 
+/*! the current hash table */
+static HashTable table;
+
+/*! the previous hash table whose entries are being migrated */
+static HashTable oldTable;
+
+/*! index of the next old table slot to be migrated */
+static size_t migrateIndex = 0;
+
+/*! tombstone marker storage */
+static char tombstone;
+
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
 
+static int hash_Alloc( HashTable *pTable, size_t size );
+static void hash_Insert( HashTable *pTable, uint32_t hash, void *object );
+static HashEntry *hash_Lookup( HashTable *pTable,
+                               uint32_t hash,
+                               HashMatchFn match,
+                               void *key );
+static void hash_Migrate( size_t n );
+static int hash_Grow( void );
+
 /*==============================================================================
         Public function definitions
 ==============================================================================*/
@@ -73,9 +150,8 @@ SOFTWARE.
     Initialize the hash table
 
     The HASH_Init function initializes the hash table and prepares it for
-    the expected number of elements.  The specified expected number
-    should be 25% greater than the real expected number to ensure
-    that collisions are minimized.
+    the expected number of elements.  The table grows automatically if
+    more elements are added.
 
     @param[in]
         n
@@ -89,29 +165,86 @@ SOFTWARE.
 int HASH_Init( size_t n )
 {
     int result = EINVAL;
+    size_t size = HASH_MIN_SIZE;
 
     if ( n > 0 )
     {
-        /* create the hash table with the requested size */
-        result = hcreate( n ) == 0 ? EOK : ENOMEM;
+        /* keep the load factor below 75% */
+        while ( size * 3 < n * 4 )
+        {
+            size <<= 1;
+        }
+
+        result = hash_Alloc( &table, size );
     }
 
     return result;
 }
 
+/*============================================================================*/
+/*  HASH_Key                                                                  */
+/*!
+    Calculate the hash of a variable name
+
+    The HASH_Key function calculates the hash of a variable name and
+    instance identifier.  Variable names are case insensitive.
+
+    @param[in]
+        name
+            name of the variable
+
+    @param[in]
+        len
+            maximum number of characters of the name to hash
+
+    @param[in]
+        instanceID
+            variable instance identifier
+
+    @retval the hash of the variable name
+
+==============================================================================*/
+uint32_t HASH_Key( const char *name, size_t len, uint32_t instanceID )
+{
+    /* FNV-1a */
+    uint32_t h = 2166136261u;
+    size_t i;
+
+    if ( name != NULL )
+    {
+        for ( i = 0; ( i < len ) && ( name[i] != 0 ); i++ )
+        {
+            h ^= (uint32_t)tolower( (unsigned char)name[i] );
+            h *= 16777619u;
+        }
+    }
+
+    h ^= instanceID * 0x9E3779B1u;
+
+    /* final avalanche so the low bits depend on all of the input */
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+
+    return h;
+}
+
 /*============================================================================*/
 /*  HASH_Add                                                                  */
 /*!
     Add an entry to the hash table
 
-    The HASH_Add function adds a new entry to the hash table
+    The HASH_Add function adds a new entry to the hash table.  The
+    object is not copied, and must remain valid while it is in the table.
 
     @param[in]
-        name
-            name of the object (used for object retrieval)
+        hash
+            hash of the object's key
 
     @param[in]
-        entry
+        object
             pointer to an object to add
 
     @retval EOK the object was added ok
@@ -119,28 +252,26 @@ int HASH_Init( size_t n )
     @retval ENOMEM object could not be added
 
 ==============================================================================*/
-int HASH_Add( char *name, void *object )
+int HASH_Add( uint32_t hash, void *object )
 {
     int result = EINVAL;
-    ENTRY e;
 
-    if ( ( name != NULL ) &&
-         ( object != NULL ) )
+    if ( ( object != NULL ) &&
+         ( table.pEntries != NULL ) )
     {
-        e.key = strdup(name);
-        if ( e.key != NULL )
+        result = EOK;
+
+        hash_Migrate( HASH_MIGRATE_STEP );
+
+        /* keep the load factor (including tombstones) below 75% */
+        if ( ( table.count + table.tombstones + 1 ) * 4 > table.size * 3 )
         {
-            e.data = object;
+            result = hash_Grow();
+        }
 
-            if ( hsearch( e, ENTER ) != NULL )
-            {
-                result = EOK;
-            }
-            else
-            {
-                free( e.key );
-                result = ENOMEM;
-            }
+        if ( result == EOK )
+        {
+            hash_Insert( &table, hash, object );
         }
     }
 
@@ -152,37 +283,436 @@ int HASH_Add( char *name, void *object )
 /*!
     Find an object in the hash table
 
-    The HASH_Find function searches for the specified object in the
-    hash table.
+    The HASH_Find function searches for the object matching the specified
+    key in the hash table.  The match function is only called for
+    candidate objects whose precomputed hash matches.
 
     @param[in]
-        name
-            name of the object to find
+        hash
+            hash of the key to find
+
+    @param[in]
+        match
+            function used to compare the key with a candidate object
+
+    @param[in]
+        key
+            key to be passed to the match function
 
     @retval pointer to the object
     @retval NULL if the object cannot be found
 
 ==============================================================================*/
-void *HASH_Find( char *name )
+void *HASH_Find( uint32_t hash, HashMatchFn match, void *key )
 {
     void *p = NULL;
-    ENTRY e;
-    ENTRY *ep;
+    HashEntry *pEntry;
 
-    if ( name != NULL )
+    if ( match != NULL )
     {
-        e.key = name;
+        hash_Migrate( HASH_MIGRATE_STEP );
+
+        pEntry = hash_Lookup( &table, hash, match, key );
+        if ( ( pEntry == NULL ) && ( oldTable.pEntries != NULL ) )
+        {
+            pEntry = hash_Lookup( &oldTable, hash, match, key );
+        }
 
-        /* search for the object in the hash table */
-        ep = hsearch( e, FIND );
-        if ( ep != NULL )
+        if ( pEntry != NULL )
         {
-            p = ep->data;
+            p = pEntry->object;
         }
     }
 
     return p;
 }
 
+/*============================================================================*/
+/*  HASH_Peek                                                                 */
+/*!
+    Find an object in the hash table without modifying it
+
+    The HASH_Peek function searches for the object matching the specified
+    key in the hash table, like HASH_Find, but it does not advance an
+    in-progress table migration.  It may be called concurrently from
+    multiple threads as long as the table is not being modified.
+
+    @param[in]
+        hash
+            hash of the key to find
+
+    @param[in]
+        match
+            function used to compare the key with a candidate object
+
+    @param[in]
+        key
+            key to be passed to the match function
+
+    @retval pointer to the object
+    @retval NULL if the object cannot be found
+
+==============================================================================*/
+void *HASH_Peek( uint32_t hash, HashMatchFn match, void *key )
+{
+    void *p = NULL;
+    HashEntry *pEntry;
+
+    if ( match != NULL )
+    {
+        pEntry = hash_Lookup( &table, hash, match, key );
+        if ( ( pEntry == NULL ) && ( oldTable.pEntries != NULL ) )
+        {
+            pEntry = hash_Lookup( &oldTable, hash, match, key );
+        }
+
+        if ( pEntry != NULL )
+        {
+            p = pEntry->object;
+        }
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  HASH_Delete                                                               */
+/*!
+    Remove an object from the hash table
+
+    The HASH_Delete function removes the specified object from
+    the hash table.
+
+    @param[in]
+        hash
+            hash of the object's key
+
+    @param[in]
+        object
+            pointer to the object to remove
+
+    @retval EOK the object was removed
+    @retval ENOENT the object was not found
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int HASH_Delete( uint32_t hash, void *object )
+{
+    int result = EINVAL;
+    HashTable *tables[2] = { &table, &oldTable };
+    HashTable *pTable;
+    HashEntry *pEntry;
+    size_t mask;
+    size_t idx;
+    size_t i;
+    size_t n;
+
+    if ( object != NULL )
+    {
+        result = ENOENT;
+
+        for ( i = 0; ( i < 2 ) && ( result == ENOENT ); i++ )
+        {
+            pTable = tables[i];
+            if ( pTable->pEntries == NULL )
+            {
+                continue;
+            }
+
+            mask = pTable->size - 1;
+            idx = hash & mask;
+            for ( n = 0; n < pTable->size; n++ )
+            {
+                pEntry = &pTable->pEntries[idx];
+                if ( pEntry->object == NULL )
+                {
+                    break;
+                }
+
+                if ( ( pEntry->object == object ) &&
+                     ( pEntry->hash == hash ) )
+                {
+                    pEntry->object = HASH_TOMBSTONE;
+                    pTable->count--;
+                    pTable->tombstones++;
+                    result = EOK;
+                    break;
+                }
+
+                idx = ( idx + 1 ) & mask;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  HASH_GetStats                                                             */
+/*!
+    Get the hash table statistics
+
+    The HASH_GetStats function gets the current size and occupancy of
+    the hash table.
+
+    @param[out]
+        pStats
+            pointer to the location to store the hash table statistics
+
+    @retval EOK the statistics were retrieved
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int HASH_GetStats( HashStats *pStats )
+{
+    int result = EINVAL;
+
+    if ( pStats != NULL )
+    {
+        pStats->count = table.count + oldTable.count;
+        pStats->size = table.size;
+        pStats->tombstones = table.tombstones;
+        pStats->migrating = oldTable.count;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  hash_Alloc                                                                */
+/*!
+    Allocate the slots for a hash table
+
+    @param[in]
+        pTable
+            pointer to the hash table to initialize
+
+    @param[in]
+        size
+            number of slots (must be a power of two)
+
+    @retval EOK the hash table was allocated
+    @retval ENOMEM the hash table could not be allocated
+
+==============================================================================*/
+static int hash_Alloc( HashTable *pTable, size_t size )
+{
+    int result = ENOMEM;
+
+    pTable->pEntries = calloc( size, sizeof( HashEntry ) );
+    if ( pTable->pEntries != NULL )
+    {
+        pTable->size = size;
+        pTable->count = 0;
+        pTable->tombstones = 0;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  hash_Insert                                                               */
+/*!
+    Insert an object into a hash table
+
+    The hash_Insert function stores the object in the first empty or
+    deleted slot in its probe sequence.  The caller must ensure the
+    table has a free slot.
+
+    @param[in]
+        pTable
+            pointer to the hash table
+
+    @param[in]
+        hash
+            hash of the object's key
+
+    @param[in]
+        object
+            pointer to the object to insert
+
+==============================================================================*/
+static void hash_Insert( HashTable *pTable, uint32_t hash, void *object )
+{
+    size_t mask = pTable->size - 1;
+    size_t idx = hash & mask;
+    HashEntry *pEntry;
+
+    while ( true )
+    {
+        pEntry = &pTable->pEntries[idx];
+        if ( pEntry->object == NULL )
+        {
+            break;
+        }
+
+        if ( pEntry->object == HASH_TOMBSTONE )
+        {
+            pTable->tombstones--;
+            break;
+        }
+
+        idx = ( idx + 1 ) & mask;
+    }
+
+    pEntry->hash = hash;
+    pEntry->object = object;
+    pTable->count++;
+}
+
+/*============================================================================*/
+/*  hash_Lookup                                                               */
+/*!
+    Search a hash table for a matching object
+
+    @param[in]
+        pTable
+            pointer to the hash table to search
+
+    @param[in]
+        hash
+            hash of the key to find
+
+    @param[in]
+        match
+            function used to compare the key with a candidate object
+
+    @param[in]
+        key
+            key to be passed to the match function
+
+    @retval pointer to the matching hash table entry
+    @retval NULL if no match was found
+
+==============================================================================*/
+static HashEntry *hash_Lookup( HashTable *pTable,
+                               uint32_t hash,
+                               HashMatchFn match,
+                               void *key )
+{
+    HashEntry *pResult = NULL;
+    HashEntry *pEntry;
+    size_t mask;
+    size_t idx;
+    size_t n;
+
+    if ( pTable->pEntries != NULL )
+    {
+        mask = pTable->size - 1;
+        idx = hash & mask;
+
+        for ( n = 0; n < pTable->size; n++ )
+        {
+            pEntry = &pTable->pEntries[idx];
+            if ( pEntry->object == NULL )
+            {
+                /* end of the probe sequence */
+                break;
+            }
+
+            if ( ( pEntry->hash == hash ) &&
+                 ( pEntry->object != HASH_TOMBSTONE ) &&
+                 ( match( pEntry->object, key ) == true ) )
+            {
+                pResult = pEntry;
+                break;
+            }
+
+            idx = ( idx + 1 ) & mask;
+        }
+    }
+
+    return pResult;
+}
+
+/*============================================================================*/
+/*  hash_Migrate                                                              */
+/*!
+    Migrate entries from the old hash table to the current table
+
+    The hash_Migrate function moves the entries in the next n slots of
+    the old hash table into the current table.  The old table is freed
+    once all of its slots have been migrated.
+
+    @param[in]
+        n
+            number of old table slots to migrate
+
+==============================================================================*/
+static void hash_Migrate( size_t n )
+{
+    HashEntry *pEntry;
+
+    while ( ( oldTable.pEntries != NULL ) && ( n-- > 0 ) )
+    {
+        pEntry = &oldTable.pEntries[migrateIndex++];
+        if ( ( pEntry->object != NULL ) &&
+             ( pEntry->object != HASH_TOMBSTONE ) )
+        {
+            hash_Insert( &table, pEntry->hash, pEntry->object );
+            oldTable.count--;
+
+            /* leave a tombstone so old table probe sequences still work */
+            pEntry->object = HASH_TOMBSTONE;
+        }
+
+        if ( migrateIndex >= oldTable.size )
+        {
+            /* migration is complete */
+            free( oldTable.pEntries );
+            oldTable.pEntries = NULL;
+            oldTable.size = 0;
+            oldTable.count = 0;
+            oldTable.tombstones = 0;
+            migrateIndex = 0;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  hash_Grow                                                                 */
+/*!
+    Start growing the hash table
+
+    The hash_Grow function replaces the current table with a new empty
+    table of twice the size.  The entries of the current table are
+    migrated incrementally by subsequent table operations.
+
+    @retval EOK the hash table is growing
+    @retval ENOMEM the new table could not be allocated
+
+==============================================================================*/
+static int hash_Grow( void )
+{
+    int result;
+    HashTable newTable;
+    size_t size = table.size;
+
+    /* complete any migration which is still in progress */
+    hash_Migrate( oldTable.size );
+
+    /* if the table is mostly tombstones, rehash at the same size */
+    if ( table.count * 2 >= table.size )
+    {
+        size <<= 1;
+    }
+
+    result = hash_Alloc( &newTable, size );
+    if ( result == EOK )
+    {
+        oldTable = table;
+        table = newTable;
+        migrateIndex = 0;
+    }
+
+    return result;
+}
+
 /*! @}
  * end of hash group */
@@ -0,0 +1,437 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup history history
+ * @brief Per-variable value history rings
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file history.c
+
+    Variable History
+
+    The Variable History module keeps the most recent values of the
+    numeric variables which have the VARFLAG_HISTORY flag set.  Each
+    value is recorded with the time it was set in a fixed size ring of
+    VARSERVER_HISTORY_DEPTH samples.  The rings are allocated from a
+    slab size class when the first value is recorded.
+
+    A window of samples, or the last N samples, can be fetched in a
+    single request, optionally with the minimum, maximum, and mean of
+    the returned samples, instead of subscribing to every change.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include "slab.h"
+#include "history.h"
+#include "stats.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! The HistoryRing object holds the most recent samples of a variable */
+struct _HistoryRing
+{
+    /*! index of the next sample to write */
+    uint32_t head;
+
+    /*! number of samples in the ring */
+    uint32_t count;
+
+    /*! samples, oldest first starting at head once the ring is full */
+    VarHistorySample samples[VARSERVER_HISTORY_DEPTH];
+};
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static double history_Number( VarType type, const VarData *pData );
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! slab size class the history rings are allocated from */
+static SlabClass *pHistorySlab = NULL;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  HISTORY_Init                                                              */
+/*!
+    Initialize the variable history rings
+
+    The HISTORY_Init function creates the slab size class which the
+    history rings are allocated from.  It must be called after SLAB_Init.
+
+    @retval EOK the history rings were initialized
+    @retval ENOMEM the size class could not be created
+
+==============================================================================*/
+int HISTORY_Init( void )
+{
+    pHistorySlab = SLAB_Create( "history", sizeof( HistoryRing ) );
+
+    return ( pHistorySlab != NULL ) ? EOK : ENOMEM;
+}
+
+/*============================================================================*/
+/*  HISTORY_Create                                                            */
+/*!
+    Create a history ring
+
+    The HISTORY_Create function allocates an empty history ring.
+
+    @retval pointer to the new history ring
+    @retval NULL the history ring could not be allocated
+
+==============================================================================*/
+HistoryRing *HISTORY_Create( void )
+{
+    HistoryRing *pRing = NULL;
+
+    if ( pHistorySlab != NULL )
+    {
+        /* slab objects are zero filled, so the ring is empty */
+        pRing = SLAB_Alloc( pHistorySlab );
+        if ( pRing != NULL )
+        {
+            STATS_MemAlloc( STATS_MEM_HISTORY, 1, sizeof( HistoryRing ) );
+        }
+    }
+
+    return pRing;
+}
+
+/*============================================================================*/
+/*  HISTORY_Delete                                                            */
+/*!
+    Delete a history ring
+
+    The HISTORY_Delete function returns a history ring to its slab
+    size class.
+
+    @param[in]
+        pRing
+            pointer to the history ring to delete
+
+==============================================================================*/
+void HISTORY_Delete( HistoryRing *pRing )
+{
+    if ( ( pRing != NULL ) &&
+         ( pHistorySlab != NULL ) )
+    {
+        SLAB_Free( pHistorySlab, pRing );
+        STATS_MemFree( STATS_MEM_HISTORY, 1, sizeof( HistoryRing ) );
+    }
+}
+
+/*============================================================================*/
+/*  HISTORY_Size                                                              */
+/*!
+    Get the memory used by a history ring
+
+    @param[in]
+        pRing
+            pointer to the history ring, or NULL for none
+
+    @retval number of bytes used by the history ring
+
+==============================================================================*/
+size_t HISTORY_Size( HistoryRing *pRing )
+{
+    return ( pRing != NULL ) ? sizeof( HistoryRing ) : 0;
+}
+
+/*============================================================================*/
+/*  HISTORY_Append                                                            */
+/*!
+    Record a variable value
+
+    The HISTORY_Append function stores the value of a numeric variable,
+    and the current time, in its history ring.  Once the ring is full
+    the oldest sample is overwritten.  String and blob values are not
+    recorded.
+
+    @param[in]
+        pRing
+            pointer to the history ring of the variable
+
+    @param[in]
+        pVarObject
+            pointer to the new value of the variable
+
+==============================================================================*/
+void HISTORY_Append( HistoryRing *pRing, const VarObject *pVarObject )
+{
+    VarHistorySample *pSample;
+    struct timespec ts;
+
+    if ( ( pRing != NULL ) &&
+         ( pVarObject != NULL ) &&
+         ( pVarObject->type != VARTYPE_STR ) &&
+         ( pVarObject->type != VARTYPE_BLOB ) )
+    {
+        clock_gettime( CLOCK_REALTIME, &ts );
+
+        pSample = &pRing->samples[pRing->head];
+        pSample->timestamp = (uint64_t)ts.tv_sec * 1000000000ULL +
+                             (uint64_t)ts.tv_nsec;
+        pSample->val = pVarObject->val;
+
+        pRing->head = ( pRing->head + 1 ) % VARSERVER_HISTORY_DEPTH;
+        if ( pRing->count < VARSERVER_HISTORY_DEPTH )
+        {
+            pRing->count++;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  HISTORY_Fetch                                                             */
+/*!
+    Fetch samples from a history ring
+
+    The HISTORY_Fetch function packs the samples selected by a history
+    query into a buffer, as a VarHistory object followed by the
+    samples, oldest first.  The samples in the time window are
+    selected, and limited to the newest pQuery->last samples.  If the
+    VAR_HISTORY_STATS option is specified, the minimum, maximum and
+    mean of the selected samples are calculated.  Only the newest
+    selected samples which fit in the buffer are returned.
+
+    @param[in]
+        pRing
+            pointer to the history ring, or NULL for an empty history
+
+    @param[in]
+        type
+            type of the variable
+
+    @param[in]
+        pQuery
+            pointer to the history query
+
+    @param[out]
+        buf
+            pointer to the buffer to receive the samples
+
+    @param[in]
+        len
+            length of the buffer
+
+    @retval EOK the samples were fetched
+    @retval E2BIG the buffer cannot hold the VarHistory object
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int HISTORY_Fetch( HistoryRing *pRing,
+                   VarType type,
+                   const VarHistoryQuery *pQuery,
+                   void *buf,
+                   size_t len )
+{
+    int result = EINVAL;
+    VarHistory *pHistory = (VarHistory *)buf;
+    VarHistorySample *pOut;
+    VarHistorySample *pSample;
+    uint32_t available = 0;
+    uint32_t first = 0;
+    uint32_t oldest = 0;
+    uint32_t n = 0;
+    uint32_t max;
+    uint32_t i;
+    double sum = 0.0;
+    double x;
+
+    if ( ( pQuery != NULL ) &&
+         ( buf != NULL ) )
+    {
+        result = ( len >= sizeof( VarHistory ) ) ? EOK : E2BIG;
+    }
+
+    if ( result == EOK )
+    {
+        pOut = (VarHistorySample *)&pHistory[1];
+        max = ( len - sizeof( VarHistory ) ) / sizeof( VarHistorySample );
+
+        if ( pRing != NULL )
+        {
+            available = pRing->count;
+            oldest = ( pRing->head + VARSERVER_HISTORY_DEPTH - available ) %
+                     VARSERVER_HISTORY_DEPTH;
+        }
+
+        /* find the samples in the time window, oldest first */
+        for ( i = 0; i < available; i++ )
+        {
+            pSample = &pRing->samples[( oldest + i ) %
+                                      VARSERVER_HISTORY_DEPTH];
+            if ( ( pQuery->end != 0 ) &&
+                 ( pSample->timestamp > pQuery->end ) )
+            {
+                break;
+            }
+
+            if ( pSample->timestamp < pQuery->start )
+            {
+                first = i + 1;
+            }
+        }
+
+        n = i - first;
+
+        /* keep only the newest samples which were asked for */
+        if ( ( pQuery->last != 0 ) && ( n > pQuery->last ) )
+        {
+            first += n - pQuery->last;
+            n = pQuery->last;
+        }
+
+        memset( pHistory, 0, sizeof( VarHistory ) );
+        pHistory->type = type;
+
+        if ( pQuery->options & VAR_HISTORY_STATS )
+        {
+            for ( i = 0; i < n; i++ )
+            {
+                pSample = &pRing->samples[( oldest + first + i ) %
+                                          VARSERVER_HISTORY_DEPTH];
+                x = history_Number( type, &pSample->val );
+                pHistory->min = ( ( i == 0 ) || ( x < pHistory->min ) )
+                                    ? x
+                                    : pHistory->min;
+                pHistory->max = ( ( i == 0 ) || ( x > pHistory->max ) )
+                                    ? x
+                                    : pHistory->max;
+                sum += x;
+            }
+
+            pHistory->mean = ( n > 0 ) ? sum / n : 0.0;
+        }
+
+        /* return the newest of the selected samples which fit */
+        if ( n > max )
+        {
+            first += n - max;
+            n = max;
+        }
+
+        pHistory->count = n;
+
+        for ( i = 0; i < n; i++ )
+        {
+            pOut[i] = pRing->samples[( oldest + first + i ) %
+                                     VARSERVER_HISTORY_DEPTH];
+        }
+    }
+
+    return result;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  history_Number                                                            */
+/*!
+    Convert a sample value to a number
+
+    The history_Number function converts a numeric sample value
+    to a double so the sample statistics can be calculated.
+
+    @param[in]
+        type
+            type of the sample value
+
+    @param[in]
+        pData
+            pointer to the sample value
+
+    @retval the sample value
+
+==============================================================================*/
+static double history_Number( VarType type, const VarData *pData )
+{
+    double x;
+
+    switch( type )
+    {
+        case VARTYPE_UINT16:
+            x = pData->ui;
+            break;
+
+        case VARTYPE_INT16:
+            x = pData->i;
+            break;
+
+        case VARTYPE_UINT32:
+            x = pData->ul;
+            break;
+
+        case VARTYPE_INT32:
+            x = pData->l;
+            break;
+
+        case VARTYPE_UINT64:
+            x = (double)pData->ull;
+            break;
+
+        case VARTYPE_INT64:
+            x = (double)pData->ll;
+            break;
+
+        case VARTYPE_FLOAT:
+            x = pData->f;
+            break;
+
+        default:
+            x = 0.0;
+            break;
+    }
+
+    return x;
+}
+
+/*! @}
+ * end of history group */
@@ -0,0 +1,1200 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup journal journal
+ * @brief Variable change journal
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file journal.c
+
+    Variable Change Journal
+
+    The Variable Change Journal records every change to the value of a
+    non-volatile variable in an append-only file, so the values can be
+    recovered when the server restarts without writing a full snapshot
+    on every change.
+
+    The journal file consists of a JournalHeader followed by a sequence of
+    variable length records.  Each record has a fixed JournalRecord part
+    containing a CRC-32 of the rest of the record, a sequence number, and
+    the variable type and numeric value, followed by the NUL terminated
+    variable name and the string or blob data.  Records are padded to a
+    multiple of 8 bytes.
+
+    Records are collected in memory and written with a single write and
+    fdatasync when the server calls JOURNAL_Flush, so all of the changes
+    made while processing a batch of client requests share one disk
+    synchronization (group commit).
+
+    When the journal is replayed, records are applied in order until the
+    first record which is truncated or fails its CRC check.  That record
+    and everything after it are the remains of an interrupted write, and
+    are removed from the file.
+
+    The definition of each variable or alias created while the journal
+    is open is recorded too, as a snapshot record in the data of a
+    definition record, so the variables created since the last snapshot
+    exist again before their changes are replayed.  The other variable
+    definitions come from the snapshot, and the journal is emptied each
+    time its contents
+    are folded into a new snapshot (compaction).
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <varserver/var.h>
+#include <varserver/varserver.h>
+#include "varlist.h"
+#include "snapshot.h"
+#include "journal.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! journal file identifier ("VJNL") */
+#define JOURNAL_MAGIC ( 0x4C4E4A56 )
+
+/*! journal file format version */
+#define JOURNAL_VERSION ( 1 )
+
+/*! alignment of the journal records */
+#define JOURNAL_ALIGN ( 8 )
+
+/*! initial size of the in-memory record buffer */
+#define JOURNAL_BUFFER_SIZE ( 1024 * 1024 )
+
+/*! name prefix of the variables created by the server itself */
+#define JOURNAL_SERVER_PREFIX "/varserver/"
+
+/*! record of a change to a variable value */
+#define JOURNAL_RECORD_CHANGE ( 0 )
+
+/*! record of a new variable or alias definition */
+#define JOURNAL_RECORD_DEFINE ( 1 )
+
+/*! CRC-32 (IEEE 802.3) reflected polynomial */
+#define JOURNAL_CRC_POLY ( 0xEDB88320U )
+
+/*==============================================================================
+        Private types
+==============================================================================*/
+
+/*! journal file header */
+typedef struct _JournalHeader
+{
+    /*! journal file identifier */
+    uint32_t magic;
+
+    /*! journal file format version */
+    uint16_t version;
+
+    /*! size of the header */
+    uint16_t headerSize;
+
+    /*! reserved for future use */
+    uint64_t reserved;
+
+} JournalHeader;
+
+/*! fixed part of a journal record */
+typedef struct _JournalRecord
+{
+    /*! CRC-32 of the record, starting at the length field */
+    uint32_t crc;
+
+    /*! total length of the record including padding */
+    uint32_t length;
+
+    /*! record sequence number */
+    uint64_t seq;
+
+    /*! variable instance identifier */
+    uint32_t instanceID;
+
+    /*! variable type */
+    uint16_t type;
+
+    /*! length of the name including the NUL terminator */
+    uint16_t nameLen;
+
+    /*! length of the string or blob data */
+    uint32_t dataLen;
+
+    /*! record kind: JOURNAL_RECORD_CHANGE or JOURNAL_RECORD_DEFINE */
+    uint32_t kind;
+
+    /*! numeric variable value */
+    uint64_t value;
+
+} JournalRecord;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static size_t journal_ReplayRecords( const char *p,
+                                     size_t len,
+                                     size_t *pCount );
+
+static bool journal_ValidRecord( const JournalRecord *pRecord, size_t len );
+
+static void journal_AddRecord( uint32_t kind,
+                               const char *name,
+                               size_t nameLen,
+                               uint32_t instanceID,
+                               const VarObject *pVarObject,
+                               const void *data,
+                               size_t dataLen );
+
+static int journal_Apply( const JournalRecord *pRecord );
+
+static int journal_ApplyChange( const JournalRecord *pRecord );
+
+static int journal_Reserve( size_t length );
+
+static int journal_Write( void );
+
+static int journal_WriteHeader( int fd );
+
+static uint32_t journal_CRC32( const void *p, size_t len );
+
+static void journal_UpdateMetrics( void );
+
+/*==============================================================================
+        File scoped variables
+==============================================================================*/
+
+/*! journal file descriptor */
+static int journalFd = -1;
+
+/*! current length of the journal file */
+static size_t journalLength = 0;
+
+/*! sequence number of the last journal record */
+static uint64_t journalSeq = 0;
+
+/*! records waiting to be written to the journal */
+static char *pBuffer = NULL;
+
+/*! size of the record buffer */
+static size_t bufSize = 0;
+
+/*! number of bytes in the record buffer */
+static size_t bufLen = 0;
+
+/*! records have been written since the last fdatasync */
+static bool unsynced = false;
+
+/*! first write error since the last flush */
+static int journalError = EOK;
+
+/*! CRC-32 lookup table */
+static uint32_t crcTable[256];
+
+/*! indicates if the CRC-32 lookup table has been generated */
+static bool crcReady = false;
+
+/*! number of records appended to the journal */
+static uint64_t *pRecordsMetric = NULL;
+
+/*! number of bytes in the journal file */
+static uint64_t *pBytesMetric = NULL;
+
+/*! number of journal disk synchronizations */
+static uint64_t *pSyncsMetric = NULL;
+
+/*! number of times the journal has been compacted */
+static uint64_t *pCompactionsMetric = NULL;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  JOURNAL_Replay                                                            */
+/*!
+    Apply the changes recorded in a journal file
+
+    The JOURNAL_Replay function reads the specified journal file and
+    applies each of its changes to the variable store in order.  Changes
+    to variables which do not exist are skipped.  Replay stops at the
+    first incomplete or corrupt record, and the file is truncated there
+    so new records are appended after the last good one.
+
+    A journal file which does not exist is treated as an empty journal.
+    JOURNAL_Replay must be called before JOURNAL_Open.
+
+    @param[in]
+        path
+            path of the journal file
+
+    @param[out]
+        pCount
+            optional pointer to a location to store the number of
+            changes applied
+
+    @retval EOK the journal was replayed
+    @retval EBADMSG the journal file header is corrupt
+    @retval ENOTSUP the journal file version is not supported
+    @retval EINVAL invalid arguments
+    @retval other error reading the journal file
+
+==============================================================================*/
+int JOURNAL_Replay( const char *path, size_t *pCount )
+{
+    int result = EINVAL;
+    int fd;
+    struct stat sb;
+    void *p = MAP_FAILED;
+    const JournalHeader *pHeader;
+    size_t count = 0;
+    size_t valid;
+
+    if ( path != NULL )
+    {
+        fd = open( path, O_RDWR | O_CLOEXEC );
+        if ( fd == -1 )
+        {
+            result = ( errno == ENOENT ) ? EOK : errno;
+        }
+        else
+        {
+            if ( fstat( fd, &sb ) != 0 )
+            {
+                result = errno;
+            }
+            else if ( sb.st_size == 0 )
+            {
+                /* the header is written by JOURNAL_Open */
+                result = EOK;
+            }
+            else if ( (size_t)sb.st_size < sizeof( JournalHeader ) )
+            {
+                result = EBADMSG;
+            }
+            else
+            {
+                p = mmap( NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+                result = ( p != MAP_FAILED ) ? EOK : errno;
+            }
+
+            if ( p != MAP_FAILED )
+            {
+                madvise( p, sb.st_size, MADV_SEQUENTIAL );
+
+                pHeader = (const JournalHeader *)p;
+                if ( pHeader->magic != JOURNAL_MAGIC )
+                {
+                    result = EBADMSG;
+                }
+                else if ( ( pHeader->version != JOURNAL_VERSION ) ||
+                          ( pHeader->headerSize != sizeof( JournalHeader ) ) )
+                {
+                    result = ENOTSUP;
+                }
+                else
+                {
+                    valid = sizeof( JournalHeader ) +
+                            journal_ReplayRecords( (const char *)&pHeader[1],
+                                                   sb.st_size -
+                                                   sizeof( JournalHeader ),
+                                                   &count );
+
+                    /* discard the remains of an interrupted write */
+                    if ( ( valid < (size_t)sb.st_size ) &&
+                         ( ftruncate( fd, valid ) != 0 ) )
+                    {
+                        result = errno;
+                    }
+                }
+
+                munmap( p, sb.st_size );
+            }
+
+            close( fd );
+        }
+
+        if ( pCount != NULL )
+        {
+            *pCount = count;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  JOURNAL_Open                                                              */
+/*!
+    Open the journal for appending
+
+    The JOURNAL_Open function opens (or creates) the specified journal
+    file so JOURNAL_Append can record variable changes in it.
+
+    @param[in]
+        path
+            path of the journal file
+
+    @retval EOK the journal was opened
+    @retval EALREADY the journal is already open
+    @retval ENOMEM not enough memory for the record buffer
+    @retval EINVAL invalid arguments
+    @retval other error opening the journal file
+
+==============================================================================*/
+int JOURNAL_Open( const char *path )
+{
+    int result = EINVAL;
+    int fd;
+    struct stat sb;
+
+    if ( journalFd != -1 )
+    {
+        result = EALREADY;
+    }
+    else if ( path != NULL )
+    {
+        pBuffer = malloc( JOURNAL_BUFFER_SIZE );
+        fd = open( path,
+                   O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC,
+                   S_IRUSR | S_IWUSR );
+        if ( pBuffer == NULL )
+        {
+            result = ENOMEM;
+        }
+        else if ( fd == -1 )
+        {
+            result = errno;
+        }
+        else if ( fstat( fd, &sb ) != 0 )
+        {
+            result = errno;
+        }
+        else if ( (size_t)sb.st_size < sizeof( JournalHeader ) )
+        {
+            /* start a new journal */
+            result = journal_WriteHeader( fd );
+            journalLength = sizeof( JournalHeader );
+        }
+        else
+        {
+            result = EOK;
+            journalLength = sb.st_size;
+        }
+
+        if ( result == EOK )
+        {
+            journalFd = fd;
+            bufSize = JOURNAL_BUFFER_SIZE;
+            bufLen = 0;
+            journal_UpdateMetrics();
+        }
+        else
+        {
+            if ( fd != -1 )
+            {
+                close( fd );
+            }
+
+            free( pBuffer );
+            pBuffer = NULL;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  JOURNAL_Append                                                            */
+/*!
+    Record a variable change in the journal
+
+    The JOURNAL_Append function adds a record of the new value of a
+    variable to the in-memory record buffer.  The record is not durable
+    until JOURNAL_Flush is called.  Nothing is recorded if the journal
+    is not open, or for the server's own /varserver/ variables.
+
+    @param[in]
+        name
+            name of the changed variable
+
+    @param[in]
+        instanceID
+            instance identifier of the changed variable
+
+    @param[in]
+        pVarObject
+            pointer to the new value of the variable
+
+==============================================================================*/
+void JOURNAL_Append( const char *name,
+                     uint32_t instanceID,
+                     const VarObject *pVarObject )
+{
+    const void *data = NULL;
+    size_t dataLen = 0;
+
+    if ( ( journalFd != -1 ) &&
+         ( name != NULL ) &&
+         ( pVarObject != NULL ) &&
+         ( strncmp( name,
+                    JOURNAL_SERVER_PREFIX,
+                    sizeof( JOURNAL_SERVER_PREFIX ) - 1 ) != 0 ) )
+    {
+        if ( ( pVarObject->type == VARTYPE_STR ) &&
+             ( pVarObject->val.str != NULL ) )
+        {
+            data = pVarObject->val.str;
+            dataLen = strlen( pVarObject->val.str ) + 1;
+        }
+        else if ( ( pVarObject->type == VARTYPE_BLOB ) &&
+                  ( pVarObject->val.blob != NULL ) )
+        {
+            data = pVarObject->val.blob;
+            dataLen = pVarObject->len;
+        }
+
+        journal_AddRecord( JOURNAL_RECORD_CHANGE,
+                           name,
+                           strlen( name ) + 1,
+                           instanceID,
+                           pVarObject,
+                           data,
+                           dataLen );
+    }
+}
+
+/*============================================================================*/
+/*  JOURNAL_Define                                                            */
+/*!
+    Record a new variable definition in the journal
+
+    The JOURNAL_Define function adds a record of the definition of a new
+    variable or alias to the in-memory record buffer, so the variable is
+    created again when the journal is replayed.  The definition is held
+    as a snapshot record.  Nothing is recorded if the journal is not open,
+    or for the server's own /varserver/ variables.
+
+    @param[in]
+        hVar
+            handle of the new variable or alias
+
+    @param[in]
+        hTarget
+            handle of the aliased variable, or VAR_INVALID for a
+            new variable
+
+==============================================================================*/
+void JOURNAL_Define( VAR_HANDLE hVar, VAR_HANDLE hTarget )
+{
+    int result = ENOMEM;
+    FILE *fp;
+    char *p = NULL;
+    size_t len = 0;
+    const SnapshotRecord *pRecord;
+    size_t nameLen;
+
+    if ( journalFd != -1 )
+    {
+        fp = open_memstream( &p, &len );
+        if ( fp != NULL )
+        {
+            result = SNAPSHOT_WriteDefinition( fp, hVar, hTarget );
+            if ( ( fclose( fp ) != 0 ) && ( result == EOK ) )
+            {
+                result = ENOMEM;
+            }
+        }
+
+        if ( ( result == EOK ) && ( len >= sizeof( SnapshotRecord ) ) )
+        {
+            /* the name is padded so the snapshot record stays aligned */
+            pRecord = (const SnapshotRecord *)p;
+            nameLen = ( pRecord->nameLen + JOURNAL_ALIGN - 1 ) &
+                      ~( (size_t)JOURNAL_ALIGN - 1 );
+
+            journal_AddRecord( JOURNAL_RECORD_DEFINE,
+                               (const char *)&pRecord[1],
+                               nameLen,
+                               pRecord->instanceID,
+                               NULL,
+                               p,
+                               len );
+        }
+        else if ( result != EOK )
+        {
+            /* report the lost definition when the journal is flushed */
+            journalError = result;
+        }
+
+        free( p );
+    }
+}
+
+/*============================================================================*/
+/*  JOURNAL_Flush                                                             */
+/*!
+    Make the recorded changes durable
+
+    The JOURNAL_Flush function writes the buffered records to the journal
+    file and synchronizes it with the disk, so every change recorded since
+    the previous flush is committed by a single fdatasync.
+
+    @retval EOK the recorded changes are durable (or there were none)
+    @retval other error writing the journal, some changes may be lost
+
+==============================================================================*/
+int JOURNAL_Flush( void )
+{
+    int result = EOK;
+
+    if ( journalFd != -1 )
+    {
+        journal_Write();
+
+        if ( unsynced == true )
+        {
+            if ( fdatasync( journalFd ) != 0 )
+            {
+                journalError = errno;
+            }
+
+            unsynced = false;
+
+            if ( pSyncsMetric != NULL )
+            {
+                (*pSyncsMetric)++;
+            }
+        }
+
+        result = journalError;
+        journalError = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  JOURNAL_Reset                                                             */
+/*!
+    Empty the journal
+
+    The JOURNAL_Reset function discards all of the journal records, and
+    is called once the current variable values have been written to a
+    new snapshot.  Any records which are still buffered are discarded
+    too, since their values are also in the snapshot.
+
+    @retval EOK the journal was emptied
+    @retval EBADF the journal is not open
+    @retval other error truncating the journal file
+
+==============================================================================*/
+int JOURNAL_Reset( void )
+{
+    int result = EBADF;
+
+    if ( journalFd != -1 )
+    {
+        bufLen = 0;
+        journalError = EOK;
+
+        result = EOK;
+        if ( ( ftruncate( journalFd, sizeof( JournalHeader ) ) != 0 ) ||
+             ( fdatasync( journalFd ) != 0 ) )
+        {
+            result = errno;
+        }
+        else
+        {
+            journalLength = sizeof( JournalHeader );
+            unsynced = false;
+
+            if ( pCompactionsMetric != NULL )
+            {
+                (*pCompactionsMetric)++;
+            }
+        }
+
+        journal_UpdateMetrics();
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  JOURNAL_Length                                                            */
+/*!
+    Get the length of the journal
+
+    The JOURNAL_Length function gets the number of bytes written to the
+    journal file, which is used to decide when to compact it.
+
+    @retval number of bytes in the journal file
+
+==============================================================================*/
+size_t JOURNAL_Length( void )
+{
+    return journalLength;
+}
+
+/*============================================================================*/
+/*  JOURNAL_SetMetrics                                                        */
+/*!
+    Set up the journal metrics
+
+    The JOURNAL_SetMetrics function creates the journal record, size,
+    synchronization, and compaction metrics using the specified metric
+    creation function.
+
+    @param[in]
+        fn
+            function used to create a metric
+
+==============================================================================*/
+void JOURNAL_SetMetrics( JournalMetricFn fn )
+{
+    if ( fn != NULL )
+    {
+        pRecordsMetric = fn( "/varserver/stats/journal_records" );
+        pBytesMetric = fn( "/varserver/stats/journal_bytes" );
+        pSyncsMetric = fn( "/varserver/stats/journal_syncs" );
+        pCompactionsMetric = fn( "/varserver/stats/journal_compactions" );
+        journal_UpdateMetrics();
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  journal_ReplayRecords                                                     */
+/*!
+    Apply the journal records
+
+    The journal_ReplayRecords function walks the journal records and
+    applies each one to the variable store, stopping at the first
+    record which is not valid.
+
+    @param[in]
+        p
+            pointer to the first journal record
+
+    @param[in]
+        len
+            number of bytes following the journal header
+
+    @param[out]
+        pCount
+            pointer to a location to store the number of changes applied
+
+    @retval number of bytes of valid records
+
+==============================================================================*/
+static size_t journal_ReplayRecords( const char *p,
+                                     size_t len,
+                                     size_t *pCount )
+{
+    size_t offset = 0;
+    const JournalRecord *pRecord;
+
+    while ( journal_ValidRecord( (const JournalRecord *)&p[offset],
+                                 len - offset ) )
+    {
+        pRecord = (const JournalRecord *)&p[offset];
+        if ( journal_Apply( pRecord ) == EOK )
+        {
+            (*pCount)++;
+        }
+
+        journalSeq = pRecord->seq;
+        offset += pRecord->length;
+    }
+
+    return offset;
+}
+
+/*============================================================================*/
+/*  journal_ValidRecord                                                       */
+/*!
+    Check a journal record
+
+    The journal_ValidRecord function checks that a journal record is
+    complete, follows the previous record, and passes its CRC check.
+
+    @param[in]
+        pRecord
+            pointer to the journal record
+
+    @param[in]
+        len
+            number of bytes remaining in the journal
+
+    @retval true the record is valid
+    @retval false the record is truncated or corrupt
+
+==============================================================================*/
+static bool journal_ValidRecord( const JournalRecord *pRecord, size_t len )
+{
+    bool result = false;
+
+    if ( ( len >= sizeof( JournalRecord ) ) &&
+         ( pRecord->length >= sizeof( JournalRecord ) ) &&
+         ( pRecord->length <= len ) &&
+         ( pRecord->length % JOURNAL_ALIGN == 0 ) &&
+         ( pRecord->seq > journalSeq ) &&
+         ( pRecord->nameLen > 0 ) &&
+         ( sizeof( JournalRecord ) + pRecord->nameLen + pRecord->dataLen
+                <= pRecord->length ) )
+    {
+        result = ( journal_CRC32( &pRecord->length,
+                                  pRecord->length - sizeof( pRecord->crc ) )
+                        == pRecord->crc );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  journal_Apply                                                             */
+/*!
+    Apply a journal record
+
+    The journal_Apply function creates the variable defined by a
+    definition record, or sets the variable named in a change record
+    to the value in the record.
+
+    @param[in]
+        pRecord
+            pointer to a valid journal record
+
+    @retval EOK the variable was created or set
+    @retval ENOENT the variable does not exist
+    @retval EBADMSG the record contents are not valid
+    @retval other the variable could not be created or set
+
+==============================================================================*/
+static int journal_Apply( const JournalRecord *pRecord )
+{
+    int result = EBADMSG;
+    const char *name = (const char *)&pRecord[1];
+
+    if ( pRecord->kind == JOURNAL_RECORD_CHANGE )
+    {
+        result = journal_ApplyChange( pRecord );
+    }
+    else if ( pRecord->kind == JOURNAL_RECORD_DEFINE )
+    {
+        /* the definition is a snapshot record following the name */
+        result = SNAPSHOT_LoadRecord( &name[pRecord->nameLen],
+                                      pRecord->dataLen );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  journal_ApplyChange                                                       */
+/*!
+    Apply a change record
+
+    The journal_ApplyChange function sets the variable named in a change
+    record to the value in the record.
+
+    @param[in]
+        pRecord
+            pointer to a valid change record
+
+    @retval EOK the variable was set
+    @retval ENOENT the variable does not exist
+    @retval EBADMSG the record contents are not valid
+    @retval other the variable could not be set
+
+==============================================================================*/
+static int journal_ApplyChange( const JournalRecord *pRecord )
+{
+    int result = EBADMSG;
+    VarInfo info;
+    bool validationInProgress = false;
+    const char *name = (const char *)&pRecord[1];
+    const char *data = &name[pRecord->nameLen];
+
+    if ( name[pRecord->nameLen - 1] == 0 )
+    {
+        memset( &info, 0, sizeof( VarInfo ) );
+        info.creds[0] = 0;
+        info.ncreds = 1;
+        strncpy( info.name, name, MAX_NAME_LEN );
+        info.instanceID = pRecord->instanceID;
+
+        result = VARLIST_Find( &info, &info.hVar );
+    }
+
+    if ( result == EOK )
+    {
+        info.var.type = pRecord->type;
+        if ( pRecord->type == VARTYPE_STR )
+        {
+            if ( ( pRecord->dataLen > 0 ) &&
+                 ( data[pRecord->dataLen - 1] == 0 ) )
+            {
+                info.var.val.str = (char *)data;
+                info.var.len = pRecord->dataLen;
+            }
+            else
+            {
+                result = EBADMSG;
+            }
+        }
+        else if ( pRecord->type == VARTYPE_BLOB )
+        {
+            info.var.val.blob = (void *)data;
+            info.var.len = pRecord->dataLen;
+        }
+        else
+        {
+            memcpy( &info.var.val, &pRecord->value, sizeof( pRecord->value ) );
+        }
+    }
+
+    if ( result == EOK )
+    {
+        result = VARLIST_Set( 0, &info, &validationInProgress, NULL );
+        if ( result == EALREADY )
+        {
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  journal_AddRecord                                                         */
+/*!
+    Add a record to the record buffer
+
+    The journal_AddRecord function builds a journal record in the
+    in-memory record buffer and computes its CRC.
+
+    @param[in]
+        kind
+            record kind
+
+    @param[in]
+        name
+            name of the variable
+
+    @param[in]
+        nameLen
+            space to reserve for the name.  It must be larger than the
+            length of the name, and the extra space is zero filled
+
+    @param[in]
+        instanceID
+            instance identifier of the variable
+
+    @param[in]
+        pVarObject
+            pointer to the value of the variable, or NULL if the record
+            has no numeric value
+
+    @param[in]
+        data
+            string, blob or definition data (may be NULL)
+
+    @param[in]
+        dataLen
+            length of the data
+
+==============================================================================*/
+static void journal_AddRecord( uint32_t kind,
+                               const char *name,
+                               size_t nameLen,
+                               uint32_t instanceID,
+                               const VarObject *pVarObject,
+                               const void *data,
+                               size_t dataLen )
+{
+    JournalRecord *pRecord;
+    size_t length;
+
+    length = ( sizeof( JournalRecord ) + nameLen + dataLen +
+               JOURNAL_ALIGN - 1 ) & ~( (size_t)JOURNAL_ALIGN - 1 );
+
+    if ( journal_Reserve( length ) == EOK )
+    {
+        pRecord = (JournalRecord *)&pBuffer[bufLen];
+        memset( pRecord, 0, length );
+
+        pRecord->length = length;
+        pRecord->seq = ++journalSeq;
+        pRecord->instanceID = instanceID;
+        pRecord->nameLen = nameLen;
+        pRecord->dataLen = dataLen;
+        pRecord->kind = kind;
+
+        if ( pVarObject != NULL )
+        {
+            pRecord->type = pVarObject->type;
+            if ( data == NULL )
+            {
+                memcpy( &pRecord->value,
+                        &pVarObject->val,
+                        sizeof( pRecord->value ) );
+            }
+        }
+
+        memcpy( &pRecord[1], name, strnlen( name, nameLen - 1 ) );
+        if ( dataLen > 0 )
+        {
+            memcpy( (char *)&pRecord[1] + nameLen, data, dataLen );
+        }
+
+        pRecord->crc = journal_CRC32( &pRecord->length,
+                                      length - sizeof( pRecord->crc ) );
+
+        bufLen += length;
+
+        if ( pRecordsMetric != NULL )
+        {
+            (*pRecordsMetric)++;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  journal_Reserve                                                           */
+/*!
+    Make room for a record in the record buffer
+
+    The journal_Reserve function writes out the buffered records if a
+    new record will not fit, and grows the buffer if the record is
+    larger than the whole buffer.
+
+    @param[in]
+        length
+            length of the record
+
+    @retval EOK there is room for the record
+    @retval ENOMEM the buffer could not be grown
+
+==============================================================================*/
+static int journal_Reserve( size_t length )
+{
+    int result = EOK;
+    char *p;
+
+    if ( bufLen + length > bufSize )
+    {
+        journal_Write();
+    }
+
+    if ( length > bufSize )
+    {
+        p = realloc( pBuffer, length );
+        if ( p != NULL )
+        {
+            pBuffer = p;
+            bufSize = length;
+        }
+        else
+        {
+            result = ENOMEM;
+            journalError = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  journal_Write                                                             */
+/*!
+    Write the buffered records to the journal file
+
+    The journal_Write function appends the buffered records to the
+    journal file and empties the record buffer.  A write error is saved
+    to be reported by the next JOURNAL_Flush.
+
+    @retval EOK the records were written
+    @retval other error writing the records
+
+==============================================================================*/
+static int journal_Write( void )
+{
+    int result = EOK;
+    size_t offset = 0;
+    ssize_t n;
+
+    while ( ( offset < bufLen ) && ( result == EOK ) )
+    {
+        n = write( journalFd, &pBuffer[offset], bufLen - offset );
+        if ( n > 0 )
+        {
+            offset += n;
+        }
+        else if ( errno != EINTR )
+        {
+            result = errno;
+            journalError = result;
+        }
+    }
+
+    if ( offset > 0 )
+    {
+        journalLength += offset;
+        unsynced = true;
+        journal_UpdateMetrics();
+    }
+
+    bufLen = 0;
+
+    return result;
+}
+
+/*============================================================================*/
+/*  journal_WriteHeader                                                       */
+/*!
+    Start a new journal file
+
+    The journal_WriteHeader function empties the journal file and writes
+    the journal header to it.
+
+    @param[in]
+        fd
+            journal file descriptor
+
+    @retval EOK the header was written
+    @retval other error writing the header
+
+==============================================================================*/
+static int journal_WriteHeader( int fd )
+{
+    int result = EOK;
+    JournalHeader header;
+
+    memset( &header, 0, sizeof( JournalHeader ) );
+    header.magic = JOURNAL_MAGIC;
+    header.version = JOURNAL_VERSION;
+    header.headerSize = sizeof( JournalHeader );
+
+    if ( ( ftruncate( fd, 0 ) != 0 ) ||
+         ( write( fd, &header, sizeof( header ) ) != sizeof( header ) ) ||
+         ( fdatasync( fd ) != 0 ) )
+    {
+        result = ( errno != EOK ) ? errno : EIO;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  journal_CRC32                                                             */
+/*!
+    Calculate a CRC-32
+
+    The journal_CRC32 function calculates the CRC-32 (IEEE 802.3) of the
+    specified data using a lookup table which is generated on first use.
+
+    @param[in]
+        p
+            pointer to the data
+
+    @param[in]
+        len
+            number of bytes of data
+
+    @retval the CRC-32 of the data
+
+==============================================================================*/
+static uint32_t journal_CRC32( const void *p, size_t len )
+{
+    const uint8_t *q = p;
+    uint32_t crc = 0xFFFFFFFFU;
+    uint32_t c;
+    size_t i;
+    int j;
+
+    if ( crcReady == false )
+    {
+        for ( i = 0; i < 256; i++ )
+        {
+            c = (uint32_t)i;
+            for ( j = 0; j < 8; j++ )
+            {
+                c = ( c & 1 ) ? ( c >> 1 ) ^ JOURNAL_CRC_POLY : ( c >> 1 );
+            }
+
+            crcTable[i] = c;
+        }
+
+        crcReady = true;
+    }
+
+    for ( i = 0; i < len; i++ )
+    {
+        crc = crcTable[( crc ^ q[i] ) & 0xFF] ^ ( crc >> 8 );
+    }
+
+    return crc ^ 0xFFFFFFFFU;
+}
+
+/*============================================================================*/
+/*  journal_UpdateMetrics                                                     */
+/*!
+    Update the journal size metric
+
+    The journal_UpdateMetrics function publishes the current length of
+    the journal file.
+
+==============================================================================*/
+static void journal_UpdateMetrics( void )
+{
+    if ( pBytesMetric != NULL )
+    {
+        *pBytesMetric = journalLength;
+    }
+}
+
+/*! @}
+ * end of journal group */
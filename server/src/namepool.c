@@ -0,0 +1,313 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup namepool namepool
+ * @brief Interned variable name pool
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file namepool.c
+
+    Variable Name Pool
+
+    The Variable Name Pool stores the variable names in a single contiguous
+    region so a scan over the variable names walks densely packed memory
+    rather than the padded fixed size name buffers of each variable.
+
+    Names are interned: a name which is already in the pool (for example
+    the same name used by several instances of a variable) is stored once
+    and shared.  The region is reserved up front for the maximum number of
+    names, so the returned name pointers remain valid for the lifetime of
+    the server.  Pages are only committed as names are added.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "namepool.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! FNV-1a offset basis */
+#define NAMEPOOL_FNV_OFFSET ( 2166136261U )
+
+/*! FNV-1a prime */
+#define NAMEPOOL_FNV_PRIME ( 16777619U )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static uint32_t namepool_Hash( const char *name, size_t len );
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! start of the name pool region */
+static char *pPool = NULL;
+
+/*! number of bytes used in the name pool */
+static size_t poolUsed = 0;
+
+/*! size of the name pool region */
+static size_t poolSize = 0;
+
+/*! maximum length of a name (excluding the NUL terminator) */
+static size_t nameMaxLen = 0;
+
+/*! intern table of pool offsets (plus one), 0=empty slot */
+static uint32_t *pTable = NULL;
+
+/*! number of slots in the intern table (a power of two) */
+static size_t tableSize = 0;
+
+/*! pointer to the name pool size metric */
+static uint64_t *pPoolMetric = NULL;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  NAMEPOOL_Init                                                             */
+/*!
+    Initialize the variable name pool
+
+    The NAMEPOOL_Init function reserves the name pool region and the
+    intern table for the specified number of names.
+
+    @param[in]
+        maxNames
+            maximum number of distinct names in the pool
+
+    @param[in]
+        maxLen
+            maximum length of a name.  Longer names are truncated.
+
+    @retval EOK the name pool was initialized
+    @retval ENOMEM the name pool could not be reserved
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int NAMEPOOL_Init( size_t maxNames, size_t maxLen )
+{
+    int result = EINVAL;
+    size_t size = 1;
+    void *p;
+
+    if ( ( maxNames > 0 ) &&
+         ( maxLen > 0 ) &&
+         ( pPool == NULL ) )
+    {
+        /* size the intern table for a load factor of at most one half */
+        while ( size < ( maxNames * 2 ) )
+        {
+            size <<= 1;
+        }
+
+        poolSize = maxNames * ( maxLen + 1 );
+        p = mmap( NULL,
+                  poolSize,
+                  PROT_READ | PROT_WRITE,
+                  MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+                  -1,
+                  0 );
+
+        pTable = calloc( size, sizeof( uint32_t ) );
+
+        if ( ( p != MAP_FAILED ) &&
+             ( pTable != NULL ) )
+        {
+            pPool = p;
+            tableSize = size;
+            nameMaxLen = maxLen;
+            result = EOK;
+        }
+        else
+        {
+            if ( p != MAP_FAILED )
+            {
+                munmap( p, poolSize );
+            }
+
+            free( pTable );
+            pTable = NULL;
+            poolSize = 0;
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NAMEPOOL_Intern                                                           */
+/*!
+    Get the pooled copy of a variable name
+
+    The NAMEPOOL_Intern function looks up the specified name in the
+    name pool and returns the pooled copy, adding the name to the pool
+    if it is not already there.  Names longer than the maximum name
+    length are truncated.
+
+    @param[in]
+        name
+            pointer to the name to intern
+
+    @retval pointer to the NUL terminated name in the name pool
+    @retval NULL the name pool is full or not initialized
+
+==============================================================================*/
+const char *NAMEPOOL_Intern( const char *name )
+{
+    const char *pName = NULL;
+    size_t len;
+    size_t mask = tableSize - 1;
+    size_t slot;
+    uint32_t offset;
+    char *p;
+
+    if ( ( name != NULL ) &&
+         ( pTable != NULL ) )
+    {
+        len = strnlen( name, nameMaxLen );
+        slot = namepool_Hash( name, len ) & mask;
+
+        /* linear probe for the name or an empty slot */
+        while ( ( pName == NULL ) &&
+                ( ( offset = pTable[slot] ) != 0 ) )
+        {
+            p = &pPool[offset - 1];
+            if ( ( strncmp( p, name, len ) == 0 ) &&
+                 ( p[len] == 0 ) )
+            {
+                pName = p;
+            }
+            else
+            {
+                slot = ( slot + 1 ) & mask;
+            }
+        }
+
+        if ( ( pName == NULL ) &&
+             ( poolUsed + len + 1 <= poolSize ) )
+        {
+            /* append the name to the pool */
+            p = &pPool[poolUsed];
+            memcpy( p, name, len );
+            p[len] = 0;
+
+            pTable[slot] = (uint32_t)( poolUsed + 1 );
+            poolUsed += len + 1;
+            pName = p;
+
+            if ( pPoolMetric != NULL )
+            {
+                *pPoolMetric = poolUsed;
+            }
+        }
+    }
+
+    return pName;
+}
+
+/*============================================================================*/
+/*  NAMEPOOL_SetMetrics                                                       */
+/*!
+    Set up the name pool metrics
+
+    The NAMEPOOL_SetMetrics function creates the name pool size metric
+    using the specified metric creation function.
+
+    @param[in]
+        fn
+            function used to create a metric
+
+==============================================================================*/
+void NAMEPOOL_SetMetrics( NamePoolMetricFn fn )
+{
+    if ( fn != NULL )
+    {
+        pPoolMetric = fn( "/varserver/stats/namepool_bytes" );
+        if ( pPoolMetric != NULL )
+        {
+            *pPoolMetric = poolUsed;
+        }
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  namepool_Hash                                                             */
+/*!
+    Calculate the intern table hash of a name
+
+    The namepool_Hash function calculates the FNV-1a hash of the first
+    len characters of the specified name.
+
+    @param[in]
+        name
+            pointer to the name to hash
+
+    @param[in]
+        len
+            number of characters to hash
+
+    @retval the hash of the name
+
+==============================================================================*/
+static uint32_t namepool_Hash( const char *name, size_t len )
+{
+    uint32_t hash = NAMEPOOL_FNV_OFFSET;
+    size_t i;
+
+    for ( i = 0; i < len; i++ )
+    {
+        hash ^= (uint8_t)name[i];
+        hash *= NAMEPOOL_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/*! @}
+ * end of namepool group */
@@ -37,6 +37,11 @@ SOFTWARE.
     The Variable Notification List Manager maintains a list of
     notifications associated with a variable.
 
+    Notifications are kept in a separate contiguous array for each
+    notification type so sending a notification only touches the
+    subscribers of that type.  Subscribers which are found to be gone
+    are compacted out of their array rather than being left behind.
+
 */
 /*============================================================================*/
 
@@ -56,32 +61,125 @@ SOFTWARE.
 #include <semaphore.h>
 #include <string.h>
 #include <mqueue.h>
+#include <math.h>
+#include <time.h>
 #include <varserver/var.h>
 #include "notify.h"
 #include "stats.h"
+#include "trace.h"
+#include "slab.h"
+
 
 /*==============================================================================
         Private definitions
 ==============================================================================*/
 
+/*! initial capacity of a notification array */
+#define NOTIFY_INITIAL_SIZE ( 4 )
+
+/*! default time to wait for room in a NOTIFY_OVERFLOW_BLOCK queue (ms) */
+#define NOTIFY_BLOCK_TIMEOUT_MS ( 10 )
+
+/*! maximum time to wait for room in a NOTIFY_OVERFLOW_BLOCK queue (ms) */
+#define NOTIFY_MAX_BLOCK_TIMEOUT_MS ( 100 )
+
+/*! time between attempts to send a coalesced change to a full queue (ns) */
+#define NOTIFY_COALESCE_RETRY ( 10000000ULL )
+
 /*==============================================================================
         Private file scoped variables
 ==============================================================================*/
 
-/* pointer to a free notification list */
-static Notification *FreeNotificationList = NULL;
+/*! notification mask bits indexed by notification type */
+static const uint16_t NotifyMasks[NOTIFY_NUM_TYPES] =
+{
+    0,
+    NOTIFY_MASK_MODIFIED,
+    NOTIFY_MASK_CALC,
+    NOTIFY_MASK_VALIDATE,
+    NOTIFY_MASK_PRINT,
+    NOTIFY_MASK_MODIFIED_QUEUE,
+    NOTIFY_MASK_MODIFIED_RING
+};
+
+/*! number of NOTIFY_MODIFIED notifications suppressed by coalescing */
+static uint64_t *pCoalescedMetric = NULL;
+
+/*! number of NOTIFY_MODIFIED notifications suppressed by rate limits */
+static uint64_t *pRateLimitedMetric = NULL;
+
+/*! number of NOTIFY_MODIFIED notifications suppressed by a deadband */
+static uint64_t *pDeadbandMetric = NULL;
+
+/*! number of queued changes discarded because a queue was full */
+static uint64_t *pQueueDroppedMetric = NULL;
+
+/*! number of queued changes coalesced because a queue was full */
+static uint64_t *pQueueCoalescedMetric = NULL;
+
+/*! function called with the process identifier of each client whose
+    notification queue overflows */
+static void (*pOverflowHandler)( pid_t pid ) = NULL;
+
+/*! buffer used to discard the oldest message from a full queue */
+static char *pDiscard = NULL;
+
+/*! size of the discard buffer */
+static size_t discardSize = 0;
+
+/*! indicates that a notification group is in progress */
+static bool groupInProgress = false;
+
+/*! subscribers already signalled in the current notification group */
+static pid_t *groupPIDs = NULL;
+
+/*! number of subscribers signalled in the current notification group */
+static size_t groupCount = 0;
+
+/*! allocated capacity of the notification group subscriber list */
+static size_t groupSize = 0;
 
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
 
-static Notification *notify_New( void );
+static bool notify_ValidType( NotificationType type );
+
+static int notify_Reserve( NotificationList *pList,
+                           NotificationType type,
+                           size_t n );
+
+static Notification *notify_Append( NotificationList *pList,
+                                    NotificationType type );
+
+static void notify_Remove( NotificationList *pList,
+                           NotificationType type,
+                           size_t idx );
 
 static int notify_Send( Notification *pNotification,
                         int handle,
                         int signal );
 
-static mqd_t notify_GetQueue( pid_t pid );
+static mqd_t notify_GetQueue( pid_t pid, NotifyOverflowPolicy overflow );
+
+static int notify_QueueSend( Notification *pNotification,
+                             void *buf,
+                             size_t len );
+
+static int notify_Overflow( Notification *pNotification,
+                            void *buf,
+                            size_t len,
+                            uint64_t *pDue );
+
+static int notify_DiscardOldest( Notification *pNotification );
+
+static bool notify_GetNumber( VarObject *pVarObject, double *pValue );
+
+static void notify_Count( uint64_t *pMetric );
+
+static bool notify_GroupSignalled( pid_t pid );
+
+static void notify_GroupAdd( pid_t pid );
 
 /*==============================================================================
         Public function definitions
@@ -96,7 +194,7 @@ static mqd_t notify_GetQueue( pid_t pid );
     the specified variable notification list.
 
     @param[in,out]
-        ppNotification
+        pList
             Pointer to the notification request list
 
     @param[in]
@@ -111,36 +209,81 @@ static mqd_t notify_GetQueue( pid_t pid );
         pid
             process id of the client to be notified
 
+    @param[in]
+        pOptions
+            pointer to the subscription options, or NULL for none.
+            The cache TTL is only supported on NOTIFY_CALC notifications,
+            the overflow policy on NOTIFY_MODIFIED_QUEUE notifications,
+            and the other options on NOTIFY_MODIFIED notifications
+
     @retval EOK the notification was successfully added
     @retval ENOTSUP the notification is not supported
+    @retval ENOMEM memory allocation failure
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-int NOTIFY_Add( Notification **ppNotification,
+int NOTIFY_Add( NotificationList *pList,
                 NotificationType type,
                 VAR_HANDLE hVar,
-                pid_t pid )
+                pid_t pid,
+                const VarNotifyOptions *pOptions )
 {
     int result = EINVAL;
-    Notification *pNotification;
+    Notification *pNotification = NULL;
+    NotifyOverflowPolicy overflow = NOTIFY_OVERFLOW_DROP_NEWEST;
+    uint32_t timeout_ms = NOTIFY_BLOCK_TIMEOUT_MS;
+
+    if( pOptions != NULL )
+    {
+        overflow = pOptions->overflow;
+        if( pOptions->blockTimeout_ms != 0 )
+        {
+            timeout_ms = pOptions->blockTimeout_ms;
+        }
+    }
 
-    if( ppNotification != NULL )
+    if( ( (unsigned)overflow > NOTIFY_OVERFLOW_BLOCK ) ||
+        ( timeout_ms > NOTIFY_MAX_BLOCK_TIMEOUT_MS ) )
+    {
+        result = EINVAL;
+    }
+    else if( ( pOptions != NULL ) &&
+             ( type != NOTIFY_MODIFIED_QUEUE ) &&
+             ( ( overflow != NOTIFY_OVERFLOW_DROP_NEWEST ) ||
+               ( pOptions->blockTimeout_ms != 0 ) ) )
+    {
+        /* the overflow policy is only supported on NOTIFY_MODIFIED_QUEUE */
+        result = ENOTSUP;
+    }
+    else if( ( pOptions != NULL ) &&
+        ( ( ( type == NOTIFY_MODIFIED ) &&
+            ( pOptions->flags & NOTIFY_OPT_CACHE_TTL ) ) ||
+          ( ( type == NOTIFY_CALC ) &&
+            ( pOptions->flags & ~NOTIFY_OPT_CACHE_TTL ) ) ||
+          ( ( type != NOTIFY_MODIFIED ) &&
+            ( type != NOTIFY_CALC ) &&
+            ( pOptions->flags != 0 ) ) ) )
+    {
+        /* the cache TTL is only supported on NOTIFY_CALC, and the
+           other options only on NOTIFY_MODIFIED */
+        result = ENOTSUP;
+    }
+    else if( pList != NULL )
     {
-        /* get a pointer to the first notification in the notification list */
-        pNotification = *ppNotification;
         switch( type )
         {
+            case NOTIFY_MODIFIED_RING:
             case NOTIFY_MODIFIED_QUEUE:
             case NOTIFY_MODIFIED:
                 /* check if we are already registered */
-                pNotification = NOTIFY_Find( pNotification, type, pid );
+                pNotification = NOTIFY_Find( pList, type, pid );
                 break;
 
             case NOTIFY_VALIDATE:
             case NOTIFY_CALC:
             case NOTIFY_PRINT:
                 /* only one validator/calculator allowed */
-                pNotification = NOTIFY_Find( pNotification, type, -1 );
+                pNotification = NOTIFY_Find( pList, type, -1 );
                 break;
 
             default:
@@ -153,30 +296,22 @@ int NOTIFY_Add( Notification **ppNotification,
             /* notification type is supported */
             if( pNotification == NULL )
             {
-                /* try to find an unused (abandoned) notification */
-                pNotification = NOTIFY_Find( *ppNotification,
-                                             NOTIFY_NONE,
-                                             -1 );
-                if( pNotification == NULL )
-                {
-                    /* a matching notification was not found
-                    so let's create one */
-                    pNotification = notify_New();
-                    if( pNotification != NULL )
-                    {
-                        /* insert the new notification
-                        at the head of the notification list */
-                        pNotification->pNext = *ppNotification;
-                        *ppNotification = pNotification;
-                    }
-                }
+                /* a matching notification was not found
+                   so let's create one */
+                pNotification = notify_Append( pList, type );
             }
 
             if( pNotification != NULL )
             {
                 if ( type == NOTIFY_MODIFIED_QUEUE )
                 {
-                    pNotification->mq = notify_GetQueue( pid );
+                    if ( pNotification->mq != (mqd_t)-1 )
+                    {
+                        /* release the previous queue descriptor */
+                        mq_close( pNotification->mq );
+                    }
+
+                    pNotification->mq = notify_GetQueue( pid, overflow );
                 }
 
                 /* populate the notification structure */
@@ -184,6 +319,23 @@ int NOTIFY_Add( Notification **ppNotification,
                 pNotification->type = type;
                 pNotification->hVar = hVar;
 
+                /* (re)apply the subscription options */
+                pNotification->options = 0;
+                pNotification->minInterval = 0;
+                pNotification->deadband = 0.0;
+                pNotification->pending = false;
+                pNotification->deferred = false;
+                pNotification->overflow = overflow;
+                pNotification->blockTimeout =
+                    (uint64_t)timeout_ms * 1000000ULL;
+                if( pOptions != NULL )
+                {
+                    pNotification->options = pOptions->flags;
+                    pNotification->minInterval =
+                        (uint64_t)pOptions->minInterval_ms * 1000000ULL;
+                    pNotification->deadband = fabs( pOptions->deadband );
+                }
+
                 /* notification successfully registered */
                 result = EOK;
             }
@@ -206,7 +358,7 @@ int NOTIFY_Add( Notification **ppNotification,
     the specified variable notification list.
 
     @param[in,out]
-        ppNotification
+        pList
             Pointer to the notification request list
 
     @param[in]
@@ -225,12 +377,12 @@ int NOTIFY_Add( Notification **ppNotification,
         count
             number of notifications of the specified type still in the list
 
-    @retval EOK the notification was successfully added
-    @retval ENOTSUP the notification is not supported
+    @retval EOK the notification was successfully cancelled
+    @retval ENOENT the notification was not found
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-int NOTIFY_Cancel( Notification **ppNotification,
+int NOTIFY_Cancel( NotificationList *pList,
                    NotificationType type,
                    VAR_HANDLE hVar,
                    pid_t pid,
@@ -238,67 +390,105 @@ int NOTIFY_Cancel( Notification **ppNotification,
 {
     int result = EINVAL;
     Notification *p;
-    Notification *pNext;
-    Notification **ppDst = &FreeNotificationList;
+    size_t i = 0;
 
-    if( ( ppNotification != NULL ) &&
+    if( ( pList != NULL ) &&
         ( count != NULL ) )
     {
         result = ENOENT;
 
-        /* initialize the counter */
-        *count = 0;
+        if( notify_ValidType( type ) )
+        {
+            while( i < pList->count[type] )
+            {
+                p = &pList->pEntries[type][i];
 
-        /* initialize the pointer to point to the head of the source list */
-        p = *ppNotification;
+                /* check if we have a map for the variable handle
+                   and process identifier */
+                if ( ( p->hVar == hVar ) &&
+                     ( p->pid == pid ) )
+                {
+                    if ( p->mq != (mqd_t)-1 )
+                    {
+                        /* release the notification queue descriptor */
+                        mq_close( p->mq );
+                    }
 
-        while ( p != NULL )
-        {
-            /* get a pointer to the next notification in the notify list */
-            pNext = p->pNext;
+                    /* compact the notification out of the array */
+                    notify_Remove( pList, type, i );
 
-            if ( p->type == type )
-            {
-                /* count the number of notifications of the specified
-                   type in the list */
-                (*count)++;
+                    /* indicate success */
+                    result = EOK;
+                }
+                else
+                {
+                    i++;
+                }
             }
+        }
 
-            /* check if we have a map for the variable handle,
-               process identifier, and notification type */
-            if ( ( p->hVar == hVar ) &&
-                 ( p->pid == pid ) &&
-                 ( p->type == type ) )
-            {
-                /* insert the notificaton onto the head of the
-                   Free Notification List */
-                memset( p, 0, sizeof( Notification ) );
-                p->pNext = *ppDst;
-                *ppDst = p;
+        /* get the number of notifications of the specified type
+           remaining in the list */
+        *count = notify_ValidType( type ) ? (int)pList->count[type] : 0;
+    }
+
+    return result;
+}
 
-                /* update the source pointer to skip over the removed
-                   notification */
-                *ppNotification = pNext;
+/*============================================================================*/
+/*  NOTIFY_RemovePID                                                          */
+/*!
+    Remove all of the notifications of a client process
 
-                /* decrement the number of notifications of the
-                   specified type in the list */
-                (*count)--;
+    The NOTIFY_RemovePID function removes every notification of every
+    type in the specified list which was requested by the specified
+    client process.  It is used to discard the notifications of a
+    client which has exited.
 
-                /* indicate success */
-                result = EOK;
+    @param[in,out]
+        pList
+            Pointer to the notification request list
+
+    @param[in]
+        pid
+            process id of the client
+
+    @retval number of notifications removed
+
+==============================================================================*/
+size_t NOTIFY_RemovePID( NotificationList *pList, pid_t pid )
+{
+    Notification *p;
+    size_t count = 0;
+    size_t i;
+    int type;
+
+    for( type = 0; ( pList != NULL ) && ( type < NOTIFY_NUM_TYPES ); type++ )
+    {
+        i = 0;
+        while( i < pList->count[type] )
+        {
+            p = &pList->pEntries[type][i];
+            if( p->pid == pid )
+            {
+                if ( p->mq != (mqd_t)-1 )
+                {
+                    /* release the notification queue descriptor */
+                    mq_close( p->mq );
+                }
+
+                /* compact the notification out of the array */
+                notify_Remove( pList, type, i );
+                count++;
             }
             else
             {
-                /* update the pointer to be modified for the next removal */
-                ppNotification = &(p->pNext);
+                i++;
             }
-
-            /* move to the next notification in the source list */
-            p = pNext;
         }
     }
 
-    return result;
+    return count;
 }
 
 /*============================================================================*/
@@ -311,9 +501,12 @@ int NOTIFY_Cancel( Notification **ppNotification,
     is -1, it is not used in the search and the first notification
     of the specified type found in the notification list is returned.
 
+    The returned pointer is only valid until the next notification
+    is added to, or removed from, the list.
+
     @param[in]
-        pNotificaiton
-            Pointer to the first notification in the notification request list
+        pList
+            Pointer to the notification request list
 
     @param[in]
         type
@@ -327,23 +520,25 @@ int NOTIFY_Cancel( Notification **ppNotification,
     @retval NULL if there was no matching notification
 
 ==============================================================================*/
-Notification *NOTIFY_Find( Notification *pNotification,
+Notification *NOTIFY_Find( NotificationList *pList,
                            NotificationType type,
                            pid_t pid )
 {
-    while( pNotification != NULL )
+    Notification *pNotification = NULL;
+    size_t i;
+
+    if( ( pList != NULL ) &&
+        ( notify_ValidType( type ) ) )
     {
-        if( ( pNotification->type == type ) && ( pid == -1 ) )
-        {
-            break;
-        }
-        else if( ( pNotification->type == type ) &&
-                 ( pNotification->pid == pid ) )
+        for( i = 0; i < pList->count[type]; i++ )
         {
-            break;
+            if( ( pid == -1 ) ||
+                ( pList->pEntries[type][i].pid == pid ) )
+            {
+                pNotification = &pList->pEntries[type][i];
+                break;
+            }
         }
-
-        pNotification = pNotification->pNext;
     }
 
     return pNotification;
@@ -360,13 +555,15 @@ Notification *NOTIFY_Find( Notification *pNotification,
     or PRINT notification is processed, we exit since
     each variable can only have one of each of those notification types.
 
+    Clients which no longer exist are removed from the notification list.
+
     @param[in]
         pid
             process identifier of the process which is initiating the signal
 
     @param[in]
-        pNotification
-            Pointer to the first notification in the notification request list
+        pList
+            Pointer to the notification request list
 
     @param[in]
         type
@@ -382,128 +579,116 @@ Notification *NOTIFY_Find( Notification *pNotification,
 
     @retval EOK all notifications were sent
     @retval ESRCH one or more processed did not exist
+    @retval ENOENT no notifications were sent
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
 int NOTIFY_Signal( pid_t pid,
-                   Notification **ppNotification,
+                   NotificationList *pList,
                    NotificationType type,
                    int handle,
                    pid_t *sentTo )
 {
     int result = EINVAL;
     Notification *pNotification;
-    int sig = -1;
+    int sig;
     int done = 0;
     int handleToSend = handle;
+    size_t i = 0;
 
-    if( ppNotification != NULL )
+    if( ( pList != NULL ) &&
+        ( notify_ValidType( type ) ) )
     {
-        /* select the first notification */
-        pNotification = *ppNotification;
-
         result = ENOENT;
 
-        while( ( pNotification != NULL ) && ( ! done ) )
+        while( ( i < pList->count[type] ) && ( ! done ) )
         {
-            if( pNotification->type == type )
+            /* select the next notification */
+            pNotification = &pList->pEntries[type][i];
+            sig = -1;
+
+            switch(type)
             {
-                switch(type)
-                {
-                    case NOTIFY_MODIFIED_QUEUE:
-                        if ( pNotification->pending == true )
-                        {
-                            sig = SIGRTMIN+10;
-
-                            /* override handle so the client receiving the
-                            notification gets the handle they requested and
-                            not a different one in case of aliasing */
-
-                            handleToSend = pNotification->hVar;
-                            pNotification->pending = false;
-                        }
-                        else
-                        {
-                            /* don't send this notification because
-                               the message queue payload was not sent */
-                            sig = -1;
-                        }
-                        break;
+                case NOTIFY_MODIFIED_QUEUE:
+                    if ( pNotification->pending == true )
+                    {
+                        sig = SIGRTMIN+10;
+
+                        /* override handle so the client receiving the
+                        notification gets the handle they requested and
+                        not a different one in case of aliasing */
 
-                    case NOTIFY_MODIFIED:
+                        handleToSend = pNotification->hVar;
+                        pNotification->pending = false;
+                    }
+                    break;
+
+                case NOTIFY_MODIFIED:
+                    /* override handle so the client receiving the
+                    notification gets the handle they requested and
+                    not a different one in case of aliasing */
+                    handleToSend = pNotification->hVar;
+                    sig = SIGRTMIN+6;
+                    break;
+
+                case NOTIFY_CALC:
+                    if( pNotification->pid != pid )
+                    {
                         /* override handle so the client receiving the
                         notification gets the handle they requested and
                         not a different one in case of aliasing */
                         handleToSend = pNotification->hVar;
-                        sig = SIGRTMIN+6;
-                        break;
+                        sig = SIGRTMIN+7;
+                    }
+                    done = 1;
+                    break;
 
-                    case NOTIFY_CALC:
-                        if( pNotification->pid == pid )
-                        {
-                            /* don't send a CALC signal to the processs
-                            which is registered to perform the calculation */
-                            sig = -1;
-                        }
-                        else
-                        {
-                            /* override handle so the client receiving the
-                            notification gets the handle they requested and
-                            not a different one in case of aliasing */
-                            handleToSend = pNotification->hVar;
-                            sig = SIGRTMIN+7;
-                        }
-                        done = 1;
-                        break;
+                case NOTIFY_VALIDATE:
+                    if( pNotification->pid != pid )
+                    {
+                        sig = SIGRTMIN+8;
+                    }
+                    done = 1;
+                    break;
 
-                    case NOTIFY_VALIDATE:
-                        if( pNotification->pid == pid )
-                        {
-                            /* don't send a VALIDATE signal to the process
-                            which is registered to perform the validation */
-                            sig = -1;
-                        }
-                        else
-                        {
-                            sig = SIGRTMIN+8;
-                        }
-                        done = 1;
-                        break;
+                case NOTIFY_PRINT:
+                    if( pNotification->pid != pid )
+                    {
+                        sig = SIGRTMIN+9;
+                    }
+                    done = 1;
+                    break;
 
-                    case NOTIFY_PRINT:
-                        if( pNotification->pid == pid )
-                        {
-                            /* don't send a PRINT signal to the process which is
-                               registered to perform the PRINT operation */
-                            sig = -1;
-                        }
-                        else
-                        {
-                            sig = SIGRTMIN+9;
-                        }
-                        done = 1;
-                        break;
+                default:
+                    break;
+            }
 
-                    default:
-                        break;
+            if( sig != -1 )
+            {
+                /* send the notification */
+                result = notify_Send( pNotification, handleToSend, sig );
+                if( result == EOK )
+                {
+                    if( sentTo != NULL )
+                    {
+                        *sentTo = pNotification->pid;
+                    }
                 }
-
-                if( sig != -1 )
+                else if( result == ESRCH )
                 {
-                    /* send the notification */
-                    result = notify_Send( pNotification, handleToSend, sig );
-                    if( result == EOK )
+                    /* the process that registered this notification is
+                       gone, compact it out of the list */
+                    if ( pNotification->mq != (mqd_t)-1 )
                     {
-                        if( sentTo != NULL )
-                        {
-                            *sentTo = pNotification->pid;
-                        }
+                        mq_close( pNotification->mq );
                     }
+
+                    notify_Remove( pList, type, i );
+                    continue;
                 }
             }
 
-            /* select the next notification */
-            pNotification = pNotification->pNext;
+            i++;
         }
     }
 
@@ -515,16 +700,16 @@ int NOTIFY_Signal( pid_t pid,
 /*!
     Get the variable handle associated with a notification type
 
-    The NOTIFY_GetVarHandle function iterates through the Notification
-    List and returns the variable handle of the first notification which
-    matches the soecified notification type.
+    The NOTIFY_GetVarHandle function returns the variable handle of the
+    first notification in the notification list which matches the
+    specified notification type.
 
     This is usually used to get the handle associated with PRINT, VALIDATE, and
     CALC notifications when aliases are used.
 
     @param[in]
-        pNotification
-            Pointer to the first notification in the notification request list
+        pList
+            Pointer to the notification request list
 
     @param[in]
         type
@@ -534,123 +719,57 @@ int NOTIFY_Signal( pid_t pid,
     @retval VAR_INVALID no notification found with the given type
 
 ==============================================================================*/
-VAR_HANDLE NOTIFY_GetVarHandle( Notification *pNotification,
+VAR_HANDLE NOTIFY_GetVarHandle( NotificationList *pList,
                                 NotificationType type )
 {
     VAR_HANDLE hVar = VAR_INVALID;
 
-    while( pNotification != NULL )
+    if( ( pList != NULL ) &&
+        ( notify_ValidType( type ) ) &&
+        ( pList->count[type] > 0 ) )
     {
-        if( pNotification->type == type )
-        {
-            hVar = pNotification->hVar;
-            break;
-        }
-
-        pNotification = pNotification->pNext;
+        hVar = pList->pEntries[type][0].hVar;
     }
 
     return hVar;
 }
 
 /*============================================================================*/
-/*  notify_New                                                                */
-/*!
-    Get a new Notification object
-
-    The notify_New function gets a new Notification object, either from the
-    Free Notification List, or from the heap if the Free Notification List
-    is empty.
-
-    @retval pointer to a new Notification object
-    @retval NULL if a new Notification object could not be allocated
-
-==============================================================================*/
-static Notification *notify_New( void )
-{
-    Notification *pNotification = NULL;
-
-    if ( FreeNotificationList != NULL )
-    {
-        /* get the notification from the free notification list */
-        pNotification = FreeNotificationList;
-        FreeNotificationList = pNotification->pNext;
-        memset( pNotification, 0, sizeof( Notification ) );
-    }
-    else
-    {
-        /* allocate the notification from the heap */
-        pNotification = calloc( 1, sizeof( Notification ) );
-    }
-
-    return pNotification;
-}
-
-/*============================================================================*/
-/*  notify_Send                                                               */
+/*  NOTIFY_GetPID                                                             */
 /*!
-    Send a notification signal
-
-    The notify_Send function sends out a notification signal
-    to the client referenced in the notification object.
+    Get the process associated with a notification type
 
-    If the client does not exist, the notification object is marked
-    as unused
+    The NOTIFY_GetPID function returns the process identifier of the
+    first notification in the notification list which matches the
+    specified notification type.
 
-    @param[in]
-        pNotification
-            pointer to the notification to send
+    This is usually used to identify the client handling the PRINT,
+    VALIDATE, and CALC notifications of a variable.
 
     @param[in]
-        handle
-            notification handle
+        pList
+            Pointer to the notification request list
 
     @param[in]
-        signal
-            signal to send
+        type
+            notification type
 
-    @retval EOK the notifications was sent
-    @retval ESRCH the process which reqeusted the notification does not exist
-    @retval EINVAL invalid arguments
+    @retval process identifier of the notification client
+    @retval 0 no notification found with the given type
 
 ==============================================================================*/
-static int notify_Send( Notification *pNotification,
-                        int handle,
-                        int signal )
+pid_t NOTIFY_GetPID( NotificationList *pList, NotificationType type )
 {
-    int result = EINVAL;
-    union sigval val;
-    int rc;
-
-    if( pNotification != NULL )
-    {
-        /* provide the signal handle to the var server */
-        val.sival_int = handle;
+    pid_t pid = 0;
 
-        /* queue the notification */
-        rc = sigqueue( pNotification->pid, signal, val );
-        if( rc == -1 )
-        {
-            result = errno;
-            if( result == ESRCH )
-            {
-                /* the process that registered this signal is gone,
-                mark the signal as unused */
-                pNotification->type = NOTIFY_NONE;
-                pNotification->pid = -1;
-            }
-        }
-        else
-        {
-            result = EOK;
-        }
-    }
-    else
+    if( ( pList != NULL ) &&
+        ( notify_ValidType( type ) ) &&
+        ( pList->count[type] > 0 ) )
     {
-        result = ENOENT;
+        pid = pList->pEntries[type][0].pid;
     }
 
-    return result;
+    return pid;
 }
 
 /*============================================================================*/
@@ -659,10 +778,18 @@ static int notify_Send( Notification *pNotification,
     Send a notification payload to a client's message queue
 
     The NOTIFY_Payload function sends a notification payload to each client
-    which has registered to receive it.
+    which has registered to receive it.  Clients whose message queue is
+    no longer valid are removed from the notification list.
+
+    When the message queue of a client is full, the overflow policy of
+    its subscription is applied, and the overflow is counted against the
+    client.  A NOTIFY_OVERFLOW_COALESCE subscription keeps the change
+    for a later attempt: calling NOTIFY_Payload again, with deferred
+    set, once the time returned in pDue has been reached sends the
+    payload to those subscriptions only.
 
     @param[in]
-        ppNotification
+        pList
             pointer to the Notification list
 
     @param[in]
@@ -673,98 +800,112 @@ static int notify_Send( Notification *pNotification,
         len
             length of the payload to send
 
+    @param[in]
+        deferred
+            true to only send the payload to subscriptions which are
+            holding a coalesced change
+
+    @param[out]
+        pDue
+            pointer to a location to store the time the next coalesced
+            change is due to be sent (CLOCK_MONOTONIC ns), or 0 if there
+            are none
+
     @retval EOK at least one notification was sent
     @retval EINVAL invalid arguments
     @retval ENOENT no notifications registered
 
 ==============================================================================*/
-int NOTIFY_Payload( Notification **ppNotification,
+int NOTIFY_Payload( NotificationList *pList,
                     void *buf,
-                    size_t len )
+                    size_t len,
+                    bool deferred,
+                    uint64_t *pDue )
 {
     int result = EINVAL;
-    int rc;
+    int err;
     Notification *pNotification;
+    uint64_t start;
+    size_t i = 0;
 
-    if( ppNotification != NULL )
+    if( ( pList != NULL ) &&
+        ( ( buf != NULL ) || ( deferred == false ) ) &&
+        ( pDue != NULL ) )
     {
-        /* select the first notification */
-        pNotification = *ppNotification;
-
         result = ENOENT;
+        *pDue = 0;
 
-        while( pNotification != NULL )
+        while( i < pList->count[NOTIFY_MODIFIED_QUEUE] )
         {
-            if( pNotification->type == NOTIFY_MODIFIED_QUEUE )
+            /* select the next notification */
+            pNotification = &pList->pEntries[NOTIFY_MODIFIED_QUEUE][i];
+
+            if( ( deferred == true ) &&
+                ( pNotification->deferred == false ) )
             {
-                /* send the message to the clients message queue */
-                rc = mq_send( pNotification->mq, buf, len, 0);
-                if ( rc == 0 )
-                {
-                    /* update the request stats */
-                    STATS_IncrementRequestCount();
+                i++;
+                continue;
+            }
 
-                    pNotification->pending = true;
-                    result = EOK;
-                }
-                else
-                {
-                    rc = errno;
-                    if ( rc == EBADF )
-                    {
-                        /* the process that requested this notification is gone,
-                        mark the signal as unused */
-                        pNotification->type = NOTIFY_NONE;
-                        pNotification->pid = -1;
-                    }
-                }
+            if( deferred == true )
+            {
+                /* the coalesced change is reported against the
+                   subscribed handle */
+                ((VarNotification *)buf)->hVar = pNotification->hVar;
             }
 
-            /* select the next notification */
-            pNotification = pNotification->pNext;
+            /* send the message to the clients message queue */
+            if ( TRACE_ENABLED() )
+            {
+                start = STATS_Now();
+                err = notify_QueueSend( pNotification, buf, len );
+                TRACE_Record( TRACE_EVENT_QUEUE,
+                              0,
+                              pNotification->clientID,
+                              pNotification->hVar,
+                              err,
+                              start,
+                              STATS_Now() - start );
+            }
+            else
+            {
+                err = notify_QueueSend( pNotification, buf, len );
+            }
+
+            if ( ( err == EAGAIN ) || ( err == ETIMEDOUT ) )
+            {
+                /* the client's message queue is full */
+                err = notify_Overflow( pNotification, buf, len, pDue );
+            }
+
+            if ( err == EOK )
+            {
+                /* update the request stats */
+                STATS_IncrementRequestCount();
+
+                pNotification->pending = true;
+                pNotification->deferred = false;
+                result = EOK;
+            }
+            else if ( err == EBADF )
+            {
+                /* the process that requested this notification is gone,
+                   compact it out of the list */
+                notify_Remove( pList, NOTIFY_MODIFIED_QUEUE, i );
+                continue;
+            }
+
+            i++;
         }
     }
 
     return result;
 }
 
-
 /*============================================================================*/
-/*  notify_GetQueue                                                           */
+/*  NOTIFY_CheckMove                                                          */
 /*!
-    Get the notification queue for a client process
-
-    The notify_GetQueue function gets the notification queue associated
-    with the client specified via its pid.
-
-    @param[in]
-        pid
-            process identifier of the client process
-
-    @retval message queue descriptor
-    @retval -1 if the message queue does not exist
-
-==============================================================================*/
-static mqd_t notify_GetQueue( pid_t pid )
-{
-    char clientname[BUFSIZ];
-    mqd_t mq;
-
-    /* build the varclient identifier */
-    sprintf(clientname, "/varclient_%d", pid);
-
-    mq = mq_open( clientname, O_WRONLY | O_NONBLOCK );
-    if ( mq == -1 )
-    {
-        printf("Failed to open %s : %s\n", clientname, strerror(errno));
-    }
-    return mq;
-}
-
-/*============================================================================*/
-/*  NOTIFY_CheckMove                                                          */
-/*!
-    Check of we can move the source notifications to the destination list
+    Check of we can move the source notifications to the destination list
 
     The NOTIFY_CheckMove function checks if we can move the notifications
     in the source list with the specified variable handle to the destination
@@ -784,70 +925,45 @@ static mqd_t notify_GetQueue( pid_t pid )
 
     @retval EOK the source list can be moved to the destination list
     @retval ENOTSUP the source list conflicts with the destination list
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
 int NOTIFY_CheckMove( VAR_HANDLE hVar,
-                      Notification *pSrc,
-                      Notification *pDst )
+                      NotificationList *pSrc,
+                      NotificationList *pDst )
 {
-    int result = EOK;
-    int numCalcs = 0;
-    int numValidates = 0;
-    int numPrints = 0;
-
-    /* count the number of calc, validate, and print handlers we have
-       on the destination notification list */
-    while ( pDst != NULL )
+    int result = EINVAL;
+    static const NotificationType exclusive[] =
     {
-        if ( pDst->type == NOTIFY_CALC )
-        {
-            numCalcs++;
-        }
-        else if ( pDst->type == NOTIFY_VALIDATE )
-        {
-            numValidates++;
-        }
-        else if ( pDst->type == NOTIFY_PRINT )
-        {
-            numPrints++;
-        }
-
-        pDst = pDst->pNext;
-    }
-
-    /* check the source notification list to see if we can copy/move
-       it to the destination notification list */
-    while ( pSrc != NULL )
+        NOTIFY_CALC,
+        NOTIFY_VALIDATE,
+        NOTIFY_PRINT
+    };
+    NotificationType type;
+    size_t i;
+    size_t j;
+
+    if( ( pSrc != NULL ) && ( pDst != NULL ) )
     {
-        if ( pSrc->hVar == hVar )
-        {
-            if( ( pSrc->type == NOTIFY_CALC ) &&
-                ( numCalcs > 0 ) )
-            {
-                /* we can only have one calc handler and one already exists */
-                result = ENOTSUP;
-                break;
-            }
-
-            if ( ( pSrc->type == NOTIFY_VALIDATE ) &&
-                ( numValidates > 0 ) )
-            {
-                /* we can only have one validate handler
-                   and one already exists */
-                result = ENOTSUP;
-                break;
-            }
+        result = EOK;
 
-            if ( ( pSrc->type == NOTIFY_PRINT ) &&
-                ( numPrints > 0 ) )
+        /* we can only have one calc, validate, and print handler, so
+           the move is not possible if both lists have one of them */
+        for( i = 0; i < sizeof( exclusive ) / sizeof( exclusive[0] ); i++ )
+        {
+            type = exclusive[i];
+            if( pDst->count[type] > 0 )
             {
-                /* we can only have one print handler and one already exists */
-                result = ENOTSUP;
-                break;
+                for( j = 0; j < pSrc->count[type]; j++ )
+                {
+                    if( pSrc->pEntries[type][j].hVar == hVar )
+                    {
+                        result = ENOTSUP;
+                        break;
+                    }
+                }
             }
         }
-
-        pSrc = pSrc->pNext;
     }
 
     return result;
@@ -860,63 +976,190 @@ int NOTIFY_CheckMove( VAR_HANDLE hVar,
 
     The NOTIFY_Move function moves all notifications from the source list
     to the destination list which match the specified notification variable
-    handle.
+    handle.  Space for the moved notifications is reserved in the
+    destination list before any notifications are moved.
 
     @param[in]
         hVar
             handle of the variable associated with the notifications to move
 
-    @param[in]
-        ppSrc
-            pointer to the pointer to the source notification list
+    @param[in,out]
+        pSrc
+            pointer to the source notification list
 
-    @param[in]
+    @param[in,out]
         pDst
-            pointer to the pointer to the destination notification list
+            pointer to the destination notification list
 
-    @retval EOK the source list can be moved to the destination list
-    @retval ENOTSUP the source list conflicts with the destination list
+    @retval EOK the notifications were moved
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
 int NOTIFY_Move( VAR_HANDLE hVar,
-                 Notification **ppSrc,
-                 Notification **ppDst )
+                 NotificationList *pSrc,
+                 NotificationList *pDst )
 {
-    Notification *p;
-    Notification *pNext;
     int result = EINVAL;
+    int type;
+    size_t i;
+    size_t n;
 
-    if ( ( ppSrc != NULL ) && ( ppDst != NULL ) )
+    if ( ( pSrc != NULL ) && ( pDst != NULL ) )
     {
         result = EOK;
 
-        /* initialize the pointer to point to the head of the source list */
-        p = *ppSrc;
-
-        while ( p != NULL )
+        /* reserve space in the destination list */
+        for( type = NOTIFY_MODIFIED;
+             ( type < NOTIFY_NUM_TYPES ) && ( result == EOK );
+             type++ )
         {
-            /* get a pointer to the next notification in the src list */
-            pNext = p->pNext;
+            n = 0;
+            for( i = 0; i < pSrc->count[type]; i++ )
+            {
+                if( pSrc->pEntries[type][i].hVar == hVar )
+                {
+                    n++;
+                }
+            }
+
+            result = notify_Reserve( pDst, type, n );
+        }
 
-            if ( p->hVar == hVar )
+        for( type = NOTIFY_MODIFIED;
+             ( type < NOTIFY_NUM_TYPES ) && ( result == EOK );
+             type++ )
+        {
+            i = 0;
+            while( i < pSrc->count[type] )
             {
-                /* insert the notificaton onto the head of the
-                   destination list */
-                p->pNext = *ppDst;
-                *ppDst = p;
+                if( pSrc->pEntries[type][i].hVar == hVar )
+                {
+                    /* append the notification to the destination list */
+                    n = pDst->count[type]++;
+                    pDst->pEntries[type][n] = pSrc->pEntries[type][i];
 
-                /* update the source pointer to skip over the removed
-                   notification */
-                *ppSrc = pNext;
+                    /* compact it out of the source list */
+                    notify_Remove( pSrc, type, i );
+                }
+                else
+                {
+                    i++;
+                }
             }
-            else
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NOTIFY_Size                                                               */
+/*!
+    Get the memory used by a notification list
+
+    The NOTIFY_Size function calculates the number of bytes allocated
+    for the notification arrays of the specified notification list.
+
+    @param[in]
+        pList
+            pointer to the notification list
+
+    @retval number of bytes allocated for the notification list
+
+==============================================================================*/
+size_t NOTIFY_Size( NotificationList *pList )
+{
+    size_t size = 0;
+    int type;
+
+    if( pList != NULL )
+    {
+        for( type = 0; type < NOTIFY_NUM_TYPES; type++ )
+        {
+            size += pList->size[type] * sizeof( Notification );
+        }
+    }
+
+    return size;
+}
+
+/*============================================================================*/
+/*  NOTIFY_ForEach                                                            */
+/*!
+    Visit the notification registrations of a variable
+
+    The NOTIFY_ForEach function calls the specified function for each
+    notification in the list which was requested via the specified
+    variable handle, with the subscription options needed to register
+    the notification again.  The iteration stops at the first call
+    which does not return EOK.
+
+    @param[in]
+        pList
+            pointer to the notification list
+
+    @param[in]
+        hVar
+            handle of the variable the notifications were requested on
+
+    @param[in]
+        fn
+            function to call for each notification
+
+    @param[in]
+        arg
+            opaque argument passed to the function
+
+    @retval EOK all of the notifications were visited
+    @retval EINVAL invalid arguments
+    @retval other error returned by the function
+
+==============================================================================*/
+int NOTIFY_ForEach( NotificationList *pList,
+                    VAR_HANDLE hVar,
+                    NotifyFn fn,
+                    void *arg )
+{
+    int result = EINVAL;
+    Notification *pNotification;
+    VarNotifyOptions options;
+    int type;
+    size_t i;
+
+    if( ( pList != NULL ) &&
+        ( fn != NULL ) )
+    {
+        result = EOK;
+
+        for( type = 0;
+             ( type < NOTIFY_NUM_TYPES ) && ( result == EOK );
+             type++ )
+        {
+            for( i = 0; ( i < pList->count[type] ) && ( result == EOK ); i++ )
             {
-                /* update the pointer to be modified for the next removal */
-                ppSrc = &(p->pNext);
-            }
+                pNotification = &pList->pEntries[type][i];
+                if( pNotification->hVar == hVar )
+                {
+                    memset( &options, 0, sizeof( options ) );
+                    options.flags = pNotification->options;
+                    options.minInterval_ms =
+                        pNotification->minInterval / 1000000ULL;
+                    options.deadband = pNotification->deadband;
+                    options.overflow = pNotification->overflow;
+                    if( type == NOTIFY_MODIFIED_QUEUE )
+                    {
+                        options.blockTimeout_ms =
+                            pNotification->blockTimeout / 1000000ULL;
+                    }
 
-            /* move to the next notification in the source list */
-            p = pNext;
+                    result = fn( hVar,
+                                 pNotification->type,
+                                 pNotification->pid,
+                                 &options,
+                                 arg );
+                }
+            }
         }
     }
 
@@ -932,48 +1175,998 @@ int NOTIFY_Move( VAR_HANDLE hVar,
     the type of notifications in the specified notification list.
 
     @param[in]
-        pNotification
+        pList
             pointer to the notification list to calculate the mask for
 
     @retval notification mask value
 
 ==============================================================================*/
-uint16_t NOTIFY_GetMask( Notification *pNotification )
+uint16_t NOTIFY_GetMask( NotificationList *pList )
 {
     uint16_t notifyMask = 0;
+    int type;
+    size_t i;
 
-    while ( pNotification != NULL )
+    if( pList != NULL )
     {
-        switch( pNotification->type )
+        for( type = NOTIFY_MODIFIED; type < NOTIFY_NUM_TYPES; type++ )
         {
-            case NOTIFY_CALC:
-                notifyMask |= NOTIFY_MASK_CALC;
-                break;
+            if( pList->count[type] > 0 )
+            {
+                notifyMask |= NotifyMasks[type];
+            }
+        }
 
-            case NOTIFY_MODIFIED:
-                notifyMask |= NOTIFY_MASK_MODIFIED;
+        for( i = 0; i < pList->count[NOTIFY_MODIFIED]; i++ )
+        {
+            if( pList->pEntries[NOTIFY_MODIFIED][i].options &
+                NOTIFY_OPT_COALESCE )
+            {
+                notifyMask |= NOTIFY_MASK_COALESCE;
                 break;
+            }
+        }
+    }
 
-            case NOTIFY_MODIFIED_QUEUE:
-                notifyMask |= NOTIFY_MASK_MODIFIED_QUEUE;
-                break;
+    return notifyMask;
+}
 
-            case NOTIFY_PRINT:
-                notifyMask |= NOTIFY_MASK_PRINT;
-                break;
+/*============================================================================*/
+/*  NOTIFY_Modified                                                           */
+/*!
+    Send NOTIFY_MODIFIED signals subject to the subscription options
 
-            case NOTIFY_VALIDATE:
-                notifyMask |= NOTIFY_MASK_VALIDATE;
-                break;
+    The NOTIFY_Modified function sends a NOTIFY_MODIFIED signal to each
+    subscriber of the variable, applying each subscription's options:
 
-            default:
-                break;
+    - NOTIFY_OPT_DEADBAND suppresses numeric changes which are within
+      the deadband of the last notified value
+    - NOTIFY_OPT_COALESCE suppresses changes while a notification is
+      still outstanding (see NOTIFY_Rearm)
+    - NOTIFY_OPT_RATE_LIMIT defers changes which occur within the minimum
+      interval of the last notification.  The deferred change is sent by
+      calling NOTIFY_Modified again, with deferred set, once the time
+      returned in pDue has been reached.
+
+    Within a notification group (see NOTIFY_BeginGroup) each subscriber
+    is only signalled once, for the first variable it subscribes to.
+
+    Suppressed changes are counted in the suppression metrics.
+    Subscribers which no longer exist are removed from the list.
+
+    @param[in]
+        pList
+            Pointer to the notification request list
+
+    @param[in]
+        pVarObject
+            pointer to the current value of the variable
+
+    @param[in]
+        deferred
+            true to only send the deferred (rate limited) notifications
+
+    @param[out]
+        pDue
+            location to store the earliest time (CLOCK_MONOTONIC nanoseconds)
+            a deferred notification is due, or 0 if there are none
+
+    @retval EOK at least one notification was sent
+    @retval ENOENT no notifications were sent
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int NOTIFY_Modified( NotificationList *pList,
+                     VarObject *pVarObject,
+                     bool deferred,
+                     uint64_t *pDue )
+{
+    int result = EINVAL;
+    Notification *p;
+    uint64_t now = 0;
+    uint64_t due = 0;
+    uint64_t next;
+    double value = 0.0;
+    bool numeric;
+    size_t i = 0;
+    int rc;
+
+    if( ( pList != NULL ) &&
+        ( pVarObject != NULL ) &&
+        ( pDue != NULL ) )
+    {
+        result = ENOENT;
+        numeric = notify_GetNumber( pVarObject, &value );
+
+        while( i < pList->count[NOTIFY_MODIFIED] )
+        {
+            p = &pList->pEntries[NOTIFY_MODIFIED][i++];
+
+            if( ( deferred == true ) && ( p->deferred == false ) )
+            {
+                /* nothing waiting for this subscriber */
+                continue;
+            }
+
+            if( ( p->options & NOTIFY_OPT_DEADBAND ) &&
+                ( numeric == true ) &&
+                ( p->lastSent != 0 ) &&
+                ( fabs( value - p->lastValue ) < p->deadband ) )
+            {
+                /* the change is within the deadband */
+                if( deferred == false )
+                {
+                    notify_Count( pDeadbandMetric );
+                }
+
+                p->deferred = false;
+                continue;
+            }
+
+            if( ( p->options & NOTIFY_OPT_COALESCE ) &&
+                ( p->pending == true ) )
+            {
+                /* the subscriber already has a notification outstanding */
+                if( deferred == false )
+                {
+                    notify_Count( pCoalescedMetric );
+                }
+
+                p->deferred = false;
+                continue;
+            }
+
+            if( p->options & NOTIFY_OPT_RATE_LIMIT )
+            {
+                if( now == 0 )
+                {
+                    now = NOTIFY_Now();
+                }
+
+                next = p->lastSent + p->minInterval;
+                if( ( p->lastSent != 0 ) && ( now < next ) )
+                {
+                    /* too soon, send the change when the interval expires */
+                    if( deferred == false )
+                    {
+                        notify_Count( pRateLimitedMetric );
+                    }
+
+                    p->deferred = true;
+                    if( ( due == 0 ) || ( next < due ) )
+                    {
+                        due = next;
+                    }
+
+                    continue;
+                }
+            }
+
+            if( notify_GroupSignalled( p->pid ) == true )
+            {
+                /* the subscriber was already signalled for this group */
+                notify_Count( pCoalescedMetric );
+                continue;
+            }
+
+            rc = notify_Send( p, p->hVar, SIGRTMIN+6 );
+            if( rc == EOK )
+            {
+                notify_GroupAdd( p->pid );
+
+                if( p->options != 0 )
+                {
+                    p->lastSent = ( now != 0 ) ? now : NOTIFY_Now();
+                    p->lastValue = value;
+                    p->deferred = false;
+                    p->pending = ( p->options & NOTIFY_OPT_COALESCE ) != 0;
+                }
+
+                result = EOK;
+            }
+            else if( rc == ESRCH )
+            {
+                /* the process that registered this notification is
+                   gone, compact it out of the list */
+                notify_Remove( pList, NOTIFY_MODIFIED, --i );
+            }
         }
 
-        pNotification = pNotification->pNext;
+        *pDue = due;
     }
 
-    return notifyMask;
+    return result;
+}
+
+/*============================================================================*/
+/*  NOTIFY_Rearm                                                              */
+/*!
+    Re-arm the coalesced notifications of a subscriber
+
+    The NOTIFY_Rearm function clears the outstanding notification of the
+    specified client's NOTIFY_OPT_COALESCE subscriptions.  It is called
+    when the client reads the variable, since at that point it has seen
+    the latest value and the next change needs to be notified again.
+
+    @param[in]
+        pList
+            Pointer to the notification request list
+
+    @param[in]
+        pid
+            process identifier of the client which read the variable
+
+==============================================================================*/
+void NOTIFY_Rearm( NotificationList *pList, pid_t pid )
+{
+    Notification *p;
+    size_t i;
+
+    if( pList != NULL )
+    {
+        for( i = 0; i < pList->count[NOTIFY_MODIFIED]; i++ )
+        {
+            p = &pList->pEntries[NOTIFY_MODIFIED][i];
+            if( ( p->pid == pid ) &&
+                ( p->options & NOTIFY_OPT_COALESCE ) )
+            {
+                p->pending = false;
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  NOTIFY_Now                                                                */
+/*!
+    Get the notification time base
+
+    The NOTIFY_Now function gets the current CLOCK_MONOTONIC time in
+    nanoseconds, which is the time base used for notification rate limits.
+
+    @retval current time in nanoseconds
+
+==============================================================================*/
+uint64_t NOTIFY_Now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*============================================================================*/
+/*  NOTIFY_SetSuppressionMetrics                                              */
+/*!
+    Set the pointers to the notification suppression metrics
+
+    The NOTIFY_SetSuppressionMetrics function sets the pointers to the
+    counters of NOTIFY_MODIFIED notifications suppressed by each of the
+    subscription options.
+
+    @param[in]
+        pCoalesced
+            pointer to the coalesced notification counter
+
+    @param[in]
+        pRateLimited
+            pointer to the rate limited notification counter
+
+    @param[in]
+        pDeadband
+            pointer to the deadband suppressed notification counter
+
+==============================================================================*/
+void NOTIFY_SetSuppressionMetrics( uint64_t *pCoalesced,
+                                   uint64_t *pRateLimited,
+                                   uint64_t *pDeadband )
+{
+    pCoalescedMetric = pCoalesced;
+    pRateLimitedMetric = pRateLimited;
+    pDeadbandMetric = pDeadband;
+}
+
+/*============================================================================*/
+/*  NOTIFY_SetOverflowMetrics                                                 */
+/*!
+    Set the pointers to the notification queue overflow metrics
+
+    The NOTIFY_SetOverflowMetrics function sets the pointers to the
+    counters of NOTIFY_MODIFIED_QUEUE changes which were discarded, or
+    coalesced, because the notification queue of the subscriber was full.
+
+    @param[in]
+        pDropped
+            pointer to the discarded change counter
+
+    @param[in]
+        pCoalesced
+            pointer to the coalesced change counter
+
+==============================================================================*/
+void NOTIFY_SetOverflowMetrics( uint64_t *pDropped, uint64_t *pCoalesced )
+{
+    pQueueDroppedMetric = pDropped;
+    pQueueCoalescedMetric = pCoalesced;
+}
+
+/*============================================================================*/
+/*  NOTIFY_SetOverflowHandler                                                 */
+/*!
+    Set the notification queue overflow handler
+
+    The NOTIFY_SetOverflowHandler function sets the function which is
+    called with the process identifier of the subscriber each time a
+    change finds its notification queue full.
+
+    @param[in]
+        handler
+            pointer to the overflow handler, or NULL for none
+
+==============================================================================*/
+void NOTIFY_SetOverflowHandler( void (*handler)( pid_t pid ) )
+{
+    pOverflowHandler = handler;
+}
+
+/*============================================================================*/
+/*  NOTIFY_BeginGroup                                                         */
+/*!
+    Begin a notification group
+
+    The NOTIFY_BeginGroup function starts a notification group.  Until
+    NOTIFY_EndGroup is called, each NOTIFY_MODIFIED subscriber is only
+    signalled once, no matter how many of the changed variables it
+    subscribes to.
+
+==============================================================================*/
+void NOTIFY_BeginGroup( void )
+{
+    groupInProgress = true;
+    groupCount = 0;
+}
+
+/*============================================================================*/
+/*  NOTIFY_EndGroup                                                           */
+/*!
+    End a notification group
+
+    The NOTIFY_EndGroup function ends the notification group started by
+    NOTIFY_BeginGroup.
+
+==============================================================================*/
+void NOTIFY_EndGroup( void )
+{
+    groupInProgress = false;
+    groupCount = 0;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  notify_ValidType                                                          */
+/*!
+    Check if a notification type can be stored in a notification list
+
+    @param[in]
+        type
+            notification type to check
+
+    @retval true the notification type is valid
+    @retval false the notification type is not valid
+
+==============================================================================*/
+static bool notify_ValidType( NotificationType type )
+{
+    return ( type > NOTIFY_NONE ) && ( type < NOTIFY_NUM_TYPES );
+}
+
+/*============================================================================*/
+/*  notify_Reserve                                                            */
+/*!
+    Reserve space in a notification array
+
+    The notify_Reserve function grows the notification array of the
+    specified type so it can hold at least n more notifications.
+
+    @param[in,out]
+        pList
+            pointer to the notification list
+
+    @param[in]
+        type
+            notification type of the array to grow
+
+    @param[in]
+        n
+            number of additional notifications to make room for
+
+    @retval EOK the space was reserved
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int notify_Reserve( NotificationList *pList,
+                           NotificationType type,
+                           size_t n )
+{
+    int result = EOK;
+    size_t size;
+    Notification *p;
+
+    size = pList->size[type];
+    if( size == 0 )
+    {
+        size = NOTIFY_INITIAL_SIZE;
+    }
+
+    while( size < pList->count[type] + n )
+    {
+        size *= 2;
+    }
+
+    if( size != pList->size[type] )
+    {
+        p = SLAB_ResizeBuffer( pList->pEntries[type],
+                               pList->size[type] * sizeof( Notification ),
+                               size * sizeof( Notification ) );
+        if( p != NULL )
+        {
+            STATS_MemAlloc( STATS_MEM_NOTIFICATIONS,
+                            0,
+                            ( size - pList->size[type] ) *
+                            sizeof( Notification ) );
+            pList->pEntries[type] = p;
+            pList->size[type] = size;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  notify_Append                                                             */
+/*!
+    Append a new Notification object to a notification array
+
+    The notify_Append function adds a new, cleared, Notification object
+    to the end of the notification array for the specified type.
+
+    @param[in,out]
+        pList
+            pointer to the notification list
+
+    @param[in]
+        type
+            notification type
+
+    @retval pointer to a new Notification object
+    @retval NULL if a new Notification object could not be allocated
+
+==============================================================================*/
+static Notification *notify_Append( NotificationList *pList,
+                                    NotificationType type )
+{
+    Notification *pNotification = NULL;
+
+    if( notify_Reserve( pList, type, 1 ) == EOK )
+    {
+        pNotification = &pList->pEntries[type][pList->count[type]++];
+        memset( pNotification, 0, sizeof( Notification ) );
+        STATS_MemAlloc( STATS_MEM_NOTIFICATIONS, 1, 0 );
+        pNotification->mq = (mqd_t)-1;
+    }
+
+    return pNotification;
+}
+
+/*============================================================================*/
+/*  notify_Remove                                                             */
+/*!
+    Remove a Notification object from a notification array
+
+    The notify_Remove function removes the notification at the specified
+    index from its notification array.  The remaining notifications are
+    moved down to keep the array contiguous and in registration order.
+
+    @param[in,out]
+        pList
+            pointer to the notification list
+
+    @param[in]
+        type
+            notification type
+
+    @param[in]
+        idx
+            index of the notification to remove
+
+==============================================================================*/
+static void notify_Remove( NotificationList *pList,
+                           NotificationType type,
+                           size_t idx )
+{
+    Notification *pEntries = pList->pEntries[type];
+    size_t count = pList->count[type];
+
+    if( idx < count )
+    {
+        memmove( &pEntries[idx],
+                 &pEntries[idx + 1],
+                 ( count - idx - 1 ) * sizeof( Notification ) );
+
+        pList->count[type] = count - 1;
+        STATS_MemFree( STATS_MEM_NOTIFICATIONS, 1, 0 );
+    }
+}
+
+/*============================================================================*/
+/*  notify_Send                                                               */
+/*!
+    Send a notification signal
+
+    The notify_Send function sends out a notification signal
+    to the client referenced in the notification object.
+
+    @param[in]
+        pNotification
+            pointer to the notification to send
+
+    @param[in]
+        handle
+            notification handle
+
+    @param[in]
+        signal
+            signal to send
+
+    @retval EOK the notifications was sent
+    @retval ESRCH the process which reqeusted the notification does not exist
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int notify_Send( Notification *pNotification,
+                        int handle,
+                        int signal )
+{
+    int result = EINVAL;
+    union sigval val;
+    uint64_t start;
+    int rc;
+
+    if( pNotification != NULL )
+    {
+        /* provide the signal handle to the var server */
+        val.sival_int = handle;
+
+        /* queue the notification */
+        if( TRACE_ENABLED() )
+        {
+            start = STATS_Now();
+            rc = sigqueue( pNotification->pid, signal, val );
+            result = ( rc == -1 ) ? errno : EOK;
+            TRACE_Record( TRACE_EVENT_SIGNAL,
+                          signal,
+                          pNotification->clientID,
+                          handle,
+                          result,
+                          start,
+                          STATS_Now() - start );
+        }
+        else
+        {
+            rc = sigqueue( pNotification->pid, signal, val );
+            result = ( rc == -1 ) ? errno : EOK;
+        }
+    }
+    else
+    {
+        result = ENOENT;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  notify_GetQueue                                                           */
+/*!
+    Get the notification queue for a client process
+
+    The notify_GetQueue function gets the notification queue associated
+    with the client specified via its pid.
+
+    The queue is opened for reading as well for the
+    NOTIFY_OVERFLOW_DROP_OLDEST policy, so the oldest message can be
+    discarded, and is opened blocking for the NOTIFY_OVERFLOW_BLOCK
+    policy.
+
+    @param[in]
+        pid
+            process identifier of the client process
+
+    @param[in]
+        overflow
+            overflow policy of the subscription
+
+    @retval message queue descriptor
+    @retval -1 if the message queue does not exist
+
+==============================================================================*/
+static mqd_t notify_GetQueue( pid_t pid, NotifyOverflowPolicy overflow )
+{
+    char clientname[BUFSIZ];
+    mqd_t mq;
+    int flags = O_WRONLY | O_NONBLOCK;
+
+    if ( overflow == NOTIFY_OVERFLOW_DROP_OLDEST )
+    {
+        flags = O_RDWR | O_NONBLOCK;
+    }
+    else if ( overflow == NOTIFY_OVERFLOW_BLOCK )
+    {
+        flags = O_WRONLY;
+    }
+
+    /* build the varclient identifier */
+    sprintf(clientname, "/varclient_%d", pid);
+
+    mq = mq_open( clientname, flags );
+    if ( mq == -1 )
+    {
+        printf("Failed to open %s : %s\n", clientname, strerror(errno));
+    }
+    return mq;
+}
+
+/*============================================================================*/
+/*  notify_QueueSend                                                          */
+/*!
+    Send a message to the notification queue of a subscriber
+
+    The notify_QueueSend function sends a message to the notification
+    queue of the subscriber.  A NOTIFY_OVERFLOW_BLOCK queue is waited
+    on for up to the block timeout of the subscription.
+
+    @param[in]
+        pNotification
+            pointer to the subscription
+
+    @param[in]
+        buf
+            pointer to the message to send
+
+    @param[in]
+        len
+            length of the message
+
+    @retval EOK the message was queued
+    @retval EAGAIN the queue is full
+    @retval ETIMEDOUT the queue stayed full for the block timeout
+    @retval other error from mq_send or mq_timedsend
+
+==============================================================================*/
+static int notify_QueueSend( Notification *pNotification,
+                             void *buf,
+                             size_t len )
+{
+    struct timespec deadline;
+    uint64_t t;
+    int rc;
+
+    if ( ( pNotification->overflow == NOTIFY_OVERFLOW_BLOCK ) &&
+         ( clock_gettime( CLOCK_REALTIME, &deadline ) == 0 ) )
+    {
+        t = (uint64_t)deadline.tv_nsec + pNotification->blockTimeout;
+        deadline.tv_sec += t / 1000000000ULL;
+        deadline.tv_nsec = t % 1000000000ULL;
+
+        rc = mq_timedsend( pNotification->mq, buf, len, 0, &deadline );
+    }
+    else
+    {
+        rc = mq_send( pNotification->mq, buf, len, 0 );
+    }
+
+    return ( rc == 0 ) ? EOK : errno;
+}
+
+/*============================================================================*/
+/*  notify_Overflow                                                           */
+/*!
+    Apply the overflow policy of a subscription with a full queue
+
+    The notify_Overflow function applies the overflow policy of a
+    subscription whose notification queue is full, and counts the
+    overflow against the subscriber.
+
+    - NOTIFY_OVERFLOW_DROP_NEWEST and NOTIFY_OVERFLOW_BLOCK discard
+      the change
+    - NOTIFY_OVERFLOW_DROP_OLDEST discards the oldest queued message
+      and sends the change in its place
+    - NOTIFY_OVERFLOW_COALESCE keeps the change to be sent when there
+      is room, replacing any change which is already being kept
+
+    @param[in]
+        pNotification
+            pointer to the subscription
+
+    @param[in]
+        buf
+            pointer to the message which did not fit
+
+    @param[in]
+        len
+            length of the message
+
+    @param[in,out]
+        pDue
+            pointer to the time the next coalesced change is due
+            (CLOCK_MONOTONIC ns), 0 for none, which is updated if
+            the change is kept
+
+    @retval EOK the change was sent in place of the oldest message
+    @retval EAGAIN the change was discarded, or kept to send later
+    @retval EBADF the queue is no longer valid
+
+==============================================================================*/
+static int notify_Overflow( Notification *pNotification,
+                            void *buf,
+                            size_t len,
+                            uint64_t *pDue )
+{
+    int result = EAGAIN;
+    uint64_t due;
+    bool counted = pNotification->deferred;
+
+    if ( pNotification->overflow == NOTIFY_OVERFLOW_COALESCE )
+    {
+        /* only the latest value is kept, so a change is only
+           counted once however many times it is retried */
+        pNotification->deferred = true;
+
+        due = NOTIFY_Now() + NOTIFY_COALESCE_RETRY;
+        if ( ( *pDue == 0 ) || ( due < *pDue ) )
+        {
+            *pDue = due;
+        }
+
+        if ( counted == false )
+        {
+            notify_Count( pQueueCoalescedMetric );
+        }
+    }
+    else
+    {
+        if ( ( pNotification->overflow == NOTIFY_OVERFLOW_DROP_OLDEST ) &&
+             ( notify_DiscardOldest( pNotification ) == EOK ) )
+        {
+            result = notify_QueueSend( pNotification, buf, len );
+        }
+
+        notify_Count( pQueueDroppedMetric );
+    }
+
+    if ( ( counted == false ) &&
+         ( pOverflowHandler != NULL ) )
+    {
+        pOverflowHandler( pNotification->pid );
+    }
+
+    if ( ( result != EOK ) &&
+         ( result != EBADF ) )
+    {
+        /* the change was not queued */
+        result = EAGAIN;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  notify_DiscardOldest                                                      */
+/*!
+    Discard the oldest message from a notification queue
+
+    @param[in]
+        pNotification
+            pointer to the subscription whose queue is full
+
+    @retval EOK the oldest message was discarded
+    @retval ENOMEM the discard buffer could not be allocated
+    @retval other error from mq_getattr or mq_receive
+
+==============================================================================*/
+static int notify_DiscardOldest( Notification *pNotification )
+{
+    int result = EOK;
+    struct mq_attr attr;
+    char *p;
+
+    if ( mq_getattr( pNotification->mq, &attr ) != 0 )
+    {
+        result = errno;
+    }
+    else if ( (size_t)attr.mq_msgsize > discardSize )
+    {
+        p = realloc( pDiscard, attr.mq_msgsize );
+        if ( p != NULL )
+        {
+            pDiscard = p;
+            discardSize = attr.mq_msgsize;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( ( result == EOK ) &&
+         ( mq_receive( pNotification->mq,
+                       pDiscard,
+                       discardSize,
+                       NULL ) == -1 ) )
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  notify_GetNumber                                                          */
+/*!
+    Get the numeric value of a variable
+
+    The notify_GetNumber function converts the value of a numeric variable
+    to a double for deadband comparisons.
+
+    @param[in]
+        pVarObject
+            pointer to the variable value
+
+    @param[out]
+        pValue
+            location to store the numeric value
+
+    @retval true the variable is numeric
+    @retval false the variable is not numeric
+
+==============================================================================*/
+static bool notify_GetNumber( VarObject *pVarObject, double *pValue )
+{
+    bool numeric = true;
+
+    switch( pVarObject->type )
+    {
+        case VARTYPE_UINT16:
+            *pValue = pVarObject->val.ui;
+            break;
+
+        case VARTYPE_INT16:
+            *pValue = pVarObject->val.i;
+            break;
+
+        case VARTYPE_UINT32:
+            *pValue = pVarObject->val.ul;
+            break;
+
+        case VARTYPE_INT32:
+            *pValue = pVarObject->val.l;
+            break;
+
+        case VARTYPE_UINT64:
+            *pValue = (double)pVarObject->val.ull;
+            break;
+
+        case VARTYPE_INT64:
+            *pValue = (double)pVarObject->val.ll;
+            break;
+
+        case VARTYPE_FLOAT:
+            *pValue = pVarObject->val.f;
+            break;
+
+        default:
+            numeric = false;
+            break;
+    }
+
+    return numeric;
+}
+
+/*============================================================================*/
+/*  notify_Count                                                              */
+/*!
+    Increment a notification metric
+
+    @param[in]
+        pMetric
+            pointer to the metric to increment (may be NULL)
+
+==============================================================================*/
+static void notify_Count( uint64_t *pMetric )
+{
+    if( pMetric != NULL )
+    {
+        (*pMetric)++;
+    }
+}
+
+/*============================================================================*/
+/*  notify_GroupSignalled                                                     */
+/*!
+    Check if a subscriber was signalled in the current notification group
+
+    @param[in]
+        pid
+            process identifier of the subscriber
+
+    @retval true the subscriber was already signalled in the group
+    @retval false the subscriber was not signalled, or there is no group
+
+==============================================================================*/
+static bool notify_GroupSignalled( pid_t pid )
+{
+    bool result = false;
+    size_t i;
+
+    if( groupInProgress == true )
+    {
+        for( i = 0; i < groupCount; i++ )
+        {
+            if( groupPIDs[i] == pid )
+            {
+                result = true;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  notify_GroupAdd                                                           */
+/*!
+    Record a subscriber signalled in the current notification group
+
+    If the subscriber list cannot be grown, the subscriber is not
+    recorded and may be signalled again for the group.
+
+    @param[in]
+        pid
+            process identifier of the subscriber
+
+==============================================================================*/
+static void notify_GroupAdd( pid_t pid )
+{
+    pid_t *p;
+    size_t size;
+
+    if( groupInProgress == true )
+    {
+        if( groupCount == groupSize )
+        {
+            size = ( groupSize == 0 ) ? NOTIFY_INITIAL_SIZE : groupSize * 2;
+            p = realloc( groupPIDs, size * sizeof( pid_t ) );
+            if( p != NULL )
+            {
+                groupPIDs = p;
+                groupSize = size;
+            }
+        }
+
+        if( groupCount < groupSize )
+        {
+            groupPIDs[groupCount++] = pid;
+        }
+    }
 }
 
 /*! @}
@@ -0,0 +1,448 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+
+/*!
+ * @defgroup permsets permsets
+ * @brief Precomputed permission sets
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file permsets.c
+
+    Precomputed Permission Sets
+
+    The Precomputed Permission Sets module assigns a bit to each group
+    identifier which appears in the read or write permissions of a
+    variable, so the permissions of a variable, and the group list of
+    a client, can each be held as a 64-bit set.  A permission check is
+    then a single AND of the two sets.
+
+    The group list of each client is resolved once when the client
+    connects and again whenever the client updates its user, rather
+    than being copied into every request.  Group identifiers beyond the
+    available bits share the overflow bit, and a check which involves
+    the overflow bit falls back to comparing the group identifiers.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/types.h>
+#include "permsets.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! resolved credentials of a client */
+typedef struct _PermClient
+{
+    /*! group list of the client */
+    gid_t gids[VARSERVER_MAX_CLIENT_GIDS];
+
+    /*! number of groups in the group list */
+    size_t n;
+
+    /*! permission set of the group list */
+    uint64_t groupset;
+
+    /*! bit assignment generation the permission set was resolved at */
+    uint64_t generation;
+
+} PermClient;
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! group identifiers which have been assigned a permission bit */
+static gid_t groups[PERMSET_MAX_GROUPS];
+
+/*! number of group identifiers which have been assigned a permission bit */
+static size_t ngroups = 0;
+
+/*! incremented each time a group identifier is assigned a permission bit */
+static uint64_t generation = 1;
+
+/*! identifier of the user which started the variable server */
+static uid_t varserver_uid;
+
+/*! resolved credentials of each client, indexed by client identifier */
+static PermClient *clients = NULL;
+
+/*! number of entries in the client credentials table */
+static size_t nclients = 0;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int permsets_Find( gid_t gid );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  PERMSETS_Init                                                             */
+/*!
+    Initialize the precomputed permission sets
+
+    The PERMSETS_Init function allocates the client credentials table
+    and records the user which started the variable server.  Clients
+    running as this user, or as root, are privileged.
+
+    @param[in]
+        maxClients
+            maximum number of client identifiers
+
+    @param[in]
+        uid
+            user identifier of the variable server
+
+    @retval EOK the permission sets were initialized
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+int PERMSETS_Init( size_t maxClients, uid_t uid )
+{
+    int result = ENOMEM;
+
+    varserver_uid = uid;
+
+    clients = calloc( maxClients, sizeof( PermClient ) );
+    if ( clients != NULL )
+    {
+        nclients = maxClients;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PERMSETS_FromPermissions                                                  */
+/*!
+    Get the permission set of a variable permission list
+
+    The PERMSETS_FromPermissions function assigns a bit to each group
+    identifier in the list which does not already have one, and returns
+    the set of bits for the list.  Once all the bits are assigned, the
+    remaining group identifiers are represented by the overflow bit.
+
+    @param[in]
+        gids
+            pointer to the read or write permission list of a variable
+
+    @param[in]
+        n
+            number of group identifiers in the list
+
+    @retval the permission set of the list
+
+==============================================================================*/
+uint64_t PERMSETS_FromPermissions( const gid_t *gids, size_t n )
+{
+    uint64_t set = 0;
+    size_t i;
+    int bit;
+
+    if ( gids != NULL )
+    {
+        for ( i = 0; ( i < n ) && ( i < VARSERVER_MAX_UIDS ); i++ )
+        {
+            bit = permsets_Find( gids[i] );
+            if ( ( bit < 0 ) && ( ngroups < PERMSET_MAX_GROUPS ) )
+            {
+                /* assign the next bit to this group identifier */
+                bit = (int)ngroups;
+                groups[ngroups++] = gids[i];
+                generation++;
+            }
+
+            set |= ( bit < 0 ) ? PERMSET_OVERFLOW : ( (uint64_t)1 << bit );
+        }
+    }
+
+    return set;
+}
+
+/*============================================================================*/
+/*  PERMSETS_Resolve                                                          */
+/*!
+    Get the permission set of a client group list
+
+    The PERMSETS_Resolve function returns the set of bits assigned to
+    the group identifiers in a client group list.  It sets the
+    privileged bit if the list includes root or the variable server
+    user, and the overflow bit if it includes a group identifier
+    which has not been assigned a bit.
+
+    @param[in]
+        gids
+            pointer to the client group list
+
+    @param[in]
+        n
+            number of group identifiers in the list
+
+    @retval the permission set of the group list
+
+==============================================================================*/
+uint64_t PERMSETS_Resolve( const gid_t *gids, size_t n )
+{
+    uint64_t set = 0;
+    size_t i;
+    int bit;
+
+    if ( gids != NULL )
+    {
+        for ( i = 0; i < n; i++ )
+        {
+            if ( ( gids[i] == 0 ) || ( gids[i] == varserver_uid ) )
+            {
+                set |= PERMSET_PRIVILEGED;
+            }
+
+            bit = permsets_Find( gids[i] );
+            set |= ( bit < 0 ) ? PERMSET_OVERFLOW : ( (uint64_t)1 << bit );
+        }
+    }
+
+    return set;
+}
+
+/*============================================================================*/
+/*  PERMSETS_Generation                                                       */
+/*!
+    Get the bit assignment generation
+
+    The PERMSETS_Generation function gets a counter which is incremented
+    each time a group identifier is assigned a bit.  A permission set
+    resolved at an earlier generation may be missing bits for groups
+    which were assigned since, and must be resolved again.
+
+    @retval the current bit assignment generation
+
+==============================================================================*/
+uint64_t PERMSETS_Generation( void )
+{
+    return generation;
+}
+
+/*============================================================================*/
+/*  PERMSETS_SetClient                                                        */
+/*!
+    Record the group list of a client
+
+    The PERMSETS_SetClient function stores the group list of a client
+    and resolves its permission set.  It is called when the client
+    connects, and when it updates its user.  A group list of length
+    zero clears the entry.
+
+    @param[in]
+        clientid
+            client identifier
+
+    @param[in]
+        gids
+            pointer to the client group list
+
+    @param[in]
+        n
+            number of group identifiers in the list
+
+    @retval EOK the client group list was recorded
+    @retval E2BIG the group list is too long, and was truncated
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int PERMSETS_SetClient( int clientid, const gid_t *gids, int n )
+{
+    int result = EINVAL;
+    PermClient *pClient;
+
+    if ( ( clientid > 0 ) &&
+         ( (size_t)clientid < nclients ) &&
+         ( gids != NULL ) )
+    {
+        pClient = &clients[clientid];
+        result = EOK;
+
+        if ( n < 0 )
+        {
+            n = 0;
+        }
+        else if ( n > VARSERVER_MAX_CLIENT_GIDS )
+        {
+            n = VARSERVER_MAX_CLIENT_GIDS;
+            result = E2BIG;
+        }
+
+        memcpy( pClient->gids, gids, n * sizeof( gid_t ) );
+        pClient->n = n;
+        pClient->groupset = PERMSETS_Resolve( pClient->gids, pClient->n );
+        pClient->generation = generation;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PERMSETS_Apply                                                            */
+/*!
+    Apply the credentials of a client to its request
+
+    The PERMSETS_Apply function stores the resolved credentials of the
+    client into the VarInfo object of its request, resolving the
+    permission set again if groups have been assigned bits since it
+    was last resolved.  Credentials supplied by the client itself
+    are overwritten.  A client without recorded credentials is
+    given none.
+
+    @param[in]
+        clientid
+            client identifier
+
+    @param[in,out]
+        pVarInfo
+            pointer to the VarInfo object of the client request
+
+    @retval EOK the client credentials were applied
+    @retval ENOENT the client has no recorded credentials
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int PERMSETS_Apply( int clientid, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    PermClient *pClient;
+
+    if ( pVarInfo != NULL )
+    {
+        pVarInfo->groupset = 0;
+        pVarInfo->ncreds = 0;
+        result = ENOENT;
+
+        if ( ( clientid > 0 ) &&
+             ( (size_t)clientid < nclients ) &&
+             ( clients[clientid].n > 0 ) )
+        {
+            pClient = &clients[clientid];
+            if ( pClient->generation != generation )
+            {
+                pClient->groupset = PERMSETS_Resolve( pClient->gids,
+                                                      pClient->n );
+                pClient->generation = generation;
+            }
+
+            memcpy( pVarInfo->creds,
+                    pClient->gids,
+                    pClient->n * sizeof( gid_t ) );
+            pVarInfo->ncreds = pClient->n;
+            pVarInfo->groupset = pClient->groupset;
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PERMSETS_IsPrivileged                                                     */
+/*!
+    Determine if a client is privileged
+
+    The PERMSETS_IsPrivileged function checks if the recorded group
+    list of a client contains root or the user which started the
+    variable server.
+
+    @param[in]
+        clientid
+            client identifier
+
+    @retval true the client is privileged
+    @retval false the client is not privileged, or is unknown
+
+==============================================================================*/
+bool PERMSETS_IsPrivileged( int clientid )
+{
+    bool privileged = false;
+
+    if ( ( clientid > 0 ) &&
+         ( (size_t)clientid < nclients ) )
+    {
+        privileged = ( clients[clientid].groupset & PERMSET_PRIVILEGED ) != 0;
+    }
+
+    return privileged;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  permsets_Find                                                             */
+/*!
+    Find the bit assigned to a group identifier
+
+    @param[in]
+        gid
+            group identifier to look up
+
+    @retval index of the bit assigned to the group identifier
+    @retval -1 the group identifier has not been assigned a bit
+
+==============================================================================*/
+static int permsets_Find( gid_t gid )
+{
+    int bit = -1;
+    size_t i;
+
+    for ( i = 0; i < ngroups; i++ )
+    {
+        if ( groups[i] == gid )
+        {
+            bit = (int)i;
+            break;
+        }
+    }
+
+    return bit;
+}
+
+/*! @}
+ * end of permsets group */
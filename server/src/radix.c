@@ -0,0 +1,645 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup radix Radix Tree Name Index
+ * @brief Radix tree index of variable names for prefix queries
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file radix.c
+
+    Radix Tree Name Index
+
+    The Radix Tree Name Index maintains a compressed (patricia) trie of
+    the variable names, alongside the hash table, so that all the
+    variables sharing a name prefix (for example a "/sys/net/" path) can
+    be visited without scanning the entire variable list.
+
+    Keys are stored in lower case since variable names are case
+    insensitive.  Each node holds the edge label from its parent, its
+    children sorted by the first character of their labels, and the list
+    of objects whose name ends exactly at the node.  Several objects may
+    share a name (for example different instances of the same variable).
+
+    Walks visit the objects in lexical order of their names.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include "radix.h"
+
+/*==============================================================================
+        Private types
+==============================================================================*/
+
+/*! object stored at a radix tree node */
+typedef struct _RadixEntry
+{
+    /*! pointer to the stored object */
+    void *object;
+
+    /*! pointer to the next object with the same name */
+    struct _RadixEntry *pNext;
+
+} RadixEntry;
+
+/*! radix tree node */
+typedef struct _RadixNode
+{
+    /*! edge label from the parent node (not NUL terminated) */
+    char *label;
+
+    /*! length of the edge label */
+    size_t len;
+
+    /*! child nodes sorted by the first character of their label */
+    struct _RadixNode **pChildren;
+
+    /*! number of child nodes */
+    size_t numChildren;
+
+    /*! number of allocated child node pointers */
+    size_t maxChildren;
+
+    /*! objects whose name ends at this node */
+    RadixEntry *pEntries;
+
+} RadixNode;
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! root node of the radix tree */
+static RadixNode root;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static RadixNode *radix_NewNode( const char *label, size_t len );
+static RadixNode **radix_FindChild( RadixNode *pNode, char c );
+static int radix_AddChild( RadixNode *pNode, RadixNode *pChild );
+static RadixNode *radix_Split( RadixNode **ppNode, size_t len );
+static size_t radix_Common( RadixNode *pNode, const char *key );
+static int radix_Visit( RadixNode *pNode, RadixWalkFn fn, void *arg );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  RADIX_Add                                                                 */
+/*!
+    Add an object to the radix tree
+
+    The RADIX_Add function adds an object to the radix tree under the
+    specified name, splitting existing edges where necessary.
+
+    @param[in]
+        name
+            name of the object
+
+    @param[in]
+        object
+            pointer to the object to store
+
+    @retval EOK the object was added to the radix tree
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int RADIX_Add( const char *name, void *object )
+{
+    int result = EINVAL;
+    RadixNode *pNode = &root;
+    RadixNode **ppChild;
+    RadixNode *pChild;
+    RadixEntry *pEntry;
+    RadixEntry **ppEntry;
+    size_t len;
+
+    if ( ( name != NULL ) && ( object != NULL ) )
+    {
+        result = EOK;
+
+        while ( ( *name != '\0' ) && ( result == EOK ) )
+        {
+            ppChild = radix_FindChild( pNode, *name );
+            if ( ppChild == NULL )
+            {
+                /* no edge starts with this character, add a leaf */
+                pChild = radix_NewNode( name, strlen( name ) );
+                result = ( pChild != NULL ) ? radix_AddChild( pNode, pChild )
+                                            : ENOMEM;
+                pNode = pChild;
+                name += strlen( name );
+            }
+            else
+            {
+                len = radix_Common( *ppChild, name );
+                if ( len < (*ppChild)->len )
+                {
+                    /* the name diverges part way along this edge */
+                    pChild = radix_Split( ppChild, len );
+                    result = ( pChild != NULL ) ? EOK : ENOMEM;
+                }
+                else
+                {
+                    pChild = *ppChild;
+                }
+
+                pNode = pChild;
+                name += len;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            pEntry = calloc( 1, sizeof( RadixEntry ) );
+            if ( pEntry != NULL )
+            {
+                /* append to keep the objects in insertion order */
+                pEntry->object = object;
+                ppEntry = &pNode->pEntries;
+                while ( *ppEntry != NULL )
+                {
+                    ppEntry = &((*ppEntry)->pNext);
+                }
+
+                *ppEntry = pEntry;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RADIX_Delete                                                              */
+/*!
+    Remove an object from the radix tree
+
+    The RADIX_Delete function removes the specified object from the
+    radix tree.  The tree nodes are retained.
+
+    @param[in]
+        name
+            name of the object
+
+    @param[in]
+        object
+            pointer to the object to remove
+
+    @retval EOK the object was removed from the radix tree
+    @retval ENOENT the object was not found
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int RADIX_Delete( const char *name, void *object )
+{
+    int result = EINVAL;
+    RadixNode *pNode = &root;
+    RadixNode **ppChild;
+    RadixEntry **ppEntry;
+    RadixEntry *pEntry;
+    size_t len;
+
+    if ( ( name != NULL ) && ( object != NULL ) )
+    {
+        result = ENOENT;
+
+        while ( ( *name != '\0' ) && ( pNode != NULL ) )
+        {
+            ppChild = radix_FindChild( pNode, *name );
+            pNode = NULL;
+            if ( ppChild != NULL )
+            {
+                len = radix_Common( *ppChild, name );
+                if ( len == (*ppChild)->len )
+                {
+                    pNode = *ppChild;
+                    name += len;
+                }
+            }
+        }
+
+        if ( pNode != NULL )
+        {
+            ppEntry = &pNode->pEntries;
+            while ( *ppEntry != NULL )
+            {
+                if ( (*ppEntry)->object == object )
+                {
+                    pEntry = *ppEntry;
+                    *ppEntry = pEntry->pNext;
+                    free( pEntry );
+                    result = EOK;
+                    break;
+                }
+
+                ppEntry = &((*ppEntry)->pNext);
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RADIX_Walk                                                                */
+/*!
+    Visit all the objects whose name starts with a prefix
+
+    The RADIX_Walk function descends the radix tree to the subtree
+    matching the specified (case insensitive) prefix, and invokes the
+    callback function for each object in that subtree in lexical
+    name order.  The walk stops early if the callback returns a value
+    other than EOK.
+
+    @param[in]
+        prefix
+            name prefix to search for.  An empty prefix visits every object
+
+    @param[in]
+        fn
+            callback function invoked for each object
+
+    @param[in]
+        arg
+            opaque argument passed to the callback function
+
+    @retval EOK the walk completed
+    @retval ENOENT no names start with the specified prefix
+    @retval EINVAL invalid arguments
+    @retval other the value returned by the callback to stop the walk
+
+==============================================================================*/
+int RADIX_Walk( const char *prefix, RadixWalkFn fn, void *arg )
+{
+    int result = EINVAL;
+    RadixNode *pNode = &root;
+    RadixNode **ppChild;
+    size_t len;
+
+    if ( ( prefix != NULL ) && ( fn != NULL ) )
+    {
+        while ( ( *prefix != '\0' ) && ( pNode != NULL ) )
+        {
+            ppChild = radix_FindChild( pNode, *prefix );
+            pNode = NULL;
+            if ( ppChild != NULL )
+            {
+                len = radix_Common( *ppChild, prefix );
+                if ( ( len == (*ppChild)->len ) ||
+                     ( prefix[len] == '\0' ) )
+                {
+                    /* the prefix follows (or ends within) this edge */
+                    pNode = *ppChild;
+                    prefix += len;
+                }
+            }
+        }
+
+        result = ( pNode != NULL ) ? radix_Visit( pNode, fn, arg ) : ENOENT;
+    }
+
+    return result;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  radix_NewNode                                                             */
+/*!
+    Allocate a new radix tree node
+
+    The radix_NewNode function allocates a new radix tree node with
+    a lower case copy of the specified edge label.
+
+    @param[in]
+        label
+            pointer to the edge label
+
+    @param[in]
+        len
+            length of the edge label
+
+    @retval pointer to the new node
+    @retval NULL memory allocation failure
+
+==============================================================================*/
+static RadixNode *radix_NewNode( const char *label, size_t len )
+{
+    RadixNode *pNode;
+    size_t i;
+
+    pNode = calloc( 1, sizeof( RadixNode ) );
+    if ( pNode != NULL )
+    {
+        pNode->label = malloc( len + 1 );
+        if ( pNode->label != NULL )
+        {
+            for ( i = 0; i < len; i++ )
+            {
+                pNode->label[i] = tolower( (unsigned char)label[i] );
+            }
+
+            pNode->label[len] = '\0';
+            pNode->len = len;
+        }
+        else
+        {
+            free( pNode );
+            pNode = NULL;
+        }
+    }
+
+    return pNode;
+}
+
+/*============================================================================*/
+/*  radix_FindChild                                                           */
+/*!
+    Find the child whose edge label starts with a character
+
+    The radix_FindChild function searches the sorted children of a
+    node for the one whose label starts with the specified character
+    (compared case insensitively).
+
+    @param[in]
+        pNode
+            pointer to the parent node
+
+    @param[in]
+        c
+            first character of the edge label to find
+
+    @retval pointer to the child pointer in the parent's child list
+    @retval NULL no such child
+
+==============================================================================*/
+static RadixNode **radix_FindChild( RadixNode *pNode, char c )
+{
+    RadixNode **ppChild = NULL;
+    unsigned char key = tolower( (unsigned char)c );
+    unsigned char first;
+    size_t lo = 0;
+    size_t hi = pNode->numChildren;
+    size_t mid;
+
+    while ( lo < hi )
+    {
+        mid = lo + ( hi - lo ) / 2;
+        first = (unsigned char)pNode->pChildren[mid]->label[0];
+        if ( first == key )
+        {
+            ppChild = &pNode->pChildren[mid];
+            break;
+        }
+        else if ( first < key )
+        {
+            lo = mid + 1;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    return ppChild;
+}
+
+/*============================================================================*/
+/*  radix_AddChild                                                            */
+/*!
+    Insert a child node into a node's sorted child list
+
+    @param[in]
+        pNode
+            pointer to the parent node
+
+    @param[in]
+        pChild
+            pointer to the child node to insert
+
+    @retval EOK the child was inserted
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int radix_AddChild( RadixNode *pNode, RadixNode *pChild )
+{
+    int result = EOK;
+    RadixNode **pChildren;
+    size_t n;
+    size_t i;
+
+    if ( pNode->numChildren == pNode->maxChildren )
+    {
+        n = ( pNode->maxChildren == 0 ) ? 4 : pNode->maxChildren * 2;
+        pChildren = realloc( pNode->pChildren, n * sizeof( RadixNode * ) );
+        if ( pChildren != NULL )
+        {
+            pNode->pChildren = pChildren;
+            pNode->maxChildren = n;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        i = pNode->numChildren;
+        while ( ( i > 0 ) &&
+                ( (unsigned char)pNode->pChildren[i-1]->label[0] >
+                  (unsigned char)pChild->label[0] ) )
+        {
+            pNode->pChildren[i] = pNode->pChildren[i-1];
+            i--;
+        }
+
+        pNode->pChildren[i] = pChild;
+        pNode->numChildren++;
+    }
+    else
+    {
+        free( pChild->label );
+        free( pChild );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  radix_Split                                                               */
+/*!
+    Split a radix tree edge
+
+    The radix_Split function inserts a new intermediate node part way
+    along an edge.  The new node takes the first len characters of the
+    edge label, and the original node becomes its only child.
+
+    @param[in,out]
+        ppNode
+            pointer to the parent's pointer to the node to split
+
+    @param[in]
+        len
+            length of the edge label of the new intermediate node
+
+    @retval pointer to the new intermediate node
+    @retval NULL memory allocation failure
+
+==============================================================================*/
+static RadixNode *radix_Split( RadixNode **ppNode, size_t len )
+{
+    RadixNode *pNode = *ppNode;
+    RadixNode *pSplit;
+    char *label;
+
+    pSplit = radix_NewNode( pNode->label, len );
+    if ( pSplit != NULL )
+    {
+        label = strdup( &pNode->label[len] );
+        pSplit->pChildren = malloc( 4 * sizeof( RadixNode * ) );
+        if ( ( label != NULL ) && ( pSplit->pChildren != NULL ) )
+        {
+            free( pNode->label );
+            pNode->label = label;
+            pNode->len -= len;
+
+            pSplit->pChildren[0] = pNode;
+            pSplit->numChildren = 1;
+            pSplit->maxChildren = 4;
+            *ppNode = pSplit;
+        }
+        else
+        {
+            free( label );
+            free( pSplit->pChildren );
+            free( pSplit->label );
+            free( pSplit );
+            pSplit = NULL;
+        }
+    }
+
+    return pSplit;
+}
+
+/*============================================================================*/
+/*  radix_Common                                                              */
+/*!
+    Get the length of the common prefix of an edge label and a key
+
+    @param[in]
+        pNode
+            pointer to the node whose edge label is compared
+
+    @param[in]
+        key
+            pointer to the remainder of the key
+
+    @retval number of leading characters shared by the label and the key
+
+==============================================================================*/
+static size_t radix_Common( RadixNode *pNode, const char *key )
+{
+    size_t len = 0;
+
+    while ( ( len < pNode->len ) &&
+            ( pNode->label[len] == tolower( (unsigned char)key[len] ) ) )
+    {
+        len++;
+    }
+
+    return len;
+}
+
+/*============================================================================*/
+/*  radix_Visit                                                               */
+/*!
+    Visit all the objects in a subtree
+
+    The radix_Visit function invokes the callback for each object stored
+    in the specified node, and then recursively for each of its
+    children in label order.
+
+    @param[in]
+        pNode
+            pointer to the root of the subtree to visit
+
+    @param[in]
+        fn
+            callback function invoked for each object
+
+    @param[in]
+        arg
+            opaque argument passed to the callback function
+
+    @retval EOK all objects were visited
+    @retval other the value returned by the callback to stop the walk
+
+==============================================================================*/
+static int radix_Visit( RadixNode *pNode, RadixWalkFn fn, void *arg )
+{
+    int result = EOK;
+    RadixEntry *pEntry = pNode->pEntries;
+    size_t i;
+
+    while ( ( pEntry != NULL ) && ( result == EOK ) )
+    {
+        result = fn( pEntry->object, arg );
+        pEntry = pEntry->pNext;
+    }
+
+    for ( i = 0; ( i < pNode->numChildren ) && ( result == EOK ); i++ )
+    {
+        result = radix_Visit( pNode->pChildren[i], fn, arg );
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of radix group */
@@ -0,0 +1,267 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup requestring requestring
+ * @brief Shared memory client request ring
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file requestring.c
+
+    Client Request Ring
+
+    The Client Request Ring module creates the shared memory request ring
+    ( /varserver_requests ).  Clients which select the ring transport
+    queue their client identifier on the ring instead of sending a
+    real-time signal per request.  The server only needs to be signalled
+    (via the doorbell signal) when it has drained the ring and marked
+    itself idle, so a busy server handles a burst of requests from a
+    single signal delivery.
+
+    Clients reserve an entry by advancing the tail, and then publish
+    their client identifier in it.  An entry which has been reserved
+    but not yet published reads as zero.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <varserver/varclient.h>
+#include "requestring.h"
+
+/*==============================================================================
+        Definitions
+==============================================================================*/
+
+/*! number of times to wait for a reserved ring entry to be published */
+#define REQUESTRING_MAX_SPIN ( 1000 )
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! pointer to the shared request ring */
+static RequestRing *pRequestRing = NULL;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  REQUESTRING_Init                                                          */
+/*!
+    Create the shared client request ring
+
+    The REQUESTRING_Init function creates the /varserver_requests shared
+    memory object and maps it into the server's address space.  The ring
+    is initially empty and marked idle so the first request rings
+    the doorbell.
+
+    @param[in]
+        shard
+            shard index of the server, which is appended to the name
+            of the shared memory object
+
+    @retval EOK the request ring was created
+    @retval ENOMEM the request ring could not be mapped
+    @retval other error from shm_open or ftruncate
+
+==============================================================================*/
+int REQUESTRING_Init( int shard )
+{
+    int result = EINVAL;
+    int fd;
+    void *p;
+    char name[BUFSIZ];
+
+    /* get the name of the shared memory object for this shard */
+    ShardName( name, sizeof( name ), SERVER_REQUESTRING, shard );
+
+    /* get shared memory file descriptor (NOT a file) */
+    fd = shm_open( name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR );
+    if ( fd != -1 )
+    {
+        /* extend shared memory object as it is initialized with size 0 */
+        if ( ftruncate( fd, sizeof( RequestRing ) ) != -1 )
+        {
+            /* map shared memory to process address space */
+            p = mmap( NULL,
+                      sizeof( RequestRing ),
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED,
+                      fd,
+                      0 );
+            if ( p != MAP_FAILED )
+            {
+                /* discard any requests left over from a previous server */
+                pRequestRing = (RequestRing *)p;
+                memset( pRequestRing, 0, sizeof( RequestRing ) );
+                __atomic_store_n( &pRequestRing->idle, 1, __ATOMIC_SEQ_CST );
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            result = errno;
+        }
+
+        /* close the file descriptor since we don't need it for anything */
+        close( fd );
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  REQUESTRING_Pop                                                           */
+/*!
+    Remove the next client request from the ring
+
+    The REQUESTRING_Pop function removes the next client identifier from
+    the request ring, along with the process identifier of the client
+    which submitted it.  If the entry at the head of the ring has been
+    reserved by a client but not yet published, it waits (briefly) for
+    the client to complete the publication.
+
+    @param[out]
+        pPid
+            pointer to a location to store the process identifier of
+            the submitter of the request
+
+    @retval client identifier of the next request
+    @retval 0 the ring is empty
+
+==============================================================================*/
+int REQUESTRING_Pop( pid_t *pPid )
+{
+    int clientid = 0;
+    uint64_t entry = 0;
+    uint32_t head;
+    uint32_t tail;
+    uint64_t *pEntry;
+    int spin = 0;
+
+    if ( pRequestRing != NULL )
+    {
+        head = __atomic_load_n( &pRequestRing->head, __ATOMIC_RELAXED );
+        tail = __atomic_load_n( &pRequestRing->tail, __ATOMIC_SEQ_CST );
+        if ( head != tail )
+        {
+            pEntry = &pRequestRing->entries[head % VARSERVER_REQUEST_RING_SIZE];
+
+            /* wait for the client to publish the reserved entry */
+            while( ( entry = __atomic_load_n( pEntry, __ATOMIC_ACQUIRE ) ) == 0 )
+            {
+                if( ++spin > REQUESTRING_MAX_SPIN )
+                {
+                    break;
+                }
+
+                sched_yield();
+            }
+
+            if ( entry != 0 )
+            {
+                clientid = (int)(uint32_t)entry;
+                *pPid = (pid_t)(uint32_t)( entry >> 32 );
+
+                /* release the entry back to the clients */
+                __atomic_store_n( pEntry, 0, __ATOMIC_RELAXED );
+                __atomic_store_n( &pRequestRing->head,
+                                  head + 1,
+                                  __ATOMIC_RELEASE );
+            }
+        }
+    }
+
+    return clientid;
+}
+
+/*============================================================================*/
+/*  REQUESTRING_Idle                                                          */
+/*!
+    Mark the server as idle and waiting for a doorbell
+
+    The REQUESTRING_Idle function is called when the server has drained
+    the request ring.  It marks the ring idle, so the next client request
+    rings the doorbell, and then re-checks the ring to close the race
+    with a client which queued a request without seeing the idle flag.
+
+    @retval true the ring is empty and the server is waiting for a doorbell
+    @retval false requests are pending and the server should keep draining
+
+==============================================================================*/
+bool REQUESTRING_Idle( void )
+{
+    bool idle = true;
+    uint32_t head;
+    uint64_t *pEntry;
+
+    if ( pRequestRing != NULL )
+    {
+        __atomic_store_n( &pRequestRing->idle, 1, __ATOMIC_SEQ_CST );
+
+        /* a client which has reserved the head entry but not yet
+           published it will see the idle flag and ring the doorbell */
+        head = __atomic_load_n( &pRequestRing->head, __ATOMIC_RELAXED );
+        pEntry = &pRequestRing->entries[head % VARSERVER_REQUEST_RING_SIZE];
+        if ( __atomic_load_n( pEntry, __ATOMIC_SEQ_CST ) != 0 )
+        {
+            /* a request arrived while we were going idle.  If a client
+               has already claimed the idle flag, a (spurious) doorbell
+               is on its way, which is harmless */
+            __atomic_store_n( &pRequestRing->idle, 0, __ATOMIC_SEQ_CST );
+            idle = false;
+        }
+    }
+
+    return idle;
+}
+
+/*! @}
+ * end of requestring group */
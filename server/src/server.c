@@ -54,10 +54,15 @@ SOFTWARE.
 #include <sys/stat.h>
 #include <sys/mman.h>
 #include <sys/syslog.h>
+#include <sys/signalfd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/syscall.h>
 #include <time.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <semaphore.h>
+#include <mqueue.h>
 #include <string.h>
 #include <inttypes.h>
 #include <grp.h>
@@ -67,8 +72,25 @@ SOFTWARE.
 #include "taglist.h"
 #include "blocklist.h"
 #include "transaction.h"
+#include "validate.h"
 #include "stats.h"
+#include "notify.h"
+#include "slab.h"
+#include "namepool.h"
+#include "snapshot.h"
+#include "journal.h"
+#include "standby.h"
+#include "history.h"
+#include "permsets.h"
+#include "trace.h"
 #include "hash.h"
+#include "varindex.h"
+#include "sharedvalues.h"
+#include "sharedblobs.h"
+#include "varversions.h"
+#include "workers.h"
+#include "requestring.h"
+#include "changering.h"
 #include "server.h"
 
 /*==============================================================================
@@ -78,9 +100,33 @@ SOFTWARE.
 /*! Maximum number of clients */
 #define MAX_VAR_CLIENTS                 ( 4096 )
 
+/*! Maximum number of read-only request worker threads */
+#define VARSERVER_MAX_WORKERS           ( 64 )
+
 /*! Timer Signal */
 #define SIG_TIMER                       ( SIGRTMIN + 5 )
 
+/*! Maximum number of signals read from the signalfd at once */
+#define MAX_SIGNAL_BATCH                ( 64 )
+
+/*! Maximum number of normal priority requests processed before the
+    server checks for high priority requests again */
+#define NORMAL_LANE_SLICE               ( 8 )
+
+/*! pidfd_open system call number, for C libraries which predate it */
+#ifndef SYS_pidfd_open
+#define SYS_pidfd_open                  ( 434 )
+#endif
+
+/*! Maximum number of client exits handled at once */
+#define MAX_CLIENT_EXIT_BATCH           ( 16 )
+
+/*! Maximum number of event loop file descriptors */
+#define MAX_EVENT_SOURCES               ( 8 )
+
+/*! Initial number of hash table slots (the table grows as needed) */
+#define HASH_INITIAL_SIZE               ( 1024 )
+
 /*==============================================================================
         Private types
 ==============================================================================*/
@@ -103,16 +149,73 @@ typedef struct _RequestHandler
     /*! counter for the number of times this request has been made */
     uint64_t *pMetric;
 
+    /*! indicates the request does not modify the variable store, so it
+        may be processed by a worker concurrently with other reads */
+    bool readOnly;
+
 } RequestHandler;
 
+/*! the ServerOptions object holds the command line options */
+typedef struct _ServerOptions
+{
+    /*! maximum number of variables */
+    size_t capacity;
+
+    /*! path of a snapshot to restore at startup */
+    char *snapshot;
+
+    /*! path of the change journal */
+    char *journal;
+
+    /*! number of read-only request worker threads */
+    size_t workers;
+
+    /*! shard index of the server, 0 for the root server */
+    int shard;
+
+    /*! variable name prefix owned by a shard server */
+    char *prefix;
+
+    /*! validation deadline in milliseconds for validators which have
+        not set a validation policy, 0 for no deadline */
+    uint32_t validationDeadline;
+
+    /*! keep the variable store in the warm standby arena, and resume
+        it from there when the server restarts */
+    bool standby;
+
+} ServerOptions;
+
+/*! the EventSource object associates a file descriptor monitored
+    by the event loop with its handler */
+typedef struct _EventSource
+{
+    /*! file descriptor to be monitored */
+    int fd;
+
+    /*! pointer to the function which handles input on the fd */
+    int (*handler)( int fd );
+
+} EventSource;
+
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
-static int NewClient( pid_t pid );
-static int ProcessRequest( siginfo_t *pInfo );
+static int NewClient( pid_t pid, int channel );
+static int ProcessRequest( int clientid );
+static void DispatchRequest( int clientid, pid_t pid );
+static bool AcceptRequest( int clientid, pid_t pid );
+static bool ProcessNormalLane( int slice );
+static void ProcessReadRequest( VarClient *pVarClient );
+static int ProcessDeferredRequests( int fd );
+static void ProcessRequestRing( void );
 static int UnblockClient( VarClient *pVarClient );
+static int DeferUnblockClient( VarClient *pVarClient );
+static void FlushUnblockedClients( void );
 static int GetClientID( void );
-static ServerInfo *InitServerInfo( void );
+static ServerInfo *InitServerInfo( char *prefix,
+                                   uint64_t storeID,
+                                   bool standby );
 static int ValidateClient( VarClient *pVarClient );
 
 static int ProcessVarRequestInvalid( VarClient *pVarClient );
@@ -140,15 +243,67 @@ static int ProcessVarRequestGetFirst( VarClient *pVarClient );
 static int ProcessVarRequestGetNext( VarClient *pVarClient );
 static int ProcessVarRequestSetFlags( VarClient *pVarClient );
 static int ProcessVarRequestClearFlags( VarClient *pVarClient );
+static int ProcessVarRequestShareValue( VarClient *pVarClient );
+static int ProcessVarRequestGetMany( VarClient *pVarClient );
+static int ProcessVarRequestSetMany( VarClient *pVarClient );
+static int ProcessVarRequestGetPage( VarClient *pVarClient );
+static int ProcessVarRequestNotifyQuery( VarClient *pVarClient );
+static int ProcessVarRequestNotifyQueryCancel( VarClient *pVarClient );
+static int ProcessVarRequestSnapshot( VarClient *pVarClient );
+static int ProcessVarRequestNewMany( VarClient *pVarClient );
+static int ProcessVarRequestShareBlob( VarClient *pVarClient );
+static int ProcessVarRequestCommitBlob( VarClient *pVarClient );
+static int ProcessVarRequestResizeWorkbuf( VarClient *pVarClient );
+static int ProcessVarRequestValidationPolicy( VarClient *pVarClient );
+static int ProcessValidationBatchRequest( VarClient *pVarClient );
+static int ProcessValidationBatchResponse( VarClient *pVarClient );
+static int CompleteValidation( uint32_t id, int response );
+static int ProcessVarRequestModify( VarClient *pVarClient );
+static int ProcessVarRequestSetGroup( VarClient *pVarClient );
+static int ProcessVarRequestGetHistory( VarClient *pVarClient );
+static int ProcessVarRequestUpdateUser( VarClient *pVarClient );
+static int ProcessVarRequestGetLargest( VarClient *pVarClient );
+static void CommitSetGroup( VarClient *pVarClient );
+static int GetBatchItem( VarClient *pVarClient,
+                         size_t item,
+                         VarInfo *pVarInfo );
+static int CreateBatchItem( VarClient *pVarClient, VarCreateItem *pItem );
+
+static int ProcessOptions( int argc, char **argv, ServerOptions *pOptions );
+static void usage( char *name );
 
 static uint64_t *MakeMetric( char *name );
 
 static int InitStats( void );
+static int InitTrace( void );
 
 static int PrintClientInfo( VarInfo *pVarInfo, char *buf, size_t len );
 
-void RegisterHandler(void(*f)(int sig, siginfo_t *info, void *ucontext));
-void handler(int sig, siginfo_t *info, void *ucontext);
+static int InitSignals( void );
+static int AddEventSource( int fd, int (*handler)( int fd ) );
+static int RunEventLoop( void );
+static int ProcessSignals( int fd );
+static void ProcessSignal( struct signalfd_siginfo *pInfo );
+static int InitRateLimitTimer( void );
+static int ProcessRateLimitTimer( int fd );
+static void ArmRateLimitTimer( void );
+static int InitValidationTimer( void );
+static int ProcessValidationTimer( int fd );
+static void ArmValidationTimer( void );
+static int InitStandbyTimer( void );
+static int ProcessStandbyTimer( int fd );
+static void ArmStandbyTimer( void );
+static int InitClientMonitor( void );
+static void MonitorClient( int clientid, pid_t pid );
+static void UnmonitorClient( int clientid );
+static int ProcessClientExits( int fd );
+static void ReclaimClientProcess( pid_t pid );
+static void ReclaimExitedClients( void );
+static void ReleaseClosedClients( void );
+static void CountReclaimed( uint64_t *pMetric, size_t n );
+static void OnQueueOverflow( pid_t pid );
+static void CommitJournal( void );
+static int CompactJournal( void );
 
 /*==============================================================================
         Private file scoped variables
@@ -158,6 +313,129 @@ void handler(int sig, siginfo_t *info, void *ucontext);
 static VarClient *VarClients[MAX_VAR_CLIENTS+1] = {0};
 static VAR_HANDLE hClientInfo = VAR_INVALID;
 
+/*! size of each client's shared memory mapping, including
+    its working buffer */
+static size_t VarClientSizes[MAX_VAR_CLIENTS+1] = {0};
+
+/*! time each client's current request was dequeued (CLOCK_MONOTONIC ns),
+    0 if there is no request in progress */
+static uint64_t RequestStart[MAX_VAR_CLIENTS+1] = {0};
+
+/*! type of each client's current request */
+static VarRequest RequestType[MAX_VAR_CLIENTS+1] = {0};
+
+/*! result code of each client's current request */
+static int RequestResult[MAX_VAR_CLIENTS+1] = {0};
+
+/*! handle of the service time histogram of each request type, 0=none */
+static int RequestLatency[VARREQUEST_END_MARKER] = {0};
+
+/*! handle of the request queueing delay histogram */
+static int queueLatency = 0;
+
+/*! handle of the queueing delay histogram of each priority class */
+static int LaneLatency[VARSERVER_NUM_PRIORITIES] = {0};
+
+/*! priority class granted to each client */
+static int ClientPriority[MAX_VAR_CLIENTS+1] = {0};
+
+/*! normal priority requests waiting behind the high priority requests */
+static int NormalLane[MAX_VAR_CLIENTS+1] = {0};
+
+/*! index of the oldest request in the NormalLane */
+static int normalLaneHead = 0;
+
+/*! number of requests in the NormalLane */
+static int normalLaneCount = 0;
+
+/*! clients to be unblocked at the end of the current batch */
+static VarClient *UnblockList[MAX_VAR_CLIENTS+1] = {0};
+
+/*! number of clients in the UnblockList */
+static int unblockCount = 0;
+
+/*! event loop epoll file descriptor */
+static int epollfd = -1;
+
+/*! file descriptors monitored by the event loop */
+static EventSource EventSources[MAX_EVENT_SOURCES];
+
+/*! number of event sources in the EventSources list */
+static int numEventSources = 0;
+
+/*! timer used to send rate limited notifications */
+static int rateLimitTimerFd = -1;
+
+/*! time the rate limit timer is armed for (CLOCK_MONOTONIC ns), 0=disarmed */
+static uint64_t rateLimitTimerDue = 0;
+
+/*! timer used to expire validation requests */
+static int validationTimerFd = -1;
+
+/*! time the validation timer is armed for (CLOCK_MONOTONIC ns), 0=disarmed */
+static uint64_t validationTimerDue = 0;
+
+/*! timer used to rebuild the warm standby arena */
+static int standbyTimerFd = -1;
+
+/*! time the standby timer is armed for (CLOCK_MONOTONIC ns), 0=disarmed */
+static uint64_t standbyTimerDue = 0;
+
+/*! number of validation requests completed by their deadline */
+static uint64_t *pValidationTimeouts = NULL;
+
+/*! epoll file descriptor monitoring the client process descriptors */
+static int clientExitFd = -1;
+
+/*! process identifier of each client */
+static pid_t ClientPIDs[MAX_VAR_CLIENTS+1] = {0};
+
+/*! process descriptor of each client, 0 if the process is monitored
+    via another of its clients, or not at all */
+static int ClientPidFds[MAX_VAR_CLIENTS+1] = {0};
+
+/*! clients whose process has exited, waiting to be released */
+static bool ClientExited[MAX_VAR_CLIENTS+1] = {0};
+
+/*! number of clients in the ClientExited list */
+static int exitedCount = 0;
+
+/*! number of requests of each client held by the read-only workers */
+static int WorkerRequests[MAX_VAR_CLIENTS+1] = {0};
+
+/*! clients which closed their connection while a read-only worker held
+    one of their requests, waiting to be released */
+static bool ClientClosing[MAX_VAR_CLIENTS+1] = {0};
+
+/*! number of clients in the ClientClosing list */
+static int closingCount = 0;
+
+/*! number of exited clients which have been released */
+static uint64_t *pReclaimedClients = NULL;
+
+/*! number of notification registrations of exited clients removed */
+static uint64_t *pReclaimedNotifications = NULL;
+
+/*! number of blocked requests of exited clients removed */
+static uint64_t *pReclaimedBlocked = NULL;
+
+/*! number of transactions of exited clients removed */
+static uint64_t *pReclaimedTransactions = NULL;
+
+/*! number of search contexts and query subscriptions of exited
+    clients removed */
+static uint64_t *pReclaimedContexts = NULL;
+
+/*! number of shared memory and message queue objects of exited
+    clients removed */
+static uint64_t *pReclaimedObjects = NULL;
+
+/*! snapshot the change journal is compacted into */
+static char *journalSnapshot = NULL;
+
+/*! shard index of this server, 0 for the root server */
+static int serverShard = 0;
+
 /*! Request Handlers - these must appear in the exact same order
     as the request enumerations so they can be looked up directly
     in the Request array */
@@ -168,49 +446,56 @@ static RequestHandler RequestHandlers[] =
         "IMVALID",
         ProcessVarRequestInvalid,
         NULL,
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_OPEN,
         "OPEN",
         NULL,
         NULL,
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_CLOSE,
         "CLOSE",
         ProcessVarRequestClose,
         "/varserver/stats/close",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_ECHO,
         "ECHO",
         ProcessVarRequestEcho,
         "/varserver/stats/echo",
-        NULL
+        NULL,
+        true
     },
     {
         VARREQUEST_NEW,
         "NEW",
         ProcessVarRequestNew,
         "/varserver/stats/new",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_ALIAS,
         "ALIAS",
         ProcessVarRequestAlias,
         "/varserver/stats/alias",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_GET_ALIASES,
         "GET_ALIASES",
         ProcessVarRequestGetAliases,
         "/varserver/stats/getaliases",
-        NULL
+        NULL,
+        true
     },
 
     {
@@ -218,133 +503,304 @@ static RequestHandler RequestHandlers[] =
         "FIND",
         ProcessVarRequestFind,
         "/varserver/stats/find",
-        NULL
+        NULL,
+        true
     },
     {
         VARREQUEST_GET,
         "GET",
         ProcessVarRequestGet,
         "/varserver/stats/get",
-        NULL
+        NULL,
+        true
     },
     {
         VARREQUEST_PRINT,
         "PRINT",
         ProcessVarRequestPrint,
         "/varserver/stats/print",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_SET,
         "SET",
         ProcessVarRequestSet,
         "/varserver/stats/set",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_TYPE,
         "TYPE",
         ProcessVarRequestType,
         "/varserver/stats/type",
-        NULL
+        NULL,
+        true
     },
     {
         VARREQUEST_NAME,
         "NAME",
         ProcessVarRequestName,
         "/varserver/stats/name",
-        NULL
+        NULL,
+        true
     },
     {
         VARREQUEST_LENGTH,
         "LENGTH",
         ProcessVarRequestLength,
         "/varserver/stats/length",
-        NULL
+        NULL,
+        true
     },
     {
         VARREQUEST_FLAGS,
         "FLAGS",
         ProcessVarRequestFlags,
         "/varserver/stats/flags",
-        NULL
+        NULL,
+        true
     },
     {
         VARREQUEST_INFO,
         "INFO",
         ProcessVarRequestInfo,
         "/varserver/stats/info",
-        NULL
+        NULL,
+        true
     },
     {
         VARREQUEST_NOTIFY,
         "NOTIFY",
         ProcessVarRequestNotify,
         "/varserver/stats/notify",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_NOTIFY_CANCEL,
         "NOTIFY_CANCEL",
         ProcessVarRequestNotifyCancel,
         "/varserver/stats/notify_cancel",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_GET_VALIDATION_REQUEST,
         "VALIDATION_REQUEST",
         ProcessValidationRequest,
         "/varserver/stats/validate_request",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_SEND_VALIDATION_RESPONSE,
         "VALIDATION_RESPONSE",
         ProcessValidationResponse,
         "/varserver/stats/validation_response",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_OPEN_PRINT_SESSION,
         "OPEN_PRINT_SESSION",
         ProcessVarRequestOpenPrintSession,
         "/varserver/stats/open_print_session",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_CLOSE_PRINT_SESSION,
         "CLOSE_PRINT_SESSION",
         ProcessVarRequestClosePrintSession,
         "/varserver/stats/close_print_session",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_GET_FIRST,
         "GET_FIRST",
         ProcessVarRequestGetFirst,
         "/varserver/stats/get_first",
-        NULL
+        NULL,
+        true
     },
     {
         VARREQUEST_GET_NEXT,
         "GET_FIRST",
         ProcessVarRequestGetNext,
         "/varserver/stats/get_next",
-        NULL
+        NULL,
+        true
     },
     {
         VARREQUEST_SET_FLAGS,
         "GET_FLAGS",
         ProcessVarRequestSetFlags,
         "/varserver/stats/set_flags",
-        NULL
+        NULL,
+        false
     },
     {
         VARREQUEST_CLEAR_FLAGS,
         "CLEAR_FLAGS",
         ProcessVarRequestClearFlags,
         "/varserver/stats/clear_flags",
-        NULL
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_SHARE_VALUE,
+        "SHARE_VALUE",
+        ProcessVarRequestShareValue,
+        "/varserver/stats/share_value",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_GET_MANY,
+        "GET_MANY",
+        ProcessVarRequestGetMany,
+        "/varserver/stats/get_many",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_SET_MANY,
+        "SET_MANY",
+        ProcessVarRequestSetMany,
+        "/varserver/stats/set_many",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_GET_PAGE,
+        "GET_PAGE",
+        ProcessVarRequestGetPage,
+        "/varserver/stats/get_page",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_NOTIFY_QUERY,
+        "NOTIFY_QUERY",
+        ProcessVarRequestNotifyQuery,
+        "/varserver/stats/notify_query",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_NOTIFY_QUERY_CANCEL,
+        "NOTIFY_QUERY_CANCEL",
+        ProcessVarRequestNotifyQueryCancel,
+        "/varserver/stats/notify_query_cancel",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_SNAPSHOT,
+        "SNAPSHOT",
+        ProcessVarRequestSnapshot,
+        "/varserver/stats/snapshot",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_NEW_MANY,
+        "NEW_MANY",
+        ProcessVarRequestNewMany,
+        "/varserver/stats/new_many",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_SHARE_BLOB,
+        "SHARE_BLOB",
+        ProcessVarRequestShareBlob,
+        "/varserver/stats/share_blob",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_COMMIT_BLOB,
+        "COMMIT_BLOB",
+        ProcessVarRequestCommitBlob,
+        "/varserver/stats/commit_blob",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_RESIZE_WORKBUF,
+        "RESIZE_WORKBUF",
+        ProcessVarRequestResizeWorkbuf,
+        "/varserver/stats/resize_workbuf",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_VALIDATION_POLICY,
+        "VALIDATION_POLICY",
+        ProcessVarRequestValidationPolicy,
+        "/varserver/stats/validation_policy",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_GET_VALIDATION_BATCH,
+        "GET_VALIDATION_BATCH",
+        ProcessValidationBatchRequest,
+        "/varserver/stats/get_validation_batch",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_SEND_VALIDATION_BATCH,
+        "SEND_VALIDATION_BATCH",
+        ProcessValidationBatchResponse,
+        "/varserver/stats/send_validation_batch",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_MODIFY,
+        "MODIFY",
+        ProcessVarRequestModify,
+        "/varserver/stats/modify",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_SET_GROUP,
+        "SET_GROUP",
+        ProcessVarRequestSetGroup,
+        "/varserver/stats/set_group",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_GET_HISTORY,
+        "GET_HISTORY",
+        ProcessVarRequestGetHistory,
+        "/varserver/stats/get_history",
+        NULL,
+        true
+    },
+    {
+        VARREQUEST_UPDATE_USER,
+        "UPDATE_USER",
+        ProcessVarRequestUpdateUser,
+        "/varserver/stats/update_user",
+        NULL,
+        false
+    },
+    {
+        VARREQUEST_GET_LARGEST,
+        "GET_LARGEST",
+        ProcessVarRequestGetLargest,
+        "/varserver/stats/get_largest",
+        NULL,
+        true
     }
 };
 
@@ -375,22 +831,179 @@ static RequestHandler RequestHandlers[] =
 int main(int argc, char **argv)
 {
     ServerInfo *pServerInfo = NULL;
+    int sigfd;
+    ServerOptions options;
+    ValidationPolicy defaultPolicy;
+    size_t count = 0;
+    uint64_t storeID = 0;
+    bool resumed = false;
+    int rc;
+
+    /* process the command line options */
+    options.capacity = VARSERVER_MAX_VARIABLES;
+    options.snapshot = NULL;
+    options.journal = NULL;
+    options.workers = 0;
+    options.shard = 0;
+    options.prefix = "";
+    options.validationDeadline = 0;
+    options.standby = false;
+    if ( ProcessOptions( argc, argv, &options ) != EOK )
+    {
+        exit( 1 );
+    }
+
+    serverShard = options.shard;
+
+    /* apply the default validation deadline, rejecting the changes
+       which are not validated in time */
+    defaultPolicy.batch = false;
+    defaultPolicy.deadline_ms = options.validationDeadline;
+    defaultPolicy.defaultResponse = ETIMEDOUT;
+    VALIDATE_SetDefaultPolicy( &defaultPolicy );
 
-    /* argc and argv are unused */
-    (void)argc;
-    (void)argv;
+    /* block signals and route them to a signalfd.  This must be done
+       before the statistics timer is created */
+    sigfd = InitSignals();
 
     /* get the user id of the user running varserver */
     VARLIST_SetUser();
 
+    /* initialize the client permission sets */
+    if ( PERMSETS_Init( MAX_VAR_CLIENTS, getuid() ) != EOK )
+    {
+        fprintf(stderr, "cannot allocate client credentials\n");
+        exit( 1 );
+    }
+
+    /* initialize the object allocators */
+    if ( SLAB_Init() != EOK )
+    {
+        fprintf(stderr, "slab allocator is not available\n");
+    }
+
+    /* initialize the variable storage */
+    if ( VARLIST_Init( options.capacity ) != EOK )
+    {
+        fprintf(stderr, "cannot allocate storage for %zu variables\n",
+                options.capacity );
+        exit( 1 );
+    }
+
+    /* initialize the variable history rings */
+    if ( HISTORY_Init() != EOK )
+    {
+        fprintf(stderr, "variable history is not available\n");
+    }
+
     /* initialize the Hash Table */
-    HASH_Init( VARSERVER_MAX_VARIABLES );
+    HASH_Init( HASH_INITIAL_SIZE );
+
+    /* initialize the variable flag and tag index */
+    if ( VARINDEX_Init( options.capacity ) != EOK )
+    {
+        fprintf(stderr, "variable flag index is not available\n");
+    }
+
+    /* create the shared variable value segment */
+    if ( SHAREDVALUES_Init( serverShard ) != EOK )
+    {
+        fprintf(stderr, "shared value segment is not available\n");
+    }
+
+    /* name the zero-copy blob segments after this shard */
+    SHAREDBLOBS_Init( serverShard );
+
+    /* create the shared variable version segment.  The versions are
+       kept if the variable store may be resumed from the standby arena */
+    if ( VARVERSIONS_Init( serverShard, options.standby ) != EOK )
+    {
+        fprintf(stderr, "variable version segment is not available\n");
+    }
+
+    /* create the shared client request ring */
+    if ( REQUESTRING_Init( serverShard ) != EOK )
+    {
+        fprintf(stderr, "request ring is not available\n");
+    }
+
+    /* create the shared change broadcast ring */
+    if ( CHANGERING_Init( serverShard ) != EOK )
+    {
+        fprintf(stderr, "change ring is not available\n");
+    }
 
     /* initialize the varserver statistics */
     InitStats();
 
-    /* register the real-time signal handler */
-    RegisterHandler(handler);
+    /* create the request trace ring */
+    if ( InitTrace() != EOK )
+    {
+        fprintf(stderr, "trace ring is not available\n");
+    }
+
+    /* resume the variable store of the previous server */
+    if ( options.standby == true )
+    {
+        rc = STANDBY_Init( serverShard );
+        if ( rc == EOK )
+        {
+            rc = STANDBY_Restore( &storeID, &count );
+            resumed = ( rc == EOK );
+        }
+
+        if ( ( rc != EOK ) && ( rc != ENOENT ) )
+        {
+            fprintf(stderr, "cannot resume the standby variable store: %s\n",
+                    strerror( rc ) );
+        }
+    }
+
+    /* restore the variables from a snapshot before accepting clients */
+    if ( ( options.snapshot != NULL ) &&
+         ( resumed == false ) )
+    {
+        rc = SNAPSHOT_Load( options.snapshot, &count );
+        if ( ( rc != EOK ) &&
+             ( ( rc != ENOENT ) || ( options.journal == NULL ) ) )
+        {
+            fprintf(stderr, "cannot restore snapshot %s: %s\n",
+                    options.snapshot,
+                    strerror( rc ) );
+        }
+
+        syslog( LOG_INFO, "restored %zu variables from %s",
+                count,
+                options.snapshot );
+    }
+
+    /* apply the changes made since the snapshot was written */
+    if ( options.journal != NULL )
+    {
+        rc = JOURNAL_Replay( options.journal, &count );
+        if ( rc != EOK )
+        {
+            fprintf(stderr, "cannot replay journal %s: %s\n",
+                    options.journal,
+                    strerror( rc ) );
+        }
+
+        syslog( LOG_INFO, "replayed %zu changes from %s",
+                count,
+                options.journal );
+
+        journalSnapshot = options.snapshot;
+        if ( ( rc != EOK ) ||
+             ( JOURNAL_Open( options.journal ) != EOK ) )
+        {
+            fprintf(stderr, "change journal is not available\n");
+        }
+        else if ( count > 0 )
+        {
+            /* fold the replayed changes into the snapshot */
+            CompactJournal();
+        }
+    }
 
     /* check that varserver group exists */
     if ( getgrnam( VARSERVER_GROUP_NAME ) == NULL )
@@ -401,15 +1014,53 @@ int main(int argc, char **argv)
     else
     {
         /* Set up server information structure */
-        pServerInfo = InitServerInfo();
-        if( pServerInfo != NULL )
+        pServerInfo = InitServerInfo( options.prefix,
+                                      storeID,
+                                      options.standby );
+        if( ( pServerInfo != NULL ) &&
+            ( AddEventSource( sigfd, ProcessSignals ) == EOK ) )
         {
-            /* loop forever processing signals */
-            while(1)
+            /* set up the rate limited notification timer */
+            if ( InitRateLimitTimer() != EOK )
+            {
+                fprintf(stderr, "notification rate limits are not available\n");
+            }
+
+            /* set up the validation deadline timer */
+            if ( InitValidationTimer() != EOK )
+            {
+                fprintf(stderr, "validation deadlines are not available\n");
+            }
+
+            /* set up the warm standby arena timer */
+            if ( options.standby == true )
+            {
+                STANDBY_SetStoreID( pServerInfo->storeID );
+                if ( InitStandbyTimer() != EOK )
+                {
+                    fprintf(stderr, "warm standby is not available\n");
+                }
+            }
+
+            /* set up the client exit monitor */
+            if ( InitClientMonitor() != EOK )
             {
-                /* do nothing - handler functions take care of everything */
-                pause();
+                fprintf(stderr, "client exit monitoring is not available\n");
             }
+
+            /* start the read-only request workers.  The signal mask is
+               already set up, so they will not receive any signals */
+            if ( ( options.workers > 0 ) &&
+                 ( ( WORKERS_Init( options.workers,
+                                   ProcessReadRequest ) != EOK ) ||
+                   ( AddEventSource( WORKERS_GetDeferredFd(),
+                                     ProcessDeferredRequests ) != EOK ) ) )
+            {
+                fprintf(stderr, "read-only request workers are not available\n");
+            }
+
+            /* loop forever processing events */
+            RunEventLoop();
         }
     }
 
@@ -417,282 +1068,308 @@ int main(int argc, char **argv)
 }
 
 /*============================================================================*/
-/*  RegisterHandler                                                           */
+/*  ProcessOptions                                                            */
 /*!
-    Register handler function with the real time signals
+    Process command line options
 
-    The RegisterHandler function registers the specified handler function
-    with the real time signals.  The handler function must follow the
-    form:
+    The ProcessOptions function processes the variable server command
+    line options and displays usage information if the options are
+    not correct.
 
-    handler( int sig, siginfo_t *info, void *ucontext )
+    Supported options are:
+
+    -c <capacity> : maximum number of variables (including aliases)
+    -r <snapshot> : restore the variables from a snapshot file
+    -j <journal> : record variable changes in a journal file (requires -r)
+    -w <workers> : number of read-only request worker threads
+    -s <shard>:<prefix> : run as a shard server owning the name prefix
+    -v <deadline> : validation deadline in milliseconds
+    -a : keep the variable store in the warm standby arena
+    -h : display help
 
     @param[in]
-        f
-            handler function to register with the real time signals
+        argc
+            number of arguments (including the command itself)
 
-==============================================================================*/
-void RegisterHandler(void(*f)(int sig, siginfo_t *info, void *ucontext))
-{
-    struct sigaction siga;
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @param[out]
+        pOptions
+            pointer to the ServerOptions object to populate
 
-    siga.sa_sigaction = f;
-    siga.sa_flags = SA_SIGINFO;
+    @retval EOK the options were processed
+    @retval EINVAL invalid options were specified
 
-    /* register the handler function with the real-time signals */
-    for (int sig = 1; sig <= SIGRTMAX; ++sig)
+==============================================================================*/
+static int ProcessOptions( int argc, char **argv, ServerOptions *pOptions )
+{
+    const char *options = "hac:r:j:w:s:v:";
+    int c;
+    int errcount = 0;
+    unsigned long n;
+    char *pEnd;
+
+    if ( ( argv != NULL ) &&
+         ( pOptions != NULL ) )
     {
-        /* register handler function with the signal */
-        sigaction(sig, &siga, NULL);
-    }
-}
+        while( ( c = getopt( argc, argv, options ) ) != -1 )
+        {
+            switch( c )
+            {
+                case 'c':
+                    n = strtoul( optarg, &pEnd, 0 );
+                    if ( ( *pEnd != 0 ) ||
+                         ( n == 0 ) ||
+                         ( n > VARSERVER_VARIABLE_LIMIT ) )
+                    {
+                        fprintf( stderr,
+                                 "capacity must be 1..%d\n",
+                                 VARSERVER_VARIABLE_LIMIT );
+                        errcount++;
+                    }
+                    else
+                    {
+                        pOptions->capacity = n;
+                    }
+                    break;
 
-/*============================================================================*/
-/*  handler                                                                   */
-/*!
-    Real time signal handler
+                case 'a':
+                    pOptions->standby = true;
+                    break;
 
-    The handler function is called to handle any received real-time signals.
+                case 'r':
+                    pOptions->snapshot = optarg;
+                    break;
 
-    Handled real-time signals include:
+                case 'j':
+                    pOptions->journal = optarg;
+                    break;
 
-    - SIG_NEWCLIENT
-    - SIG_CLIENT_REQUEST
-    - SIG_TIMER
+                case 'w':
+                    n = strtoul( optarg, &pEnd, 0 );
+                    if ( ( *pEnd != 0 ) ||
+                         ( n > VARSERVER_MAX_WORKERS ) )
+                    {
+                        fprintf( stderr,
+                                 "workers must be 0..%d\n",
+                                 VARSERVER_MAX_WORKERS );
+                        errcount++;
+                    }
+                    else
+                    {
+                        pOptions->workers = n;
+                    }
+                    break;
 
-    @param[in]
-        sig
-            signal identifier
+                case 's':
+                    n = strtoul( optarg, &pEnd, 0 );
+                    if ( ( *pEnd != ':' ) ||
+                         ( n == 0 ) ||
+                         ( n >= VARSERVER_MAX_SHARDS ) ||
+                         ( pEnd[1] != '/' ) ||
+                         ( strlen( &pEnd[1] ) > MAX_NAME_LEN ) )
+                    {
+                        fprintf( stderr,
+                                 "shard must be 1..%d:/<prefix>\n",
+                                 VARSERVER_MAX_SHARDS - 1 );
+                        errcount++;
+                    }
+                    else
+                    {
+                        pOptions->shard = (int)n;
+                        pOptions->prefix = &pEnd[1];
+                    }
+                    break;
 
-    @param[in]
-        info
-            pointer to the siginfo_t object containing the signal info
+                case 'v':
+                    n = strtoul( optarg, &pEnd, 0 );
+                    if ( ( *pEnd != 0 ) ||
+                         ( n > UINT32_MAX ) )
+                    {
+                        fprintf( stderr, "invalid validation deadline\n" );
+                        errcount++;
+                    }
+                    else
+                    {
+                        pOptions->validationDeadline = (uint32_t)n;
+                    }
+                    break;
 
-    @param[in]
-        ucontext
-            opaque context pointer, unused
+                case 'h':
+                default:
+                    errcount++;
+                    break;
+            }
+        }
 
-==============================================================================*/
-void handler(int sig, siginfo_t *info, void *ucontext)
-{
-    /* ucontext is not used */
-    (void)ucontext;
+        if ( ( pOptions->journal != NULL ) &&
+             ( pOptions->snapshot == NULL ) )
+        {
+            fprintf( stderr, "a journal requires a snapshot (-r)\n" );
+            errcount++;
+        }
 
-    if ( sig == SIG_NEWCLIENT )
-    {
-        if ( info != NULL )
+        if ( errcount > 0 )
         {
-            NewClient( info->si_pid );
+            usage( argv[0] );
         }
     }
-    else if ( sig == SIG_CLIENT_REQUEST )
-    {
-        ProcessRequest( info );
-    }
-    else if ( sig == SIG_TIMER )
-    {
-        STATS_Process();
-    }
-    else if ( sig == SIGINT )
-    {
-        exit( 1 );
-    }
     else
     {
-        printf("SERVER: unhandled signal: %d\n", sig);
+        errcount++;
     }
+
+    return ( errcount == 0 ) ? EOK : EINVAL;
 }
 
 /*============================================================================*/
-/*  InitServerInfo                                                            */
+/*  usage                                                                     */
 /*!
-    Construct the server information which is shared with clients
-    via the /varserver shared memory object.
+    Display the usage information
 
-    This information includes:
-        - the variable server process identifier used by clients
-          to send messages to the server
+    The usage function describes the command line options on the
+    standard error stream.
 
-    @retval pointer to the server information object
-    @retval NULL if the server information object could not be created
+    @param[in]
+        name
+            pointer to the application name
 
 ==============================================================================*/
-static ServerInfo *InitServerInfo( void )
+static void usage( char *name )
 {
-    int fd;
-    int res;
-    ServerInfo *pServerInfo = NULL;
-
-    /* get shared memory file descriptor (NOT a file) */
-	fd = shm_open(SERVER_SHAREDMEM, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
-	if (fd != -1)
-	{
-    	/* extend shared memory object as it is initialized with size 0 */
-	    res = ftruncate(fd, sizeof(ServerInfo));
-	    if (res != -1)
-	    {
-            /* map shared memory to process address space */
-            pServerInfo = mmap( NULL,
-                                sizeof(ServerInfo),
-                                PROT_WRITE,
-                                MAP_SHARED,
-                                fd,
-                                0);
-
-            if( pServerInfo != NULL )
-            {
-                pServerInfo->pid = getpid();
-            }
-            else
-            {
-                perror("mmap");
-            }
-        }
-        else
-        {
-            perror("ftruncate");
-        }
-	}
-    else
+    if ( name != NULL )
     {
-        perror("shm_open");
+        fprintf( stderr,
+                 "usage: %s [-h] [-a] [-c <capacity>] [-r <snapshot>] "
+                 "[-j <journal>] [-w <workers>] "
+                 "[-s <shard>:<prefix>] [-v <deadline ms>]\n\n",
+                 name );
+        fprintf( stderr, "-h : display this help\n" );
+        fprintf( stderr,
+                 "-a : keep the variables in a warm standby arena and "
+                 "resume them on restart\n" );
+        fprintf( stderr,
+                 "-c : maximum number of variables (default %d)\n",
+                 VARSERVER_MAX_VARIABLES );
+        fprintf( stderr, "-r : restore the variables from a snapshot\n" );
+        fprintf( stderr,
+                 "-j : record variable changes in a journal which is "
+                 "compacted into the snapshot\n" );
+        fprintf( stderr,
+                 "-w : number of threads processing read-only requests "
+                 "(default 0)\n" );
+        fprintf( stderr,
+                 "-s : run as shard 1..%d owning the variable names "
+                 "under the prefix\n",
+                 VARSERVER_MAX_SHARDS - 1 );
+        fprintf( stderr,
+                 "-v : reject changes not validated within the deadline "
+                 "(default 0=wait)\n" );
     }
-
-    return pServerInfo;
 }
 
 /*============================================================================*/
-/*  GetClientID                                                               */
+/*  InitSignals                                                               */
 /*!
-    Get an available client identifier
+    Route the server's signals to a signalfd
 
-    The GetClientID function searches the variable server client list
-    and returns the first available client identifier
+    The InitSignals function blocks all asynchronous signals and creates
+    a non-blocking signalfd from which they can be read by the event loop.
+    Synchronous fault signals are left unblocked.
 
-    @retval an available client identifier
-    @retval 0 if no client identifiers are available
+    @retval file descriptor of the signalfd
+    @retval -1 the signalfd could not be created
 
 ==============================================================================*/
-static int GetClientID( void )
+static int InitSignals( void )
 {
-    int i;
-    int clientId = 0;
+    sigset_t mask;
+    int fd;
 
-    for(i=1;i<MAX_VAR_CLIENTS;i++)
+    sigfillset( &mask );
+    sigdelset( &mask, SIGSEGV );
+    sigdelset( &mask, SIGBUS );
+    sigdelset( &mask, SIGFPE );
+    sigdelset( &mask, SIGILL );
+
+    /* block the signals so they are delivered to the signalfd */
+    sigprocmask( SIG_BLOCK, &mask, NULL );
+
+    fd = signalfd( -1, &mask, SFD_NONBLOCK | SFD_CLOEXEC );
+    if ( fd == -1 )
     {
-        if( VarClients[i] == NULL )
-        {
-            clientId=i;
-            break;
-        }
+        perror("signalfd");
     }
 
-    return clientId;
+    return fd;
 }
 
 /*============================================================================*/
-/*  ProcessRequest                                                            */
+/*  AddEventSource                                                            */
 /*!
+    Add a file descriptor to the event loop
 
-    Process a request from a client
+    The AddEventSource function registers a file descriptor with the
+    event loop.  The specified handler is called whenever the file
+    descriptor is readable.
 
-    The ProcessRequest function handles requests received from clients
-    Requests include:
-        - closing the interface between the client and the server
+    @param[in]
+        fd
+            file descriptor to monitor
 
     @param[in]
-        pInfo
-            pointer to a siginfo_t object containing the request information
+        handler
+            pointer to the function to handle input on the fd
 
-    @retval EOK the request was processed successfully
-    @retval EINPROGRESS the request is pending and the client will remain
-            blocked until the request is complete
-    @retval EINVAL invalid argument
+    @retval EOK the event source was added
+    @retval ENOMEM no more event sources can be added
+    @retval EINVAL invalid arguments
+    @retval other error from epoll_create1 or epoll_ctl
 
 ==============================================================================*/
-static int ProcessRequest( siginfo_t *pInfo )
+static int AddEventSource( int fd, int (*handler)( int fd ) )
 {
     int result = EINVAL;
-    int clientid;
-    VarClient *pVarClient = NULL;
-    VarRequest requestType = VARREQUEST_INVALID;
-    int (*handler)(VarClient *pVarClient);
-    uint64_t *pMetric;
+    struct epoll_event ev;
+    EventSource *pEventSource;
 
-    if ( pInfo != NULL )
+    if ( ( fd != -1 ) && ( handler != NULL ) )
     {
-        /* get the client id */
-        clientid = pInfo->si_value.sival_int;
-
-        /* update the request stats */
-        STATS_IncrementRequestCount();
+        result = EOK;
 
-        if( clientid < MAX_VAR_CLIENTS )
+        if ( epollfd == -1 )
         {
-            /* get a pointer to the client information object */
-            pVarClient = VarClients[clientid];
-            if( pVarClient != NULL )
+            epollfd = epoll_create1( EPOLL_CLOEXEC );
+            if ( epollfd == -1 )
             {
-                if( pVarClient->requestType >= VARREQUEST_END_MARKER )
-                {
-                    requestType = VARREQUEST_INVALID;
-                }
-                else
-                {
-                    requestType = pVarClient->requestType;
-                }
-
-                if( pVarClient->debug >= LOG_DEBUG )
-                {
-                    printf("SERVER: Processing request %s from client %d\n",
-                            RequestHandlers[requestType].requestName,
-                            clientid);
-                }
-
-                /* update the metric */
-                pMetric = RequestHandlers[requestType].pMetric;
-                if ( pMetric != NULL )
-                {
-                    (*pMetric)++;
-                }
+                result = errno;
+            }
+        }
 
-                /* increment the client's transaction counter */
-                (pVarClient->transactionCount)++;
+        if ( result == EOK )
+        {
+            if ( numEventSources < MAX_EVENT_SOURCES )
+            {
+                pEventSource = &EventSources[numEventSources];
+                pEventSource->fd = fd;
+                pEventSource->handler = handler;
 
-                /* get the appropriate handler */
-                handler = RequestHandlers[requestType].handler;
-                if( handler != NULL )
+                ev.events = EPOLLIN;
+                ev.data.ptr = pEventSource;
+                if ( epoll_ctl( epollfd, EPOLL_CTL_ADD, fd, &ev ) == 0 )
                 {
-                    /* invoke the handler */
-                    result = handler( pVarClient );
+                    numEventSources++;
                 }
                 else
                 {
-                    /* this function is not supported yet */
-                    printf("requestType %d is not supported\n", requestType);
-                    result = ENOTSUP;
+                    result = errno;
                 }
             }
             else
             {
-                printf("SERVER: Invalid var client : NULL pointer\n");
-            }
-        }
-        else
-        {
-            printf("SERVER: Invalid client ID: %d\n", clientid);
-        }
-
-        /* a result code of EINPROGRESS indicates the the variable server
-           has passed the requested transaction off to another client
-           unblocking this client request will be deferred until
-           the other client responds */
-        if( result != EINPROGRESS )
-        {
-            /* unblock the client so it can proceed */
-            if( requestType != VARREQUEST_CLOSE )
-            {
-                UnblockClient( pVarClient );
+                result = ENOMEM;
             }
         }
     }
@@ -701,282 +1378,3041 @@ static int ProcessRequest( siginfo_t *pInfo )
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestClose                                                    */
+/*  RunEventLoop                                                              */
 /*!
-    Terminate a client connection
-
-    Handle a request from a client to terminate its connection to the
-    server.  The client is unblocked, the client memory map is closed,
-    and the client reference is deleted.
+    Run the server event loop
 
-    @param[in]
-        pVarClient
-            pointer to the variable client object
+    The RunEventLoop function waits for input on the registered event
+    sources and invokes their handlers.  It only returns if the epoll
+    file descriptor fails.
 
-    @retval EOK the client was closed successfully
-    @retval EINVAL invalid argument
-    @retval errno error number returned by munmap
+    @retval errno from epoll_wait
 
 ==============================================================================*/
-static int ProcessVarRequestClose( VarClient *pVarClient )
+static int RunEventLoop( void )
 {
-    int result = EINVAL;
-    int clientid = 0;
+    int result = EOK;
+    struct epoll_event events[MAX_EVENT_SOURCES];
+    EventSource *pEventSource;
+    int n;
+    int i;
 
-    if( pVarClient != NULL )
+    while( result == EOK )
     {
-        if( pVarClient->debug >= LOG_DEBUG )
+        n = epoll_wait( epollfd, events, MAX_EVENT_SOURCES, -1 );
+        if ( n == -1 )
         {
-            printf("SERVER: Closing Client\n");
+            if ( errno != EINTR )
+            {
+                perror("epoll_wait");
+                result = errno;
+            }
         }
 
-        pVarClient->responseVal = 0;
-
-        /* allow the client to proceed */
-        UnblockClient( pVarClient );
-
-        /* get the client id */
-        clientid = pVarClient->clientid;
-
-        if( ( clientid > 0 ) && ( clientid < MAX_VAR_CLIENTS ) )
+        for ( i = 0; i < n; i++ )
         {
-            /* clear the client entry in the VAR clients table */
-            VarClients[clientid] = NULL;
+            pEventSource = (EventSource *)events[i].data.ptr;
+            if ( pEventSource != NULL )
+            {
+                pEventSource->handler( pEventSource->fd );
+            }
         }
 
-        /* unmap the memory */
-        result = munmap( pVarClient, sizeof(VarClient));
-        if( result != EOK )
-        {
-            result = errno;
-        }
+        /* requests may have deferred rate limited notifications */
+        ArmRateLimitTimer();
 
-        if( ( result != EOK ) &&
-            ( pVarClient->debug >= LOG_DEBUG ) )
-        {
-            printf("%s failed: (%d) %s\n", __func__, result, strerror(result));
-        }
+        /* requests may have queued or completed validations */
+        ArmValidationTimer();
+
+        /* requests may have changed the variable definitions */
+        ArmStandbyTimer();
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  UnblockClient                                                             */
+/*  InitRateLimitTimer                                                        */
 /*!
-    Unblock the client connection
+    Create the rate limited notification timer
 
-    Unblocking the client connection allows the client to return from its
-    API call to the server.
-
-    @param[in]
-        pVarClient
-            pointer to the variable client object
+    The InitRateLimitTimer function creates the timer file descriptor used
+    to send NOTIFY_MODIFIED notifications which were deferred by a
+    subscription rate limit, and adds it to the event loop.
 
-    @retval EOK the client was closed successfully
-    @retval EINVAL invalid argument
+    @retval EOK the timer was created
+    @retval other error from timerfd_create or AddEventSource
 
 ==============================================================================*/
-static int UnblockClient( VarClient *pVarClient )
+static int InitRateLimitTimer( void )
 {
-    int result = EINVAL;
+    int result;
 
-    if( pVarClient != NULL )
+    rateLimitTimerFd = timerfd_create( CLOCK_MONOTONIC,
+                                       TFD_NONBLOCK | TFD_CLOEXEC );
+    if ( rateLimitTimerFd != -1 )
     {
-        if( pVarClient->debug >= LOG_DEBUG )
+        result = AddEventSource( rateLimitTimerFd, ProcessRateLimitTimer );
+        if ( result != EOK )
         {
-            printf( "SERVER: unblocking client %d pid(%d)\n",
-                    pVarClient->clientid,
-                    pVarClient->client_pid );
+            close( rateLimitTimerFd );
+            rateLimitTimerFd = -1;
         }
-
-        /* unblock the client by posting to the client semaphore */
-        sem_post( &pVarClient->sem );
-        result = EOK;
+    }
+    else
+    {
+        result = errno;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  NewClient                                                                 */
+/*  ProcessRateLimitTimer                                                     */
 /*!
-    Registers a new client
+    Handle expiry of the rate limited notification timer
 
-    The NewClient function registers a new client with the server using
-    the client's process identifier.  Once a client has been created
-    and registered, it may send requests to the server using the
-    variable server APIs.
+    The ProcessRateLimitTimer function sends the rate limited notifications
+    which are due.  The timer is re-armed for the next deferred
+    notification by the event loop.
 
     @param[in]
-        pid
-            The new client's process identifier
+        fd
+            timer file descriptor
 
-    @retval EOK the client was created and registered successfully
-    @retval EINVAL the new client could not be created
+    @retval EOK the timer was processed
 
 ==============================================================================*/
-static int NewClient( pid_t pid )
+static int ProcessRateLimitTimer( int fd )
 {
-    int fd;
-    char clientname[BUFSIZ];
-    VarClient *pVarClient;
-    int result = EINVAL;
-    int clientId;
+    uint64_t expirations;
 
-    sprintf(clientname, "/varclient_%d", pid);
+    /* acknowledge the timer */
+    if ( read( fd, &expirations, sizeof( expirations ) ) == -1 )
+    {
+        /* spurious wakeup, the time is checked below anyway */
+    }
 
-    /* get shared memory file descriptor (NOT a file) */
-	fd = shm_open( clientname, O_RDWR, S_IRUSR | S_IWUSR);
-	if (fd != -1)
-	{
-        /* map shared memory to process address space */
-        pVarClient = (VarClient *)mmap( NULL,
-                                        sizeof(VarClient),
-                                        PROT_WRITE,
-                                        MAP_SHARED,
-                                        fd,
-                                        0);
-        if (pVarClient != MAP_FAILED)
-        {
-            clientId=GetClientID();
-            if ( clientId != 0 )
-            {
-                VarClients[clientId] = pVarClient;
-                pVarClient->clientid = clientId;
-            }
-            else
-            {
-                pVarClient->clientid = 0;
-            }
+    rateLimitTimerDue = 0;
 
-            /* close the file descriptor since we don't need it for anything */
-            close( fd );
+    WORKERS_WriteLock();
+    VARLIST_SendRateLimited();
+    WORKERS_WriteUnlock();
 
-            UnblockClient( pVarClient );
+    return EOK;
+}
 
-            if ( clientId == 0 )
-            {
-                munmap( pVarClient, sizeof(VarClient));
-            }
+/*============================================================================*/
+/*  ArmRateLimitTimer                                                         */
+/*!
+    Arm the rate limited notification timer
 
-            result = EOK;
-        }
-        else
+    The ArmRateLimitTimer function sets the rate limited notification
+    timer to expire when the next deferred notification is due.  The
+    timer is only reprogrammed when the due time changes.
+
+==============================================================================*/
+static void ArmRateLimitTimer( void )
+{
+    struct itimerspec its;
+    uint64_t due;
+
+    due = VARLIST_RateLimitedDue();
+    if ( ( rateLimitTimerFd != -1 ) &&
+         ( due != rateLimitTimerDue ) )
+    {
+        memset( &its, 0, sizeof( its ) );
+        its.it_value.tv_sec = due / 1000000000ULL;
+        its.it_value.tv_nsec = due % 1000000000ULL;
+
+        /* a zero it_value disarms the timer */
+        if ( timerfd_settime( rateLimitTimerFd,
+                              TFD_TIMER_ABSTIME,
+                              &its,
+                              NULL ) == 0 )
         {
-            perror("mmap");
+            rateLimitTimerDue = due;
         }
-	}
-    else
-    {
-        perror("shm_open");
     }
-
-    return result;
 }
 
 /*============================================================================*/
-/*  ValidateClient                                                            */
+/*  InitValidationTimer                                                       */
 /*!
-    Validate a client reference
+    Create the validation deadline timer
 
-    The ValidateClient function checks that the specified pointer
-    references a valid varclient for this server.
+    The InitValidationTimer function creates the timer file descriptor
+    used to complete the validation requests which were not answered
+    before their deadline, and adds it to the event loop.
 
-    @param[in]
+    @retval EOK the timer was created
+    @retval other error from timerfd_create or AddEventSource
+
+==============================================================================*/
+static int InitValidationTimer( void )
+{
+    int result;
+
+    validationTimerFd = timerfd_create( CLOCK_MONOTONIC,
+                                        TFD_NONBLOCK | TFD_CLOEXEC );
+    if ( validationTimerFd != -1 )
+    {
+        result = AddEventSource( validationTimerFd, ProcessValidationTimer );
+        if ( result != EOK )
+        {
+            close( validationTimerFd );
+            validationTimerFd = -1;
+        }
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessValidationTimer                                                    */
+/*!
+    Handle expiry of the validation deadline timer
+
+    The ProcessValidationTimer function completes each validation request
+    whose deadline has passed with the default response of its validator,
+    and releases the writers which were waiting for them.  The timer is
+    re-armed for the next deadline by the event loop.
+
+    @param[in]
+        fd
+            timer file descriptor
+
+    @retval EOK the timer was processed
+
+==============================================================================*/
+static int ProcessValidationTimer( int fd )
+{
+    uint64_t expirations;
+    uint64_t now;
+    uint32_t id;
+    int response;
+
+    /* acknowledge the timer */
+    if ( read( fd, &expirations, sizeof( expirations ) ) == -1 )
+    {
+        /* spurious wakeup, the deadlines are checked below anyway */
+    }
+
+    validationTimerDue = 0;
+    now = STATS_Now();
+
+    WORKERS_WriteLock();
+
+    while ( VALIDATE_Expired( now, &id, &response ) == EOK )
+    {
+        if ( pValidationTimeouts != NULL )
+        {
+            (*pValidationTimeouts)++;
+        }
+
+        CompleteValidation( id, response );
+    }
+
+    WORKERS_WriteUnlock();
+
+    /* make the changes durable before their clients are released */
+    CommitJournal();
+
+    /* release the clients whose requests are complete */
+    FlushUnblockedClients();
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  ArmValidationTimer                                                        */
+/*!
+    Arm the validation deadline timer
+
+    The ArmValidationTimer function sets the validation deadline timer
+    to expire when the next pending validation request is due.  The
+    timer is only reprogrammed when the due time changes.
+
+==============================================================================*/
+static void ArmValidationTimer( void )
+{
+    struct itimerspec its;
+    uint64_t due;
+
+    due = VALIDATE_Due();
+    if ( ( validationTimerFd != -1 ) &&
+         ( due != validationTimerDue ) )
+    {
+        memset( &its, 0, sizeof( its ) );
+        its.it_value.tv_sec = due / 1000000000ULL;
+        its.it_value.tv_nsec = due % 1000000000ULL;
+
+        /* a zero it_value disarms the timer */
+        if ( timerfd_settime( validationTimerFd,
+                              TFD_TIMER_ABSTIME,
+                              &its,
+                              NULL ) == 0 )
+        {
+            validationTimerDue = due;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  InitStandbyTimer                                                          */
+/*!
+    Create the warm standby arena timer
+
+    The InitStandbyTimer function creates the timer file descriptor used
+    to rebuild the warm standby arena after the variable definitions
+    change, and adds it to the event loop.
+
+    @retval EOK the timer was created
+    @retval other error from timerfd_create or AddEventSource
+
+==============================================================================*/
+static int InitStandbyTimer( void )
+{
+    int result;
+
+    standbyTimerFd = timerfd_create( CLOCK_MONOTONIC,
+                                     TFD_NONBLOCK | TFD_CLOEXEC );
+    if ( standbyTimerFd != -1 )
+    {
+        result = AddEventSource( standbyTimerFd, ProcessStandbyTimer );
+        if ( result != EOK )
+        {
+            close( standbyTimerFd );
+            standbyTimerFd = -1;
+        }
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessStandbyTimer                                                       */
+/*!
+    Handle expiry of the warm standby arena timer
+
+    The ProcessStandbyTimer function rebuilds the warm standby arena.
+    The timer is re-armed by the event loop when the variable
+    definitions change again.
+
+    @param[in]
+        fd
+            timer file descriptor
+
+    @retval EOK the timer was processed
+
+==============================================================================*/
+static int ProcessStandbyTimer( int fd )
+{
+    uint64_t expirations;
+
+    /* acknowledge the timer */
+    if ( read( fd, &expirations, sizeof( expirations ) ) == -1 )
+    {
+        /* spurious wakeup, the arena is rebuilt anyway */
+    }
+
+    standbyTimerDue = 0;
+
+    WORKERS_WriteLock();
+    STANDBY_Sync();
+    WORKERS_WriteUnlock();
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  ArmStandbyTimer                                                           */
+/*!
+    Arm the warm standby arena timer
+
+    The ArmStandbyTimer function sets the warm standby arena timer to
+    expire when the arena is next due to be rebuilt.  The timer is only
+    reprogrammed when the due time changes.
+
+==============================================================================*/
+static void ArmStandbyTimer( void )
+{
+    struct itimerspec its;
+    uint64_t due;
+
+    due = STANDBY_Due();
+    if ( ( standbyTimerFd != -1 ) &&
+         ( due != standbyTimerDue ) )
+    {
+        memset( &its, 0, sizeof( its ) );
+        its.it_value.tv_sec = due / 1000000000ULL;
+        its.it_value.tv_nsec = due % 1000000000ULL;
+
+        /* an arena which is already due is rebuilt straight away */
+        if ( ( due != 0 ) &&
+             ( its.it_value.tv_sec == 0 ) &&
+             ( its.it_value.tv_nsec == 0 ) )
+        {
+            its.it_value.tv_nsec = 1;
+        }
+
+        /* a zero it_value disarms the timer */
+        if ( timerfd_settime( standbyTimerFd,
+                              TFD_TIMER_ABSTIME,
+                              &its,
+                              NULL ) == 0 )
+        {
+            standbyTimerDue = due;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  InitClientMonitor                                                         */
+/*!
+    Create the client exit monitor
+
+    The InitClientMonitor function creates the epoll file descriptor
+    which monitors the process descriptors of the clients, and adds it
+    to the event loop.  When a client process exits, its resources are
+    reclaimed immediately instead of when the server next fails to
+    signal it.
+
+    @retval EOK the client exit monitor was created
+    @retval other error from epoll_create1 or AddEventSource
+
+==============================================================================*/
+static int InitClientMonitor( void )
+{
+    int result;
+
+    clientExitFd = epoll_create1( EPOLL_CLOEXEC );
+    if ( clientExitFd != -1 )
+    {
+        result = AddEventSource( clientExitFd, ProcessClientExits );
+        if ( result != EOK )
+        {
+            close( clientExitFd );
+            clientExitFd = -1;
+        }
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  MonitorClient                                                             */
+/*!
+    Start monitoring the process of a new client
+
+    The MonitorClient function records the process of a new client and
+    opens a process descriptor for it, unless another connection of the
+    same process already holds one.  A client whose process descriptor
+    cannot be opened is still served, and is cleaned up lazily.
+
+    @param[in]
+        clientid
+            identifier of the new client
+
+    @param[in]
+        pid
+            process identifier of the new client
+
+==============================================================================*/
+static void MonitorClient( int clientid, pid_t pid )
+{
+    struct epoll_event ev;
+    bool monitored = false;
+    int fd;
+    int i;
+
+    ClientPIDs[clientid] = pid;
+    ClientPidFds[clientid] = 0;
+    ClientExited[clientid] = false;
+
+    for( i = 1; ( i < MAX_VAR_CLIENTS ) && ( monitored == false ); i++ )
+    {
+        monitored = ( VarClients[i] != NULL ) &&
+                    ( ClientPIDs[i] == pid ) &&
+                    ( ClientPidFds[i] > 0 );
+    }
+
+    if ( ( clientExitFd != -1 ) &&
+         ( monitored == false ) )
+    {
+        fd = (int)syscall( SYS_pidfd_open, pid, 0 );
+        if ( fd > 0 )
+        {
+            memset( &ev, 0, sizeof( ev ) );
+            ev.events = EPOLLIN;
+            ev.data.u32 = (uint32_t)pid;
+            if ( epoll_ctl( clientExitFd, EPOLL_CTL_ADD, fd, &ev ) == 0 )
+            {
+                ClientPidFds[clientid] = fd;
+            }
+            else
+            {
+                close( fd );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  UnmonitorClient                                                           */
+/*!
+    Stop monitoring the process of a closing client
+
+    The UnmonitorClient function hands the process descriptor held by
+    a closing client to another connection of the same process, or
+    closes it if the process has no other connections.
+
+    @param[in]
+        clientid
+            identifier of the closing client
+
+==============================================================================*/
+static void UnmonitorClient( int clientid )
+{
+    int fd = ClientPidFds[clientid];
+    int i;
+
+    for( i = 1; ( i < MAX_VAR_CLIENTS ) && ( fd > 0 ); i++ )
+    {
+        if ( ( i != clientid ) &&
+             ( VarClients[i] != NULL ) &&
+             ( ClientPIDs[i] == ClientPIDs[clientid] ) )
+        {
+            ClientPidFds[i] = fd;
+            fd = 0;
+        }
+    }
+
+    if ( fd > 0 )
+    {
+        /* closing the descriptor removes it from the exit monitor */
+        close( fd );
+    }
+
+    if ( ClientExited[clientid] == true )
+    {
+        exitedCount--;
+    }
+
+    ClientPidFds[clientid] = 0;
+    ClientPIDs[clientid] = 0;
+    ClientExited[clientid] = false;
+}
+
+/*============================================================================*/
+/*  ProcessClientExits                                                        */
+/*!
+    Handle the exit of client processes
+
+    The ProcessClientExits function is called by the event loop when
+    the process descriptor of one or more clients becomes readable,
+    which indicates that the process has exited.  The resources of
+    each exited process are reclaimed.
+
+    @param[in]
+        fd
+            client exit monitor epoll file descriptor
+
+    @retval EOK the client exits were processed
+    @retval other error from epoll_wait
+
+==============================================================================*/
+static int ProcessClientExits( int fd )
+{
+    int result = EOK;
+    struct epoll_event events[MAX_CLIENT_EXIT_BATCH];
+    int n;
+    int i;
+
+    n = epoll_wait( fd, events, MAX_CLIENT_EXIT_BATCH, 0 );
+    if ( n == -1 )
+    {
+        result = errno;
+    }
+
+    if ( n > 0 )
+    {
+        WORKERS_WriteLock();
+
+        for ( i = 0; i < n; i++ )
+        {
+            ReclaimClientProcess( (pid_t)events[i].data.u32 );
+        }
+
+        WORKERS_WriteUnlock();
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReclaimClientProcess                                                      */
+/*!
+    Reclaim the resources of an exited client process
+
+    The ReclaimClientProcess function marks every connection of the
+    exited process for release, and discards its notification
+    registrations, search contexts, query subscriptions, transactions,
+    validator registration and notification message queue.  It must
+    be called with exclusive access to the variable store, outside of
+    a batch of requests.
+
+    @param[in]
+        pid
+            process identifier of the exited client
+
+==============================================================================*/
+static void ReclaimClientProcess( pid_t pid )
+{
+    char name[BUFSIZ];
+    size_t notifications;
+    size_t contexts;
+    int i;
+
+    for( i = 1; i < MAX_VAR_CLIENTS; i++ )
+    {
+        if ( ( VarClients[i] != NULL ) &&
+             ( ClientPIDs[i] == pid ) &&
+             ( ClientExited[i] == false ) )
+        {
+            if ( ClientPidFds[i] > 0 )
+            {
+                close( ClientPidFds[i] );
+                ClientPidFds[i] = 0;
+            }
+
+            ClientExited[i] = true;
+            exitedCount++;
+        }
+    }
+
+    /* release the writers waiting for this client's validations */
+    VALIDATE_RemoveValidator( pid );
+
+    /* forget the requests the client was waiting on */
+    CountReclaimed( pReclaimedTransactions,
+                    TRANSACTION_RemoveByRequestor( pid ) );
+
+    if ( VARLIST_PurgeClient( pid, &notifications, &contexts ) == EOK )
+    {
+        CountReclaimed( pReclaimedNotifications, notifications );
+        CountReclaimed( pReclaimedContexts, contexts );
+    }
+
+    /* the notification queue belongs to the root server connection */
+    if ( serverShard == 0 )
+    {
+        snprintf( name, sizeof( name ), "/varclient_%d", pid );
+        if ( mq_unlink( name ) == 0 )
+        {
+            CountReclaimed( pReclaimedObjects, 1 );
+        }
+    }
+
+    ReclaimExitedClients();
+}
+
+/*============================================================================*/
+/*  ReclaimExitedClients                                                      */
+/*!
+    Release the connections of exited client processes
+
+    The ReclaimExitedClients function releases each connection whose
+    process has exited, along with its blocked requests and its shared
+    memory object.  A connection whose request is still held by a
+    read-only worker is released on a later call.  It must be called
+    with exclusive access to the variable store, outside of a batch
+    of requests.
+
+==============================================================================*/
+static void ReclaimExitedClients( void )
+{
+    VarClient *pVarClient;
+    char name[BUFSIZ];
+    int i;
+
+    for( i = 1; ( i < MAX_VAR_CLIENTS ) && ( exitedCount > 0 ); i++ )
+    {
+        pVarClient = VarClients[i];
+        if ( ( pVarClient == NULL ) ||
+             ( ClientExited[i] == false ) ||
+             ( __atomic_load_n( &WorkerRequests[i], __ATOMIC_ACQUIRE ) > 0 ) )
+        {
+            continue;
+        }
+
+        CountReclaimed( pReclaimedBlocked, RemoveBlockedClient( pVarClient ) );
+
+        ClientName( name,
+                    sizeof( name ),
+                    ClientPIDs[i],
+                    pVarClient->channel,
+                    serverShard );
+        if ( shm_unlink( name ) == 0 )
+        {
+            CountReclaimed( pReclaimedObjects, 1 );
+        }
+
+        /* the request in progress is abandoned, not completed */
+        RequestStart[i] = 0;
+        pVarClient->asyncCompletion = false;
+        pVarClient->clientid = i;
+
+        ProcessVarRequestClose( pVarClient );
+        CountReclaimed( pReclaimedClients, 1 );
+    }
+}
+
+/*============================================================================*/
+/*  CountReclaimed                                                            */
+/*!
+    Add to a reclaimed resource metric
+
+    @param[in]
+        pMetric
+            pointer to the metric, or NULL if it is not available
+
+    @param[in]
+        n
+            number of resources reclaimed
+
+==============================================================================*/
+static void CountReclaimed( uint64_t *pMetric, size_t n )
+{
+    if ( pMetric != NULL )
+    {
+        *pMetric += n;
+    }
+}
+
+/*============================================================================*/
+/*  OnQueueOverflow                                                           */
+/*!
+    Count a change lost or delayed by a full notification queue
+
+    The OnQueueOverflow function is called by the notification module
+    when a NOTIFY_MODIFIED_QUEUE payload could not be placed on a
+    client's message queue.  It increments the overflow counter of the
+    client's primary connection, which the client reads via
+    VAR_GetQueueOverflows.
+
+    @param[in]
+        pid
+            process identifier of the client owning the message queue
+
+==============================================================================*/
+static void OnQueueOverflow( pid_t pid )
+{
+    static int lastid = 0;
+    int i;
+
+    if ( ( VarClients[lastid] == NULL ) ||
+         ( ClientPIDs[lastid] != pid ) ||
+         ( VarClients[lastid]->channel != 0 ) )
+    {
+        lastid = 0;
+
+        for( i = 1; ( i < MAX_VAR_CLIENTS ) && ( lastid == 0 ); i++ )
+        {
+            if ( ( VarClients[i] != NULL ) &&
+                 ( ClientPIDs[i] == pid ) &&
+                 ( VarClients[i]->channel == 0 ) )
+            {
+                lastid = i;
+            }
+        }
+    }
+
+    if ( VarClients[lastid] != NULL )
+    {
+        __atomic_add_fetch( &VarClients[lastid]->queueOverflows,
+                            1,
+                            __ATOMIC_RELAXED );
+    }
+}
+
+/*============================================================================*/
+/*  CommitJournal                                                             */
+/*!
+    Commit the journalled variable changes
+
+    The CommitJournal function makes the variable changes recorded while
+    processing the current batch of requests durable with a single disk
+    synchronization, and compacts the journal into the snapshot once it
+    has grown past JOURNAL_COMPACT_SIZE.
+
+==============================================================================*/
+static void CommitJournal( void )
+{
+    if ( JOURNAL_Flush() != EOK )
+    {
+        syslog( LOG_ERR, "cannot write the change journal" );
+    }
+
+    if ( JOURNAL_Length() >= JOURNAL_COMPACT_SIZE )
+    {
+        CompactJournal();
+    }
+}
+
+/*============================================================================*/
+/*  CompactJournal                                                            */
+/*!
+    Fold the change journal into the snapshot
+
+    The CompactJournal function writes all of the variables to the
+    journal snapshot and then empties the journal.  The journal is
+    flushed first so it never holds fewer changes than the snapshot,
+    and replaying it over the new snapshot after a failure part way
+    through the compaction gives the same values.
+
+    @retval EOK the journal was compacted
+    @retval EINVAL there is no journal snapshot
+    @retval other error writing the snapshot or the journal
+
+==============================================================================*/
+static int CompactJournal( void )
+{
+    int result = EINVAL;
+    size_t count = 0;
+
+    if ( journalSnapshot != NULL )
+    {
+        result = JOURNAL_Flush();
+        if ( result == EOK )
+        {
+            result = SNAPSHOT_Save( journalSnapshot, 0, &count );
+        }
+
+        if ( result == EOK )
+        {
+            result = JOURNAL_Reset();
+        }
+
+        if ( result == EOK )
+        {
+            syslog( LOG_INFO, "compacted journal into %s (%zu variables)",
+                    journalSnapshot,
+                    count );
+        }
+        else
+        {
+            syslog( LOG_ERR, "cannot compact journal: %s",
+                    strerror( result ) );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessSignals                                                            */
+/*!
+    Process pending signals
+
+    The ProcessSignals function drains the signalfd in batches, handling
+    each signal in turn.  High priority requests are processed as they
+    are received, and normal priority requests are queued on the normal
+    lane.  The normal lane is serviced a slice at a time, draining the
+    signalfd again between slices so a high priority request never
+    waits behind more than a slice of normal priority requests.
+    Clients whose requests were completed are unblocked once all of
+    the pending requests have been handled.
+
+    @param[in]
+        fd
+            signalfd file descriptor
+
+    @retval EOK the pending signals were processed
+    @retval other error from read
+
+==============================================================================*/
+static int ProcessSignals( int fd )
+{
+    int result = EOK;
+    struct signalfd_siginfo info[MAX_SIGNAL_BATCH];
+    ssize_t n;
+    size_t count;
+    size_t i;
+
+    do
+    {
+        do
+        {
+            n = read( fd, info, sizeof( info ) );
+            if ( n > 0 )
+            {
+                count = (size_t)n / sizeof( struct signalfd_siginfo );
+                for ( i = 0; i < count; i++ )
+                {
+                    ProcessSignal( &info[i] );
+                }
+            }
+            else if ( ( n == -1 ) &&
+                      ( errno != EAGAIN ) &&
+                      ( errno != EINTR ) )
+            {
+                result = errno;
+            }
+
+        } while( n > 0 );
+
+    } while( ProcessNormalLane( NORMAL_LANE_SLICE ) == true );
+
+    /* make the changes durable before their clients are released */
+    CommitJournal();
+
+    /* release the clients whose requests are complete */
+    FlushUnblockedClients();
+
+    if ( ( exitedCount > 0 ) || ( closingCount > 0 ) )
+    {
+        /* retry the exited and closed clients which were held by
+           a worker */
+        WORKERS_WriteLock();
+        ReclaimExitedClients();
+        ReleaseClosedClients();
+        WORKERS_WriteUnlock();
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessSignal                                                             */
+/*!
+    Handle a received signal
+
+    The ProcessSignal function is called by the event loop for each
+    signal read from the signalfd.
+
+    Handled signals include:
+
+    - SIG_NEWCLIENT
+    - SIG_CLIENT_REQUEST
+    - SIG_CLIENT_DOORBELL
+    - SIG_TIMER
+
+    @param[in]
+        pInfo
+            pointer to the signalfd_siginfo object containing the signal info
+
+==============================================================================*/
+static void ProcessSignal( struct signalfd_siginfo *pInfo )
+{
+    int sig = (int)pInfo->ssi_signo;
+
+    if ( sig == SIG_NEWCLIENT )
+    {
+        WORKERS_WriteLock();
+        NewClient( (pid_t)pInfo->ssi_pid, pInfo->ssi_int );
+        WORKERS_WriteUnlock();
+    }
+    else if ( sig == SIG_CLIENT_REQUEST )
+    {
+        DispatchRequest( pInfo->ssi_int, (pid_t)pInfo->ssi_pid );
+    }
+    else if ( sig == SIG_CLIENT_DOORBELL )
+    {
+        ProcessRequestRing();
+    }
+    else if ( sig == SIG_TIMER )
+    {
+        WORKERS_WriteLock();
+        ReclaimExitedClients();
+        ReleaseClosedClients();
+        STATS_Process();
+        WORKERS_WriteUnlock();
+    }
+    else if ( sig == SIGINT )
+    {
+        exit( 1 );
+    }
+    else
+    {
+        printf("SERVER: unhandled signal: %d\n", sig);
+    }
+}
+
+/*============================================================================*/
+/*  InitServerInfo                                                            */
+/*!
+    Construct the server information which is shared with clients
+    via the /varserver shared memory object.  Shard servers use
+    /varserver.<shard>
+
+    This information includes:
+        - the variable server process identifier used by clients
+          to send messages to the server
+        - the name resolution generation, which is seeded from the
+          start time so it changes when the server restarts
+        - the shard index and the variable name prefix it owns
+        - the variable store identifier, which only changes when the
+          server restarts without resuming the previous variable store
+        - whether the server keeps a warm standby arena
+
+    @param[in]
+        prefix
+            variable name prefix owned by this server, empty for
+            the root server
+
+    @param[in]
+        storeID
+            identifier of the variable store resumed from the warm
+            standby arena, or 0 for a new variable store
+
+    @param[in]
+        standby
+            true if the server keeps a warm standby arena
+
+    @retval pointer to the server information object
+    @retval NULL if the server information object could not be created
+
+==============================================================================*/
+static ServerInfo *InitServerInfo( char *prefix,
+                                   uint64_t storeID,
+                                   bool standby )
+{
+    int fd;
+    int res;
+    ServerInfo *pServerInfo = NULL;
+    struct timespec now;
+    char name[BUFSIZ];
+
+    ShardName( name, sizeof( name ), SERVER_SHAREDMEM, serverShard );
+
+    /* get shared memory file descriptor (NOT a file) */
+	fd = shm_open(name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR);
+	if (fd != -1)
+	{
+    	/* extend shared memory object as it is initialized with size 0 */
+	    res = ftruncate(fd, sizeof(ServerInfo));
+	    if (res != -1)
+	    {
+            /* map shared memory to process address space */
+            pServerInfo = mmap( NULL,
+                                sizeof(ServerInfo),
+                                PROT_WRITE,
+                                MAP_SHARED,
+                                fd,
+                                0);
+
+            if( pServerInfo != NULL )
+            {
+                /* publish the shard and the store before the pid so a
+                   client never sees a running server with a stale prefix
+                   or store identifier */
+                pServerInfo->shard = serverShard;
+                memset( pServerInfo->prefix, 0, sizeof( pServerInfo->prefix ) );
+                strncpy( pServerInfo->prefix, prefix, MAX_NAME_LEN );
+
+                if( clock_gettime( CLOCK_REALTIME, &now ) == 0 )
+                {
+                    pServerInfo->generation =
+                        (uint64_t)now.tv_sec * 1000000000ULL +
+                        (uint64_t)now.tv_nsec;
+                }
+                else
+                {
+                    pServerInfo->generation++;
+                }
+
+                /* a new variable store is identified by its generation */
+                pServerInfo->storeID = ( storeID != 0 )
+                                       ? storeID
+                                       : pServerInfo->generation;
+                pServerInfo->standby = standby;
+
+                VARLIST_SetGeneration( &pServerInfo->generation );
+
+                /* clients reconnect when they see the new pid */
+                __atomic_store_n( &pServerInfo->pid,
+                                  getpid(),
+                                  __ATOMIC_RELEASE );
+            }
+            else
+            {
+                perror("mmap");
+            }
+        }
+        else
+        {
+            perror("ftruncate");
+        }
+	}
+    else
+    {
+        perror("shm_open");
+    }
+
+    return pServerInfo;
+}
+
+/*============================================================================*/
+/*  GetClientID                                                               */
+/*!
+    Get an available client identifier
+
+    The GetClientID function searches the variable server client list
+    and returns the first available client identifier
+
+    @retval an available client identifier
+    @retval 0 if no client identifiers are available
+
+==============================================================================*/
+static int GetClientID( void )
+{
+    int i;
+    int clientId = 0;
+
+    for(i=1;i<MAX_VAR_CLIENTS;i++)
+    {
+        if( VarClients[i] == NULL )
+        {
+            clientId=i;
+            break;
+        }
+    }
+
+    return clientId;
+}
+
+/*============================================================================*/
+/*  ProcessRequest                                                            */
+/*!
+
+    Process a request from a client
+
+    The ProcessRequest function handles requests received from clients
+    Requests include:
+        - closing the interface between the client and the server
+
+    @param[in]
+        clientid
+            identifier of the client which made the request
+
+    @retval EOK the request was processed successfully
+    @retval EINPROGRESS the request is pending and the client will remain
+            blocked until the request is complete
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int ProcessRequest( int clientid )
+{
+    int result = EINVAL;
+    VarClient *pVarClient = NULL;
+    VarRequest requestType = VARREQUEST_INVALID;
+    int (*handler)(VarClient *pVarClient);
+    uint64_t *pMetric;
+    uint64_t now;
+    bool readOnly;
+
+    /* update the request stats */
+    STATS_IncrementRequestCount();
+
+    if( ( clientid > 0 ) && ( clientid < MAX_VAR_CLIENTS ) )
+    {
+        /* get a pointer to the client information object */
+        pVarClient = VarClients[clientid];
+        if( pVarClient != NULL )
+        {
+            if( pVarClient->requestType >= VARREQUEST_END_MARKER )
+            {
+                requestType = VARREQUEST_INVALID;
+            }
+            else
+            {
+                requestType = pVarClient->requestType;
+            }
+
+            if( pVarClient->debug >= LOG_DEBUG )
+            {
+                printf("SERVER: Processing request %s from client %d\n",
+                        RequestHandlers[requestType].requestName,
+                        clientid);
+            }
+
+            /* update the metric */
+            pMetric = RequestHandlers[requestType].pMetric;
+            if ( pMetric != NULL )
+            {
+                (*pMetric)++;
+            }
+
+            /* measure the queueing delay, and start timing the service
+               time which ends when the client is unblocked */
+            now = STATS_Now();
+            if ( ( pVarClient->requestTime != 0 ) &&
+                 ( pVarClient->requestTime <= now ) )
+            {
+                STATS_RecordLatency( queueLatency,
+                                     now - pVarClient->requestTime );
+                STATS_RecordLatency( LaneLatency[ClientPriority[clientid]],
+                                     now - pVarClient->requestTime );
+            }
+
+            RequestStart[clientid] = now;
+            RequestType[clientid] = requestType;
+            RequestResult[clientid] = EOK;
+
+            /* increment the client's transaction counter */
+            (pVarClient->transactionCount)++;
+
+            /* replace the request credentials with those resolved
+               when the client connected */
+            PERMSETS_Apply( clientid, &pVarClient->variableInfo );
+
+            /* get the appropriate handler */
+            handler = RequestHandlers[requestType].handler;
+            readOnly = ( handler != NULL ) &&
+                       ( RequestHandlers[requestType].readOnly == true );
+            if( readOnly == true )
+            {
+                /* the client is not released while a worker holds
+                   its request */
+                __atomic_add_fetch( &WorkerRequests[clientid],
+                                    1,
+                                    __ATOMIC_ACQ_REL );
+            }
+
+            if( ( readOnly == true ) &&
+                ( WORKERS_Submit( pVarClient ) == EOK ) )
+            {
+                /* a worker will process the request and unblock
+                   the client */
+                result = EINPROGRESS;
+            }
+            else if( handler != NULL )
+            {
+                if( readOnly == true )
+                {
+                    /* the request was not accepted by a worker */
+                    __atomic_sub_fetch( &WorkerRequests[clientid],
+                                        1,
+                                        __ATOMIC_ACQ_REL );
+                }
+
+                /* invoke the handler with exclusive access to the
+                   variable store */
+                WORKERS_WriteLock();
+                result = handler( pVarClient );
+                WORKERS_WriteUnlock();
+
+                /* the handler may have remapped the client object */
+                if( requestType == VARREQUEST_RESIZE_WORKBUF )
+                {
+                    pVarClient = VarClients[clientid];
+                }
+            }
+            else
+            {
+                /* this function is not supported yet */
+                printf("requestType %d is not supported\n", requestType);
+                result = ENOTSUP;
+            }
+        }
+        else
+        {
+            printf("SERVER: Invalid var client : NULL pointer\n");
+        }
+    }
+    else
+    {
+        printf("SERVER: Invalid client ID: %d\n", clientid);
+    }
+
+    /* a result code of EINPROGRESS indicates the the variable server
+       has passed the requested transaction off to another client
+       unblocking this client request will be deferred until
+       the other client responds */
+    if( result != EINPROGRESS )
+    {
+        /* unblock the client so it can proceed */
+        if( requestType != VARREQUEST_CLOSE )
+        {
+            if( ( clientid > 0 ) && ( clientid < MAX_VAR_CLIENTS ) )
+            {
+                RequestResult[clientid] = result;
+            }
+
+            DeferUnblockClient( pVarClient );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessReadRequest                                                        */
+/*!
+    Process a read-only request on a worker thread
+
+    The ProcessReadRequest function is called by a read-only request
+    worker to process a request which was queued by ProcessRequest.
+    The handler runs with shared access to the variable store.  If the
+    handler cannot complete the request without modifying the store it
+    returns EWOULDBLOCK, and the request is handed back to the main
+    thread.  Otherwise the client is unblocked directly.
+
+    @param[in]
+        pVarClient
+            pointer to the client whose request is to be processed
+
+==============================================================================*/
+static void ProcessReadRequest( VarClient *pVarClient )
+{
+    int result;
+    int clientid = pVarClient->clientid;
+    int (*handler)(VarClient *pVarClient);
+
+    /* use the request type validated by ProcessRequest */
+    handler = RequestHandlers[RequestType[clientid]].handler;
+
+    WORKERS_ReadLock();
+    result = handler( pVarClient );
+    WORKERS_ReadUnlock();
+
+    if( ( result != EWOULDBLOCK ) ||
+        ( WORKERS_Defer( pVarClient ) != EOK ) )
+    {
+        RequestResult[clientid] = result;
+        UnblockClient( pVarClient );
+
+        /* the request is no longer held by a worker.  The client may
+           already be closed, so only its identifier is used here */
+        __atomic_sub_fetch( &WorkerRequests[clientid],
+                            1,
+                            __ATOMIC_ACQ_REL );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessDeferredRequests                                                   */
+/*!
+    Complete the requests handed back by the read-only workers
+
+    The ProcessDeferredRequests function is called by the event loop
+    when a read-only worker has handed a request back to the main
+    thread.  The request's handler is run again with exclusive access
+    to the variable store, where it may block the client, for example
+    on a CALC handler.
+
+    @param[in]
+        fd
+            deferred request eventfd (unused)
+
+    @retval EOK the deferred requests were processed
+
+==============================================================================*/
+static int ProcessDeferredRequests( int fd )
+{
+    VarClient *pVarClient;
+    int clientid;
+    int result;
+    int (*handler)(VarClient *pVarClient);
+
+    (void)fd;
+
+    while( ( pVarClient = WORKERS_NextDeferred() ) != NULL )
+    {
+        clientid = pVarClient->clientid;
+
+        /* use the request type validated by ProcessRequest */
+        handler = RequestHandlers[RequestType[clientid]].handler;
+
+        WORKERS_WriteLock();
+        result = handler( pVarClient );
+        WORKERS_WriteUnlock();
+
+        if( result != EINPROGRESS )
+        {
+            RequestResult[clientid] = result;
+            DeferUnblockClient( pVarClient );
+        }
+
+        /* the request is no longer held by a worker */
+        __atomic_sub_fetch( &WorkerRequests[clientid],
+                            1,
+                            __ATOMIC_ACQ_REL );
+    }
+
+    /* release the clients whose requests are complete */
+    FlushUnblockedClients();
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  ProcessRequestRing                                                        */
+/*!
+    Process the requests queued on the client request ring
+
+    The ProcessRequestRing function is called when a client rings the
+    request ring doorbell.  It processes all of the queued requests,
+    including any which arrive while it is running, and then marks
+    the server idle so the next request rings the doorbell again.
+
+==============================================================================*/
+static void ProcessRequestRing( void )
+{
+    int clientid;
+    pid_t pid = 0;
+
+    do
+    {
+        while( ( clientid = REQUESTRING_Pop( &pid ) ) != 0 )
+        {
+            DispatchRequest( clientid, pid );
+        }
+
+    } while( REQUESTRING_Idle() == false );
+}
+
+/*============================================================================*/
+/*  DispatchRequest                                                           */
+/*!
+    Process or queue a request according to the client priority
+
+    The DispatchRequest function processes the request of a high
+    priority client immediately, and queues the request of a normal
+    priority client on the normal lane.  Each client has at most one
+    request outstanding, so the normal lane only fills up if a client
+    signals the server without waiting for its response, in which
+    case the request is processed immediately.  Requests which are
+    not accepted by AcceptRequest are discarded.
+
+    @param[in]
+        clientid
+            identifier of the client which made the request
+
+    @param[in]
+        pid
+            process identifier of the submitter of the request
+
+==============================================================================*/
+static void DispatchRequest( int clientid, pid_t pid )
+{
+    int idx;
+
+    if( AcceptRequest( clientid, pid ) == true )
+    {
+        if( ( ClientPriority[clientid] == VARSERVER_PRIORITY_NORMAL ) &&
+            ( normalLaneCount < MAX_VAR_CLIENTS ) )
+        {
+            idx = ( normalLaneHead + normalLaneCount ) % MAX_VAR_CLIENTS;
+            NormalLane[idx] = clientid;
+            normalLaneCount++;
+        }
+        else
+        {
+            ProcessRequest( clientid );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  AcceptRequest                                                             */
+/*!
+    Check that a queued request was made by the client it names
+
+    The AcceptRequest function checks a client identifier received from
+    the request ring or a request signal before the request is
+    processed.  The request is only accepted if it was submitted by
+    the process which registered the client, the client is not being
+    closed or released, and the client has marked the request pending.
+    The pending mark is cleared, so each request is accepted once.
+
+    @param[in]
+        clientid
+            identifier of the client which made the request
+
+    @param[in]
+        pid
+            process identifier of the submitter of the request
+
+    @retval true the request may be processed
+    @retval false the request must be discarded
+
+==============================================================================*/
+static bool AcceptRequest( int clientid, pid_t pid )
+{
+    bool accept = false;
+    VarClient *pVarClient;
+
+    if( ( clientid > 0 ) &&
+        ( clientid < MAX_VAR_CLIENTS ) &&
+        ( pid > 0 ) &&
+        ( ClientPIDs[clientid] == pid ) &&
+        ( ClientClosing[clientid] == false ) &&
+        ( ClientExited[clientid] == false ) )
+    {
+        pVarClient = VarClients[clientid];
+        if( pVarClient != NULL )
+        {
+            accept = ( __atomic_exchange_n( &pVarClient->pending,
+                                            0,
+                                            __ATOMIC_ACQ_REL ) != 0 );
+        }
+    }
+
+    return accept;
+}
+
+/*============================================================================*/
+/*  ProcessNormalLane                                                         */
+/*!
+    Process a slice of the normal priority requests
+
+    The ProcessNormalLane function processes up to the specified number
+    of requests from the normal lane, oldest first.
+
+    @param[in]
+        slice
+            maximum number of requests to process
+
+    @retval true there are requests remaining on the normal lane
+    @retval false the normal lane is empty
+
+==============================================================================*/
+static bool ProcessNormalLane( int slice )
+{
+    int clientid;
+
+    while( ( slice-- > 0 ) && ( normalLaneCount > 0 ) )
+    {
+        clientid = NormalLane[normalLaneHead];
+        normalLaneHead = ( normalLaneHead + 1 ) % MAX_VAR_CLIENTS;
+        normalLaneCount--;
+
+        ProcessRequest( clientid );
+    }
+
+    return ( normalLaneCount > 0 );
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestClose                                                    */
+/*!
+    Terminate a client connection
+
+    Handle a request from a client to terminate its connection to the
+    server.  The client is unblocked, the client memory map is closed,
+    and the client reference is deleted.  If a read-only worker still
+    holds a request of the client, the client memory map is closed by
+    ReleaseClosedClients once the worker is finished with it.
+
+    @param[in]
+        pVarClient
+            pointer to the variable client object
+
+    @retval EOK the client was closed successfully
+    @retval EINVAL invalid argument
+    @retval errno error number returned by munmap
+
+==============================================================================*/
+static int ProcessVarRequestClose( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    int clientid = 0;
+    bool valid;
+    size_t mapsize;
+
+    if( pVarClient != NULL )
+    {
+        if( pVarClient->debug >= LOG_DEBUG )
+        {
+            printf("SERVER: Closing Client\n");
+        }
+
+        /* get the client id */
+        clientid = pVarClient->clientid;
+        valid = ( clientid > 0 ) && ( clientid < MAX_VAR_CLIENTS );
+
+        if( ( valid == false ) || ( ClientClosing[clientid] == false ) )
+        {
+            pVarClient->responseVal = 0;
+
+            /* release the writers waiting for this client's validations */
+            VALIDATE_RemoveValidator( pVarClient->client_pid );
+
+            /* allow the client to proceed */
+            UnblockClient( pVarClient );
+        }
+
+        if( ( valid == true ) &&
+            ( __atomic_load_n( &WorkerRequests[clientid],
+                               __ATOMIC_ACQUIRE ) > 0 ) )
+        {
+            /* a worker is still using the client object */
+            if( ClientClosing[clientid] == false )
+            {
+                ClientClosing[clientid] = true;
+                closingCount++;
+            }
+
+            result = EOK;
+        }
+        else
+        {
+            mapsize = sizeof(VarClient);
+            if( valid == true )
+            {
+                if( ClientClosing[clientid] == true )
+                {
+                    ClientClosing[clientid] = false;
+                    closingCount--;
+                }
+
+                /* clear the client entry in the VAR clients table */
+                UnmonitorClient( clientid );
+                VarClients[clientid] = NULL;
+                ClientPriority[clientid] = VARSERVER_PRIORITY_NORMAL;
+                PERMSETS_SetClient( clientid, pVarClient->grouplist, 0 );
+                mapsize = VarClientSizes[clientid];
+                VarClientSizes[clientid] = 0;
+                STATS_MemFree( STATS_MEM_CLIENTS, 1, mapsize );
+            }
+
+            /* unmap the memory */
+            result = munmap( pVarClient, mapsize );
+            if( result != EOK )
+            {
+                result = errno;
+            }
+
+            if( ( result != EOK ) &&
+                ( pVarClient->debug >= LOG_DEBUG ) )
+            {
+                printf("%s failed: (%d) %s\n",
+                       __func__,
+                       result,
+                       strerror(result));
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReleaseClosedClients                                                      */
+/*!
+    Release the closed connections which were held by a worker
+
+    The ReleaseClosedClients function closes the memory map of each
+    client which closed its connection while a read-only worker still
+    held one of its requests, once the worker is finished with it.  It
+    must be called with exclusive access to the variable store, outside
+    of a batch of requests.
+
+==============================================================================*/
+static void ReleaseClosedClients( void )
+{
+    int i;
+
+    for( i = 1; ( i < MAX_VAR_CLIENTS ) && ( closingCount > 0 ); i++ )
+    {
+        if ( ( ClientClosing[i] == true ) &&
+             ( VarClients[i] != NULL ) &&
+             ( __atomic_load_n( &WorkerRequests[i], __ATOMIC_ACQUIRE ) == 0 ) )
+        {
+            ProcessVarRequestClose( VarClients[i] );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  UnblockClient                                                             */
+/*!
+    Unblock the client connection
+
+    Unblocking the client connection allows the client to return from its
+    API call to the server.
+
+    @param[in]
+        pVarClient
+            pointer to the variable client object
+
+    @retval EOK the client was closed successfully
+    @retval EINVAL invalid argument
+
+==============================================================================*/
+static int UnblockClient( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    uint64_t duration;
+    union sigval val;
+    bool asyncCompletion;
+    pid_t pid;
+    int id;
+
+    if( pVarClient != NULL )
+    {
+        if( pVarClient->debug >= LOG_DEBUG )
+        {
+            printf( "SERVER: unblocking client %d pid(%d)\n",
+                    pVarClient->clientid,
+                    pVarClient->client_pid );
+        }
+
+        /* record the service time of the client's request */
+        id = pVarClient->clientid;
+        if ( ( id > 0 ) &&
+             ( id < MAX_VAR_CLIENTS ) &&
+             ( RequestStart[id] != 0 ) )
+        {
+            duration = STATS_Now() - RequestStart[id];
+            STATS_RecordLatency( RequestLatency[RequestType[id]], duration );
+
+            if ( TRACE_ENABLED() )
+            {
+                TRACE_Record( TRACE_EVENT_REQUEST,
+                              RequestType[id],
+                              id,
+                              pVarClient->variableInfo.hVar,
+                              RequestResult[id],
+                              RequestStart[id],
+                              duration );
+            }
+
+            RequestStart[id] = 0;
+        }
+
+        /* once the semaphore is posted the client may close its
+           connection and be unmapped, so the client object must not
+           be accessed after the post */
+        asyncCompletion = pVarClient->asyncCompletion;
+        val.sival_int = pVarClient->channel;
+        pid = pVarClient->client_pid;
+
+        /* unblock the client by posting to the client semaphore */
+        sem_post( &pVarClient->sem );
+
+        if ( asyncCompletion == true )
+        {
+            /* wake the client's asynchronous completion descriptor */
+            sigqueue( pid, SIG_VAR_ASYNC, val );
+        }
+
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  DeferUnblockClient                                                        */
+/*!
+    Unblock a client at the end of the current batch
+
+    The DeferUnblockClient function queues the specified client to be
+    unblocked when the current batch of requests has been processed.
+    If the queue is full the client is unblocked immediately.
+
+    @param[in]
+        pVarClient
+            pointer to the client to be unblocked
+
+    @retval EOK the client was queued or unblocked
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int DeferUnblockClient( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    if( pVarClient != NULL )
+    {
+        if( unblockCount < MAX_VAR_CLIENTS )
+        {
+            UnblockList[unblockCount++] = pVarClient;
+            result = EOK;
+        }
+        else
+        {
+            result = UnblockClient( pVarClient );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  FlushUnblockedClients                                                     */
+/*!
+    Unblock all of the deferred clients
+
+    The FlushUnblockedClients function unblocks all of the clients
+    queued by DeferUnblockClient.
+
+==============================================================================*/
+static void FlushUnblockedClients( void )
+{
+    int i;
+
+    for( i = 0; i < unblockCount; i++ )
+    {
+        UnblockClient( UnblockList[i] );
+        UnblockList[i] = NULL;
+    }
+
+    unblockCount = 0;
+}
+
+/*============================================================================*/
+/*  NewClient                                                                 */
+/*!
+    Registers a new client
+
+    The NewClient function registers a new client with the server using
+    the client's process identifier.  Once a client has been created
+    and registered, it may send requests to the server using the
+    variable server APIs.
+
+    @param[in]
+        pid
+            The new client's process identifier
+
+    @param[in]
+        channel
+            channel index of the client connection, 0 for the primary
+            connection of the process
+
+    @retval EOK the client was created and registered successfully
+    @retval EINVAL the new client could not be created
+
+==============================================================================*/
+static int NewClient( pid_t pid, int channel )
+{
+    int fd;
+    char clientname[BUFSIZ];
+    VarClient *pVarClient;
+    int result = EINVAL;
+    int clientId;
+    struct stat sb;
+    size_t mapsize = sizeof(VarClient);
+
+    /* each shard server has its own client objects */
+    ClientName( clientname, sizeof( clientname ), pid, channel, serverShard );
+
+    /* get shared memory file descriptor (NOT a file) */
+	fd = shm_open( clientname, O_RDWR, S_IRUSR | S_IWUSR);
+	if (fd != -1)
+	{
+        /* map the whole client object, including its working buffer */
+        if ( ( fstat( fd, &sb ) == 0 ) &&
+             ( (size_t)sb.st_size > mapsize ) )
+        {
+            mapsize = (size_t)sb.st_size;
+        }
+
+        /* map shared memory to process address space */
+        pVarClient = (VarClient *)mmap( NULL,
+                                        mapsize,
+                                        PROT_WRITE,
+                                        MAP_SHARED,
+                                        fd,
+                                        0);
+        if (pVarClient != MAP_FAILED)
+        {
+            clientId=GetClientID();
+            if ( clientId != 0 )
+            {
+                VarClients[clientId] = pVarClient;
+                VarClientSizes[clientId] = mapsize;
+                pVarClient->clientid = clientId;
+                STATS_MemAlloc( STATS_MEM_CLIENTS, 1, mapsize );
+
+                /* resolve the client credentials once per connection */
+                PERMSETS_SetClient( clientId,
+                                    pVarClient->grouplist,
+                                    pVarClient->ngroups );
+
+                /* only privileged clients may jump the request queue */
+                if ( ( pVarClient->priority == VARSERVER_PRIORITY_HIGH ) &&
+                     ( PERMSETS_IsPrivileged( clientId ) == true ) )
+                {
+                    ClientPriority[clientId] = VARSERVER_PRIORITY_HIGH;
+                }
+                else
+                {
+                    ClientPriority[clientId] = VARSERVER_PRIORITY_NORMAL;
+                }
+
+                pVarClient->priority = ClientPriority[clientId];
+
+                /* release the client eagerly if its process exits */
+                MonitorClient( clientId, pid );
+            }
+            else
+            {
+                pVarClient->clientid = 0;
+            }
+
+            /* close the file descriptor since we don't need it for anything */
+            close( fd );
+
+            UnblockClient( pVarClient );
+
+            if ( clientId == 0 )
+            {
+                munmap( pVarClient, mapsize );
+            }
+
+            result = EOK;
+        }
+        else
+        {
+            perror("mmap");
+        }
+	}
+    else
+    {
+        perror("shm_open");
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ValidateClient                                                            */
+/*!
+    Validate a client reference
+
+    The ValidateClient function checks that the specified pointer
+    references a valid varclient for this server.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the client is valid
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ValidateClient( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    if( ( pVarClient != NULL ) &&
+        ( pVarClient->id == VARSERVER_ID ) )
+    {
+        if( pVarClient->version == VARSERVER_VERSION )
+        {
+            result = EOK;
+        }
+        else
+        {
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestNew                                                      */
+/*!
+    Process a NEW variable request from a client
+
+    The ProcessVarRequestNew function handles a "NEW variable" request
+    from a client.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the new variable was created
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestNew( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    uint32_t varhandle;
+    int rc;
+    VarInfo *pVarInfo;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* special handling for string variables uses the client's
+           working buffer to pass the variable value */
+        if( pVarClient->variableInfo.var.type == VARTYPE_STR )
+        {
+            pVarClient->variableInfo.var.val.str = &pVarClient->workbuf;
+        }
+
+        /* special handling for blob variables uses the client's
+           working buffer to pass the variable value */
+        if( pVarClient->variableInfo.var.type == VARTYPE_BLOB )
+        {
+            pVarClient->variableInfo.var.val.blob = &pVarClient->workbuf;
+        }
+
+        /* get a pointer to the VariableInfo  */
+        pVarInfo = &pVarClient->variableInfo;
+
+        /* check if the variable already exists */
+        if ( VARLIST_Exists( pVarInfo ) == EOK )
+        {
+            /* indicate that the variable already exists and cannot be added */
+            pVarClient->responseVal = VAR_INVALID;
+        }
+        else
+        {
+            /* add the new variable to the variable list */
+            rc = VARLIST_AddNew( pVarInfo, &varhandle );
+            if( rc == EOK )
+            {
+                /* return the new variable's handle */
+                pVarClient->responseVal = varhandle;
+            }
+            else
+            {
+                pVarClient->responseVal = VAR_INVALID;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestAlias                                                    */
+/*!
+    Process an ALIAS variable request from a client
+
+    The ProcessVarRequestAlias function handles an "ALIAS variable" request
+    from a client to create a new variable alias for an existing variable.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the alias was created
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+    @retval ENOENT the variable was not found
+    @retval ENOMEM no memory for a new variable
+    @retval EEXIST a variable with the requested name already exists
+
+==============================================================================*/
+static int ProcessVarRequestAlias( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    VarInfo *pVarInfo;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        pVarInfo = &pVarClient->variableInfo;
+        result = VARLIST_Alias( pVarInfo, &pVarInfo->hVar );
+        if ( result != EOK )
+        {
+            pVarClient->responseVal = VAR_INVALID;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestGetAliases                                               */
+/*!
+    Process a GET_ALIASES request from a client
+
+    The ProcessVarRequestGetAliases function handles a "Get Aliases" request
+    from a client to retrieve the list of aliases for the specified variable
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the alias list was returned
+    @retval EINVAL the client is invalid
+    @retval E2BIG alias list does not fit in the return buffer
+    @retval ENOENT there are no aliases
+
+==============================================================================*/
+static int ProcessVarRequestGetAliases( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    VarInfo *pVarInfo;
+    size_t len;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        pVarInfo = &pVarClient->variableInfo;
+
+        /* get the maximum number of aliases we can retrieve */
+        len = pVarClient->workbufsize / sizeof( VAR_HANDLE );
+
+        /* retrieve the list of aliases */
+        result = VARLIST_GetAliases( pVarInfo,
+                                     (VAR_HANDLE *)&pVarClient->workbuf,
+                                     len );
+
+        /* return the result */
+        pVarClient->responseVal = result;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestFind                                                     */
+/*!
+    Process a FIND variable request from a client
+
+    The ProcessVarRequestFind function handles a "FIND variable" request
+    from a client.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the new variable was found
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestFind( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* search for the variable in the variable list */
+        result = VARLIST_Find( &pVarClient->variableInfo,
+                               (VAR_HANDLE *)&pVarClient->responseVal );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestEcho                                                     */
+/*!
+    Process an ECHO request from a client
+
+    The ProcessVarRequestEcho function handles a test ECHO request
+    from a client.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the request was successful
+    @retval EINVAL the client is invalid
+
+==============================================================================*/
+static int ProcessVarRequestEcho( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* echo request back to response */
+        pVarClient->responseVal = pVarClient->requestVal;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestInvalid                                                  */
+/*!
+    Handler for invalid requests from a client
+
+    The ProcessVarRequestInvalid function catches any unsupported/invalid
+    request from a client.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval ENOTSUP the request is not supported
+    @retval EINVAL the client is invalid
+
+==============================================================================*/
+static int ProcessVarRequestInvalid( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* tell the client this request is not supported */
+        result = ENOTSUP;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestPrint                                                    */
+/*!
+    Process a PRINT variable request from a client
+
+    The ProcessVarRequestPrint function handles a "PRINT variable" request
+    from a client.  It populates the variable value and the format specifier
+    into the client's VarInfo object
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable info was returned
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestPrint( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    pid_t handler;
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        if ( pVarClient->variableInfo.hVar == hClientInfo )
+        {
+            result = PrintClientInfo( &pVarClient->variableInfo,
+                                      &pVarClient->workbuf,
+                                      pVarClient->workbufsize );
+        }
+        else
+        {
+            result = VARLIST_PrintByHandle( pVarClient->client_pid,
+                                            &pVarClient->variableInfo,
+                                            &pVarClient->workbuf,
+                                            pVarClient->workbufsize,
+                                            pVarClient,
+                                            &handler );
+        }
+
+        /* capture the result */
+        pVarClient->responseVal = result;
+
+        if( result == EINPROGRESS )
+        {
+            /* another client needs to calculate the value before
+               we can print it */
+            /* add the client to the blocked clients list */
+            BlockClient( pVarClient, NOTIFY_CALC );
+        }
+        else if(  result == ESTRPIPE )
+        {
+            /* printing is being handled by another client */
+            /* get the PID of the client handling the printing */
+            pVarClient->peer_pid = handler;
+
+            /* don't unblock the requesting client */
+            result = EINPROGRESS;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestOpenPrintSession                                         */
+/*!
+    Handle a request to open a print session
+
+    The ProcessVarRequestOpenPrintSession function handles a request
+    from a client to open a print session.  It gets the variable handle
+    for the variable being printed, and gets the VarClient object
+    for the client which is requesting the variable to be printed.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable info was returned
+    @retval ENOENT the print session was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestOpenPrintSession( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    VarClient *pRequestor;
+    VAR_HANDLE hVar;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* get the print session transaction */
+        pRequestor = (VarClient *)TRANSACTION_Get( pVarClient->requestVal,
+                                                   &hVar );
+        if( pRequestor != NULL )
+        {
+            /* get the handle for the variable being requested */
+            pVarClient->variableInfo.hVar = hVar;
+
+            /* get the PID of the client requesting the print */
+            pVarClient->peer_pid = pRequestor->client_pid;
+
+            /* get the PID of the client performing the print */
+            pRequestor->peer_pid = pVarClient->client_pid;
+
+            /* pass the print session identifier to the requestor so it
+               can tag the file descriptor it sends to the responder */
+            pRequestor->requestVal = pVarClient->requestVal;
+
+            /* unblock the requesting client */
+            UnblockClient( pRequestor );
+
+            /* indicate success */
+            result = EOK;
+        }
+        else
+        {
+            /* print session transaction was not found */
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestClosePrintSession                                        */
+/*!
+    Handle a request to close a print session
+
+    The ProcessVarRequestClosePrintSession function handles a request
+    from a client to close a print session.
+
+    The client which is requesting the variable to be printed is unblocked
+    by this function.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure of the client closing
+            the print session.
+
+    @retval EOK the print session was closed
+    @retval ENOENT the print session was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestClosePrintSession( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    VarClient *pRequestor;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* get the client object of the requestor of the print */
+        pRequestor = (VarClient *)TRANSACTION_Remove( pVarClient->requestVal );
+        if( pRequestor != NULL )
+        {
+            /* unblock the requesting client */
+            UnblockClient( pRequestor );
+
+            result = EOK;
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestSet                                                      */
+/*!
+    Process a SET variable request from a client
+
+    The ProcessVarRequestSet function handles a "SET variable" request
+    from a client.  It populates the variable value into the varstorage
+    for the variable
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable value was set
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestSet( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* check if we are dealing with a string */
+        if( pVarClient->variableInfo.var.type == VARTYPE_STR )
+        {
+            /* for strings, the data is transferred via the working buffer */
+            pVarClient->variableInfo.var.val.str = &pVarClient->workbuf;
+        }
+
+        /* check if we are dealing with a blob */
+        if( pVarClient->variableInfo.var.type == VARTYPE_BLOB )
+        {
+            /* for strings, the data is transferred via the working buffer */
+            pVarClient->variableInfo.var.val.blob = &pVarClient->workbuf;
+        }
+
+        /* set the variable value */
+        result = VARLIST_Set( pVarClient->client_pid,
+                              &pVarClient->variableInfo,
+                              &pVarClient->validationInProgress,
+                              (void *)pVarClient );
+
+        pVarClient->responseVal = result;
+    }
+
+    if( ( result != EOK ) &&
+        ( pVarClient->debug >= LOG_DEBUG ) )
+    {
+        printf( "SERVER: %s result = %s\n", __func__, strerror( result ) );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestModify                                                   */
+/*!
+    Process a MODIFY variable request from a client
+
+    The ProcessVarRequestModify function handles an atomic read-modify-write
+    request from a client.  The VarModify object at the start of the
+    client's working buffer holds the operands, and requestVal holds the
+    VarModifyOp to perform.  The previous value of the variable is
+    returned in the client's variableInfo, with string values in the
+    working buffer, as for a GET request.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable was modified
+    @retval EAGAIN the variable did not hold the expected value
+    @retval E2BIG the operands or old value do not fit in the working buffer
+    @retval EINVAL the client is invalid
+    @retval other error from VARLIST_Modify
+
+==============================================================================*/
+static int ProcessVarRequestModify( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    VarModify modify;
+    VarObject *pObj;
+    uint32_t offset;
+    size_t n;
+    int i;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK )
+    {
+        if( pVarClient->workbufsize < sizeof( VarModify ) )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            /* the working buffer is re-used to return the old value */
+            memcpy( &modify, &pVarClient->workbuf, sizeof( VarModify ) );
+
+            for( i = 0; ( i < 2 ) && ( result == EOK ); i++ )
+            {
+                pObj = ( i == 0 ) ? &modify.operand : &modify.expected;
+                offset = ( i == 0 ) ? modify.operandOffset
+                                    : modify.expectedOffset;
+                if( pObj->type == VARTYPE_STR )
+                {
+                    /* string operands are in the working buffer */
+                    n = pVarClient->workbufsize;
+                    if( ( offset < n ) &&
+                        ( memchr( &pVarClient->workbuf + offset,
+                                  0,
+                                  n - offset ) != NULL ) )
+                    {
+                        pObj->val.str = &pVarClient->workbuf + offset;
+                    }
+                    else
+                    {
+                        result = E2BIG;
+                    }
+                }
+            }
+        }
+
+        if( result == EOK )
+        {
+            result = VARLIST_Modify( pVarClient->client_pid,
+                                     &pVarClient->variableInfo,
+                                     pVarClient->requestVal,
+                                     &modify.operand,
+                                     &modify.expected,
+                                     &pVarClient->workbuf,
+                                     pVarClient->workbufsize );
+        }
+
+        /* an E2BIG result lets the client grow its working buffer
+           to the returned variable length and try again */
+        pVarClient->responseVal = result;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestGetHistory                                               */
+/*!
+    Process a GET_HISTORY request from a client
+
+    The ProcessVarRequestGetHistory function handles a request for
+    samples from the history ring of a variable.  The client's working
+    buffer holds a VarHistoryQuery object, and is re-used to return a
+    VarHistory object followed by up to requestVal of the selected
+    samples.  The result is returned in the response value.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the request was processed
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestGetHistory( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    VarHistoryQuery query;
+    size_t len;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK )
+    {
+        /* only return as many samples as the client asked for */
+        len = sizeof( VarHistory ) +
+              (size_t)( pVarClient->requestVal > 0
+                            ? pVarClient->requestVal
+                            : 0 ) * sizeof( VarHistorySample );
+        if( len > pVarClient->workbufsize )
+        {
+            len = pVarClient->workbufsize;
+        }
+
+        if( pVarClient->workbufsize < sizeof( VarHistoryQuery ) )
+        {
+            pVarClient->responseVal = E2BIG;
+        }
+        else
+        {
+            /* the working buffer is re-used to return the samples */
+            memcpy( &query, &pVarClient->workbuf, sizeof( VarHistoryQuery ) );
+
+            pVarClient->responseVal =
+                VARLIST_GetHistory( &pVarClient->variableInfo,
+                                    &query,
+                                    &pVarClient->workbuf,
+                                    len );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestUpdateUser                                               */
+/*!
+    Process an UPDATE_USER request from a client
+
+    The ProcessVarRequestUpdateUser function handles a notification
+    that the client has changed its effective user.  The client's group
+    list is resolved again and used for all of its subsequent requests.
+    The result is returned in the response value.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the request was processed
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestUpdateUser( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK )
+    {
+        pVarClient->responseVal =
+            PERMSETS_SetClient( pVarClient->clientid,
+                                pVarClient->grouplist,
+                                pVarClient->ngroups );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestGetLargest                                               */
+/*!
+    Process a GET_LARGEST request from a client
+
+    The ProcessVarRequestGetLargest function handles a request for the
+    requestVal variables which use the most server memory.  They are
+    returned in the client's working buffer as an array of VarMemUsage
+    objects, and their number is returned in the response value, or
+    a negative error code on failure.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the request was processed
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestGetLargest( VarClient *pVarClient )
+{
+    int result = EINVAL;
+    size_t n;
+    size_t count = 0;
+    int rc;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK )
+    {
+        n = ( pVarClient->requestVal > 0 )
+                ? (size_t)pVarClient->requestVal
+                : 0;
+        if( n > pVarClient->workbufsize / sizeof( VarMemUsage ) )
+        {
+            n = pVarClient->workbufsize / sizeof( VarMemUsage );
+        }
+
+        rc = VARLIST_GetLargest( &pVarClient->variableInfo,
+                                 (VarMemUsage *)&pVarClient->workbuf,
+                                 n,
+                                 &count );
+
+        pVarClient->responseVal = ( rc == EOK ) ? (int)count : -rc;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestType                                                     */
+/*!
+    Process a TYPE variable request from a client
+
+    The ProcessVarRequestType function handles a "variable TYPE" request
+    from a client.  It requests the variable type for the specified
+    variable
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable type was retrieved
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestType( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* fet the variable type */
+        result = VARLIST_GetType( &pVarClient->variableInfo );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestName                                                     */
+/*!
+    Process a NAME variable request from a client
+
+    The ProcessVarRequestName function handles a "variable NAME" request
+    from a client.  It requests the variable name for the specified
+    variable
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable type was retrieved
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestName( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* fetch the variable name */
+        result = VARLIST_GetName( &pVarClient->variableInfo );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestLength                                                   */
+/*!
+    Process a LENGTH variable request from a client
+
+    The ProcessVarRequestLength function handles a "variable LENGTH" request
+    from a client.  It requests the variable length for the specified
+    variable.  This is mostly useful for variable length data types such
+    as strings.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable length was retrieved
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestLength( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* get the variable length */
+        result = VARLIST_GetLength( &(pVarClient->variableInfo) );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestFlags                                                    */
+/*!
+    Process a FLAGS variable request from a client
+
+    The ProcessVarRequestFlags function handles a "variable FLAGS" request
+    from a client.  It requests the variable flags for the specified
+    variable.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable flags were retrieved
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestFlags( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* get the variable length */
+        result = VARLIST_GetFlags( &(pVarClient->variableInfo) );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestInfo                                                     */
+/*!
+    Process an INFO variable request from a client
+
+    The ProcessVarRequestInfo function handles a "variable INFO" request
+    from a client.  It requests the variable information for the specified
+    variable.
+
+    Variable information includes
+
+    - name
+    - permissions
+    - format specifier
+    - flags
+    - tags
+    - instanceID
+    - guid
+
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable info was retrieved
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestInfo( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        /* get the variable length */
+        result = VARLIST_GetInfo( &(pVarClient->variableInfo) );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestNotify                                                   */
+/*!
+    Process a NOTIFY variable request from a client
+
+    The ProcessVarRequestNotify function handles a variable notification
+    requests from a client.  It registers a request for a notification
+    of type:
+        NOTIFY_MODIFIED_QUEUE
+            - request a notification when the notification queue changes
+        NOTIFY_MODIFIED_RING
+            - request a variable's changes be published on the shared
+              change ring
+        NOTIFY_MODIFIED
+            - request a notification when a variable's value changes
+        NOTIFY_CALC
+            - request a notification when a variable's value is requested
+              by another client
+        NOTIFY_VALIDATE
+            - request a notification when a variable is being changed
+              by another client, before the change is applied.
+        NOTIFY_PRINT
+            - request a notification when a client tries to print
+              the variable with the given handle
+
+    @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the client is valid
+    @retval EOK the variable notification was successfully registered
+    @retval ENOENT the variable was not found
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ValidateClient( VarClient *pVarClient )
+static int ProcessVarRequestNotify( VarClient *pVarClient )
 {
     int result = EINVAL;
+    VarNotifyOptions *pOptions;
 
-    if( ( pVarClient != NULL ) &&
-        ( pVarClient->id == VARSERVER_ID ) )
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
     {
-        if( pVarClient->version == VARSERVER_VERSION )
-        {
-            result = EOK;
-        }
-        else
-        {
-            result = ENOTSUP;
-        }
+        /* the subscription options are passed in the working buffer */
+        pOptions = ( pVarClient->requestVal == sizeof( VarNotifyOptions ) )
+                   ? (VarNotifyOptions *)&pVarClient->workbuf
+                   : NULL;
+
+        /* register the notification request */
+        result = VARLIST_RequestNotify( &(pVarClient->variableInfo),
+                                        pVarClient->client_pid,
+                                        pOptions );
+
+        /* report the registration result to the client */
+        pVarClient->responseVal = result;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestNew                                                      */
+/*  ProcessVarRequestNotifyCancel                                             */
 /*!
-    Process a NEW variable request from a client
+    Process a NOTIFY_CANCEL variable request from a client
 
-    The ProcessVarRequestNew function handles a "NEW variable" request
-    from a client.
+    The ProcessVarRequestNotifyCancel function handles a variable notification
+    cancellation request from a client.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the new variable was created
-    @retval ENOMEM memory allocation failure
+    @retval EOK the variable notification was successfully cancelled
+    @retval ENOENT the variable or notification was not found
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestNew( VarClient *pVarClient )
+static int ProcessVarRequestNotifyCancel( VarClient *pVarClient )
 {
     int result = EINVAL;
-    uint32_t varhandle;
-    int rc;
-    VarInfo *pVarInfo;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
     if( result == EOK)
     {
-        /* special handling for string variables uses the client's
-           working buffer to pass the variable value */
-        if( pVarClient->variableInfo.var.type == VARTYPE_STR )
-        {
-            pVarClient->variableInfo.var.val.str = &pVarClient->workbuf;
-        }
+        /* cancel the notification request */
+        result = VARLIST_NotifyCancel( &(pVarClient->variableInfo),
+                                       pVarClient->client_pid );
+    }
 
-        /* special handling for blob variables uses the client's
-           working buffer to pass the variable value */
-        if( pVarClient->variableInfo.var.type == VARTYPE_BLOB )
-        {
-            pVarClient->variableInfo.var.val.blob = &pVarClient->workbuf;
-        }
+    return result;
+}
 
-        /* get a pointer to the VariableInfo  */
-        pVarInfo = &pVarClient->variableInfo;
+/*============================================================================*/
+/*  ProcessVarRequestGet                                                      */
+/*!
+    Process a GET variable request from a client
 
-        /* check if the variable already exists */
-        if ( VARLIST_Exists( pVarInfo ) == EOK )
+    The ProcessVarRequestGet function handles a "GET variable" request
+    from a client.  It populates the variable type, value and length
+    into the client's VarInfo object.  If the variable is a string,
+    the string is transferred into the client'sworking buffer.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable info was returned
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestGet( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        result = VARLIST_GetByHandle( pVarClient->client_pid,
+                                      &pVarClient->variableInfo,
+                                      &pVarClient->workbuf,
+                                      pVarClient->workbufsize );
+        if( result == EINPROGRESS )
         {
-            /* indicate that the variable already exists and cannot be added */
-            pVarClient->responseVal = VAR_INVALID;
+            /* add the client to the blocked clients list */
+            BlockClient( pVarClient, NOTIFY_CALC );
         }
-        else
+
+        /* an E2BIG result lets the client grow its working buffer
+           to the returned variable length and try again */
+        pVarClient->responseVal = result;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestGetFirst                                                 */
+/*!
+    Process a GET_FIRST variable request from a client
+
+    The ProcessVarRequestGetFirst function handles a "GET_FIRST variable"
+    request from a client.  It initiates a search for variables which
+    match the specified search criteria.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable info was returned
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestGetFirst( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        result = VARLIST_GetFirst( pVarClient->client_pid,
+                                   pVarClient->requestVal,
+                                   &pVarClient->variableInfo,
+                                   &pVarClient->workbuf,
+                                   pVarClient->workbufsize,
+                                   &pVarClient->responseVal);
+        if( result == EINPROGRESS )
         {
-            /* add the new variable to the variable list */
-            rc = VARLIST_AddNew( pVarInfo, &varhandle );
-            if( rc == EOK )
-            {
-                /* return the new variable's handle */
-                pVarClient->responseVal = varhandle;
-            }
-            else
-            {
-                pVarClient->responseVal = VAR_INVALID;
-            }
+            /* add the client to the blocked clients list */
+            BlockClient( pVarClient, NOTIFY_CALC );
         }
     }
 
@@ -984,39 +4420,42 @@ static int ProcessVarRequestNew( VarClient *pVarClient )
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestAlias                                                    */
+/*  ProcessVarRequestGetNext                                                  */
 /*!
-    Process an ALIAS variable request from a client
+    Process a GET_NEXT variable request from a client
 
-    The ProcessVarRequestAlias function handles an "ALIAS variable" request
-    from a client to create a new variable alias for an existing variable.
+    The ProcessVarRequestGetNext function handles a "GET_NEXT variable"
+    request from a client.  It continues a search for variables which
+    match the specified search criteria.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the alias was created
+    @retval EOK the variable info was returned
+    @retval ENOENT the variable was not found
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
-    @retval ENOENT the variable was not found
-    @retval ENOMEM no memory for a new variable
-    @retval EEXIST a variable with the requested name already exists
 
 ==============================================================================*/
-static int ProcessVarRequestAlias( VarClient *pVarClient )
+static int ProcessVarRequestGetNext( VarClient *pVarClient )
 {
     int result = EINVAL;
-    VarInfo *pVarInfo;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
     if( result == EOK)
     {
-        pVarInfo = &pVarClient->variableInfo;
-        result = VARLIST_Alias( pVarInfo, &pVarInfo->hVar );
-        if ( result != EOK )
+        result = VARLIST_GetNext( pVarClient->client_pid,
+                                  pVarClient->requestVal,
+                                  &pVarClient->variableInfo,
+                                  &pVarClient->workbuf,
+                                  pVarClient->workbufsize,
+                                  &pVarClient->responseVal );
+        if( result == EINPROGRESS )
         {
-            pVarClient->responseVal = VAR_INVALID;
+            /* add the client to the blocked clients list */
+            BlockClient( pVarClient, NOTIFY_CALC );
         }
     }
 
@@ -1024,69 +4463,95 @@ static int ProcessVarRequestAlias( VarClient *pVarClient )
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestGetAliases                                               */
+/*  ProcessVarRequestSetFlags                                                 */
 /*!
-    Process a GET_ALIASES request from a client
+    Process a SET_FLAGS variable request from a client
 
-    The ProcessVarRequestGetAliases function handles a "Get Aliases" request
-    from a client to retrieve the list of aliases for the specified variable
+    The ProcessVarRequestSetFlags function handles a "variable SET_FLAGS"
+    request from a client.  It sets all of the flags specified in the
+    pVarClient->variableInfo object for the variable specified in the
+    pVarClient->variableInfo object.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the alias list was returned
+    @retval EOK the variable flags were set
+    @retval ENOENT the variable was not found
     @retval EINVAL the client is invalid
-    @retval E2BIG alias list does not fit in the return buffer
-    @retval ENOENT there are no aliases
+    @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestGetAliases( VarClient *pVarClient )
+static int ProcessVarRequestSetFlags( VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    /* validate the client object */
+    result = ValidateClient( pVarClient );
+    if( result == EOK)
+    {
+        result = VARLIST_SetFlags( &pVarClient->variableInfo );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessVarRequestClearFlags                                               */
+/*!
+    Process a CLEAR_FLAGS variable request from a client
+
+    The ProcessVarRequestClearFlags function handles a "variable CLEAR_FLAGS"
+    request from a client.  It clears all of the flags specified in the
+    pVarClient->variableInfo object for the variable specified in the
+    pVarClient->variableInfo object.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+    @retval EOK the variable flags were cleared
+    @retval ENOENT the variable was not found
+    @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
+
+==============================================================================*/
+static int ProcessVarRequestClearFlags( VarClient *pVarClient )
 {
     int result = EINVAL;
-    VarInfo *pVarInfo;
-    size_t len;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
     if( result == EOK)
     {
-        pVarInfo = &pVarClient->variableInfo;
-
-        /* get the maximum number of aliases we can retrieve */
-        len = pVarClient->workbufsize / sizeof( VAR_HANDLE );
-
-        /* retrieve the list of aliases */
-        result = VARLIST_GetAliases( pVarInfo,
-                                     (VAR_HANDLE *)&pVarClient->workbuf,
-                                     len );
-
-        /* return the result */
-        pVarClient->responseVal = result;
+        result = VARLIST_ClearFlags( &pVarClient->variableInfo );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestFind                                                     */
+/*  ProcessVarRequestShareValue                                               */
 /*!
-    Process a FIND variable request from a client
+    Process a SHARE_VALUE variable request from a client
 
-    The ProcessVarRequestFind function handles a "FIND variable" request
-    from a client.
+    The ProcessVarRequestShareValue function handles a "variable SHARE_VALUE"
+    request from a client.  It publishes the value of the variable specified
+    in the pVarClient->variableInfo object in the shared value segment
+    so the client can read it without a server round trip.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the new variable was found
+    @retval EOK the variable value was shared
     @retval ENOENT the variable was not found
+    @retval EACCES the variable has a read permission list
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestFind( VarClient *pVarClient )
+static int ProcessVarRequestShareValue( VarClient *pVarClient )
 {
     int result = EINVAL;
 
@@ -1094,31 +4559,33 @@ static int ProcessVarRequestFind( VarClient *pVarClient )
     result = ValidateClient( pVarClient );
     if( result == EOK)
     {
-        /* search for the variable in the variable list */
-        result = VARLIST_Find( &pVarClient->variableInfo,
-                               (VAR_HANDLE *)&pVarClient->responseVal );
+        pVarClient->responseVal =
+                VARLIST_ShareValue( &pVarClient->variableInfo );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestEcho                                                     */
+/*  ProcessVarRequestShareBlob                                                */
 /*!
-    Process an ECHO request from a client
+    Process a SHARE_BLOB variable request from a client
 
-    The ProcessVarRequestEcho function handles a test ECHO request
-    from a client.
+    The ProcessVarRequestShareBlob function handles a "variable SHARE_BLOB"
+    request from a client.  It moves the value of the blob variable
+    specified in the pVarClient->variableInfo object into a zero-copy
+    blob segment which the client can map.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the request was successful
+    @retval EOK the request was processed
     @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestEcho( VarClient *pVarClient )
+static int ProcessVarRequestShareBlob( VarClient *pVarClient )
 {
     int result = EINVAL;
 
@@ -1126,30 +4593,34 @@ static int ProcessVarRequestEcho( VarClient *pVarClient )
     result = ValidateClient( pVarClient );
     if( result == EOK)
     {
-        /* echo request back to response */
-        pVarClient->responseVal = pVarClient->requestVal;
+        pVarClient->responseVal =
+                VARLIST_ShareBlob( &pVarClient->variableInfo );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestInvalid                                                  */
+/*  ProcessVarRequestCommitBlob                                               */
 /*!
-    Handler for invalid requests from a client
+    Process a COMMIT_BLOB variable request from a client
 
-    The ProcessVarRequestInvalid function catches any unsupported/invalid
-    request from a client.
+    The ProcessVarRequestCommitBlob function handles a "variable
+    COMMIT_BLOB" request from a client.  It publishes the blob value
+    which the client has written in place into the zero-copy blob
+    segment of the variable specified in the pVarClient->variableInfo
+    object.  No blob data is transferred with the request.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval ENOTSUP the request is not supported
+    @retval EOK the request was processed
     @retval EINVAL the client is invalid
+    @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestInvalid( VarClient *pVarClient )
+static int ProcessVarRequestCommitBlob( VarClient *pVarClient )
 {
     int result = EINVAL;
 
@@ -1157,134 +4628,211 @@ static int ProcessVarRequestInvalid( VarClient *pVarClient )
     result = ValidateClient( pVarClient );
     if( result == EOK)
     {
-        /* tell the client this request is not supported */
-        result = ENOTSUP;
+        pVarClient->responseVal =
+                VARLIST_CommitBlob( pVarClient->client_pid,
+                                    &pVarClient->variableInfo );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestPrint                                                    */
+/*  ProcessVarRequestResizeWorkbuf                                            */
 /*!
-    Process a PRINT variable request from a client
+    Process a RESIZE_WORKBUF request from a client
 
-    The ProcessVarRequestPrint function handles a "PRINT variable" request
-    from a client.  It populates the variable value and the format specifier
-    into the client's VarInfo object
+    The ProcessVarRequestResizeWorkbuf function handles a "RESIZE_WORKBUF"
+    request from a client which has extended its shared memory object
+    to grow its working buffer to pVarClient->requestVal bytes.  The
+    server maps the whole object again, releases the old mapping,
+    and updates the clients table to refer to the new mapping.
+
+    The VarClient object moves in the server's address space, so the
+    caller must fetch it again from the clients table once the request
+    has been processed.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable info was returned
-    @retval ENOENT the variable was not found
+    @retval EOK the request was processed
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestPrint( VarClient *pVarClient )
+static int ProcessVarRequestResizeWorkbuf( VarClient *pVarClient )
 {
     int result = EINVAL;
-    pid_t handler;
+    char clientname[BUFSIZ];
+    VarClient *pNewVarClient;
+    int clientid;
+    size_t workbufsize;
+    size_t mapsize;
+    struct stat sb;
+    int rc = EINVAL;
+    int fd;
+
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        if ( pVarClient->variableInfo.hVar == hClientInfo )
-        {
-            result = PrintClientInfo( &pVarClient->variableInfo,
-                                      &pVarClient->workbuf,
-                                      pVarClient->workbufsize );
-        }
-        else
-        {
-            result = VARLIST_PrintByHandle( pVarClient->client_pid,
-                                            &pVarClient->variableInfo,
-                                            &pVarClient->workbuf,
-                                            pVarClient->workbufsize,
-                                            pVarClient,
-                                            &handler );
-        }
-
-        /* capture the result */
-        pVarClient->responseVal = result;
+        clientid = pVarClient->clientid;
+        workbufsize = ( pVarClient->requestVal > 0 )
+                        ? (size_t)pVarClient->requestVal
+                        : 0;
+        mapsize = sizeof(VarClient) + workbufsize - 1;
 
-        if( result == EINPROGRESS )
+        if( workbufsize <= pVarClient->workbufsize )
         {
-            /* another client needs to calculate the value before
-               we can print it */
-            /* add the client to the blocked clients list */
-            BlockClient( pVarClient, NOTIFY_CALC );
+            /* the working buffer is already large enough */
+            rc = EOK;
         }
-        else if(  result == ESTRPIPE )
+        else if( ( clientid > 0 ) &&
+                 ( clientid < MAX_VAR_CLIENTS ) &&
+                 ( VarClients[clientid] == pVarClient ) )
         {
-            /* printing is being handled by another client */
-            /* get the PID of the client handling the printing */
-            pVarClient->peer_pid = handler;
+            ClientName( clientname,
+                        sizeof( clientname ),
+                        pVarClient->client_pid,
+                        pVarClient->channel,
+                        serverShard );
+
+            fd = shm_open( clientname, O_RDWR, S_IRUSR | S_IWUSR );
+            if( fd != -1 )
+            {
+                /* the client must have extended the object first */
+                if( ( fstat( fd, &sb ) == 0 ) &&
+                    ( (size_t)sb.st_size >= mapsize ) )
+                {
+                    pNewVarClient = (VarClient *)mmap( NULL,
+                                                       mapsize,
+                                                       PROT_WRITE,
+                                                       MAP_SHARED,
+                                                       fd,
+                                                       0 );
+                    if( pNewVarClient != MAP_FAILED )
+                    {
+                        munmap( pVarClient, VarClientSizes[clientid] );
+                        STATS_MemAlloc( STATS_MEM_CLIENTS,
+                                        0,
+                                        mapsize - VarClientSizes[clientid] );
+
+                        VarClients[clientid] = pNewVarClient;
+                        VarClientSizes[clientid] = mapsize;
+                        pVarClient = pNewVarClient;
+                        pVarClient->workbufsize = workbufsize;
+                        rc = EOK;
+                    }
+                    else
+                    {
+                        rc = ENOMEM;
+                    }
+                }
 
-            /* don't unblock the requesting client */
-            result = EINPROGRESS;
+                close( fd );
+            }
+            else
+            {
+                rc = errno;
+            }
         }
+
+        pVarClient->responseVal = rc;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestOpenPrintSession                                         */
+/*  ProcessVarRequestGetMany                                                  */
 /*!
-    Handle a request to open a print session
+    Process a GET_MANY variable request from a client
 
-    The ProcessVarRequestOpenPrintSession function handles a request
-    from a client to open a print session.  It gets the variable handle
-    for the variable being printed, and gets the VarClient object
-    for the client which is requesting the variable to be printed.
+    The ProcessVarRequestGetMany function handles a batched "GET variable"
+    request from a client.  The client's working buffer contains an array
+    of requestVal VarBatchItem objects.  Each item is retrieved using
+    VARLIST_GetByHandle, and its value and result are written back into
+    the item.  String and blob data is packed into the working buffer
+    following the item array.
+
+    Variables with a CALC handler cannot be retrieved in a batch, and
+    are returned with an EWOULDBLOCK result.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable info was returned
-    @retval ENOENT the print session was not found
+    @retval EOK the batch was processed
+    @retval E2BIG the item array does not fit in the working buffer
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestOpenPrintSession( VarClient *pVarClient )
+static int ProcessVarRequestGetMany( VarClient *pVarClient )
 {
     int result = EINVAL;
-    VarClient *pRequestor;
-    VAR_HANDLE hVar;
+    VarBatchItem *pItems;
+    VarBatchItem *pItem;
+    VarInfo *pVarInfo;
+    char *pData;
+    size_t count;
+    size_t offset;
+    size_t i;
+    size_t n;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        /* get the print session transaction */
-        pRequestor = (VarClient *)TRANSACTION_Get( pVarClient->requestVal,
-                                                   &hVar );
-        if( pRequestor != NULL )
+        pVarInfo = &pVarClient->variableInfo;
+        pItems = (VarBatchItem *)&pVarClient->workbuf;
+        count = ( pVarClient->requestVal > 0 ) ? pVarClient->requestVal : 0;
+        offset = count * sizeof( VarBatchItem );
+        pVarClient->responseVal = 0;
+
+        if( offset > pVarClient->workbufsize )
         {
-            /* get the handle for the variable being requested */
-            pVarClient->variableInfo.hVar = hVar;
+            result = E2BIG;
+        }
+        else
+        {
+            VARLIST_BeginBatch();
 
-            /* get the PID of the client requesting the print */
-            pVarClient->peer_pid = pRequestor->client_pid;
+            for( i = 0; i < count; i++ )
+            {
+                pItem = &pItems[i];
+                pData = &pVarClient->workbuf + offset;
 
-            /* get the PID of the client performing the print */
-            pRequestor->peer_pid = pVarClient->client_pid;
+                pVarInfo->hVar = pItem->hVar;
+                pItem->result = VARLIST_GetByHandle(
+                                            pVarClient->client_pid,
+                                            pVarInfo,
+                                            pData,
+                                            pVarClient->workbufsize - offset );
 
-            /* unblock the requesting client */
-            UnblockClient( pRequestor );
+                pItem->var = pVarInfo->var;
+                pItem->offset = offset;
 
-            /* indicate success */
-            result = EOK;
-        }
-        else
-        {
-            /* print session transaction was not found */
-            result = ENOENT;
+                if( pItem->result == EOK )
+                {
+                    /* advance past the string or blob data */
+                    n = 0;
+                    if( pVarInfo->var.type == VARTYPE_STR )
+                    {
+                        n = strlen( pData ) + 1;
+                    }
+                    else if( pVarInfo->var.type == VARTYPE_BLOB )
+                    {
+                        n = pVarInfo->var.len;
+                    }
+
+                    offset += n;
+                }
+            }
+
+            VARLIST_EndBatch();
+
+            pVarClient->responseVal = count;
         }
     }
 
@@ -1292,48 +4840,112 @@ static int ProcessVarRequestOpenPrintSession( VarClient *pVarClient )
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestClosePrintSession                                        */
+/*  ProcessVarRequestSetMany                                                  */
 /*!
-    Handle a request to close a print session
+    Process a SET_MANY variable request from a client
 
-    The ProcessVarRequestClosePrintSession function handles a request
-    from a client to close a print session.
+    The ProcessVarRequestSetMany function handles a batched "SET variable"
+    request from a client.  The client's working buffer contains an array
+    of requestVal VarBatchItem objects, followed by the data for any
+    string or blob values.  Each item is set using VARLIST_Set and its
+    result is written back into the item.  Change notifications are
+    sent once the whole batch has been applied.
 
-    The client which is requesting the variable to be printed is unblocked
-    by this function.
+    Variables with a VALIDATE handler cannot be set in a batch, and
+    are returned with an EWOULDBLOCK result.
 
     @param[in]
         pVarClient
-            Pointer to the client data structure of the client closing
-            the print session.
+            Pointer to the client data structure
 
-    @retval EOK the print session was closed
-    @retval ENOENT the print session was not found
+    @retval EOK the batch was processed
+    @retval E2BIG the item array does not fit in the working buffer
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestClosePrintSession( VarClient *pVarClient )
+static int ProcessVarRequestSetMany( VarClient *pVarClient )
 {
     int result = EINVAL;
-    VarClient *pRequestor;
+    VarBatchItem *pItems;
+    VarBatchItem *pItem;
+    VarInfo *pVarInfo;
+    bool validationInProgress;
+    size_t count;
+    size_t i;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        /* get the client object of the requestor of the print */
-        pRequestor = (VarClient *)TRANSACTION_Remove( pVarClient->requestVal );
-        if( pRequestor != NULL )
-        {
-            /* unblock the requesting client */
-            UnblockClient( pRequestor );
+        pVarInfo = &pVarClient->variableInfo;
+        pItems = (VarBatchItem *)&pVarClient->workbuf;
+        count = ( pVarClient->requestVal > 0 ) ? pVarClient->requestVal : 0;
+        pVarClient->responseVal = 0;
 
-            result = EOK;
+        if( count * sizeof( VarBatchItem ) > pVarClient->workbufsize )
+        {
+            result = E2BIG;
         }
         else
         {
-            result = ENOENT;
+            VARLIST_BeginBatch();
+
+            for( i = 0; i < count; i++ )
+            {
+                pItem = &pItems[i];
+
+                pVarInfo->hVar = pItem->hVar;
+                pVarInfo->var = pItem->var;
+                pItem->result = EOK;
+
+                if( ( pItem->var.type == VARTYPE_STR ) ||
+                    ( pItem->var.type == VARTYPE_BLOB ) )
+                {
+                    /* string and blob data is in the working buffer */
+                    if( ( pItem->offset < pVarClient->workbufsize ) &&
+                        ( pItem->var.len <=
+                            pVarClient->workbufsize - pItem->offset ) )
+                    {
+                        pVarInfo->var.val.blob =
+                                &pVarClient->workbuf + pItem->offset;
+                    }
+                    else
+                    {
+                        pItem->result = E2BIG;
+                    }
+                }
+
+                if( pItem->result == EOK )
+                {
+                    /* record the item a batched validation belongs to */
+                    VALIDATE_SetBatchItem( (int)i );
+
+                    validationInProgress = false;
+                    pItem->result = VARLIST_Set( pVarClient->client_pid,
+                                                 pVarInfo,
+                                                 &validationInProgress,
+                                                 (void *)pVarClient );
+                    if( pItem->result == EINPROGRESS )
+                    {
+                        /* the item is waiting for a batched validator */
+                        pVarClient->pendingValidations++;
+                    }
+                }
+            }
+
+            VALIDATE_SetBatchItem( -1 );
+
+            VARLIST_EndBatch();
+
+            pVarClient->responseVal = count;
+
+            if( pVarClient->pendingValidations > 0 )
+            {
+                /* the client is released once the validations
+                   are complete */
+                result = EINPROGRESS;
+            }
         }
     }
 
@@ -1341,364 +4953,671 @@ static int ProcessVarRequestClosePrintSession( VarClient *pVarClient )
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestSet                                                      */
+/*  ProcessVarRequestSetGroup                                                 */
 /*!
-    Process a SET variable request from a client
+    Process a SET_GROUP variable request from a client
 
-    The ProcessVarRequestSet function handles a "SET variable" request
-    from a client.  It populates the variable value into the varstorage
-    for the variable
+    The ProcessVarRequestSetGroup function handles an atomic group "SET
+    variable" request from a client.  The client's working buffer has
+    the same layout as for a SET_MANY request.  Every item is checked,
+    and any changes which need validation are sent to their validators,
+    before any of the values are applied.  If any item is rejected, no
+    values are applied and the remaining items are returned with an
+    ECANCELED result.  Otherwise all of the values are applied together
+    and each subscriber is sent a single change notification.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable value was set
-    @retval ENOENT the variable was not found
+    @retval EOK the group was processed
+    @retval EINPROGRESS the group is waiting for its validators
+    @retval E2BIG the item array does not fit in the working buffer
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestSet( VarClient *pVarClient )
+static int ProcessVarRequestSetGroup( VarClient *pVarClient )
 {
     int result = EINVAL;
+    VarBatchItem *pItems;
+    VarInfo *pVarInfo;
+    bool validate[VARSERVER_MAX_BATCH_ITEMS];
+    bool failed = false;
+    size_t count;
+    size_t i;
+    int rc;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        /* check if we are dealing with a string */
-        if( pVarClient->variableInfo.var.type == VARTYPE_STR )
+        pVarInfo = &pVarClient->variableInfo;
+        pItems = (VarBatchItem *)&pVarClient->workbuf;
+        count = ( pVarClient->requestVal > 0 ) ? pVarClient->requestVal : 0;
+        pVarClient->responseVal = 0;
+
+        if( ( count > VARSERVER_MAX_BATCH_ITEMS ) ||
+            ( count * sizeof( VarBatchItem ) > pVarClient->workbufsize ) )
         {
-            /* for strings, the data is transferred via the working buffer */
-            pVarClient->variableInfo.var.val.str = &pVarClient->workbuf;
+            result = E2BIG;
         }
-
-        /* check if we are dealing with a blob */
-        if( pVarClient->variableInfo.var.type == VARTYPE_BLOB )
+        else
         {
-            /* for strings, the data is transferred via the working buffer */
-            pVarClient->variableInfo.var.val.blob = &pVarClient->workbuf;
+            /* check every item before anything is changed */
+            for( i = 0; i < count; i++ )
+            {
+                validate[i] = false;
+                pItems[i].result = GetBatchItem( pVarClient,
+                                                 i,
+                                                 pVarInfo );
+                if( pItems[i].result == EOK )
+                {
+                    pItems[i].result = VARLIST_CheckSet(
+                                                pVarClient->client_pid,
+                                                pVarInfo,
+                                                &validate[i] );
+                }
+
+                if( pItems[i].result != EOK )
+                {
+                    failed = true;
+                }
+            }
+
+            /* ask the validators to approve the changes */
+            for( i = 0; ( i < count ) && ( failed == false ); i++ )
+            {
+                if( validate[i] == true )
+                {
+                    GetBatchItem( pVarClient, i, pVarInfo );
+
+                    /* record the item the validation belongs to */
+                    VALIDATE_SetBatchItem( (int)i );
+
+                    rc = VARLIST_RequestValidation( pVarClient->client_pid,
+                                                    pVarInfo,
+                                                    (void *)pVarClient );
+                    if( rc == EINPROGRESS )
+                    {
+                        pVarClient->pendingValidations++;
+                    }
+                    else if( rc != EOK )
+                    {
+                        pItems[i].result = rc;
+                        failed = true;
+                    }
+                }
+            }
+
+            VALIDATE_SetBatchItem( -1 );
+
+            pVarClient->responseVal = count;
+
+            if( pVarClient->pendingValidations > 0 )
+            {
+                /* the group is applied once the validations
+                   are complete */
+                result = EINPROGRESS;
+            }
+            else
+            {
+                CommitSetGroup( pVarClient );
+            }
         }
+    }
 
-        /* set the variable value */
-        result = VARLIST_Set( pVarClient->client_pid,
-                              &pVarClient->variableInfo,
-                              &pVarClient->validationInProgress,
-                              (void *)pVarClient );
+    return result;
+}
 
-        pVarClient->responseVal = result;
+/*============================================================================*/
+/*  CommitSetGroup                                                            */
+/*!
+    Apply the values of a SET_GROUP request
+
+    The CommitSetGroup function applies all of the values of a SET_GROUP
+    request once they have been checked and validated.  The change
+    notifications are sent once the whole group has been applied, and
+    each subscriber only receives one of them.  If any of the items
+    was rejected, none of the values are applied and the items which
+    were not rejected are given an ECANCELED result.
+
+    @param[in]
+        pVarClient
+            Pointer to the client data structure
+
+==============================================================================*/
+static void CommitSetGroup( VarClient *pVarClient )
+{
+    VarBatchItem *pItems;
+    VarInfo *pVarInfo;
+    bool validationInProgress;
+    bool failed = false;
+    size_t count;
+    size_t i;
+
+    pVarInfo = &pVarClient->variableInfo;
+    pItems = (VarBatchItem *)&pVarClient->workbuf;
+    count = pVarClient->responseVal;
+
+    for( i = 0; i < count; i++ )
+    {
+        if( pItems[i].result != EOK )
+        {
+            failed = true;
+        }
     }
 
-    if( ( result != EOK ) &&
-        ( pVarClient->debug >= LOG_DEBUG ) )
+    if( failed == true )
     {
-        printf( "SERVER: %s result = %s\n", __func__, strerror( result ) );
+        for( i = 0; i < count; i++ )
+        {
+            if( pItems[i].result == EOK )
+            {
+                pItems[i].result = ECANCELED;
+            }
+        }
     }
+    else
+    {
+        NOTIFY_BeginGroup();
+        VARLIST_BeginBatch();
 
-    return result;
+        for( i = 0; i < count; i++ )
+        {
+            GetBatchItem( pVarClient, i, pVarInfo );
+
+            /* the changes have already been validated */
+            validationInProgress = true;
+            pItems[i].result = VARLIST_Set( pVarClient->client_pid,
+                                            pVarInfo,
+                                            &validationInProgress,
+                                            (void *)pVarClient );
+            if( pItems[i].result == EALREADY )
+            {
+                pItems[i].result = EOK;
+            }
+        }
+
+        VARLIST_EndBatch();
+        NOTIFY_EndGroup();
+    }
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestType                                                     */
+/*  GetBatchItem                                                              */
 /*!
-    Process a TYPE variable request from a client
+    Get the variable and value of a batched set item
 
-    The ProcessVarRequestType function handles a "variable TYPE" request
-    from a client.  It requests the variable type for the specified
-    variable
+    The GetBatchItem function gets the variable handle and value of a
+    SET_MANY or SET_GROUP item from the client's working buffer.  The
+    data of a string or blob value is left in the working buffer.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable type was retrieved
-    @retval ENOENT the variable was not found
-    @retval EINVAL the client is invalid
-    @retval ENOTSUP the client is the wrong version
+    @param[in]
+        item
+            index of the item in the client's working buffer
+
+    @param[out]
+        pVarInfo
+            Pointer to the VarInfo object to populate
+
+    @retval EOK the item was retrieved
+    @retval E2BIG the item data is outside the working buffer
 
 ==============================================================================*/
-static int ProcessVarRequestType( VarClient *pVarClient )
+static int GetBatchItem( VarClient *pVarClient,
+                         size_t item,
+                         VarInfo *pVarInfo )
 {
-    int result = EINVAL;
+    int result = EOK;
+    VarBatchItem *pItem;
 
-    /* validate the client object */
-    result = ValidateClient( pVarClient );
-    if( result == EOK)
+    pItem = &((VarBatchItem *)&pVarClient->workbuf)[item];
+
+    pVarInfo->hVar = pItem->hVar;
+    pVarInfo->var = pItem->var;
+
+    if( ( pItem->var.type == VARTYPE_STR ) ||
+        ( pItem->var.type == VARTYPE_BLOB ) )
     {
-        /* fet the variable type */
-        result = VARLIST_GetType( &pVarClient->variableInfo );
+        /* string and blob data is in the working buffer */
+        if( ( pItem->offset < pVarClient->workbufsize ) &&
+            ( pItem->var.len <= pVarClient->workbufsize - pItem->offset ) )
+        {
+            pVarInfo->var.val.blob = &pVarClient->workbuf + pItem->offset;
+        }
+        else
+        {
+            result = E2BIG;
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestName                                                     */
+/*  ProcessVarRequestGetPage                                                  */
 /*!
-    Process a NAME variable request from a client
+    Process a GET_PAGE variable request from a client
 
-    The ProcessVarRequestName function handles a "variable NAME" request
-    from a client.  It requests the variable name for the specified
-    variable
+    The ProcessVarRequestGetPage function handles a paged query request
+    from a client.  As many matching variables as will fit are packed
+    into the client's working buffer, and the search context identifier
+    (0 when the search is complete) is returned in the response value.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable type was retrieved
-    @retval ENOENT the variable was not found
+    @retval EOK the page was processed
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
+    @retval other error from VARLIST_GetPage
 
 ==============================================================================*/
-static int ProcessVarRequestName( VarClient *pVarClient )
+static int ProcessVarRequestGetPage( VarClient *pVarClient )
 {
     int result = EINVAL;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        /* fetch the variable name */
-        result = VARLIST_GetName( &pVarClient->variableInfo );
+        result = VARLIST_GetPage( pVarClient->client_pid,
+                                  pVarClient->requestVal,
+                                  &pVarClient->variableInfo,
+                                  &pVarClient->workbuf,
+                                  pVarClient->workbufsize,
+                                  &pVarClient->responseVal );
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestLength                                                   */
+/*  ProcessVarRequestNotifyQuery                                              */
 /*!
-    Process a LENGTH variable request from a client
+    Process a NOTIFY_QUERY request from a client
 
-    The ProcessVarRequestLength function handles a "variable LENGTH" request
-    from a client.  It requests the variable length for the specified
-    variable.  This is mostly useful for variable length data types such
-    as strings.
+    The ProcessVarRequestNotifyQuery function registers a NOTIFY_MODIFIED
+    subscription for all variables matching a query.  The query type is
+    in the request value and the match string is in the client's working
+    buffer.  The subscription identifier is returned in the response
+    value, or the negated error code if the subscription failed.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable length was retrieved
-    @retval ENOENT the variable was not found
+    @retval EOK the subscription was registered
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
+    @retval other error from VARLIST_NotifyQuery
 
 ==============================================================================*/
-static int ProcessVarRequestLength( VarClient *pVarClient )
+static int ProcessVarRequestNotifyQuery( VarClient *pVarClient )
 {
     int result = EINVAL;
+    int id = 0;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        /* get the variable length */
-        result = VARLIST_GetLength( &(pVarClient->variableInfo) );
+        /* make sure the match string is terminated */
+        (&pVarClient->workbuf)[pVarClient->workbufsize - 1] = 0;
+
+        result = VARLIST_NotifyQuery( pVarClient->client_pid,
+                                      pVarClient->requestVal,
+                                      &pVarClient->variableInfo,
+                                      &pVarClient->workbuf,
+                                      &id );
+
+        pVarClient->responseVal = ( result == EOK ) ? id : -result;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestFlags                                                    */
+/*  ProcessVarRequestNotifyQueryCancel                                        */
 /*!
-    Process a FLAGS variable request from a client
+    Process a NOTIFY_QUERY_CANCEL request from a client
 
-    The ProcessVarRequestFlags function handles a "variable FLAGS" request
-    from a client.  It requests the variable flags for the specified
-    variable.
+    The ProcessVarRequestNotifyQueryCancel function cancels the query
+    subscription identified by the request value.  The result is
+    returned in the response value.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable flags were retrieved
-    @retval ENOENT the variable was not found
+    @retval EOK the subscription was cancelled
+    @retval ENOENT the subscription was not found
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestFlags( VarClient *pVarClient )
+static int ProcessVarRequestNotifyQueryCancel( VarClient *pVarClient )
 {
     int result = EINVAL;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        /* get the variable length */
-        result = VARLIST_GetFlags( &(pVarClient->variableInfo) );
+        result = VARLIST_NotifyQueryCancel( pVarClient->client_pid,
+                                            pVarClient->requestVal );
+
+        pVarClient->responseVal = result;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestInfo                                                     */
+/*  ProcessVarRequestSnapshot                                                 */
 /*!
-    Process an INFO variable request from a client
-
-    The ProcessVarRequestInfo function handles a "variable INFO" request
-    from a client.  It requests the variable information for the specified
-    variable.
-
-    Variable information includes
-
-    - name
-    - permissions
-    - format specifier
-    - flags
-    - tags
-    - instanceID
-    - guid
+    Process a SNAPSHOT request from a client
 
+    The ProcessVarRequestSnapshot function writes a snapshot of the
+    variable store to the file named in the client's working buffer,
+    using the snapshot options in the request value.  Only root, or the
+    user running the variable server, may write a snapshot.  The number
+    of records written, or a negated error code, is returned in the
+    response value.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable info was retrieved
-    @retval ENOENT the variable was not found
+    @retval EOK the snapshot was written
+    @retval EACCES the client is not permitted to write a snapshot
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
+    @retval other error from SNAPSHOT_Save
 
 ==============================================================================*/
-static int ProcessVarRequestInfo( VarClient *pVarClient )
+static int ProcessVarRequestSnapshot( VarClient *pVarClient )
 {
     int result = EINVAL;
+    VarInfo *pVarInfo;
+    size_t count = 0;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        /* get the variable length */
-        result = VARLIST_GetInfo( &(pVarClient->variableInfo) );
+        pVarInfo = &pVarClient->variableInfo;
+        if( ( pVarInfo->ncreds > 0 ) &&
+            ( ( pVarInfo->creds[0] == 0 ) ||
+              ( pVarInfo->creds[0] == getuid() ) ) )
+        {
+            /* make sure the path is terminated */
+            (&pVarClient->workbuf)[pVarClient->workbufsize - 1] = 0;
+
+            result = SNAPSHOT_Save( &pVarClient->workbuf,
+                                    pVarClient->requestVal,
+                                    &count );
+        }
+        else
+        {
+            result = EACCES;
+        }
+
+        pVarClient->responseVal = ( result == EOK ) ? (int)count : -result;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestNotify                                                   */
+/*  ProcessVarRequestNewMany                                                  */
 /*!
-    Process a NOTIFY variable request from a client
+    Process a NEW_MANY request from a client
 
-    The ProcessVarRequestNotify function handles a variable notification
-    requests from a client.  It registers a request for a notification
-    of type:
-        NOTIFY_MODIFIED_QUEUE
-            - request a notification when the notification queue changes
-        NOTIFY_MODIFIED
-            - request a notification when a variable's value changes
-        NOTIFY_CALC
-            - request a notification when a variable's value is requested
-              by another client
-        NOTIFY_VALIDATE
-            - request a notification when a variable is being changed
-              by another client, before the change is applied.
-        NOTIFY_PRINT
-            - request a notification when a client tries to print
-              the variable with the given handle
+    The ProcessVarRequestNewMany function creates each of the variables
+    defined by the VarCreateItem objects packed into the client's
+    working buffer.  The number of items in the batch is in the request
+    value.  The result and handle of each new variable are stored in its
+    item, and the number of items processed is returned in the response
+    value.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable notification was successfully registered
-    @retval ENOENT the variable was not found
+    @retval EOK the batch was processed
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestNotify( VarClient *pVarClient )
+static int ProcessVarRequestNewMany( VarClient *pVarClient )
 {
     int result = EINVAL;
+    VarCreateItem *pItem;
+    size_t count;
+    size_t offset = 0;
+    size_t i = 0;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        /* register the notification request */
-        result = VARLIST_RequestNotify( &(pVarClient->variableInfo),
-                                        pVarClient->client_pid );
+        count = ( pVarClient->requestVal > 0 ) ? pVarClient->requestVal : 0;
+
+        while( ( i < count ) &&
+               ( sizeof( VarCreateItem ) <= pVarClient->workbufsize - offset ) )
+        {
+            pItem = (VarCreateItem *)( &pVarClient->workbuf + offset );
+            if( ( pItem->size < sizeof( VarCreateItem ) ) ||
+                ( pItem->size > pVarClient->workbufsize - offset ) ||
+                ( pItem->size % VARCREATE_ITEM_ALIGN != 0 ) )
+            {
+                /* the rest of the batch cannot be located */
+                break;
+            }
+
+            pItem->result = CreateBatchItem( pVarClient, pItem );
+            offset += pItem->size;
+            i++;
+        }
+
+        pVarClient->responseVal = i;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestNotifyCancel                                             */
+/*  CreateBatchItem                                                           */
 /*!
-    Process a NOTIFY_CANCEL variable request from a client
+    Create a variable from a NEW_MANY batch item
 
-    The ProcessVarRequestNotifyCancel function handles a variable notification
-    cancellation request from a client.
+    The CreateBatchItem function builds the VarInfo object for a variable
+    defined in a NEW_MANY batch item, using the requesting client's
+    credentials, and adds the new variable to the variable list.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable notification was successfully cancelled
-    @retval ENOENT the variable or notification was not found
-    @retval EINVAL the client is invalid
-    @retval ENOTSUP the client is the wrong version
+    @param[in,out]
+        pItem
+            pointer to a batch item which lies within the working buffer.
+            The handle of the new variable is stored in the item.
+
+    @retval EOK the variable was created
+    @retval EEXIST the variable already exists
+    @retval EINVAL the item contents are not valid
+    @retval other error from VARLIST_AddNew
 
 ==============================================================================*/
-static int ProcessVarRequestNotifyCancel( VarClient *pVarClient )
+static int CreateBatchItem( VarClient *pVarClient, VarCreateItem *pItem )
 {
     int result = EINVAL;
+    VarInfo info;
+    char *p = (char *)pItem;
+    size_t size = pItem->size;
+    size_t nameLen;
+    uint32_t varhandle;
 
-    /* validate the client object */
-    result = ValidateClient( pVarClient );
-    if( result == EOK)
+    pItem->hVar = VAR_INVALID;
+
+    memset( &info, 0, sizeof( VarInfo ) );
+    memcpy( info.creds,
+            pVarClient->variableInfo.creds,
+            sizeof( info.creds ) );
+    info.ncreds = pVarClient->variableInfo.ncreds;
+    info.groupset = pVarClient->variableInfo.groupset;
+
+    nameLen = strnlen( pItem->name, size - sizeof( VarCreateItem ) );
+    if( ( nameLen > 0 ) &&
+        ( nameLen <= MAX_NAME_LEN ) &&
+        ( pItem->tagspecOffset > sizeof( VarCreateItem ) + nameLen ) &&
+        ( pItem->tagspecOffset < size ) &&
+        ( strnlen( &p[pItem->tagspecOffset], size - pItem->tagspecOffset )
+            < MAX_TAGSPEC_LEN ) )
     {
-        /* cancel the notification request */
-        result = VARLIST_NotifyCancel( &(pVarClient->variableInfo),
-                                       pVarClient->client_pid );
+        memcpy( info.name, pItem->name, nameLen );
+        strcpy( info.tagspec, &p[pItem->tagspecOffset] );
+        memcpy( info.formatspec, pItem->formatspec, MAX_FORMATSPEC_LEN );
+        info.formatspec[MAX_FORMATSPEC_LEN - 1] = 0;
+        info.instanceID = pItem->instanceID;
+        info.guid = pItem->guid;
+        info.flags = pItem->flags;
+        info.permissions = pItem->permissions;
+        info.var = pItem->var;
+        result = EOK;
+    }
+
+    if( ( result == EOK ) &&
+        ( ( info.var.type == VARTYPE_STR ) ||
+          ( info.var.type == VARTYPE_BLOB ) ) )
+    {
+        if( pItem->valueOffset == 0 )
+        {
+            /* strings without an initial value start out empty */
+            info.var.val.str = "";
+            result = ( info.var.type == VARTYPE_STR ) ? EOK : EINVAL;
+        }
+        else if( ( pItem->valueOffset < size ) &&
+                 ( ( ( info.var.type == VARTYPE_STR ) &&
+                     ( memchr( &p[pItem->valueOffset],
+                               0,
+                               size - pItem->valueOffset ) != NULL ) ) ||
+                   ( ( info.var.type == VARTYPE_BLOB ) &&
+                     ( info.var.len <= size - pItem->valueOffset ) ) ) )
+        {
+            info.var.val.blob = &p[pItem->valueOffset];
+        }
+        else
+        {
+            result = EINVAL;
+        }
+    }
+
+    if( result == EOK )
+    {
+        if( VARLIST_Exists( &info ) == EOK )
+        {
+            result = EEXIST;
+        }
+        else
+        {
+            result = VARLIST_AddNew( &info, &varhandle );
+            if( result == EOK )
+            {
+                pItem->hVar = varhandle;
+            }
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestGet                                                      */
+/*  ProcessValidationRequest                                                  */
 /*!
-    Process a GET variable request from a client
+    Process a Validation Request from a client
 
-    The ProcessVarRequestGet function handles a "GET variable" request
-    from a client.  It populates the variable type, value and length
-    into the client's VarInfo object.  If the variable is a string,
-    the string is transferred into the client'sworking buffer.
+    The ProcessValidationRequest function handles a validation request
+    from a client.  A client sends a validation request to the server
+    after it has received a validation signal from the server indicating
+    that another client is trying to change a variable for which the
+    client is registered as a validator.
+
+    The Validation Request is used to retrieve the pending new value
+    so it can be validated by the client.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable info was returned
-    @retval ENOENT the variable was not found
+    @retval EOK the validation information was returned
+    @retval ENOENT the validation request was not found
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestGet( VarClient *pVarClient )
+static int ProcessValidationRequest( VarClient *pVarClient )
 {
     int result = EINVAL;
+    VarClient *pSetClient;
+    VarInfo setInfo;
+    VarObject *pSrc;
+    VAR_HANDLE hVar;
+    int item = -1;
 
-    /* validate the client object */
+    /* validated the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        result = VARLIST_GetByHandle( pVarClient->client_pid,
-                                      &pVarClient->variableInfo,
-                                      &pVarClient->workbuf,
-                                      pVarClient->workbufsize );
-        if( result == EINPROGRESS )
+        /* get a pointer to the client requesting the validation */
+        pSetClient = (VarClient *)TRANSACTION_Get( pVarClient->requestVal,
+                                                   &hVar );
+        VALIDATE_GetItem( pVarClient->requestVal, &item );
+        if( pSetClient != NULL )
+        {
+            /* get the proposed value from the setting client */
+            pSrc = &pSetClient->variableInfo.var;
+            if( ( item >= 0 ) &&
+                ( GetBatchItem( pSetClient, item, &setInfo ) == EOK ) )
+            {
+                pSrc = &setInfo.var;
+            }
+
+            if( pSrc->type == VARTYPE_STR )
+            {
+                /* strings will be stored in the client's working buffer */
+                pVarClient->variableInfo.var.val.str = &pVarClient->workbuf;
+                pVarClient->variableInfo.var.len = pVarClient->workbufsize;
+            }
+
+            if( pSrc->type == VARTYPE_BLOB )
+            {
+                /* blobs will be stored in the client's working buffer */
+                pVarClient->variableInfo.var.val.blob = &pVarClient->workbuf;
+
+
+                // TO DO : Need to pass blob size as well as blob!!!!
+                pVarClient->variableInfo.var.len = pVarClient->workbufsize;
+            }
+
+            /* copy the variable handle from the setting client to the
+               validating client */
+            pVarClient->variableInfo.hVar = hVar;
+
+            /* copy the Variable object from the setter to the validator */
+            result = VAROBJECT_Copy( &pVarClient->variableInfo.var, pSrc );
+        }
+        else
         {
-            /* add the client to the blocked clients list */
-            BlockClient( pVarClient, NOTIFY_CALC );
+            result = ENOENT;
         }
     }
 
@@ -1706,85 +5625,75 @@ static int ProcessVarRequestGet( VarClient *pVarClient )
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestGetFirst                                                 */
+/*  ProcessValidationResponse                                                 */
 /*!
-    Process a GET_FIRST variable request from a client
+    Process a Validation Response from a client
 
-    The ProcessVarRequestGetFirst function handles a "GET_FIRST variable"
-    request from a client.  It initiates a search for variables which
-    match the specified search criteria.
+    The ProcessValidationResponse function handles a validge is accepted
+    or rejected.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable info was returned
-    @retval ENOENT the variable was not found
+    @retval EOK the validation information was returned
+    @retval ENOENT the validation request was not found
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestGetFirst( VarClient *pVarClient )
+static int ProcessValidationResponse( VarClient *pVarClient )
 {
     int result = EINVAL;
 
-    /* validate the client object */
+    /* validated the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        result = VARLIST_GetFirst( pVarClient->client_pid,
-                                   pVarClient->requestVal,
-                                   &pVarClient->variableInfo,
-                                   &pVarClient->workbuf,
-                                   pVarClient->workbufsize,
-                                   &pVarClient->responseVal);
-        if( result == EINPROGRESS )
-        {
-            /* add the client to the blocked clients list */
-            BlockClient( pVarClient, NOTIFY_CALC );
-        }
+        result = CompleteValidation( pVarClient->requestVal,
+                                     pVarClient->responseVal );
     }
 
     return result;
+
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestGetNext                                                  */
+/*  ProcessVarRequestValidationPolicy                                         */
 /*!
-    Process a GET_NEXT variable request from a client
+    Process a VALIDATION_POLICY request from a client
 
-    The ProcessVarRequestGetNext function handles a "GET_NEXT variable"
-    request from a client.  It continues a search for variables which
-    match the specified search criteria.
+    The ProcessVarRequestValidationPolicy function sets the validation
+    policy of the requesting validator from the ValidationPolicy object
+    in the client's working buffer.
 
     @param[in]
         pVarClient
             Pointer to the client data structure
 
-    @retval EOK the variable info was returned
-    @retval ENOENT the variable was not found
+    @retval EOK the validation policy was set
+    @retval E2BIG the working buffer is too small
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestGetNext( VarClient *pVarClient )
+static int ProcessVarRequestValidationPolicy( VarClient *pVarClient )
 {
     int result = EINVAL;
+    ValidationPolicy policy;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        result = VARLIST_GetNext( pVarClient->client_pid,
-                                  pVarClient->requestVal,
-                                  &pVarClient->variableInfo,
-                                  &pVarClient->workbuf,
-                                  pVarClient->workbufsize,
-                                  &pVarClient->responseVal );
-        if( result == EINPROGRESS )
+        if( pVarClient->workbufsize < sizeof( ValidationPolicy ) )
         {
-            /* add the client to the blocked clients list */
-            BlockClient( pVarClient, NOTIFY_CALC );
+            result = E2BIG;
+        }
+        else
+        {
+            memcpy( &policy, &pVarClient->workbuf, sizeof( policy ) );
+            result = VALIDATE_SetPolicy( pVarClient->client_pid, &policy );
         }
     }
 
@@ -1792,140 +5701,175 @@ static int ProcessVarRequestGetNext( VarClient *pVarClient )
 }
 
 /*============================================================================*/
-/*  ProcessVarRequestSetFlags                                                 */
+/*  ProcessValidationBatchRequest                                             */
 /*!
-    Process a SET_FLAGS variable request from a client
+    Process a GET_VALIDATION_BATCH request from a client
 
-    The ProcessVarRequestSetFlags function handles a "variable SET_FLAGS"
-    request from a client.  It sets all of the flags specified in the
-    pVarClient->variableInfo object for the variable specified in the
-    pVarClient->variableInfo object.
+    The ProcessValidationBatchRequest function packs up to requestVal of
+    the validator's queued validation requests into its working buffer
+    as VarValidationItem objects, followed by the data of any string or
+    blob values.  The number of items is returned in the response value.
+    A request whose value does not fit is returned with an E2BIG result
+    and no value, and can be fetched with a VALIDATION_REQUEST.
 
     @param[in]
         pVarClient
-            Pointer to the client data structure
+            Pointer to the client data structure of the validator
 
-    @retval EOK the variable flags were set
-    @retval ENOENT the variable was not found
+    @retval EOK the batch was processed
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessVarRequestSetFlags( VarClient *pVarClient )
+static int ProcessValidationBatchRequest( VarClient *pVarClient )
 {
     int result = EINVAL;
+    VarValidationItem *pItems;
+    VarBatchItem *pItem;
+    VarClient *pSetClient;
+    VarObject *pSrc;
+    VarObject src;
+    VAR_HANDLE hVar;
+    uint32_t id;
+    size_t max;
+    size_t count = 0;
+    size_t offset;
+    size_t n;
+    int item;
 
     /* validate the client object */
     result = ValidateClient( pVarClient );
-    if( result == EOK)
+    if( result == EOK )
     {
-        result = VARLIST_SetFlags( &pVarClient->variableInfo );
-    }
+        pItems = (VarValidationItem *)&pVarClient->workbuf;
+        max = ( pVarClient->requestVal > 0 ) ? pVarClient->requestVal : 0;
+        if( max > pVarClient->workbufsize / sizeof( VarValidationItem ) )
+        {
+            max = pVarClient->workbufsize / sizeof( VarValidationItem );
+        }
 
-    return result;
-}
+        offset = max * sizeof( VarValidationItem );
 
-/*============================================================================*/
-/*  ProcessVarRequestClearFlags                                               */
-/*!
-    Process a CLEAR_FLAGS variable request from a client
+        while( ( count < max ) &&
+               ( VALIDATE_Next( pVarClient->client_pid,
+                                &id,
+                                &item ) == EOK ) )
+        {
+            pSetClient = (VarClient *)TRANSACTION_Get( id, &hVar );
+            if( pSetClient == NULL )
+            {
+                /* discard a request whose transaction has gone */
+                VALIDATE_Complete( id, &item );
+                continue;
+            }
 
-    The ProcessVarRequestClearFlags function handles a "variable CLEAR_FLAGS"
-    request from a client.  It clears all of the flags specified in the
-    pVarClient->variableInfo object for the variable specified in the
-    pVarClient->variableInfo object.
+            /* get the proposed value from the setting client */
+            if( item < 0 )
+            {
+                pSrc = &pSetClient->variableInfo.var;
+            }
+            else
+            {
+                pItem = &((VarBatchItem *)&pSetClient->workbuf)[item];
+                src = pItem->var;
+                if( ( src.type == VARTYPE_STR ) ||
+                    ( src.type == VARTYPE_BLOB ) )
+                {
+                    src.val.blob = &pSetClient->workbuf + pItem->offset;
+                }
 
-    @param[in]
-        pVarClient
-            Pointer to the client data structure
+                pSrc = &src;
+            }
 
-    @retval EOK the variable flags were cleared
-    @retval ENOENT the variable was not found
-    @retval EINVAL the client is invalid
-    @retval ENOTSUP the client is the wrong version
+            pItems[count].id = id;
+            pItem = &pItems[count].item;
+            pItem->hVar = hVar;
+            pItem->var = *pSrc;
+            pItem->offset = offset;
+            pItem->result = EOK;
 
-==============================================================================*/
-static int ProcessVarRequestClearFlags( VarClient *pVarClient )
-{
-    int result = EINVAL;
+            if( ( pSrc->type == VARTYPE_STR ) ||
+                ( pSrc->type == VARTYPE_BLOB ) )
+            {
+                n = ( pSrc->type == VARTYPE_STR )
+                        ? strnlen( pSrc->val.str, pSrc->len ) + 1
+                        : pSrc->len;
+                if( n <= pVarClient->workbufsize - offset )
+                {
+                    memcpy( &pVarClient->workbuf + offset, pSrc->val.blob, n );
+                    if( pSrc->type == VARTYPE_STR )
+                    {
+                        /* make sure the string is terminated */
+                        (&pVarClient->workbuf)[offset + n - 1] = 0;
+                    }
+
+                    offset += n;
+                }
+                else
+                {
+                    pItem->result = E2BIG;
+                }
+            }
 
-    /* validate the client object */
-    result = ValidateClient( pVarClient );
-    if( result == EOK)
-    {
-        result = VARLIST_ClearFlags( &pVarClient->variableInfo );
+            count++;
+        }
+
+        pVarClient->responseVal = count;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  ProcessValidationRequest                                                  */
+/*  ProcessValidationBatchResponse                                            */
 /*!
-    Process a Validation Request from a client
+    Process a SEND_VALIDATION_BATCH request from a client
 
-    The ProcessValidationRequest function handles a validation request
-    from a client.  A client sends a validation request to the server
-    after it has received a validation signal from the server indicating
-    that another client is trying to change a variable for which the
-    client is registered as a validator.
-
-    The Validation Request is used to retrieve the pending new value
-    so it can be validated by the client.
+    The ProcessValidationBatchResponse function applies the responses of
+    a validator to requestVal validation requests.  The client's working
+    buffer contains an array of VarValidationItem objects holding the
+    request identifiers and responses.  The result of completing each
+    request is written back into its item.
 
     @param[in]
         pVarClient
-            Pointer to the client data structure
+            Pointer to the client data structure of the validator
 
-    @retval EOK the validation information was returned
-    @retval ENOENT the validation request was not found
+    @retval EOK the batch was processed
+    @retval E2BIG the item array does not fit in the working buffer
     @retval EINVAL the client is invalid
     @retval ENOTSUP the client is the wrong version
 
 ==============================================================================*/
-static int ProcessValidationRequest( VarClient *pVarClient )
+static int ProcessValidationBatchResponse( VarClient *pVarClient )
 {
     int result = EINVAL;
-    VarClient *pSetClient;
-    VAR_HANDLE hVar;
+    VarValidationItem *pItems;
+    size_t count;
+    size_t i;
 
-    /* validated the client object */
+    /* validate the client object */
     result = ValidateClient( pVarClient );
     if( result == EOK )
     {
-        /* get a pointer to the client requesting the validation */
-        pSetClient = (VarClient *)TRANSACTION_Get( pVarClient->requestVal,
-                                                   &hVar );
-        if( pSetClient != NULL )
-        {
-            if( pSetClient->variableInfo.var.type == VARTYPE_STR )
-            {
-                /* strings will be stored in the client's working buffer */
-                pVarClient->variableInfo.var.val.str = &pVarClient->workbuf;
-                pVarClient->variableInfo.var.len = pVarClient->workbufsize;
-            }
-
-            if( pSetClient->variableInfo.var.type == VARTYPE_BLOB )
-            {
-                /* blobs will be stored in the client's working buffer */
-                pVarClient->variableInfo.var.val.blob = &pVarClient->workbuf;
-
-
-                // TO DO : Need to pass blob size as well as blob!!!!
-                pVarClient->variableInfo.var.len = pVarClient->workbufsize;
-            }
-
-            /* copy the variable handle from the setting client to the
-               validating client */
-            pVarClient->variableInfo.hVar = hVar;
+        pItems = (VarValidationItem *)&pVarClient->workbuf;
+        count = ( pVarClient->requestVal > 0 ) ? pVarClient->requestVal : 0;
+        pVarClient->responseVal = 0;
 
-            /* copy the Variable object from the setter to the validator */
-            result = VAROBJECT_Copy( &pVarClient->variableInfo.var,
-                                     &pSetClient->variableInfo.var );
+        if( count * sizeof( VarValidationItem ) > pVarClient->workbufsize )
+        {
+            result = E2BIG;
         }
         else
         {
-            result = ENOENT;
+            for( i = 0; i < count; i++ )
+            {
+                pItems[i].item.result =
+                    CompleteValidation( pItems[i].id,
+                                        pItems[i].item.result );
+            }
+
+            pVarClient->responseVal = count;
         }
     }
 
@@ -1933,52 +5877,123 @@ static int ProcessValidationRequest( VarClient *pVarClient )
 }
 
 /*============================================================================*/
-/*  ProcessValidationResponse                                                 */
+/*  CompleteValidation                                                        */
 /*!
-    Process a Validation Response from a client
+    Complete a validation request
 
-    The ProcessValidationResponse function handles a validge is accepted
-    or rejected.
+    The CompleteValidation function applies a validator's response (or
+    the default response of an expired request) to a pending validation
+    request.  An accepted change is set on behalf of the writer, and a
+    rejected change returns the response to the writer.  A single set
+    request is released immediately, and a SET_MANY request is released
+    once all of its validated items are complete.  A SET_GROUP request
+    is applied, or cancelled, once all of its items are validated.
 
     @param[in]
-        pVarClient
-            Pointer to the client data structure
+        id
+            transaction identifier of the validation request
 
-    @retval EOK the validation information was returned
+    @param[in]
+        response
+            EOK to accept the change, or the error to reject it with
+
+    @retval EOK the validation was completed
     @retval ENOENT the validation request was not found
-    @retval EINVAL the client is invalid
-    @retval ENOTSUP the client is the wrong version
+    @retval other the accepted change could not be set
 
 ==============================================================================*/
-static int ProcessValidationResponse( VarClient *pVarClient )
+static int CompleteValidation( uint32_t id, int response )
 {
-    int result = EINVAL;
+    int result = ENOENT;
     VarClient *pSetClient;
+    VarBatchItem *pItem;
+    VarInfo *pVarInfo;
+    bool validationInProgress;
+    int item = -1;
 
-    /* validated the client object */
-    result = ValidateClient( pVarClient );
-    if( result == EOK )
+    VALIDATE_Complete( id, &item );
+
+    /* get a pointer to the client requesting the validation */
+    pSetClient = (VarClient *)TRANSACTION_Remove( id );
+    if( pSetClient != NULL )
     {
-        /* get a pointer to the client requesting the validation */
-        pSetClient = (VarClient *)TRANSACTION_Remove(pVarClient->requestVal);
-        if( pSetClient != NULL )
+        result = EOK;
+
+        if( item < 0 )
         {
             /* copy the response from the validator to the setter */
-            pSetClient->responseVal = pVarClient->responseVal;
+            pSetClient->responseVal = response;
 
-            if( pVarClient->responseVal == EOK )
+            if( response == EOK )
             {
                 /* set the value on behalf of the requestor */
                 result = ProcessVarRequestSet( pSetClient );
             }
+            else
+            {
+                /* the next set request needs to be validated again */
+                pSetClient->validationInProgress = false;
+            }
+
+            if( ( pSetClient->clientid > 0 ) &&
+                ( pSetClient->clientid < MAX_VAR_CLIENTS ) )
+            {
+                RequestResult[pSetClient->clientid] =
+                    ( response == EOK ) ? result : response;
+            }
 
             /* unblock the client */
-            UnblockClient( pSetClient );
+            DeferUnblockClient( pSetClient );
+        }
+        else if( pSetClient->requestType == VARREQUEST_SET_GROUP )
+        {
+            /* the group is applied once all of its items are validated */
+            pItem = &((VarBatchItem *)&pSetClient->workbuf)[item];
+            pItem->result = response;
+
+            if( ( pSetClient->pendingValidations > 0 ) &&
+                ( --pSetClient->pendingValidations == 0 ) )
+            {
+                CommitSetGroup( pSetClient );
+                DeferUnblockClient( pSetClient );
+            }
+        }
+        else
+        {
+            pItem = &((VarBatchItem *)&pSetClient->workbuf)[item];
+            pItem->result = response;
+
+            if( response == EOK )
+            {
+                /* set the SET_MANY item on behalf of the requestor */
+                pVarInfo = &pSetClient->variableInfo;
+                pVarInfo->hVar = pItem->hVar;
+                pVarInfo->var = pItem->var;
+                if( ( pItem->var.type == VARTYPE_STR ) ||
+                    ( pItem->var.type == VARTYPE_BLOB ) )
+                {
+                    pVarInfo->var.val.blob =
+                                &pSetClient->workbuf + pItem->offset;
+                }
+
+                validationInProgress = true;
+                pItem->result = VARLIST_Set( pSetClient->client_pid,
+                                             pVarInfo,
+                                             &validationInProgress,
+                                             (void *)pSetClient );
+                result = pItem->result;
+            }
+
+            if( ( pSetClient->pendingValidations > 0 ) &&
+                ( --pSetClient->pendingValidations == 0 ) )
+            {
+                /* all of the validated items are complete */
+                DeferUnblockClient( pSetClient );
+            }
         }
     }
 
     return result;
-
 }
 
 /*============================================================================*/
@@ -2000,6 +6015,8 @@ static int InitStats( void )
     size_t i;
     char *pMetricName;
     uint64_t *pMetric;
+    char *pSuffix;
+    char name[MAX_NAME_LEN+1];
 
     /* initialize an empty stats object */
     STATS_Initialize();
@@ -2008,8 +6025,57 @@ static int InitStats( void )
     STATS_SetRequestsPerSecPtr(MakeMetric("/varserver/stats/tps" ));
     STATS_SetTotalRequestsPtr(MakeMetric("/varserver/stats/transactions"));
 
+    /* set up the capacity and resident memory metrics */
+    pMetric = MakeMetric( "/varserver/stats/capacity" );
+    if ( pMetric != NULL )
+    {
+        *pMetric = VARLIST_Capacity();
+    }
+
+    STATS_SetMemoryPtrs( MakeMetric( "/varserver/stats/rss_bytes" ),
+                         MakeMetric( "/varserver/stats/rss_per_var" ) );
+
     /* set up the blocked client counter metric */
     SetBlockedClientMetric(MakeMetric("/varserver/stats/blocked_clients"));
+    SetBlockedListMaxMetric(MakeMetric("/varserver/stats/blocked_list_max"));
+
+    /* set up the expired validation counter metric */
+    pValidationTimeouts = MakeMetric( "/varserver/stats/validation_timeouts" );
+
+    /* set up the exited client reclamation metrics */
+    pReclaimedClients = MakeMetric( "/varserver/stats/reclaimed_clients" );
+    pReclaimedNotifications =
+                MakeMetric( "/varserver/stats/reclaimed_notifications" );
+    pReclaimedBlocked = MakeMetric( "/varserver/stats/reclaimed_blocked" );
+    pReclaimedTransactions =
+                MakeMetric( "/varserver/stats/reclaimed_transactions" );
+    pReclaimedContexts = MakeMetric( "/varserver/stats/reclaimed_contexts" );
+    pReclaimedObjects = MakeMetric( "/varserver/stats/reclaimed_objects" );
+
+    /* set up the suppressed notification metrics */
+    NOTIFY_SetSuppressionMetrics(
+                    MakeMetric("/varserver/stats/notify_coalesced"),
+                    MakeMetric("/varserver/stats/notify_rate_limited"),
+                    MakeMetric("/varserver/stats/notify_deadband") );
+
+    /* set up the notification message queue overflow metrics */
+    NOTIFY_SetOverflowMetrics(
+                    MakeMetric("/varserver/stats/notify_queue_dropped"),
+                    MakeMetric("/varserver/stats/notify_queue_coalesced") );
+    NOTIFY_SetOverflowHandler( OnQueueOverflow );
+
+    /* set up the CALC handler metrics */
+    VARLIST_SetCalcMetrics( MakeMetric( "/varserver/stats/calc_cache_hits" ),
+                            MakeMetric( "/varserver/stats/calc_coalesced" ) );
+
+    /* set up the server memory accounting metrics */
+    STATS_SetMemMetrics( MakeMetric );
+
+    /* set up the slab allocator occupancy metrics */
+    SLAB_SetMetrics( MakeMetric );
+    NAMEPOOL_SetMetrics( MakeMetric );
+    JOURNAL_SetMetrics( MakeMetric );
+    STANDBY_SetMetrics( MakeMetric );
 
     /* create the metric variable */
     memset(&info, 0, sizeof(VarInfo));
@@ -2033,12 +6099,93 @@ static int InitStats( void )
         {
             pMetric = MakeMetric( pMetricName );
             RequestHandlers[i].pMetric = pMetric;
+
+            /* make the request service time histogram */
+            pSuffix = strrchr( pMetricName, '/' );
+            snprintf( name, sizeof( name ), "/varserver/stats/latency%s",
+                      pSuffix );
+            RequestLatency[i] = STATS_NewHistogram( name, MakeMetric );
         }
     }
 
+    /* make the request queueing delay histogram */
+    queueLatency = STATS_NewHistogram( "/varserver/stats/latency/queue",
+                                       MakeMetric );
+
+    /* make the queueing delay histogram of each priority class */
+    LaneLatency[VARSERVER_PRIORITY_NORMAL] =
+        STATS_NewHistogram( "/varserver/stats/latency/lane/normal",
+                            MakeMetric );
+    LaneLatency[VARSERVER_PRIORITY_HIGH] =
+        STATS_NewHistogram( "/varserver/stats/latency/lane/high",
+                            MakeMetric );
+
     return EOK;
 }
 
+/*============================================================================*/
+/*  InitTrace                                                                 */
+/*!
+    Initialize the request trace ring
+
+    The InitTrace function creates the shared request trace ring, and
+    the /varserver/trace/enable variable which switches tracing on
+    (non-zero) and off (zero) at runtime.  Only root can read or write
+    the enable variable.  The request type names are published in the
+    trace ring for the trace readers.
+
+    @retval EOK the trace ring was initialized
+    @retval other the trace ring is not available
+
+==============================================================================*/
+static int InitTrace( void )
+{
+    int result;
+    VarInfo info;
+    VAR_HANDLE hVar;
+    VarObject *pVarObject;
+    size_t len;
+    size_t n;
+    size_t i;
+
+    result = TRACE_Init( serverShard );
+    if ( result == EOK )
+    {
+        /* create the trace enable variable */
+        memset(&info, 0, sizeof(VarInfo));
+        len = sizeof(info.name);
+        strncpy(info.name, SERVER_TRACE_ENABLE, len);
+        info.name[len-1] = 0;
+        info.var.len = sizeof( uint32_t );
+        info.var.type = VARTYPE_UINT32;
+        info.permissions.read[0] = 0;
+        info.permissions.nreads = 1;
+        info.permissions.write[0] = 0;
+        info.permissions.nwrites = 1;
+        result = VARLIST_AddNew( &info, &hVar );
+    }
+
+    if ( result == EOK )
+    {
+        /* the server reads the enable flag directly from the variable */
+        pVarObject = VARLIST_GetObj( hVar );
+        result = TRACE_SetEnable( ( pVarObject != NULL ) ?
+                                  &pVarObject->val.ul : NULL );
+    }
+
+    if ( result == EOK )
+    {
+        n = sizeof(RequestHandlers) / sizeof(RequestHandler);
+        for ( i=0; i<n; i++ )
+        {
+            TRACE_SetRequestName( RequestHandlers[i].requestType,
+                                  RequestHandlers[i].requestName );
+        }
+    }
+
+    return result;
+}
+
 /*============================================================================*/
 /*  MakeMetric                                                                */
 /*!
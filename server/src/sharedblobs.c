@@ -0,0 +1,405 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup sharedblobs sharedblobs
+ * @brief Zero-copy blob segments
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file sharedblobs.c
+
+    Zero-copy Blob Segments
+
+    The Zero-copy Blob Segments module stores the value of a large blob
+    variable in its own shared memory object ( /varserver_blob_<ref> )
+    instead of the server heap.  Clients map the segment and read the
+    value in place, or fill the value in place and ask the server to
+    commit it, so the blob data is never copied through the client
+    working buffer.
+
+    Each segment holds two buffers.  The low bit of the generation
+    counter selects the buffer holding the current value.  Writers
+    lock the other buffer, fill it, and commit it by incrementing the
+    generation counter, so readers of the current value are never
+    disturbed by a write in progress.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <varserver/varclient.h>
+#include "sharedblobs.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! round a length up to the shared blob buffer alignment */
+#define SHARED_BLOB_ROUNDUP( n ) \
+    ( ( (n) + SHARED_BLOB_ALIGN - 1 ) & ~( (size_t)SHARED_BLOB_ALIGN - 1 ) )
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! shard index of the server */
+static int blobShard = 0;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SHAREDBLOBS_Init                                                          */
+/*!
+    Initialize the zero-copy blob segments
+
+    The SHAREDBLOBS_Init function records the shard index of the server,
+    which is appended to the names of the blob segments it creates.
+
+    @param[in]
+        shard
+            shard index of the server
+
+    @retval EOK the zero-copy blob segments were initialized
+
+==============================================================================*/
+int SHAREDBLOBS_Init( int shard )
+{
+    blobShard = shard;
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  SHAREDBLOBS_Create                                                        */
+/*!
+    Create a zero-copy blob segment
+
+    The SHAREDBLOBS_Create function creates the shared memory object
+    for the specified blob variable, maps it into the server's address
+    space, and stores the current value of the blob in it.
+
+    @param[in]
+        storageRef
+            storage reference of the blob variable
+
+    @param[in]
+        capacity
+            size of the blob variable
+
+    @param[in]
+        value
+            pointer to the current blob value, or NULL for none
+
+    @param[out]
+        ppSharedBlob
+            pointer to a location to store a pointer to the segment
+
+    @retval EOK the blob segment was created
+    @retval E2BIG the blob is too large
+    @retval ENOMEM the blob segment could not be mapped
+    @retval EINVAL invalid arguments
+    @retval other error from shm_open or ftruncate
+
+==============================================================================*/
+int SHAREDBLOBS_Create( uint32_t storageRef,
+                        size_t capacity,
+                        const void *value,
+                        SharedBlob **ppSharedBlob )
+{
+    int result = EINVAL;
+    SharedBlob *pSharedBlob;
+    char base[BUFSIZ];
+    char name[BUFSIZ];
+    size_t offset;
+    size_t stride;
+    size_t size;
+    void *p;
+    int fd;
+
+    if ( ( capacity > 0 ) &&
+         ( ppSharedBlob != NULL ) )
+    {
+        offset = SHARED_BLOB_ROUNDUP( sizeof( SharedBlob ) );
+        stride = SHARED_BLOB_ROUNDUP( capacity );
+        size = offset + 2 * stride;
+        result = ( size <= UINT32_MAX ) ? EOK : E2BIG;
+
+        if ( result == EOK )
+        {
+            snprintf( base,
+                      sizeof( base ),
+                      "%s_%" PRIu32,
+                      SERVER_SHAREDBLOB,
+                      storageRef );
+            result = ShardName( name, sizeof( name ), base, blobShard );
+        }
+
+        if ( result == EOK )
+        {
+            /* get shared memory file descriptor (NOT a file) */
+            fd = shm_open( name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR );
+            if ( fd == -1 )
+            {
+                result = errno;
+            }
+            else if ( ftruncate( fd, size ) == -1 )
+            {
+                result = errno;
+                close( fd );
+            }
+            else
+            {
+                p = mmap( NULL,
+                          size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          fd,
+                          0 );
+
+                /* close the file descriptor since we don't need it */
+                close( fd );
+
+                if ( p != MAP_FAILED )
+                {
+                    pSharedBlob = (SharedBlob *)p;
+                    memset( pSharedBlob, 0, sizeof( SharedBlob ) );
+                    pSharedBlob->storageRef = storageRef;
+                    pSharedBlob->capacity = capacity;
+                    pSharedBlob->offset[0] = offset;
+                    pSharedBlob->offset[1] = offset + stride;
+                    pSharedBlob->len[0] = capacity;
+
+                    if ( value != NULL )
+                    {
+                        memcpy( (char *)p + offset, value, capacity );
+                    }
+
+                    /* publish the segment once it is initialized */
+                    __atomic_store_n( &pSharedBlob->magic,
+                                      SHARED_BLOB_MAGIC,
+                                      __ATOMIC_RELEASE );
+
+                    *ppSharedBlob = pSharedBlob;
+                }
+                else
+                {
+                    result = ENOMEM;
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SHAREDBLOBS_Value                                                         */
+/*!
+    Get the current value of a zero-copy blob
+
+    The SHAREDBLOBS_Value function gets a pointer to the buffer holding
+    the current value of the blob.  The pointer changes every time a
+    new value is committed.
+
+    @param[in]
+        pSharedBlob
+            pointer to the blob segment
+
+    @retval pointer to the current blob value
+    @retval NULL invalid arguments
+
+==============================================================================*/
+void *SHAREDBLOBS_Value( SharedBlob *pSharedBlob )
+{
+    void *p = NULL;
+
+    if ( pSharedBlob != NULL )
+    {
+        p = (char *)pSharedBlob +
+            pSharedBlob->offset[pSharedBlob->generation & 1];
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  SHAREDBLOBS_Write                                                         */
+/*!
+    Store a value into a zero-copy blob
+
+    The SHAREDBLOBS_Write function stores a blob value received via a
+    client working buffer.  It locks and fills the other buffer on
+    behalf of the server and commits it.  Any bytes beyond the new
+    value are carried over from the current value, just as they would
+    be for a blob held in the server heap.
+
+    @param[in]
+        pSharedBlob
+            pointer to the blob segment
+
+    @param[in]
+        value
+            pointer to the new value
+
+    @param[in]
+        len
+            length of the new value
+
+    @retval EOK the new value was committed
+    @retval EALREADY the blob already holds the value
+    @retval EBUSY a client is writing a new value
+    @retval E2BIG the value does not fit
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SHAREDBLOBS_Write( SharedBlob *pSharedBlob,
+                       const void *value,
+                       size_t len )
+{
+    int result = EINVAL;
+    char *pCurrent;
+    char *pNext;
+    uint64_t generation;
+    pid_t pid = getpid();
+
+    if ( ( pSharedBlob != NULL ) &&
+         ( value != NULL ) )
+    {
+        generation = pSharedBlob->generation;
+        pCurrent = (char *)pSharedBlob +
+                   pSharedBlob->offset[generation & 1];
+        pNext = (char *)pSharedBlob +
+                pSharedBlob->offset[( generation + 1 ) & 1];
+
+        if ( len > pSharedBlob->capacity )
+        {
+            result = E2BIG;
+        }
+        else if ( memcmp( pCurrent, value, len ) == 0 )
+        {
+            result = EALREADY;
+        }
+        else if ( SharedBlobLock( pSharedBlob, pid ) == EOK )
+        {
+            memcpy( pNext, value, len );
+            memcpy( &pNext[len],
+                    &pCurrent[len],
+                    pSharedBlob->capacity - len );
+
+            result = SHAREDBLOBS_Commit( pSharedBlob,
+                                         pid,
+                                         pSharedBlob->capacity );
+        }
+        else
+        {
+            result = EBUSY;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SHAREDBLOBS_Commit                                                        */
+/*!
+    Commit a new zero-copy blob value
+
+    The SHAREDBLOBS_Commit function makes the buffer written by the
+    writer holding the lock the current value of the blob, and releases
+    the lock.  Readers which started before the commit can continue to
+    use the previous buffer until the next writer locks it.
+
+    @param[in]
+        pSharedBlob
+            pointer to the blob segment
+
+    @param[in]
+        pid
+            process identifier of the writer
+
+    @param[in]
+        len
+            length of the new value
+
+    @retval EOK the new value was committed
+    @retval EPERM the writer does not hold the lock
+    @retval E2BIG the value is larger than the blob, and was discarded
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SHAREDBLOBS_Commit( SharedBlob *pSharedBlob, pid_t pid, size_t len )
+{
+    int result = EINVAL;
+    uint64_t generation;
+
+    if ( pSharedBlob != NULL )
+    {
+        if ( __atomic_load_n( &pSharedBlob->writer,
+                              __ATOMIC_ACQUIRE ) != pid )
+        {
+            result = EPERM;
+        }
+        else if ( len > pSharedBlob->capacity )
+        {
+            SharedBlobUnlock( pSharedBlob, pid );
+            result = E2BIG;
+        }
+        else
+        {
+            generation = pSharedBlob->generation + 1;
+            pSharedBlob->len[generation & 1] = len;
+
+            /* switch the readers to the new buffer */
+            __atomic_store_n( &pSharedBlob->generation,
+                              generation,
+                              __ATOMIC_RELEASE );
+
+            SharedBlobUnlock( pSharedBlob, pid );
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of sharedblobs group */
@@ -0,0 +1,337 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup sharedvalues sharedvalues
+ * @brief Shared memory variable value segment
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file sharedvalues.c
+
+    Shared Variable Values
+
+    The Shared Variable Values module publishes the values of selected
+    primitive (non-string, non-blob) variables in a read-only shared
+    memory segment ( /varserver_values ).  Clients which have been granted
+    access to a variable can read its value directly from the segment
+    without a round trip to the server.
+
+    The segment is only accessible to the server user, and only holds
+    variables without a read permission list, so the clients which can
+    map it are permitted to read every value it contains.
+
+    Each value is protected by a sequence counter.  The counter is
+    incremented to an odd value before the value is updated, and to
+    an even value after the update is complete.  Readers retry if they
+    observe an odd counter, or if the counter changed during their read.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <varserver/varclient.h>
+#include "sharedvalues.h"
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! pointer to the shared value segment */
+static SharedValues *pSharedValues = NULL;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SHAREDVALUES_Init                                                         */
+/*!
+    Create the shared variable value segment
+
+    The SHAREDVALUES_Init function creates the /varserver_values shared
+    memory object and maps it into the server's address space.
+
+    @param[in]
+        shard
+            shard index of the server, which is appended to the name
+            of the shared memory object
+
+    @retval EOK the shared value segment was created
+    @retval ENOMEM the shared value segment could not be mapped
+    @retval other error from shm_open or ftruncate
+
+==============================================================================*/
+int SHAREDVALUES_Init( int shard )
+{
+    int result = EINVAL;
+    int fd;
+    void *p;
+    char name[BUFSIZ];
+
+    /* get the name of the shared memory object for this shard */
+    ShardName( name, sizeof( name ), SERVER_SHAREDVALUES, shard );
+
+    /* get shared memory file descriptor (NOT a file) */
+    fd = shm_open( name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR );
+    if ( fd != -1 )
+    {
+        /* extend shared memory object as it is initialized with size 0 */
+        if ( ftruncate( fd, sizeof( SharedValues ) ) != -1 )
+        {
+            /* map shared memory to process address space */
+            p = mmap( NULL,
+                      sizeof( SharedValues ),
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED,
+                      fd,
+                      0 );
+            if ( p != MAP_FAILED )
+            {
+                /* discard any values left over from a previous server */
+                pSharedValues = (SharedValues *)p;
+                memset( pSharedValues, 0, sizeof( SharedValues ) );
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            result = errno;
+        }
+
+        /* close the file descriptor since we don't need it for anything */
+        close( fd );
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SHAREDVALUES_Alloc                                                        */
+/*!
+    Allocate a shared value slot
+
+    The SHAREDVALUES_Alloc function allocates a new slot in the shared
+    value segment and populates it with the specified variable value.
+
+    @param[in]
+        storageRef
+            storage reference of the variable which owns the slot
+
+    @param[in]
+        pVarObject
+            pointer to the variable value to publish
+
+    @param[out]
+        pSlot
+            pointer to a location to store the allocated slot number
+
+    @retval EOK the shared value slot was allocated
+    @retval ENOMEM no more shared value slots are available
+    @retval ENOTSUP the shared value segment is not available
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SHAREDVALUES_Alloc( uint32_t storageRef,
+                        VarObject *pVarObject,
+                        uint16_t *pSlot )
+{
+    int result = EINVAL;
+    uint32_t slot;
+
+    if ( ( pVarObject != NULL ) &&
+         ( pSlot != NULL ) )
+    {
+        if ( pSharedValues == NULL )
+        {
+            result = ENOTSUP;
+        }
+        else if ( pSharedValues->count + 1 >= VARSERVER_MAX_SHARED_VALUES )
+        {
+            result = ENOMEM;
+        }
+        else
+        {
+            /* slot 0 is reserved to indicate an unshared variable */
+            slot = ++(pSharedValues->count);
+            pSharedValues->values[slot].storageRef = storageRef;
+
+            SHAREDVALUES_Update( slot, pVarObject );
+
+            *pSlot = slot;
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SHAREDVALUES_Map                                                          */
+/*!
+    Map a variable handle to a shared value slot
+
+    The SHAREDVALUES_Map function publishes the mapping between a variable
+    handle and its shared value slot.  A slot of 0 removes the mapping
+    and forces clients to request the value from the server.
+
+    @param[in]
+        hVar
+            handle of the variable to map
+
+    @param[in]
+        slot
+            slot number to map the variable to
+
+    @retval EOK the mapping was published
+    @retval ENOTSUP the shared value segment is not available
+    @retval ERANGE the handle or slot is out of range
+
+==============================================================================*/
+int SHAREDVALUES_Map( VAR_HANDLE hVar, uint16_t slot )
+{
+    int result = ENOTSUP;
+
+    if ( pSharedValues != NULL )
+    {
+        if ( ( hVar < VARSERVER_MAX_SHARED_HANDLES ) &&
+             ( slot < VARSERVER_MAX_SHARED_VALUES ) )
+        {
+            __atomic_store_n( &pSharedValues->index[hVar],
+                              slot,
+                              __ATOMIC_RELEASE );
+            result = EOK;
+        }
+        else
+        {
+            result = ERANGE;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SHAREDVALUES_Update                                                       */
+/*!
+    Update a shared value
+
+    The SHAREDVALUES_Update function updates the value in the specified
+    shared value slot.  Readers observe an odd sequence number while
+    the update is in progress.
+
+    @param[in]
+        slot
+            slot number of the value to update
+
+    @param[in]
+        pVarObject
+            pointer to the new variable value
+
+==============================================================================*/
+void SHAREDVALUES_Update( uint16_t slot, VarObject *pVarObject )
+{
+    SharedValue *pSharedValue;
+    uint32_t seq;
+
+    if ( ( pSharedValues != NULL ) &&
+         ( pVarObject != NULL ) &&
+         ( slot != 0 ) &&
+         ( slot < VARSERVER_MAX_SHARED_VALUES ) )
+    {
+        pSharedValue = &pSharedValues->values[slot];
+
+        /* mark the value as being modified */
+        seq = pSharedValue->seq;
+        __atomic_store_n( &pSharedValue->seq, seq + 1, __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_RELEASE );
+
+        pSharedValue->type = pVarObject->type;
+        pSharedValue->len = pVarObject->len;
+        pSharedValue->val = pVarObject->val;
+
+        /* mark the value as stable */
+        __atomic_store_n( &pSharedValue->seq, seq + 2, __ATOMIC_RELEASE );
+    }
+}
+
+/*============================================================================*/
+/*  SHAREDVALUES_Disable                                                      */
+/*!
+    Disable direct reads of a shared value
+
+    The SHAREDVALUES_Disable function marks the value in the specified
+    shared value slot so clients will request it from the server instead.
+    This is used for variables which acquire a CALC handler.
+
+    @param[in]
+        slot
+            slot number of the value to disable
+
+==============================================================================*/
+void SHAREDVALUES_Disable( uint16_t slot )
+{
+    SharedValue *pSharedValue;
+    uint32_t seq;
+
+    if ( ( pSharedValues != NULL ) &&
+         ( slot != 0 ) &&
+         ( slot < VARSERVER_MAX_SHARED_VALUES ) )
+    {
+        pSharedValue = &pSharedValues->values[slot];
+
+        seq = pSharedValue->seq;
+        __atomic_store_n( &pSharedValue->seq, seq + 1, __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_RELEASE );
+
+        pSharedValue->type = VARTYPE_INVALID;
+
+        __atomic_store_n( &pSharedValue->seq, seq + 2, __ATOMIC_RELEASE );
+    }
+}
+
+/*! @}
+ * end of sharedvalues group */
@@ -0,0 +1,748 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup slab slab
+ * @brief Slab allocator for variable server objects
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file slab.c
+
+    Slab Allocator
+
+    The Slab Allocator provides fixed size object allocation for the
+    variable server's long lived objects (variable storage, aliases,
+    notification arrays, and string and blob values) to reduce heap
+    fragmentation and keep objects of the same kind close together.
+
+    Each size class carves its objects from slabs, and the slabs are
+    carved from large arenas which are backed by huge pages when they are
+    available.  Freed objects are kept on a per-class free list for reuse.
+    String and blob buffers are allocated from power-of-two size classes.
+    Objects which are too large for a slab are allocated from the heap.
+
+    The occupancy of each size class is published as a pair of
+    /varserver/stats/slab_<class>_used and /varserver/stats/slab_<class>_total
+    metrics.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include "slab.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! size of an arena mapping (one huge page) */
+#ifndef SLAB_ARENA_SIZE
+#define SLAB_ARENA_SIZE ( 2 * 1024 * 1024 )
+#endif
+
+/*! size of a slab carved from an arena */
+#ifndef SLAB_SIZE
+#define SLAB_SIZE ( 64 * 1024 )
+#endif
+
+/*! alignment of the objects in a slab */
+#define SLAB_ALIGN ( 16 )
+
+/*! smallest buffer size class */
+#define SLAB_MIN_BUFFER ( 16 )
+
+/*! largest buffer size class */
+#define SLAB_MAX_BUFFER ( 32 * 1024 )
+
+/*! number of power-of-two buffer size classes */
+#define SLAB_NUM_BUFFER_CLASSES ( 12 )
+
+/*! maximum number of size classes */
+#define SLAB_MAX_CLASSES ( 32 )
+
+/*! maximum length of a size class name */
+#define SLAB_MAX_NAME_LEN ( 32 )
+
+/*==============================================================================
+        Private types
+==============================================================================*/
+
+/*! a free object on a size class free list */
+typedef struct _SlabFree
+{
+    /*! pointer to the next free object */
+    struct _SlabFree *pNext;
+
+} SlabFree;
+
+/*! a slab allocator size class */
+struct _SlabClass
+{
+    /*! name of the size class */
+    char name[SLAB_MAX_NAME_LEN];
+
+    /*! size of each object in the class */
+    size_t size;
+
+    /*! next unused object in the current slab */
+    char *pNext;
+
+    /*! end of the current slab */
+    char *pEnd;
+
+    /*! list of freed objects */
+    SlabFree *pFree;
+
+    /*! number of objects in use */
+    uint64_t used;
+
+    /*! number of objects carved from slabs (or heap allocated) */
+    uint64_t total;
+
+    /*! pointer to the objects in use metric */
+    uint64_t *pUsed;
+
+    /*! pointer to the total objects metric */
+    uint64_t *pTotal;
+};
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static SlabClass *slab_NewClass( const char *name, size_t size );
+static SlabClass *slab_BufferClass( size_t len );
+static void *slab_NewSlab( void );
+static void slab_Update( SlabClass *pClass );
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! size classes */
+static SlabClass slabClasses[SLAB_MAX_CLASSES];
+
+/*! number of size classes */
+static size_t numSlabClasses = 0;
+
+/*! next unused slab in the current arena */
+static char *pArenaNext = NULL;
+
+/*! end of the current arena */
+static char *pArenaEnd = NULL;
+
+/*! number of arenas mapped */
+static uint64_t numArenas = 0;
+
+/*! number of arenas backed by huge pages */
+static uint64_t numHugeArenas = 0;
+
+/*! pointer to the arena count metric */
+static uint64_t *pArenaMetric = NULL;
+
+/*! pointer to the huge page arena count metric */
+static uint64_t *pHugeArenaMetric = NULL;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SLAB_Init                                                                 */
+/*!
+    Initialize the slab allocator
+
+    The SLAB_Init function creates the power-of-two buffer size classes
+    used for string and blob values.  It must be called before any
+    other slab allocator function.
+
+    @retval EOK the slab allocator was initialized
+    @retval ENOMEM too many size classes
+
+==============================================================================*/
+int SLAB_Init( void )
+{
+    int result = EOK;
+    char name[SLAB_MAX_NAME_LEN];
+    size_t size = SLAB_MIN_BUFFER;
+    size_t i;
+
+    if ( numSlabClasses == 0 )
+    {
+        for ( i = 0; i < SLAB_NUM_BUFFER_CLASSES; i++ )
+        {
+            snprintf( name, sizeof( name ), "buf%zu", size );
+            if ( slab_NewClass( name, size ) == NULL )
+            {
+                result = ENOMEM;
+            }
+
+            size <<= 1;
+        }
+
+        /* buffers which are too big for the buffer classes */
+        if ( slab_NewClass( "large", 0 ) == NULL )
+        {
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SLAB_Create                                                               */
+/*!
+    Create a fixed size object class
+
+    The SLAB_Create function creates a size class for objects of the
+    specified size.
+
+    @param[in]
+        name
+            name of the size class used for its metrics
+
+    @param[in]
+        size
+            size of the objects in the class
+
+    @retval pointer to the new size class
+    @retval NULL the size class could not be created
+
+==============================================================================*/
+SlabClass *SLAB_Create( const char *name, size_t size )
+{
+    SlabClass *pClass = NULL;
+
+    if ( ( name != NULL ) &&
+         ( size > 0 ) )
+    {
+        pClass = slab_NewClass( name, size );
+    }
+
+    return pClass;
+}
+
+/*============================================================================*/
+/*  SLAB_Alloc                                                                */
+/*!
+    Allocate an object from a size class
+
+    The SLAB_Alloc function allocates a zero filled object from the
+    specified size class.  The object is taken from the class free list
+    if possible, otherwise it is carved from the current slab.
+
+    @param[in]
+        pClass
+            pointer to the size class to allocate from
+
+    @retval pointer to the allocated object
+    @retval NULL memory allocation failure
+
+==============================================================================*/
+void *SLAB_Alloc( SlabClass *pClass )
+{
+    void *p = NULL;
+
+    if ( pClass != NULL )
+    {
+        if ( pClass->size > SLAB_SIZE )
+        {
+            /* too big for a slab */
+            p = calloc( 1, pClass->size );
+            if ( p != NULL )
+            {
+                pClass->total++;
+            }
+        }
+        else if ( pClass->pFree != NULL )
+        {
+            /* reuse a freed object */
+            p = pClass->pFree;
+            pClass->pFree = pClass->pFree->pNext;
+            memset( p, 0, pClass->size );
+        }
+        else
+        {
+            if ( (size_t)( pClass->pEnd - pClass->pNext ) < pClass->size )
+            {
+                /* start a new slab */
+                pClass->pNext = slab_NewSlab();
+                pClass->pEnd = ( pClass->pNext != NULL )
+                                ? pClass->pNext + SLAB_SIZE
+                                : NULL;
+            }
+
+            if ( pClass->pNext != NULL )
+            {
+                /* slab memory is zero filled when it is mapped */
+                p = pClass->pNext;
+                pClass->pNext += pClass->size;
+                pClass->total++;
+            }
+        }
+
+        if ( p != NULL )
+        {
+            pClass->used++;
+            slab_Update( pClass );
+        }
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  SLAB_Free                                                                 */
+/*!
+    Return an object to its size class
+
+    @param[in]
+        pClass
+            pointer to the size class the object was allocated from
+
+    @param[in]
+        p
+            pointer to the object to free
+
+==============================================================================*/
+void SLAB_Free( SlabClass *pClass, void *p )
+{
+    SlabFree *pFree = (SlabFree *)p;
+
+    if ( ( pClass != NULL ) &&
+         ( p != NULL ) )
+    {
+        if ( pClass->size > SLAB_SIZE )
+        {
+            free( p );
+            pClass->total--;
+        }
+        else
+        {
+            pFree->pNext = pClass->pFree;
+            pClass->pFree = pFree;
+        }
+
+        pClass->used--;
+        slab_Update( pClass );
+    }
+}
+
+/*============================================================================*/
+/*  SLAB_AllocBuffer                                                          */
+/*!
+    Allocate a string or blob buffer
+
+    The SLAB_AllocBuffer function allocates a zero filled buffer from the
+    smallest power-of-two size class which can hold the requested length.
+    Buffers larger than the largest buffer class are allocated from
+    the heap.
+
+    @param[in]
+        len
+            required length of the buffer
+
+    @retval pointer to the allocated buffer
+    @retval NULL memory allocation failure
+
+==============================================================================*/
+void *SLAB_AllocBuffer( size_t len )
+{
+    void *p = NULL;
+    SlabClass *pClass;
+
+    if ( len > 0 )
+    {
+        pClass = slab_BufferClass( len );
+        if ( ( pClass != NULL ) &&
+             ( pClass->size == 0 ) )
+        {
+            /* large buffer */
+            p = calloc( 1, len );
+            if ( p != NULL )
+            {
+                pClass->total++;
+                pClass->used++;
+                slab_Update( pClass );
+            }
+        }
+        else
+        {
+            p = SLAB_Alloc( pClass );
+        }
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  SLAB_FreeBuffer                                                           */
+/*!
+    Free a string or blob buffer
+
+    @param[in]
+        p
+            pointer to the buffer to free
+
+    @param[in]
+        len
+            length the buffer was allocated with
+
+==============================================================================*/
+void SLAB_FreeBuffer( void *p, size_t len )
+{
+    SlabClass *pClass;
+
+    if ( p != NULL )
+    {
+        pClass = slab_BufferClass( len );
+        if ( ( pClass != NULL ) &&
+             ( pClass->size == 0 ) )
+        {
+            free( p );
+            pClass->total--;
+            pClass->used--;
+            slab_Update( pClass );
+        }
+        else
+        {
+            SLAB_Free( pClass, p );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  SLAB_ResizeBuffer                                                         */
+/*!
+    Resize a string or blob buffer
+
+    The SLAB_ResizeBuffer function moves the contents of a buffer into a
+    buffer of the new length.  The buffer is only moved if the new length
+    needs a different size class.  Any added space is zero filled.
+
+    @param[in]
+        p
+            pointer to the buffer to resize, or NULL to allocate a new buffer
+
+    @param[in]
+        oldlen
+            length the buffer was allocated with
+
+    @param[in]
+        len
+            new length of the buffer
+
+    @retval pointer to the resized buffer
+    @retval NULL memory allocation failure, the original buffer is unchanged
+
+==============================================================================*/
+void *SLAB_ResizeBuffer( void *p, size_t oldlen, size_t len )
+{
+    void *pNew = NULL;
+    SlabClass *pOldClass;
+    SlabClass *pClass;
+
+    if ( p == NULL )
+    {
+        pNew = SLAB_AllocBuffer( len );
+    }
+    else
+    {
+        pOldClass = slab_BufferClass( oldlen );
+        pClass = slab_BufferClass( len );
+        if ( ( pClass == pOldClass ) &&
+             ( pClass != NULL ) &&
+             ( pClass->size != 0 ) )
+        {
+            /* the buffer already fits */
+            if ( len > oldlen )
+            {
+                memset( (char *)p + oldlen, 0, len - oldlen );
+            }
+
+            pNew = p;
+        }
+        else
+        {
+            pNew = SLAB_AllocBuffer( len );
+            if ( pNew != NULL )
+            {
+                memcpy( pNew, p, ( len < oldlen ) ? len : oldlen );
+                SLAB_FreeBuffer( p, oldlen );
+            }
+        }
+    }
+
+    return pNew;
+}
+
+/*============================================================================*/
+/*  SLAB_SetMetrics                                                           */
+/*!
+    Set up the slab allocator occupancy metrics
+
+    The SLAB_SetMetrics function creates the objects in use and total
+    objects metrics for each size class, and the arena metrics, using
+    the specified metric creation function.
+
+    @param[in]
+        fn
+            function used to create a metric
+
+==============================================================================*/
+void SLAB_SetMetrics( SlabMetricFn fn )
+{
+    char name[128];
+    SlabClass *pClass;
+    size_t n = numSlabClasses;
+    size_t i;
+
+    if ( fn != NULL )
+    {
+        pArenaMetric = fn( "/varserver/stats/slab_arenas" );
+        pHugeArenaMetric = fn( "/varserver/stats/slab_huge_arenas" );
+
+        /* creating the metrics may allocate objects, so only the size
+           classes which exist now get metrics */
+        for ( i = 0; i < n; i++ )
+        {
+            pClass = &slabClasses[i];
+
+            snprintf( name, sizeof( name ),
+                      "/varserver/stats/slab_%s_used",
+                      pClass->name );
+            pClass->pUsed = fn( name );
+
+            snprintf( name, sizeof( name ),
+                      "/varserver/stats/slab_%s_total",
+                      pClass->name );
+            pClass->pTotal = fn( name );
+        }
+
+        for ( i = 0; i < n; i++ )
+        {
+            slab_Update( &slabClasses[i] );
+        }
+
+        if ( pArenaMetric != NULL )
+        {
+            *pArenaMetric = numArenas;
+        }
+
+        if ( pHugeArenaMetric != NULL )
+        {
+            *pHugeArenaMetric = numHugeArenas;
+        }
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  slab_NewClass                                                             */
+/*!
+    Add a size class to the size class table
+
+    @param[in]
+        name
+            name of the size class
+
+    @param[in]
+        size
+            size of the objects in the class, 0 for heap allocated buffers
+
+    @retval pointer to the new size class
+    @retval NULL the size class table is full
+
+==============================================================================*/
+static SlabClass *slab_NewClass( const char *name, size_t size )
+{
+    SlabClass *pClass = NULL;
+
+    if ( numSlabClasses < SLAB_MAX_CLASSES )
+    {
+        pClass = &slabClasses[numSlabClasses++];
+        memset( pClass, 0, sizeof( SlabClass ) );
+
+        strncpy( pClass->name, name, SLAB_MAX_NAME_LEN - 1 );
+
+        /* round the object size up to the slab alignment so every object
+           is aligned and large enough to hold a free list link */
+        pClass->size = ( size + SLAB_ALIGN - 1 ) & ~( (size_t)SLAB_ALIGN - 1 );
+    }
+
+    return pClass;
+}
+
+/*============================================================================*/
+/*  slab_BufferClass                                                          */
+/*!
+    Get the buffer size class for a buffer length
+
+    @param[in]
+        len
+            length of the buffer
+
+    @retval pointer to the smallest buffer class which holds len bytes,
+            or the large buffer class
+    @retval NULL the slab allocator has not been initialized
+
+==============================================================================*/
+static SlabClass *slab_BufferClass( size_t len )
+{
+    SlabClass *pClass = NULL;
+    size_t size = SLAB_MIN_BUFFER;
+    size_t i = 0;
+
+    if ( numSlabClasses > SLAB_NUM_BUFFER_CLASSES )
+    {
+        while ( ( size < len ) && ( i < SLAB_NUM_BUFFER_CLASSES ) )
+        {
+            size <<= 1;
+            i++;
+        }
+
+        /* class SLAB_NUM_BUFFER_CLASSES is the large buffer class */
+        pClass = &slabClasses[i];
+    }
+
+    return pClass;
+}
+
+/*============================================================================*/
+/*  slab_NewSlab                                                              */
+/*!
+    Get a new slab from the current arena
+
+    The slab_NewSlab function carves a new slab from the current arena,
+    mapping a new arena when the current one is used up.  Arenas are
+    mapped with huge pages if they are available, otherwise transparent
+    huge pages are requested for the mapping.
+
+    @retval pointer to the new zero filled slab
+    @retval NULL a new arena could not be mapped
+
+==============================================================================*/
+static void *slab_NewSlab( void )
+{
+    void *p = NULL;
+    void *pArena;
+    bool huge = true;
+
+    if ( (size_t)( pArenaEnd - pArenaNext ) < SLAB_SIZE )
+    {
+        pArena = mmap( NULL,
+                       SLAB_ARENA_SIZE,
+                       PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB,
+                       -1,
+                       0 );
+        if ( pArena == MAP_FAILED )
+        {
+            huge = false;
+            pArena = mmap( NULL,
+                           SLAB_ARENA_SIZE,
+                           PROT_READ | PROT_WRITE,
+                           MAP_PRIVATE | MAP_ANONYMOUS,
+                           -1,
+                           0 );
+            if ( pArena != MAP_FAILED )
+            {
+                /* transparent huge pages are a hint, ignore failures */
+                (void)madvise( pArena, SLAB_ARENA_SIZE, MADV_HUGEPAGE );
+            }
+        }
+
+        if ( pArena != MAP_FAILED )
+        {
+            pArenaNext = pArena;
+            pArenaEnd = pArenaNext + SLAB_ARENA_SIZE;
+
+            numArenas++;
+            if ( huge == true )
+            {
+                numHugeArenas++;
+            }
+
+            if ( pArenaMetric != NULL )
+            {
+                *pArenaMetric = numArenas;
+            }
+
+            if ( pHugeArenaMetric != NULL )
+            {
+                *pHugeArenaMetric = numHugeArenas;
+            }
+        }
+    }
+
+    if ( (size_t)( pArenaEnd - pArenaNext ) >= SLAB_SIZE )
+    {
+        p = pArenaNext;
+        pArenaNext += SLAB_SIZE;
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  slab_Update                                                               */
+/*!
+    Update the occupancy metrics of a size class
+
+    @param[in]
+        pClass
+            pointer to the size class
+
+==============================================================================*/
+static void slab_Update( SlabClass *pClass )
+{
+    if ( pClass->pUsed != NULL )
+    {
+        *pClass->pUsed = pClass->used;
+    }
+
+    if ( pClass->pTotal != NULL )
+    {
+        *pClass->pTotal = pClass->total;
+    }
+}
+
+/*! @}
+ * end of slab group */
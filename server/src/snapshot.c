@@ -0,0 +1,1272 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup snapshot snapshot
+ * @brief Binary snapshot and restore of the variable store
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file snapshot.c
+
+    Variable Store Snapshots
+
+    The Variable Store Snapshot functions write the definitions and values
+    of the variables to a compact versioned binary file, and restore them
+    from that file when the server starts, so a large set of variables can
+    be recreated in a single pass rather than one client request at a time.
+
+    A snapshot file consists of a SnapshotHeader followed by a sequence of
+    variable length records.  Each record has a fixed SnapshotRecord part
+    containing the variable definition, flags, permissions and numeric
+    value, followed by the NUL terminated name, alias target name and tag
+    specification, and the string or blob data.  Records are padded to a
+    multiple of 8 bytes so the file can be read in place from a memory
+    mapping.
+
+    Variables which share storage with a variable already in the snapshot
+    are written as alias records.  The server's own /varserver/ variables
+    are never saved since they are created when the server starts.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <varserver/var.h>
+#include <varserver/varserver.h>
+#include <varserver/varclient.h>
+#include "varlist.h"
+#include "snapshot.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! name prefix of the variables created by the server itself */
+#define SNAPSHOT_SERVER_PREFIX "/varserver/"
+
+/*! marks variable storage which was not saved in the snapshot */
+#define SNAPSHOT_NOT_SAVED ( (VAR_HANDLE)~0U )
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int snapshot_SaveVar( FILE *fp,
+                             VAR_HANDLE hVar,
+                             uint32_t options,
+                             VAR_HANDLE *pSaved,
+                             size_t n,
+                             SnapshotHeader *pHeader );
+
+static int snapshot_SaveDefinition( FILE *fp,
+                                    const VarInfo *pVarInfo,
+                                    const VarObject *pVarObject,
+                                    SnapshotHeader *pHeader );
+
+static int snapshot_SaveAlias( FILE *fp,
+                               const VarInfo *pVarInfo,
+                               VAR_HANDLE hTarget,
+                               SnapshotHeader *pHeader );
+
+static bool snapshot_IsServerVar( const char *name );
+
+static int snapshot_Write( FILE *fp,
+                           const void *p,
+                           size_t len,
+                           SnapshotHeader *pHeader );
+
+static int snapshot_WriteRecord( FILE *fp,
+                                 SnapshotRecord *pRecord,
+                                 const char *name,
+                                 const char *target,
+                                 const char *tagspec,
+                                 const void *data,
+                                 SnapshotHeader *pHeader );
+
+static int snapshot_LoadRecords( const char *p,
+                                 const SnapshotHeader *pHeader,
+                                 size_t *pCount );
+
+static bool snapshot_ValidRecord( const SnapshotRecord *pRecord, size_t len );
+
+static int snapshot_Restore( const SnapshotRecord *pRecord );
+
+static void snapshot_SetCreds( VarInfo *pVarInfo );
+
+static uint32_t snapshot_Checksum( uint32_t hash,
+                                   const void *p,
+                                   size_t len );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  SNAPSHOT_Save                                                             */
+/*!
+    Write a snapshot of the variable store
+
+    The SNAPSHOT_Save function writes the variables to a snapshot file.
+    The snapshot is written to a temporary file which replaces the
+    specified file once it is complete, so an interrupted snapshot
+    never leaves a partial file behind.
+
+    @param[in]
+        path
+            path of the snapshot file
+
+    @param[in]
+        options
+            VAR_SNAPSHOT_DIRTY to only save the non-volatile variables
+            with the dirty flag set
+
+    @param[out]
+        pCount
+            optional pointer to a location to store the number of
+            records written
+
+    @retval EOK the snapshot was written
+    @retval ENOMEM memory allocation failure
+    @retval ENAMETOOLONG the path is too long
+    @retval EINVAL invalid arguments
+    @retval other error writing the snapshot file
+
+==============================================================================*/
+int SNAPSHOT_Save( const char *path, uint32_t options, size_t *pCount )
+{
+    int result = EINVAL;
+    char tmp[PATH_MAX];
+    FILE *fp = NULL;
+
+    if ( path != NULL )
+    {
+        if ( snprintf( tmp, sizeof( tmp ), "%s.tmp", path )
+                >= (int)sizeof( tmp ) )
+        {
+            result = ENAMETOOLONG;
+        }
+        else
+        {
+            fp = fopen( tmp, "wb" );
+            result = ( fp != NULL ) ? EOK : errno;
+        }
+
+        if ( result == EOK )
+        {
+            result = SNAPSHOT_Write( fp, options, pCount );
+            if ( ( result == EOK ) &&
+                 ( ( fflush( fp ) != 0 ) ||
+                   ( fsync( fileno( fp ) ) != 0 ) ) )
+            {
+                result = EIO;
+            }
+
+            if ( ( fclose( fp ) != 0 ) && ( result == EOK ) )
+            {
+                result = EIO;
+            }
+
+            if ( ( result == EOK ) &&
+                 ( rename( tmp, path ) != 0 ) )
+            {
+                result = errno;
+            }
+
+            if ( result != EOK )
+            {
+                unlink( tmp );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SNAPSHOT_Write                                                            */
+/*!
+    Write a snapshot image to a stream
+
+    The SNAPSHOT_Write function writes the snapshot header and records
+    at the current position of the specified stream, so a snapshot
+    image can be embedded in a larger file.  The header is completed
+    once the records are written, and the stream is left positioned
+    after the last record.
+
+    @param[in]
+        fp
+            snapshot output stream
+
+    @param[in]
+        options
+            VAR_SNAPSHOT_DIRTY to only save the non-volatile variables
+            with the dirty flag set
+
+    @param[out]
+        pCount
+            optional pointer to a location to store the number of
+            records written
+
+    @retval EOK the snapshot image was written
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+    @retval EIO error writing the snapshot image
+
+==============================================================================*/
+int SNAPSHOT_Write( FILE *fp, uint32_t options, size_t *pCount )
+{
+    int result = EINVAL;
+    SnapshotHeader header;
+    VAR_HANDLE *pSaved = NULL;
+    VAR_HANDLE hVar;
+    long start;
+    size_t n;
+
+    if ( fp != NULL )
+    {
+        /* variable storage saved in the snapshot, by storage reference */
+        n = VARLIST_Count();
+        pSaved = calloc( n + 1, sizeof( VAR_HANDLE ) );
+        start = ftell( fp );
+
+        if ( pSaved == NULL )
+        {
+            result = ENOMEM;
+        }
+        else
+        {
+            result = ( start != -1 ) ? EOK : EIO;
+        }
+
+        if ( result == EOK )
+        {
+            memset( &header, 0, sizeof( SnapshotHeader ) );
+            header.magic = SNAPSHOT_MAGIC;
+            header.version = SNAPSHOT_VERSION;
+            header.headerSize = sizeof( SnapshotHeader );
+            header.checksum = SNAPSHOT_FNV_OFFSET;
+
+            /* reserve space for the header */
+            if ( fwrite( &header, sizeof( header ), 1, fp ) != 1 )
+            {
+                result = EIO;
+            }
+
+            for ( hVar = 1; ( hVar <= n ) && ( result == EOK ); hVar++ )
+            {
+                result = snapshot_SaveVar( fp,
+                                           hVar,
+                                           options,
+                                           pSaved,
+                                           n,
+                                           &header );
+            }
+
+            /* write the completed header, and move back to the end */
+            if ( ( result == EOK ) &&
+                 ( ( fseek( fp, start, SEEK_SET ) != 0 ) ||
+                   ( fwrite( &header, sizeof( header ), 1, fp ) != 1 ) ||
+                   ( fseek( fp, 0, SEEK_END ) != 0 ) ) )
+            {
+                result = EIO;
+            }
+
+            if ( ( result == EOK ) &&
+                 ( pCount != NULL ) )
+            {
+                *pCount = header.count;
+            }
+        }
+
+        free( pSaved );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SNAPSHOT_Load                                                             */
+/*!
+    Restore the variable store from a snapshot
+
+    The SNAPSHOT_Load function maps the specified snapshot file and
+    creates its variables and aliases in a single pass.  Variables
+    which already exist are left unchanged.  The restored variables
+    do not have the dirty flag set.
+
+    @param[in]
+        path
+            path of the snapshot file
+
+    @param[out]
+        pCount
+            optional pointer to a location to store the number of
+            variables and aliases restored
+
+    @retval EOK the snapshot was restored
+    @retval EBADMSG the snapshot file is corrupt
+    @retval ENOTSUP the snapshot file version is not supported
+    @retval EINVAL invalid arguments
+    @retval other error reading the snapshot file
+
+==============================================================================*/
+int SNAPSHOT_Load( const char *path, size_t *pCount )
+{
+    int result = EINVAL;
+    int fd;
+    struct stat sb;
+    void *p = MAP_FAILED;
+
+    if ( path != NULL )
+    {
+        fd = open( path, O_RDONLY | O_CLOEXEC );
+        if ( fd == -1 )
+        {
+            result = errno;
+        }
+        else
+        {
+            if ( fstat( fd, &sb ) != 0 )
+            {
+                result = errno;
+            }
+            else if ( (size_t)sb.st_size < sizeof( SnapshotHeader ) )
+            {
+                result = EBADMSG;
+            }
+            else
+            {
+                p = mmap( NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+                result = ( p != MAP_FAILED ) ? EOK : errno;
+            }
+
+            close( fd );
+        }
+
+        if ( result == EOK )
+        {
+            madvise( p, sb.st_size, MADV_SEQUENTIAL );
+            result = SNAPSHOT_LoadImage( p, sb.st_size, pCount );
+            munmap( p, sb.st_size );
+        }
+        else if ( pCount != NULL )
+        {
+            *pCount = 0;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SNAPSHOT_LoadImage                                                        */
+/*!
+    Restore the variable store from a snapshot image in memory
+
+    The SNAPSHOT_LoadImage function validates a snapshot image which
+    has already been mapped or read into memory, and creates its
+    variables and aliases in a single pass.  Variables which already
+    exist are left unchanged.  The restored variables do not have the
+    dirty flag set.
+
+    @param[in]
+        p
+            pointer to the snapshot image
+
+    @param[in]
+        len
+            length of the snapshot image
+
+    @param[out]
+        pCount
+            optional pointer to a location to store the number of
+            variables and aliases restored
+
+    @retval EOK the snapshot was restored
+    @retval EBADMSG the snapshot image is corrupt
+    @retval ENOTSUP the snapshot image version is not supported
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int SNAPSHOT_LoadImage( const void *p, size_t len, size_t *pCount )
+{
+    int result = EINVAL;
+    const SnapshotHeader *pHeader = p;
+    size_t count = 0;
+
+    if ( p != NULL )
+    {
+        if ( ( len < sizeof( SnapshotHeader ) ) ||
+             ( pHeader->magic != SNAPSHOT_MAGIC ) )
+        {
+            result = EBADMSG;
+        }
+        else if ( ( pHeader->version != SNAPSHOT_VERSION ) ||
+                  ( pHeader->headerSize != sizeof( SnapshotHeader ) ) )
+        {
+            result = ENOTSUP;
+        }
+        else if ( ( pHeader->length != len - sizeof( SnapshotHeader ) ) ||
+                  ( snapshot_Checksum( SNAPSHOT_FNV_OFFSET,
+                                       &pHeader[1],
+                                       pHeader->length )
+                        != pHeader->checksum ) )
+        {
+            result = EBADMSG;
+        }
+        else
+        {
+            result = snapshot_LoadRecords( (const char *)&pHeader[1],
+                                           pHeader,
+                                           &count );
+        }
+    }
+
+    if ( pCount != NULL )
+    {
+        *pCount = count;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SNAPSHOT_WriteDefinition                                                  */
+/*!
+    Write the definition of a single variable
+
+    The SNAPSHOT_WriteDefinition function writes a single snapshot
+    record, without a snapshot header, which defines the specified
+    variable, or the specified alias of another variable.  Nothing is
+    written for the server's own variables.  The record is restored
+    with SNAPSHOT_LoadRecord.
+
+    @param[in]
+        fp
+            output stream
+
+    @param[in]
+        hVar
+            handle of the variable or alias to write
+
+    @param[in]
+        hTarget
+            handle of the aliased variable, or VAR_INVALID to write
+            a variable definition
+
+    @retval EOK the record was written, or the variable was skipped
+    @retval ENOENT the variable does not exist
+    @retval EINVAL invalid arguments
+    @retval EIO error writing the record
+
+==============================================================================*/
+int SNAPSHOT_WriteDefinition( FILE *fp, VAR_HANDLE hVar, VAR_HANDLE hTarget )
+{
+    int result = EINVAL;
+    SnapshotHeader header;
+    VarInfo info;
+    const VarObject *pVarObject;
+
+    if ( fp != NULL )
+    {
+        memset( &header, 0, sizeof( SnapshotHeader ) );
+        memset( &info, 0, sizeof( VarInfo ) );
+        info.hVar = hVar;
+        snapshot_SetCreds( &info );
+
+        pVarObject = VARLIST_PeekObj( hVar );
+        if ( ( pVarObject == NULL ) ||
+             ( VARLIST_GetInfo( &info ) != EOK ) )
+        {
+            result = ENOENT;
+        }
+        else if ( snapshot_IsServerVar( info.name ) == true )
+        {
+            result = EOK;
+        }
+        else if ( hTarget == VAR_INVALID )
+        {
+            result = snapshot_SaveDefinition( fp, &info, pVarObject, &header );
+        }
+        else
+        {
+            result = snapshot_SaveAlias( fp, &info, hTarget, &header );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SNAPSHOT_LoadRecord                                                       */
+/*!
+    Restore a single snapshot record
+
+    The SNAPSHOT_LoadRecord function validates a record written by
+    SNAPSHOT_WriteDefinition and creates its variable or alias.
+
+    @param[in]
+        p
+            pointer to the record.  It must be aligned to SNAPSHOT_ALIGN
+
+    @param[in]
+        len
+            number of bytes available at p
+
+    @retval EOK the variable or alias was created
+    @retval EBADMSG the record is corrupt
+    @retval EINVAL invalid arguments
+    @retval other the variable or alias could not be created
+
+==============================================================================*/
+int SNAPSHOT_LoadRecord( const void *p, size_t len )
+{
+    int result = EINVAL;
+
+    if ( p != NULL )
+    {
+        result = ( snapshot_ValidRecord( p, len ) == true )
+                    ? snapshot_Restore( p )
+                    : EBADMSG;
+    }
+
+    return result;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  snapshot_SaveVar                                                          */
+/*!
+    Write a variable to the snapshot
+
+    The snapshot_SaveVar function writes a variable definition record,
+    or an alias record if the variable's storage has already been
+    saved.  Variables which do not match the snapshot options, and the
+    server's own variables, are skipped.
+
+    @param[in]
+        fp
+            snapshot output stream
+
+    @param[in]
+        hVar
+            handle of the variable to save
+
+    @param[in]
+        options
+            snapshot options
+
+    @param[in,out]
+        pSaved
+            handles of the saved variables indexed by storage reference
+
+    @param[in]
+        n
+            number of entries in the pSaved array (less one)
+
+    @param[in,out]
+        pHeader
+            pointer to the snapshot header to update
+
+    @retval EOK the variable was saved or skipped
+    @retval other error writing the snapshot file
+
+==============================================================================*/
+static int snapshot_SaveVar( FILE *fp,
+                             VAR_HANDLE hVar,
+                             uint32_t options,
+                             VAR_HANDLE *pSaved,
+                             size_t n,
+                             SnapshotHeader *pHeader )
+{
+    int result = EOK;
+    VarInfo info;
+    const VarObject *pVarObject;
+
+    memset( &info, 0, sizeof( VarInfo ) );
+    info.hVar = hVar;
+    snapshot_SetCreds( &info );
+
+    pVarObject = VARLIST_PeekObj( hVar );
+
+    if ( ( pVarObject != NULL ) &&
+         ( VARLIST_GetInfo( &info ) == EOK ) &&
+         ( info.storageRef <= n ) &&
+         ( snapshot_IsServerVar( info.name ) == false ) )
+    {
+        if ( pSaved[info.storageRef] == VAR_INVALID )
+        {
+            if ( ( options & VAR_SNAPSHOT_DIRTY ) &&
+                 ( ( ( info.flags & VARFLAG_DIRTY ) == 0 ) ||
+                   ( info.flags & VARFLAG_VOLATILE ) ) )
+            {
+                /* not selected for the snapshot */
+                pSaved[info.storageRef] = SNAPSHOT_NOT_SAVED;
+            }
+            else
+            {
+                result = snapshot_SaveDefinition( fp,
+                                                  &info,
+                                                  pVarObject,
+                                                  pHeader );
+
+                pSaved[info.storageRef] = hVar;
+            }
+        }
+        else if ( pSaved[info.storageRef] != SNAPSHOT_NOT_SAVED )
+        {
+            /* the storage is already saved, so this is an alias */
+            result = snapshot_SaveAlias( fp,
+                                         &info,
+                                         pSaved[info.storageRef],
+                                         pHeader );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  snapshot_SaveDefinition                                                   */
+/*!
+    Write a variable definition record
+
+    The snapshot_SaveDefinition function writes a record holding the
+    definition and the value of a variable.
+
+    @param[in]
+        fp
+            snapshot output stream
+
+    @param[in]
+        pVarInfo
+            pointer to the information of the variable
+
+    @param[in]
+        pVarObject
+            pointer to the value of the variable
+
+    @param[in,out]
+        pHeader
+            pointer to the snapshot header to update
+
+    @retval EOK the record was written
+    @retval EIO error writing the snapshot file
+
+==============================================================================*/
+static int snapshot_SaveDefinition( FILE *fp,
+                                    const VarInfo *pVarInfo,
+                                    const VarObject *pVarObject,
+                                    SnapshotHeader *pHeader )
+{
+    SnapshotRecord record;
+    const void *data = NULL;
+    size_t i;
+
+    memset( &record, 0, sizeof( SnapshotRecord ) );
+    record.instanceID = pVarInfo->instanceID;
+    record.guid = pVarInfo->guid;
+    record.kind = SNAPSHOT_RECORD_VAR;
+    record.type = pVarObject->type;
+    record.flags = pVarInfo->flags;
+    record.len = pVarObject->len;
+    memcpy( record.formatspec, pVarInfo->formatspec, MAX_FORMATSPEC_LEN );
+    record.formatspec[MAX_FORMATSPEC_LEN - 1] = 0;
+
+    record.nreads = pVarInfo->permissions.nreads;
+    record.nwrites = pVarInfo->permissions.nwrites;
+    for ( i = 0; i < VARSERVER_MAX_UIDS; i++ )
+    {
+        record.read[i] = pVarInfo->permissions.read[i];
+        record.write[i] = pVarInfo->permissions.write[i];
+    }
+
+    if ( pVarObject->type == VARTYPE_STR )
+    {
+        data = pVarObject->val.str;
+        record.dataLen = ( data != NULL )
+                         ? strnlen( data, pVarObject->len ) + 1
+                         : 0;
+    }
+    else if ( pVarObject->type == VARTYPE_BLOB )
+    {
+        data = pVarObject->val.blob;
+        record.dataLen = ( data != NULL ) ? pVarObject->len : 0;
+    }
+    else
+    {
+        memcpy( &record.value, &pVarObject->val, sizeof( record.value ) );
+    }
+
+    return snapshot_WriteRecord( fp,
+                                 &record,
+                                 pVarInfo->name,
+                                 "",
+                                 pVarInfo->tagspec,
+                                 data,
+                                 pHeader );
+}
+
+/*============================================================================*/
+/*  snapshot_SaveAlias                                                        */
+/*!
+    Write a variable alias record
+
+    The snapshot_SaveAlias function writes a record which makes a
+    variable an alias of another variable.
+
+    @param[in]
+        fp
+            snapshot output stream
+
+    @param[in]
+        pVarInfo
+            pointer to the information of the alias
+
+    @param[in]
+        hTarget
+            handle of the aliased variable
+
+    @param[in,out]
+        pHeader
+            pointer to the snapshot header to update
+
+    @retval EOK the record was written, or the target was not found
+    @retval EIO error writing the snapshot file
+
+==============================================================================*/
+static int snapshot_SaveAlias( FILE *fp,
+                               const VarInfo *pVarInfo,
+                               VAR_HANDLE hTarget,
+                               SnapshotHeader *pHeader )
+{
+    int result = EOK;
+    SnapshotRecord record;
+    VarInfo target;
+
+    memset( &target, 0, sizeof( VarInfo ) );
+    target.hVar = hTarget;
+    snapshot_SetCreds( &target );
+
+    if ( VARLIST_GetInfo( &target ) == EOK )
+    {
+        memset( &record, 0, sizeof( SnapshotRecord ) );
+        record.instanceID = pVarInfo->instanceID;
+        record.guid = pVarInfo->guid;
+        record.kind = SNAPSHOT_RECORD_ALIAS;
+        record.targetInstanceID = target.instanceID;
+        result = snapshot_WriteRecord( fp,
+                                       &record,
+                                       pVarInfo->name,
+                                       target.name,
+                                       "",
+                                       NULL,
+                                       pHeader );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  snapshot_IsServerVar                                                      */
+/*!
+    Check if a variable belongs to the server
+
+    The snapshot_IsServerVar function checks if a variable name is one
+    of the server's own /varserver/ variables, which are never saved.
+
+    @param[in]
+        name
+            name of the variable
+
+    @retval true the variable belongs to the server
+    @retval false the variable does not belong to the server
+
+==============================================================================*/
+static bool snapshot_IsServerVar( const char *name )
+{
+    return ( strncmp( name,
+                      SNAPSHOT_SERVER_PREFIX,
+                      sizeof( SNAPSHOT_SERVER_PREFIX ) - 1 ) == 0 );
+}
+
+/*============================================================================*/
+/*  snapshot_WriteRecord                                                      */
+/*!
+    Write a record to the snapshot
+
+    The snapshot_WriteRecord function completes the record lengths and
+    writes the fixed record part, the strings, the data and the padding
+    to the snapshot file.
+
+    @param[in]
+        fp
+            snapshot output stream
+
+    @param[in,out]
+        pRecord
+            pointer to the record to write.  The data length must be set.
+
+    @param[in]
+        name
+            variable name
+
+    @param[in]
+        target
+            alias target name (empty for a variable record)
+
+    @param[in]
+        tagspec
+            variable tag specification
+
+    @param[in]
+        data
+            string or blob data (may be NULL)
+
+    @param[in,out]
+        pHeader
+            pointer to the snapshot header to update
+
+    @retval EOK the record was written
+    @retval EIO error writing the snapshot file
+
+==============================================================================*/
+static int snapshot_WriteRecord( FILE *fp,
+                                 SnapshotRecord *pRecord,
+                                 const char *name,
+                                 const char *target,
+                                 const char *tagspec,
+                                 const void *data,
+                                 SnapshotHeader *pHeader )
+{
+    int result;
+    static const char padding[SNAPSHOT_ALIGN] = {0};
+    size_t length;
+
+    pRecord->nameLen = strlen( name ) + 1;
+    pRecord->targetLen = strlen( target ) + 1;
+    pRecord->tagspecLen = strlen( tagspec ) + 1;
+
+    length = sizeof( SnapshotRecord ) +
+             pRecord->nameLen +
+             pRecord->targetLen +
+             pRecord->tagspecLen +
+             pRecord->dataLen;
+
+    pRecord->length = ( length + SNAPSHOT_ALIGN - 1 ) & ~( SNAPSHOT_ALIGN - 1 );
+
+    result = snapshot_Write( fp, pRecord, sizeof( SnapshotRecord ), pHeader );
+    if ( result == EOK )
+    {
+        result = snapshot_Write( fp, name, pRecord->nameLen, pHeader );
+    }
+
+    if ( result == EOK )
+    {
+        result = snapshot_Write( fp, target, pRecord->targetLen, pHeader );
+    }
+
+    if ( result == EOK )
+    {
+        result = snapshot_Write( fp, tagspec, pRecord->tagspecLen, pHeader );
+    }
+
+    if ( ( result == EOK ) &&
+         ( pRecord->dataLen > 0 ) )
+    {
+        result = snapshot_Write( fp, data, pRecord->dataLen, pHeader );
+    }
+
+    if ( result == EOK )
+    {
+        result = snapshot_Write( fp,
+                                 padding,
+                                 pRecord->length - length,
+                                 pHeader );
+    }
+
+    if ( result == EOK )
+    {
+        pHeader->count++;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  snapshot_Write                                                            */
+/*!
+    Write data to the snapshot
+
+    The snapshot_Write function writes data to the snapshot file and
+    adds it to the snapshot length and checksum.
+
+    @param[in]
+        fp
+            snapshot output stream
+
+    @param[in]
+        p
+            pointer to the data to write
+
+    @param[in]
+        len
+            number of bytes to write
+
+    @param[in,out]
+        pHeader
+            pointer to the snapshot header to update
+
+    @retval EOK the data was written
+    @retval EIO error writing the snapshot file
+
+==============================================================================*/
+static int snapshot_Write( FILE *fp,
+                           const void *p,
+                           size_t len,
+                           SnapshotHeader *pHeader )
+{
+    int result = EOK;
+
+    if ( len > 0 )
+    {
+        if ( fwrite( p, len, 1, fp ) == 1 )
+        {
+            pHeader->length += len;
+            pHeader->checksum = snapshot_Checksum( pHeader->checksum, p, len );
+        }
+        else
+        {
+            result = EIO;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  snapshot_LoadRecords                                                      */
+/*!
+    Restore the snapshot records
+
+    The snapshot_LoadRecords function validates each snapshot record
+    and restores its variable or alias.
+
+    @param[in]
+        p
+            pointer to the first record
+
+    @param[in]
+        pHeader
+            pointer to the snapshot header
+
+    @param[out]
+        pCount
+            pointer to a location to store the number of records restored
+
+    @retval EOK the records were restored
+    @retval EBADMSG a record is corrupt
+
+==============================================================================*/
+static int snapshot_LoadRecords( const char *p,
+                                 const SnapshotHeader *pHeader,
+                                 size_t *pCount )
+{
+    int result = EOK;
+    const SnapshotRecord *pRecord;
+    size_t offset = 0;
+    uint32_t i;
+
+    for ( i = 0; ( i < pHeader->count ) && ( result == EOK ); i++ )
+    {
+        pRecord = (const SnapshotRecord *)&p[offset];
+        if ( snapshot_ValidRecord( pRecord, pHeader->length - offset ) )
+        {
+            if ( snapshot_Restore( pRecord ) == EOK )
+            {
+                (*pCount)++;
+            }
+
+            offset += pRecord->length;
+        }
+        else
+        {
+            result = EBADMSG;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  snapshot_ValidRecord                                                      */
+/*!
+    Check a snapshot record
+
+    The snapshot_ValidRecord function checks that a snapshot record, and
+    each of its strings, is complete.
+
+    @param[in]
+        pRecord
+            pointer to the record
+
+    @param[in]
+        len
+            number of bytes remaining in the snapshot
+
+    @retval true the record is valid
+    @retval false the record is truncated or corrupt
+
+==============================================================================*/
+static bool snapshot_ValidRecord( const SnapshotRecord *pRecord, size_t len )
+{
+    bool result = false;
+    const char *name;
+    size_t length;
+
+    if ( len >= sizeof( SnapshotRecord ) )
+    {
+        length = sizeof( SnapshotRecord ) +
+                 pRecord->nameLen +
+                 pRecord->targetLen +
+                 pRecord->tagspecLen +
+                 (size_t)pRecord->dataLen;
+
+        name = (const char *)&pRecord[1];
+
+        result = ( pRecord->length >= length ) &&
+                 ( pRecord->length <= len ) &&
+                 ( ( pRecord->length % SNAPSHOT_ALIGN ) == 0 ) &&
+                 ( pRecord->nameLen > 0 ) &&
+                 ( pRecord->targetLen > 0 ) &&
+                 ( pRecord->tagspecLen > 0 ) &&
+                 ( name[pRecord->nameLen - 1] == 0 ) &&
+                 ( name[pRecord->nameLen + pRecord->targetLen - 1] == 0 ) &&
+                 ( name[pRecord->nameLen +
+                        pRecord->targetLen +
+                        pRecord->tagspecLen - 1] == 0 );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  snapshot_Restore                                                          */
+/*!
+    Restore a snapshot record
+
+    The snapshot_Restore function creates the variable or alias
+    described by a snapshot record.
+
+    @param[in]
+        pRecord
+            pointer to a validated snapshot record
+
+    @retval EOK the variable or alias was created
+    @retval EEXIST the variable already exists
+    @retval EBADMSG the record contents are not valid
+    @retval other the variable or alias could not be created
+
+==============================================================================*/
+static int snapshot_Restore( const SnapshotRecord *pRecord )
+{
+    int result = EBADMSG;
+    VarInfo info;
+    VarInfo target;
+    VAR_HANDLE hVar;
+    const char *name = (const char *)&pRecord[1];
+    const char *targetName = &name[pRecord->nameLen];
+    const char *tagspec = &targetName[pRecord->targetLen];
+    const char *data = &tagspec[pRecord->tagspecLen];
+    size_t i;
+
+    memset( &info, 0, sizeof( VarInfo ) );
+    snapshot_SetCreds( &info );
+    strncpy( info.name, name, MAX_NAME_LEN );
+    info.instanceID = pRecord->instanceID;
+    info.guid = pRecord->guid;
+
+    if ( pRecord->kind == SNAPSHOT_RECORD_ALIAS )
+    {
+        /* find the alias target */
+        memset( &target, 0, sizeof( VarInfo ) );
+        snapshot_SetCreds( &target );
+        strncpy( target.name, targetName, MAX_NAME_LEN );
+        target.instanceID = pRecord->targetInstanceID;
+
+        result = VARLIST_Find( &target, &info.hVar );
+        if ( result == EOK )
+        {
+            result = VARLIST_Alias( &info, &hVar );
+        }
+    }
+    else if ( ( pRecord->kind == SNAPSHOT_RECORD_VAR ) &&
+              ( pRecord->type > VARTYPE_INVALID ) &&
+              ( pRecord->type < VARTYPE_END_MARKER ) &&
+              ( pRecord->nreads <= VARSERVER_MAX_UIDS ) &&
+              ( pRecord->nwrites <= VARSERVER_MAX_UIDS ) )
+    {
+        /* the restored values match the snapshot, so they are not dirty,
+           and the alias flag is set again when the aliases are restored */
+        info.flags = pRecord->flags & ~( VARFLAG_DIRTY | VARFLAG_ALIAS );
+        info.var.type = pRecord->type;
+        info.var.len = pRecord->len;
+        memcpy( info.formatspec, pRecord->formatspec, MAX_FORMATSPEC_LEN );
+        info.formatspec[MAX_FORMATSPEC_LEN - 1] = 0;
+        strncpy( info.tagspec, tagspec, MAX_TAGSPEC_LEN - 1 );
+
+        info.permissions.nreads = pRecord->nreads;
+        info.permissions.nwrites = pRecord->nwrites;
+        for ( i = 0; i < VARSERVER_MAX_UIDS; i++ )
+        {
+            info.permissions.read[i] = pRecord->read[i];
+            info.permissions.write[i] = pRecord->write[i];
+        }
+
+        result = EOK;
+        if ( pRecord->type == VARTYPE_STR )
+        {
+            /* the string is copied from the mapping by VARLIST_AddNew */
+            if ( ( pRecord->dataLen > 0 ) &&
+                 ( pRecord->dataLen <= pRecord->len + 1 ) &&
+                 ( data[pRecord->dataLen - 1] == 0 ) )
+            {
+                info.var.val.str = (char *)data;
+            }
+            else
+            {
+                result = EBADMSG;
+            }
+        }
+        else if ( pRecord->type == VARTYPE_BLOB )
+        {
+            if ( pRecord->dataLen == pRecord->len )
+            {
+                info.var.val.blob = (void *)data;
+            }
+            else
+            {
+                result = EBADMSG;
+            }
+        }
+        else
+        {
+            memcpy( &info.var.val, &pRecord->value, sizeof( pRecord->value ) );
+        }
+
+        if ( ( result == EOK ) &&
+             ( VARLIST_Exists( &info ) == EOK ) )
+        {
+            /* an existing variable is left unchanged */
+            result = EEXIST;
+        }
+
+        if ( result == EOK )
+        {
+            result = VARLIST_AddNew( &info, &hVar );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  snapshot_SetCreds                                                         */
+/*!
+    Give a VarInfo object root credentials
+
+    The snapshot_SetCreds function sets root credentials in a VarInfo
+    object so the snapshot functions can access every variable.
+
+    @param[in,out]
+        pVarInfo
+            pointer to the VarInfo object to update
+
+==============================================================================*/
+static void snapshot_SetCreds( VarInfo *pVarInfo )
+{
+    pVarInfo->creds[0] = 0;
+    pVarInfo->ncreds = 1;
+}
+
+/*============================================================================*/
+/*  snapshot_Checksum                                                         */
+/*!
+    Update the snapshot checksum
+
+    The snapshot_Checksum function adds the specified data to an FNV-1a
+    checksum.
+
+    @param[in]
+        hash
+            current checksum value
+
+    @param[in]
+        p
+            pointer to the data to add
+
+    @param[in]
+        len
+            number of bytes to add
+
+    @retval the updated checksum value
+
+==============================================================================*/
+static uint32_t snapshot_Checksum( uint32_t hash,
+                                   const void *p,
+                                   size_t len )
+{
+    const uint8_t *q = p;
+    size_t i;
+
+    for ( i = 0; i < len; i++ )
+    {
+        hash ^= q[i];
+        hash *= SNAPSHOT_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/*! @}
+ * end of snapshot group */
@@ -0,0 +1,1070 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup standby standby
+ * @brief Warm standby arena
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file standby.c
+
+    Warm Standby Arena
+
+    The Warm Standby Arena keeps a copy of the variable store in a named
+    shared memory object ( /varserver_standby ), which outlives the
+    server process.  A server restarted with the same arena reattaches
+    to it, validates it, and restores the variable definitions, values
+    and notification registrations before it accepts any clients, so
+    the store is back in a few milliseconds instead of being rebuilt
+    by the clients.
+
+    The arena consists of a StandbyHeader, a snapshot image of the
+    variable definitions and values, the notification registrations,
+    and a table of value slots indexed by storage reference.  The
+    snapshot image and the registrations are rebuilt, at most once per
+    STANDBY_SYNC_INTERVAL_MS, after the definitions change.  The new
+    arena is written to a temporary object which atomically replaces
+    the current one, so a server which dies during a rebuild leaves
+    the previous arena intact.
+
+    Between rebuilds, every change to a numeric value is written through
+    to its value slot, which is protected by a sequence counter that is
+    odd while the slot is being updated.  The slots newer than the
+    snapshot image are applied after the image is restored.  String and
+    blob values are captured by the next rebuild.
+
+    The variable handles are only preserved if the restored store has
+    exactly the same handles as the store which was saved.  The arena
+    identifies the store it holds, and the restored server publishes
+    the same store identifier, so connected clients know they can
+    reconnect and continue to use their variable handles.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <signal.h>
+#include <syslog.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <varserver/var.h>
+#include <varserver/varserver.h>
+#include <varserver/varclient.h>
+#include "varlist.h"
+#include "snapshot.h"
+#include "standby.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! warm standby arena identifier ("VSBY") */
+#define STANDBY_MAGIC ( 0x59425356 )
+
+/*! warm standby arena format version */
+#define STANDBY_VERSION ( 1 )
+
+/*! alignment of the warm standby arena sections */
+#define STANDBY_ALIGN ( 8 )
+
+/*==============================================================================
+        Private types
+==============================================================================*/
+
+/*! warm standby arena header */
+typedef struct _StandbyHeader
+{
+    /*! warm standby arena identifier */
+    uint32_t magic;
+
+    /*! warm standby arena format version */
+    uint16_t version;
+
+    /*! size of the header */
+    uint16_t headerSize;
+
+    /*! identifier of the variable store held in the arena */
+    uint64_t storeID;
+
+    /*! number of variables created by the server before the store
+        was restored */
+    uint32_t baseCount;
+
+    /*! number of variable handles when the arena was built */
+    uint32_t varCount;
+
+    /*! number of variable handles, updated as variables are created */
+    uint32_t liveCount;
+
+    /*! size of a value slot */
+    uint32_t slotSize;
+
+    /*! offset of the snapshot image */
+    uint64_t imageOffset;
+
+    /*! length of the snapshot image */
+    uint64_t imageLength;
+
+    /*! offset of the notification registrations */
+    uint64_t notifyOffset;
+
+    /*! number of notification registrations */
+    uint64_t notifyCount;
+
+    /*! offset of the value slot table */
+    uint64_t slotOffset;
+
+    /*! number of value slots */
+    uint64_t slotCount;
+
+    /*! total size of the arena */
+    uint64_t size;
+
+} StandbyHeader;
+
+/*! notification registration held in the arena */
+typedef struct _StandbyNotification
+{
+    /*! handle of the variable the notification was requested on */
+    VAR_HANDLE hVar;
+
+    /*! notification type */
+    uint32_t type;
+
+    /*! process identifier of the notification client */
+    pid_t pid;
+
+    /*! reserved for alignment */
+    uint32_t reserved;
+
+    /*! notification subscription options */
+    VarNotifyOptions options;
+
+} StandbyNotification;
+
+/*! numeric value written through to the arena */
+typedef struct _StandbySlot
+{
+    /*! sequence counter, odd while the slot is being updated */
+    uint32_t seq;
+
+    /*! handle of the variable which was changed, VAR_INVALID if the
+        value has not changed since the arena was built */
+    VAR_HANDLE hVar;
+
+    /*! variable type */
+    uint32_t type;
+
+    /*! reserved for alignment */
+    uint32_t reserved;
+
+    /*! numeric variable value */
+    uint64_t value;
+
+} StandbySlot;
+
+/*! Context of the notification registrations being written */
+typedef struct _StandbyWriter
+{
+    /*! arena output stream */
+    FILE *fp;
+
+    /*! pointer to the arena header to update */
+    StandbyHeader *pHeader;
+
+} StandbyWriter;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int standby_Validate( const StandbyHeader *pHeader, size_t len );
+
+static void standby_RestoreValues( const StandbyHeader *pHeader );
+
+static size_t standby_RestoreNotifications( const StandbyHeader *pHeader );
+
+static int standby_WriteNotification( VAR_HANDLE hVar,
+                                      NotificationType type,
+                                      pid_t pid,
+                                      const VarNotifyOptions *pOptions,
+                                      void *arg );
+
+static int standby_Pad( FILE *fp );
+
+static void standby_SetCreds( VarInfo *pVarInfo );
+
+static uint64_t standby_Now( void );
+
+/*==============================================================================
+        File scoped variables
+==============================================================================*/
+
+/*! path of the warm standby arena */
+static char standbyPath[PATH_MAX];
+
+/*! indicates if the warm standby arena is enabled */
+static bool enabled = false;
+
+/*! number of variables created by the server before the store
+    was restored */
+static uint32_t baseCount = 0;
+
+/*! identifier of the variable store */
+static uint64_t standbyStoreID = 0;
+
+/*! pointer to the mapping of the current arena */
+static StandbyHeader *pArena = NULL;
+
+/*! pointer to the value slots of the current arena */
+static StandbySlot *pSlots = NULL;
+
+/*! number of value slots in the current arena */
+static size_t slotCount = 0;
+
+/*! the definitions have changed since the arena was built */
+static bool changed = false;
+
+/*! time the arena was last built (CLOCK_MONOTONIC nanoseconds) */
+static uint64_t lastSync = 0;
+
+/*! number of times the arena has been rebuilt */
+static uint64_t *pSyncsMetric = NULL;
+
+/*! time taken by the last restore from the arena in microseconds */
+static uint64_t *pRestoreMetric = NULL;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  STANDBY_Init                                                              */
+/*!
+    Enable the warm standby arena
+
+    The STANDBY_Init function enables the warm standby arena of the
+    specified shard.  It must be called after the server has created
+    its own variables and before the store is restored, since the
+    number of variables which exist at that point is recorded to
+    validate that a restored store has the same variable handles.
+
+    @param[in]
+        shard
+            shard index of the server, which is appended to the name
+            of the arena
+
+    @retval EOK the warm standby arena was enabled
+    @retval E2BIG the name of the arena is too long
+    @retval EINVAL invalid shard index
+
+==============================================================================*/
+int STANDBY_Init( int shard )
+{
+    int result;
+    char name[BUFSIZ];
+
+    result = ShardName( name, sizeof( name ), SERVER_STANDBY, shard );
+    if ( result == EOK )
+    {
+        if ( snprintf( standbyPath,
+                       sizeof( standbyPath ),
+                       "%s%s",
+                       STANDBY_SHM_DIR,
+                       name ) >= (int)sizeof( standbyPath ) )
+        {
+            result = E2BIG;
+        }
+        else
+        {
+            baseCount = VARLIST_Count();
+            changed = true;
+            enabled = true;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  STANDBY_Restore                                                           */
+/*!
+    Restore the variable store from the warm standby arena
+
+    The STANDBY_Restore function maps the warm standby arena left by
+    the previous server, validates it, and restores its variables.  If
+    the restored variables have the same handles as the saved store,
+    the values written through since the arena was built are applied,
+    and the notifications of the clients which are still running are
+    registered again.
+
+    @param[out]
+        pStoreID
+            pointer to a location to store the identifier of the
+            restored store, or 0 if the variable handles could not be
+            preserved
+
+    @param[out]
+        pCount
+            optional pointer to a location to store the number of
+            variables and aliases restored
+
+    @retval EOK the variable store was restored
+    @retval ENOTSUP the warm standby arena is not enabled
+    @retval EBADMSG the warm standby arena is corrupt
+    @retval EINVAL invalid arguments
+    @retval other error reading the warm standby arena
+
+==============================================================================*/
+int STANDBY_Restore( uint64_t *pStoreID, size_t *pCount )
+{
+    int result = EINVAL;
+    int fd;
+    struct stat sb;
+    void *p = MAP_FAILED;
+    const StandbyHeader *pHeader;
+    uint64_t start = standby_Now();
+    size_t count = 0;
+    size_t n = 0;
+
+    if ( pStoreID != NULL )
+    {
+        *pStoreID = 0;
+
+        if ( enabled == false )
+        {
+            result = ENOTSUP;
+        }
+        else
+        {
+            fd = open( standbyPath, O_RDONLY | O_CLOEXEC );
+            result = ( fd != -1 ) ? EOK : errno;
+        }
+
+        if ( result == EOK )
+        {
+            if ( fstat( fd, &sb ) != 0 )
+            {
+                result = errno;
+            }
+            else if ( (size_t)sb.st_size < sizeof( StandbyHeader ) )
+            {
+                result = EBADMSG;
+            }
+            else
+            {
+                p = mmap( NULL, sb.st_size, PROT_READ, MAP_SHARED, fd, 0 );
+                result = ( p != MAP_FAILED ) ? EOK : errno;
+            }
+
+            close( fd );
+        }
+
+        if ( result == EOK )
+        {
+            pHeader = (const StandbyHeader *)p;
+            result = standby_Validate( pHeader, sb.st_size );
+            if ( result == EOK )
+            {
+                result = SNAPSHOT_LoadImage( (const char *)p +
+                                                 pHeader->imageOffset,
+                                             pHeader->imageLength,
+                                             &count );
+            }
+
+            /* the variable handles are preserved if every variable of
+               the saved store, and no other, has been restored */
+            if ( ( result == EOK ) &&
+                 ( pHeader->baseCount == baseCount ) &&
+                 ( pHeader->liveCount == pHeader->varCount ) &&
+                 ( VARLIST_Count() == pHeader->varCount ) )
+            {
+                standby_RestoreValues( pHeader );
+                n = standby_RestoreNotifications( pHeader );
+                *pStoreID = pHeader->storeID;
+            }
+
+            munmap( p, sb.st_size );
+
+            syslog( LOG_INFO,
+                    "restored %zu variables and %zu notifications "
+                    "from %s",
+                    count,
+                    n,
+                    standbyPath );
+        }
+
+        if ( pRestoreMetric != NULL )
+        {
+            *pRestoreMetric = ( standby_Now() - start ) / 1000ULL;
+        }
+
+        if ( pCount != NULL )
+        {
+            *pCount = count;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  STANDBY_SetStoreID                                                        */
+/*!
+    Set the identifier of the variable store
+
+    The STANDBY_SetStoreID function sets the identifier of the variable
+    store which is published to the clients, and written to the warm
+    standby arena when it is next rebuilt.
+
+    @param[in]
+        storeID
+            identifier of the variable store
+
+==============================================================================*/
+void STANDBY_SetStoreID( uint64_t storeID )
+{
+    standbyStoreID = storeID;
+    changed = true;
+}
+
+/*============================================================================*/
+/*  STANDBY_Sync                                                              */
+/*!
+    Rebuild the warm standby arena
+
+    The STANDBY_Sync function writes a new warm standby arena holding
+    the current variable store and notification registrations, and
+    atomically replaces the current arena with it.  The value slots of
+    the new arena are empty since the snapshot image holds the current
+    values.
+
+    @retval EOK the warm standby arena was rebuilt
+    @retval ENOTSUP the warm standby arena is not enabled
+    @retval ENAMETOOLONG the path of the arena is too long
+    @retval ENOMEM the new arena could not be mapped
+    @retval other error writing the warm standby arena
+
+==============================================================================*/
+int STANDBY_Sync( void )
+{
+    int result = ENOTSUP;
+    char tmp[PATH_MAX];
+    StandbyHeader header;
+    StandbyWriter writer;
+    FILE *fp = NULL;
+    void *p = MAP_FAILED;
+    int fd = -1;
+
+    if ( enabled == true )
+    {
+        if ( snprintf( tmp, sizeof( tmp ), "%s.tmp", standbyPath )
+                >= (int)sizeof( tmp ) )
+        {
+            result = ENAMETOOLONG;
+        }
+        else
+        {
+            fd = open( tmp,
+                       O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC,
+                       S_IRUSR | S_IWUSR );
+            fp = ( fd != -1 ) ? fdopen( fd, "w+b" ) : NULL;
+            result = ( fp != NULL ) ? EOK : errno;
+        }
+
+        if ( result == EOK )
+        {
+            memset( &header, 0, sizeof( StandbyHeader ) );
+            header.magic = STANDBY_MAGIC;
+            header.version = STANDBY_VERSION;
+            header.headerSize = sizeof( StandbyHeader );
+            header.storeID = standbyStoreID;
+            header.baseCount = baseCount;
+            header.varCount = VARLIST_Count();
+            header.liveCount = header.varCount;
+            header.slotSize = sizeof( StandbySlot );
+            header.imageOffset = sizeof( StandbyHeader );
+
+            /* reserve space for the header */
+            if ( fwrite( &header, sizeof( header ), 1, fp ) != 1 )
+            {
+                result = EIO;
+            }
+
+            if ( result == EOK )
+            {
+                result = SNAPSHOT_Write( fp, 0, NULL );
+            }
+
+            if ( result == EOK )
+            {
+                header.imageLength = ftell( fp ) - header.imageOffset;
+                result = standby_Pad( fp );
+            }
+
+            if ( result == EOK )
+            {
+                header.notifyOffset = ftell( fp );
+                writer.fp = fp;
+                writer.pHeader = &header;
+                result = VARLIST_ForEachNotification(
+                                standby_WriteNotification,
+                                &writer );
+            }
+
+            if ( result == EOK )
+            {
+                result = standby_Pad( fp );
+            }
+
+            if ( result == EOK )
+            {
+                /* a storage reference never exceeds the number of
+                   variable handles */
+                header.slotOffset = ftell( fp );
+                header.slotCount = header.varCount + 1;
+                header.size = header.slotOffset +
+                              header.slotCount * sizeof( StandbySlot );
+
+                /* write the completed header */
+                if ( ( fseek( fp, 0, SEEK_SET ) != 0 ) ||
+                     ( fwrite( &header, sizeof( header ), 1, fp ) != 1 ) ||
+                     ( fflush( fp ) != 0 ) )
+                {
+                    result = EIO;
+                }
+            }
+
+            /* the value slots start out empty */
+            if ( ( result == EOK ) &&
+                 ( ftruncate( fd, header.size ) != 0 ) )
+            {
+                result = errno;
+            }
+
+            if ( result == EOK )
+            {
+                p = mmap( NULL,
+                          header.size,
+                          PROT_READ | PROT_WRITE,
+                          MAP_SHARED,
+                          fd,
+                          0 );
+                result = ( p != MAP_FAILED ) ? EOK : ENOMEM;
+            }
+
+            /* this also closes the file descriptor */
+            fclose( fp );
+
+            if ( ( result == EOK ) &&
+                 ( rename( tmp, standbyPath ) != 0 ) )
+            {
+                result = errno;
+                munmap( p, header.size );
+            }
+
+            if ( result == EOK )
+            {
+                /* write the value changes through to the new arena */
+                if ( pArena != NULL )
+                {
+                    munmap( pArena, pArena->size );
+                }
+
+                pArena = (StandbyHeader *)p;
+                pSlots = (StandbySlot *)( (char *)p + header.slotOffset );
+                slotCount = header.slotCount;
+                changed = false;
+
+                if ( pSyncsMetric != NULL )
+                {
+                    (*pSyncsMetric)++;
+                }
+            }
+            else
+            {
+                unlink( tmp );
+            }
+        }
+        else if ( fd != -1 )
+        {
+            close( fd );
+        }
+
+        /* do not retry a failed rebuild before the next interval */
+        lastSync = standby_Now();
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  STANDBY_Due                                                               */
+/*!
+    Get the time the warm standby arena is due to be rebuilt
+
+    The STANDBY_Due function gets the time the warm standby arena is
+    next due to be rebuilt.  The arena is rebuilt no more than once per
+    STANDBY_SYNC_INTERVAL_MS after the definitions have changed.
+
+    @retval CLOCK_MONOTONIC time in nanoseconds the arena is due
+    @retval 0 the arena does not need to be rebuilt
+
+==============================================================================*/
+uint64_t STANDBY_Due( void )
+{
+    uint64_t due = 0;
+
+    if ( ( enabled == true ) &&
+         ( changed == true ) )
+    {
+        due = lastSync + (uint64_t)STANDBY_SYNC_INTERVAL_MS * 1000000ULL;
+    }
+
+    return due;
+}
+
+/*============================================================================*/
+/*  STANDBY_Changed                                                           */
+/*!
+    Indicate that the variable definitions have changed
+
+    The STANDBY_Changed function is called when variables are created,
+    or their definitions or notification registrations change, so the
+    warm standby arena is rebuilt.  The number of variable handles is
+    updated in the current arena straight away, so a store which lost
+    the variables created since the arena was built is never restored
+    with its handles preserved.
+
+==============================================================================*/
+void STANDBY_Changed( void )
+{
+    if ( enabled == true )
+    {
+        changed = true;
+
+        if ( pArena != NULL )
+        {
+            __atomic_store_n( &pArena->liveCount,
+                              (uint32_t)VARLIST_Count(),
+                              __ATOMIC_RELEASE );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  STANDBY_Update                                                            */
+/*!
+    Write a value change through to the warm standby arena
+
+    The STANDBY_Update function stores the new value of a numeric
+    variable in its value slot.  A change to a string or blob value,
+    or to a variable which does not have a slot, causes the arena to
+    be rebuilt instead.
+
+    @param[in]
+        storageRef
+            storage reference of the modified variable
+
+    @param[in]
+        hVar
+            handle of the modified variable
+
+    @param[in]
+        pVarObject
+            pointer to the new value
+
+==============================================================================*/
+void STANDBY_Update( uint32_t storageRef,
+                     VAR_HANDLE hVar,
+                     const VarObject *pVarObject )
+{
+    StandbySlot *pSlot;
+    uint32_t seq;
+
+    if ( ( enabled == true ) &&
+         ( pVarObject != NULL ) )
+    {
+        if ( ( pVarObject->type == VARTYPE_STR ) ||
+             ( pVarObject->type == VARTYPE_BLOB ) )
+        {
+            changed = true;
+        }
+        else if ( ( pSlots != NULL ) &&
+                  ( storageRef < slotCount ) )
+        {
+            pSlot = &pSlots[storageRef];
+            seq = pSlot->seq;
+
+            __atomic_store_n( &pSlot->seq, seq + 1, __ATOMIC_RELEASE );
+            pSlot->hVar = hVar;
+            pSlot->type = pVarObject->type;
+            memcpy( &pSlot->value, &pVarObject->val, sizeof( pSlot->value ) );
+            __atomic_store_n( &pSlot->seq, seq + 2, __ATOMIC_RELEASE );
+        }
+        else
+        {
+            /* the variable is not in the arena yet */
+            changed = true;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  STANDBY_SetMetrics                                                        */
+/*!
+    Create the warm standby arena metrics
+
+    The STANDBY_SetMetrics function creates the metrics which count the
+    rebuilds of the warm standby arena, and measure the time taken by
+    the last restore from the arena.  The metrics are created whether
+    or not the arena is enabled, so the server variables are the same.
+
+    @param[in]
+        fn
+            function used to create a metric
+
+==============================================================================*/
+void STANDBY_SetMetrics( StandbyMetricFn fn )
+{
+    if ( fn != NULL )
+    {
+        pSyncsMetric = fn( "/varserver/stats/standby_syncs" );
+        pRestoreMetric = fn( "/varserver/stats/standby_restore_us" );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  standby_Validate                                                          */
+/*!
+    Validate a warm standby arena
+
+    The standby_Validate function checks the warm standby arena header,
+    and that each of the arena sections lies within the arena.
+
+    @param[in]
+        pHeader
+            pointer to the arena header
+
+    @param[in]
+        len
+            size of the arena
+
+    @retval EOK the arena is valid
+    @retval EBADMSG the arena is corrupt
+    @retval ENOTSUP the arena version is not supported
+
+==============================================================================*/
+static int standby_Validate( const StandbyHeader *pHeader, size_t len )
+{
+    int result = EBADMSG;
+
+    if ( pHeader->magic != STANDBY_MAGIC )
+    {
+        result = EBADMSG;
+    }
+    else if ( ( pHeader->version != STANDBY_VERSION ) ||
+              ( pHeader->headerSize != sizeof( StandbyHeader ) ) ||
+              ( pHeader->slotSize != sizeof( StandbySlot ) ) )
+    {
+        result = ENOTSUP;
+    }
+    else if ( ( pHeader->size == len ) &&
+              ( pHeader->imageOffset <= len ) &&
+              ( pHeader->imageLength <= len - pHeader->imageOffset ) &&
+              ( pHeader->notifyOffset <= len ) &&
+              ( ( pHeader->notifyOffset % STANDBY_ALIGN ) == 0 ) &&
+              ( pHeader->notifyCount <=
+                    ( len - pHeader->notifyOffset ) /
+                    sizeof( StandbyNotification ) ) &&
+              ( pHeader->slotOffset <= len ) &&
+              ( ( pHeader->slotOffset % STANDBY_ALIGN ) == 0 ) &&
+              ( pHeader->slotCount <=
+                    ( len - pHeader->slotOffset ) / sizeof( StandbySlot ) ) )
+    {
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  standby_RestoreValues                                                     */
+/*!
+    Apply the values written through to the warm standby arena
+
+    The standby_RestoreValues function sets the variables whose value
+    changed after the arena was built to the value in their slot.
+    Slots which were being updated when the previous server stopped
+    are skipped, leaving the value from the snapshot image.  The
+    server's own variables are not restored.
+
+    @param[in]
+        pHeader
+            pointer to the validated arena header
+
+==============================================================================*/
+static void standby_RestoreValues( const StandbyHeader *pHeader )
+{
+    const StandbySlot *pSlot;
+    const VarObject *pVarObject;
+    VarInfo info;
+    bool validationInProgress = false;
+    size_t i;
+
+    pSlot = (const StandbySlot *)( (const char *)pHeader +
+                                   pHeader->slotOffset );
+
+    for ( i = 1; i < pHeader->slotCount; i++ )
+    {
+        pVarObject = VARLIST_PeekObj( pSlot[i].hVar );
+
+        if ( ( ( pSlot[i].seq & 1 ) == 0 ) &&
+             ( pSlot[i].hVar > baseCount ) &&
+             ( pVarObject != NULL ) &&
+             ( pVarObject->type == pSlot[i].type ) )
+        {
+            memset( &info, 0, sizeof( VarInfo ) );
+            standby_SetCreds( &info );
+            info.hVar = pSlot[i].hVar;
+            info.var.type = pSlot[i].type;
+            memcpy( &info.var.val,
+                    &pSlot[i].value,
+                    sizeof( pSlot[i].value ) );
+
+            VARLIST_Set( 0, &info, &validationInProgress, NULL );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  standby_RestoreNotifications                                              */
+/*!
+    Register the notifications held in the warm standby arena
+
+    The standby_RestoreNotifications function registers each
+    notification held in the arena again, unless the process which
+    requested it no longer exists.
+
+    @param[in]
+        pHeader
+            pointer to the validated arena header
+
+    @retval number of notifications registered
+
+==============================================================================*/
+static size_t standby_RestoreNotifications( const StandbyHeader *pHeader )
+{
+    const StandbyNotification *pNotification;
+    VarInfo info;
+    size_t count = 0;
+    size_t i;
+
+    pNotification = (const StandbyNotification *)
+                        ( (const char *)pHeader + pHeader->notifyOffset );
+
+    for ( i = 0; i < pHeader->notifyCount; i++ )
+    {
+        if ( ( pNotification[i].pid > 0 ) &&
+             ( ( kill( pNotification[i].pid, 0 ) == 0 ) ||
+               ( errno == EPERM ) ) )
+        {
+            memset( &info, 0, sizeof( VarInfo ) );
+            standby_SetCreds( &info );
+            info.hVar = pNotification[i].hVar;
+            info.notificationType = pNotification[i].type;
+
+            if ( VARLIST_RequestNotify( &info,
+                                        pNotification[i].pid,
+                                        &pNotification[i].options ) == EOK )
+            {
+                count++;
+            }
+        }
+    }
+
+    return count;
+}
+
+/*============================================================================*/
+/*  standby_WriteNotification                                                 */
+/*!
+    Write a notification registration to the warm standby arena
+
+    The standby_WriteNotification function is called by
+    VARLIST_ForEachNotification for each notification registration,
+    and appends it to the arena being built.
+
+    @param[in]
+        hVar
+            handle of the variable the notification was requested on
+
+    @param[in]
+        type
+            notification type
+
+    @param[in]
+        pid
+            process identifier of the notification client
+
+    @param[in]
+        pOptions
+            pointer to the notification subscription options
+
+    @param[in]
+        arg
+            pointer to the StandbyWriter context
+
+    @retval EOK the notification registration was written
+    @retval EIO error writing the warm standby arena
+
+==============================================================================*/
+static int standby_WriteNotification( VAR_HANDLE hVar,
+                                      NotificationType type,
+                                      pid_t pid,
+                                      const VarNotifyOptions *pOptions,
+                                      void *arg )
+{
+    int result = EIO;
+    StandbyWriter *pWriter = (StandbyWriter *)arg;
+    StandbyNotification notification;
+
+    memset( &notification, 0, sizeof( StandbyNotification ) );
+    notification.hVar = hVar;
+    notification.type = type;
+    notification.pid = pid;
+    notification.options = *pOptions;
+
+    if ( fwrite( &notification,
+                 sizeof( notification ),
+                 1,
+                 pWriter->fp ) == 1 )
+    {
+        pWriter->pHeader->notifyCount++;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  standby_Pad                                                               */
+/*!
+    Align the warm standby arena output
+
+    The standby_Pad function writes zeros until the output stream is
+    positioned on a multiple of STANDBY_ALIGN.
+
+    @param[in]
+        fp
+            arena output stream
+
+    @retval EOK the output stream is aligned
+    @retval EIO error writing the warm standby arena
+
+==============================================================================*/
+static int standby_Pad( FILE *fp )
+{
+    int result = EIO;
+    static const char padding[STANDBY_ALIGN] = {0};
+    long offset;
+    size_t n;
+
+    offset = ftell( fp );
+    if ( offset != -1 )
+    {
+        n = ( STANDBY_ALIGN - ( offset % STANDBY_ALIGN ) ) % STANDBY_ALIGN;
+        if ( ( n == 0 ) ||
+             ( fwrite( padding, n, 1, fp ) == 1 ) )
+        {
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  standby_SetCreds                                                          */
+/*!
+    Give a VarInfo object root credentials
+
+    The standby_SetCreds function sets root credentials in a VarInfo
+    object so the restore can access every variable.
+
+    @param[in,out]
+        pVarInfo
+            pointer to the VarInfo object to update
+
+==============================================================================*/
+static void standby_SetCreds( VarInfo *pVarInfo )
+{
+    pVarInfo->creds[0] = 0;
+    pVarInfo->ncreds = 1;
+}
+
+/*============================================================================*/
+/*  standby_Now                                                               */
+/*!
+    Get the current time
+
+    The standby_Now function gets the current CLOCK_MONOTONIC time.
+
+    @retval current time in nanoseconds
+
+==============================================================================*/
+static uint64_t standby_Now( void )
+{
+    struct timespec ts;
+    uint64_t now = 0;
+
+    if ( clock_gettime( CLOCK_MONOTONIC, &ts ) == 0 )
+    {
+        now = (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+    }
+
+    return now;
+}
+
+/*! @}
+ * end of standby group */
@@ -38,6 +38,24 @@ SOFTWARE.
     metrics used to monitor the performance of the
     notifications associated with a variable.
 
+    It also publishes the resident memory of the server process, in
+    total and per variable, so the memory cost of the variable storage
+    can be monitored on the target.
+
+    The memory used by each server subsystem (variables, string and
+    blob values, notifications, blocked clients, transactions, search
+    contexts, history rings and client mappings) is counted in bytes
+    and objects as it is allocated and freed, and published below
+    /varserver/mem once per second for capacity planning.
+
+    Latency histograms record durations (such as the time taken to
+    service each type of request) in log-linear buckets: each power of
+    two range is split into STATS_SUB_BUCKETS equal buckets, so values
+    are resolved to within about 12% from nanoseconds to minutes with
+    a few hundred counters.  The 50th, 90th and 99th percentiles and
+    the maximum (in nanoseconds, since the server started) are
+    published once per second.
+
 */
 /*============================================================================*/
 
@@ -54,11 +72,54 @@ SOFTWARE.
 #include <time.h>
 #include <signal.h>
 #include "stats.h"
+#include "varlist.h"
 
 /*==============================================================================
         Private definitions
 ==============================================================================*/
 
+/*! number of bits of sub-bucket resolution in a latency histogram */
+#define STATS_SUB_BITS ( 3 )
+
+/*! number of buckets in each power of two range of a latency histogram */
+#define STATS_SUB_BUCKETS ( 1 << STATS_SUB_BITS )
+
+/*! largest power of two tracked by a latency histogram (2^40ns ~ 18 min) */
+#define STATS_MAX_EXPONENT ( 40 )
+
+/*! number of buckets in a latency histogram */
+#define STATS_LATENCY_BUCKETS \
+    ( ( STATS_MAX_EXPONENT - STATS_SUB_BITS + 2 ) * STATS_SUB_BUCKETS )
+
+/*! the LatencyHistogram object counts durations in log-linear buckets */
+typedef struct _LatencyHistogram
+{
+    /*! number of recorded durations */
+    uint64_t count;
+
+    /*! number of recorded durations when the metrics were last updated */
+    uint64_t reported;
+
+    /*! longest recorded duration */
+    uint64_t max;
+
+    /*! pointer to the 50th percentile metric */
+    uint64_t *pP50;
+
+    /*! pointer to the 90th percentile metric */
+    uint64_t *pP90;
+
+    /*! pointer to the 99th percentile metric */
+    uint64_t *pP99;
+
+    /*! pointer to the maximum metric */
+    uint64_t *pMax;
+
+    /*! duration counters */
+    uint64_t buckets[STATS_LATENCY_BUCKETS];
+
+} LatencyHistogram;
+
 /*! the RequestStats is used to track the total number of requests
     handled by the variable server, as well as the number of
     requests per second */
@@ -73,8 +134,34 @@ typedef struct _RequestStats
     /*! pointer to the VarObject containing the totalRequestCount */
     uint64_t *pTotalRequests;
 
+    /*! pointer to the resident memory size statistic */
+    uint64_t *pResident;
+
+    /*! pointer to the resident memory per variable statistic */
+    uint64_t *pResidentPerVar;
+
 } RequestStats;
 
+/*! the MemStats object counts the memory used by a server subsystem */
+typedef struct _MemStats
+{
+    /*! name of the subsystem in the memory metrics */
+    const char *name;
+
+    /*! number of allocated bytes */
+    uint64_t bytes;
+
+    /*! number of allocated objects */
+    uint64_t objects;
+
+    /*! pointer to the allocated bytes metric */
+    uint64_t *pBytes;
+
+    /*! pointer to the allocated objects metric */
+    uint64_t *pObjects;
+
+} MemStats;
+
 /*==============================================================================
         Private file scoped variables
 ==============================================================================*/
@@ -82,11 +169,42 @@ typedef struct _RequestStats
 /*! request statistics */
 static RequestStats stats = {0};
 
+/*! memory accounting, indexed by StatsMem category.  The counters are
+    kept apart from the request statistics since allocations begin
+    before the statistics are initialized */
+static MemStats memStats[STATS_MEM_END] =
+{
+    { "variables", 0, 0, NULL, NULL },
+    { "aliases", 0, 0, NULL, NULL },
+    { "strings", 0, 0, NULL, NULL },
+    { "blobs", 0, 0, NULL, NULL },
+    { "notifications", 0, 0, NULL, NULL },
+    { "blocked_clients", 0, 0, NULL, NULL },
+    { "transactions", 0, 0, NULL, NULL },
+    { "search_contexts", 0, 0, NULL, NULL },
+    { "history", 0, 0, NULL, NULL },
+    { "clients", 0, 0, NULL, NULL }
+};
+
+/*! pointer to the total allocated bytes metric */
+static uint64_t *pMemTotal = NULL;
+
+/*! latency histograms, indexed by histogram handle (slot 0 is unused) */
+static LatencyHistogram *histograms[STATS_MAX_HISTOGRAMS + 1] = {0};
+
+/*! number of latency histograms */
+static int numHistograms = 0;
+
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
 
 static void CreateStatsTimer( int timeoutms );
+static void UpdateMemoryStats( void );
+static void UpdateLatencyStats( void );
+static void UpdateMemMetrics( void );
+static int LatencyBucket( uint64_t ns );
+static uint64_t LatencyBucketLimit( int bucket );
 
 /*==============================================================================
         Public function definitions
@@ -164,6 +282,32 @@ void STATS_SetTotalRequestsPtr( uint64_t *p )
     stats.pTotalRequests = p;
 }
 
+/*============================================================================*/
+/*  STATS_SetMemoryPtrs                                                       */
+/*!
+    Set the pointers to the resident memory statistics
+
+    The STATS_SetMemoryPtrs function sets the pointers to the resident
+    memory size and resident memory per variable statistics
+
+    @param[in]
+        pResident
+            pointer to the storage for the resident memory size statistic
+
+    @param[in]
+        pResidentPerVar
+            pointer to the storage for the resident memory per variable
+            statistic
+
+==============================================================================*/
+void STATS_SetMemoryPtrs( uint64_t *pResident, uint64_t *pResidentPerVar )
+{
+    stats.pResident = pResident;
+    stats.pResidentPerVar = pResidentPerVar;
+
+    UpdateMemoryStats();
+}
+
 /*============================================================================*/
 /*  STATS_Process                                                             */
 /*!
@@ -182,6 +326,239 @@ void STATS_Process( void )
     }
 
     stats.requestCount=0;
+
+    UpdateMemoryStats();
+    UpdateMemMetrics();
+    UpdateLatencyStats();
+}
+
+/*============================================================================*/
+/*  STATS_NewHistogram                                                        */
+/*!
+    Create a latency histogram
+
+    The STATS_NewHistogram function creates a latency histogram and
+    its p50, p90, p99 and max metrics below the specified name prefix,
+    using the specified metric creation function.
+
+    @param[in]
+        prefix
+            name prefix of the histogram metrics
+
+    @param[in]
+        fn
+            function used to create a metric
+
+    @retval handle of the new histogram
+    @retval 0 the histogram could not be created
+
+==============================================================================*/
+int STATS_NewHistogram( char *prefix, StatsMetricFn fn )
+{
+    int result = 0;
+    LatencyHistogram *pHistogram;
+    char name[MAX_NAME_LEN+1];
+
+    if( ( prefix != NULL ) &&
+        ( fn != NULL ) &&
+        ( numHistograms < STATS_MAX_HISTOGRAMS ) )
+    {
+        pHistogram = calloc( 1, sizeof( LatencyHistogram ) );
+        if( pHistogram != NULL )
+        {
+            snprintf( name, sizeof( name ), "%s/p50", prefix );
+            pHistogram->pP50 = fn( name );
+            snprintf( name, sizeof( name ), "%s/p90", prefix );
+            pHistogram->pP90 = fn( name );
+            snprintf( name, sizeof( name ), "%s/p99", prefix );
+            pHistogram->pP99 = fn( name );
+            snprintf( name, sizeof( name ), "%s/max", prefix );
+            pHistogram->pMax = fn( name );
+
+            result = ++numHistograms;
+            histograms[result] = pHistogram;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  STATS_RecordLatency                                                       */
+/*!
+    Record a duration in a latency histogram
+
+    The STATS_RecordLatency function counts a duration in the bucket
+    of the specified histogram which contains it.  The histogram is
+    updated atomically since read-only requests are completed on the
+    worker threads.
+
+    @param[in]
+        histogram
+            handle of the histogram (0 is ignored)
+
+    @param[in]
+        ns
+            duration in nanoseconds
+
+==============================================================================*/
+void STATS_RecordLatency( int histogram, uint64_t ns )
+{
+    LatencyHistogram *pHistogram;
+    uint64_t max;
+
+    if( ( histogram > 0 ) &&
+        ( histogram <= numHistograms ) )
+    {
+        pHistogram = histograms[histogram];
+        __atomic_fetch_add( &pHistogram->buckets[LatencyBucket( ns )],
+                            1,
+                            __ATOMIC_RELAXED );
+        __atomic_fetch_add( &pHistogram->count, 1, __ATOMIC_RELAXED );
+
+        max = __atomic_load_n( &pHistogram->max, __ATOMIC_RELAXED );
+        while( ( ns > max ) &&
+               ( !__atomic_compare_exchange_n( &pHistogram->max,
+                                               &max,
+                                               ns,
+                                               false,
+                                               __ATOMIC_RELAXED,
+                                               __ATOMIC_RELAXED ) ) )
+        {
+            /* another thread updated the maximum, try again */
+        }
+    }
+}
+
+/*============================================================================*/
+/*  STATS_Now                                                                 */
+/*!
+    Get a timestamp for latency measurements
+
+    The STATS_Now function gets the CLOCK_MONOTONIC time, which is read
+    without a system call on the common targets.
+
+    @retval monotonic time in nanoseconds
+
+==============================================================================*/
+uint64_t STATS_Now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/*============================================================================*/
+/*  STATS_MemAlloc                                                            */
+/*!
+    Account for allocated server memory
+
+    The STATS_MemAlloc function adds allocated objects and bytes to
+    the memory counters of a server subsystem.  It may be called from
+    the request worker threads.
+
+    @param[in]
+        type
+            memory accounting category
+
+    @param[in]
+        objects
+            number of allocated objects
+
+    @param[in]
+        bytes
+            number of allocated bytes
+
+==============================================================================*/
+void STATS_MemAlloc( StatsMem type, size_t objects, size_t bytes )
+{
+    if ( type < STATS_MEM_END )
+    {
+        __atomic_add_fetch( &memStats[type].objects,
+                            objects,
+                            __ATOMIC_RELAXED );
+        __atomic_add_fetch( &memStats[type].bytes,
+                            bytes,
+                            __ATOMIC_RELAXED );
+    }
+}
+
+/*============================================================================*/
+/*  STATS_MemFree                                                             */
+/*!
+    Account for freed server memory
+
+    The STATS_MemFree function removes freed objects and bytes from
+    the memory counters of a server subsystem.  It may be called from
+    the request worker threads.
+
+    @param[in]
+        type
+            memory accounting category
+
+    @param[in]
+        objects
+            number of freed objects
+
+    @param[in]
+        bytes
+            number of freed bytes
+
+==============================================================================*/
+void STATS_MemFree( StatsMem type, size_t objects, size_t bytes )
+{
+    if ( type < STATS_MEM_END )
+    {
+        __atomic_sub_fetch( &memStats[type].objects,
+                            objects,
+                            __ATOMIC_RELAXED );
+        __atomic_sub_fetch( &memStats[type].bytes,
+                            bytes,
+                            __ATOMIC_RELAXED );
+    }
+}
+
+/*============================================================================*/
+/*  STATS_SetMemMetrics                                                       */
+/*!
+    Set up the server memory metrics
+
+    The STATS_SetMemMetrics function creates the allocated bytes and
+    objects metrics for each memory accounting category, and the total
+    allocated bytes metric, using the specified metric creation
+    function.
+
+    @param[in]
+        fn
+            function used to create a metric
+
+==============================================================================*/
+void STATS_SetMemMetrics( StatsMetricFn fn )
+{
+    char name[128];
+    int i;
+
+    if ( fn != NULL )
+    {
+        for ( i = 0; i < STATS_MEM_END; i++ )
+        {
+            snprintf( name, sizeof( name ),
+                      "/varserver/mem/%s_bytes",
+                      memStats[i].name );
+            memStats[i].pBytes = fn( name );
+
+            snprintf( name, sizeof( name ),
+                      "/varserver/mem/%s_objects",
+                      memStats[i].name );
+            memStats[i].pObjects = fn( name );
+        }
+
+        pMemTotal = fn( "/varserver/mem/total_bytes" );
+
+        UpdateMemMetrics();
+    }
 }
 
 /*============================================================================*/
@@ -222,5 +599,248 @@ static void CreateStatsTimer( int timeoutms )
     timer_settime(timerID, 0, &its, NULL);
 }
 
+/*============================================================================*/
+/*  UpdateMemoryStats                                                         */
+/*!
+    Update the resident memory statistics
+
+    The UpdateMemoryStats function reads the resident set size of the
+    server process from /proc/self/statm and updates the resident memory
+    size and resident memory per variable statistics.
+
+==============================================================================*/
+static void UpdateMemoryStats( void )
+{
+    FILE *fp;
+    unsigned long size;
+    unsigned long resident;
+    uint64_t bytes;
+    size_t n;
+
+    if ( ( stats.pResident != NULL ) ||
+         ( stats.pResidentPerVar != NULL ) )
+    {
+        fp = fopen( "/proc/self/statm", "r" );
+        if ( fp != NULL )
+        {
+            if ( fscanf( fp, "%lu %lu", &size, &resident ) == 2 )
+            {
+                bytes = (uint64_t)resident * (uint64_t)sysconf( _SC_PAGESIZE );
+                n = VARLIST_Count();
+
+                if ( stats.pResident != NULL )
+                {
+                    *(stats.pResident) = bytes;
+                }
+
+                if ( ( stats.pResidentPerVar != NULL ) &&
+                     ( n > 0 ) )
+                {
+                    *(stats.pResidentPerVar) = bytes / n;
+                }
+            }
+
+            fclose( fp );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  UpdateMemMetrics                                                          */
+/*!
+    Update the server memory metrics
+
+    The UpdateMemMetrics function publishes the memory counters of each
+    server subsystem, and their total, to the memory metrics.
+
+==============================================================================*/
+static void UpdateMemMetrics( void )
+{
+    uint64_t total = 0;
+    uint64_t bytes;
+    int i;
+
+    for ( i = 0; i < STATS_MEM_END; i++ )
+    {
+        bytes = __atomic_load_n( &memStats[i].bytes, __ATOMIC_RELAXED );
+        total += bytes;
+
+        if ( memStats[i].pBytes != NULL )
+        {
+            *(memStats[i].pBytes) = bytes;
+        }
+
+        if ( memStats[i].pObjects != NULL )
+        {
+            *(memStats[i].pObjects) =
+                __atomic_load_n( &memStats[i].objects, __ATOMIC_RELAXED );
+        }
+    }
+
+    if ( pMemTotal != NULL )
+    {
+        *pMemTotal = total;
+    }
+}
+
+/*============================================================================*/
+/*  UpdateLatencyStats                                                        */
+/*!
+    Update the latency histogram metrics
+
+    The UpdateLatencyStats function calculates the percentiles of each
+    latency histogram which has recorded new durations, and publishes
+    them along with the maximum.  A percentile is reported as the upper
+    limit of the bucket which contains it.
+
+==============================================================================*/
+static void UpdateLatencyStats( void )
+{
+    LatencyHistogram *pHistogram;
+    uint64_t total;
+    uint64_t limit;
+    uint64_t p50;
+    uint64_t p90;
+    uint64_t p99;
+    int h;
+    int i;
+
+    for( h = 1; h <= numHistograms; h++ )
+    {
+        pHistogram = histograms[h];
+        if( pHistogram->count != pHistogram->reported )
+        {
+            /* ranks of the percentiles, rounded up */
+            p50 = ( pHistogram->count * 50 + 99 ) / 100;
+            p90 = ( pHistogram->count * 90 + 99 ) / 100;
+            p99 = ( pHistogram->count * 99 + 99 ) / 100;
+
+            total = 0;
+            for( i = 0; ( i < STATS_LATENCY_BUCKETS ) && ( total < p99 ); i++ )
+            {
+                if( pHistogram->buckets[i] == 0 )
+                {
+                    continue;
+                }
+
+                limit = LatencyBucketLimit( i );
+                if( limit > pHistogram->max )
+                {
+                    limit = pHistogram->max;
+                }
+
+                if( ( total < p50 ) &&
+                    ( total + pHistogram->buckets[i] >= p50 ) &&
+                    ( pHistogram->pP50 != NULL ) )
+                {
+                    *(pHistogram->pP50) = limit;
+                }
+
+                if( ( total < p90 ) &&
+                    ( total + pHistogram->buckets[i] >= p90 ) &&
+                    ( pHistogram->pP90 != NULL ) )
+                {
+                    *(pHistogram->pP90) = limit;
+                }
+
+                total += pHistogram->buckets[i];
+                if( ( total >= p99 ) &&
+                    ( pHistogram->pP99 != NULL ) )
+                {
+                    *(pHistogram->pP99) = limit;
+                }
+            }
+
+            if( pHistogram->pMax != NULL )
+            {
+                *(pHistogram->pMax) = pHistogram->max;
+            }
+
+            pHistogram->reported = pHistogram->count;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  LatencyBucket                                                             */
+/*!
+    Find the latency histogram bucket for a duration
+
+    The LatencyBucket function maps a duration to its histogram bucket.
+    Durations below STATS_SUB_BUCKETS have a bucket each.  Above that,
+    the power of two range selects a group of STATS_SUB_BUCKETS buckets
+    and the next STATS_SUB_BITS bits of the duration select the bucket
+    in the group.
+
+    @param[in]
+        ns
+            duration in nanoseconds
+
+    @retval bucket index
+
+==============================================================================*/
+static int LatencyBucket( uint64_t ns )
+{
+    int bucket;
+    int e;
+
+    if( ns < STATS_SUB_BUCKETS )
+    {
+        bucket = (int)ns;
+    }
+    else
+    {
+        /* index of the most significant bit */
+        e = 63 - __builtin_clzll( ns );
+        if( e > STATS_MAX_EXPONENT )
+        {
+            bucket = STATS_LATENCY_BUCKETS - 1;
+        }
+        else
+        {
+            bucket = ( e - STATS_SUB_BITS + 1 ) * STATS_SUB_BUCKETS +
+                     (int)( ( ns >> ( e - STATS_SUB_BITS ) ) &
+                            ( STATS_SUB_BUCKETS - 1 ) );
+        }
+    }
+
+    return bucket;
+}
+
+/*============================================================================*/
+/*  LatencyBucketLimit                                                        */
+/*!
+    Get the largest duration in a latency histogram bucket
+
+    The LatencyBucketLimit function is the inverse of LatencyBucket.
+
+    @param[in]
+        bucket
+            bucket index
+
+    @retval largest duration (in nanoseconds) counted in the bucket
+
+==============================================================================*/
+static uint64_t LatencyBucketLimit( int bucket )
+{
+    uint64_t limit;
+    int e;
+    int m;
+
+    if( bucket < STATS_SUB_BUCKETS )
+    {
+        limit = (uint64_t)bucket;
+    }
+    else
+    {
+        e = bucket / STATS_SUB_BUCKETS + STATS_SUB_BITS - 1;
+        m = bucket % STATS_SUB_BUCKETS;
+        limit = ( (uint64_t)( STATS_SUB_BUCKETS + m + 1 )
+                    << ( e - STATS_SUB_BITS ) ) - 1;
+    }
+
+    return limit;
+}
+
 /*! @}
  * end of stats group */
@@ -0,0 +1,318 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup trace trace
+ * @brief Shared memory request trace ring
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file trace.c
+
+    Request Trace Ring
+
+    The Request Trace Ring module creates the shared memory trace ring
+    ( /varserver_trace ).  When tracing is enabled via the
+    /varserver/trace/enable variable, the server writes a fixed size
+    binary record for each completed client request and for each
+    notification it sends.  The ring overwrites its oldest records,
+    so it can be left running under production load and read with
+    the vartrace tool when something goes wrong.
+
+    When tracing is disabled, the cost on the request path is the
+    single branch in TRACE_ENABLED().
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <varserver/varclient.h>
+#include <varserver/varserver.h>
+#include "trace.h"
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! enable flag used until the trace enable variable is available */
+static uint32_t traceDisabled = 0;
+
+/*! pointer to the shared trace ring */
+static TraceRing *pTraceRing = NULL;
+
+/*==============================================================================
+        Public variables
+==============================================================================*/
+
+/*! pointer to the trace enable flag */
+uint32_t *pTraceEnable = &traceDisabled;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  TRACE_Init                                                                */
+/*!
+    Create the shared trace ring
+
+    The TRACE_Init function creates the /varserver_trace shared memory
+    object and maps it into the server's address space.  The ring is
+    initially empty, and tracing is disabled.
+
+    @param[in]
+        shard
+            shard index of the server, which is appended to the name
+            of the shared memory object
+
+    @retval EOK the trace ring was created
+    @retval ENOMEM the trace ring could not be mapped
+    @retval other error from shm_open or ftruncate
+
+==============================================================================*/
+int TRACE_Init( int shard )
+{
+    int result = EINVAL;
+    int fd;
+    void *p;
+    char name[BUFSIZ];
+
+    /* get the name of the shared memory object for this shard */
+    ShardName( name, sizeof( name ), SERVER_TRACERING, shard );
+
+    /* get shared memory file descriptor (NOT a file) */
+    fd = shm_open( name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR );
+    if ( fd != -1 )
+    {
+        /* extend shared memory object as it is initialized with size 0 */
+        if ( ftruncate( fd, sizeof( TraceRing ) ) != -1 )
+        {
+            /* map shared memory to process address space */
+            p = mmap( NULL,
+                      sizeof( TraceRing ),
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED,
+                      fd,
+                      0 );
+            if ( p != MAP_FAILED )
+            {
+                /* discard any records left over from a previous server */
+                pTraceRing = (TraceRing *)p;
+                memset( pTraceRing, 0, sizeof( TraceRing ) );
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            result = errno;
+        }
+
+        /* close the file descriptor since we don't need it for anything */
+        close( fd );
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TRACE_SetEnable                                                           */
+/*!
+    Set the trace enable flag
+
+    The TRACE_SetEnable function sets the location of the flag which
+    enables tracing.  This is normally the value of the trace enable
+    variable, so tracing can be switched on and off at runtime by
+    setting the variable.  Tracing stays disabled if the trace ring
+    is not available.
+
+    @param[in]
+        pEnable
+            pointer to the trace enable flag
+
+    @retval EOK the trace enable flag was set
+    @retval ENOENT the trace ring is not available
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int TRACE_SetEnable( uint32_t *pEnable )
+{
+    int result = EINVAL;
+
+    if ( pTraceRing == NULL )
+    {
+        result = ENOENT;
+    }
+    else if ( pEnable != NULL )
+    {
+        pTraceEnable = pEnable;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TRACE_SetRequestName                                                      */
+/*!
+    Publish the name of a request type
+
+    The TRACE_SetRequestName function stores the name of a request type
+    in the trace ring so readers can display request records without
+    their own copy of the request names.
+
+    @param[in]
+        type
+            VarRequest type
+
+    @param[in]
+        name
+            name of the request type
+
+    @retval EOK the name was stored
+    @retval ENOENT the trace ring is not available
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int TRACE_SetRequestName( int type, const char *name )
+{
+    int result = EINVAL;
+
+    if ( pTraceRing == NULL )
+    {
+        result = ENOENT;
+    }
+    else if ( ( type >= 0 ) &&
+              ( type < VARSERVER_TRACE_MAX_REQUESTS ) &&
+              ( name != NULL ) )
+    {
+        strncpy( pTraceRing->requestNames[type],
+                 name,
+                 VARSERVER_TRACE_NAME_LEN - 1 );
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  TRACE_Record                                                              */
+/*!
+    Write a record to the trace ring
+
+    The TRACE_Record function writes a trace record at the head of the
+    trace ring, overwriting the oldest record if the ring is full.
+    The record's sequence number is cleared while it is being written
+    so readers can detect records which change while they are read.
+
+    Callers check TRACE_ENABLED() before calling this function.
+
+    @param[in]
+        event
+            the kind of event being recorded
+
+    @param[in]
+        type
+            VarRequest of a request, or the signal number of a notification
+
+    @param[in]
+        clientid
+            identifier of the requesting or notified client
+
+    @param[in]
+        hVar
+            handle of the variable involved
+
+    @param[in]
+        result
+            result code of the request or notification
+
+    @param[in]
+        timestamp
+            start time of the event (CLOCK_MONOTONIC nanoseconds)
+
+    @param[in]
+        duration
+            duration of the event in nanoseconds
+
+==============================================================================*/
+void TRACE_Record( TraceEvent event,
+                   int type,
+                   int clientid,
+                   VAR_HANDLE hVar,
+                   int result,
+                   uint64_t timestamp,
+                   uint64_t duration )
+{
+    TraceRecord *pRecord;
+    uint64_t head;
+
+    if ( pTraceRing != NULL )
+    {
+        /* reserve a record, the worker threads may record concurrently */
+        head = __atomic_fetch_add( &pTraceRing->head, 1, __ATOMIC_ACQ_REL );
+        pRecord = &pTraceRing->records[head &
+                                       ( VARSERVER_TRACE_RING_SIZE - 1 )];
+
+        /* invalidate the record while it is being written */
+        __atomic_store_n( &pRecord->seq, 0, __ATOMIC_RELAXED );
+        __atomic_thread_fence( __ATOMIC_SEQ_CST );
+
+        pRecord->timestamp = timestamp;
+        pRecord->duration = ( duration > UINT32_MAX ) ? UINT32_MAX
+                                                      : (uint32_t)duration;
+        pRecord->clientid = clientid;
+        pRecord->hVar = hVar;
+        pRecord->result = result;
+        pRecord->event = event;
+        pRecord->type = type;
+
+        /* publish the record */
+        __atomic_store_n( &pRecord->seq, head + 1, __ATOMIC_RELEASE );
+    }
+}
+
+/*! @}
+ * end of trace group */
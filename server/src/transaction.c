@@ -57,6 +57,7 @@ SOFTWARE.
 #include <string.h>
 #include <varserver/var.h>
 #include "transaction.h"
+#include "stats.h"
 
 /*==============================================================================
         Private definitions
@@ -164,6 +165,12 @@ int TRANSACTION_New( pid_t clientPID,
         {
             /* allocate a new Transaction object */
             pTransaction = calloc( 1, sizeof( Transaction ) );
+            if( pTransaction != NULL )
+            {
+                STATS_MemAlloc( STATS_MEM_TRANSACTIONS,
+                                1,
+                                sizeof( Transaction ) );
+            }
         }
 
         if( pTransaction != NULL )
@@ -319,7 +326,7 @@ void *TRANSACTION_Remove( uint32_t transactionID )
 
             /* remove the transaction from the transaction list
                and put it into the free list */
-            if( pPrevTransaction == transactionList )
+            if( pTransaction == transactionList )
             {
                 /* remove the transaction from the head of
                    the transaction list */
@@ -353,5 +360,57 @@ void *TRANSACTION_Remove( uint32_t transactionID )
     return pTransactionInfo;
 }
 
+/*============================================================================*/
+/*  TRANSACTION_RemoveByRequestor                                             */
+/*!
+    Remove all of the transactions of a requestor
+
+    The TRANSACTION_RemoveByRequestor function removes every transaction
+    initiated by the specified client process.  It is used to discard
+    the transactions of a client which has exited, so their transaction
+    information is never used again.
+
+    @param[in]
+        requestor
+            process identifier of the client which initiated the
+            transactions
+
+    @retval number of transactions removed
+
+==============================================================================*/
+size_t TRANSACTION_RemoveByRequestor( pid_t requestor )
+{
+    Transaction **pp = &transactionList;
+    Transaction *pTransaction;
+    size_t count = 0;
+
+    while( *pp != NULL )
+    {
+        pTransaction = *pp;
+        if( pTransaction->requestor == requestor )
+        {
+            /* remove the transaction from the transaction list */
+            *pp = pTransaction->pNext;
+
+            /* clear the transaction object */
+            pTransaction->requestor = -1;
+            pTransaction->pInfo = NULL;
+            pTransaction->transactionID = 0L;
+
+            /* move the transaction to the free list */
+            pTransaction->pNext = freelist;
+            freelist = pTransaction;
+
+            count++;
+        }
+        else
+        {
+            pp = &pTransaction->pNext;
+        }
+    }
+
+    return count;
+}
+
 /*! @}
  * end of transaction group */
@@ -36,6 +36,14 @@ SOFTWARE.
 
     The Validate List manages a list of in-progress data validations
 
+    It also tracks the validation requests sent to each validator.
+    Validators which set a batched validation policy are signalled
+    only when their queue of unfetched requests becomes non-empty,
+    and fetch and answer many requests per round trip.  Requests
+    which are not answered before the validator's deadline are
+    completed with its default response, so a hung validator cannot
+    block writers indefinitely.
+
 */
 /*============================================================================*/
 
@@ -54,6 +62,8 @@ SOFTWARE.
 #include <fcntl.h>
 #include <semaphore.h>
 #include <string.h>
+#include <stdbool.h>
+#include <time.h>
 #include <varserver/varclient.h>
 #include "validate.h"
 
@@ -87,9 +97,58 @@ typedef struct _ValidationRequest
 
 } ValidationRequest;
 
+/*! the Validator object holds the validation policy of a validator */
+typedef struct _Validator
+{
+    /*! process identifier of the validator */
+    pid_t pid;
+
+    /*! validation policy of the validator */
+    ValidationPolicy policy;
+
+    /*! indicates the validator has been signalled and has not yet
+        fetched all of its queued validation requests */
+    bool signalled;
+
+    /*! the pNext pointer points to the next validator */
+    struct _Validator *pNext;
+
+} Validator;
+
+/*! the PendingValidation object tracks a validation request which has
+    been sent to a validator and not yet answered */
+typedef struct _PendingValidation
+{
+    /*! transaction identifier of the validation request */
+    uint32_t id;
+
+    /*! process identifier of the validator */
+    pid_t validator;
+
+    /*! index of the SET_MANY item being validated, or -1 for a
+        single set request */
+    int item;
+
+    /*! indicates a batched validator has fetched the request */
+    bool fetched;
+
+    /*! time the request expires (CLOCK_MONOTONIC ns), 0 for never */
+    uint64_t deadline;
+
+    /*! response applied when the request expires */
+    int defaultResponse;
+
+    /*! the pNext pointer points to the next pending validation in
+        the order the requests were made */
+    struct _PendingValidation *pNext;
+
+} PendingValidation;
+
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
+static Validator *validate_FindValidator( pid_t pid );
+static uint64_t validate_Now( void );
 
 /*==============================================================================
         Private file scoped variables
@@ -104,6 +163,24 @@ static ValidationRequest *freelist = NULL;
 /*! Validation Request Counter */
 static uint32_t RequestCounter = 0L;
 
+/*! list of validators which have set a validation policy */
+static Validator *validatorList = NULL;
+
+/*! policy applied to validators which have not set one */
+static ValidationPolicy defaultPolicy = { false, 0, ETIMEDOUT };
+
+/*! oldest pending validation */
+static PendingValidation *pendingHead = NULL;
+
+/*! newest pending validation */
+static PendingValidation *pendingTail = NULL;
+
+/*! list of available PendingValidation objects */
+static PendingValidation *pendingFreelist = NULL;
+
+/*! SET_MANY item index of the validation requests being queued */
+static int batchItem = -1;
+
 /*==============================================================================
         Public function definitions
 ==============================================================================*/
@@ -259,6 +336,605 @@ int VALIDATE_GetRequest( uint32_t requestHandle,
     return result;
 }
 
+/*============================================================================*/
+/*  VALIDATE_SetPolicy                                                        */
+/*!
+    Set the validation policy of a validator
+
+    The VALIDATE_SetPolicy function records how validation requests are
+    delivered to the specified validator, and the deadline and default
+    response applied to the requests it does not answer in time.
+    The policy applies to validation requests made after it is set.
+
+    @param[in]
+        pid
+            process identifier of the validator
+
+    @param[in]
+        pPolicy
+            pointer to the validation policy
+
+    @retval EOK the validation policy was set
+    @retval ENOMEM memory allocation problem
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VALIDATE_SetPolicy( pid_t pid, ValidationPolicy *pPolicy )
+{
+    int result = EINVAL;
+    Validator *pValidator;
+
+    if( pPolicy != NULL )
+    {
+        pValidator = validate_FindValidator( pid );
+        if( pValidator == NULL )
+        {
+            pValidator = calloc( 1, sizeof( Validator ) );
+            if( pValidator != NULL )
+            {
+                pValidator->pid = pid;
+                pValidator->pNext = validatorList;
+                validatorList = pValidator;
+            }
+        }
+
+        if( pValidator != NULL )
+        {
+            pValidator->policy = *pPolicy;
+            result = EOK;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALIDATE_SetDefaultPolicy                                                 */
+/*!
+    Set the validation policy of validators which have not set one
+
+    The VALIDATE_SetDefaultPolicy function sets the deadline and default
+    response applied to the validation requests of validators which
+    have not set their own validation policy.  Such validators are
+    always signalled for each validation request.
+
+    @param[in]
+        pPolicy
+            pointer to the default validation policy
+
+    @retval EOK the default validation policy was set
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VALIDATE_SetDefaultPolicy( ValidationPolicy *pPolicy )
+{
+    int result = EINVAL;
+
+    if( pPolicy != NULL )
+    {
+        defaultPolicy = *pPolicy;
+        defaultPolicy.batch = false;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALIDATE_RemoveValidator                                                  */
+/*!
+    Remove a validator which has disconnected
+
+    The VALIDATE_RemoveValidator function discards the validation policy
+    of the specified validator, and makes its pending validation
+    requests expire immediately so the writers waiting for them are
+    released with the default response.
+
+    @param[in]
+        pid
+            process identifier of the validator
+
+    @retval EOK the validator was removed
+    @retval ENOENT the validator had no policy or pending requests
+
+==============================================================================*/
+int VALIDATE_RemoveValidator( pid_t pid )
+{
+    int result = ENOENT;
+    Validator *pValidator = validatorList;
+    Validator *pPrev = NULL;
+    PendingValidation *pPending;
+
+    while( pValidator != NULL )
+    {
+        if( pValidator->pid == pid )
+        {
+            if( pPrev == NULL )
+            {
+                validatorList = pValidator->pNext;
+            }
+            else
+            {
+                pPrev->pNext = pValidator->pNext;
+            }
+
+            free( pValidator );
+            result = EOK;
+            break;
+        }
+
+        pPrev = pValidator;
+        pValidator = pValidator->pNext;
+    }
+
+    for( pPending = pendingHead; pPending != NULL; pPending = pPending->pNext )
+    {
+        if( pPending->validator == pid )
+        {
+            /* expire the request as soon as possible */
+            pPending->deadline = 1;
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALIDATE_IsBatched                                                        */
+/*!
+    Check if a validator fetches its validation requests in batches
+
+    @param[in]
+        pid
+            process identifier of the validator
+
+    @retval true the validator uses batched validation
+    @retval false the validator is signalled for each validation request
+
+==============================================================================*/
+bool VALIDATE_IsBatched( pid_t pid )
+{
+    Validator *pValidator = validate_FindValidator( pid );
+
+    return ( pValidator != NULL ) ? pValidator->policy.batch : false;
+}
+
+/*============================================================================*/
+/*  VALIDATE_SetBatchItem                                                     */
+/*!
+    Set the SET_MANY item index of the validation requests being queued
+
+    The VALIDATE_SetBatchItem function is called before each item of a
+    SET_MANY request is set, so the validation requests queued for it
+    record which item they belong to.  It is reset to -1 once the
+    SET_MANY request has been processed.
+
+    @param[in]
+        item
+            index of the SET_MANY item, or -1 for a single set request
+
+==============================================================================*/
+void VALIDATE_SetBatchItem( int item )
+{
+    batchItem = item;
+}
+
+/*============================================================================*/
+/*  VALIDATE_Queue                                                            */
+/*!
+    Queue a validation request for a validator
+
+    The VALIDATE_Queue function records a new validation request, and
+    starts its deadline.  A validator which uses batched validation is
+    only signalled when it has no other queued validation requests
+    which it has not fetched.
+
+    @param[in]
+        validator
+            process identifier of the validator
+
+    @param[in]
+        id
+            transaction identifier of the validation request
+
+    @param[out]
+        pSignal
+            pointer to a location to store whether the validator must
+            be signalled
+
+    @retval EOK the validation request was queued
+    @retval ENOMEM memory allocation problem
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VALIDATE_Queue( pid_t validator, uint32_t id, bool *pSignal )
+{
+    int result = EINVAL;
+    PendingValidation *pPending;
+    Validator *pValidator;
+    ValidationPolicy *pPolicy = &defaultPolicy;
+
+    if( pSignal != NULL )
+    {
+        *pSignal = true;
+
+        pValidator = validate_FindValidator( validator );
+        if( pValidator != NULL )
+        {
+            pPolicy = &pValidator->policy;
+        }
+
+        if( pendingFreelist != NULL )
+        {
+            /* get a PendingValidation object from the free list */
+            pPending = pendingFreelist;
+            pendingFreelist = pendingFreelist->pNext;
+        }
+        else
+        {
+            /* allocate a new PendingValidation object */
+            pPending = calloc( 1, sizeof( PendingValidation ) );
+        }
+
+        if( pPending != NULL )
+        {
+            pPending->id = id;
+            pPending->validator = validator;
+            pPending->item = batchItem;
+            pPending->fetched = false;
+            pPending->defaultResponse = pPolicy->defaultResponse;
+            pPending->deadline = ( pPolicy->deadline_ms != 0 )
+                ? validate_Now() + pPolicy->deadline_ms * 1000000ULL
+                : 0;
+            pPending->pNext = NULL;
+
+            /* append to the tail so requests are fetched in order */
+            if( pendingTail == NULL )
+            {
+                pendingHead = pPending;
+            }
+            else
+            {
+                pendingTail->pNext = pPending;
+            }
+
+            pendingTail = pPending;
+
+            if( ( pPolicy->batch == true ) &&
+                ( pValidator != NULL ) )
+            {
+                /* only signal when the batch queue becomes non-empty */
+                *pSignal = ( pValidator->signalled == false );
+                pValidator->signalled = true;
+            }
+
+            result = EOK;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALIDATE_Next                                                             */
+/*!
+    Fetch the next queued validation request of a validator
+
+    The VALIDATE_Next function gets the oldest validation request for
+    the specified validator which it has not fetched yet, and marks it
+    as fetched.  The request remains pending until it is completed.
+    Once all of the validator's requests have been fetched, the
+    validator will be signalled again for its next request.
+
+    @param[in]
+        validator
+            process identifier of the validator
+
+    @param[out]
+        pID
+            pointer to a location to store the transaction identifier
+
+    @param[out]
+        pItem
+            pointer to a location to store the SET_MANY item index
+
+    @retval EOK a validation request was fetched
+    @retval ENOENT the validator has no more queued validation requests
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VALIDATE_Next( pid_t validator, uint32_t *pID, int *pItem )
+{
+    int result = EINVAL;
+    PendingValidation *pPending;
+    Validator *pValidator;
+
+    if( ( pID != NULL ) &&
+        ( pItem != NULL ) )
+    {
+        result = ENOENT;
+
+        for( pPending = pendingHead;
+             pPending != NULL;
+             pPending = pPending->pNext )
+        {
+            if( ( pPending->validator == validator ) &&
+                ( pPending->fetched == false ) )
+            {
+                pPending->fetched = true;
+                *pID = pPending->id;
+                *pItem = pPending->item;
+                result = EOK;
+                break;
+            }
+        }
+
+        if( result == ENOENT )
+        {
+            pValidator = validate_FindValidator( validator );
+            if( pValidator != NULL )
+            {
+                pValidator->signalled = false;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALIDATE_GetItem                                                          */
+/*!
+    Get the item index of a pending validation request
+
+    The VALIDATE_GetItem function gets the index of the item of a
+    batched set request which a pending validation request belongs to.
+
+    @param[in]
+        id
+            transaction identifier of the validation request
+
+    @param[out]
+        pItem
+            pointer to a location to store the item index, which is -1
+            if the request is not part of a batched set request
+
+    @retval EOK the item index was retrieved
+    @retval ENOENT the validation request was not found
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VALIDATE_GetItem( uint32_t id, int *pItem )
+{
+    int result = EINVAL;
+    PendingValidation *pPending;
+
+    if( pItem != NULL )
+    {
+        *pItem = -1;
+        result = ENOENT;
+
+        for( pPending = pendingHead;
+             pPending != NULL;
+             pPending = pPending->pNext )
+        {
+            if( pPending->id == id )
+            {
+                *pItem = pPending->item;
+                result = EOK;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALIDATE_Complete                                                         */
+/*!
+    Complete a pending validation request
+
+    The VALIDATE_Complete function removes a validation request which
+    has been answered or has expired from the pending validations.
+
+    @param[in]
+        id
+            transaction identifier of the validation request
+
+    @param[out]
+        pItem
+            pointer to a location to store the SET_MANY item index
+            of the request, which is -1 if the request was not found
+
+    @retval EOK the validation request was completed
+    @retval ENOENT the validation request was not found
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VALIDATE_Complete( uint32_t id, int *pItem )
+{
+    int result = EINVAL;
+    PendingValidation *pPending = pendingHead;
+    PendingValidation *pPrev = NULL;
+
+    if( pItem != NULL )
+    {
+        *pItem = -1;
+        result = ENOENT;
+
+        while( pPending != NULL )
+        {
+            if( pPending->id == id )
+            {
+                if( pPrev == NULL )
+                {
+                    pendingHead = pPending->pNext;
+                }
+                else
+                {
+                    pPrev->pNext = pPending->pNext;
+                }
+
+                if( pendingTail == pPending )
+                {
+                    pendingTail = pPrev;
+                }
+
+                *pItem = pPending->item;
+
+                /* move the pending validation to the free list */
+                pPending->pNext = pendingFreelist;
+                pendingFreelist = pPending;
+
+                result = EOK;
+                break;
+            }
+
+            pPrev = pPending;
+            pPending = pPending->pNext;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALIDATE_Expired                                                          */
+/*!
+    Get a validation request whose deadline has expired
+
+    The VALIDATE_Expired function finds the oldest pending validation
+    request whose deadline has passed.  The caller applies the default
+    response and completes it using VALIDATE_Complete.
+
+    @param[in]
+        now
+            current time (CLOCK_MONOTONIC ns)
+
+    @param[out]
+        pID
+            pointer to a location to store the transaction identifier
+
+    @param[out]
+        pResponse
+            pointer to a location to store the default response
+
+    @retval EOK an expired validation request was found
+    @retval ENOENT no validation requests have expired
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VALIDATE_Expired( uint64_t now, uint32_t *pID, int *pResponse )
+{
+    int result = EINVAL;
+    PendingValidation *pPending;
+
+    if( ( pID != NULL ) &&
+        ( pResponse != NULL ) )
+    {
+        result = ENOENT;
+
+        for( pPending = pendingHead;
+             pPending != NULL;
+             pPending = pPending->pNext )
+        {
+            if( ( pPending->deadline != 0 ) &&
+                ( pPending->deadline <= now ) )
+            {
+                *pID = pPending->id;
+                *pResponse = pPending->defaultResponse;
+                result = EOK;
+                break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VALIDATE_Due                                                              */
+/*!
+    Get the time the next validation request expires
+
+    @retval time the next pending validation request expires
+            (CLOCK_MONOTONIC ns)
+    @retval 0 no pending validation requests have a deadline
+
+==============================================================================*/
+uint64_t VALIDATE_Due( void )
+{
+    uint64_t due = 0;
+    PendingValidation *pPending;
+
+    for( pPending = pendingHead; pPending != NULL; pPending = pPending->pNext )
+    {
+        if( ( pPending->deadline != 0 ) &&
+            ( ( due == 0 ) || ( pPending->deadline < due ) ) )
+        {
+            due = pPending->deadline;
+        }
+    }
+
+    return due;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  validate_FindValidator                                                    */
+/*!
+    Find the validation policy of a validator
+
+    @param[in]
+        pid
+            process identifier of the validator
+
+    @retval pointer to the Validator object
+    @retval NULL the validator has not set a validation policy
+
+==============================================================================*/
+static Validator *validate_FindValidator( pid_t pid )
+{
+    Validator *pValidator = validatorList;
+
+    while( ( pValidator != NULL ) &&
+           ( pValidator->pid != pid ) )
+    {
+        pValidator = pValidator->pNext;
+    }
+
+    return pValidator;
+}
+
+/*============================================================================*/
+/*  validate_Now                                                              */
+/*!
+    Get the current time
+
+    @retval current CLOCK_MONOTONIC time in nanoseconds
+
+==============================================================================*/
+static uint64_t validate_Now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
 
 /*! @}
  * end of validate group */
@@ -0,0 +1,442 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup varindex Variable Flag and Tag Index
+ * @brief Bitmap inverted index of variable flags and tags
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file varindex.c
+
+    Variable Flag and Tag Index
+
+    The Variable Flag and Tag Index maintains one bitmap per variable
+    flag and one bitmap per tag, each with one bit per variable handle.
+    Flag and tag queries are answered by combining the bitmaps a 64-bit
+    word at a time (OR of the queried flags, optionally inverted, AND each
+    of the queried tags) and visiting only the set bits, rather than
+    matching every variable individually.
+
+    The flag bitmaps are allocated up front, the tag bitmaps are allocated
+    when the tag is first assigned to a variable.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include "taglist.h"
+#include "varindex.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! number of variable flag bits */
+#define VARINDEX_NUM_FLAGS ( 32 )
+
+/*! number of handles per bitmap word */
+#define VARINDEX_WORD_BITS ( 64 )
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! number of 64-bit words in each bitmap */
+static size_t numWords = 0;
+
+/*! one bitmap per variable flag bit */
+static uint64_t *flagIndex[VARINDEX_NUM_FLAGS] = {NULL};
+
+/*! one bitmap per tag number */
+static uint64_t *tagIndex[VARSERVER_MAX_TAGS + 1] = {NULL};
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void varindex_SetBit( uint64_t *pBitmap, VAR_HANDLE hVar, bool set );
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  VARINDEX_Init                                                             */
+/*!
+    Initialize the variable flag and tag index
+
+    The VARINDEX_Init function allocates the flag bitmaps for the
+    specified number of variable handles.
+
+    @param[in]
+        n
+            maximum number of variable handles
+
+    @retval EOK the index was successfully initialized
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARINDEX_Init( size_t n )
+{
+    int result = EINVAL;
+    int i;
+
+    if ( n > 0 )
+    {
+        result = EOK;
+
+        /* handle 0 is never used, so allow for handles 0..n */
+        numWords = ( n / VARINDEX_WORD_BITS ) + 1;
+
+        for ( i = 0; i < VARINDEX_NUM_FLAGS; i++ )
+        {
+            flagIndex[i] = calloc( numWords, sizeof( uint64_t ) );
+            if ( flagIndex[i] == NULL )
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARINDEX_SetFlags                                                         */
+/*!
+    Update the flag index for a variable
+
+    The VARINDEX_SetFlags function sets the variable handle's bit in
+    the bitmap of each flag which is set, and clears it in the bitmap
+    of each flag which is not set.
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        flags
+            current flags of the variable
+
+    @retval EOK the flag index was updated
+    @retval ENOMEM the flag index is not available
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARINDEX_SetFlags( VAR_HANDLE hVar, uint32_t flags )
+{
+    int result = EINVAL;
+    int i;
+
+    if ( ( hVar != VAR_INVALID ) &&
+         ( hVar / VARINDEX_WORD_BITS < numWords ) )
+    {
+        result = EOK;
+
+        for ( i = 0; i < VARINDEX_NUM_FLAGS; i++ )
+        {
+            if ( flagIndex[i] != NULL )
+            {
+                varindex_SetBit( flagIndex[i],
+                                 hVar,
+                                 ( flags & ( 1UL << i ) ) ? true : false );
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARINDEX_SetTags                                                          */
+/*!
+    Add or remove a variable from the tag index
+
+    The VARINDEX_SetTags function sets (or clears) the variable handle's
+    bit in the bitmap of each of the specified tags.
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        pTags
+            pointer to the variable's tag number array (0 terminated)
+
+    @param[in]
+        len
+            maximum number of tags in the tag number array
+
+    @param[in]
+        set
+            true to add the variable to the tag bitmaps,
+            false to remove it
+
+    @retval EOK the tag index was updated
+    @retval ENOMEM memory allocation failure
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARINDEX_SetTags( VAR_HANDLE hVar,
+                      uint16_t *pTags,
+                      size_t len,
+                      bool set )
+{
+    int result = EINVAL;
+    uint16_t tag;
+    size_t i;
+
+    if ( ( pTags != NULL ) &&
+         ( hVar != VAR_INVALID ) &&
+         ( hVar / VARINDEX_WORD_BITS < numWords ) )
+    {
+        result = EOK;
+
+        for ( i = 0; ( i < len ) && ( pTags[i] != 0 ); i++ )
+        {
+            tag = pTags[i];
+            if ( tag > VARSERVER_MAX_TAGS )
+            {
+                result = EINVAL;
+                continue;
+            }
+
+            if ( ( tagIndex[tag] == NULL ) && ( set == true ) )
+            {
+                tagIndex[tag] = calloc( numWords, sizeof( uint64_t ) );
+                if ( tagIndex[tag] == NULL )
+                {
+                    result = ENOMEM;
+                }
+            }
+
+            if ( tagIndex[tag] != NULL )
+            {
+                varindex_SetBit( tagIndex[tag], hVar, set );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARINDEX_Query                                                            */
+/*!
+    Find the variables matching a flag and tag query
+
+    The VARINDEX_Query function combines the flag and tag bitmaps
+    according to the search type, and invokes the callback function
+    for each matching variable handle in ascending handle order.
+
+    A QUERY_FLAGS search matches variables with any of the specified
+    flags set, or with none of them set if QUERY_NEGATE_FLAGS is also
+    specified.  A QUERY_TAGS search matches variables which have all
+    of the specified tags.
+
+    @param[in]
+        searchType
+            search type bitfield containing QUERY_FLAGS, QUERY_TAGS
+            and/or QUERY_NEGATE_FLAGS.  Other search types are ignored.
+
+    @param[in]
+        flags
+            flags to search for when QUERY_FLAGS is specified
+
+    @param[in]
+        pTags
+            pointer to the tags to search for when QUERY_TAGS is specified
+
+    @param[in]
+        len
+            maximum number of tags in the tag number array
+
+    @param[in]
+        maxHandle
+            the highest variable handle in use
+
+    @param[in]
+        fn
+            callback function invoked for each matching variable
+
+    @param[in]
+        arg
+            opaque argument passed to the callback function
+
+    @retval EOK the query completed
+    @retval EINVAL invalid arguments
+    @retval other the value returned by the callback to stop the query
+
+==============================================================================*/
+int VARINDEX_Query( int searchType,
+                    uint32_t flags,
+                    uint16_t *pTags,
+                    size_t len,
+                    VAR_HANDLE maxHandle,
+                    VarIndexFn fn,
+                    void *arg )
+{
+    int result = EINVAL;
+    size_t lastWord;
+    size_t w;
+    size_t i;
+    uint64_t bits;
+    uint64_t any;
+    uint16_t tag;
+    int k;
+
+    if ( ( fn != NULL ) &&
+         ( ( ( searchType & QUERY_TAGS ) == 0 ) || ( pTags != NULL ) ) &&
+         ( numWords > 0 ) )
+    {
+        result = EOK;
+
+        lastWord = maxHandle / VARINDEX_WORD_BITS;
+        if ( lastWord >= numWords )
+        {
+            lastWord = numWords - 1;
+        }
+
+        for ( w = 0; ( w <= lastWord ) && ( result == EOK ); w++ )
+        {
+            bits = ~(uint64_t)0;
+
+            if ( searchType & QUERY_FLAGS )
+            {
+                /* any of the flags */
+                any = 0;
+                for ( k = 0; k < VARINDEX_NUM_FLAGS; k++ )
+                {
+                    if ( ( flags & ( 1UL << k ) ) &&
+                         ( flagIndex[k] != NULL ) )
+                    {
+                        any |= flagIndex[k][w];
+                    }
+                }
+
+                bits = ( searchType & QUERY_NEGATE_FLAGS ) ? ~any : any;
+            }
+
+            if ( searchType & QUERY_TAGS )
+            {
+                /* all of the tags */
+                for ( i = 0; ( i < len ) && ( pTags[i] != 0 ); i++ )
+                {
+                    tag = pTags[i];
+                    if ( ( tag <= VARSERVER_MAX_TAGS ) &&
+                         ( tagIndex[tag] != NULL ) )
+                    {
+                        bits &= tagIndex[tag][w];
+                    }
+                    else
+                    {
+                        bits = 0;
+                    }
+                }
+            }
+
+            if ( w == 0 )
+            {
+                /* handle 0 is not a valid variable handle */
+                bits &= ~(uint64_t)1;
+            }
+
+            if ( ( w == lastWord ) &&
+                 ( ( maxHandle % VARINDEX_WORD_BITS ) <
+                   ( VARINDEX_WORD_BITS - 1 ) ) )
+            {
+                /* exclude handles which are not in use */
+                bits &= ( (uint64_t)2 << ( maxHandle % VARINDEX_WORD_BITS ) )
+                        - 1;
+            }
+
+            /* visit each set bit */
+            while ( ( bits != 0 ) && ( result == EOK ) )
+            {
+                result = fn( ( w * VARINDEX_WORD_BITS ) +
+                             __builtin_ctzll( bits ),
+                             arg );
+
+                /* clear the lowest set bit */
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  varindex_SetBit                                                           */
+/*!
+    Set or clear a variable handle's bit in a bitmap
+
+    @param[in]
+        pBitmap
+            pointer to the bitmap to update
+
+    @param[in]
+        hVar
+            handle of the variable
+
+    @param[in]
+        set
+            true to set the bit, false to clear it
+
+==============================================================================*/
+static void varindex_SetBit( uint64_t *pBitmap, VAR_HANDLE hVar, bool set )
+{
+    uint64_t mask = (uint64_t)1 << ( hVar % VARINDEX_WORD_BITS );
+
+    if ( set == true )
+    {
+        pBitmap[hVar / VARINDEX_WORD_BITS] |= mask;
+    }
+    else
+    {
+        pBitmap[hVar / VARINDEX_WORD_BITS] &= ~mask;
+    }
+}
+
+/*! @}
+ * end of varindex group */
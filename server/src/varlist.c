@@ -59,6 +59,7 @@ SOFTWARE.
 #include <syslog.h>
 #include <ctype.h>
 #include <regex.h>
+#include <pthread.h>
 #include <varserver/varclient.h>
 #include <varserver/varserver.h>
 #include <varserver/varobject.h>
@@ -69,12 +70,42 @@ SOFTWARE.
 #include "notify.h"
 #include "blocklist.h"
 #include "transaction.h"
+#include "validate.h"
 #include "hash.h"
+#include "radix.h"
+#include "varindex.h"
+#include "sharedvalues.h"
+#include "sharedblobs.h"
+#include "varversions.h"
+#include "changering.h"
+#include "slab.h"
+#include "namepool.h"
+#include "journal.h"
+#include "standby.h"
+#include "history.h"
+#include "permsets.h"
+#include "stats.h"
 
 /*==============================================================================
         Private definitions
 ==============================================================================*/
 
+/*! maximum number of notifications which can be deferred during a batch */
+#define VARLIST_MAX_BATCH_NOTIFICATIONS ( 1024 )
+
+/*! number of words in the handle bitmap of a query subscription */
+#define VARLIST_QUERY_BITMAP_WORDS  ( ( maxVariables / 64 ) + 1 )
+
+/*! log2 of the number of VarID objects in a variable storage chunk */
+#define VARLIST_CHUNK_SHIFT ( 10 )
+
+/*! number of VarID objects in a variable storage chunk */
+#define VARLIST_CHUNK_SIZE ( 1 << VARLIST_CHUNK_SHIFT )
+
+/*! maximum number of candidates examined for a single page, so a long
+    search yields to other requests between pages */
+#define VARLIST_PAGE_SLICE ( 4096 )
+
 /*==============================================================================
         Type definitions
 ==============================================================================*/
@@ -97,6 +128,21 @@ typedef struct _searchContext
     /*! variable tag specifiers */
     uint16_t tags[MAX_TAGS_LEN];
 
+    /*! indicates the search steps through a candidate list */
+    bool indexed;
+
+    /*! candidate variables from the name or flag/tag index */
+    VAR_HANDLE *pCandidates;
+
+    /*! number of candidate variables */
+    size_t numCandidates;
+
+    /*! number of allocated candidate handles */
+    size_t maxCandidates;
+
+    /*! search position: candidate index, or last examined handle */
+    size_t cursor;
+
     /*! pointer to the next search context */
     struct _searchContext *pNext;
 } SearchContext;
@@ -111,23 +157,40 @@ typedef struct _VarAlias
     struct _VarAlias *pNext;
 } VarAlias;
 
-/*! The VarStorage object is used internally by the varserver to
-    encapsulate all the information about a single variable */
-typedef struct _VarStorage
+/*! The set plan of a variable selects how its values are stored.
+    Variables which are not read-only, and have no triggers, auditing,
+    history or notifications, get the plan of their storage type, and
+    values of the same type are stored by the fast set path */
+typedef enum _SetPlan
 {
-    /*! reference counter counts the number of variables
-        associated with this storage */
-    uint16_t refCount;
+    /*! every value is stored by the general set path */
+    SETPLAN_GENERAL = 0,
 
-    /*! storage reference id */
-    uint32_t storageRef;
+    /*! 16-bit values of the same type take the fast set path */
+    SETPLAN_16,
 
-    /*! variable data */
-    VarObject var;
+    /*! 32-bit values of the same type take the fast set path */
+    SETPLAN_32,
 
-    /*! variable flags */
-    uint32_t flags;
+    /*! 64-bit values of the same type take the fast set path */
+    SETPLAN_64,
+
+    /*! float values take the fast set path */
+    SETPLAN_FLOAT
+
+} SetPlan;
 
+/*! variable flags which require the general set path */
+#define SETPLAN_GENERAL_FLAGS ( VARFLAG_READONLY | \
+                                VARFLAG_TRIGGER | \
+                                VARFLAG_AUDIT | \
+                                VARFLAG_HISTORY )
+
+/*! Variable metadata which is not needed on the get and set paths.
+    It is kept apart from the VarStorage object so the storage objects
+    stay small and densely packed */
+typedef struct _VarMeta
+{
     /*! variable tag specifiers */
     uint16_t tags[MAX_TAGS_LEN];
 
@@ -137,15 +200,68 @@ typedef struct _VarStorage
     /*! variable permissions */
     VarPermissions permissions;
 
-    /*! pointer to the notification list for this variable */
-    Notification *pNotifications;
+    /*! permission set of the read permissions */
+    uint64_t readSet;
 
-    /* indicate if this variable has an associated CALC notification */
-    uint16_t notifyMask;
+    /*! permission set of the write permissions */
+    uint64_t writeSet;
+
+    /*! per-type notification lists for this variable */
+    NotificationList notifications;
 
     /*! list of aliases */
     VarAlias *pAliases;
 
+    /*! zero-copy segment holding a blob value, NULL=server heap */
+    SharedBlob *pSharedBlob;
+
+    /*! lifetime of a calculated value (ns), 0=not cached */
+    uint64_t calcTTL;
+
+    /*! time the cached calculated value expires, 0=none cached */
+    uint64_t calcExpiry;
+
+    /*! recent values of a VARFLAG_HISTORY variable, NULL=none recorded */
+    HistoryRing *pHistory;
+
+} VarMeta;
+
+/*! The VarStorage object is used internally by the varserver to
+    encapsulate all the information about a single variable */
+typedef struct _VarStorage
+{
+    /*! variable data */
+    VarObject var;
+
+    /*! time a rate limited NOTIFY_MODIFIED notification is due,
+        0=none deferred */
+    uint64_t modifiedDue;
+
+    /*! infrequently accessed variable metadata */
+    VarMeta *pMeta;
+
+    /*! storage reference id */
+    uint32_t storageRef;
+
+    /*! variable flags */
+    uint32_t flags;
+
+    /*! reference counter counts the number of variables
+        associated with this storage */
+    uint16_t refCount;
+
+    /* indicate if this variable has an associated CALC notification */
+    uint16_t notifyMask;
+
+    /*! slot in the shared value segment, 0=not shared */
+    uint16_t sharedSlot;
+
+    /*! indicates the value is modified directly, outside of VARLIST_Set */
+    bool directAccess;
+
+    /*! set plan of the variable, see varlist_UpdateSetPlan */
+    uint8_t setPlan;
+
 } VarStorage;
 
 /*! Variable Identifier */
@@ -157,8 +273,8 @@ typedef struct _var_id
     /*! instance identifier for this variable */
     uint32_t instanceID;
 
-    /*! name of the variable */
-    char name[MAX_NAME_LEN+1];
+    /*! name of the variable, in the name pool */
+    const char *name;
 
     /*! globally unique identifier for the variable */
     uint32_t guid;
@@ -168,6 +284,58 @@ typedef struct _var_id
 
 } VarID;
 
+/*! A NOTIFY_MODIFIED subscription to all of the variables
+    which match a query */
+typedef struct _QuerySubscription
+{
+    /*! subscription identifier */
+    int id;
+
+    /*! query parameters and the owning client */
+    SearchContext ctx;
+
+    /*! credentials of the subscribing client */
+    VarInfo creds;
+
+    /*! bit assignment generation of the credentials permission set */
+    uint64_t generation;
+
+    /*! bitmap of the variable handles which match the query */
+    uint64_t *pHandles;
+
+    /*! pointer to the next query subscription */
+    struct _QuerySubscription *pNext;
+
+} QuerySubscription;
+
+/*! A notification deferred until the end of a batch request */
+typedef struct _BatchNotification
+{
+    /*! process identifier of the client which modified the variable */
+    pid_t clientPID;
+
+    /*! pointer to the storage of the modified variable */
+    VarStorage *pVarStorage;
+
+    /*! handle of the modified variable */
+    VAR_HANDLE hVar;
+
+} BatchNotification;
+
+/*! Context of a VARLIST_ForEachNotification iteration */
+typedef struct _NotificationVisit
+{
+    /*! function to call for each notification */
+    VarNotifyFn fn;
+
+    /*! opaque argument passed to the function */
+    void *arg;
+
+    /*! lifetime of the calculated values of the variable in nanoseconds */
+    uint64_t calcTTL;
+
+} NotificationVisit;
+
 /*==============================================================================
         Private file scoped variables
 ==============================================================================*/
@@ -175,8 +343,13 @@ typedef struct _var_id
 /*! counts the number of variables in the list */
 static int varcount = 0;
 
-/*! variable storage */
-static VarID varstore[ VARSERVER_MAX_VARIABLES ] = {0};
+/*! maximum number of variables */
+static size_t maxVariables = VARSERVER_MAX_VARIABLES;
+
+/*! variable storage chunks indexed by the upper bits of the handle.
+    Chunks are allocated as they are needed and are never moved, so
+    VarID pointers remain valid as the variable storage grows */
+static VarID **varstore = NULL;
 
 /*! search contexts */
 static SearchContext *pSearchContexts = NULL;
@@ -187,9 +360,62 @@ static int contextIdent = 0;
 /*! id of user that started varserver */
 static uid_t varserver_uid;
 
+/*! indicates the calling thread is a read-only request worker, which
+    must not modify the variable store */
+static __thread bool readOnlyThread = false;
+
+/*! protects the search context list from concurrent workers */
+static pthread_mutex_t searchContextLock = PTHREAD_MUTEX_INITIALIZER;
+
+/*! pointer to the name resolution generation counter */
+static uint64_t *pGeneration = NULL;
+
 /*! Number of VarStorage objects we have created */
 static uint32_t NumVarStorage = 0;
 
+/*! indicates a batch request is being processed */
+static bool batchInProgress = false;
+
+/*! notifications deferred until the end of the current batch */
+static BatchNotification batchNotifications[VARLIST_MAX_BATCH_NOTIFICATIONS];
+
+/*! number of deferred batch notifications */
+static size_t numBatchNotifications = 0;
+
+/*! variables with rate limited NOTIFY_MODIFIED notifications waiting
+    to be sent */
+static VarStorage **pRateLimited = NULL;
+
+/*! number of variables in the pRateLimited list */
+static size_t numRateLimited = 0;
+
+/*! allocated size of the pRateLimited list */
+static size_t maxRateLimited = 0;
+
+/*! earliest time a rate limited notification is due, 0=none */
+static uint64_t rateLimitedDue = 0;
+
+/*! pointer to the counter of gets answered from a cached CALC value */
+static uint64_t *pCalcCacheHitsMetric = NULL;
+
+/*! pointer to the counter of gets which joined a CALC in progress */
+static uint64_t *pCalcCoalescedMetric = NULL;
+
+/*! size class for VarStorage objects */
+static SlabClass *pStorageSlab = NULL;
+
+/*! size class for VarMeta objects */
+static SlabClass *pMetaSlab = NULL;
+
+/*! size class for VarAlias objects */
+static SlabClass *pAliasSlab = NULL;
+
+/*! list of query subscriptions */
+static QuerySubscription *pQuerySubscriptions = NULL;
+
+/*! last assigned query subscription identifier */
+static int querySubscriptionIdent = 0;
+
 /*==============================================================================
         Private function declarations
 ==============================================================================*/
@@ -207,26 +433,65 @@ static int varlist_SetFloat( VarStorage *pVarStorage, VarInfo *pVarInfo );
 static int varlist_SetStr( VarStorage *pVarStorage, VarInfo *pVarInfo );
 static int varlist_SetBlob( VarStorage *pVarStorage, VarInfo *pVarInfo );
 static int varlist_Calc( VarClient *pVarClient, void *arg );
+static bool varlist_CalcCached( VarStorage *pVarStorage );
+static int varlist_RequestCalc( pid_t clientPID,
+                                VarStorage *pVarStorage,
+                                VAR_HANDLE hVar );
 
 static int varlist_SendNotifications( pid_t clientPID,
                                       VarStorage *pVarStorage,
                                       VAR_HANDLE hVar );
+static int varlist_DeferNotifications( pid_t clientPID,
+                                       VarStorage *pVarStorage,
+                                       VAR_HANDLE hVar );
+static int varlist_RateLimit( VarStorage *pVarStorage, uint64_t due );
+static void varlist_SyncNotifyMask( VarStorage *pVarStorage );
 
 static int varlist_HandleTrigger( pid_t clientPID,
                                   VarStorage *pVarStorage,
                                   VAR_HANDLE hVar );
 
+static int varlist_RequestValidation( pid_t clientPID,
+                                      VarStorage *pVarStorage,
+                                      pid_t validator,
+                                      void *clientInfo );
+
 static SearchContext *varlist_NewSearchContext( pid_t clientPID,
                                                 int searchType,
                                                 VarInfo *pVarInfo,
                                                 char *searchText );
+static void varlist_InitSearchContext( SearchContext *p,
+                                       pid_t clientPID,
+                                       int searchType,
+                                       VarInfo *pVarInfo,
+                                       char *searchText );
 static int varlist_DeleteSearchContext( SearchContext *ctx );
 static SearchContext *varlist_FindSearchContext( pid_t clientPID,
                                                  int context );
 
 static int varlist_Match( VarID *pVarID, SearchContext *ctx );
+static VAR_HANDLE varlist_NextCandidate( SearchContext *ctx );
+static int varlist_PackRecord( VarID *pVarID,
+                               char *buf,
+                               size_t len,
+                               bool withValue,
+                               size_t *pSize );
+static int varlist_FindCandidates( SearchContext *ctx );
+static int varlist_AddCandidate( SearchContext *ctx, VAR_HANDLE hVar );
+static int varlist_PrefixCandidate( void *object, void *arg );
+static int varlist_IndexCandidate( VAR_HANDLE hVar, void *arg );
+static int varlist_IndexStorage( VarStorage *pVarStorage, VarID *pVarID );
 static int varlist_MatchTags( uint16_t *pHaystack, uint16_t *pNeedle );
 
+static bool varlist_QueryMatch( QuerySubscription *pSubscription,
+                                VarID *pVarID );
+static void varlist_QueryEvaluate( VarID *pVarID );
+static void varlist_QueryNotify( VarStorage *pVarStorage, VAR_HANDLE hVar );
+static VAR_HANDLE varlist_QueryHandle( QuerySubscription *pSubscription,
+                                       VarStorage *pVarStorage,
+                                       VAR_HANDLE hVar );
+static void varlist_DeleteQuerySubscription( QuerySubscription *p );
+
 static int assign_BlobVarInfo( VarStorage *pVarStorage, VarInfo *pVarInfo );
 static int assign_StringVarInfo( VarStorage *pVarStorage, VarInfo *pVarInfo );
 
@@ -239,7 +504,7 @@ static void *varlist_GetNotificationPayload( VAR_HANDLE hVar,
                                              VarStorage *pVarStorage,
                                              size_t *size );
 
-static void varlist_SetDirty( VarStorage *pVarStorage );
+static void varlist_SetDirty( VarID *pVarID );
 
 static bool varlist_CheckReadPermissions( VarInfo *pVarInfo,
                                           VarID *pVarID );
@@ -247,11 +512,43 @@ static bool varlist_CheckReadPermissions( VarInfo *pVarInfo,
 static bool varlist_CheckWritePermissions( VarInfo *pVarInfo,
                                            VarID *pVarStorage );
 
+static bool varlist_CheckPermissionSet( VarInfo *pVarInfo,
+                                        uint64_t set,
+                                        gid_t *q,
+                                        size_t m );
+
+static uint64_t varlist_MemUsage( VarStorage *pVarStorage );
+
 static int varlist_Audit( pid_t clientPID,
                           VarID *pVarID,
                           VarInfo *pVarInfo );
 
+static void varlist_RecordHistory( VarStorage *pVarStorage );
+static int varlist_Changed( pid_t clientPID,
+                            VarID *pVarID,
+                            VarInfo *pVarInfo,
+                            int result );
+static void varlist_UpdateSetPlan( VarStorage *pVarStorage );
+static int varlist_FastSet( pid_t clientPID,
+                            VarID *pVarID,
+                            VarInfo *pVarInfo );
+static int varlist_Compare( VarStorage *pVarStorage,
+                            const VarObject *pExpected );
+static int varlist_ModifyValue( VarObject *pValue,
+                                int op,
+                                const VarObject *pOperand );
+static int varlist_GetNumber( const VarObject *pOperand, double *pNumber );
+static int varlist_ModifyInteger( VarObject *pValue,
+                                  int op,
+                                  const VarObject *pOperand );
+
 static VarID *varlist_FindVar( VarInfo *pVarInfo );
+static VarID *varlist_HandleVarID( VAR_HANDLE hVar );
+static VarID *varlist_NewVarID( VAR_HANDLE hVar );
+
+static uint32_t varlist_Hash( VarInfo *pVarInfo );
+
+static bool varlist_MatchName( void *object, void *key );
 
 static VarID *varlist_GetVarID( VarInfo *pVarInfo );
 
@@ -268,10 +565,102 @@ static int varlist_MoveAlias( VarID *pAliasID,
 static VarAlias *varlist_DeleteAliasReference( VarID *pVarID,
                                                VarStorage *pVarStorage );
 
+static int varlist_VisitNotification( VAR_HANDLE hVar,
+                                      NotificationType type,
+                                      pid_t pid,
+                                      const VarNotifyOptions *pOptions,
+                                      void *arg );
+
 /*==============================================================================
         Public function definitions
 ==============================================================================*/
 
+/*============================================================================*/
+/*  VARLIST_Init                                                              */
+/*!
+    Initialize the variable list
+
+    The VARLIST_Init function sets the maximum number of variables and
+    creates the slab allocator size classes for the variable storage,
+    metadata, and alias objects, and reserves the variable name pool.
+    It must be called after SLAB_Init and before any variables are
+    created.
+
+    The variable storage itself grows in chunks as variables are added,
+    so the capacity only limits the number of variables.
+
+    @param[in]
+        capacity
+            maximum number of variables
+
+    @retval EOK the variable list was initialized
+    @retval ENOMEM the size classes or name pool could not be created
+    @retval EINVAL invalid capacity
+
+==============================================================================*/
+int VARLIST_Init( size_t capacity )
+{
+    int result = EINVAL;
+
+    if ( ( capacity > 0 ) &&
+         ( capacity <= VARSERVER_VARIABLE_LIMIT ) )
+    {
+        result = ENOMEM;
+
+        /* handle 0 is never used, so allow for handles 0..capacity */
+        maxVariables = capacity;
+        varstore = calloc( ( capacity >> VARLIST_CHUNK_SHIFT ) + 1,
+                           sizeof( VarID * ) );
+
+        pStorageSlab = SLAB_Create( "varstorage", sizeof( VarStorage ) );
+        pMetaSlab = SLAB_Create( "varmeta", sizeof( VarMeta ) );
+        pAliasSlab = SLAB_Create( "varalias", sizeof( VarAlias ) );
+
+        if ( ( varstore != NULL ) &&
+             ( pStorageSlab != NULL ) &&
+             ( pMetaSlab != NULL ) &&
+             ( pAliasSlab != NULL ) )
+        {
+            /* names are stored with the same truncation as the hash key */
+            result = NAMEPOOL_Init( capacity, MAX_NAME_LEN - 1 );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_Capacity                                                          */
+/*!
+    Get the maximum number of variables
+
+    The VARLIST_Capacity function gets the maximum number of variables
+    which can be stored in the variable list.
+
+    @retval the maximum number of variables
+
+==============================================================================*/
+size_t VARLIST_Capacity( void )
+{
+    return maxVariables;
+}
+
+/*============================================================================*/
+/*  VARLIST_Count                                                             */
+/*!
+    Get the number of variables
+
+    The VARLIST_Count function gets the number of variables (including
+    aliases) which are stored in the variable list.
+
+    @retval the number of variables
+
+==============================================================================*/
+size_t VARLIST_Count( void )
+{
+    return (size_t)varcount;
+}
+
 /*============================================================================*/
 /*  VARLIST_AddNew                                                            */
 /*!
@@ -297,15 +686,14 @@ int VARLIST_AddNew( VarInfo *pVarInfo, uint32_t *pVarHandle )
 {
     int result = EINVAL;
     int varhandle;
-    VarStorage *pVarStorage;
+    VarStorage *pVarStorage = NULL;
     VarID *pVarID;
-    char buf[256];
-    char *name;
+    uint32_t hash;
 
     if( ( pVarInfo != NULL ) &&
         ( pVarHandle != NULL ) )
     {
-        if( varcount < VARSERVER_MAX_VARIABLES )
+        if( (size_t)varcount < maxVariables )
         {
             /* assume success until we know otherwise */
             result = EOK;
@@ -316,9 +704,19 @@ int VARLIST_AddNew( VarInfo *pVarInfo, uint32_t *pVarHandle )
             if( result == EOK )
             {
                 /* get a pointer to the variable storage for the new variable */
-                pVarID = &varstore[varhandle];
-                pVarStorage = calloc( 1, sizeof( VarStorage ) );
+                pVarID = varlist_NewVarID( varhandle );
+                if ( pVarID != NULL )
+                {
+                    pVarStorage = SLAB_Alloc( pStorageSlab );
+                }
+
                 if ( pVarStorage != NULL )
+                {
+                    pVarStorage->pMeta = SLAB_Alloc( pMetaSlab );
+                }
+
+                if ( ( pVarStorage != NULL ) &&
+                     ( pVarStorage->pMeta != NULL ) )
                 {
                     /* set the storage reference */
                     pVarStorage->storageRef = ++NumVarStorage;
@@ -326,20 +724,47 @@ int VARLIST_AddNew( VarInfo *pVarInfo, uint32_t *pVarHandle )
                     /* set the variable storage pointer */
                     pVarID->pVarStorage = pVarStorage;
 
-                    /* construct the fully qualified variable name */
-                    name = VARLIST_FQN( pVarInfo, buf, sizeof( buf ) );
-
-                    /* add the VarStorage object to the Hash Table */
-                    result = HASH_Add( name, pVarID );
+                    /* add the VarID object to the Hash Table */
+                    hash = varlist_Hash( pVarInfo );
+                    result = HASH_Add( hash, pVarID );
                     if ( result == EOK )
                     {
                         /* copy the variable information from the VarInfo object
                         to the VarStorage object */
                         result = AssignVarInfo( pVarID, pVarStorage, pVarInfo );
                         if( result == EOK )
+                        {
+                            /* add the variable to the flag and tag index */
+                            VARINDEX_SetFlags( varhandle, pVarStorage->flags );
+                            result = VARINDEX_SetTags( varhandle,
+                                                       pVarStorage->pMeta->tags,
+                                                       MAX_TAGS_LEN,
+                                                       true );
+                        }
+
+                        if( result == EOK )
+                        {
+                            /* add the VarID object to the name index */
+                            result = RADIX_Add( pVarID->name, pVarID );
+                        }
+
+                        if( result != EOK )
+                        {
+                            /* remove the incomplete variable */
+                            VARINDEX_SetTags( varhandle,
+                                              pVarStorage->pMeta->tags,
+                                              MAX_TAGS_LEN,
+                                              false );
+                            HASH_Delete( hash, pVarID );
+                        }
+                        else
                         {
                             /* increment the number of variables */
                             varcount++;
+                            STATS_MemAlloc( STATS_MEM_VARIABLES,
+                                            1,
+                                            sizeof( VarStorage ) +
+                                            sizeof( VarMeta ) );
 
                             /* increment the storage reference counter */
                             pVarStorage->refCount = 1;
@@ -347,13 +772,33 @@ int VARLIST_AddNew( VarInfo *pVarInfo, uint32_t *pVarHandle )
                             /* set the variable handle */
                             pVarID->hVar = varhandle;
 
+                            /* publish the variable version to clients */
+                            VARVERSIONS_Map( varhandle,
+                                             pVarStorage->storageRef );
+
                             /* assign the variable handle */
                             *pVarHandle = varhandle;
+
+                            /* check the new variable against the
+                               query subscriptions */
+                            varlist_QueryEvaluate( pVarID );
+
+                            /* the new variable is added to the warm
+                               standby arena when it is rebuilt */
+                            STANDBY_Changed();
+
+                            /* record the definition in the journal */
+                            JOURNAL_Define( varhandle, VAR_INVALID );
                         }
                     }
                 }
                 else
                 {
+                    if ( pVarStorage != NULL )
+                    {
+                        SLAB_Free( pStorageSlab, pVarStorage );
+                    }
+
                     result = ENOMEM;
                 }
             }
@@ -415,6 +860,12 @@ int VARLIST_Alias( VarInfo *pVarInfo, uint32_t *pVarHandle )
                     result = varlist_MoveAlias( pAliasVarID,
                                                 pVarID,
                                                 pVarHandle );
+                    if ( ( result == EOK ) &&
+                         ( pGeneration != NULL ) )
+                    {
+                        /* invalidate client name resolution caches */
+                        __atomic_add_fetch( pGeneration, 1, __ATOMIC_RELEASE );
+                    }
                 }
                 else
                 {
@@ -429,6 +880,18 @@ int VARLIST_Alias( VarInfo *pVarInfo, uint32_t *pVarHandle )
                                            pVarID,
                                            pVarHandle );
             }
+
+            if ( result == EOK )
+            {
+                /* check the alias against the query subscriptions */
+                pAliasVarID = varlist_HandleVarID( *pVarHandle );
+                varlist_QueryEvaluate( pAliasVarID );
+
+                STANDBY_Changed();
+
+                /* record the alias in the journal */
+                JOURNAL_Define( *pVarHandle, pVarID->hVar );
+            }
         }
         else
         {
@@ -473,15 +936,17 @@ static int varlist_SelfAlias( VarID *pVarID )
         if ( pVarStorage != NULL )
         {
             /* create a VarAlias object */
-            pSelfAlias = malloc( sizeof( VarAlias ) );
+            pSelfAlias = SLAB_Alloc( pAliasSlab );
             if ( pSelfAlias != NULL )
             {
+                STATS_MemAlloc( STATS_MEM_ALIASES, 1, sizeof( VarAlias ) );
+
                 /* populate the VarAlias object */
                 pSelfAlias->pVarID = pVarID;
-                pSelfAlias->pNext = pVarStorage->pAliases;
+                pSelfAlias->pNext = pVarStorage->pMeta->pAliases;
 
                 /* insert the VarAlias object at the head of the alias list */
-                pVarStorage->pAliases = pSelfAlias;
+                pVarStorage->pMeta->pAliases = pSelfAlias;
 
                 /* success */
                 result = EOK;
@@ -538,8 +1003,6 @@ static int varlist_NewAlias( VarInfo *pVarInfo,
     int varhandle;
     VarStorage *pVarStorage;
     VarID *pAliasVarID;
-    char buf[256];
-    char *name;
     VarAlias *pVarAlias;
 
     if ( ( pVarID != NULL ) &&
@@ -550,24 +1013,21 @@ static int varlist_NewAlias( VarInfo *pVarInfo,
         if ( pVarStorage != NULL )
         {
             /* check if we have enough space for another variable */
-            if( varcount < VARSERVER_MAX_VARIABLES )
+            if( (size_t)varcount < maxVariables )
             {
                 /* create a VarAlias object */
-                pVarAlias = malloc( sizeof( VarAlias ));
-                if ( pVarAlias != NULL )
+                pVarAlias = SLAB_Alloc( pAliasSlab );
+                pAliasVarID = varlist_NewVarID( varcount + 1 );
+                if ( ( pVarAlias != NULL ) &&
+                     ( pAliasVarID != NULL ) )
                 {
-                    /* get a pointer to the alias Variable identifier */
+                    /* get the alias Variable identifier */
                     varhandle = ++varcount;
-                    pAliasVarID = &varstore[varhandle];
-
-                    /* copy the variable name */
-                    strncpy( pAliasVarID->name,
-                            pVarInfo->name,
-                            MAX_NAME_LEN );
-                    pAliasVarID->name[MAX_NAME_LEN-1] = 0;
+                    STATS_MemAlloc( STATS_MEM_ALIASES, 1, sizeof( VarAlias ) );
 
-                    /* construct the fully qualified variable name */
-                    name = VARLIST_FQN( pVarInfo, buf, sizeof( buf ) );
+                    /* get the pooled variable name.  The pool is sized
+                       for one name per variable handle */
+                    pAliasVarID->name = NAMEPOOL_Intern( pVarInfo->name );
 
                     /* populate the VarID data */
                     pAliasVarID->guid = pVarInfo->guid;
@@ -586,6 +1046,9 @@ static int varlist_NewAlias( VarInfo *pVarInfo,
                     /* return the storage reference identifier */
                     pVarInfo->storageRef = pVarStorage->storageRef;
 
+                    /* the alias shares the version of its variable */
+                    VARVERSIONS_Map( varhandle, pVarStorage->storageRef );
+
                     if ( pVarHandle != NULL )
                     {
                         /* return the new variable handle */
@@ -594,21 +1057,42 @@ static int varlist_NewAlias( VarInfo *pVarInfo,
 
                     /* attach self alias if this is the first alias for
                        the variable */
-                    if ( pVarStorage->pAliases == NULL )
+                    if ( pVarStorage->pMeta->pAliases == NULL )
                     {
                         varlist_SelfAlias( pVarID );
                     }
 
                     /* attach the variable alias to the variable storage */
                     pVarAlias->pVarID = pAliasVarID;
-                    pVarAlias->pNext = pVarStorage->pAliases;
-                    pVarStorage->pAliases = pVarAlias;
+                    pVarAlias->pNext = pVarStorage->pMeta->pAliases;
+                    pVarStorage->pMeta->pAliases = pVarAlias;
 
                     /* add the Alias VarID object to the Hash Table */
-                    result = HASH_Add( name, pAliasVarID );
+                    result = HASH_Add( varlist_Hash( pVarInfo ), pAliasVarID );
+                    if ( result == EOK )
+                    {
+                        /* add the Alias VarID object to the name index */
+                        result = RADIX_Add( pAliasVarID->name, pAliasVarID );
+                    }
+
+                    if ( result == EOK )
+                    {
+                        /* index the alias tags, and the alias flag on
+                           every reference to the variable storage */
+                        result = VARINDEX_SetTags( pAliasVarID->hVar,
+                                                   pVarStorage->pMeta->tags,
+                                                   MAX_TAGS_LEN,
+                                                   true );
+                        varlist_IndexStorage( pVarStorage, pVarID );
+                    }
                 }
                 else
                 {
+                    if ( pVarAlias != NULL )
+                    {
+                        SLAB_Free( pAliasSlab, pVarAlias );
+                    }
+
                     /* no memory for the VarAlias object */
                     result = ENOMEM;
                 }
@@ -689,14 +1173,14 @@ static int varlist_MoveAlias( VarID *pAliasID,
         {
             /* check if we can move the notifications */
             result = NOTIFY_CheckMove( pAliasID->hVar,
-                                       pAliasStorage->pNotifications,
-                                       pVarStorage->pNotifications );
+                                       &pAliasStorage->pMeta->notifications,
+                                       &pVarStorage->pMeta->notifications );
             if ( result == EOK )
             {
                 /* move the alias notifications to the target variable */
                 result = NOTIFY_Move( pAliasID->hVar,
-                                      &(pAliasStorage->pNotifications),
-                                      &(pVarStorage->pNotifications) );
+                                      &(pAliasStorage->pMeta->notifications),
+                                      &(pVarStorage->pMeta->notifications) );
                 if ( result == EOK )
                 {
                     /* delete the alias reference from its current variable  */
@@ -705,7 +1189,7 @@ static int varlist_MoveAlias( VarID *pAliasID,
                                                     pAliasID->pVarStorage );
                     if ( pVarAlias != NULL )
                     {
-                        if ( pVarStorage->pAliases == NULL )
+                        if ( pVarStorage->pMeta->pAliases == NULL )
                         {
                             /* if this is the first alias for the target
                                variable, create a self alias for the target
@@ -714,19 +1198,37 @@ static int varlist_MoveAlias( VarID *pAliasID,
                         }
 
                         /* store the variable alias in the variable storage */
-                        pVarAlias->pNext = pVarStorage->pAliases;
-                        pVarStorage->pAliases = pVarAlias;
+                        pVarAlias->pNext = pVarStorage->pMeta->pAliases;
+                        pVarStorage->pMeta->pAliases = pVarAlias;
                     }
 
                     /* recalculate the notification list masks */
                     pAliasStorage->notifyMask =
-                        NOTIFY_GetMask( pAliasStorage->pNotifications );
+                        NOTIFY_GetMask( &pAliasStorage->pMeta->notifications );
 
                     pVarStorage->notifyMask =
-                        NOTIFY_GetMask( pVarStorage->pNotifications );
+                        NOTIFY_GetMask( &pVarStorage->pMeta->notifications );
+
+                    varlist_UpdateSetPlan( pAliasStorage );
+                    varlist_UpdateSetPlan( pVarStorage );
 
                     /* update the data storage pointer for the alias */
+                    VARINDEX_SetTags( pAliasID->hVar,
+                                      pAliasStorage->pMeta->tags,
+                                      MAX_TAGS_LEN,
+                                      false );
                     pAliasID->pVarStorage = pVarStorage;
+                    VARINDEX_SetTags( pAliasID->hVar,
+                                      pVarStorage->pMeta->tags,
+                                      MAX_TAGS_LEN,
+                                      true );
+
+                    /* clients must re-request access to the shared value
+                       since the alias now refers to a different variable */
+                    SHAREDVALUES_Map( pAliasID->hVar, 0 );
+
+                    /* report the version of the new variable */
+                    VARVERSIONS_Map( pAliasID->hVar, pVarStorage->storageRef );
 
                     /* decrement the reference count on the previously
                        aliased variable and clear the alias flag if
@@ -746,6 +1248,10 @@ static int varlist_MoveAlias( VarID *pAliasID,
                         pVarStorage->flags |= VARFLAG_ALIAS;
                     }
 
+                    /* update the flag index for both variables */
+                    varlist_IndexStorage( pAliasStorage, NULL );
+                    varlist_IndexStorage( pVarStorage, pVarID );
+
                     if ( pVarHandle != NULL )
                     {
                         /* store the handle to the alias variable */
@@ -788,9 +1294,9 @@ static VarAlias *varlist_DeleteAliasReference( VarID *pVarID,
     if ( ( pVarID != NULL ) &&
          ( pVarStorage != NULL ) )
     {
-        ppVarAlias = &(pVarStorage->pAliases);
+        ppVarAlias = &(pVarStorage->pMeta->pAliases);
 
-        p = pVarStorage->pAliases;
+        p = pVarStorage->pMeta->pAliases;
 
         while( p != NULL )
         {
@@ -818,83 +1324,221 @@ static VarAlias *varlist_DeleteAliasReference( VarID *pVarID,
 }
 
 /*============================================================================*/
-/*  varlist_FindVar                                                           */
+/*  varlist_HandleVarID                                                       */
 /*!
-    Find a variable object given its name and instance ID
+    Get the VarID object for a variable handle
 
-    The varlist_FindVar function finds the VarID object
-    in the Hash Table given its name and instance identifier.
+    The varlist_HandleVarID function gets a pointer to the VarID object
+    for the specified variable handle from the variable storage chunks.
 
     @param[in]
-        pVarInfo
-            Pointer to the variable definition containing the name and
-            instance identifier of the variable to find
+        hVar
+            handle of the variable
 
-    @retval pointer to the VarID object found
-    @retval NULL if no VarStorage object was found
+    @retval pointer to the VarID object
+    @retval NULL if the handle is not in an allocated chunk
 
 ==============================================================================*/
-static VarID *varlist_FindVar( VarInfo *pVarInfo )
+static VarID *varlist_HandleVarID( VAR_HANDLE hVar )
 {
+    VarID *pChunk = NULL;
     VarID *pVarID = NULL;
-    char buf[256];
-    char *name;
 
-    if( pVarInfo != NULL )
+    if ( ( varstore != NULL ) &&
+         ( hVar <= maxVariables ) )
     {
-        /* get the variable's fully qualified name */
-        name = VARLIST_FQN( pVarInfo, buf, sizeof( buf ) );
-
-        /* find the VarStorage given its name */
-        pVarID = HASH_Find( name );
+        pChunk = varstore[hVar >> VARLIST_CHUNK_SHIFT];
+        if ( pChunk != NULL )
+        {
+            pVarID = &pChunk[hVar & ( VARLIST_CHUNK_SIZE - 1 )];
+        }
     }
 
     return pVarID;
 }
 
 /*============================================================================*/
-/*  VARLIST_Find                                                              */
+/*  varlist_NewVarID                                                          */
 /*!
-    Find a variable in the variable list by its name
-
-    The VARLIST_Find function searches the variable list for the
-    variable with the specified name and instance identifier.
+    Get the VarID object for a new variable handle
 
-    @param[in]
-        pVarInfo
-            Pointer to the variable definition containing the name and
-            instance identifier of the variable to find
+    The varlist_NewVarID function gets a pointer to the VarID object
+    for the specified variable handle, allocating the variable storage
+    chunk which holds it if necessary.
 
     @param[in]
-        pVarHandle
-            pointer to a VAR_HANDLE to store the handle to the variable
-            when it is found or VAR_INVALID if it is not.
+        hVar
+            handle of the new variable
 
-    @retval EOK the variable was found
-    @retval ENOENT the variable was not found
-    @retval EINVAL invalid arguments
+    @retval pointer to the VarID object
+    @retval NULL if the handle exceeds the capacity or memory allocation
+            failed
 
 ==============================================================================*/
-int VARLIST_Find( VarInfo *pVarInfo, VAR_HANDLE *pVarHandle )
+static VarID *varlist_NewVarID( VAR_HANDLE hVar )
 {
-    int result = EINVAL;
-    VarID *pVarID;
+    VarID **ppChunk;
+    VarID *pVarID = NULL;
 
-    if( ( pVarInfo != NULL ) &&
-        ( pVarHandle != NULL ) )
+    if ( ( varstore != NULL ) &&
+         ( hVar > 0 ) &&
+         ( hVar <= maxVariables ) )
     {
-        /* assume we didn't find it */
-        result = ENOENT;
-
-        /* store VAR_INVALID in the variable handle */
-        *pVarHandle = VAR_INVALID;
+        ppChunk = &varstore[hVar >> VARLIST_CHUNK_SHIFT];
+        if ( *ppChunk == NULL )
+        {
+            *ppChunk = calloc( VARLIST_CHUNK_SIZE, sizeof( VarID ) );
+        }
 
-        /* find the VarID object */
-        pVarID = varlist_FindVar( pVarInfo );
-        if ( pVarID != NULL )
+        if ( *ppChunk != NULL )
         {
-            /* check if we have read permissions on the variable */
-            if ( varlist_CheckReadPermissions( pVarInfo, pVarID ))
+            pVarID = &(*ppChunk)[hVar & ( VARLIST_CHUNK_SIZE - 1 )];
+        }
+    }
+
+    return pVarID;
+}
+
+/*============================================================================*/
+/*  varlist_FindVar                                                           */
+/*!
+    Find a variable object given its name and instance ID
+
+    The varlist_FindVar function finds the VarID object
+    in the Hash Table given its name and instance identifier.
+
+    @param[in]
+        pVarInfo
+            Pointer to the variable definition containing the name and
+            instance identifier of the variable to find
+
+    @retval pointer to the VarID object found
+    @retval NULL if no VarStorage object was found
+
+==============================================================================*/
+static VarID *varlist_FindVar( VarInfo *pVarInfo )
+{
+    VarID *pVarID = NULL;
+
+    if( pVarInfo != NULL )
+    {
+        /* find the VarID given its name and instance identifier.
+           Read-only workers must not advance the hash table migration */
+        if ( readOnlyThread == true )
+        {
+            pVarID = HASH_Peek( varlist_Hash( pVarInfo ),
+                                varlist_MatchName,
+                                (void *)pVarInfo );
+        }
+        else
+        {
+            pVarID = HASH_Find( varlist_Hash( pVarInfo ),
+                                varlist_MatchName,
+                                (void *)pVarInfo );
+        }
+    }
+
+    return pVarID;
+}
+
+/*============================================================================*/
+/*  varlist_Hash                                                              */
+/*!
+    Calculate the hash table key for a variable
+
+    The varlist_Hash function calculates the hash of the variable's
+    name and instance identifier.  Only the part of the name which is
+    stored in the VarID object is hashed.
+
+    @param[in]
+        pVarInfo
+            Pointer to the variable definition containing the name and
+            instance identifier of the variable
+
+    @retval the hash of the variable's name
+
+==============================================================================*/
+static uint32_t varlist_Hash( VarInfo *pVarInfo )
+{
+    return HASH_Key( pVarInfo->name, MAX_NAME_LEN - 1, pVarInfo->instanceID );
+}
+
+/*============================================================================*/
+/*  varlist_MatchName                                                         */
+/*!
+    Check if a VarID object matches a variable name
+
+    The varlist_MatchName function is used by the hash table to compare
+    a candidate VarID object with the name and instance identifier being
+    searched for.  Variable names are case insensitive.
+
+    @param[in]
+        object
+            pointer to the candidate VarID object
+
+    @param[in]
+        key
+            pointer to the VarInfo object containing the name and
+            instance identifier being searched for
+
+    @retval true the VarID matches the name
+    @retval false the VarID does not match the name
+
+==============================================================================*/
+static bool varlist_MatchName( void *object, void *key )
+{
+    VarID *pVarID = (VarID *)object;
+    VarInfo *pVarInfo = (VarInfo *)key;
+
+    return ( pVarID->instanceID == pVarInfo->instanceID ) &&
+           ( strncasecmp( pVarID->name,
+                          pVarInfo->name,
+                          MAX_NAME_LEN - 1 ) == 0 );
+}
+
+/*============================================================================*/
+/*  VARLIST_Find                                                              */
+/*!
+    Find a variable in the variable list by its name
+
+    The VARLIST_Find function searches the variable list for the
+    variable with the specified name and instance identifier.
+
+    @param[in]
+        pVarInfo
+            Pointer to the variable definition containing the name and
+            instance identifier of the variable to find
+
+    @param[in]
+        pVarHandle
+            pointer to a VAR_HANDLE to store the handle to the variable
+            when it is found or VAR_INVALID if it is not.
+
+    @retval EOK the variable was found
+    @retval ENOENT the variable was not found
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_Find( VarInfo *pVarInfo, VAR_HANDLE *pVarHandle )
+{
+    int result = EINVAL;
+    VarID *pVarID;
+
+    if( ( pVarInfo != NULL ) &&
+        ( pVarHandle != NULL ) )
+    {
+        /* assume we didn't find it */
+        result = ENOENT;
+
+        /* store VAR_INVALID in the variable handle */
+        *pVarHandle = VAR_INVALID;
+
+        /* find the VarID object */
+        pVarID = varlist_FindVar( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            /* check if we have read permissions on the variable */
+            if ( varlist_CheckReadPermissions( pVarInfo, pVarID ))
             {
                 *pVarHandle = pVarID->hVar;
                 result = EOK;
@@ -1041,6 +1685,7 @@ char *VARLIST_FQN( VarInfo *pVarInfo, char *buf, size_t len )
             process (if applicable)
 
     @retval EOK the variable print request was handled
+    @retval E2BIG the value does not fit in the working buffer
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
@@ -1059,7 +1704,6 @@ int VARLIST_PrintByHandle( pid_t clientPID,
     size_t n;
     uint32_t printHandle;
     char *p;
-    Notification *pNotifications;
 
     if( ( pVarInfo != NULL ) &&
         ( workbuf != NULL ) )
@@ -1081,9 +1725,9 @@ int VARLIST_PrintByHandle( pid_t clientPID,
             if( pVarStorage->notifyMask & NOTIFY_MASK_PRINT )
             {
                 /* get the handle associated with the PRINT notification */
-                pNotifications = pVarStorage->pNotifications;
-                hTransactionVar = NOTIFY_GetVarHandle( pNotifications,
-                                                       NOTIFY_PRINT );
+                hTransactionVar = NOTIFY_GetVarHandle(
+                                                &pVarStorage->pMeta->notifications,
+                                                NOTIFY_PRINT );
 
                 /* create a PRINT transaction */
                 result = TRANSACTION_New( clientPID,
@@ -1094,7 +1738,7 @@ int VARLIST_PrintByHandle( pid_t clientPID,
                 {
                     /* send a PRINT notification */
                     result = NOTIFY_Signal( clientPID,
-                                            &pVarStorage->pNotifications,
+                                            &pVarStorage->pMeta->notifications,
                                             NOTIFY_PRINT,
                                             printHandle,
                                             handler );
@@ -1104,6 +1748,7 @@ int VARLIST_PrintByHandle( pid_t clientPID,
                         client on this variable */
                         pVarStorage->notifyMask |=
                             NOTIFY_MASK_HAS_PRINT_BLOCK;
+                        varlist_UpdateSetPlan( pVarStorage );
 
                         /* indicate that the print output will be piped
                         from another client */
@@ -1115,34 +1760,23 @@ int VARLIST_PrintByHandle( pid_t clientPID,
             }
 
             /* check if this variable has a CALC handler attached */
-            if( pVarStorage->notifyMask & NOTIFY_MASK_CALC )
+            if( ( pVarStorage->notifyMask & NOTIFY_MASK_CALC ) &&
+                ( varlist_CalcCached( pVarStorage ) == false ) )
             {
-                /* send a calc request to the "owner" of this variable */
-                result = NOTIFY_Signal( clientPID,
-                                        &pVarStorage->pNotifications,
-                                        NOTIFY_CALC,
-                                        hVar,
-                                        NULL );
-                if (result == EOK )
-                {
-                    /* indicate that there is now a CALC blocked
-                    client on this variable */
-                    pVarStorage->notifyMask |= NOTIFY_MASK_HAS_CALC_BLOCK;
-
-                    /* an EINPROGRESS result will prevent the client
-                    from being unblocked until this request is complete */
-                    result = EINPROGRESS;
-                }
-                else if( result == ESRCH )
-                {
-                    /* the CALC handler has died so remove the CALC flag */
-                    pVarStorage->notifyMask &= ~NOTIFY_MASK_CALC;
-                }
+                /* ask the "owner" of this variable for a new value */
+                result = varlist_RequestCalc( clientPID, pVarStorage, hVar );
             }
 
             if( ( result != EINPROGRESS ) &&
                 ( result != ESTRPIPE ) )
             {
+                if( pVarStorage->notifyMask & NOTIFY_MASK_COALESCE )
+                {
+                    /* the client has seen the latest value, so its
+                       coalesced notifications can be sent again */
+                    NOTIFY_Rearm( &pVarStorage->pMeta->notifications, clientPID );
+                }
+
                 /* get the variable TLV */
                 pVarInfo->var.len = pVarStorage->var.len;
                 pVarInfo->var.type = pVarStorage->var.type;
@@ -1155,12 +1789,14 @@ int VARLIST_PrintByHandle( pid_t clientPID,
 
                 /* get the format specifier */
                 memcpy( pVarInfo->formatspec,
-                        pVarStorage->formatspec,
+                        pVarStorage->pMeta->formatspec,
                         MAX_FORMATSPEC_LEN );
 
                 /* get the flags */
                 pVarInfo->flags = pVarStorage->flags;
 
+                result = EOK;
+
                 if( pVarInfo->var.type == VARTYPE_STR )
                 {
                     if ( pVarStorage->flags & VARFLAG_PASSWORD )
@@ -1208,8 +1844,6 @@ int VARLIST_PrintByHandle( pid_t clientPID,
                         result = E2BIG;
                     }
                 }
-
-                result = EOK;
             }
         }
         else
@@ -1259,6 +1893,7 @@ int VARLIST_GetByHandle( pid_t clientPID,
     int result = EINVAL;
     VAR_HANDLE hVar = VAR_INVALID;
     size_t n;
+    bool calc;
 
     if( ( pVarInfo != NULL ) &&
         ( buf != NULL ) )
@@ -1276,33 +1911,35 @@ int VARLIST_GetByHandle( pid_t clientPID,
             /* get the storage reference identifier */
             pVarInfo->storageRef = pVarStorage->storageRef;
 
-            /* check if this variable has a CALC handler attached */
-            if( pVarStorage->notifyMask & NOTIFY_MASK_CALC )
-            {
-                /* send a calc request to the "owner" of this variable */
-                result = NOTIFY_Signal( clientPID,
-                                        &pVarStorage->pNotifications,
-                                        NOTIFY_CALC,
-                                        hVar,
-                                        NULL );
-                if (result == EOK )
-                {
-                    /* indicate that there is now a CALC blocked
-                    client on this variable */
-                    pVarStorage->notifyMask |= NOTIFY_MASK_HAS_CALC_BLOCK;
+            /* check if this variable needs its CALC handler, a cached
+               calculated value is returned like any other value */
+            calc = ( ( pVarStorage->notifyMask & NOTIFY_MASK_CALC ) &&
+                     ( varlist_CalcCached( pVarStorage ) == false ) );
 
-                    /* an EINPROGRESS result will prevent the client
-                    from being unblocked until this request is complete */
-                    result = EINPROGRESS;
-                }
-                else if( result == ESRCH )
-                {
-                    /* the CALC handler has died so remove the CALC flag */
-                    pVarStorage->notifyMask &= ~NOTIFY_MASK_CALC;
-                }
+            if( ( calc == true ) &&
+                ( batchInProgress == true ) )
+            {
+                /* a batch cannot block on a CALC, the variable must
+                   be retrieved individually */
+                result = EWOULDBLOCK;
+            }
+            else if( ( readOnlyThread == true ) &&
+                     ( ( calc == true ) ||
+                       ( pVarStorage->notifyMask & NOTIFY_MASK_COALESCE ) ) )
+            {
+                /* a read-only worker cannot signal the CALC handler or
+                   re-arm the notifications, so the variable must be
+                   retrieved by the main thread */
+                result = EWOULDBLOCK;
+            }
+            else if( calc == true )
+            {
+                /* ask the "owner" of this variable for a new value */
+                result = varlist_RequestCalc( clientPID, pVarStorage, hVar );
             }
 
-            if( result != EINPROGRESS )
+            if( ( result != EINPROGRESS ) &&
+                ( result != EWOULDBLOCK ) )
             {
                 /* not a CALC notification */
                 /* get the variable TLV */
@@ -1312,6 +1949,13 @@ int VARLIST_GetByHandle( pid_t clientPID,
 
                 result = EOK;
 
+                if( pVarStorage->notifyMask & NOTIFY_MASK_COALESCE )
+                {
+                    /* the client has seen the latest value, so its
+                       coalesced notifications can be sent again */
+                    NOTIFY_Rearm( &pVarStorage->pMeta->notifications, clientPID );
+                }
+
                 if( pVarInfo->var.type == VARTYPE_STR )
                 {
                     /* strings are passed back via the working buffer */
@@ -1397,9 +2041,7 @@ int VARLIST_Set( pid_t clientPID,
     VarID *pVarID;
     VarStorage *pVarStorage = NULL;
     VAR_HANDLE hVar = VAR_INVALID;
-    uint32_t validateHandle;
-    Notification *pNotifications;
-    VAR_HANDLE hTransactionVar = VAR_INVALID;
+    pid_t validator;
     int rc;
 
     if( pVarInfo != NULL )
@@ -1413,7 +2055,17 @@ int VARLIST_Set( pid_t clientPID,
 
         if ( ( pVarStorage != NULL ) &&
              ( validationInProgress != NULL ) &&
-             ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+             ( pVarStorage->setPlan != SETPLAN_GENERAL ) &&
+             ( pVarStorage->var.type == pVarInfo->var.type ) )
+        {
+            /* store a value of the same type into a variable which
+               uses none of the write side features */
+            *validationInProgress = false;
+            result = varlist_FastSet( clientPID, pVarID, pVarInfo );
+        }
+        else if ( ( pVarStorage != NULL ) &&
+                  ( validationInProgress != NULL ) &&
+                  ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
         {
             /* check if this variable is readonly */
             if ( pVarStorage->flags & VARFLAG_READONLY )
@@ -1439,50 +2091,39 @@ int VARLIST_Set( pid_t clientPID,
                 return EOK;
             }
 
-            /* Check if we have a validation handler on this variable */
+            /* Check if we have a validation handler on this variable,
+               and prevent self-notification */
             if( ( pVarStorage->notifyMask & NOTIFY_MASK_VALIDATE ) &&
-                ( *validationInProgress == false ) )
+                ( *validationInProgress == false ) &&
+                ( NOTIFY_Find( &pVarStorage->pMeta->notifications,
+                               NOTIFY_VALIDATE,
+                               clientPID ) == NULL ) )
             {
-                /* prevent self-notification */
-                if( NOTIFY_Find( pVarStorage->pNotifications,
-                                 NOTIFY_VALIDATE,
-                                 clientPID ) == NULL )
-                {
-                    /* get the handle associated with the PRINT notification */
-                    pNotifications = pVarStorage->pNotifications;
-                    hTransactionVar = NOTIFY_GetVarHandle( pNotifications,
-                                                           NOTIFY_VALIDATE );
-
-                    /* create a validation transaction */
-                    result = TRANSACTION_New( clientPID,
-                                              clientInfo,
-                                              hTransactionVar,
-                                              &validateHandle );
-                    if( result == EOK )
+                validator = NOTIFY_GetPID( &pVarStorage->pMeta->notifications,
+                                           NOTIFY_VALIDATE );
+
+                if( ( batchInProgress == true ) &&
+                    ( VALIDATE_IsBatched( validator ) == false ) )
+                {
+                    /* a batch can only wait for a batched validator,
+                       the variable must be set individually */
+                    result = EWOULDBLOCK;
+                }
+                else
+                {
+                    result = varlist_RequestValidation( clientPID,
+                                                        pVarStorage,
+                                                        validator,
+                                                        clientInfo );
+                    if( result == EINPROGRESS )
                     {
-                        /* send a notification to the validation client with the
-                        identifier of the validation request */
-                        result = NOTIFY_Signal( clientPID,
-                                                &pVarStorage->pNotifications,
-                                                NOTIFY_VALIDATE,
-                                                validateHandle,
-                                                NULL );
-                        if( result == EOK )
-                        {
-                            *validationInProgress = true;
-                            result = EINPROGRESS;
-                        }
-                        else if( result == ESRCH )
-                        {
-                            /* the validation client is gone, so clear the
-                            notification mask */
-                            pVarStorage->notifyMask &= ~NOTIFY_MASK_VALIDATE;
-                        }
+                        *validationInProgress = true;
                     }
                 }
             }
 
-            if( result != EINPROGRESS )
+            if( ( result != EINPROGRESS ) &&
+                ( result != EWOULDBLOCK ) )
             {
                 /* indicate that there is no validation in progress */
                 *validationInProgress = false;
@@ -1529,45 +2170,8 @@ int VARLIST_Set( pid_t clientPID,
                 }
             }
 
-            if ( result == EOK )
-            {
-                varlist_SetDirty( pVarStorage );
-            }
-
-            if ( pVarStorage->flags & VARFLAG_AUDIT )
-            {
-                varlist_Audit( clientPID, pVarID, pVarInfo );
-            }
-
-            if ( ( result == EOK ) ||
-                 ( result == EALREADY ) )
-            {
-                /* check for any CALC blocked clients on the variable */
-                if( pVarStorage->notifyMask & NOTIFY_MASK_HAS_CALC_BLOCK )
-                {
-                    /* unblock the first CALC blocked client */
-                    UnblockClients( pVarStorage->storageRef,
-                                    NOTIFY_CALC,
-                                    varlist_Calc,
-                                    (void *)pVarInfo );
-
-                    /* indicate we no longer have CALC blocked clients */
-                    pVarStorage->notifyMask &= ~NOTIFY_MASK_HAS_CALC_BLOCK;
-                }
-
-                if ( result == EOK )
-                {
-                    /* send out notifications */
-                    result = varlist_SendNotifications( clientPID,
-                                                        pVarStorage,
-                                                        hVar );
-                }
-            }
-
-            if ( result == EALREADY )
-            {
-                result = EOK;
-            }
+            /* record the change and notify the subscribers */
+            result = varlist_Changed( clientPID, pVarID, pVarInfo, result );
         }
         else
         {
@@ -1580,151 +2184,137 @@ int VARLIST_Set( pid_t clientPID,
 }
 
 /*============================================================================*/
-/*  varlist_Audit                                                             */
+/*  VARLIST_CheckSet                                                          */
 /*!
-    Create a variable change audit log
+    Check that a SET request can be applied
 
-    The varlist_Audit function creates a variable change audit log,
-    using syslog, and writes the variable name, value, user id, and
-    process id that requested the change.
+    The VARLIST_CheckSet function checks that the specified variable
+    exists, can be written by the client, and can hold the new value,
+    without changing the variable.  It is used to check all of the
+    values of a group set before any of them are applied.
 
     @param[in]
         clientPID
-            process id of the client requesting the change
-
-    @param[in]
-        pVarID
-            pointer to the variable ID object that was changed
+            the process ID of the client setting the variable
 
-    @param[in]
+    @param[in,out]
         pVarInfo
-            pointer to the variable change info for the change request
+            Pointer to the variable definition containing the handle
+            of the variable to set and the value to set it to
 
-    @retval EOK the variable audit log was written
-    @retval ENOTSUP unsupported data type
+    @param[out]
+        pValidate
+            pointer to a location to store whether the change must be
+            validated by the variable's validator
+
+    @retval EOK the value can be applied
+    @retval ENOTSUP the value is the wrong type, or the variable is held
+            in a zero-copy blob segment
+    @retval ERANGE the value is out of range
+    @retval E2BIG the value does not fit in the variable
+    @retval EACCES the client cannot write the variable
+    @retval ENOENT the variable does not exist
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int varlist_Audit( pid_t clientPID,
-                          VarID *pVarID,
-                          VarInfo *pVarInfo )
+int VARLIST_CheckSet( pid_t clientPID,
+                      VarInfo *pVarInfo,
+                      bool *pValidate )
 {
     int result = EINVAL;
+    VarID *pVarID;
     VarStorage *pVarStorage = NULL;
-    uid_t uid;
-    char *varname;
+    VarStorage scratch;
 
-    if ( ( pVarInfo != NULL ) &&
-         ( pVarID != NULL ) )
+    if( ( pVarInfo != NULL ) &&
+        ( pValidate != NULL ) )
     {
-        uid = pVarInfo->creds[0];
-        varname = pVarID->name;
+        *pValidate = false;
 
-        pVarStorage = pVarID->pVarStorage;
-        if ( pVarStorage != NULL )
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
         {
-            result = EOK;
+            pVarStorage = pVarID->pVarStorage;
+        }
 
+        if ( ( pVarStorage == NULL ) ||
+             ( varlist_CheckReadPermissions( pVarInfo, pVarID ) == false ) )
+        {
+            result = ENOENT;
+        }
+        else if ( ( pVarStorage->flags & VARFLAG_READONLY ) ||
+                  ( varlist_CheckWritePermissions( pVarInfo,
+                                                   pVarID ) == false ) )
+        {
+            result = EACCES;
+        }
+        else if ( pVarStorage->var.type == VARTYPE_STR )
+        {
+            result = ( pVarInfo->var.type != VARTYPE_STR ) ? ENOTSUP
+                   : ( pVarInfo->var.len > pVarStorage->var.len ) ? E2BIG
+                   : EOK;
+        }
+        else if ( pVarStorage->var.type == VARTYPE_BLOB )
+        {
+            /* a client may be writing a zero-copy blob segment */
+            result = ( ( pVarInfo->var.type != VARTYPE_BLOB ) ||
+                       ( pVarStorage->pMeta->pSharedBlob != NULL ) ) ? ENOTSUP
+                   : ( pVarInfo->var.len > pVarStorage->var.len ) ? E2BIG
+                   : EOK;
+        }
+        else
+        {
+            /* convert the value into a scratch copy of the storage */
+            scratch = *pVarStorage;
             switch( pVarStorage->var.type )
             {
                 case VARTYPE_FLOAT:
-                    syslog( LOG_INFO,
-                            "'%s' changed to '%f' by user %d from process %d",
-                            varname,
-                            pVarStorage->var.val.f,
-                            uid,
-                            clientPID  );
+                    result = varlist_SetFloat( &scratch, pVarInfo );
                     break;
 
-                case VARTYPE_BLOB:
-                    syslog( LOG_INFO,
-                            "'%s' changed by user %d from process %d",
-                            varname,
-                            uid,
-                            clientPID  );
-                    result = EOK;
+                case VARTYPE_UINT16:
+                    result = varlist_Set16( &scratch, pVarInfo );
                     break;
 
-                case VARTYPE_STR:
-                    if ( pVarStorage->var.val.str != NULL )
-                    {
-                        syslog( LOG_INFO,
-                                "'%s' changed to '%s' by user %d "
-                                "from process %d",
-                                varname,
-                                pVarStorage->var.val.str,
-                                uid,
-                                clientPID  );
-                    }
-                    result = EOK;
-                    break;
-
-                case VARTYPE_UINT16:
-                    syslog( LOG_INFO,
-                            "'%s' changed to '%u' by user %d from process %d",
-                            varname,
-                            pVarStorage->var.val.ui,
-                            uid,
-                            clientPID  );
-                    break;
-
-                case VARTYPE_INT16:
-                    syslog( LOG_INFO,
-                            "'%s' changed to '%d' by user %d from process %d",
-                            varname,
-                            pVarStorage->var.val.i,
-                            uid,
-                            clientPID  );
+                case VARTYPE_INT16:
+                    result = varlist_Set16s( &scratch, pVarInfo );
                     break;
 
                 case VARTYPE_UINT32:
-                    syslog( LOG_INFO,
-                            "'%s' changed to '"
-                            "%" PRIu32
-                            "' by user %d from process %d",
-                            varname,
-                            pVarStorage->var.val.ul,
-                            uid,
-                            clientPID  );
+                    result = varlist_Set32( &scratch, pVarInfo );
                     break;
 
                 case VARTYPE_INT32:
-                    syslog( LOG_INFO,
-                            "'%s' changed to '"
-                            "%" PRId32
-                            "' by user %d from process %d",
-                            varname,
-                            pVarStorage->var.val.l,
-                            uid,
-                            clientPID  );
+                    result = varlist_Set32s( &scratch, pVarInfo );
                     break;
 
                 case VARTYPE_UINT64:
-                    syslog( LOG_INFO,
-                            "'%s' changed to '"
-                            "%" PRIu64
-                            "' by user %d from process %d",
-                            varname,
-                            pVarStorage->var.val.ull,
-                            uid,
-                            clientPID  );
+                    result = varlist_Set64( &scratch, pVarInfo );
                     break;
 
                 case VARTYPE_INT64:
-                    syslog( LOG_INFO,
-                            "'%s' changed to '"
-                            "%" PRId64
-                            "' by user %d from process %d",
-                            varname,
-                            pVarStorage->var.val.ll,
-                            uid,
-                            clientPID  );
+                    result = varlist_Set64s( &scratch, pVarInfo );
                     break;
 
                 default:
                     result = ENOTSUP;
                     break;
             }
+
+            if ( result == EALREADY )
+            {
+                result = EOK;
+            }
+        }
+
+        if ( ( result == EOK ) &&
+             ( pVarStorage->notifyMask & NOTIFY_MASK_VALIDATE ) &&
+             ( NOTIFY_Find( &pVarStorage->pMeta->notifications,
+                            NOTIFY_VALIDATE,
+                            clientPID ) == NULL ) )
+        {
+            /* the validator must accept the change first */
+            *pValidate = true;
         }
     }
 
@@ -1732,59 +2322,62 @@ static int varlist_Audit( pid_t clientPID,
 }
 
 /*============================================================================*/
-/*  VARLIST_SetFlags                                                          */
+/*  VARLIST_RequestValidation                                                 */
 /*!
-    Handle a SET_FLAGS request from a client
+    Ask the validator of a variable to validate a change
 
-    The VARLIST_SetFlags function handles a SET_FLAGS request from a client.
-    It sets the specified flags on the specified variable
+    The VARLIST_RequestValidation function asks the validator of the
+    specified variable to validate the change in the VarInfo object.
+    The validator's response is handled as for a SET request which is
+    waiting for validation, but the change is not applied.
+
+    @param[in]
+        clientPID
+            the process ID of the client setting the variable
 
     @param[in]
         pVarInfo
             Pointer to the variable definition containing the handle
-            of the variable whose flags will be set
+            of the variable and its new value
 
-    @retval EOK the variable flags were successfully set
+    @param[in]
+        clientInfo
+            opaque pointer to the client VarClient object
+
+    @retval EINPROGRESS the change is waiting for the validator
+    @retval EOK the variable no longer has a validator
     @retval ENOENT the variable does not exist
-    @retval EACCES insufficient permissions to set the flags
-    @retval EINVAL invalid arguments
+    @retval other the validation could not be requested
 
 ==============================================================================*/
-int VARLIST_SetFlags( VarInfo *pVarInfo )
+int VARLIST_RequestValidation( pid_t clientPID,
+                               VarInfo *pVarInfo,
+                               void *clientInfo )
 {
-    int result = EINVAL;
-    VarStorage *pVarStorage = NULL;
+    int result = ENOENT;
     VarID *pVarID;
-    bool rc;
+    VarStorage *pVarStorage = NULL;
+    pid_t validator;
 
-    if( pVarInfo != NULL )
+    pVarID = varlist_GetVarID( pVarInfo );
+    if ( pVarID != NULL )
     {
-        pVarID = varlist_GetVarID( pVarInfo );
-        if ( pVarID != NULL )
-        {
-            pVarStorage = pVarID->pVarStorage;
-        }
-
-        result = ENOENT;
+        pVarStorage = pVarID->pVarStorage;
+    }
 
-        if ( ( pVarStorage != NULL ) &&
-             ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+    if ( pVarStorage != NULL )
+    {
+        validator = NOTIFY_GetPID( &pVarStorage->pMeta->notifications,
+                                   NOTIFY_VALIDATE );
+
+        result = varlist_RequestValidation( clientPID,
+                                            pVarStorage,
+                                            validator,
+                                            clientInfo );
+        if ( result == ESRCH )
         {
-            /* check if we have write permissions on this variable */
-            rc = varlist_CheckWritePermissions( pVarInfo, pVarID );
-            if ( rc == true )
-            {
-                pVarStorage->flags |= pVarInfo->flags;
-
-                /* get the storage reference identifier */
-                pVarInfo->storageRef = pVarStorage->storageRef;
-
-                result = EOK;
-            }
-            else
-            {
-                result = EACCES;
-            }
+            /* the validator has gone, so there is nothing to wait for */
+            result = EOK;
         }
     }
 
@@ -1792,32 +2385,83 @@ int VARLIST_SetFlags( VarInfo *pVarInfo )
 }
 
 /*============================================================================*/
-/*  VARLIST_ClearFlags                                                        */
+/*  VARLIST_Modify                                                            */
 /*!
-    Handle a CLEAR_FLAGS request from a client
+    Handle a MODIFY request from a client
 
-    The VARLIST_ClearFlags function handles a CLEAR_FLAGS request from a client.
-    It clears the specified flags on the specified variable
+    The VARLIST_Modify function atomically reads the current value of a
+    variable, computes its new value with the specified operation, and
+    stores it as for VARLIST_Set, so the change is journalled and the
+    normal notifications are sent.  The previous value of the variable is
+    returned in the VarInfo object, with string values copied into the
+    working buffer.
+
+    Arithmetic operations are range checked against the type of the
+    variable, and the bitwise operations use the operand bits which fit
+    in the variable.  Variables with a CALC or VALIDATE handler cannot
+    be modified, since their stored values are not authoritative.
 
     @param[in]
+        clientPID
+            the process ID of the client modifying the variable
+
+    @param[in,out]
         pVarInfo
             Pointer to the variable definition containing the handle
-            of the variable whose flags will be cleared
+            of the variable to modify.  The previous value of the
+            variable is returned in it.
 
-    @retval EOK the variable flags were successfully cleared
+    @param[in]
+        op
+            the VarModifyOp operation to perform
+
+    @param[in]
+        pOperand
+            pointer to the operand, or the new value of a VAR_MODIFY_CAS
+
+    @param[in]
+        pExpected
+            pointer to the expected value of a VAR_MODIFY_CAS
+
+    @param[in]
+        buf
+            pointer to the working buffer to return a string value
+
+    @param[in]
+        bufsize
+            size of the working buffer
+
+    @retval EOK the variable was modified
+    @retval EAGAIN the variable did not hold the expected value
+    @retval ERANGE the result does not fit in the variable
+    @retval ENOTSUP the operation is not supported on the variable
+    @retval EACCES the variable cannot be modified by the client
     @retval ENOENT the variable does not exist
-    @retval EACCES insufficient permissions to clear the flags
+    @retval E2BIG the previous value does not fit in the working buffer
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-int VARLIST_ClearFlags( VarInfo *pVarInfo )
+int VARLIST_Modify( pid_t clientPID,
+                    VarInfo *pVarInfo,
+                    int op,
+                    VarObject *pOperand,
+                    const VarObject *pExpected,
+                    char *buf,
+                    size_t bufsize )
 {
     int result = EINVAL;
-    VarStorage *pVarStorage = NULL;
     VarID *pVarID;
-    int rc;
+    VarStorage *pVarStorage = NULL;
+    VarObject old;
+    VarObject value;
+    bool validationInProgress = false;
+    const char *src;
+    size_t n;
 
-    if( pVarInfo != NULL )
+    if( ( pVarInfo != NULL ) &&
+        ( pOperand != NULL ) &&
+        ( pExpected != NULL ) &&
+        ( buf != NULL ) )
     {
         pVarID = varlist_GetVarID( pVarInfo );
         if ( pVarID != NULL )
@@ -1825,100 +2469,164 @@ int VARLIST_ClearFlags( VarInfo *pVarInfo )
             pVarStorage = pVarID->pVarStorage;
         }
 
-        result = ENOENT;
-
-        if( ( pVarStorage != NULL ) &&
-            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        if ( ( pVarStorage != NULL ) &&
+             ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
         {
-            /* check if we have write permissions on this variable */
-            rc = varlist_CheckWritePermissions( pVarInfo, pVarID );
-            if ( rc == true )
-            {
-                pVarStorage->flags &= ~(pVarInfo->flags);
+            old = pVarStorage->var;
+            value = pVarStorage->var;
 
-                /* get the storage reference identifier */
-                pVarInfo->storageRef = pVarStorage->storageRef;
+            if ( pVarStorage->flags & VARFLAG_PASSWORD )
+            {
+                /* the old value of a password cannot be returned */
+                result = EACCES;
+            }
+            else if ( pVarStorage->notifyMask &
+                      ( NOTIFY_MASK_CALC | NOTIFY_MASK_VALIDATE ) )
+            {
+                result = ENOTSUP;
+            }
+            else if ( op == VAR_MODIFY_CAS )
+            {
+                result = varlist_Compare( pVarStorage, pExpected );
+                if ( ( result == EOK ) &&
+                     ( pOperand->type == VARTYPE_STR ) )
+                {
+                    pOperand->len = strlen( pOperand->val.str );
+                }
 
-                result = EOK;
+                value = *pOperand;
             }
             else
             {
-                result = EACCES;
+                result = varlist_ModifyValue( &value, op, pOperand );
+            }
+
+            if ( result == EOK )
+            {
+                /* store the new value as for a SET request */
+                pVarInfo->var = value;
+                result = VARLIST_Set( clientPID,
+                                      pVarInfo,
+                                      &validationInProgress,
+                                      NULL );
+                if ( result == EALREADY )
+                {
+                    /* the operation did not change the value */
+                    result = EOK;
+                }
+            }
+
+            if ( ( result == EOK ) ||
+                 ( result == EAGAIN ) )
+            {
+                /* return the previous value */
+                pVarInfo->var = old;
+                if ( old.type == VARTYPE_STR )
+                {
+                    /* a successful exchange replaced the expected value */
+                    src = ( result == EOK ) ? pExpected->val.str
+                                            : pVarStorage->var.val.str;
+                    n = strlen( src );
+                    if ( n < bufsize )
+                    {
+                        memmove( buf, src, n + 1 );
+                    }
+                    else
+                    {
+                        /* the variable has not changed, so the client
+                           can grow its working buffer and try again */
+                        result = E2BIG;
+                    }
+                }
             }
         }
+        else
+        {
+            /* the requested variable does not exist */
+            result = ENOENT;
+        }
     }
 
     return result;
 }
 
-/*==============================================================================
-        Private function definitions
-==============================================================================*/
-
 /*============================================================================*/
-/*  varlist_SendNotifications                                                 */
+/*  VARLIST_GetHistory                                                        */
 /*!
-    Send out requested client notifications
+    Handle a GET_HISTORY request from a client
 
-    The varlist_SendNotifications function sends out requested client
-    notifications of type modified and modified_queued.
+    The VARLIST_GetHistory function packs the samples selected by a
+    history query from the history ring of a variable into the
+    specified buffer, as a VarHistory object followed by the samples.
+    A variable which has the VARFLAG_HISTORY flag but has not been set
+    since the flag was added has an empty history.
 
     @param[in]
-        clientPID
-            process identifier of the requesting client
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable and the credentials of the client
 
     @param[in]
-        pVarStorage
-            pointer to the variable storage for the variable notification
+        pQuery
+            pointer to the history query
+
+    @param[out]
+        buf
+            pointer to the buffer to receive the samples
 
     @param[in]
-        hVar
-            handle to the variable that has been modified
+        bufsize
+            size of the buffer
 
-    @retval EOK the notifications were sent
+    @retval EOK the samples were fetched
+    @retval ENOENT the variable does not exist
+    @retval EACCES the client cannot read the variable's history
+    @retval ENOTSUP the variable does not keep a history
+    @retval E2BIG the buffer is too small
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int varlist_SendNotifications( pid_t clientPID,
-                                      VarStorage *pVarStorage,
-                                      VAR_HANDLE hVar )
+int VARLIST_GetHistory( VarInfo *pVarInfo,
+                        const VarHistoryQuery *pQuery,
+                        char *buf,
+                        size_t bufsize )
 {
     int result = EINVAL;
-    void *payload;
-    size_t n = 0;
+    VarStorage *pVarStorage = NULL;
+    VarID *pVarID;
 
-    if ( pVarStorage != NULL )
+    if( ( pVarInfo != NULL ) &&
+        ( pQuery != NULL ) &&
+        ( buf != NULL ) )
     {
-        result = EOK;
-
-        /* signal variable modified */
-        if ( pVarStorage->notifyMask & NOTIFY_MASK_MODIFIED )
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
         {
-            NOTIFY_Signal( clientPID,
-                           &pVarStorage->pNotifications,
-                           NOTIFY_MODIFIED,
-                           hVar,
-                           NULL );
+            pVarStorage = pVarID->pVarStorage;
         }
 
-        if ( pVarStorage->notifyMask & NOTIFY_MASK_MODIFIED_QUEUE )
+        if ( ( pVarStorage == NULL ) ||
+             ( !varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
         {
-            /* prepare the notification payload */
-            payload = varlist_GetNotificationPayload( hVar,
-                                                      pVarStorage,
-                                                      &n );
-
-            /* send the notification payloads */
-            NOTIFY_Payload( &pVarStorage->pNotifications,
-                            payload,
-                            n );
-
-            /* send notification signals to the clients */
-            NOTIFY_Signal( clientPID,
-                            &pVarStorage->pNotifications,
-                            NOTIFY_MODIFIED_QUEUE,
-                            hVar,
-                            NULL );
+            result = ENOENT;
+        }
+        else if ( pVarStorage->flags & VARFLAG_PASSWORD )
+        {
+            result = EACCES;
+        }
+        else if ( ( ( pVarStorage->flags & VARFLAG_HISTORY ) == 0 ) ||
+                  ( pVarStorage->var.type == VARTYPE_STR ) ||
+                  ( pVarStorage->var.type == VARTYPE_BLOB ) )
+        {
+            result = ENOTSUP;
+        }
+        else
+        {
+            result = HISTORY_Fetch( pVarStorage->pMeta->pHistory,
+                                    pVarStorage->var.type,
+                                    pQuery,
+                                    buf,
+                                    bufsize );
         }
     }
 
@@ -1926,148 +2634,230 @@ static int varlist_SendNotifications( pid_t clientPID,
 }
 
 /*============================================================================*/
-/*  varlist_HandleTrigger                                                     */
+/*  VARLIST_GetLargest                                                        */
 /*!
-    Check for and handle modification for a trigger variable
-
-    The varlist_HandleTrigger function checks to see if the variable
-    which is being set is a trigger variable.  If it is, and notifications,
-    are requested for this variable, then the notification will be sent out.
+    Get the variables which use the most server memory
 
+    The VARLIST_GetLargest function finds the n variables readable by
+    the client which use the most server memory, and stores them
+    largest first.  The memory used by a variable includes its storage
+    and metadata objects, its value, its notification registrations,
+    and its history ring.  Variables which share storage with an alias
+    are reported once.
 
     @param[in]
-        pVarStorage
-            Pointer to the variable storage
+        pVarInfo
+            Pointer to the variable definition containing the
+            credentials of the client
+
+    @param[out]
+        pUsage
+            pointer to an array of n entries to receive the variables
+
+    @param[in]
+        n
+            maximum number of variables to report
+
+    @param[out]
+        pCount
+            pointer to a location to store the number of variables
+            reported
+
+    @retval EOK the variables were reported
+    @retval EINVAL invalid arguments
 
 ==============================================================================*/
-static int varlist_HandleTrigger( pid_t clientPID,
-                                  VarStorage *pVarStorage,
-                                  VAR_HANDLE hVar )
+int VARLIST_GetLargest( VarInfo *pVarInfo,
+                        VarMemUsage *pUsage,
+                        size_t n,
+                        size_t *pCount )
 {
     int result = EINVAL;
+    VAR_HANDLE hVar;
+    VarID *pVarID;
+    VarID *pOther;
+    uint64_t bytes;
+    size_t count = 0;
+    size_t i;
+    bool duplicate;
 
-    if ( pVarStorage != NULL )
+    if( ( pVarInfo != NULL ) &&
+        ( ( pUsage != NULL ) || ( n == 0 ) ) &&
+        ( pCount != NULL ) )
     {
-        if (  pVarStorage->flags & VARFLAG_TRIGGER )
+        for( hVar = 1; ( n > 0 ) && ( hVar <= (VAR_HANDLE)varcount ); hVar++ )
         {
-            /* send out notifications */
-            result = varlist_SendNotifications( clientPID,
-                                                pVarStorage,
-                                                hVar );
+            pVarID = varlist_HandleVarID( hVar );
+            if( ( pVarID == NULL ) ||
+                ( pVarID->pVarStorage == NULL ) ||
+                ( !varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+            {
+                continue;
+            }
+
+            bytes = varlist_MemUsage( pVarID->pVarStorage );
+            if( ( count == n ) && ( bytes <= pUsage[count - 1].bytes ) )
+            {
+                continue;
+            }
+
+            /* aliases of a variable share its storage and its size */
+            duplicate = false;
+            for( i = 0; ( i < count ) && ( !duplicate ); i++ )
+            {
+                if( pUsage[i].bytes == bytes )
+                {
+                    pOther = varlist_HandleVarID( pUsage[i].hVar );
+                    duplicate = ( pOther != NULL ) &&
+                                ( pOther->pVarStorage ==
+                                  pVarID->pVarStorage );
+                }
+            }
+
+            if( !duplicate )
+            {
+                /* insert the variable in order of decreasing size */
+                i = ( count < n ) ? count++ : count - 1;
+                while( ( i > 0 ) && ( pUsage[i - 1].bytes < bytes ) )
+                {
+                    pUsage[i] = pUsage[i - 1];
+                    i--;
+                }
+
+                pUsage[i].hVar = hVar;
+                pUsage[i].bytes = bytes;
+            }
         }
+
+        *pCount = count;
+        result = EOK;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  varlist_SetDirty                                                          */
+/*  varlist_MemUsage                                                          */
 /*!
-    Set the variable's dirty bit
-
-    The varlist_SetDirty function sets the dirty bit for the variable
-    if it is a non-volatile variable.  The dirty bit is used to identify
-    variables that have been modified after startup.
+    Calculate the server memory used by a variable
 
     @param[in]
         pVarStorage
-            Pointer to the variable storage
+            pointer to the storage of the variable
+
+    @retval number of bytes of server memory used by the variable
 
 ==============================================================================*/
-static void varlist_SetDirty( VarStorage *pVarStorage )
+static uint64_t varlist_MemUsage( VarStorage *pVarStorage )
 {
-    if ( pVarStorage != NULL )
+    VarMeta *pMeta = pVarStorage->pMeta;
+    uint64_t bytes = sizeof( VarStorage ) + sizeof( VarMeta );
+
+    if( pVarStorage->var.type == VARTYPE_STR )
     {
-        if (  pVarStorage->flags & VARFLAG_VOLATILE )
-        {
-            /* do nothing for volatile flags */
-        }
-        else
-        {
-            /* set the dirty bit for non-volatile variables */
-            pVarStorage->flags |= VARFLAG_DIRTY;
-        }
+        bytes += pVarStorage->var.len + 1;
+    }
+    else if( pVarStorage->var.type == VARTYPE_BLOB )
+    {
+        /* a zero-copy blob segment holds two copies of the value */
+        bytes += ( pMeta->pSharedBlob != NULL ) ? 2 * pVarStorage->var.len
+                                                : pVarStorage->var.len;
     }
+
+    bytes += NOTIFY_Size( &pMeta->notifications );
+    bytes += HISTORY_Size( pMeta->pHistory );
+
+    return bytes;
 }
 
 /*============================================================================*/
-/*  varlist_Calc                                                              */
+/*  varlist_Compare                                                           */
 /*!
-    Function to be applied while unblocking CALC blocked clients
-
-    The varlist_Calc function copies the VarObject pointed by 'arg'
-    into the specified VarClient's VarObject.
+    Compare the value of a variable with an expected value
 
-    Strings are copied directly into the client's working buffer
+    The varlist_Compare function checks if a variable holds the expected
+    value of a compare-and-swap operation.  Numeric values are converted
+    to the type of the variable as they would be for a SET request.
 
-    @param[in,out]
-        pVarClient
-            Pointer to the VarClient to receive the VarObject
+    @param[in]
+        pVarStorage
+            pointer to the storage of the variable to compare
 
     @param[in]
-        arg
-            opaque pointer to the source VarInfo to copy
+        pExpected
+            pointer to the expected value
 
-    @retval EOK the variable was successfully copied
-    @retval EINVAL invalid arguments
-    @retval ENOENT no data available in the source VarObject
-    @retval E2BIG the string in the source VarObject will not fit in the
-            client's working buffer
+    @retval EOK the variable holds the expected value
+    @retval EAGAIN the variable does not hold the expected value
+    @retval ENOTSUP the values cannot be compared
 
 ==============================================================================*/
-static int varlist_Calc( VarClient *pVarClient, void *arg )
+static int varlist_Compare( VarStorage *pVarStorage,
+                            const VarObject *pExpected )
 {
-    int result = EINVAL;
-    VarInfo *pVarInfo = (VarInfo *)arg;
-    VarType varType;
-    size_t len;
-    VarID *pVarID;
-    VarStorage *pVarStorage = NULL;
+    int result = ENOTSUP;
+    VarStorage expected;
+    VarInfo info;
+    int rc = ENOTSUP;
 
-    if( ( pVarClient != NULL ) &&
-        ( pVarInfo != NULL ) )
+    if ( pVarStorage->var.type == VARTYPE_STR )
     {
-        pVarID = varlist_GetVarID( pVarInfo );
-        if ( pVarID != NULL )
+        if ( pExpected->type == VARTYPE_STR )
         {
-            pVarStorage = pVarID->pVarStorage;
+            result = ( strcmp( pVarStorage->var.val.str,
+                               pExpected->val.str ) == 0 ) ? EOK : EAGAIN;
         }
+    }
+    else if ( pVarStorage->var.type != VARTYPE_BLOB )
+    {
+        /* convert the expected value to the type of the variable
+           using a scratch copy of the variable storage */
+        expected = *pVarStorage;
+        info.var = *pExpected;
 
-        if ( pVarStorage != NULL )
+        switch( pVarStorage->var.type )
         {
-            /* get the storage reference identifier */
-            pVarInfo->storageRef = pVarStorage->storageRef;
+            case VARTYPE_FLOAT:
+                rc = varlist_SetFloat( &expected, &info );
+                break;
 
-            /* copy the format specifier */
-            memcpy( pVarClient->variableInfo.formatspec,
-                    pVarStorage->formatspec,
-                    MAX_FORMATSPEC_LEN );
+            case VARTYPE_UINT16:
+                rc = varlist_Set16( &expected, &info );
+                break;
 
-            /* copy the variable type from the varstore */
-            varType = pVarStorage->var.type;
-            pVarClient->variableInfo.var.type = varType;
+            case VARTYPE_INT16:
+                rc = varlist_Set16s( &expected, &info );
+                break;
 
-            /* copy the variable length from the varstore */
-            len = pVarStorage->var.len;
-            pVarClient->variableInfo.var.len = len;
+            case VARTYPE_UINT32:
+                rc = varlist_Set32( &expected, &info );
+                break;
 
-            if( varType == VARTYPE_STR )
-            {
-                result = varlist_CopyVarInfoStringToClient( pVarClient,
-                                                            pVarInfo );
-            }
-            else if ( varType == VARTYPE_BLOB )
-            {
-                result = varlist_CopyVarInfoBlobToClient( pVarClient,
-                                                          pVarInfo );
-            }
-            else
-            {
-                /* copy the source VarObject to the VarClient */
-                pVarClient->variableInfo.var.val = pVarInfo->var.val;
+            case VARTYPE_INT32:
+                rc = varlist_Set32s( &expected, &info );
+                break;
 
-                result = EOK;
-            }
+            case VARTYPE_UINT64:
+                rc = varlist_Set64( &expected, &info );
+                break;
+
+            case VARTYPE_INT64:
+                rc = varlist_Set64s( &expected, &info );
+                break;
+
+            default:
+                break;
+        }
+
+        if ( rc == EALREADY )
+        {
+            /* the conversion found the expected value */
+            result = EOK;
+        }
+        else if ( ( rc == EOK ) || ( rc == ERANGE ) )
+        {
+            /* the variable holds a different value */
+            result = EAGAIN;
         }
     }
 
@@ -2075,301 +2865,347 @@ static int varlist_Calc( VarClient *pVarClient, void *arg )
 }
 
 /*============================================================================*/
-/*  varlist_CopyVarInfoBlobToClient                                           */
+/*  varlist_ModifyValue                                                       */
 /*!
-    Copy a VarInfo blob into the client's working buffer
-
-    The varlist_CopyVarInfoBlobToClient function copies the VarInfo object
-    pointed to by the pVarInfo argument into the working buffer of the
-    client pointed to by pVarClient
+    Apply a read-modify-write operation to a value
 
-    Blobs are copied directly into the client's working buffer
+    The varlist_ModifyValue function applies an arithmetic or bitwise
+    operation to a copy of a numeric variable value.  Floating point
+    values only support the arithmetic operations.
 
     @param[in,out]
-        pVarClient
-            Pointer to the VarClient containing the working buffer to receive
-            the blob data
+        pValue
+            pointer to the value to modify
 
     @param[in]
-        pVarInfo
-            pointer to the VarInfo object containing the blob to copy
+        op
+            the VarModifyOp operation to apply
 
-    @retval EOK the blob was successfully copied
-    @retval EINVAL invalid arguments
-    @retval ENOENT no blob data contained in the source VarInfo object
-    @retval E2BIG the blob in the source VarObject will not fit in the
-            client's working buffer
+    @param[in]
+        pOperand
+            pointer to the operand (not used by VAR_MODIFY_INC and
+            VAR_MODIFY_DEC)
+
+    @retval EOK the value was modified
+    @retval ERANGE the result does not fit in the value
+    @retval ENOTSUP the operation is not supported on the value
 
 ==============================================================================*/
-static int varlist_CopyVarInfoBlobToClient( VarClient *pVarClient,
-                                            VarInfo *pVarInfo )
+static int varlist_ModifyValue( VarObject *pValue,
+                                int op,
+                                const VarObject *pOperand )
 {
-    int result = EINVAL;
-    size_t destlen;
+    int result = ENOTSUP;
+    VarObject one;
+    double d;
 
-    if ( ( pVarClient != NULL ) &&
-         ( pVarInfo != NULL ) )
+    if ( ( op == VAR_MODIFY_INC ) || ( op == VAR_MODIFY_DEC ) )
     {
-        /* get the destination blob size */
-        destlen = pVarClient->variableInfo.var.len;
+        /* increment and decrement add or subtract one */
+        one.type = VARTYPE_UINT16;
+        one.val.ui = 1;
+        pOperand = &one;
+        op = ( op == VAR_MODIFY_INC ) ? VAR_MODIFY_ADD : VAR_MODIFY_SUB;
+    }
 
-        /* check that the blob will fit */
-        if( ( pVarInfo->var.len <= destlen ) &&
-            ( destlen <= pVarClient->workbufsize ) )
+    if ( pValue->type == VARTYPE_FLOAT )
+    {
+        result = varlist_GetNumber( pOperand, &d );
+        if ( ( result == EOK ) &&
+             ( op == VAR_MODIFY_ADD ) )
         {
-            if( pVarInfo->var.val.blob != NULL )
-            {
-                /* copy the blob value into the client's working buffer */
-                memcpy( &pVarClient->workbuf,
-                        pVarInfo->var.val.blob,
-                        pVarInfo->var.len );
-
-                result = EOK;
-            }
-            else
-            {
-                /* no source blob to copy */
-                result = ENOENT;
-            }
+            pValue->val.f = (float)( pValue->val.f + d );
+        }
+        else if ( ( result == EOK ) &&
+                  ( op == VAR_MODIFY_SUB ) )
+        {
+            pValue->val.f = (float)( pValue->val.f - d );
         }
         else
         {
-            /* source blob is too big to fit in the client's buffer */
-            result = E2BIG;
+            result = ENOTSUP;
         }
     }
+    else if ( pOperand->type != VARTYPE_FLOAT )
+    {
+        result = varlist_ModifyInteger( pValue, op, pOperand );
+    }
 
     return result;
 }
 
 /*============================================================================*/
-/*  varlist_CopyVarInfoStringToClient                                         */
+/*  varlist_GetNumber                                                         */
 /*!
-    Copy a VarInfo string into the client's working buffer
-
-    The varlist_CopyVarInfoStringToClient function copies the VarInfo object
-    pointed to by the pVarInfo argument into the working buffer of the
-    client pointed to by pVarClient
-
-    Strings are copied directly into the client's working buffer
-
-    @param[in,out]
-        pVarClient
-            Pointer to the VarClient containing the working buffer to receive
-            the string data
+    Get the value of a numeric operand
 
     @param[in]
-        pVarInfo
-            pointer to the VarInfo object containing the string to copy
+        pOperand
+            pointer to the operand
 
-    @retval EOK the string was successfully copied
-    @retval EINVAL invalid arguments
-    @retval ENOENT no string data contained in the source VarInfo object
-    @retval E2BIG the string in the source VarObject will not fit in the
-            client's working buffer
+    @param[out]
+        pNumber
+            pointer to a location to store the operand value
+
+    @retval EOK the operand value was retrieved
+    @retval ENOTSUP the operand is not a number
 
 ==============================================================================*/
-static int varlist_CopyVarInfoStringToClient( VarClient *pVarClient,
-                                              VarInfo *pVarInfo )
+static int varlist_GetNumber( const VarObject *pOperand, double *pNumber )
 {
-    int result = EINVAL;
-    size_t destlen;
+    int result = EOK;
 
-    if ( ( pVarClient != NULL ) &&
-         ( pVarInfo != NULL ) )
+    switch( pOperand->type )
     {
-        /* get the destination blob size */
-        destlen = pVarClient->variableInfo.var.len;
+        case VARTYPE_UINT16:
+            *pNumber = pOperand->val.ui;
+            break;
 
-        /* check that the blob will fit */
-        if( ( pVarInfo->var.len <= destlen ) &&
-            ( destlen <= pVarClient->workbufsize ) )
-        {
-            if( pVarInfo->var.val.str != NULL )
-            {
-                /* copy the variable value into the client's working buffer */
-                strcpy( &pVarClient->workbuf, pVarInfo->var.val.str );
+        case VARTYPE_INT16:
+            *pNumber = pOperand->val.i;
+            break;
 
-                result = EOK;
+        case VARTYPE_UINT32:
+            *pNumber = pOperand->val.ul;
+            break;
 
-            }
-            else
-            {
-                /* no source string to copy */
-                result = ENOENT;
-            }
-        }
-        else
-        {
-            /* source string is too big to fit in the client's buffer */
-            result = E2BIG;
-        }
-    }
+        case VARTYPE_INT32:
+            *pNumber = pOperand->val.l;
+            break;
+
+        case VARTYPE_UINT64:
+            *pNumber = (double)pOperand->val.ull;
+            break;
+
+        case VARTYPE_INT64:
+            *pNumber = (double)pOperand->val.ll;
+            break;
+
+        case VARTYPE_FLOAT:
+            *pNumber = pOperand->val.f;
+            break;
+
+        default:
+            result = ENOTSUP;
+            break;
+    }
 
     return result;
 }
 
 /*============================================================================*/
-/*  varlist_Set16                                                             */
+/*  varlist_ModifyInteger                                                     */
 /*!
-    Store a value into a VARTYPE_UINT16 variable
+    Apply a read-modify-write operation to an integer value
 
-    The varlist_Set16 function stores a value into a VARTYPE_UINT16 variable.
-    The function will convert the source type if possible.
+    The varlist_ModifyInteger function applies an arithmetic or bitwise
+    operation with an integer operand to a copy of an integer variable
+    value.  The arithmetic is performed on the exact values, and results
+    which cannot be represented by the type of the value are rejected.
+    The bitwise operations keep the bits which fit in the value.
+
+    @param[in,out]
+        pValue
+            pointer to the value to modify
 
     @param[in]
-        pVarStorage
-            pointer to the storage object for the target variable
+        op
+            the VAR_MODIFY_ADD, VAR_MODIFY_SUB, VAR_MODIFY_OR,
+            VAR_MODIFY_AND or VAR_MODIFY_CLEAR operation to apply
 
     @param[in]
-        pVarInfo
-            pointer to the variable info object containing the value to set
+        pOperand
+            pointer to the integer operand
 
-    @retval EOK the variable was successfully set
-    @retval ENOTSUP the source variable is not supported for this operation
-    @retval ERANGE the source variable is outside of the range that can be
-                   supported by the target variable
-    @retval EINVAL invalid arguments
-    @retval EALREADY the value is already set to the requested value
+    @retval EOK the value was modified
+    @retval ERANGE the result does not fit in the value
+    @retval ENOTSUP the operation is not supported on the value
 
 ==============================================================================*/
-static int varlist_Set16( VarStorage *pVarStorage, VarInfo *pVarInfo )
+static int varlist_ModifyInteger( VarObject *pValue,
+                                  int op,
+                                  const VarObject *pOperand )
 {
-    int result = EINVAL;
-    VarType srctype;
-    uint16_t ui;
+    int result = EOK;
+    int64_t s = 0;
+    uint64_t u = 0;
+    int64_t sv = 0;
+    uint64_t uv = 0;
+    int64_t smin = 0;
+    int64_t smax = 0;
+    uint64_t umax = 0;
+    bool isSigned = true;
+    bool big = false;
+    bool overflow = false;
+
+    /* get the operand value and bit pattern */
+    switch( pOperand->type )
+    {
+        case VARTYPE_UINT16:
+            s = pOperand->val.ui;
+            break;
 
-    if( ( pVarStorage != NULL ) &&
-        ( pVarInfo != NULL ) )
+        case VARTYPE_INT16:
+            s = pOperand->val.i;
+            break;
+
+        case VARTYPE_UINT32:
+            s = pOperand->val.ul;
+            break;
+
+        case VARTYPE_INT32:
+            s = pOperand->val.l;
+            break;
+
+        case VARTYPE_INT64:
+            s = pOperand->val.ll;
+            break;
+
+        case VARTYPE_UINT64:
+            /* operands above INT64_MAX are used unsigned */
+            s = (int64_t)pOperand->val.ull;
+            big = ( pOperand->val.ull > INT64_MAX );
+            break;
+
+        default:
+            result = ENOTSUP;
+            break;
+    }
+
+    u = (uint64_t)s;
+
+    /* get the current value and its range */
+    switch( pValue->type )
     {
-        srctype = pVarInfo->var.type;
-        switch( srctype )
+        case VARTYPE_UINT16:
+            uv = pValue->val.ui;
+            umax = UINT16_MAX;
+            isSigned = false;
+            break;
+
+        case VARTYPE_INT16:
+            sv = pValue->val.i;
+            smin = INT16_MIN;
+            smax = INT16_MAX;
+            break;
+
+        case VARTYPE_UINT32:
+            uv = pValue->val.ul;
+            umax = UINT32_MAX;
+            isSigned = false;
+            break;
+
+        case VARTYPE_INT32:
+            sv = pValue->val.l;
+            smin = INT32_MIN;
+            smax = INT32_MAX;
+            break;
+
+        case VARTYPE_UINT64:
+            uv = pValue->val.ull;
+            umax = UINT64_MAX;
+            isSigned = false;
+            break;
+
+        case VARTYPE_INT64:
+            sv = pValue->val.ll;
+            smin = INT64_MIN;
+            smax = INT64_MAX;
+            break;
+
+        default:
+            result = ENOTSUP;
+            break;
+    }
+
+    if ( result == EOK )
+    {
+        switch( op )
         {
-            case VARTYPE_INT16:
-                if ( pVarInfo->var.val.i < 0 )
+            case VAR_MODIFY_ADD:
+                if ( isSigned == true )
                 {
-                    result = ERANGE;
+                    overflow = big ? __builtin_add_overflow( sv, u, &sv )
+                                   : __builtin_add_overflow( sv, s, &sv );
                 }
                 else
                 {
-                    ui = (uint16_t)(pVarInfo->var.val.i);
-                    if ( pVarStorage->var.val.ui == ui )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ui = ui;
-                        result = EOK;
-                    }
+                    overflow = big ? __builtin_add_overflow( uv, u, &uv )
+                                   : __builtin_add_overflow( uv, s, &uv );
                 }
                 break;
 
-            case VARTYPE_UINT16:
-                if ( pVarStorage->var.val.ui == pVarInfo->var.val.ui )
+            case VAR_MODIFY_SUB:
+                if ( isSigned == true )
                 {
-                    result = EALREADY;
+                    overflow = big ? __builtin_sub_overflow( sv, u, &sv )
+                                   : __builtin_sub_overflow( sv, s, &sv );
                 }
                 else
                 {
-                    pVarStorage->var.val.ui = pVarInfo->var.val.ui;
-                    result = EOK;
+                    overflow = big ? __builtin_sub_overflow( uv, u, &uv )
+                                   : __builtin_sub_overflow( uv, s, &uv );
                 }
                 break;
 
-            case VARTYPE_INT32:
-                if ( ( pVarInfo->var.val.l > 65535 ) ||
-                     ( pVarInfo->var.val.l < 0 ) )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    /* store int32_t sources into uint16_t target */
-                    ui = (uint16_t)(pVarInfo->var.val.l);
+            case VAR_MODIFY_OR:
+                sv = (int64_t)( (uint64_t)sv | u );
+                uv |= u;
+                break;
 
-                    if ( ui == pVarStorage->var.val.ui )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ui = ui;
-                        result = EOK;
-                    }
-                }
+            case VAR_MODIFY_AND:
+                sv = (int64_t)( (uint64_t)sv & u );
+                uv &= u;
                 break;
 
-            case VARTYPE_UINT32:
-                if( pVarInfo->var.val.ul > 65535 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    /* store uint32_t source into uint16_t target */
-                    ui = (uint16_t)(pVarInfo->var.val.ul);
+            case VAR_MODIFY_CLEAR:
+                sv = (int64_t)( (uint64_t)sv & ~u );
+                uv &= ~u;
+                break;
 
-                    if ( ui == pVarStorage->var.val.ui )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ui = ui;
-                        result = EOK;
-                    }
-                }
+            default:
+                result = ENOTSUP;
                 break;
+        }
+    }
 
-            case VARTYPE_UINT64:
-                if( pVarInfo->var.val.ull > 65535 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    /* store uint64_t source into uint16_t target */
-                    ui = (uint16_t)(pVarInfo->var.val.ull);
+    if ( ( result == EOK ) &&
+         ( ( op == VAR_MODIFY_ADD ) || ( op == VAR_MODIFY_SUB ) ) &&
+         ( ( overflow == true ) ||
+           ( ( isSigned == true ) && ( ( sv < smin ) || ( sv > smax ) ) ) ||
+           ( ( isSigned == false ) && ( uv > umax ) ) ) )
+    {
+        /* the result cannot be represented by the variable */
+        result = ERANGE;
+    }
 
-                    if ( ui == pVarStorage->var.val.ui )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ui = ui;
-                        result = EOK;
-                    }
-                }
+    if ( result == EOK )
+    {
+        /* store the result, keeping the bits which fit in the value */
+        switch( pValue->type )
+        {
+            case VARTYPE_UINT16:
+                pValue->val.ui = (uint16_t)uv;
                 break;
 
-            case VARTYPE_INT64:
-                if ( ( pVarInfo->var.val.ll > 65535 ) ||
-                     ( pVarInfo->var.val.ll < 0 ) )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    /* store int64_t source into uint16_t target */
-                    ui = (uint16_t)(pVarInfo->var.val.ll);
+            case VARTYPE_INT16:
+                pValue->val.i = (int16_t)sv;
+                break;
 
-                    if ( ui == pVarStorage->var.val.ui )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ui = ui;
-                        result = EOK;
-                    }
-                }
+            case VARTYPE_UINT32:
+                pValue->val.ul = (uint32_t)uv;
+                break;
+
+            case VARTYPE_INT32:
+                pValue->val.l = (int32_t)sv;
+                break;
+
+            case VARTYPE_UINT64:
+                pValue->val.ull = uv;
                 break;
 
             default:
-                /* conversion not supported */
-                result = ENOTSUP;
+                pValue->val.ll = sv;
                 break;
         }
     }
@@ -2378,600 +3214,3335 @@ static int varlist_Set16( VarStorage *pVarStorage, VarInfo *pVarInfo )
 }
 
 /*============================================================================*/
-/*  varlist_Set16s                                                            */
+/*  varlist_Changed                                                           */
 /*!
-    Store a value into a VARTYPE_INT16 variable
+    Complete a change to a variable value
 
-    The varlist_Set16s function stores a value into a VARTYPE_INT16 variable.
-    The function will convert the source type if possible.
+    The varlist_Changed function performs the actions which follow an
+    attempt to set a variable.  When the value has changed, it marks
+    the variable as dirty, bumps its version, journals the new value
+    and updates any shared copy.  When the set succeeded, it releases
+    any CALC blocked clients and sends the change notifications.
 
     @param[in]
-        pVarStorage
-            pointer to the storage object for the target variable
+        clientPID
+            process identifier of the client which set the variable
+
+    @param[in]
+        pVarID
+            pointer to the variable which was set
 
     @param[in]
         pVarInfo
-            pointer to the variable info object containing the value to set
+            pointer to the variable info from the set request
 
-    @retval EOK the variable was successfully set
-    @retval ENOTSUP the source variable is not supported for this operation
-    @retval ERANGE the source variable is outside of the range that can be
-                   supported by the target variable
-    @retval EINVAL invalid arguments
-    @retval EALREADY the value is already set to the requested value
+    @param[in]
+        result
+            result of storing the value
+
+    @retval EOK the variable was set
+    @retval other the error from storing the value or sending the
+            notifications
 
 ==============================================================================*/
-static int varlist_Set16s( VarStorage *pVarStorage, VarInfo *pVarInfo )
+static int varlist_Changed( pid_t clientPID,
+                            VarID *pVarID,
+                            VarInfo *pVarInfo,
+                            int result )
 {
-    int result = EINVAL;
-    VarType srctype;
-    int16_t i;
+    VarStorage *pVarStorage = pVarID->pVarStorage;
+    VAR_HANDLE hVar = pVarID->hVar;
 
-    if( ( pVarStorage != NULL ) &&
-        ( pVarInfo != NULL ) )
+    if ( result == EOK )
     {
-        srctype = pVarInfo->var.type;
-        switch( srctype )
-        {
-            case VARTYPE_INT16:
-                if ( pVarStorage->var.val.i == pVarInfo->var.val.i )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.i = pVarInfo->var.val.i;
-                    result = EOK;
-                }
-                break;
+        varlist_SetDirty( pVarID );
 
-            case VARTYPE_UINT16:
-                if ( pVarInfo->var.val.ui > 32767 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    /* store uint16_t source into int16_t target */
-                    i = (int16_t)(pVarInfo->var.val.ui);
-                    if ( i == pVarStorage->var.val.i )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.i = i;
-                        result = EOK;
-                    }
-                }
-                break;
+        /* write the value through to the warm standby arena */
+        STANDBY_Update( pVarStorage->storageRef, hVar, &pVarStorage->var );
 
-            case VARTYPE_INT32:
-                if( ( pVarInfo->var.val.l > 32767 ) ||
-                    ( pVarInfo->var.val.l < -32768 ) )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    /* store int32_t source into int16_t target */
-                    i = (int16_t)(pVarInfo->var.val.l);
+        /* invalidate any client cached copies of the value */
+        VARVERSIONS_Increment( pVarStorage->storageRef );
 
-                    if ( i == pVarStorage->var.val.i )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.i = i;
-                        result = EOK;
-                    }
-                }
-                break;
+        /* record the change in the journal */
+        if ( ( pVarStorage->flags & VARFLAG_VOLATILE ) == 0 )
+        {
+            JOURNAL_Append( pVarID->name,
+                            pVarID->instanceID,
+                            &pVarStorage->var );
+        }
 
-            case VARTYPE_UINT32:
-                if( pVarInfo->var.val.ul > 32767 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    /* store uint32_t source into int16_t target */
-                    i = (int16_t)(pVarInfo->var.val.ul);
+        /* update the shared copy of the variable value */
+        if ( pVarStorage->sharedSlot != 0 )
+        {
+            SHAREDVALUES_Update( pVarStorage->sharedSlot,
+                                 &pVarStorage->var );
+        }
 
-                    if ( i == pVarStorage->var.val.i )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.i = i;
-                        result = EOK;
-                    }
-                }
-                break;
+        /* record the value in the history ring */
+        if ( pVarStorage->flags & VARFLAG_HISTORY )
+        {
+            varlist_RecordHistory( pVarStorage );
+        }
+    }
 
-            case VARTYPE_INT64:
-                if( ( pVarInfo->var.val.ll > 32767 ) ||
-                    ( pVarInfo->var.val.ll < -32768 ) )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    /* store int64_t source into int16_t target */
-                    i = (int16_t)(pVarInfo->var.val.ll);
+    if ( pVarStorage->flags & VARFLAG_AUDIT )
+    {
+        varlist_Audit( clientPID, pVarID, pVarInfo );
+    }
 
-                    if ( i == pVarStorage->var.val.i )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.i = i;
-                        result = EOK;
-                    }
-                }
+    if ( ( result == EOK ) ||
+         ( result == EALREADY ) )
+    {
+        if( ( pVarStorage->pMeta->calcTTL != 0 ) &&
+            ( pVarStorage->notifyMask & NOTIFY_MASK_CALC ) &&
+            ( NOTIFY_GetPID( &pVarStorage->pMeta->notifications,
+                             NOTIFY_CALC ) == clientPID ) )
+        {
+            /* the CALC handler has supplied a new value, which can be
+               reused until its TTL expires */
+            pVarStorage->pMeta->calcExpiry = NOTIFY_Now() +
+                                             pVarStorage->pMeta->calcTTL;
+        }
+
+        /* check for any CALC blocked clients on the variable */
+        if( pVarStorage->notifyMask & NOTIFY_MASK_HAS_CALC_BLOCK )
+        {
+            /* all of the CALC blocked clients are waiting for the
+               same calculation, so unblock them all with its result */
+            while( UnblockClients( pVarStorage->storageRef,
+                                   NOTIFY_CALC,
+                                   varlist_Calc,
+                                   (void *)pVarInfo ) == EOK );
+
+            /* indicate we no longer have CALC blocked clients */
+            pVarStorage->notifyMask &= ~NOTIFY_MASK_HAS_CALC_BLOCK;
+            varlist_UpdateSetPlan( pVarStorage );
+        }
+
+        if ( result == EOK )
+        {
+            /* send out notifications */
+            result = varlist_SendNotifications( clientPID,
+                                                pVarStorage,
+                                                hVar );
+        }
+    }
+
+    if ( result == EALREADY )
+    {
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_UpdateSetPlan                                                     */
+/*!
+    Select the set plan of a variable
+
+    The varlist_UpdateSetPlan function selects the set plan of a variable
+    from its type, flags and notification mask.  It is called whenever
+    any of these change, so the set path does not need to check for
+    write side features the variable does not use.
+
+    @param[in]
+        pVarStorage
+            pointer to the variable storage to update
+
+==============================================================================*/
+static void varlist_UpdateSetPlan( VarStorage *pVarStorage )
+{
+    uint8_t plan = SETPLAN_GENERAL;
+
+    if ( ( ( pVarStorage->flags & SETPLAN_GENERAL_FLAGS ) == 0 ) &&
+         ( pVarStorage->notifyMask == 0 ) )
+    {
+        switch( pVarStorage->var.type )
+        {
+            case VARTYPE_UINT16:
+            case VARTYPE_INT16:
+                plan = SETPLAN_16;
+                break;
+
+            case VARTYPE_UINT32:
+            case VARTYPE_INT32:
+                plan = SETPLAN_32;
                 break;
 
             case VARTYPE_UINT64:
-                if( pVarInfo->var.val.ull > 32767 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    /* store uint64_t source into int16_t target */
-                    i = (int16_t)(pVarInfo->var.val.ull);
+            case VARTYPE_INT64:
+                plan = SETPLAN_64;
+                break;
 
-                    if ( i == pVarStorage->var.val.i )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.i = i;
-                        result = EOK;
-                    }
-                }
+            case VARTYPE_FLOAT:
+                plan = SETPLAN_FLOAT;
                 break;
 
             default:
-                /* conversion not supported */
-                result = ENOTSUP;
                 break;
         }
     }
 
-    return result;
+    pVarStorage->setPlan = plan;
 }
 
 /*============================================================================*/
-/*  varlist_Set32                                                             */
+/*  varlist_FastSet                                                           */
 /*!
-    Store a value into a VARTYPE_UINT32 variable
+    Store a value using the fast set path
 
-    The varlist_Set32 function stores a value into a VARTYPE_UINT32 variable.
-    The function will convert the source type if possible.
+    The varlist_FastSet function stores a value of the same type into
+    a variable with a fast set plan.  The value needs no conversion or
+    range checks, and the variable has no validation, notifications,
+    triggers, auditing or history, so only the permission checks and
+    the change bookkeeping remain.
 
     @param[in]
-        pVarStorage
-            pointer to the storage object for the target variable
+        clientPID
+            process identifier of the client setting the variable
 
     @param[in]
+        pVarID
+            pointer to the variable to set
+
+    @param[in,out]
         pVarInfo
-            pointer to the variable info object containing the value to set
+            pointer to the variable info from the set request
 
-    @retval EOK the variable was successfully set
-    @retval ENOTSUP the source variable is not supported for this operation
-    @retval EINVAL invalid arguments
-    @retval EALREADY the value is already set to the requested value
+    @retval EOK the variable was set
+    @retval ENOENT the client cannot read the variable
+    @retval EACCES the client cannot write the variable
 
 ==============================================================================*/
-static int varlist_Set32( VarStorage *pVarStorage, VarInfo *pVarInfo )
+static int varlist_FastSet( pid_t clientPID,
+                            VarID *pVarID,
+                            VarInfo *pVarInfo )
 {
-    int result = EINVAL;
-    VarType srctype;
-    uint32_t ul;
+    int result = EALREADY;
+    VarStorage *pVarStorage = pVarID->pVarStorage;
+    VarData *pDst = &pVarStorage->var.val;
+    VarData *pSrc = &pVarInfo->var.val;
 
-    if( ( pVarStorage != NULL ) &&
-        ( pVarInfo != NULL ) )
+    if ( varlist_CheckReadPermissions( pVarInfo, pVarID ) == false )
     {
-        srctype = pVarInfo->var.type;
-        switch( srctype )
+        result = ENOENT;
+    }
+    else if ( varlist_CheckWritePermissions( pVarInfo, pVarID ) == false )
+    {
+        result = EACCES;
+    }
+    else
+    {
+        /* get the storage reference identifier */
+        pVarInfo->storageRef = pVarStorage->storageRef;
+
+        switch( pVarStorage->setPlan )
         {
-            case VARTYPE_UINT32:
-                if( pVarStorage->var.val.ul == pVarInfo->var.val.ul )
-                {
-                    result = EALREADY;
-                }
-                else
+            case SETPLAN_16:
+                if ( pDst->ui != pSrc->ui )
                 {
-                    pVarStorage->var.val.ul = pVarInfo->var.val.ul;
+                    pDst->ui = pSrc->ui;
                     result = EOK;
                 }
                 break;
 
-            case VARTYPE_INT32:
-                if ( pVarInfo->var.val.l < 0 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    ul = (uint32_t)(pVarInfo->var.val.l);
-                    if( pVarStorage->var.val.ul == ul )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ul = ul;
-                        result = EOK;
-                    }
-                }
-                break;
-
-            case VARTYPE_INT16:
-                if ( pVarInfo->var.val.i < 0 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    ul = pVarInfo->var.val.ui;
-                    if ( ul == pVarStorage->var.val.ul )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ul = ul;
-                        result = EOK;
-                    }
-                }
-                break;
-
-            case VARTYPE_UINT16:
-                ul = pVarInfo->var.val.ui;
-                if ( ul == pVarStorage->var.val.ul )
-                {
-                    result = EALREADY;
-                }
-                else
+            case SETPLAN_32:
+                if ( pDst->ul != pSrc->ul )
                 {
-                    pVarStorage->var.val.ul = ul;
+                    pDst->ul = pSrc->ul;
                     result = EOK;
                 }
                 break;
 
-            case VARTYPE_UINT64:
-                if ( pVarInfo->var.val.ull > 4294967295 )
-                {
-                    result = ERANGE;
-                }
-                else
+            case SETPLAN_64:
+                if ( pDst->ull != pSrc->ull )
                 {
-                    ul = (uint32_t)(pVarInfo->var.val.ull);
-                    if ( pVarStorage->var.val.ul == ul )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ul = ul;
-                        result = EOK;
-                    }
+                    pDst->ull = pSrc->ull;
+                    result = EOK;
                 }
                 break;
 
-            case VARTYPE_INT64:
-                if ( ( pVarInfo->var.val.ll > 4294967295 ) ||
-                     ( pVarInfo->var.val.ll < 0 ) )
-                {
-                    result = ERANGE;
-                }
-                else
+            case SETPLAN_FLOAT:
+                if ( pDst->f != pSrc->f )
                 {
-                    ul = (uint32_t)(pVarInfo->var.val.ll);
-                    if ( pVarStorage->var.val.ul == ul )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ul = ul;
-                        result = EOK;
-                    }
+                    pDst->f = pSrc->f;
+                    result = EOK;
                 }
                 break;
 
             default:
-                result = ENOTSUP;
                 break;
         }
-    }
 
-    return result;
-}
+        if ( result == EOK )
+        {
+            varlist_SetDirty( pVarID );
 
-/*============================================================================*/
-/*  varlist_Set32s                                                            */
-/*!
-    Store a value into a VARTYPE_INT32 variable
+            /* write the value through to the warm standby arena */
+            STANDBY_Update( pVarStorage->storageRef,
+                            pVarID->hVar,
+                            &pVarStorage->var );
 
-    The varlist_Set32s function stores a value into a VARTYPE_INT32 variable.
-    The function will convert the source type if possible.
+            /* invalidate any client cached copies of the value */
+            VARVERSIONS_Increment( pVarStorage->storageRef );
 
-    @param[in]
-        pVarStorage
-            pointer to the storage object for the target variable
-
-    @param[in]
-        pVarInfo
-            pointer to the variable info object containing the value to set
-
-    @retval EOK the variable was successfully set
-    @retval ENOTSUP the source variable is not supported for this operation
-    @retval EINVAL invalid arguments
-    @retval EALREADY the value is already set to the requested value
+            /* record the change in the journal */
+            if ( ( pVarStorage->flags & VARFLAG_VOLATILE ) == 0 )
+            {
+                JOURNAL_Append( pVarID->name,
+                                pVarID->instanceID,
+                                &pVarStorage->var );
+            }
 
-==============================================================================*/
-static int varlist_Set32s( VarStorage *pVarStorage, VarInfo *pVarInfo )
-{
-    int result = EINVAL;
-    VarType srctype;
-    int32_t l;
+            /* update the shared copy of the variable value */
+            if ( pVarStorage->sharedSlot != 0 )
+            {
+                SHAREDVALUES_Update( pVarStorage->sharedSlot,
+                                     &pVarStorage->var );
+            }
 
-    if( ( pVarStorage != NULL ) &&
-        ( pVarInfo != NULL ) )
-    {
-        srctype = pVarInfo->var.type;
-        switch( srctype )
+            if ( pQuerySubscriptions != NULL )
+            {
+                /* the variable may match a query subscription */
+                result = varlist_SendNotifications( clientPID,
+                                                    pVarStorage,
+                                                    pVarID->hVar );
+            }
+        }
+        else
         {
-            case VARTYPE_UINT32:
-                if ( pVarInfo->var.val.ul > 2147483647 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    l = (int32_t)(pVarInfo->var.val.ul);
-                    if( pVarStorage->var.val.l == l )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.l = l;
-                        result = EOK;
-                    }
-                }
-                break;
+            /* the variable already holds the value */
+            result = EOK;
+        }
+    }
 
-            case VARTYPE_INT32:
-                if ( pVarStorage->var.val.l == pVarInfo->var.val.l )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.l = pVarInfo->var.val.l;
-                    result = EOK;
-                }
-                break;
+    return result;
+}
 
-            case VARTYPE_INT16:
-                l = (int32_t)(pVarInfo->var.val.i);
-                if ( pVarStorage->var.val.l == l )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.l = l;
-                    result = EOK;
-                }
-                break;
+/*============================================================================*/
+/*  varlist_RecordHistory                                                     */
+/*!
+    Record a new variable value in its history ring
 
-            case VARTYPE_UINT16:
-                l = (int32_t)(pVarInfo->var.val.ui);
-                if ( pVarStorage->var.val.l == l )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.l = l;
-                    result = EOK;
-                }
-                break;
+    The varlist_RecordHistory function appends the current value of a
+    VARFLAG_HISTORY variable to its history ring, allocating the ring
+    when the first value is recorded.  String and blob values are
+    not recorded.
 
-            case VARTYPE_UINT64:
-                if ( pVarInfo->var.val.ull > 2147483647 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    l = (int32_t)(pVarInfo->var.val.ull);
-                    if ( pVarStorage->var.val.l == l )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.l = l;
-                        result = EOK;
-                    }
-                }
-                break;
+    @param[in]
+        pVarStorage
+            pointer to the storage of the changed variable
 
-            case VARTYPE_INT64:
-                if ( ( pVarInfo->var.val.ll > 2147483647 ) ||
-                     ( pVarInfo->var.val.ll < -2147483648 ) )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    l = (int32_t)(pVarInfo->var.val.ll);
-                    if ( pVarStorage->var.val.l == l )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.l = l;
-                        result = EOK;
-                    }
-                }
-                break;
+==============================================================================*/
+static void varlist_RecordHistory( VarStorage *pVarStorage )
+{
+    VarMeta *pMeta = pVarStorage->pMeta;
 
-            default:
-                result = ENOTSUP;
-                break;
+    if ( ( pVarStorage->var.type != VARTYPE_STR ) &&
+         ( pVarStorage->var.type != VARTYPE_BLOB ) )
+    {
+        if ( pMeta->pHistory == NULL )
+        {
+            pMeta->pHistory = HISTORY_Create();
         }
-    }
 
-    return result;
+        HISTORY_Append( pMeta->pHistory, &pVarStorage->var );
+    }
 }
 
 /*============================================================================*/
-/*  varlist_Set64                                                             */
+/*  varlist_Audit                                                             */
 /*!
-    Store a value into a VARTYPE_UINT64 variable
+    Create a variable change audit log
 
-    The varlist_Set64 function stores a value into a VARTYPE_UINT64 variable.
-    The function will convert the source type if possible.
+    The varlist_Audit function creates a variable change audit log,
+    using syslog, and writes the variable name, value, user id, and
+    process id that requested the change.
 
     @param[in]
-        pVarStorage
-            pointer to the storage object for the target variable
+        clientPID
+            process id of the client requesting the change
+
+    @param[in]
+        pVarID
+            pointer to the variable ID object that was changed
 
     @param[in]
         pVarInfo
-            pointer to the variable info object containing the value to set
+            pointer to the variable change info for the change request
 
-    @retval EOK the variable was successfully set
-    @retval ENOTSUP the source variable is not supported for this operation
+    @retval EOK the variable audit log was written
+    @retval ENOTSUP unsupported data type
     @retval EINVAL invalid arguments
-    @retval EALREADY the value is already set to the requested value
 
 ==============================================================================*/
-static int varlist_Set64( VarStorage *pVarStorage, VarInfo *pVarInfo )
+static int varlist_Audit( pid_t clientPID,
+                          VarID *pVarID,
+                          VarInfo *pVarInfo )
 {
     int result = EINVAL;
-    VarType srctype;
-    uint64_t ull;
+    VarStorage *pVarStorage = NULL;
+    uid_t uid;
+    const char *varname;
 
-    if( ( pVarStorage != NULL ) &&
-        ( pVarInfo != NULL ) )
+    if ( ( pVarInfo != NULL ) &&
+         ( pVarID != NULL ) )
     {
-        srctype = pVarInfo->var.type;
-        switch( srctype )
+        uid = pVarInfo->creds[0];
+        varname = pVarID->name;
+
+        pVarStorage = pVarID->pVarStorage;
+        if ( pVarStorage != NULL )
         {
-            case VARTYPE_UINT32:
-                ull = (uint64_t)(pVarInfo->var.val.ul);
-                if( pVarStorage->var.val.ull == ull )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.ull = ull;
+            result = EOK;
+
+            switch( pVarStorage->var.type )
+            {
+                case VARTYPE_FLOAT:
+                    syslog( LOG_INFO,
+                            "'%s' changed to '%f' by user %d from process %d",
+                            varname,
+                            pVarStorage->var.val.f,
+                            uid,
+                            clientPID  );
+                    break;
+
+                case VARTYPE_BLOB:
+                    syslog( LOG_INFO,
+                            "'%s' changed by user %d from process %d",
+                            varname,
+                            uid,
+                            clientPID  );
                     result = EOK;
-                }
-                break;
+                    break;
 
-            case VARTYPE_INT32:
-                if ( pVarInfo->var.val.l < 0 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    ull = (uint64_t)(pVarInfo->var.val.l);
-                    if( pVarStorage->var.val.ull == ull )
-                    {
-                        result = EALREADY;
-                    }
-                    else
+                case VARTYPE_STR:
+                    if ( pVarStorage->var.val.str != NULL )
                     {
-                        pVarStorage->var.val.ull = ull;
-                        result = EOK;
+                        syslog( LOG_INFO,
+                                "'%s' changed to '%s' by user %d "
+                                "from process %d",
+                                varname,
+                                pVarStorage->var.val.str,
+                                uid,
+                                clientPID  );
                     }
-                }
-                break;
+                    result = EOK;
+                    break;
 
-            case VARTYPE_INT16:
-                if ( pVarInfo->var.val.i < 0 )
-                {
-                    result = ERANGE;
-                }
-                else
-                {
-                    ull = (uint64_t)(pVarInfo->var.val.i);
-                    if ( ull == pVarStorage->var.val.ull )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ull = ull;
-                        result = EOK;
-                    }
-                }
-                break;
+                case VARTYPE_UINT16:
+                    syslog( LOG_INFO,
+                            "'%s' changed to '%u' by user %d from process %d",
+                            varname,
+                            pVarStorage->var.val.ui,
+                            uid,
+                            clientPID  );
+                    break;
 
-            case VARTYPE_UINT16:
-                ull = (uint64_t)(pVarInfo->var.val.ui);
-                if ( ull == pVarStorage->var.val.ull )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.ull = ull;
-                    result = EOK;
-                }
-                break;
+                case VARTYPE_INT16:
+                    syslog( LOG_INFO,
+                            "'%s' changed to '%d' by user %d from process %d",
+                            varname,
+                            pVarStorage->var.val.i,
+                            uid,
+                            clientPID  );
+                    break;
 
-            case VARTYPE_UINT64:
-                if ( pVarInfo->var.val.ull == pVarStorage->var.val.ull )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.ull = pVarInfo->var.val.ull;
-                    result = EOK;
-                }
-                break;
+                case VARTYPE_UINT32:
+                    syslog( LOG_INFO,
+                            "'%s' changed to '"
+                            "%" PRIu32
+                            "' by user %d from process %d",
+                            varname,
+                            pVarStorage->var.val.ul,
+                            uid,
+                            clientPID  );
+                    break;
 
-            case VARTYPE_INT64:
-                if ( pVarInfo->var.val.ll < 0 )
-                {
-                    result = ERANGE;
-                }
-                else
+                case VARTYPE_INT32:
+                    syslog( LOG_INFO,
+                            "'%s' changed to '"
+                            "%" PRId32
+                            "' by user %d from process %d",
+                            varname,
+                            pVarStorage->var.val.l,
+                            uid,
+                            clientPID  );
+                    break;
+
+                case VARTYPE_UINT64:
+                    syslog( LOG_INFO,
+                            "'%s' changed to '"
+                            "%" PRIu64
+                            "' by user %d from process %d",
+                            varname,
+                            pVarStorage->var.val.ull,
+                            uid,
+                            clientPID  );
+                    break;
+
+                case VARTYPE_INT64:
+                    syslog( LOG_INFO,
+                            "'%s' changed to '"
+                            "%" PRId64
+                            "' by user %d from process %d",
+                            varname,
+                            pVarStorage->var.val.ll,
+                            uid,
+                            clientPID  );
+                    break;
+
+                default:
+                    result = ENOTSUP;
+                    break;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_SetFlags                                                          */
+/*!
+    Handle a SET_FLAGS request from a client
+
+    The VARLIST_SetFlags function handles a SET_FLAGS request from a client.
+    It sets the specified flags on the specified variable
+
+    @param[in]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable whose flags will be set
+
+    @retval EOK the variable flags were successfully set
+    @retval ENOENT the variable does not exist
+    @retval EACCES insufficient permissions to set the flags
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_SetFlags( VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarStorage *pVarStorage = NULL;
+    VarID *pVarID;
+    bool rc;
+
+    if( pVarInfo != NULL )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            pVarStorage = pVarID->pVarStorage;
+        }
+
+        result = ENOENT;
+
+        if ( ( pVarStorage != NULL ) &&
+             ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            /* check if we have write permissions on this variable */
+            rc = varlist_CheckWritePermissions( pVarInfo, pVarID );
+            if ( rc == true )
+            {
+                pVarStorage->flags |= pVarInfo->flags;
+                varlist_IndexStorage( pVarStorage, pVarID );
+                varlist_UpdateSetPlan( pVarStorage );
+                STANDBY_Changed();
+
+                /* get the storage reference identifier */
+                pVarInfo->storageRef = pVarStorage->storageRef;
+
+                result = EOK;
+            }
+            else
+            {
+                result = EACCES;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_ClearFlags                                                        */
+/*!
+    Handle a CLEAR_FLAGS request from a client
+
+    The VARLIST_ClearFlags function handles a CLEAR_FLAGS request from a client.
+    It clears the specified flags on the specified variable
+
+    @param[in]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable whose flags will be cleared
+
+    @retval EOK the variable flags were successfully cleared
+    @retval ENOENT the variable does not exist
+    @retval EACCES insufficient permissions to clear the flags
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_ClearFlags( VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarStorage *pVarStorage = NULL;
+    VarID *pVarID;
+    int rc;
+
+    if( pVarInfo != NULL )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            pVarStorage = pVarID->pVarStorage;
+        }
+
+        result = ENOENT;
+
+        if( ( pVarStorage != NULL ) &&
+            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            /* check if we have write permissions on this variable */
+            rc = varlist_CheckWritePermissions( pVarInfo, pVarID );
+            if ( rc == true )
+            {
+                pVarStorage->flags &= ~(pVarInfo->flags);
+                varlist_IndexStorage( pVarStorage, pVarID );
+                varlist_UpdateSetPlan( pVarStorage );
+                STANDBY_Changed();
+
+                if ( ( pVarInfo->flags & VARFLAG_HISTORY ) &&
+                     ( pVarStorage->pMeta->pHistory != NULL ) )
                 {
-                    ull = (uint64_t)(pVarInfo->var.val.ll);
-                    if ( pVarStorage->var.val.ull == ull )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ull = ull;
-                        result = EOK;
-                    }
+                    /* the recorded history is no longer kept */
+                    HISTORY_Delete( pVarStorage->pMeta->pHistory );
+                    pVarStorage->pMeta->pHistory = NULL;
                 }
-                break;
 
-            default:
-                result = ENOTSUP;
-                break;
+                /* get the storage reference identifier */
+                pVarInfo->storageRef = pVarStorage->storageRef;
+
+                result = EOK;
+            }
+            else
+            {
+                result = EACCES;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_ShareValue                                                        */
+/*!
+    Handle a SHARE_VALUE request from a client
+
+    The VARLIST_ShareValue function handles a SHARE_VALUE request from a
+    client.  It publishes the value of the specified variable in the
+    shared value segment so the client can read it directly.  Only
+    primitive (non-string, non-blob) variables which the client has
+    permission to read can be shared.  Password variables, calculated
+    variables, and variables which are modified outside of VARLIST_Set
+    are never shared.
+
+    The shared value segment can only be mapped by clients running
+    as the server user, which may read every variable.  Variables with
+    a read permission list are never shared, since the members of the
+    listed groups could not map the segment, and the segment does not
+    check which variables a client may read.
+
+    @param[in,out]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable to share
+
+    @retval EOK the variable value is available in the shared value segment
+    @retval ENOENT the variable does not exist
+    @retval ENOTSUP the variable cannot be shared
+    @retval EACCES the variable has a read permission list
+    @retval ENOMEM no more shared value slots are available
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_ShareValue( VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarStorage *pVarStorage = NULL;
+    VarID *pVarID;
+    VarType type;
+
+    if( pVarInfo != NULL )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            pVarStorage = pVarID->pVarStorage;
+        }
+
+        result = ENOENT;
+
+        if ( ( pVarStorage != NULL ) &&
+             ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            type = pVarStorage->var.type;
+
+            if ( pVarStorage->pMeta->permissions.nreads > 0 )
+            {
+                result = EACCES;
+            }
+            else if ( ( type == VARTYPE_STR ) ||
+                 ( type == VARTYPE_BLOB ) ||
+                 ( type == VARTYPE_INVALID ) ||
+                 ( pVarStorage->flags & VARFLAG_PASSWORD ) ||
+                 ( pVarStorage->notifyMask & NOTIFY_MASK_CALC ) ||
+                 ( pVarStorage->directAccess == true ) )
+            {
+                result = ENOTSUP;
+            }
+            else if ( pVarStorage->sharedSlot == 0 )
+            {
+                result = SHAREDVALUES_Alloc( pVarStorage->storageRef,
+                                             &pVarStorage->var,
+                                             &pVarStorage->sharedSlot );
+            }
+            else
+            {
+                result = EOK;
+            }
+
+            if ( result == EOK )
+            {
+                /* get the storage reference identifier */
+                pVarInfo->storageRef = pVarStorage->storageRef;
+
+                /* map the requested handle to the shared value */
+                result = SHAREDVALUES_Map( pVarID->hVar,
+                                           pVarStorage->sharedSlot );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_ShareBlob                                                         */
+/*!
+    Handle a SHARE_BLOB request from a client
+
+    The VARLIST_ShareBlob function handles a SHARE_BLOB request from a
+    client.  It moves the value of the specified blob variable out of
+    the server heap into its own zero-copy blob segment, which clients
+    can map to read and write the value in place.  Password variables,
+    and variables with a CALC or VALIDATE handler, are never shared
+    since their values must pass through the server.
+
+    @param[in,out]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the blob to share.  On return it contains the storage
+            reference which names the segment and the blob size.
+
+    @retval EOK the blob value is available in its zero-copy segment
+    @retval ENOENT the variable does not exist
+    @retval ENOTSUP the variable cannot be shared
+    @retval EACCES the client may not write to the variable
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_ShareBlob( VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarStorage *pVarStorage = NULL;
+    VarMeta *pMeta;
+    VarID *pVarID;
+    void *pBlob;
+
+    if( pVarInfo != NULL )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            pVarStorage = pVarID->pVarStorage;
+        }
+
+        result = ENOENT;
+
+        if ( ( pVarStorage != NULL ) &&
+             ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            pMeta = pVarStorage->pMeta;
+
+            if ( ( pVarStorage->var.type != VARTYPE_BLOB ) ||
+                 ( pVarStorage->var.len == 0 ) ||
+                 ( pVarStorage->flags & VARFLAG_PASSWORD ) ||
+                 ( pVarStorage->notifyMask &
+                    ( NOTIFY_MASK_CALC | NOTIFY_MASK_VALIDATE ) ) ||
+                 ( pVarStorage->directAccess == true ) )
+            {
+                result = ENOTSUP;
+            }
+            else if ( ( ( pVarStorage->flags & VARFLAG_READONLY ) == 0 ) &&
+                      ( varlist_CheckWritePermissions( pVarInfo,
+                                                        pVarID ) == false ) )
+            {
+                /* the segment is writable, so writers must be allowed */
+                result = EACCES;
+            }
+            else if ( pMeta->pSharedBlob == NULL )
+            {
+                pBlob = pVarStorage->var.val.blob;
+                result = SHAREDBLOBS_Create( pVarStorage->storageRef,
+                                             pVarStorage->var.len,
+                                             pBlob,
+                                             &pMeta->pSharedBlob );
+                if ( result == EOK )
+                {
+                    /* the segment now holds the value */
+                    pVarStorage->var.val.blob =
+                        SHAREDBLOBS_Value( pMeta->pSharedBlob );
+                    SLAB_FreeBuffer( pBlob, pVarStorage->var.len );
+                    STATS_MemFree( STATS_MEM_BLOBS, 1, pVarStorage->var.len );
+                }
+            }
+            else
+            {
+                result = EOK;
+            }
+
+            if ( result == EOK )
+            {
+                /* get the storage reference identifier */
+                pVarInfo->storageRef = pVarStorage->storageRef;
+                pVarInfo->var.type = VARTYPE_BLOB;
+                pVarInfo->var.len = pVarStorage->var.len;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_CommitBlob                                                        */
+/*!
+    Handle a COMMIT_BLOB request from a client
+
+    The VARLIST_CommitBlob function handles a COMMIT_BLOB request from
+    a client which has written a new blob value in place into the
+    zero-copy segment of the variable.  The written buffer becomes the
+    current value, and the change is then handled as for any other set.
+
+    @param[in]
+        clientPID
+            process identifier of the client which wrote the value
+
+    @param[in,out]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the blob and the length of the new value in var.len
+
+    @retval EOK the new value was committed
+    @retval ENOENT the variable does not exist
+    @retval ENOTSUP the variable does not have a zero-copy segment, or
+            has a VALIDATE handler
+    @retval EACCES the client may not write to the variable
+    @retval EPERM the client has not locked the segment for writing
+    @retval E2BIG the value is larger than the blob
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_CommitBlob( pid_t clientPID, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarStorage *pVarStorage = NULL;
+    SharedBlob *pSharedBlob = NULL;
+    VarID *pVarID = NULL;
+
+    if( pVarInfo != NULL )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            pVarStorage = pVarID->pVarStorage;
+        }
+
+        result = ENOENT;
+
+        if ( ( pVarStorage != NULL ) &&
+             ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            pSharedBlob = pVarStorage->pMeta->pSharedBlob;
+
+            if ( ( pVarStorage->flags & VARFLAG_READONLY ) ||
+                 ( varlist_CheckWritePermissions( pVarInfo,
+                                                  pVarID ) == false ) )
+            {
+                result = EACCES;
+            }
+            else if ( ( pSharedBlob == NULL ) ||
+                      ( pVarStorage->notifyMask & NOTIFY_MASK_VALIDATE ) )
+            {
+                /* a validator cannot see a value written in place */
+                result = ENOTSUP;
+            }
+            else
+            {
+                /* get the storage reference identifier */
+                pVarInfo->storageRef = pVarStorage->storageRef;
+
+                result = SHAREDBLOBS_Commit( pSharedBlob,
+                                             clientPID,
+                                             pVarInfo->var.len );
+                pVarStorage->var.val.blob = SHAREDBLOBS_Value( pSharedBlob );
+            }
+        }
+    }
+
+    if ( ( result != EOK ) &&
+         ( pSharedBlob != NULL ) )
+    {
+        /* discard the rejected value */
+        SharedBlobUnlock( pSharedBlob, clientPID );
+    }
+
+    if ( result == EOK )
+    {
+        /* record the change and notify the subscribers */
+        result = varlist_Changed( clientPID, pVarID, pVarInfo, result );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_BeginBatch                                                        */
+/*!
+    Start processing a batch request
+
+    The VARLIST_BeginBatch function is called before the items of a
+    GET_MANY or SET_MANY request are processed.  Until VARLIST_EndBatch
+    is called, change notifications are deferred, and variables which
+    would block the client on a CALC or VALIDATE handler are
+    rejected with EWOULDBLOCK.
+
+==============================================================================*/
+void VARLIST_BeginBatch( void )
+{
+    batchInProgress = true;
+    numBatchNotifications = 0;
+}
+
+/*============================================================================*/
+/*  VARLIST_EndBatch                                                          */
+/*!
+    Complete processing of a batch request
+
+    The VARLIST_EndBatch function is called after all of the items of a
+    batch request have been processed.  It sends the change notifications
+    which were deferred during the batch, once per modified variable.
+
+==============================================================================*/
+void VARLIST_EndBatch( void )
+{
+    size_t i;
+    BatchNotification *pBatchNotification;
+
+    batchInProgress = false;
+
+    for( i = 0; i < numBatchNotifications; i++ )
+    {
+        pBatchNotification = &batchNotifications[i];
+        varlist_SendNotifications( pBatchNotification->clientPID,
+                                   pBatchNotification->pVarStorage,
+                                   pBatchNotification->hVar );
+    }
+
+    numBatchNotifications = 0;
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  varlist_DeferNotifications                                                */
+/*!
+    Defer variable change notifications to the end of a batch
+
+    The varlist_DeferNotifications function records that the specified
+    variable has been modified during a batch request.  A variable which
+    is modified multiple times in the same batch is only recorded once.
+    If the deferred notification list is full, the notifications are
+    sent immediately.
+
+    @param[in]
+        clientPID
+            process identifier of the requesting client
+
+    @param[in]
+        pVarStorage
+            pointer to the variable storage for the variable notification
+
+    @param[in]
+        hVar
+            handle to the variable that has been modified
+
+    @retval EOK the notifications were deferred (or sent)
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int varlist_DeferNotifications( pid_t clientPID,
+                                       VarStorage *pVarStorage,
+                                       VAR_HANDLE hVar )
+{
+    int result = EINVAL;
+    BatchNotification *pBatchNotification;
+    size_t i;
+
+    if ( pVarStorage != NULL )
+    {
+        result = EOK;
+
+        for( i = 0; i < numBatchNotifications; i++ )
+        {
+            pBatchNotification = &batchNotifications[i];
+            if( ( pBatchNotification->pVarStorage == pVarStorage ) &&
+                ( pBatchNotification->hVar == hVar ) )
+            {
+                /* already deferred */
+                break;
+            }
+        }
+
+        if( i == numBatchNotifications )
+        {
+            if( numBatchNotifications < VARLIST_MAX_BATCH_NOTIFICATIONS )
+            {
+                pBatchNotification = &batchNotifications[numBatchNotifications];
+                pBatchNotification->clientPID = clientPID;
+                pBatchNotification->pVarStorage = pVarStorage;
+                pBatchNotification->hVar = hVar;
+                numBatchNotifications++;
+            }
+            else
+            {
+                /* no room to defer the notifications */
+                batchInProgress = false;
+                result = varlist_SendNotifications( clientPID,
+                                                    pVarStorage,
+                                                    hVar );
+                batchInProgress = true;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_SendNotifications                                                 */
+/*!
+    Send out requested client notifications
+
+    The varlist_SendNotifications function sends out requested client
+    notifications of type modified, modified_queued, and modified_ring.
+
+    @param[in]
+        clientPID
+            process identifier of the requesting client
+
+    @param[in]
+        pVarStorage
+            pointer to the variable storage for the variable notification
+
+    @param[in]
+        hVar
+            handle to the variable that has been modified
+
+    @retval EOK the notifications were sent
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int varlist_SendNotifications( pid_t clientPID,
+                                      VarStorage *pVarStorage,
+                                      VAR_HANDLE hVar )
+{
+    int result = EINVAL;
+    void *payload = NULL;
+    size_t n = 0;
+    uint64_t due = 0;
+    uint64_t queueDue = 0;
+
+    if ( ( pVarStorage != NULL ) &&
+         ( batchInProgress == true ) )
+    {
+        /* notifications are sent at the end of the batch */
+        result = varlist_DeferNotifications( clientPID, pVarStorage, hVar );
+    }
+    else if ( pVarStorage != NULL )
+    {
+        result = EOK;
+
+        if ( pQuerySubscriptions != NULL )
+        {
+            /* signal the query subscribers */
+            varlist_QueryNotify( pVarStorage, hVar );
+        }
+
+        /* signal variable modified */
+        if ( pVarStorage->notifyMask & NOTIFY_MASK_MODIFIED )
+        {
+            NOTIFY_Modified( &pVarStorage->pMeta->notifications,
+                             &pVarStorage->var,
+                             false,
+                             &due );
+            if ( due != 0 )
+            {
+                /* send the rate limited notifications later */
+                varlist_RateLimit( pVarStorage, due );
+            }
+        }
+
+        if ( pVarStorage->notifyMask & ( NOTIFY_MASK_MODIFIED_QUEUE |
+                                         NOTIFY_MASK_MODIFIED_RING ) )
+        {
+            /* prepare the notification payload */
+            payload = varlist_GetNotificationPayload( hVar,
+                                                      pVarStorage,
+                                                      &n );
+        }
+
+        if ( ( pVarStorage->notifyMask & NOTIFY_MASK_MODIFIED_RING ) &&
+             ( payload != NULL ) )
+        {
+            /* publish the payload once for all change ring subscribers */
+            CHANGERING_Write( pVarStorage->storageRef, payload, n );
+        }
+
+        if ( pVarStorage->notifyMask & NOTIFY_MASK_MODIFIED_QUEUE )
+        {
+            /* send the notification payloads */
+            NOTIFY_Payload( &pVarStorage->pMeta->notifications,
+                            payload,
+                            n,
+                            false,
+                            &queueDue );
+            if ( queueDue != 0 )
+            {
+                /* retry the changes coalesced by full message queues */
+                varlist_RateLimit( pVarStorage, queueDue );
+            }
+
+            /* send notification signals to the clients */
+            NOTIFY_Signal( clientPID,
+                            &pVarStorage->pMeta->notifications,
+                            NOTIFY_MODIFIED_QUEUE,
+                            hVar,
+                            NULL );
+        }
+
+        /* subscribers which have gone away are compacted out of the
+           notification lists, so keep the notification mask in sync */
+        varlist_SyncNotifyMask( pVarStorage );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_RateLimit                                                         */
+/*!
+    Schedule the rate limited notifications of a variable
+
+    The varlist_RateLimit function adds the variable to the list of
+    variables with rate limited NOTIFY_MODIFIED notifications waiting
+    to be sent, and records when they are due.
+
+    @param[in]
+        pVarStorage
+            pointer to the variable storage with deferred notifications
+
+    @param[in]
+        due
+            time the deferred notifications are due (CLOCK_MONOTONIC ns)
+
+    @retval EOK the notifications were scheduled
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int varlist_RateLimit( VarStorage *pVarStorage, uint64_t due )
+{
+    int result = EOK;
+    VarStorage **p;
+    size_t n;
+
+    if ( pVarStorage->modifiedDue == 0 )
+    {
+        if ( numRateLimited == maxRateLimited )
+        {
+            n = ( maxRateLimited == 0 ) ? 16 : maxRateLimited * 2;
+            p = realloc( pRateLimited, n * sizeof( VarStorage * ) );
+            if ( p != NULL )
+            {
+                pRateLimited = p;
+                maxRateLimited = n;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            pRateLimited[numRateLimited++] = pVarStorage;
+            pVarStorage->modifiedDue = due;
+        }
+    }
+    else if ( due < pVarStorage->modifiedDue )
+    {
+        pVarStorage->modifiedDue = due;
+    }
+
+    if ( ( result == EOK ) &&
+         ( ( rateLimitedDue == 0 ) || ( due < rateLimitedDue ) ) )
+    {
+        rateLimitedDue = due;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_SendRateLimited                                                   */
+/*!
+    Send the rate limited notifications which are due
+
+    The VARLIST_SendRateLimited function sends the deferred NOTIFY_MODIFIED
+    notifications of each rate limited variable whose notifications are
+    due, and removes variables which have no more deferred notifications
+    from the list.
+
+    @retval time the next rate limited notification is due
+            (CLOCK_MONOTONIC ns), or 0 if there are none
+
+==============================================================================*/
+uint64_t VARLIST_SendRateLimited( void )
+{
+    uint64_t now = NOTIFY_Now();
+    VarStorage *pVarStorage;
+    uint64_t due;
+    uint64_t queueDue = 0;
+    void *payload;
+    size_t n;
+    size_t i = 0;
+
+    rateLimitedDue = 0;
+
+    while ( i < numRateLimited )
+    {
+        pVarStorage = pRateLimited[i];
+        if ( pVarStorage->modifiedDue <= now )
+        {
+            NOTIFY_Modified( &pVarStorage->pMeta->notifications,
+                             &pVarStorage->var,
+                             true,
+                             &due );
+
+            if ( pVarStorage->notifyMask & NOTIFY_MASK_MODIFIED_QUEUE )
+            {
+                /* retry the changes coalesced by full message queues,
+                   sending the current value of the variable */
+                payload = varlist_GetNotificationPayload( VAR_INVALID,
+                                                          pVarStorage,
+                                                          &n );
+                if ( ( payload != NULL ) &&
+                     ( NOTIFY_Payload( &pVarStorage->pMeta->notifications,
+                                       payload,
+                                       n,
+                                       true,
+                                       &queueDue ) == EOK ) )
+                {
+                    NOTIFY_Signal( 0,
+                                   &pVarStorage->pMeta->notifications,
+                                   NOTIFY_MODIFIED_QUEUE,
+                                   VAR_INVALID,
+                                   NULL );
+                }
+
+                if ( ( queueDue != 0 ) &&
+                     ( ( due == 0 ) || ( queueDue < due ) ) )
+                {
+                    due = queueDue;
+                }
+            }
+
+            varlist_SyncNotifyMask( pVarStorage );
+            pVarStorage->modifiedDue = due;
+        }
+
+        if ( pVarStorage->modifiedDue == 0 )
+        {
+            /* nothing left to send for this variable */
+            pRateLimited[i] = pRateLimited[--numRateLimited];
+        }
+        else
+        {
+            if ( ( rateLimitedDue == 0 ) ||
+                 ( pVarStorage->modifiedDue < rateLimitedDue ) )
+            {
+                rateLimitedDue = pVarStorage->modifiedDue;
+            }
+
+            i++;
+        }
+    }
+
+    return rateLimitedDue;
+}
+
+/*============================================================================*/
+/*  VARLIST_RateLimitedDue                                                    */
+/*!
+    Get the time the next rate limited notification is due
+
+    @retval time the next rate limited notification is due
+            (CLOCK_MONOTONIC ns), or 0 if there are none
+
+==============================================================================*/
+uint64_t VARLIST_RateLimitedDue( void )
+{
+    return rateLimitedDue;
+}
+
+/*============================================================================*/
+/*  VARLIST_SetCalcMetrics                                                    */
+/*!
+    Set the pointers to the CALC handler metrics
+
+    The VARLIST_SetCalcMetrics function sets the pointers to the counters
+    of gets which were answered from a cached calculated value, and of
+    gets which joined a calculation already in progress.  Neither of
+    these gets signals the CALC handler.
+
+    @param[in]
+        pCacheHits
+            pointer to the cached calculated value counter
+
+    @param[in]
+        pCoalesced
+            pointer to the joined calculation counter
+
+==============================================================================*/
+void VARLIST_SetCalcMetrics( uint64_t *pCacheHits, uint64_t *pCoalesced )
+{
+    pCalcCacheHitsMetric = pCacheHits;
+    pCalcCoalescedMetric = pCoalesced;
+}
+
+/*============================================================================*/
+/*  varlist_SyncNotifyMask                                                    */
+/*!
+    Update the notification mask from the notification lists
+
+    The varlist_SyncNotifyMask function re-derives the notification type
+    bits of the variable's notification mask from its notification lists.
+    The blocked client bits are not affected.
+
+    @param[in]
+        pVarStorage
+            pointer to the variable storage to update
+
+==============================================================================*/
+static void varlist_SyncNotifyMask( VarStorage *pVarStorage )
+{
+    pVarStorage->notifyMask =
+        ( pVarStorage->notifyMask & ~NOTIFY_MASK_TYPES ) |
+        NOTIFY_GetMask( &pVarStorage->pMeta->notifications );
+
+    varlist_UpdateSetPlan( pVarStorage );
+}
+
+/*============================================================================*/
+/*  varlist_RequestValidation                                                 */
+/*!
+    Ask the validator of a variable to validate a change
+
+    The varlist_RequestValidation function creates a validation
+    transaction for the proposed change, queues it for the validator,
+    and signals the validator with the transaction identifier.
+    Validators using batched validation are only signalled when their
+    queue of unfetched validation requests becomes non-empty.
+
+    @param[in]
+        clientPID
+            process identifier of the client setting the variable
+
+    @param[in]
+        pVarStorage
+            Pointer to the variable storage
+
+    @param[in]
+        validator
+            process identifier of the validator
+
+    @param[in]
+        clientInfo
+            opaque pointer to the client information
+
+    @retval EINPROGRESS the change is waiting for the validator
+    @retval ESRCH the validator is gone
+    @retval other the validation could not be requested
+
+==============================================================================*/
+static int varlist_RequestValidation( pid_t clientPID,
+                                      VarStorage *pVarStorage,
+                                      pid_t validator,
+                                      void *clientInfo )
+{
+    int result;
+    NotificationList *pList = &pVarStorage->pMeta->notifications;
+    VAR_HANDLE hTransactionVar;
+    uint32_t validateHandle;
+    bool signal = true;
+    int item;
+
+    /* get the handle associated with the VALIDATE notification */
+    hTransactionVar = NOTIFY_GetVarHandle( pList, NOTIFY_VALIDATE );
+
+    /* create a validation transaction */
+    result = TRANSACTION_New( clientPID,
+                              clientInfo,
+                              hTransactionVar,
+                              &validateHandle );
+    if( result == EOK )
+    {
+        result = VALIDATE_Queue( validator, validateHandle, &signal );
+        if( ( result == EOK ) &&
+            ( signal == true ) )
+        {
+            /* send a notification to the validation client with the
+               identifier of the validation request */
+            result = NOTIFY_Signal( clientPID,
+                                    pList,
+                                    NOTIFY_VALIDATE,
+                                    validateHandle,
+                                    NULL );
+        }
+
+        if( result == EOK )
+        {
+            result = EINPROGRESS;
+        }
+        else
+        {
+            /* discard the validation request */
+            VALIDATE_Complete( validateHandle, &item );
+            TRANSACTION_Remove( validateHandle );
+
+            if( result == ESRCH )
+            {
+                /* the validation client is gone, so clear the
+                   notification mask */
+                pVarStorage->notifyMask &= ~NOTIFY_MASK_VALIDATE;
+                varlist_UpdateSetPlan( pVarStorage );
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_HandleTrigger                                                     */
+/*!
+    Check for and handle modification for a trigger variable
+
+    The varlist_HandleTrigger function checks to see if the variable
+    which is being set is a trigger variable.  If it is, and notifications,
+    are requested for this variable, then the notification will be sent out.
+
+
+    @param[in]
+        pVarStorage
+            Pointer to the variable storage
+
+==============================================================================*/
+static int varlist_HandleTrigger( pid_t clientPID,
+                                  VarStorage *pVarStorage,
+                                  VAR_HANDLE hVar )
+{
+    int result = EINVAL;
+
+    if ( pVarStorage != NULL )
+    {
+        if (  pVarStorage->flags & VARFLAG_TRIGGER )
+        {
+            /* send out notifications */
+            result = varlist_SendNotifications( clientPID,
+                                                pVarStorage,
+                                                hVar );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_SetDirty                                                          */
+/*!
+    Set the variable's dirty bit
+
+    The varlist_SetDirty function sets the dirty bit for the variable
+    if it is a non-volatile variable.  The dirty bit is used to identify
+    variables that have been modified after startup.
+
+    @param[in]
+        pVarID
+            Pointer to the variable identifier
+
+==============================================================================*/
+static void varlist_SetDirty( VarID *pVarID )
+{
+    VarStorage *pVarStorage;
+
+    if ( ( pVarID != NULL ) &&
+         ( pVarID->pVarStorage != NULL ) )
+    {
+        pVarStorage = pVarID->pVarStorage;
+
+        if (  pVarStorage->flags & ( VARFLAG_VOLATILE | VARFLAG_DIRTY ) )
+        {
+            /* do nothing for volatile or already dirty variables */
+        }
+        else
+        {
+            /* set the dirty bit for non-volatile variables */
+            pVarStorage->flags |= VARFLAG_DIRTY;
+            varlist_IndexStorage( pVarStorage, pVarID );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  varlist_IndexStorage                                                      */
+/*!
+    Update the flag index for a variable's storage
+
+    The varlist_IndexStorage function updates the flag index and the
+    query subscriptions for every variable handle which refers to the
+    specified variable storage, ie the variable itself and all of its
+    aliases.
+
+    @param[in]
+        pVarStorage
+            Pointer to the variable storage whose flags have changed
+
+    @param[in]
+        pVarID
+            Pointer to the variable identifier, used if the
+            variable has no aliases.  May be NULL.
+
+    @retval EOK the flag index was updated
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int varlist_IndexStorage( VarStorage *pVarStorage, VarID *pVarID )
+{
+    int result = EINVAL;
+    VarAlias *pVarAlias;
+
+    if ( pVarStorage != NULL )
+    {
+        result = EOK;
+
+        pVarAlias = pVarStorage->pMeta->pAliases;
+        if ( pVarAlias == NULL )
+        {
+            if ( pVarID != NULL )
+            {
+                result = VARINDEX_SetFlags( pVarID->hVar, pVarStorage->flags );
+                varlist_QueryEvaluate( pVarID );
+            }
+        }
+
+        while ( pVarAlias != NULL )
+        {
+            if ( pVarAlias->pVarID != NULL )
+            {
+                result = VARINDEX_SetFlags( pVarAlias->pVarID->hVar,
+                                            pVarStorage->flags );
+                varlist_QueryEvaluate( pVarAlias->pVarID );
+            }
+
+            pVarAlias = pVarAlias->pNext;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_Calc                                                              */
+/*!
+    Function to be applied while unblocking CALC blocked clients
+
+    The varlist_Calc function copies the VarObject pointed by 'arg'
+    into the specified VarClient's VarObject.
+
+    Strings are copied directly into the client's working buffer
+
+    @param[in,out]
+        pVarClient
+            Pointer to the VarClient to receive the VarObject
+
+    @param[in]
+        arg
+            opaque pointer to the source VarInfo to copy
+
+    @retval EOK the variable was successfully copied
+    @retval EINVAL invalid arguments
+    @retval ENOENT no data available in the source VarObject
+    @retval E2BIG the string in the source VarObject will not fit in the
+            client's working buffer
+
+==============================================================================*/
+static int varlist_Calc( VarClient *pVarClient, void *arg )
+{
+    int result = EINVAL;
+    VarInfo *pVarInfo = (VarInfo *)arg;
+    VarType varType;
+    size_t len;
+    VarID *pVarID;
+    VarStorage *pVarStorage = NULL;
+
+    if( ( pVarClient != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            pVarStorage = pVarID->pVarStorage;
+        }
+
+        if ( pVarStorage != NULL )
+        {
+            /* get the storage reference identifier */
+            pVarInfo->storageRef = pVarStorage->storageRef;
+
+            /* copy the format specifier */
+            memcpy( pVarClient->variableInfo.formatspec,
+                    pVarStorage->pMeta->formatspec,
+                    MAX_FORMATSPEC_LEN );
+
+            /* copy the variable type from the varstore */
+            varType = pVarStorage->var.type;
+            pVarClient->variableInfo.var.type = varType;
+
+            /* copy the variable length from the varstore */
+            len = pVarStorage->var.len;
+            pVarClient->variableInfo.var.len = len;
+
+            if( varType == VARTYPE_STR )
+            {
+                result = varlist_CopyVarInfoStringToClient( pVarClient,
+                                                            pVarInfo );
+            }
+            else if ( varType == VARTYPE_BLOB )
+            {
+                result = varlist_CopyVarInfoBlobToClient( pVarClient,
+                                                          pVarInfo );
+            }
+            else
+            {
+                /* copy the source VarObject to the VarClient */
+                pVarClient->variableInfo.var.val = pVarInfo->var.val;
+
+                result = EOK;
+            }
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_CalcCached                                                        */
+/*!
+    Check if a variable holds a current calculated value
+
+    The varlist_CalcCached function checks if the value last supplied
+    by the CALC handler of the variable can be returned without asking
+    the handler to calculate it again.  A cached value is counted in the
+    CALC cache hits metric.
+
+    @param[in]
+        pVarStorage
+            pointer to the variable storage to check
+
+    @retval true the calculated value is within its cache TTL
+    @retval false the CALC handler must calculate a new value
+
+==============================================================================*/
+static bool varlist_CalcCached( VarStorage *pVarStorage )
+{
+    bool result = false;
+    uint64_t expiry = pVarStorage->pMeta->calcExpiry;
+
+    if( ( expiry != 0 ) &&
+        ( NOTIFY_Now() < expiry ) )
+    {
+        if( pCalcCacheHitsMetric != NULL )
+        {
+            /* gets may be answered concurrently by the request workers */
+            __atomic_add_fetch( pCalcCacheHitsMetric, 1, __ATOMIC_RELAXED );
+        }
+
+        result = true;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_RequestCalc                                                       */
+/*!
+    Ask the CALC handler of a variable for a new value
+
+    The varlist_RequestCalc function signals the CALC handler of the
+    variable to calculate a new value.  If clients are already blocked
+    waiting for a calculation, the requesting client joins them instead,
+    and they are all answered by the next value from the handler.
+
+    @param[in]
+        clientPID
+            process identifier of the requesting client
+
+    @param[in]
+        pVarStorage
+            pointer to the variable storage
+
+    @param[in]
+        hVar
+            handle of the variable being requested
+
+    @retval EINPROGRESS the client must wait for the calculation
+    @retval ESRCH the CALC handler has gone
+    @retval other error from NOTIFY_Signal
+
+==============================================================================*/
+static int varlist_RequestCalc( pid_t clientPID,
+                                VarStorage *pVarStorage,
+                                VAR_HANDLE hVar )
+{
+    int result = EINVAL;
+
+    if( ( pVarStorage->notifyMask & NOTIFY_MASK_HAS_CALC_BLOCK ) &&
+        ( HasBlockedClients( pVarStorage->storageRef, NOTIFY_CALC ) ) )
+    {
+        /* a calculation is already in progress */
+        if( pCalcCoalescedMetric != NULL )
+        {
+            (*pCalcCoalescedMetric)++;
+        }
+
+        result = EINPROGRESS;
+    }
+    else
+    {
+        /* send a calc request to the "owner" of this variable */
+        result = NOTIFY_Signal( clientPID,
+                                &pVarStorage->pMeta->notifications,
+                                NOTIFY_CALC,
+                                hVar,
+                                NULL );
+        if( result == EOK )
+        {
+            /* indicate that there is now a CALC blocked
+            client on this variable */
+            pVarStorage->notifyMask |= NOTIFY_MASK_HAS_CALC_BLOCK;
+            varlist_UpdateSetPlan( pVarStorage );
+
+            /* an EINPROGRESS result will prevent the client
+            from being unblocked until this request is complete */
+            result = EINPROGRESS;
+        }
+        else if( result == ESRCH )
+        {
+            /* the CALC handler has died so remove the CALC flag */
+            pVarStorage->notifyMask &= ~NOTIFY_MASK_CALC;
+            varlist_UpdateSetPlan( pVarStorage );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_CopyVarInfoBlobToClient                                           */
+/*!
+    Copy a VarInfo blob into the client's working buffer
+
+    The varlist_CopyVarInfoBlobToClient function copies the VarInfo object
+    pointed to by the pVarInfo argument into the working buffer of the
+    client pointed to by pVarClient
+
+    Blobs are copied directly into the client's working buffer
+
+    @param[in,out]
+        pVarClient
+            Pointer to the VarClient containing the working buffer to receive
+            the blob data
+
+    @param[in]
+        pVarInfo
+            pointer to the VarInfo object containing the blob to copy
+
+    @retval EOK the blob was successfully copied
+    @retval EINVAL invalid arguments
+    @retval ENOENT no blob data contained in the source VarInfo object
+    @retval E2BIG the blob in the source VarObject will not fit in the
+            client's working buffer
+
+==============================================================================*/
+static int varlist_CopyVarInfoBlobToClient( VarClient *pVarClient,
+                                            VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    size_t destlen;
+
+    if ( ( pVarClient != NULL ) &&
+         ( pVarInfo != NULL ) )
+    {
+        /* get the destination blob size */
+        destlen = pVarClient->variableInfo.var.len;
+
+        /* check that the blob will fit */
+        if( ( pVarInfo->var.len <= destlen ) &&
+            ( destlen <= pVarClient->workbufsize ) )
+        {
+            if( pVarInfo->var.val.blob != NULL )
+            {
+                /* copy the blob value into the client's working buffer */
+                memcpy( &pVarClient->workbuf,
+                        pVarInfo->var.val.blob,
+                        pVarInfo->var.len );
+
+                result = EOK;
+            }
+            else
+            {
+                /* no source blob to copy */
+                result = ENOENT;
+            }
+        }
+        else
+        {
+            /* source blob is too big to fit in the client's buffer */
+            result = E2BIG;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_CopyVarInfoStringToClient                                         */
+/*!
+    Copy a VarInfo string into the client's working buffer
+
+    The varlist_CopyVarInfoStringToClient function copies the VarInfo object
+    pointed to by the pVarInfo argument into the working buffer of the
+    client pointed to by pVarClient
+
+    Strings are copied directly into the client's working buffer
+
+    @param[in,out]
+        pVarClient
+            Pointer to the VarClient containing the working buffer to receive
+            the string data
+
+    @param[in]
+        pVarInfo
+            pointer to the VarInfo object containing the string to copy
+
+    @retval EOK the string was successfully copied
+    @retval EINVAL invalid arguments
+    @retval ENOENT no string data contained in the source VarInfo object
+    @retval E2BIG the string in the source VarObject will not fit in the
+            client's working buffer
+
+==============================================================================*/
+static int varlist_CopyVarInfoStringToClient( VarClient *pVarClient,
+                                              VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    size_t destlen;
+
+    if ( ( pVarClient != NULL ) &&
+         ( pVarInfo != NULL ) )
+    {
+        /* get the destination blob size */
+        destlen = pVarClient->variableInfo.var.len;
+
+        /* check that the blob will fit */
+        if( ( pVarInfo->var.len <= destlen ) &&
+            ( destlen <= pVarClient->workbufsize ) )
+        {
+            if( pVarInfo->var.val.str != NULL )
+            {
+                /* copy the variable value into the client's working buffer */
+                strcpy( &pVarClient->workbuf, pVarInfo->var.val.str );
+
+                result = EOK;
+
+            }
+            else
+            {
+                /* no source string to copy */
+                result = ENOENT;
+            }
+        }
+        else
+        {
+            /* source string is too big to fit in the client's buffer */
+            result = E2BIG;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_Set16                                                             */
+/*!
+    Store a value into a VARTYPE_UINT16 variable
+
+    The varlist_Set16 function stores a value into a VARTYPE_UINT16 variable.
+    The function will convert the source type if possible.
+
+    @param[in]
+        pVarStorage
+            pointer to the storage object for the target variable
+
+    @param[in]
+        pVarInfo
+            pointer to the variable info object containing the value to set
+
+    @retval EOK the variable was successfully set
+    @retval ENOTSUP the source variable is not supported for this operation
+    @retval ERANGE the source variable is outside of the range that can be
+                   supported by the target variable
+    @retval EINVAL invalid arguments
+    @retval EALREADY the value is already set to the requested value
+
+==============================================================================*/
+static int varlist_Set16( VarStorage *pVarStorage, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarType srctype;
+    uint16_t ui;
+
+    if( ( pVarStorage != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        srctype = pVarInfo->var.type;
+        switch( srctype )
+        {
+            case VARTYPE_INT16:
+                if ( pVarInfo->var.val.i < 0 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    ui = (uint16_t)(pVarInfo->var.val.i);
+                    if ( pVarStorage->var.val.ui == ui )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ui = ui;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_UINT16:
+                if ( pVarStorage->var.val.ui == pVarInfo->var.val.ui )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ui = pVarInfo->var.val.ui;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_INT32:
+                if ( ( pVarInfo->var.val.l > 65535 ) ||
+                     ( pVarInfo->var.val.l < 0 ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    /* store int32_t sources into uint16_t target */
+                    ui = (uint16_t)(pVarInfo->var.val.l);
+
+                    if ( ui == pVarStorage->var.val.ui )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ui = ui;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_UINT32:
+                if( pVarInfo->var.val.ul > 65535 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    /* store uint32_t source into uint16_t target */
+                    ui = (uint16_t)(pVarInfo->var.val.ul);
+
+                    if ( ui == pVarStorage->var.val.ui )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ui = ui;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_UINT64:
+                if( pVarInfo->var.val.ull > 65535 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    /* store uint64_t source into uint16_t target */
+                    ui = (uint16_t)(pVarInfo->var.val.ull);
+
+                    if ( ui == pVarStorage->var.val.ui )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ui = ui;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_INT64:
+                if ( ( pVarInfo->var.val.ll > 65535 ) ||
+                     ( pVarInfo->var.val.ll < 0 ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    /* store int64_t source into uint16_t target */
+                    ui = (uint16_t)(pVarInfo->var.val.ll);
+
+                    if ( ui == pVarStorage->var.val.ui )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ui = ui;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            default:
+                /* conversion not supported */
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_Set16s                                                            */
+/*!
+    Store a value into a VARTYPE_INT16 variable
+
+    The varlist_Set16s function stores a value into a VARTYPE_INT16 variable.
+    The function will convert the source type if possible.
+
+    @param[in]
+        pVarStorage
+            pointer to the storage object for the target variable
+
+    @param[in]
+        pVarInfo
+            pointer to the variable info object containing the value to set
+
+    @retval EOK the variable was successfully set
+    @retval ENOTSUP the source variable is not supported for this operation
+    @retval ERANGE the source variable is outside of the range that can be
+                   supported by the target variable
+    @retval EINVAL invalid arguments
+    @retval EALREADY the value is already set to the requested value
+
+==============================================================================*/
+static int varlist_Set16s( VarStorage *pVarStorage, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarType srctype;
+    int16_t i;
+
+    if( ( pVarStorage != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        srctype = pVarInfo->var.type;
+        switch( srctype )
+        {
+            case VARTYPE_INT16:
+                if ( pVarStorage->var.val.i == pVarInfo->var.val.i )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.i = pVarInfo->var.val.i;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_UINT16:
+                if ( pVarInfo->var.val.ui > 32767 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    /* store uint16_t source into int16_t target */
+                    i = (int16_t)(pVarInfo->var.val.ui);
+                    if ( i == pVarStorage->var.val.i )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.i = i;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_INT32:
+                if( ( pVarInfo->var.val.l > 32767 ) ||
+                    ( pVarInfo->var.val.l < -32768 ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    /* store int32_t source into int16_t target */
+                    i = (int16_t)(pVarInfo->var.val.l);
+
+                    if ( i == pVarStorage->var.val.i )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.i = i;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_UINT32:
+                if( pVarInfo->var.val.ul > 32767 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    /* store uint32_t source into int16_t target */
+                    i = (int16_t)(pVarInfo->var.val.ul);
+
+                    if ( i == pVarStorage->var.val.i )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.i = i;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_INT64:
+                if( ( pVarInfo->var.val.ll > 32767 ) ||
+                    ( pVarInfo->var.val.ll < -32768 ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    /* store int64_t source into int16_t target */
+                    i = (int16_t)(pVarInfo->var.val.ll);
+
+                    if ( i == pVarStorage->var.val.i )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.i = i;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_UINT64:
+                if( pVarInfo->var.val.ull > 32767 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    /* store uint64_t source into int16_t target */
+                    i = (int16_t)(pVarInfo->var.val.ull);
+
+                    if ( i == pVarStorage->var.val.i )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.i = i;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            default:
+                /* conversion not supported */
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_Set32                                                             */
+/*!
+    Store a value into a VARTYPE_UINT32 variable
+
+    The varlist_Set32 function stores a value into a VARTYPE_UINT32 variable.
+    The function will convert the source type if possible.
+
+    @param[in]
+        pVarStorage
+            pointer to the storage object for the target variable
+
+    @param[in]
+        pVarInfo
+            pointer to the variable info object containing the value to set
+
+    @retval EOK the variable was successfully set
+    @retval ENOTSUP the source variable is not supported for this operation
+    @retval EINVAL invalid arguments
+    @retval EALREADY the value is already set to the requested value
+
+==============================================================================*/
+static int varlist_Set32( VarStorage *pVarStorage, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarType srctype;
+    uint32_t ul;
+
+    if( ( pVarStorage != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        srctype = pVarInfo->var.type;
+        switch( srctype )
+        {
+            case VARTYPE_UINT32:
+                if( pVarStorage->var.val.ul == pVarInfo->var.val.ul )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ul = pVarInfo->var.val.ul;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_INT32:
+                if ( pVarInfo->var.val.l < 0 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    ul = (uint32_t)(pVarInfo->var.val.l);
+                    if( pVarStorage->var.val.ul == ul )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ul = ul;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_INT16:
+                if ( pVarInfo->var.val.i < 0 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    ul = pVarInfo->var.val.ui;
+                    if ( ul == pVarStorage->var.val.ul )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ul = ul;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_UINT16:
+                ul = pVarInfo->var.val.ui;
+                if ( ul == pVarStorage->var.val.ul )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ul = ul;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_UINT64:
+                if ( pVarInfo->var.val.ull > 4294967295 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    ul = (uint32_t)(pVarInfo->var.val.ull);
+                    if ( pVarStorage->var.val.ul == ul )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ul = ul;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_INT64:
+                if ( ( pVarInfo->var.val.ll > 4294967295 ) ||
+                     ( pVarInfo->var.val.ll < 0 ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    ul = (uint32_t)(pVarInfo->var.val.ll);
+                    if ( pVarStorage->var.val.ul == ul )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ul = ul;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_Set32s                                                            */
+/*!
+    Store a value into a VARTYPE_INT32 variable
+
+    The varlist_Set32s function stores a value into a VARTYPE_INT32 variable.
+    The function will convert the source type if possible.
+
+    @param[in]
+        pVarStorage
+            pointer to the storage object for the target variable
+
+    @param[in]
+        pVarInfo
+            pointer to the variable info object containing the value to set
+
+    @retval EOK the variable was successfully set
+    @retval ENOTSUP the source variable is not supported for this operation
+    @retval EINVAL invalid arguments
+    @retval EALREADY the value is already set to the requested value
+
+==============================================================================*/
+static int varlist_Set32s( VarStorage *pVarStorage, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarType srctype;
+    int32_t l;
+
+    if( ( pVarStorage != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        srctype = pVarInfo->var.type;
+        switch( srctype )
+        {
+            case VARTYPE_UINT32:
+                if ( pVarInfo->var.val.ul > 2147483647 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    l = (int32_t)(pVarInfo->var.val.ul);
+                    if( pVarStorage->var.val.l == l )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.l = l;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_INT32:
+                if ( pVarStorage->var.val.l == pVarInfo->var.val.l )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.l = pVarInfo->var.val.l;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_INT16:
+                l = (int32_t)(pVarInfo->var.val.i);
+                if ( pVarStorage->var.val.l == l )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.l = l;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_UINT16:
+                l = (int32_t)(pVarInfo->var.val.ui);
+                if ( pVarStorage->var.val.l == l )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.l = l;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_UINT64:
+                if ( pVarInfo->var.val.ull > 2147483647 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    l = (int32_t)(pVarInfo->var.val.ull);
+                    if ( pVarStorage->var.val.l == l )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.l = l;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_INT64:
+                if ( ( pVarInfo->var.val.ll > 2147483647 ) ||
+                     ( pVarInfo->var.val.ll < -2147483648 ) )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    l = (int32_t)(pVarInfo->var.val.ll);
+                    if ( pVarStorage->var.val.l == l )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.l = l;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_Set64                                                             */
+/*!
+    Store a value into a VARTYPE_UINT64 variable
+
+    The varlist_Set64 function stores a value into a VARTYPE_UINT64 variable.
+    The function will convert the source type if possible.
+
+    @param[in]
+        pVarStorage
+            pointer to the storage object for the target variable
+
+    @param[in]
+        pVarInfo
+            pointer to the variable info object containing the value to set
+
+    @retval EOK the variable was successfully set
+    @retval ENOTSUP the source variable is not supported for this operation
+    @retval EINVAL invalid arguments
+    @retval EALREADY the value is already set to the requested value
+
+==============================================================================*/
+static int varlist_Set64( VarStorage *pVarStorage, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarType srctype;
+    uint64_t ull;
+
+    if( ( pVarStorage != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        srctype = pVarInfo->var.type;
+        switch( srctype )
+        {
+            case VARTYPE_UINT32:
+                ull = (uint64_t)(pVarInfo->var.val.ul);
+                if( pVarStorage->var.val.ull == ull )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ull = ull;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_INT32:
+                if ( pVarInfo->var.val.l < 0 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    ull = (uint64_t)(pVarInfo->var.val.l);
+                    if( pVarStorage->var.val.ull == ull )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ull = ull;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_INT16:
+                if ( pVarInfo->var.val.i < 0 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    ull = (uint64_t)(pVarInfo->var.val.i);
+                    if ( ull == pVarStorage->var.val.ull )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ull = ull;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_UINT16:
+                ull = (uint64_t)(pVarInfo->var.val.ui);
+                if ( ull == pVarStorage->var.val.ull )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ull = ull;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_UINT64:
+                if ( pVarInfo->var.val.ull == pVarStorage->var.val.ull )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ull = pVarInfo->var.val.ull;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_INT64:
+                if ( pVarInfo->var.val.ll < 0 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    ull = (uint64_t)(pVarInfo->var.val.ll);
+                    if ( pVarStorage->var.val.ull == ull )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ull = ull;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_Set64s                                                            */
+/*!
+    Store a value into a VARTYPE_INT64 variable
+
+    The varlist_Set64s function stores a value into a VARTYPE_UINT64 variable.
+    The function will convert the source type if possible.
+
+    @param[in]
+        pVarStorage
+            pointer to the storage object for the target variable
+
+    @param[in]
+        pVarInfo
+            pointer to the variable info object containing the value to set
+
+    @retval EOK the variable was successfully set
+    @retval ENOTSUP the source variable is not supported for this operation
+    @retval EINVAL invalid arguments
+    @retval EALREADY the value is already set to the requested value
+
+==============================================================================*/
+static int varlist_Set64s( VarStorage *pVarStorage, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarType srctype;
+    int64_t ll;
+
+    if( ( pVarStorage != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        srctype = pVarInfo->var.type;
+        switch( srctype )
+        {
+            case VARTYPE_UINT32:
+                ll = (int64_t)(pVarInfo->var.val.ul);
+                if( pVarStorage->var.val.ll == ll )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ll = ll;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_INT32:
+                ll = (int64_t)(pVarInfo->var.val.l);
+                if( pVarStorage->var.val.ll == ll )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ll = ll;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_INT16:
+                ll = (int64_t)(pVarInfo->var.val.i);
+                if ( ll == pVarStorage->var.val.ll )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ll = ll;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_UINT16:
+                ll = (int64_t)(pVarInfo->var.val.ui);
+                if ( ll == pVarStorage->var.val.ll )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ll = ll;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_UINT64:
+                if ( pVarInfo->var.val.ull > 9223372036854775807 )
+                {
+                    result = ERANGE;
+                }
+                else
+                {
+                    ll = (int64_t)(pVarInfo->var.val.ull);
+                    if ( ll == (int64_t)(pVarStorage->var.val.ull) )
+                    {
+                        result = EALREADY;
+                    }
+                    else
+                    {
+                        pVarStorage->var.val.ll = ll;
+                        result = EOK;
+                    }
+                }
+                break;
+
+            case VARTYPE_INT64:
+                if ( pVarInfo->var.val.ll == pVarStorage->var.val.ll )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.ll = pVarInfo->var.val.ll;
+                    result = EOK;
+                }
+                break;
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_SetFloat                                                          */
+/*!
+    Store a value into a VARTYPE_FLOAT variable
+
+    The varlist_SetFloat function stores a value into a VARTYPE_FLOAT variable
+    The function will convert the source type if possible.
+
+    @param[in]
+        pVarStorage
+            pointer to the storage object for the target variable
+
+    @param[in]
+        pVarInfo
+            pointer to the variable info object containing the value to set
+
+    @retval EOK the variable was successfully set
+    @retval ENOTSUP the source variable is not supported for this operation
+    @retval EINVAL invalid arguments
+    @retval EALREADY the value is already set to the requested value
+
+==============================================================================*/
+static int varlist_SetFloat( VarStorage *pVarStorage, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarType srctype;
+    float f;
+
+    if( ( pVarStorage != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        srctype = pVarInfo->var.type;
+        switch( srctype )
+        {
+            case VARTYPE_INT32:
+                f = pVarInfo->var.val.l;
+                if ( pVarStorage->var.val.f == f )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.f = f;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_UINT32:
+                f = pVarInfo->var.val.ul;
+                if ( pVarStorage->var.val.f == f )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.f = f;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_INT16:
+                f = pVarInfo->var.val.i;
+                if ( pVarStorage->var.val.f == f )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.f = f;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_UINT16:
+                f = pVarInfo->var.val.ui;
+                if ( pVarStorage->var.val.f == f )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.f = f;
+                    result = EOK;
+                }
+                break;
+
+            case VARTYPE_FLOAT:
+                if ( pVarStorage->var.val.f == pVarInfo->var.val.f )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    pVarStorage->var.val.f = pVarInfo->var.val.f;
+                    result = EOK;
+                }
+                break;
+
+            default:
+                result = ENOTSUP;
+                break;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_SetStr                                                            */
+/*!
+    Store a value into a VARTYPE_STR variable
+
+    The varlist_SetStr function stores a value into a VARTYPE_STR variable
+    The function will convert the source type if possible.
+
+    @param[in]
+        pVarStorage
+            pointer to the storage object for the target variable
+
+    @param[in]
+        pVarInfo
+            pointer to the variable info object containing the value to set
+
+    @retval EOK the variable was successfully set
+    @retval ENOTSUP the source variable is not supported for this operation
+    @retval E2BIG not enough space to store the source variable
+    @retval EINVAL invalid arguments
+    @retval EALREADY the value is already set to the requested value
+
+==============================================================================*/
+static int varlist_SetStr( VarStorage *pVarStorage, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    size_t n;
+
+    if( ( pVarStorage != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        if( pVarInfo->var.type == VARTYPE_STR )
+        {
+            /* we have a string, check its length */
+            n = pVarInfo->var.len;
+            if( n <= pVarStorage->var.len )
+            {
+                if ( memcmp( pVarStorage->var.val.str,
+                            pVarInfo->var.val.str,
+                            n ) == 0 )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    /* copy the string and nul terminate */
+                    memcpy( pVarStorage->var.val.str,
+                            pVarInfo->var.val.str,
+                            n );
+                    pVarStorage->var.val.str[n] = '\0';
+
+                    /* string copied successfully */
+                    result = EOK;
+                }
+            }
+            else
+            {
+                /* the string doesn't fit */
+                result = E2BIG;
+            }
+        }
+        else
+        {
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_SetBlob                                                           */
+/*!
+    Store a value into a VARTYPE_BLOB variable
+
+    The varlist_SetBlob function stores a value into a VARTYPE_BLOB variable
+
+    @param[in]
+        pVarStorage
+            pointer to the storage object for the target variable
+
+    @param[in]
+        pVarInfo
+            pointer to the variable info object containing the value to set
+
+    @retval EOK the variable was successfully set
+    @retval ENOTSUP the source variable is not supported for this operation
+    @retval E2BIG not enough space to store the source variable
+    @retval EINVAL invalid arguments
+    @retval EALREADY the value is already set to the requested value
+    @retval EBUSY a client is writing to the zero-copy blob segment
+
+==============================================================================*/
+static int varlist_SetBlob( VarStorage *pVarStorage, VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    size_t n;
+
+    if( ( pVarStorage != NULL ) &&
+        ( pVarInfo != NULL ) )
+    {
+        if( pVarInfo->var.type == VARTYPE_BLOB )
+        {
+            /* we have a blob, check its length */
+            n = pVarInfo->var.len;
+            if( ( n <= pVarStorage->var.len ) &&
+                ( pVarStorage->pMeta->pSharedBlob != NULL ) )
+            {
+                /* store the blob in the zero-copy segment */
+                result = SHAREDBLOBS_Write( pVarStorage->pMeta->pSharedBlob,
+                                            pVarInfo->var.val.blob,
+                                            n );
+                pVarStorage->var.val.blob =
+                    SHAREDBLOBS_Value( pVarStorage->pMeta->pSharedBlob );
+            }
+            else if( n <= pVarStorage->var.len )
+            {
+                if ( memcmp( pVarStorage->var.val.blob,
+                            pVarInfo->var.val.blob,
+                            n ) == 0 )
+                {
+                    result = EALREADY;
+                }
+                else
+                {
+                    /* copy the blob */
+                    memcpy( pVarStorage->var.val.blob,
+                            pVarInfo->var.val.blob,
+                            n );
+
+                    /* blob copied successfully */
+                    result = EOK;
+                }
+            }
+            else
+            {
+                /* the blob doesn't fit */
+                result = E2BIG;
+            }
+        }
+        else
+        {
+            result = ENOTSUP;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_GetType                                                           */
+/*!
+    Handle a TYPE request from a client
+
+    The VARLIST_Type function handles a TYPE request from a client.
+    It retrieves the VarObject type for the specified variable
+
+    @param[in,out]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable to query
+
+    @retval EOK the variable was successfully set
+    @retval ENOENT the variable does not exist
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_GetType( VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarStorage *pVarStorage = NULL;
+    VarID *pVarID;
+
+    if( pVarInfo != NULL )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            /* get a pointer to the variable storage for this variable */
+            pVarStorage = pVarID->pVarStorage;
+        }
+
+        if( ( pVarStorage != NULL ) &&
+            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            /* retrieve the type */
+            pVarInfo->var.type = pVarStorage->var.type;
+
+            /* get the storage reference identifier */
+            pVarInfo->storageRef = pVarStorage->storageRef;
+
+            result = EOK;
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_GetName                                                           */
+/*!
+    Handle a NAME request from a client
+
+    The VARLIST_GetName function handles a NAME request from a client.
+    It retrieves the VarObject name for the specified variable
+
+    @param[in,out]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable to query
+
+    @retval EOK the variable was successfully set
+    @retval ENOENT the variable does not exist
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_GetName( VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarID *pVarID;
+
+    if( pVarInfo != NULL )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            if( ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+            {
+                /* retrieve the name */
+                strcpy( pVarInfo->name, pVarID->name );
+                result = EOK;
+            }
+            else
+            {
+                result = ENOENT;
+            }
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_GetLength                                                         */
+/*!
+    Handle a LENGTH request from a client
+
+    The VARLIST_GetLength function handles a LENGTH request from a client.
+    It retrieves the VarObject length for the specified variable
+
+    @param[in,out]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable to query
+
+    @retval EOK the variable was successfully set
+    @retval ENOENT the variable does not exist
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_GetLength( VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarStorage *pVarStorage = NULL;
+    VarID *pVarID;
+
+    if( pVarInfo != NULL )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            /* get a pointer to the variable storage for this variable */
+            pVarStorage = pVarID->pVarStorage;
+        }
+
+        if( ( pVarStorage != NULL ) &&
+            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            /* retrieve the type */
+            pVarInfo->var.len = pVarStorage->var.len;
+
+            /* get the storage reference identifier */
+            pVarInfo->storageRef = pVarStorage->storageRef;
+
+            result = EOK;
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_GetFlags                                                          */
+/*!
+    Handle a FLAGS request from a client
+
+    The VARLIST_GetFlags function handles a FLAGS request from a client.
+    It retrieves the flags for the specified variable
+
+    @param[in,out]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable to query
+
+    @retval EOK the variable was successfully set
+    @retval ENOENT the variable does not exist
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_GetFlags( VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarStorage *pVarStorage = NULL;
+    VarID *pVarID;
+
+    if( pVarInfo != NULL )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            /* get a pointer to the variable storage for this variable */
+            pVarStorage = pVarID->pVarStorage;
+        }
+
+        if( ( pVarStorage != NULL ) &&
+            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            /* retrieve the flags */
+            pVarInfo->flags = pVarStorage->flags;
+
+            /* get the storage reference identifier */
+            pVarInfo->storageRef = pVarStorage->storageRef;
+
+            result = EOK;
+        }
+        else
+        {
+            result = ENOENT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARLIST_GetInfo                                                           */
+/*!
+    Handle a variable information request from a client
+
+    The VARLIST_GetInfo function handles an INFO request from a client.
+    It retrieves the VarInfo data for the specified variable.  The
+    notificationType is set to NOTIFY_PRINT if the variable has a PRINT
+    handler.
+
+    @param[in,out]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable to query
+
+    @retval EOK the variable was successfully set
+    @retval ENOENT the variable does not exist
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int VARLIST_GetInfo( VarInfo *pVarInfo )
+{
+    int result = EINVAL;
+    VarStorage *pVarStorage = NULL;
+    VarID *pVarID;
+
+    if( pVarInfo != NULL )
+    {
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
+        {
+            /* get a pointer to the variable storage for this variable */
+            pVarStorage = pVarID->pVarStorage;
+        }
+
+        if( ( pVarStorage != NULL ) &&
+            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            /* retrieve the VarInfo object */
+            pVarInfo->storageRef = pVarStorage->storageRef;
+            pVarInfo->flags = pVarStorage->flags;
+            memcpy( pVarInfo->formatspec,
+                    pVarStorage->pMeta->formatspec,
+                    MAX_FORMATSPEC_LEN );
+
+            pVarInfo->guid = pVarID->guid;
+            pVarInfo->instanceID = pVarID->instanceID;
+            strcpy( pVarInfo->name, pVarID->name );
+            pVarInfo->permissions = pVarStorage->pMeta->permissions;
+
+            /* report a PRINT handler, which changes how the value
+               is rendered */
+            pVarInfo->notificationType =
+                ( pVarStorage->notifyMask & NOTIFY_MASK_PRINT ) ? NOTIFY_PRINT
+                                                                : NOTIFY_NONE;
+
+            TAGLIST_TagsToString( pVarStorage->pMeta->tags,
+                                  MAX_TAGS_LEN,
+                                  pVarInfo->tagspec,
+                                  MAX_TAGSPEC_LEN );
+            result = EOK;
+        }
+        else
+        {
+            result = ENOENT;
         }
     }
 
@@ -2979,233 +6550,147 @@ static int varlist_Set64( VarStorage *pVarStorage, VarInfo *pVarInfo )
 }
 
 /*============================================================================*/
-/*  varlist_Set64s                                                            */
+/*  VARLIST_GetAliases                                                        */
 /*!
-    Store a value into a VARTYPE_INT64 variable
+    Get a list of aliases for the specified variable
 
-    The varlist_Set64s function stores a value into a VARTYPE_UINT64 variable.
-    The function will convert the source type if possible.
+    The VARLIST_GetAliases function genreates a list of aliases
+    for the specified variable as a JSON list
+    eg. ["alias1","alias2",...,"aliasN"]
 
     @param[in]
-        pVarStorage
-            pointer to the storage object for the target variable
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable to query
+
+    @param[in,out]
+        aliases
+            pointer to the buffer to store the alias list
 
     @param[in]
-        pVarInfo
-            pointer to the variable info object containing the value to set
+        len
+            maximum length of the alias list
 
-    @retval EOK the variable was successfully set
-    @retval ENOTSUP the source variable is not supported for this operation
+    @retval EOK the alias list was successfully generated
+    @retval E2BIG the alias list does not fit in the buffer
+    @retval ENOENT there are no aliases
     @retval EINVAL invalid arguments
-    @retval EALREADY the value is already set to the requested value
 
 ==============================================================================*/
-static int varlist_Set64s( VarStorage *pVarStorage, VarInfo *pVarInfo )
+int VARLIST_GetAliases( VarInfo *pVarInfo, VAR_HANDLE *aliases, size_t len )
 {
     int result = EINVAL;
-    VarType srctype;
-    int64_t ll;
+    VarStorage *pVarStorage = NULL;
+    VarID *pVarID;
+    VarAlias *pVarAlias;
+    size_t count = 0;
 
-    if( ( pVarStorage != NULL ) &&
-        ( pVarInfo != NULL ) )
+    if ( ( pVarInfo != NULL ) &&
+         ( aliases != NULL ) &&
+         ( len > 0 ) )
     {
-        srctype = pVarInfo->var.type;
-        switch( srctype )
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
         {
-            case VARTYPE_UINT32:
-                ll = (int64_t)(pVarInfo->var.val.ul);
-                if( pVarStorage->var.val.ll == ll )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.ll = ll;
-                    result = EOK;
-                }
-                break;
-
-            case VARTYPE_INT32:
-                ll = (int64_t)(pVarInfo->var.val.l);
-                if( pVarStorage->var.val.ll == ll )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.ll = ll;
-                    result = EOK;
-                }
-                break;
+            /* get a pointer to the variable storage for this variable */
+            pVarStorage = pVarID->pVarStorage;
+        }
 
-            case VARTYPE_INT16:
-                ll = (int64_t)(pVarInfo->var.val.i);
-                if ( ll == pVarStorage->var.val.ll )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.ll = ll;
-                    result = EOK;
-                }
-                break;
+        if( ( pVarStorage != NULL ) &&
+            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            /* pointer to the list of aliases */
+            pVarAlias = pVarStorage->pMeta->pAliases;
 
-            case VARTYPE_UINT16:
-                ll = (int64_t)(pVarInfo->var.val.ui);
-                if ( ll == pVarStorage->var.val.ll )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.ll = ll;
-                    result = EOK;
-                }
-                break;
+            /* copy the aliases */
+            while( ( pVarAlias != NULL ) && ( count < len ) )
+            {
+                /* get a pointer to the variable id */
+                pVarID = pVarAlias->pVarID;
 
-            case VARTYPE_UINT64:
-                if ( pVarInfo->var.val.ull > 9223372036854775807 )
-                {
-                    result = ERANGE;
-                }
-                else
+                if ( ( pVarID != NULL ) &&
+                     ( pVarID->hVar != VAR_INVALID ) )
                 {
-                    ll = (int64_t)(pVarInfo->var.val.ull);
-                    if ( ll == (int64_t)(pVarStorage->var.val.ull) )
-                    {
-                        result = EALREADY;
-                    }
-                    else
-                    {
-                        pVarStorage->var.val.ll = ll;
-                        result = EOK;
-                    }
+                    /* store the alias */
+                    aliases[count++] = pVarID->hVar;
                 }
-                break;
 
-            case VARTYPE_INT64:
-                if ( pVarInfo->var.val.ll == pVarStorage->var.val.ll )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.ll = pVarInfo->var.val.ll;
-                    result = EOK;
-                }
-                break;
+                /* get the next alias */
+                pVarAlias = pVarAlias->pNext;
+            }
 
-            default:
-                result = ENOTSUP;
-                break;
+            if ( count == len )
+            {
+                result = E2BIG;
+            }
+            else
+            {
+                result = ( count > 0 ) ? EOK : ENOENT;
+            }
+        }
+        else
+        {
+            result = ENOENT;
         }
     }
 
     return result;
+
 }
 
 /*============================================================================*/
-/*  varlist_SetFloat                                                          */
+/*  VARLIST_ForEachNotification                                               */
 /*!
-    Store a value into a VARTYPE_FLOAT variable
+    Visit all of the notification registrations
 
-    The varlist_SetFloat function stores a value into a VARTYPE_FLOAT variable
-    The function will convert the source type if possible.
+    The VARLIST_ForEachNotification function calls the specified function
+    for each notification registered against each variable handle, in
+    handle order, with the subscription options needed to register the
+    notification again.  The iteration stops at the first call which
+    does not return EOK.
 
     @param[in]
-        pVarStorage
-            pointer to the storage object for the target variable
+        fn
+            function to call for each notification
 
     @param[in]
-        pVarInfo
-            pointer to the variable info object containing the value to set
+        arg
+            opaque argument passed to the function
 
-    @retval EOK the variable was successfully set
-    @retval ENOTSUP the source variable is not supported for this operation
+    @retval EOK all of the notifications were visited
     @retval EINVAL invalid arguments
-    @retval EALREADY the value is already set to the requested value
+    @retval other error returned by the function
 
 ==============================================================================*/
-static int varlist_SetFloat( VarStorage *pVarStorage, VarInfo *pVarInfo )
+int VARLIST_ForEachNotification( VarNotifyFn fn, void *arg )
 {
     int result = EINVAL;
-    VarType srctype;
-    float f;
+    NotificationVisit visit;
+    VarStorage *pVarStorage;
+    VarID *pVarID;
+    VAR_HANDLE hVar;
 
-    if( ( pVarStorage != NULL ) &&
-        ( pVarInfo != NULL ) )
+    if ( fn != NULL )
     {
-        srctype = pVarInfo->var.type;
-        switch( srctype )
-        {
-            case VARTYPE_INT32:
-                f = pVarInfo->var.val.l;
-                if ( pVarStorage->var.val.f == f )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.f = f;
-                    result = EOK;
-                }
-                break;
-
-            case VARTYPE_UINT32:
-                f = pVarInfo->var.val.ul;
-                if ( pVarStorage->var.val.f == f )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.f = f;
-                    result = EOK;
-                }
-                break;
-
-            case VARTYPE_INT16:
-                f = pVarInfo->var.val.i;
-                if ( pVarStorage->var.val.f == f )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.f = f;
-                    result = EOK;
-                }
-                break;
-
-            case VARTYPE_UINT16:
-                f = pVarInfo->var.val.ui;
-                if ( pVarStorage->var.val.f == f )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.f = f;
-                    result = EOK;
-                }
-                break;
-
-            case VARTYPE_FLOAT:
-                if ( pVarStorage->var.val.f == pVarInfo->var.val.f )
-                {
-                    result = EALREADY;
-                }
-                else
-                {
-                    pVarStorage->var.val.f = pVarInfo->var.val.f;
-                    result = EOK;
-                }
-                break;
-
-            default:
-                result = ENOTSUP;
-                break;
+        result = EOK;
+        visit.fn = fn;
+        visit.arg = arg;
+
+        for ( hVar = 1;
+              ( hVar <= (VAR_HANDLE)varcount ) && ( result == EOK );
+              hVar++ )
+        {
+            pVarID = varlist_HandleVarID( hVar );
+            pVarStorage = ( pVarID != NULL ) ? pVarID->pVarStorage : NULL;
+            if ( ( pVarStorage != NULL ) &&
+                 ( pVarStorage->pMeta != NULL ) )
+            {
+                visit.calcTTL = pVarStorage->pMeta->calcTTL;
+                result = NOTIFY_ForEach( &pVarStorage->pMeta->notifications,
+                                         hVar,
+                                         varlist_VisitNotification,
+                                         &visit );
+            }
         }
     }
 
@@ -3213,69 +6698,115 @@ static int varlist_SetFloat( VarStorage *pVarStorage, VarInfo *pVarInfo )
 }
 
 /*============================================================================*/
-/*  varlist_SetStr                                                            */
+/*  VARLIST_RequestNotify                                                     */
 /*!
-    Store a value into a VARTYPE_STR variable
+    Handle a notification registration request from a client
 
-    The varlist_SetStr function stores a value into a VARTYPE_STR variable
-    The function will convert the source type if possible.
+    The VARLIST_RequestNotify function handles a notification request
+    from a client.  It registers the specific notification request
+    against the specified variable.
+
+    @param[in,out]
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable to register the notification against
 
     @param[in]
-        pVarStorage
-            pointer to the storage object for the target variable
+        pid
+            process ID of the requester
 
     @param[in]
-        pVarInfo
-            pointer to the variable info object containing the value to set
+        pOptions
+            pointer to the subscription options, or NULL for none
 
-    @retval EOK the variable was successfully set
-    @retval ENOTSUP the source variable is not supported for this operation
-    @retval E2BIG not enough space to store the source variable
+    @retval EOK the notification request was successfully registered
+    @retval ENOENT the variable does not exist
+    @retval ENOTSUP the notification type is not supported
     @retval EINVAL invalid arguments
-    @retval EALREADY the value is already set to the requested value
 
 ==============================================================================*/
-static int varlist_SetStr( VarStorage *pVarStorage, VarInfo *pVarInfo )
+int VARLIST_RequestNotify( VarInfo *pVarInfo,
+                           pid_t pid,
+                           const VarNotifyOptions *pOptions )
 {
     int result = EINVAL;
-    size_t n;
+    VarStorage *pVarStorage = NULL;
+    NotificationType notifyType;
+    VarID *pVarID;
+    VAR_HANDLE hVar = VAR_INVALID;
 
-    if( ( pVarStorage != NULL ) &&
-        ( pVarInfo != NULL ) )
+    if( pVarInfo != NULL )
     {
-        if( pVarInfo->var.type == VARTYPE_STR )
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
         {
-            /* we have a string, check its length */
-            n = pVarInfo->var.len;
-            if( n <= pVarStorage->var.len )
+            /* get a pointer to the variable storage for this variable */
+            pVarStorage = pVarID->pVarStorage;
+
+            /* get the handle of the variable for the notification request */
+            hVar = pVarInfo->hVar;
+        }
+
+        /* get the notification type */
+        notifyType = pVarInfo->notificationType;
+
+        if( ( pVarStorage != NULL ) &&
+            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            /* get the storage reference identifier */
+            pVarInfo->storageRef = pVarStorage->storageRef;
+
+            /* add the notification */
+            result = NOTIFY_Add( &pVarStorage->pMeta->notifications,
+                                 notifyType,
+                                 hVar,
+                                 pid,
+                                 pOptions );
+            if( result == EOK )
             {
-                if ( memcmp( pVarStorage->var.val.str,
-                            pVarInfo->var.val.str,
-                            n ) == 0 )
+                if( notifyType == NOTIFY_MODIFIED )
                 {
-                    result = EALREADY;
+                    pVarStorage->notifyMask |= NOTIFY_MASK_MODIFIED;
                 }
-                else
+                else if ( notifyType == NOTIFY_MODIFIED_QUEUE )
                 {
-                    /* copy the string and nul terminate */
-                    memcpy( pVarStorage->var.val.str,
-                            pVarInfo->var.val.str,
-                            n );
-                    pVarStorage->var.val.str[n] = '\0';
+                    pVarStorage->notifyMask |= NOTIFY_MASK_MODIFIED_QUEUE;
+                }
+                else if ( notifyType == NOTIFY_MODIFIED_RING )
+                {
+                    pVarStorage->notifyMask |= NOTIFY_MASK_MODIFIED_RING;
+                }
+                else if( notifyType == NOTIFY_CALC )
+                {
+                    pVarStorage->notifyMask |= NOTIFY_MASK_CALC;
 
-                    /* string copied successfully */
-                    result = EOK;
+                    /* set up the lifetime of the calculated values */
+                    pVarStorage->pMeta->calcExpiry = 0;
+                    pVarStorage->pMeta->calcTTL =
+                        ( ( pOptions != NULL ) &&
+                          ( pOptions->flags & NOTIFY_OPT_CACHE_TTL ) )
+                            ? (uint64_t)pOptions->cacheTTL_ms * 1000000ULL
+                            : 0;
+
+                    /* calculated values cannot be read from shared memory */
+                    SHAREDVALUES_Disable( pVarStorage->sharedSlot );
+
+                    /* or cached by clients */
+                    VARVERSIONS_SetCacheable( pVarStorage->storageRef, false );
                 }
+                else if( notifyType == NOTIFY_VALIDATE )
+                {
+                    pVarStorage->notifyMask |= NOTIFY_MASK_VALIDATE;
+                }
+                else if( notifyType == NOTIFY_PRINT )
+                {
+                    pVarStorage->notifyMask |= NOTIFY_MASK_PRINT;
+                }
+
+                /* pick up the subscription option bits */
+                varlist_SyncNotifyMask( pVarStorage );
+                STANDBY_Changed();
             }
-            else
-            {
-                /* the string doesn't fit */
-                result = E2BIG;
-            }
-        }
-        else
-        {
-            result = ENOTSUP;
         }
     }
 
@@ -3283,120 +6814,229 @@ static int varlist_SetStr( VarStorage *pVarStorage, VarInfo *pVarInfo )
 }
 
 /*============================================================================*/
-/*  varlist_SetBlob                                                           */
+/*  VARLIST_NotifyCancel                                                     */
 /*!
-    Store a value into a VARTYPE_BLOB variable
+    Handle a notification cancellation request from a client
 
-    The varlist_SetBlob function stores a value into a VARTYPE_BLOB variable
+    The VARLIST_NotifyCancel function handles a notification cancellation
+    request from a client.
 
     @param[in]
-        pVarStorage
-            pointer to the storage object for the target variable
+        pVarInfo
+            Pointer to the variable definition containing the handle
+            of the variable to cancel the nofication for.
 
     @param[in]
-        pVarInfo
-            pointer to the variable info object containing the value to set
+        pid
+            process ID of the requester
 
-    @retval EOK the variable was successfully set
-    @retval ENOTSUP the source variable is not supported for this operation
-    @retval E2BIG not enough space to store the source variable
+    @retval EOK the notification request was successfully registered
+    @retval ENOENT the variable does not exist
+    @retval ENOTSUP the notification type is not supported
     @retval EINVAL invalid arguments
-    @retval EALREADY the value is already set to the requested value
 
 ==============================================================================*/
-static int varlist_SetBlob( VarStorage *pVarStorage, VarInfo *pVarInfo )
+int VARLIST_NotifyCancel( VarInfo *pVarInfo, pid_t pid )
 {
     int result = EINVAL;
-    size_t n;
+    VarStorage *pVarStorage = NULL;
+    NotificationType notifyType;
+    VarID *pVarID;
+    VAR_HANDLE hVar = VAR_INVALID;
+    int count = -1;
 
-    if( ( pVarStorage != NULL ) &&
-        ( pVarInfo != NULL ) )
+    if ( pVarInfo != NULL )
     {
-        if( pVarInfo->var.type == VARTYPE_BLOB )
+        pVarID = varlist_GetVarID( pVarInfo );
+        if ( pVarID != NULL )
         {
-            /* we have a blob, check its length */
-            n = pVarInfo->var.len;
-            if( n <= pVarStorage->var.len )
+            /* get a pointer to the variable storage for this variable */
+            pVarStorage = pVarID->pVarStorage;
+
+            /* get the handle of the variable for the notification request */
+            hVar = pVarInfo->hVar;
+        }
+
+        /* get the notification type */
+        notifyType = pVarInfo->notificationType;
+
+        if( ( pVarStorage != NULL ) &&
+            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        {
+            /* cancel the specific notification for the specified client */
+            result = NOTIFY_Cancel( &pVarStorage->pMeta->notifications,
+                                    notifyType,
+                                    hVar,
+                                    pid,
+                                    &count );
+            if ( ( result == EOK ) &&
+                 ( count == 0 ) )
             {
-                if ( memcmp( pVarStorage->var.val.blob,
-                            pVarInfo->var.val.blob,
-                            n ) == 0 )
+                /* update the notification masks */
+                if( notifyType == NOTIFY_MODIFIED )
                 {
-                    result = EALREADY;
+                    pVarStorage->notifyMask &= ~NOTIFY_MASK_MODIFIED;
                 }
-                else
+                else if ( notifyType == NOTIFY_MODIFIED_QUEUE )
                 {
-                    /* copy the blob */
-                    memcpy( pVarStorage->var.val.blob,
-                            pVarInfo->var.val.blob,
-                            n );
+                    pVarStorage->notifyMask &= ~NOTIFY_MASK_MODIFIED_QUEUE;
+                }
+                else if ( notifyType == NOTIFY_MODIFIED_RING )
+                {
+                    pVarStorage->notifyMask &= ~NOTIFY_MASK_MODIFIED_RING;
+                }
+                else if( notifyType == NOTIFY_CALC )
+                {
+                    pVarStorage->notifyMask &= ~NOTIFY_MASK_CALC;
 
-                    /* blob copied successfully */
-                    result = EOK;
+                    /* discard the cached calculated value */
+                    pVarStorage->pMeta->calcTTL = 0;
+                    pVarStorage->pMeta->calcExpiry = 0;
+
+                    /* re-enable direct reads of the shared value */
+                    SHAREDVALUES_Update( pVarStorage->sharedSlot,
+                                         &pVarStorage->var );
+
+                    /* allow clients to cache the value again */
+                    if ( pVarStorage->directAccess == false )
+                    {
+                        VARVERSIONS_SetCacheable( pVarStorage->storageRef,
+                                                  true );
+                    }
+                }
+                else if( notifyType == NOTIFY_VALIDATE )
+                {
+                    pVarStorage->notifyMask &= ~NOTIFY_MASK_VALIDATE;
+                }
+                else if( notifyType == NOTIFY_PRINT )
+                {
+                    pVarStorage->notifyMask &= ~NOTIFY_MASK_PRINT;
                 }
             }
-            else
+
+            if ( result == EOK )
             {
-                /* the blob doesn't fit */
-                result = E2BIG;
+                /* update the subscription option bits */
+                varlist_SyncNotifyMask( pVarStorage );
+                STANDBY_Changed();
             }
         }
-        else
-        {
-            result = ENOTSUP;
-        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  VARLIST_GetType                                                           */
+/*  VARLIST_NotifyQuery                                                       */
 /*!
-    Handle a TYPE request from a client
+    Handle a query subscription request from a client
 
-    The VARLIST_Type function handles a TYPE request from a client.
-    It retrieves the VarObject type for the specified variable
+    The VARLIST_NotifyQuery function registers a single NOTIFY_MODIFIED
+    subscription which covers every variable matching the specified query.
+    The query is evaluated against the name, flag and tag indexes when
+    the subscription is created, and each variable (or alias) created
+    afterwards is checked against it.  The subscriber is signalled with
+    the handle of the modified variable.
 
-    @param[in,out]
+    @param[in]
+        clientPID
+            process identifier of the subscribing client
+
+    @param[in]
+        searchType
+            integer specifing the query type (QUERY_xxx flags)
+
+    @param[in]
         pVarInfo
-            Pointer to the variable definition containing the handle
-            of the variable to query
+            pointer to the query instance ID, flags and tags, and the
+            client credentials
 
-    @retval EOK the variable was successfully set
-    @retval ENOENT the variable does not exist
+    @param[in]
+        searchText
+            pointer to the query match string
+
+    @param[out]
+        pId
+            pointer to a location to store the subscription identifier
+
+    @retval EOK the query subscription was registered
+    @retval ENOMEM memory allocation failure
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-int VARLIST_GetType( VarInfo *pVarInfo )
+int VARLIST_NotifyQuery( pid_t clientPID,
+                         int searchType,
+                         VarInfo *pVarInfo,
+                         char *searchText,
+                         int *pId )
 {
     int result = EINVAL;
-    VarStorage *pVarStorage = NULL;
-    VarID *pVarID;
+    QuerySubscription *p;
+    VAR_HANDLE hVar;
 
-    if( pVarInfo != NULL )
+    if( ( pVarInfo != NULL ) &&
+        ( searchText != NULL ) &&
+        ( pId != NULL ) )
     {
-        pVarID = varlist_GetVarID( pVarInfo );
-        if ( pVarID != NULL )
-        {
-            /* get a pointer to the variable storage for this variable */
-            pVarStorage = pVarID->pVarStorage;
-        }
+        result = ENOMEM;
 
-        if( ( pVarStorage != NULL ) &&
-            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        p = calloc( 1, sizeof( QuerySubscription ) );
+        if( p != NULL )
         {
-            /* retrieve the type */
-            pVarInfo->var.type = pVarStorage->var.type;
+            STATS_MemAlloc( STATS_MEM_SEARCH_CONTEXTS,
+                            1,
+                            sizeof( QuerySubscription ) +
+                            VARLIST_QUERY_BITMAP_WORDS * sizeof( uint64_t ) );
+
+            varlist_InitSearchContext( &p->ctx,
+                                       clientPID,
+                                       searchType,
+                                       pVarInfo,
+                                       searchText );
+
+            memcpy( p->creds.creds, pVarInfo->creds, sizeof( p->creds.creds ) );
+            p->creds.ncreds = pVarInfo->ncreds;
+            p->creds.groupset = pVarInfo->groupset;
+            p->generation = PERMSETS_Generation();
+
+            p->pHandles = calloc( VARLIST_QUERY_BITMAP_WORDS,
+                                  sizeof( uint64_t ) );
+
+            if( ( p->pHandles != NULL ) &&
+                ( p->ctx.query.match != NULL ) &&
+                ( varlist_FindCandidates( &p->ctx ) == EOK ) )
+            {
+                /* evaluate the query against the existing variables */
+                while( ( hVar = varlist_NextCandidate( &p->ctx ) )
+                            != VAR_INVALID )
+                {
+                    if( varlist_QueryMatch( p,
+                                            varlist_HandleVarID( hVar ) ) )
+                    {
+                        p->pHandles[hVar / 64] |= ( 1ULL << ( hVar % 64 ) );
+                    }
+                }
 
-            /* get the storage reference identifier */
-            pVarInfo->storageRef = pVarStorage->storageRef;
+                /* the candidate list is not needed after registration */
+                STATS_MemFree( STATS_MEM_SEARCH_CONTEXTS,
+                               0,
+                               p->ctx.maxCandidates * sizeof( VAR_HANDLE ) );
+                free( p->ctx.pCandidates );
+                p->ctx.pCandidates = NULL;
+                p->ctx.numCandidates = 0;
+                p->ctx.maxCandidates = 0;
 
-            result = EOK;
-        }
-        else
-        {
-            result = ENOENT;
+                p->id = ++querySubscriptionIdent;
+                p->pNext = pQuerySubscriptions;
+                pQuerySubscriptions = p;
+
+                *pId = p->id;
+                result = EOK;
+            }
+            else
+            {
+                varlist_DeleteQuerySubscription( p );
+            }
         }
     }
 
@@ -3404,215 +7044,345 @@ int VARLIST_GetType( VarInfo *pVarInfo )
 }
 
 /*============================================================================*/
-/*  VARLIST_GetName                                                           */
+/*  VARLIST_NotifyQueryCancel                                                 */
 /*!
-    Handle a NAME request from a client
+    Cancel a query subscription
 
-    The VARLIST_GetName function handles a NAME request from a client.
-    It retrieves the VarObject name for the specified variable
+    The VARLIST_NotifyQueryCancel function removes the specified query
+    subscription belonging to the specified client.
 
-    @param[in,out]
-        pVarInfo
-            Pointer to the variable definition containing the handle
-            of the variable to query
+    @param[in]
+        clientPID
+            process identifier of the subscribing client
 
-    @retval EOK the variable was successfully set
-    @retval ENOENT the variable does not exist
-    @retval EINVAL invalid arguments
+    @param[in]
+        id
+            identifier of the query subscription to cancel
+
+    @retval EOK the query subscription was cancelled
+    @retval ENOENT the query subscription was not found
 
 ==============================================================================*/
-int VARLIST_GetName( VarInfo *pVarInfo )
+int VARLIST_NotifyQueryCancel( pid_t clientPID, int id )
 {
-    int result = EINVAL;
-    VarID *pVarID;
+    int result = ENOENT;
+    QuerySubscription **pp = &pQuerySubscriptions;
+    QuerySubscription *p;
 
-    if( pVarInfo != NULL )
+    while( *pp != NULL )
     {
-        pVarID = varlist_GetVarID( pVarInfo );
-        if ( pVarID != NULL )
-        {
-            if( ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
-            {
-                /* retrieve the name */
-                memcpy( pVarInfo->name, pVarID->name, MAX_NAME_LEN+1 );
-                result = EOK;
-            }
-            else
-            {
-                result = ENOENT;
-            }
-        }
-        else
+        p = *pp;
+        if( ( p->id == id ) &&
+            ( p->ctx.clientPID == clientPID ) )
         {
-            result = ENOENT;
+            *pp = p->pNext;
+            varlist_DeleteQuerySubscription( p );
+            result = EOK;
+            break;
         }
+
+        pp = &p->pNext;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  VARLIST_GetLength                                                         */
+/*  VARLIST_PurgeClient                                                       */
 /*!
-    Handle a LENGTH request from a client
+    Discard the variable store resources of an exited client
 
-    The VARLIST_GetLength function handles a LENGTH request from a client.
-    It retrieves the VarObject length for the specified variable
+    The VARLIST_PurgeClient function removes the notification
+    registrations, search contexts and query subscriptions owned by the
+    specified client process, and clears the notification masks of the
+    variables it was the last subscriber of.  Variables it was the CALC
+    handler of return to their stored value.
 
-    @param[in,out]
-        pVarInfo
-            Pointer to the variable definition containing the handle
-            of the variable to query
+    @param[in]
+        clientPID
+            process identifier of the exited client
 
-    @retval EOK the variable was successfully set
-    @retval ENOENT the variable does not exist
+    @param[out]
+        pNotifications
+            pointer to a location to store the number of notification
+            registrations removed
+
+    @param[out]
+        pContexts
+            pointer to a location to store the number of search contexts
+            and query subscriptions removed
+
+    @retval EOK the client resources were removed
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-int VARLIST_GetLength( VarInfo *pVarInfo )
+int VARLIST_PurgeClient( pid_t clientPID,
+                         size_t *pNotifications,
+                         size_t *pContexts )
 {
     int result = EINVAL;
-    VarStorage *pVarStorage = NULL;
+    VarStorage *pVarStorage;
     VarID *pVarID;
+    VAR_HANDLE hVar;
+    SearchContext *ctx;
+    QuerySubscription **pp = &pQuerySubscriptions;
+    QuerySubscription *p;
+    size_t n;
+    bool calc;
 
-    if( pVarInfo != NULL )
+    if( ( pNotifications != NULL ) &&
+        ( pContexts != NULL ) )
     {
-        pVarID = varlist_GetVarID( pVarInfo );
-        if ( pVarID != NULL )
-        {
-            /* get a pointer to the variable storage for this variable */
-            pVarStorage = pVarID->pVarStorage;
-        }
+        *pNotifications = 0;
+        *pContexts = 0;
 
-        if( ( pVarStorage != NULL ) &&
-            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        for( hVar = 1; hVar <= (VAR_HANDLE)varcount; hVar++ )
         {
-            /* retrieve the type */
-            pVarInfo->var.len = pVarStorage->var.len;
+            pVarID = varlist_HandleVarID( hVar );
+            pVarStorage = ( pVarID != NULL ) ? pVarID->pVarStorage : NULL;
+            if( ( pVarStorage == NULL ) ||
+                ( pVarStorage->pMeta == NULL ) )
+            {
+                continue;
+            }
 
-            /* get the storage reference identifier */
-            pVarInfo->storageRef = pVarStorage->storageRef;
+            calc = ( pVarStorage->notifyMask & NOTIFY_MASK_CALC ) != 0;
 
-            result = EOK;
+            n = NOTIFY_RemovePID( &pVarStorage->pMeta->notifications,
+                                  clientPID );
+            if( n > 0 )
+            {
+                *pNotifications += n;
+                varlist_SyncNotifyMask( pVarStorage );
+                STANDBY_Changed();
+
+                if( ( calc == true ) &&
+                    ( ( pVarStorage->notifyMask & NOTIFY_MASK_CALC ) == 0 ) )
+                {
+                    /* discard the cached calculated value */
+                    pVarStorage->pMeta->calcTTL = 0;
+                    pVarStorage->pMeta->calcExpiry = 0;
+
+                    /* re-enable direct reads of the shared value */
+                    SHAREDVALUES_Update( pVarStorage->sharedSlot,
+                                         &pVarStorage->var );
+
+                    /* allow clients to cache the value again */
+                    if ( pVarStorage->directAccess == false )
+                    {
+                        VARVERSIONS_SetCacheable( pVarStorage->storageRef,
+                                                  true );
+                    }
+                }
+            }
         }
-        else
+
+        /* release the search contexts of the client.  Search context
+           objects are never freed, so the list can be walked while
+           they are released */
+        for( ctx = pSearchContexts; ctx != NULL; ctx = ctx->pNext )
         {
-            result = ENOENT;
+            if( ( ctx->contextId != 0 ) &&
+                ( ctx->clientPID == clientPID ) )
+            {
+                varlist_DeleteSearchContext( ctx );
+                (*pContexts)++;
+            }
+        }
+
+        /* release the query subscriptions of the client */
+        while( *pp != NULL )
+        {
+            p = *pp;
+            if( p->ctx.clientPID == clientPID )
+            {
+                *pp = p->pNext;
+                varlist_DeleteQuerySubscription( p );
+                (*pContexts)++;
+            }
+            else
+            {
+                pp = &p->pNext;
+            }
         }
+
+        result = EOK;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  VARLIST_GetFlags                                                          */
+/*  AssignVarInfo                                                             */
 /*!
-    Handle a FLAGS request from a client
+    Copy the variable info from the VarInfo object to the VarStorage object
 
-    The VARLIST_GetFlags function handles a FLAGS request from a client.
-    It retrieves the flags for the specified variable
+    The AssignVarInfo function copies the variable information from the
+    specified VarInfo object into the specified VarStorage object.
 
-    @param[in,out]
+    VarStorage <- VarInfo
+
+    It allocates memory for string and blob type variables
+
+    @param[in]
+        pVarID
+            Pointer to the variable identifier
+
+    @param[in]
+        pVarStorage
+            Pointer to the destination VarStorage object
+
+    @param[in]
         pVarInfo
-            Pointer to the variable definition containing the handle
-            of the variable to query
+            Pointer to the source VarInfo object
 
-    @retval EOK the variable was successfully set
-    @retval ENOENT the variable does not exist
+    @retval EOK the variable information was successfully assigned
+    @retval ENOMEM memory allocation failure
+    @retval ENOTSUP zero length string specified
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-int VARLIST_GetFlags( VarInfo *pVarInfo )
+static int AssignVarInfo( VarID *pVarID,
+                          VarStorage *pVarStorage,
+                          VarInfo *pVarInfo )
 {
     int result = EINVAL;
-    VarStorage *pVarStorage = NULL;
-    VarID *pVarID;
 
-    if( pVarInfo != NULL )
+    if( ( pVarStorage != NULL ) &&
+        ( pVarInfo != NULL ) )
     {
-        pVarID = varlist_GetVarID( pVarInfo );
-        if ( pVarID != NULL )
+        /* assume success until we know otherwise */
+        /* see if we need to allocate storage for a string variable */
+        result = EOK;
+
+        if( pVarInfo->var.type == VARTYPE_STR )
         {
-            /* get a pointer to the variable storage for this variable */
-            pVarStorage = pVarID->pVarStorage;
+            result = assign_StringVarInfo( pVarStorage, pVarInfo );
+        }
+        else if ( pVarInfo->var.type == VARTYPE_BLOB )
+        {
+            result = assign_BlobVarInfo( pVarStorage, pVarInfo );
         }
 
-        if( ( pVarStorage != NULL ) &&
-            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        if( result == EOK )
         {
-            /* retrieve the flags */
-            pVarInfo->flags = pVarStorage->flags;
+            /* set the variable's instance identifier */
+            pVarID->instanceID = pVarInfo->instanceID;
 
-            /* get the storage reference identifier */
-            pVarInfo->storageRef = pVarStorage->storageRef;
+            /* get the pooled variable name.  The pool is sized
+               for one name per variable handle */
+            pVarID->name = NAMEPOOL_Intern( pVarInfo->name );
 
-            result = EOK;
-        }
-        else
-        {
-            result = ENOENT;
+            /* set the variable's GUID */
+            pVarID->guid = pVarInfo->guid;
+
+            /* set the variable type */
+            pVarStorage->var.type = pVarInfo->var.type;
+
+            /* set the variable length */
+            pVarStorage->var.len = pVarInfo->var.len;
+
+            /* set the variable flags */
+            pVarStorage->flags = pVarInfo->flags;
+            varlist_UpdateSetPlan( pVarStorage );
+
+            /* copy the variable format specifier */
+            strncpy( pVarStorage->pMeta->formatspec,
+                        pVarInfo->formatspec,
+                        MAX_FORMATSPEC_LEN );
+            pVarStorage->pMeta->formatspec[MAX_FORMATSPEC_LEN-1] = 0;
+
+            /* set the variable permissions */
+            pVarStorage->pMeta->permissions = pVarInfo->permissions;
+            pVarStorage->pMeta->readSet = PERMSETS_FromPermissions(
+                                    pVarInfo->permissions.read,
+                                    pVarInfo->permissions.nreads );
+            pVarStorage->pMeta->writeSet = PERMSETS_FromPermissions(
+                                    pVarInfo->permissions.write,
+                                    pVarInfo->permissions.nwrites );
+
+            /* copy the variable value */
+            if( ( pVarInfo->var.type != VARTYPE_STR ) &&
+                ( pVarInfo->var.type != VARTYPE_BLOB ) )
+            {
+                pVarStorage->var.val  = pVarInfo->var.val;
+            }
+
+            /* set the variable tags */
+            result = TAGLIST_Parse( pVarInfo->tagspec,
+                                    pVarStorage->pMeta->tags,
+                                    MAX_TAGS_LEN );
         }
     }
 
     return result;
+
 }
 
 /*============================================================================*/
-/*  VARLIST_GetInfo                                                           */
+/*  assign_BlobVarInfo                                                        */
 /*!
-    Handle a variable information request from a client
+    Copy the blob variable info from the VarInfo object to the VarStorage object
 
-    The VARLIST_GetInfo function handles an INFO request from a client.
-    It retrieves the VarInfo data for the specified variable
+    The assign_BlobVarInfo function copies the blob variable information from
+    the specified VarInfo object into the specified VarStorage object.
 
-    @param[in,out]
+    VarStorage <- VarInfo
+
+    It allocates memory for the blob data
+
+    @param[in]
+        pVarStorage
+            Pointer to the destination VarStorage object
+
+    @param[in]
         pVarInfo
-            Pointer to the variable definition containing the handle
-            of the variable to query
+            Pointer to the source VarInfo object
 
-    @retval EOK the variable was successfully set
-    @retval ENOENT the variable does not exist
+    @retval EOK the variable information was successfully assigned
+    @retval ENOMEM memory allocation failure
+    @retval ENOTSUP zero length blob specified or invalid type specified
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-int VARLIST_GetInfo( VarInfo *pVarInfo )
+static int assign_BlobVarInfo( VarStorage *pVarStorage, VarInfo *pVarInfo )
 {
     int result = EINVAL;
-    VarStorage *pVarStorage = NULL;
-    VarID *pVarID;
 
-    if( pVarInfo != NULL )
+    if ( ( pVarStorage != NULL ) &&
+         ( pVarInfo != NULL ) )
     {
-        pVarID = varlist_GetVarID( pVarInfo );
-        if ( pVarID != NULL )
+        if ( pVarInfo->var.type == VARTYPE_BLOB )
         {
-            /* get a pointer to the variable storage for this variable */
-            pVarStorage = pVarID->pVarStorage;
-        }
+            if( pVarInfo->var.len != 0 )
+            {
+                pVarStorage->var.val.blob =
+                                SLAB_AllocBuffer( pVarInfo->var.len );
+                if( pVarStorage->var.val.blob != NULL )
+                {
+                    STATS_MemAlloc( STATS_MEM_BLOBS, 1, pVarInfo->var.len );
+
+                    /* copy the blob */
+                    memcpy( pVarStorage->var.val.blob,
+                             pVarInfo->var.val.blob,
+                             pVarInfo->var.len );
 
-        if( ( pVarStorage != NULL ) &&
-            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
-        {
-            /* retrieve the VarInfo object */
-            pVarInfo->storageRef = pVarStorage->storageRef;
-            pVarInfo->flags = pVarStorage->flags;
-            memcpy( pVarInfo->formatspec,
-                    pVarStorage->formatspec,
-                    MAX_FORMATSPEC_LEN );
+                    result = EOK;
+                }
+                else
+                {
+                    result = ENOMEM;
+                }
+            }
+            else
+            {
+                result = ENOTSUP;
+            }
 
-            pVarInfo->guid = pVarID->guid;
-            pVarInfo->instanceID = pVarID->instanceID;
-            memcpy( pVarInfo->name, pVarID->name, MAX_NAME_LEN );
-            pVarInfo->permissions = pVarStorage->permissions;
-            TAGLIST_TagsToString( pVarStorage->tags,
-                                  MAX_TAGS_LEN,
-                                  pVarInfo->tagspec,
-                                  MAX_TAGSPEC_LEN );
-            result = EOK;
         }
         else
         {
-            result = ENOENT;
+            result = ENOTSUP;
         }
     }
 
@@ -3620,175 +7390,214 @@ int VARLIST_GetInfo( VarInfo *pVarInfo )
 }
 
 /*============================================================================*/
-/*  VARLIST_GetAliases                                                        */
+/*  assign_StringVarInfo                                                      */
 /*!
-    Get a list of aliases for the specified variable
+    Copy the string var info from the VarInfo object to the VarStorage object
 
-    The VARLIST_GetAliases function genreates a list of aliases
-    for the specified variable as a JSON list
-    eg. ["alias1","alias2",...,"aliasN"]
+    The assign_StringVarInfo function copies the string variable information
+    from the specified VarInfo object into the specified VarStorage object.
 
-    @param[in]
-        pVarInfo
-            Pointer to the variable definition containing the handle
-            of the variable to query
+    VarStorage <- VarInfo
 
-    @param[in,out]
-        aliases
-            pointer to the buffer to store the alias list
+    It allocates memory for the string
 
     @param[in]
-        len
-            maximum length of the alias list
+        pVarStorage
+            Pointer to the destination VarStorage object
 
-    @retval EOK the alias list was successfully generated
-    @retval E2BIG the alias list does not fit in the buffer
-    @retval ENOENT there are no aliases
+    @param[in]
+        pVarInfo
+            Pointer to the source VarInfo object
+
+    @retval EOK the variable information was successfully assigned
+    @retval ENOMEM memory allocation failure
+    @retval ENOTSUP zero length string specified or invalid type specified
     @retval EINVAL invalid arguments
 
 ==============================================================================*/
-int VARLIST_GetAliases( VarInfo *pVarInfo, VAR_HANDLE *aliases, size_t len )
+static int assign_StringVarInfo( VarStorage *pVarStorage, VarInfo *pVarInfo )
 {
     int result = EINVAL;
-    VarStorage *pVarStorage = NULL;
-    VarID *pVarID;
-    VarAlias *pVarAlias;
-    size_t count = 0;
 
-    if ( ( pVarInfo != NULL ) &&
-         ( aliases != NULL ) &&
-         ( len > 0 ) )
+    if ( ( pVarStorage != NULL ) &&
+         ( pVarInfo != NULL ) )
     {
-        pVarID = varlist_GetVarID( pVarInfo );
-        if ( pVarID != NULL )
+        if ( pVarInfo->var.type == VARTYPE_STR )
         {
-            /* get a pointer to the variable storage for this variable */
-            pVarStorage = pVarID->pVarStorage;
-        }
+            if( pVarInfo->var.len != 0 )
+            {
+                /* allocate memory for the string and a NUL terminator
+                   after a full length value */
+                pVarStorage->var.val.str =
+                                SLAB_AllocBuffer( pVarInfo->var.len + 1 );
+                if( pVarStorage->var.val.str != NULL )
+                {
+                    STATS_MemAlloc( STATS_MEM_STRINGS,
+                                    1,
+                                    pVarInfo->var.len + 1 );
 
-        if( ( pVarStorage != NULL ) &&
-            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
-        {
-            /* pointer to the list of aliases */
-            pVarAlias = pVarStorage->pAliases;
+                    /* copy the string */
+                    strncpy( pVarStorage->var.val.str,
+                             pVarInfo->var.val.str,
+                             pVarInfo->var.len );
 
-            /* copy the aliases */
-            while( ( pVarAlias != NULL ) && ( count < len ) )
-            {
-                /* get a pointer to the variable id */
-                pVarID = pVarAlias->pVarID;
+                    pVarStorage->var.val.str[ pVarInfo->var.len-1 ] = 0;
 
-                if ( ( pVarID != NULL ) &&
-                     ( pVarID->hVar != VAR_INVALID ) )
+                    result = EOK;
+                }
+                else
                 {
-                    /* store the alias */
-                    aliases[count++] = pVarID->hVar;
+                    result = ENOMEM;
                 }
-
-                /* get the next alias */
-                pVarAlias = pVarAlias->pNext;
-            }
-
-            if ( count == len )
-            {
-                result = E2BIG;
             }
             else
             {
-                result = ( count > 0 ) ? EOK : ENOENT;
+                result = ENOTSUP;
             }
         }
         else
         {
-            result = ENOENT;
+            result = ENOTSUP;
         }
     }
 
     return result;
-
 }
 
 /*============================================================================*/
-/*  VARLIST_RequestNotify                                                     */
+/*  VARLIST_GetFirst                                                          */
 /*!
-    Handle a notification registration request from a client
+    Handle a get_first request from a client
 
-    The VARLIST_RequestNotify function handles a notification request
-    from a client.  It registers the specific notification request
-    against the specified variable.
+    The VARLIST_GetFirst function handles a get_first request from a
+    client.  It searches through the variable list to find the first
+    variable which matches the search critera.
+
+    @param[in]
+        clientPID
+            the process identifier of the requesting client
+
+    @param[in]
+        searchType
+            search type bitfield containing one or more of the
+            following search type bits:
+                QUERY_REGEX
+                QUERY_MATCH
+                QUERY_IMATCH
+                QUERY_FLAGS
+                QUERY_TAGS
+                QUERY_PREFIX
 
     @param[in,out]
         pVarInfo
-            Pointer to the variable definition containing the handle
-            of the variable to register the notification against
+            Pointer to the variable definition containing the search criteria
+
+    @param[out]
+        buf
+            pointer to the buffer (for returning string values)
 
     @param[in]
-        pid
-            process ID of the requester
+        bufsize
+            specifies the size of the buffer (and therefore
+            the maximum string length that can be retrieved).
 
-    @retval EOK the notification request was successfully registered
-    @retval ENOENT the variable does not exist
-    @retval ENOTSUP the notification type is not supported
+    @param[in,out]
+        context
+            pointer to a location to store the search context
+
+    @retval EOK the variable get_first request was handled
     @retval EINVAL invalid arguments
+    @retval ENOENT no variable matching the search criteria was found
+    @retval ENOMEM no search contexts available
 
 ==============================================================================*/
-int VARLIST_RequestNotify( VarInfo *pVarInfo, pid_t pid )
+int VARLIST_GetFirst( pid_t clientPID,
+                      int searchType,
+                      VarInfo *pVarInfo,
+                      char *buf,
+                      size_t bufsize,
+                      int *context )
 {
     int result = EINVAL;
+    VAR_HANDLE hVar;
+    SearchContext *ctx;
     VarStorage *pVarStorage = NULL;
-    NotificationType notifyType;
     VarID *pVarID;
-    VAR_HANDLE hVar = VAR_INVALID;
 
-    if( pVarInfo != NULL )
+    if( ( pVarInfo != NULL ) &&
+        ( buf != NULL ) &&
+        ( context != NULL ) )
     {
-        pVarID = varlist_GetVarID( pVarInfo );
-        if ( pVarID != NULL )
-        {
-            /* get a pointer to the variable storage for this variable */
-            pVarStorage = pVarID->pVarStorage;
+        result = ENOENT;
 
-            /* get the handle of the variable for the notification request */
-            hVar = pVarInfo->hVar;
+        /* create a new search context */
+        ctx = varlist_NewSearchContext( clientPID,
+                                        searchType,
+                                        pVarInfo,
+                                        buf );
+        if( ( ctx != NULL ) &&
+            ( varlist_FindCandidates( ctx ) == ENOMEM ) )
+        {
+            varlist_DeleteSearchContext( ctx );
+            ctx = NULL;
         }
 
-        /* get the notification type */
-        notifyType = pVarInfo->notificationType;
-
-        if( ( pVarStorage != NULL ) &&
-            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        if( ctx != NULL )
         {
-            /* get the storage reference identifier */
-            pVarInfo->storageRef = pVarStorage->storageRef;
-
-            /* add the notification */
-            result = NOTIFY_Add( &pVarStorage->pNotifications,
-                                 notifyType,
-                                 hVar,
-                                 pid );
-            if( result == EOK )
+            /* search through the variable list */
+            while( ( hVar = varlist_NextCandidate( ctx ) ) != VAR_INVALID )
             {
-                if( notifyType == NOTIFY_MODIFIED )
-                {
-                    pVarStorage->notifyMask |= NOTIFY_MASK_MODIFIED;
-                }
-                else if ( notifyType == NOTIFY_MODIFIED_QUEUE )
-                {
-                    pVarStorage->notifyMask |= NOTIFY_MASK_MODIFIED_QUEUE;
-                }
-                else if( notifyType == NOTIFY_CALC )
-                {
-                    pVarStorage->notifyMask |= NOTIFY_MASK_CALC;
-                }
-                else if( notifyType == NOTIFY_VALIDATE )
+                pVarID = varlist_HandleVarID( hVar );
+                if ( pVarID != NULL )
                 {
-                    pVarStorage->notifyMask |= NOTIFY_MASK_VALIDATE;
+                    /* get a pointer to the storage for this variable */
+                    pVarStorage = pVarID->pVarStorage;
                 }
-                else if( notifyType == NOTIFY_PRINT )
+
+                if ( ( pVarStorage != NULL ) &&
+                     ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
                 {
-                    pVarStorage->notifyMask |= NOTIFY_MASK_PRINT;
+                    if( varlist_Match( pVarID, ctx ) == EOK )
+                    {
+                        /* copy the name */
+                        strcpy( pVarInfo->name, pVarID->name );
+
+                        /* copy the instanceID */
+                        pVarInfo->instanceID = pVarID->instanceID;
+
+                        /* copy the format specifier */
+                        memcpy( pVarInfo->formatspec,
+                                pVarStorage->pMeta->formatspec,
+                                MAX_FORMATSPEC_LEN );
+
+                        /* store the variable context id */
+                        *context = ctx->contextId;
+
+                        /* store the last variable found */
+                        ctx->hVar = hVar;
+
+                        /* get the variable value */
+                        pVarInfo->hVar = hVar;
+                        result = VARLIST_GetByHandle( clientPID,
+                                                      pVarInfo,
+                                                      buf,
+                                                      bufsize );
+                        break;
+                    }
                 }
             }
+
+            if( result == ENOENT )
+            {
+                /* nothing found - remove the search context */
+                varlist_DeleteSearchContext( ctx );
+                *context = 0;
+            }
+        }
+        else
+        {
+            *context = 0;
+            result = ENOMEM;
         }
     }
 
@@ -3796,936 +7605,1270 @@ int VARLIST_RequestNotify( VarInfo *pVarInfo, pid_t pid )
 }
 
 /*============================================================================*/
-/*  VARLIST_NotifyCancel                                                     */
+/*  VARLIST_GetNext                                                           */
 /*!
-    Handle a notification cancellation request from a client
+    Handle a get_next request from a client
 
-    The VARLIST_NotifyCancel function handles a notification cancellation
-    request from a client.
+    The VARLIST_GetNext function handles a get_next request from a
+    client.  It searches through the variable list to find the next
+    variable which matches the search critera in the specified search
+    context
+
+    @param[in]
+        clientPID
+            the process identifier of the requesting client
 
     @param[in]
+        context
+            pointer to the search context identifier
+
+    @param[in,out]
         pVarInfo
-            Pointer to the variable definition containing the handle
-            of the variable to cancel the nofication for.
+            Pointer to the data structure which will receive the
+            variable value
+
+    @param[out]
+        buf
+            pointer to the buffer (for returning string values)
 
     @param[in]
-        pid
-            process ID of the requester
+        bufsize
+            specifies the size of the buffer (and therefore
+            the maximum string length that can be retrieved).
 
-    @retval EOK the notification request was successfully registered
-    @retval ENOENT the variable does not exist
-    @retval ENOTSUP the notification type is not supported
+    @param[in,out]
+       response
+            pointer to a location to store the response value
+
+    @retval EOK the variable get_first request was handled
     @retval EINVAL invalid arguments
+    @retval ENOENT no variable matching the search criteria was found
+    @retval ENOMEM no search contexts available
 
 ==============================================================================*/
-int VARLIST_NotifyCancel( VarInfo *pVarInfo, pid_t pid )
+int VARLIST_GetNext( pid_t clientPID,
+                     int context,
+                     VarInfo *pVarInfo,
+                     char *buf,
+                     size_t bufsize,
+                     int *response )
 {
     int result = EINVAL;
+    VAR_HANDLE hVar;
+    SearchContext *ctx;
     VarStorage *pVarStorage = NULL;
-    NotificationType notifyType;
     VarID *pVarID;
-    VAR_HANDLE hVar = VAR_INVALID;
-    int count = -1;
 
-    if ( pVarInfo != NULL )
+    /* get the search context */
+    ctx = varlist_FindSearchContext( clientPID, context );
+    if ( ctx != NULL )
     {
-        pVarID = varlist_GetVarID( pVarInfo );
-        if ( pVarID != NULL )
-        {
-            /* get a pointer to the variable storage for this variable */
-            pVarStorage = pVarID->pVarStorage;
-
-            /* get the handle of the variable for the notification request */
-            hVar = pVarInfo->hVar;
-        }
-
-        /* get the notification type */
-        notifyType = pVarInfo->notificationType;
+        result = ENOENT;
 
-        if( ( pVarStorage != NULL ) &&
-            ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+        /* search through the variable list looking for a match */
+        while( ( hVar = varlist_NextCandidate( ctx ) ) != VAR_INVALID )
         {
-            /* cancel the specific notification for the specified client */
-            result = NOTIFY_Cancel( &pVarStorage->pNotifications,
-                                    notifyType,
-                                    hVar,
-                                    pid,
-                                    &count );
-            if ( ( result == EOK ) &&
-                 ( count == 0 ) )
+            pVarID = varlist_HandleVarID( hVar );
+            if ( pVarID != NULL )
             {
-                /* update the notification masks */
-                if( notifyType == NOTIFY_MODIFIED )
-                {
-                    pVarStorage->notifyMask &= ~NOTIFY_MASK_MODIFIED;
-                }
-                else if ( notifyType == NOTIFY_MODIFIED_QUEUE )
-                {
-                    pVarStorage->notifyMask &= ~NOTIFY_MASK_MODIFIED_QUEUE;
-                }
-                else if( notifyType == NOTIFY_CALC )
-                {
-                    pVarStorage->notifyMask &= ~NOTIFY_MASK_CALC;
-                }
-                else if( notifyType == NOTIFY_VALIDATE )
-                {
-                    pVarStorage->notifyMask &= ~NOTIFY_MASK_VALIDATE;
-                }
-                else if( notifyType == NOTIFY_PRINT )
+                /* get a pointer to the storage for this variable */
+                pVarStorage = pVarID->pVarStorage;
+            }
+
+            if ( ( pVarStorage != NULL ) &&
+                 ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+            {
+                /* check if the current variable matches the search criteria */
+                if( varlist_Match( pVarID, ctx ) == EOK )
                 {
-                    pVarStorage->notifyMask &= ~NOTIFY_MASK_PRINT;
+                    /* copy the name */
+                    strcpy( pVarInfo->name, pVarID->name );
+
+                    /* copy the instanceID */
+                    pVarInfo->instanceID = pVarID->instanceID;
+
+                    /* copy the format specifier */
+                    memcpy( pVarInfo->formatspec,
+                            pVarStorage->pMeta->formatspec,
+                            MAX_FORMATSPEC_LEN );
+
+                    /* store the last variable found */
+                    ctx->hVar = hVar;
+
+                    /* get the variable value */
+                    pVarInfo->hVar = hVar;
+                    result = VARLIST_GetByHandle( clientPID,
+                                                pVarInfo,
+                                                buf,
+                                                bufsize );
+                    break;
                 }
             }
         }
+
+        if( result == ENOENT )
+        {
+            /* no more matching variables found */
+            /* delete the search context */
+            varlist_DeleteSearchContext( ctx );
+
+            /* indicate end of search */
+            context = 0;
+        }
+
+        /* store the response value */
+        *response = context;
+    }
+    else
+    {
+        /* search context does not exist */
+        *response = 0;
+
+        result = ENOTSUP;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  AssignVarInfo                                                             */
+/*  VARLIST_GetPage                                                           */
 /*!
-    Copy the variable info from the VarInfo object to the VarStorage object
+    Handle a get_page request from a client
 
-    The AssignVarInfo function copies the variable information from the
-    specified VarInfo object into the specified VarStorage object.
+    The VARLIST_GetPage function handles a get_page request from a
+    client.  It packs as many variables matching the search criteria
+    as will fit into the page buffer.  The position of the search is kept
+    in the search context so the next page continues where this one
+    ended.
 
-    VarStorage <- VarInfo
+    A new search context is created if the context identifier is 0.
+    In this case the query type is taken from the page header, and the
+    search text follows the page header.
 
-    It allocates memory for string and blob type variables
+    Each record contains the value of the variable unless it is
+    calculated, rendered by a PRINT handler, or would not fit in an
+    empty page.  The client retrieves such values individually.
+
+    At most VARLIST_PAGE_SLICE candidates are examined for each page,
+    so the page may be returned short, or even empty, before the search
+    is complete.  This bounds the time the search holds the variable
+    store, so other requests are serviced between pages.
 
     @param[in]
-        pVarID
-            Pointer to the variable identifier
+        clientPID
+            the process identifier of the requesting client
 
     @param[in]
-        pVarStorage
-            Pointer to the destination VarStorage object
+        context
+            the search context identifier, or 0 to start a new search
 
     @param[in]
         pVarInfo
-            Pointer to the source VarInfo object
+            Pointer to the variable definition containing the search
+            criteria and the client credentials
 
-    @retval EOK the variable information was successfully assigned
-    @retval ENOMEM memory allocation failure
-    @retval ENOTSUP zero length string specified
+    @param[in,out]
+        buf
+            pointer to the buffer to receive the page
+
+    @param[in]
+        bufsize
+            size of the page buffer
+
+    @param[out]
+       response
+            pointer to a location to store the search context identifier,
+            or 0 if the search is complete
+
+    @retval EOK the get_page request was handled
     @retval EINVAL invalid arguments
+    @retval E2BIG the page is too small for a single record
+    @retval ENOMEM no search contexts available
+    @retval ENOTSUP the search context does not exist
 
 ==============================================================================*/
-static int AssignVarInfo( VarID *pVarID,
-                          VarStorage *pVarStorage,
-                          VarInfo *pVarInfo )
+int VARLIST_GetPage( pid_t clientPID,
+                     int context,
+                     VarInfo *pVarInfo,
+                     char *buf,
+                     size_t bufsize,
+                     int *response )
 {
     int result = EINVAL;
+    VarQueryPage *pPage = (VarQueryPage *)buf;
+    SearchContext *ctx = NULL;
+    VarStorage *pVarStorage;
+    VarID *pVarID;
+    VAR_HANDLE hVar = VAR_INVALID;
+    size_t offset = sizeof( VarQueryPage );
+    size_t n;
+    int examined = 0;
+    int rc;
 
-    if( ( pVarStorage != NULL ) &&
-        ( pVarInfo != NULL ) )
+    if( ( pVarInfo != NULL ) &&
+        ( buf != NULL ) &&
+        ( bufsize > sizeof( VarQueryPage ) ) &&
+        ( response != NULL ) )
     {
-        /* assume success until we know otherwise */
-        /* see if we need to allocate storage for a string variable */
-        result = EOK;
-
-        if( pVarInfo->var.type == VARTYPE_STR )
-        {
-            result = assign_StringVarInfo( pVarStorage, pVarInfo );
-        }
-        else if ( pVarInfo->var.type == VARTYPE_BLOB )
+        if( ( pPage->size > sizeof( VarQueryPage ) ) &&
+            ( pPage->size < bufsize ) )
         {
-            result = assign_BlobVarInfo( pVarStorage, pVarInfo );
+            /* the client may request a smaller page */
+            bufsize = pPage->size;
         }
 
-        if( result == EOK )
+        if( context == 0 )
         {
-            /* set the variable's instance identifier */
-            pVarID->instanceID = pVarInfo->instanceID;
-
-            /* copy the variable name */
-            strncpy(pVarID->name, pVarInfo->name, MAX_NAME_LEN );
-            pVarID->name[MAX_NAME_LEN-1] = 0;
+            /* NUL terminate the search text */
+            buf[bufsize - 1] = 0;
+
+            /* create a new search context */
+            ctx = varlist_NewSearchContext( clientPID,
+                                            pPage->type,
+                                            pVarInfo,
+                                            buf + sizeof( VarQueryPage ) );
+            if( ( ctx != NULL ) &&
+                ( varlist_FindCandidates( ctx ) == ENOMEM ) )
+            {
+                varlist_DeleteSearchContext( ctx );
+                ctx = NULL;
+            }
 
-            /* set the variable's GUID */
-            pVarID->guid = pVarInfo->guid;
+            result = ( ctx != NULL ) ? EOK : ENOMEM;
+        }
+        else
+        {
+            ctx = varlist_FindSearchContext( clientPID, context );
+            result = ( ctx != NULL ) ? EOK : ENOTSUP;
+        }
 
-            /* set the variable type */
-            pVarStorage->var.type = pVarInfo->var.type;
+        pPage->count = 0;
 
-            /* set the variable length */
-            pVarStorage->var.len = pVarInfo->var.len;
+        while( ( ctx != NULL ) &&
+               ( ( hVar = varlist_NextCandidate( ctx ) ) != VAR_INVALID ) )
+        {
+            pVarID = varlist_HandleVarID( hVar );
+            pVarStorage = pVarID->pVarStorage;
 
-            /* set the variable flags */
-            pVarStorage->flags = pVarInfo->flags;
+            if( ( pVarStorage != NULL ) &&
+                ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) &&
+                ( varlist_Match( pVarID, ctx ) == EOK ) )
+            {
+                rc = varlist_PackRecord( pVarID,
+                                         buf + offset,
+                                         bufsize - offset,
+                                         true,
+                                         &n );
+                if( ( rc == E2BIG ) && ( pPage->count == 0 ) )
+                {
+                    /* send the record without its value */
+                    rc = varlist_PackRecord( pVarID,
+                                             buf + offset,
+                                             bufsize - offset,
+                                             false,
+                                             &n );
+                }
+
+                if( ( rc != EOK ) && ( pPage->count == 0 ) )
+                {
+                    /* the page is too small for any record */
+                    result = E2BIG;
+                    hVar = VAR_INVALID;
+                    break;
+                }
 
-            /* copy the variable format specifier */
-            strncpy( pVarStorage->formatspec,
-                        pVarInfo->formatspec,
-                        MAX_FORMATSPEC_LEN );
-            pVarStorage->formatspec[MAX_FORMATSPEC_LEN-1] = 0;
+                if( rc != EOK )
+                {
+                    /* the page is full, resume from this variable */
+                    ctx->cursor--;
+                    break;
+                }
 
-            /* set the variable permissions */
-            pVarStorage->permissions = pVarInfo->permissions;
+                offset += n;
+                pPage->count++;
+            }
 
-            /* copy the variable value */
-            if( ( pVarInfo->var.type != VARTYPE_STR ) &&
-                ( pVarInfo->var.type != VARTYPE_BLOB ) )
+            if( ++examined >= VARLIST_PAGE_SLICE )
             {
-                pVarStorage->var.val  = pVarInfo->var.val;
+                /* yield, and resume from the next candidate */
+                break;
             }
+        }
 
-            /* set the variable tags */
-            result = TAGLIST_Parse( pVarInfo->tagspec,
-                                    pVarStorage->tags,
-                                    MAX_TAGS_LEN );
+        pPage->size = offset;
+
+        if( ctx == NULL )
+        {
+            *response = 0;
+        }
+        else if( hVar == VAR_INVALID )
+        {
+            /* the search is complete */
+            varlist_DeleteSearchContext( ctx );
+            *response = 0;
+        }
+        else
+        {
+            *response = ctx->contextId;
         }
     }
 
     return result;
-
 }
 
 /*============================================================================*/
-/*  assign_BlobVarInfo                                                        */
+/*  varlist_PackRecord                                                        */
 /*!
-    Copy the blob variable info from the VarInfo object to the VarStorage object
+    Pack a variable into a page of query results
 
-    The assign_BlobVarInfo function copies the blob variable information from
-    the specified VarInfo object into the specified VarStorage object.
+    The varlist_PackRecord function writes a VarQueryRecord for the
+    specified variable into the page buffer.  The value is omitted
+    (and the record result is set to indicate that it must be retrieved
+    separately) if the variable is calculated or has a PRINT handler,
+    or if withValue is false.  Password values are never included.
 
-    VarStorage <- VarInfo
+    @param[in]
+        pVarID
+            pointer to the variable to pack
 
-    It allocates memory for the blob data
+    @param[out]
+        buf
+            pointer to the location in the page to write the record
 
     @param[in]
-        pVarStorage
-            Pointer to the destination VarStorage object
+        len
+            space remaining in the page
 
     @param[in]
-        pVarInfo
-            Pointer to the source VarInfo object
+        withValue
+            true to include string values in the record
 
-    @retval EOK the variable information was successfully assigned
-    @retval ENOMEM memory allocation failure
-    @retval ENOTSUP zero length blob specified or invalid type specified
-    @retval EINVAL invalid arguments
+    @param[out]
+        pSize
+            pointer to a location to store the size of the packed record
+
+    @retval EOK the record was packed
+    @retval E2BIG there is not enough space for the record
 
 ==============================================================================*/
-static int assign_BlobVarInfo( VarStorage *pVarStorage, VarInfo *pVarInfo )
+static int varlist_PackRecord( VarID *pVarID,
+                               char *buf,
+                               size_t len,
+                               bool withValue,
+                               size_t *pSize )
 {
-    int result = EINVAL;
+    int result = EOK;
+    VarStorage *pVarStorage = pVarID->pVarStorage;
+    VarQueryRecord *pRecord = (VarQueryRecord *)buf;
+    size_t nameLen = strlen( pVarID->name ) + 1;
+    size_t formatLen = strnlen( pVarStorage->pMeta->formatspec,
+                                MAX_FORMATSPEC_LEN - 1 ) + 1;
+    size_t valueLen = 0;
+    size_t size;
+    char *p;
+    int rc = EOK;
 
-    if ( ( pVarStorage != NULL ) &&
-         ( pVarInfo != NULL ) )
+    if( pVarStorage->notifyMask & ( NOTIFY_MASK_CALC | NOTIFY_MASK_PRINT ) )
     {
-        if ( pVarInfo->var.type == VARTYPE_BLOB )
+        /* the value must be requested from its owner */
+        rc = ENOTSUP;
+    }
+    else if( pVarStorage->flags & VARFLAG_PASSWORD )
+    {
+        /* password values are never sent */
+    }
+    else if( pVarStorage->var.type == VARTYPE_STR )
+    {
+        if( withValue == true )
         {
-            if( pVarInfo->var.len != 0 )
-            {
-                pVarStorage->var.val.blob = calloc( 1, pVarInfo->var.len );
-                if( pVarStorage->var.val.blob != NULL )
-                {
-                    /* copy the blob */
-                    memcpy( pVarStorage->var.val.blob,
-                             pVarInfo->var.val.blob,
-                             pVarInfo->var.len );
+            valueLen = ( pVarStorage->var.val.str != NULL )
+                        ? strlen( pVarStorage->var.val.str ) + 1
+                        : 0;
+        }
+        else
+        {
+            rc = E2BIG;
+        }
+    }
 
-                    result = EOK;
-                }
-                else
-                {
-                    result = ENOMEM;
-                }
-            }
-            else
-            {
-                result = ENOTSUP;
-            }
+    size = sizeof( VarQueryRecord ) + nameLen + formatLen + valueLen;
+    size = ( size + VARQUERY_RECORD_ALIGN - 1 ) &
+           ~( (size_t)VARQUERY_RECORD_ALIGN - 1 );
 
+    if( size <= len )
+    {
+        memset( pRecord, 0, sizeof( VarQueryRecord ) );
+        pRecord->size = size;
+        pRecord->result = rc;
+        pRecord->hVar = pVarID->hVar;
+        pRecord->instanceID = pVarID->instanceID;
+        pRecord->flags = pVarStorage->flags;
+        pRecord->var.type = pVarStorage->var.type;
+        pRecord->var.len = pVarStorage->var.len;
+
+        if( ( rc == EOK ) &&
+            ( pVarStorage->var.type != VARTYPE_STR ) &&
+            ( pVarStorage->var.type != VARTYPE_BLOB ) &&
+            ( ( pVarStorage->flags & VARFLAG_PASSWORD ) == 0 ) )
+        {
+            pRecord->var.val = pVarStorage->var.val;
         }
-        else
+
+        p = pRecord->name;
+        memcpy( p, pVarID->name, nameLen );
+        p += nameLen;
+
+        pRecord->formatOffset = p - buf;
+        memcpy( p, pVarStorage->pMeta->formatspec, formatLen - 1 );
+        p[formatLen - 1] = 0;
+        p += formatLen;
+
+        if( valueLen > 0 )
         {
-            result = ENOTSUP;
+            pRecord->valueOffset = p - buf;
+            memcpy( p, pVarStorage->var.val.str, valueLen );
         }
+
+        *pSize = size;
+    }
+    else
+    {
+        result = E2BIG;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  assign_StringVarInfo                                                      */
+/*  varlist_NewSearchContext                                                  */
 /*!
-    Copy the string var info from the VarInfo object to the VarStorage object
+    Create a new search context for a client
 
-    The assign_StringVarInfo function copies the string variable information
-    from the specified VarInfo object into the specified VarStorage object.
+    The varlist_NewSearchContext function searches through the
+    search contexts of the variable server, looking for one which is
+    unused.  If none is found, a new one is created.
 
-    VarStorage <- VarInfo
+    The search context contains all the details of the requested search
 
-    It allocates memory for the string
+    @param[in]
+        clientPID
+            process identifier of the client requesting the search context
 
     @param[in]
-        pVarStorage
-            Pointer to the destination VarStorage object
+        searchType
+            integer specifing the search type, containing one or more of
+            the following flags:
+               QUERY_REGEX
+               QUERY_MATCH
+               QUERY_FLAGS
+               QUERY_TAGS
+               QUERY_INSTANCEID
+               QUERY_PREFIX
 
     @param[in]
         pVarInfo
-            Pointer to the source VarInfo object
+            pointer to the variable info to search for
 
-    @retval EOK the variable information was successfully assigned
-    @retval ENOMEM memory allocation failure
-    @retval ENOTSUP zero length string specified or invalid type specified
-    @retval EINVAL invalid arguments
+    @param[in]
+        searchText
+            pointer to the regex search text
+
+    @retval pointer to the created search context
+    @retval NULL if the requested search context does not exist
 
 ==============================================================================*/
-static int assign_StringVarInfo( VarStorage *pVarStorage, VarInfo *pVarInfo )
+static SearchContext *varlist_NewSearchContext( pid_t clientPID,
+                                                int searchType,
+                                                VarInfo *pVarInfo,
+                                                char *searchText )
 {
-    int result = EINVAL;
+    SearchContext **pp = &pSearchContexts;
+    SearchContext *p = NULL;
 
-    if ( ( pVarStorage != NULL ) &&
-         ( pVarInfo != NULL ) )
+    pthread_mutex_lock( &searchContextLock );
+
+    /* find an unused pre-existing context */
+    while( *pp != NULL )
     {
-        if ( pVarInfo->var.type == VARTYPE_STR )
+        if( (*pp)->contextId == 0 )
         {
-            if( pVarInfo->var.len != 0 )
-            {
-                /* allocate memroy for the string */
-                pVarStorage->var.val.str = calloc( 1, pVarInfo->var.len );
-                if( pVarStorage->var.val.str != NULL )
-                {
-                    /* copy the string */
-                    strncpy( pVarStorage->var.val.str,
-                             pVarInfo->var.val.str,
-                             pVarInfo->var.len );
+            p = *pp;
+            break;
+        }
 
-                    pVarStorage->var.val.str[ pVarInfo->var.len-1 ] = 0;
+        pp = &((*pp)->pNext);
+    }
 
-                    result = EOK;
-                }
-                else
-                {
-                    result = ENOMEM;
-                }
-            }
-            else
-            {
-                result = ENOTSUP;
-            }
-        }
-        else
+    if ( p == NULL )
+    {
+        /* allocate a new search context */
+        p = calloc( 1, sizeof( SearchContext ) );
+        *pp = p;
+
+        if ( p != NULL )
         {
-            result = ENOTSUP;
+            STATS_MemAlloc( STATS_MEM_SEARCH_CONTEXTS,
+                            1,
+                            sizeof( SearchContext ) );
         }
     }
 
-    return result;
+    if( p != NULL )
+    {
+        /* claim the context */
+        ++contextIdent;
+        p->contextId = contextIdent;
+        p->clientPID = clientPID;
+    }
+
+    pthread_mutex_unlock( &searchContextLock );
+
+    /* populate the search context */
+    if( p != NULL )
+    {
+        varlist_InitSearchContext( p,
+                                   clientPID,
+                                   searchType,
+                                   pVarInfo,
+                                   searchText );
+    }
+
+    return p;
 }
 
 /*============================================================================*/
-/*  VARLIST_GetFirst                                                          */
+/*  varlist_InitSearchContext                                                 */
 /*!
-    Handle a get_first request from a client
+    Populate the query parameters of a search context
 
-    The VARLIST_GetFirst function handles a get_first request from a
-    client.  It searches through the variable list to find the first
-    variable which matches the search critera.
+    The varlist_InitSearchContext function copies the query parameters
+    from the client request into the specified search context and resets
+    its search position.
+
+    @param[in,out]
+        p
+            pointer to the search context to populate
 
     @param[in]
         clientPID
-            the process identifier of the requesting client
+            process identifier of the client which owns the search
 
     @param[in]
         searchType
-            search type bitfield containing one or more of the
-            following search type bits:
-                QUERY_REGEX
-                QUERY_MATCH
-                QUERY_IMATCH
-                QUERY_FLAGS
-                QUERY_TAGS
+            integer specifing the search type (QUERY_xxx flags)
 
-    @param[in,out]
+    @param[in]
         pVarInfo
-            Pointer to the variable definition containing the search criteria
-
-    @param[out]
-        buf
-            pointer to the buffer (for returning string values)
+            pointer to the variable info to search for
 
     @param[in]
-        bufsize
-            specifies the size of the buffer (and therefore
-            the maximum string length that can be retrieved).
-
-    @param[in,out]
-        context
-            pointer to a location to store the search context
-
-    @retval EOK the variable get_first request was handled
-    @retval EINVAL invalid arguments
-    @retval ENOENT no variable matching the search criteria was found
-    @retval ENOMEM no search contexts available
+        searchText
+            pointer to the search text
 
 ==============================================================================*/
-int VARLIST_GetFirst( pid_t clientPID,
-                      int searchType,
-                      VarInfo *pVarInfo,
-                      char *buf,
-                      size_t bufsize,
-                      int *context )
+static void varlist_InitSearchContext( SearchContext *p,
+                                       pid_t clientPID,
+                                       int searchType,
+                                       VarInfo *pVarInfo,
+                                       char *searchText )
 {
-    int result = EINVAL;
-    VAR_HANDLE hVar;
-    SearchContext *ctx;
-    VarStorage *pVarStorage = NULL;
-    VarID *pVarID;
-
-    if( ( pVarInfo != NULL ) &&
-        ( buf != NULL ) &&
-        ( context != NULL ) )
-    {
-        hVar = 1;
-        result = ENOENT;
-
-        /* create a new search context */
-        ctx = varlist_NewSearchContext( clientPID,
-                                        searchType,
-                                        pVarInfo,
-                                        buf );
-        if( ctx != NULL )
-        {
-            /* search through the variable list */
-            while( ( hVar < VARSERVER_MAX_VARIABLES ) &&
-                   ( hVar <= (VAR_HANDLE)varcount ) )
-            {
-                pVarID = &varstore[hVar];
-                if ( pVarID != NULL )
-                {
-                    /* get a pointer to the storage for this variable */
-                    pVarStorage = pVarID->pVarStorage;
-                }
-
-                if ( ( pVarStorage != NULL ) &&
-                     ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
-                {
-                    if( varlist_Match( pVarID, ctx ) == EOK )
-                    {
-                        /* copy the name */
-                        memcpy( pVarInfo->name,
-                                pVarID->name,
-                                MAX_NAME_LEN+1 );
-
-                        /* copy the instanceID */
-                        pVarInfo->instanceID = pVarID->instanceID;
+    p->clientPID = clientPID;
+    p->query.instanceID = pVarInfo->instanceID;
+    p->query.flags = pVarInfo->flags;
+    p->query.type = searchType;
+    memcpy(&(p->query.tagspec), &(pVarInfo->tagspec), MAX_TAGSPEC_LEN );
+    p->query.match = strdup( searchText );
+    p->indexed = false;
+    p->numCandidates = 0;
+    p->cursor = 0;
+    memset( p->tags, 0, sizeof( p->tags ) );
+    TAGLIST_Parse( pVarInfo->tagspec,
+                   p->tags,
+                   MAX_TAGS_LEN );
+}
 
-                        /* copy the format specifier */
-                        memcpy( pVarInfo->formatspec,
-                                pVarStorage->formatspec,
-                                MAX_FORMATSPEC_LEN );
+/*============================================================================*/
+/*  varlist_DeleteSearchContext                                               */
+/*!
+    Delete a search context which is no longer needed
 
-                        /* store the variable context id */
-                        *context = ctx->contextId;
+    The varlist_DeleteSearchContext function clears any resources
+    used by the search context and makes it available for use
+    by a new client
 
-                        /* store the last variable found */
-                        ctx->hVar = hVar;
+    @param[in]
+        ctx
+            pointer to the search context to delete
 
-                        /* get the variable value */
-                        pVarInfo->hVar = hVar;
-                        result = VARLIST_GetByHandle( clientPID,
-                                                      pVarInfo,
-                                                      buf,
-                                                      bufsize );
-                        break;
-                    }
-                }
+    @retval EOK search context deleted
+    @retval EINVAL invalid arguments
 
-                hVar++;
-            }
+==============================================================================*/
+static int varlist_DeleteSearchContext( SearchContext *ctx )
+{
+    int result = EINVAL;
 
-            if( result == ENOENT )
-            {
-                /* nothing found - remove the search context */
-                varlist_DeleteSearchContext( ctx );
-                *context = 0;
-            }
+    if( ctx != NULL )
+    {
+        if( ctx->query.match != NULL )
+        {
+            free( ctx->query.match );
+            ctx->query.match = NULL;
         }
-        else
+
+        if( ctx->pCandidates != NULL )
         {
-            *context = 0;
-            result = ENOMEM;
+            free( ctx->pCandidates );
+            ctx->pCandidates = NULL;
+            STATS_MemFree( STATS_MEM_SEARCH_CONTEXTS,
+                           0,
+                           ctx->maxCandidates * sizeof( VAR_HANDLE ) );
         }
+
+        ctx->numCandidates = 0;
+        ctx->maxCandidates = 0;
+        ctx->query.flags = 0;
+        memset( ctx->query.tagspec, 0, MAX_TAGSPEC_LEN );
+        ctx->query.type = 0;
+
+        /* release the context for re-use */
+        pthread_mutex_lock( &searchContextLock );
+        ctx->contextId = 0;
+        ctx->clientPID = -1;
+        pthread_mutex_unlock( &searchContextLock );
+
+        result = EOK;
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  VARLIST_GetNext                                                           */
+/*  varlist_FindSearchContext                                                 */
 /*!
-    Handle a get_next request from a client
+    Find the specified search context for the client
 
-    The VARLIST_GetNext function handles a get_next request from a
-    client.  It searches through the variable list to find the next
-    variable which matches the search critera in the specified search
-    context
+    The varlist_FindSearchContext function searches through the
+    search contexts of the variable server, looking for one which is
+    owned by the specified client, with the specified context identifier
 
     @param[in]
         clientPID
-            the process identifier of the requesting client
+            process identifier of the client requesting the search context
 
     @param[in]
         context
-            pointer to the search context identifier
+            identifier of the search context to find
 
-    @param[in,out]
-        pVarInfo
-            Pointer to the data structure which will receive the
-            variable value
+    @retval pointer to the requested search context
+    @retval NULL if the requested search context does not exist
 
-    @param[out]
-        buf
-            pointer to the buffer (for returning string values)
+==============================================================================*/
+static SearchContext *varlist_FindSearchContext( pid_t clientPID,
+                                                 int context )
+{
+    SearchContext *p;
+
+    pthread_mutex_lock( &searchContextLock );
+
+    p = pSearchContexts;
+    while( p != NULL )
+    {
+        if( ( p->contextId == context ) &&
+            ( p->clientPID == clientPID ) )
+        {
+            /* found it */
+            break;
+        }
+
+        p = p->pNext;
+    }
+
+    pthread_mutex_unlock( &searchContextLock );
+
+    return p;
+}
+
+/*============================================================================*/
+/*  varlist_Match                                                             */
+/*!
+    Match a variable against query parameters
+
+    The varlist_Match function checks if the specified variable
+    matches the query conditions in the specified search context
 
     @param[in]
-        bufsize
-            specifies the size of the buffer (and therefore
-            the maximum string length that can be retrieved).
+        pVarID
+            pointer to the variable to match
 
-    @param[in,out]
-       response
-            pointer to a location to store the response value
+    @param[in]
+        ctx
+            search context containing the search parameters
 
-    @retval EOK the variable get_first request was handled
+    @retval EOK the variable was successfully matched against the search context
     @retval EINVAL invalid arguments
-    @retval ENOENT no variable matching the search criteria was found
-    @retval ENOMEM no search contexts available
+    @retval ENOENT the variable did not match the search context
 
 ==============================================================================*/
-int VARLIST_GetNext( pid_t clientPID,
-                     int context,
-                     VarInfo *pVarInfo,
-                     char *buf,
-                     size_t bufsize,
-                     int *response )
+static int varlist_Match( VarID *pVarID, SearchContext *ctx )
 {
     int result = EINVAL;
-    VAR_HANDLE hVar;
-    SearchContext *ctx;
     VarStorage *pVarStorage = NULL;
-    VarID *pVarID;
+    int searchtype;
+    bool found = false;
+    bool match;
 
-    /* get the search context */
-    ctx = varlist_FindSearchContext( clientPID, context );
-    if ( ctx != NULL )
+    if ( ( ctx != NULL ) &&
+         ( pVarID != NULL ) )
     {
-        result = ENOENT;
+        /* get a pointer to the variable storage for this variable */
+        pVarStorage = pVarID->pVarStorage;
+        if ( pVarStorage != NULL )
+        {
+            found = true;
 
-        ctx->hVar++;
-        hVar = ctx->hVar;
+            searchtype = ctx->query.type;
 
-        /* search through the variable list looking for a match */
-        while( ( hVar < VARSERVER_MAX_VARIABLES ) &&
-               ( hVar <= (VAR_HANDLE)varcount ) )
-        {
-            pVarID = &varstore[hVar];
-            if ( pVarID != NULL )
+            /* dont find hidden variables in vars queries */
+            if( pVarStorage->flags & VARFLAG_HIDDEN )
             {
-                /* get a pointer to the storage for this variable */
-                pVarStorage = pVarID->pVarStorage;
+                found = false;
             }
 
-            if ( ( pVarStorage != NULL ) &&
-                 ( varlist_CheckReadPermissions( pVarInfo, pVarID ) ) )
+            /* name matching */
+            if( searchtype & QUERY_MATCH )
             {
-                /* check if the current variable matches the search criteria */
-                if( varlist_Match( pVarID, ctx ) == EOK )
-                {
-                    /* copy the name */
-                    memcpy( pVarInfo->name, pVarID->name, MAX_NAME_LEN+1 );
-
-                    /* copy the instanceID */
-                    pVarInfo->instanceID = pVarID->instanceID;
+                found &= (strcasestr(pVarID->name, ctx->query.match) != NULL );
+            }
 
-                    /* copy the format specifier */
-                    memcpy( pVarInfo->formatspec,
-                            pVarStorage->formatspec,
-                            MAX_FORMATSPEC_LEN );
+            /* name prefix matching */
+            if( searchtype & QUERY_PREFIX )
+            {
+                found &= ( strncasecmp( pVarID->name,
+                                        ctx->query.match,
+                                        strlen( ctx->query.match ) ) == 0 );
+            }
 
-                    /* store the last variable found */
-                    ctx->hVar = hVar;
+            /* regex matching */
+            if( searchtype & QUERY_REGEX )
+            {
+                regex_t regex;
+                regmatch_t match[1];
 
-                    /* get the variable value */
-                    pVarInfo->hVar = hVar;
-                    result = VARLIST_GetByHandle( clientPID,
-                                                pVarInfo,
-                                                buf,
-                                                bufsize );
-                    break;
+                if( regcomp(&regex, ctx->query.match, REG_EXTENDED) == 0 )
+                {
+                    found &= (regexec(&regex, pVarID->name, 1, match, 0) == 0 );
+                    regfree(&regex);
                 }
             }
 
-            hVar++;
-        }
+            /* instance ID matching */
+            if( searchtype & QUERY_INSTANCEID )
+            {
+                found &= (ctx->query.instanceID == pVarID->instanceID );
+            }
 
-        if( result == ENOENT )
-        {
-            /* no more matching variables found */
-            /* delete the search context */
-            varlist_DeleteSearchContext( ctx );
+            /* any flags matching */
+            if( searchtype & QUERY_FLAGS )
+            {
+                match = (ctx->query.flags & pVarStorage->flags ) ? true : false;
 
-            /* indicate end of search */
-            context = 0;
+                if (searchtype & QUERY_NEGATE_FLAGS)
+                {
+                    match = !match;
+                }
+
+                found &= match;
+            }
+
+            /* all tags matching */
+            if ( searchtype & QUERY_TAGS )
+            {
+                if ( varlist_MatchTags( pVarStorage->pMeta->tags, ctx->tags ) == EOK )
+                {
+                    match = true;
+                }
+                else
+                {
+                    match = false;
+                }
+
+                found &= match;
+            }
         }
 
-        /* store the response value */
-        *response = context;
+        result = ( found == true ) ? EOK : ENOENT;
     }
-    else
-    {
-        /* search context does not exist */
-        *response = 0;
 
-        result = ENOTSUP;
+    return result;
+}
+
+/*============================================================================*/
+/*  varlist_NextCandidate                                                     */
+/*!
+    Get the next variable to examine in a search
+
+    The varlist_NextCandidate function advances the search position of the
+    specified search context and returns the handle of the next variable
+    to be matched against the query.  Indexed searches step through the
+    candidates collected by varlist_FindCandidates, all other searches step
+    through the entire variable list.
+
+    @param[in]
+        ctx
+            pointer to the search context
+
+    @retval handle of the next variable to examine
+    @retval VAR_INVALID there are no more variables to examine
+
+==============================================================================*/
+static VAR_HANDLE varlist_NextCandidate( SearchContext *ctx )
+{
+    VAR_HANDLE hVar = VAR_INVALID;
+
+    if( ctx->indexed == true )
+    {
+        if( ctx->cursor < ctx->numCandidates )
+        {
+            hVar = ctx->pCandidates[ctx->cursor++];
+        }
+    }
+    else if( ( ctx->cursor < (size_t)varcount ) &&
+             ( ctx->cursor < maxVariables ) )
+    {
+        hVar = ++ctx->cursor;
     }
 
-    return result;
+    return hVar;
 }
 
 /*============================================================================*/
-/*  varlist_NewSearchContext                                                  */
+/*  varlist_FindCandidates                                                    */
 /*!
-    Create a new search context for a client
-
-    The varlist_NewSearchContext function searches through the
-    search contexts of the variable server, looking for one which is
-    unused.  If none is found, a new one is created.
+    Collect the candidate variables for a search from an index
 
-    The search context contains all the details of the requested search
+    The varlist_FindCandidates function uses the name index for
+    QUERY_PREFIX searches, and the flag and tag index for QUERY_FLAGS
+    and QUERY_TAGS searches, to collect the handles of the variables
+    which may match the search.  The candidates are still checked
+    against the full search criteria by varlist_Match.  Other searches
+    are not indexed and step through the entire variable list.
 
     @param[in]
-        clientPID
-            process identifier of the client requesting the search context
+        ctx
+            pointer to the search context
 
-    @param[in]
-        searchType
-            integer specifing the search type, containing one or more of
-            the following flags:
-               QUERY_REGEX
-               QUERY_MATCH
-               QUERY_FLAGS
-               QUERY_TAGS
-               QUERY_INSTANCEID
+    @retval EOK the candidates were collected (or the search is not indexed)
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int varlist_FindCandidates( SearchContext *ctx )
+{
+    int result = EOK;
+
+    if( ctx->query.type & QUERY_PREFIX )
+    {
+        /* collect the candidates from the name index subtree */
+        ctx->indexed = true;
+        result = RADIX_Walk( ctx->query.match,
+                             varlist_PrefixCandidate,
+                             ctx );
+    }
+    else if( ctx->query.type & ( QUERY_FLAGS | QUERY_TAGS ) )
+    {
+        /* collect the candidates from the flag and tag bitmaps */
+        ctx->indexed = true;
+        result = VARINDEX_Query( ctx->query.type,
+                                 ctx->query.flags,
+                                 ctx->tags,
+                                 MAX_TAGS_LEN,
+                                 varcount,
+                                 varlist_IndexCandidate,
+                                 ctx );
+    }
+
+    return ( result == ENOMEM ) ? ENOMEM : EOK;
+}
+
+/*============================================================================*/
+/*  varlist_AddCandidate                                                      */
+/*!
+    Add a variable to the candidate list of a search context
 
     @param[in]
-        pVarInfo
-            pointer to the variable info to search for
+        ctx
+            pointer to the search context
 
     @param[in]
-        searchText
-            pointer to the regex search text
+        hVar
+            handle of the candidate variable
 
-    @retval pointer to the created search context
-    @retval NULL if the requested search context does not exist
+    @retval EOK the variable was added to the candidate list
+    @retval ENOMEM memory allocation failure
 
 ==============================================================================*/
-static SearchContext *varlist_NewSearchContext( pid_t clientPID,
-                                                int searchType,
-                                                VarInfo *pVarInfo,
-                                                char *searchText )
+static int varlist_AddCandidate( SearchContext *ctx, VAR_HANDLE hVar )
 {
-    SearchContext **pp = &pSearchContexts;
-    SearchContext *p = NULL;
+    int result = EOK;
+    VAR_HANDLE *pCandidates;
+    size_t n;
 
-    /* find an unused pre-existing context */
-    while( *pp != NULL )
+    if( ctx->numCandidates == ctx->maxCandidates )
     {
-        if( (*pp)->contextId == 0 )
+        n = ( ctx->maxCandidates == 0 ) ? 64 : ctx->maxCandidates * 2;
+        pCandidates = realloc( ctx->pCandidates, n * sizeof( VAR_HANDLE ) );
+        if( pCandidates != NULL )
         {
-            p = *pp;
-            break;
+            STATS_MemAlloc( STATS_MEM_SEARCH_CONTEXTS,
+                            0,
+                            ( n - ctx->maxCandidates ) * sizeof( VAR_HANDLE ) );
+            ctx->pCandidates = pCandidates;
+            ctx->maxCandidates = n;
+        }
+        else
+        {
+            result = ENOMEM;
         }
-
-        pp = &((*pp)->pNext);
     }
 
-    if ( p == NULL )
+    if( result == EOK )
     {
-        /* allocate a new search context */
-        p = calloc( 1, sizeof( SearchContext ) );
-        *pp = p;
+        ctx->pCandidates[ctx->numCandidates++] = hVar;
     }
 
-    /* populate the search context */
-    if( p != NULL )
-    {
-        ++contextIdent;
-        p->contextId = contextIdent;
-        p->clientPID = clientPID;
-        p->query.instanceID = pVarInfo->instanceID;
-        p->query.flags = pVarInfo->flags;
-        p->query.type = searchType;
-        memcpy(&(p->query.tagspec), &(pVarInfo->tagspec), MAX_TAGSPEC_LEN );
-        p->query.match = strdup( searchText );
-        TAGLIST_Parse( pVarInfo->tagspec,
-                       p->tags,
-                       MAX_TAGS_LEN );
-    }
+    return result;
+}
 
-    return p;
+/*============================================================================*/
+/*  varlist_PrefixCandidate                                                   */
+/*!
+    Name index walk callback for QUERY_PREFIX searches
+
+    @param[in]
+        object
+            pointer to the VarID of the variable
+
+    @param[in]
+        arg
+            pointer to the search context
+
+    @retval EOK the variable was added to the candidate list
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int varlist_PrefixCandidate( void *object, void *arg )
+{
+    return varlist_AddCandidate( (SearchContext *)arg,
+                                 ((VarID *)object)->hVar );
 }
 
 /*============================================================================*/
-/*  varlist_DeleteSearchContext                                               */
+/*  varlist_IndexCandidate                                                    */
 /*!
-    Delete a search context which is no longer needed
+    Flag and tag index query callback for QUERY_FLAGS and QUERY_TAGS searches
 
-    The varlist_DeleteSearchContext function clears any resources
-    used by the search context and makes it available for use
-    by a new client
+    @param[in]
+        hVar
+            handle of the variable
 
     @param[in]
-        ctx
-            pointer to the search context to delete
+        arg
+            pointer to the search context
 
-    @retval EOK search context deleted
+    @retval EOK the variable was added to the candidate list
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int varlist_IndexCandidate( VAR_HANDLE hVar, void *arg )
+{
+    return varlist_AddCandidate( (SearchContext *)arg, hVar );
+}
+
+/*============================================================================*/
+/*  varlist_MatchTags                                                         */
+/*!
+    Match all tags
+
+    The varlist_MatchTags function checks if all of the tags in the
+    needle list are found in the haystack list.
+
+    @param[in]
+        pHaystack
+            pointer to the list of tags to search
+
+    @param[in]
+        pNeedle
+            pointer to the list of tags to find
+
+    @retval EOK all the tags in the needle list were found in the haystack list
     @retval EINVAL invalid arguments
+    @retval ENOENT one or more of the tags could not be found
 
 ==============================================================================*/
-static int varlist_DeleteSearchContext( SearchContext *ctx )
+static int varlist_MatchTags( uint16_t *pHaystack, uint16_t *pNeedle )
 {
     int result = EINVAL;
+    int i;
+    int j;
+    bool found;
 
-    if( ctx != NULL )
+    if ( ( pHaystack != NULL ) &&
+         ( pNeedle != NULL ) )
     {
-        if( ctx->query.match != NULL )
+        /* assume we have found all needles until we have not */
+        result = EOK;
+
+        /* we must find ALL the needles in the haystack or the search fails */
+        for( i = 0; i < MAX_TAGS_LEN ; i++ )
         {
-            free( ctx->query.match );
-            ctx->query.match = NULL;
-        }
+            if ( pNeedle[i] == 0 )
+            {
+                break;
+            }
 
-        ctx->query.flags = 0;
-        memset( ctx->query.tagspec, 0, MAX_TAGSPEC_LEN );
-        ctx->query.type = 0;
-        ctx->contextId = 0;
-        ctx->clientPID = -1;
+            found = false;
 
-        result = EOK;
+            /* search the haystack for the needle */
+            for ( j = 0; j < MAX_TAGS_LEN; j++ )
+            {
+                if ( pHaystack[j] == 0 )
+                {
+                    break;
+                }
+
+                if ( pHaystack[j] == pNeedle[i] )
+                {
+                    found = true;
+                }
+            }
+
+            /* if the needle is not found, the match fails */
+            if ( found == false )
+            {
+                result = ENOENT;
+            }
+        }
     }
 
     return result;
 }
 
 /*============================================================================*/
-/*  varlist_FindSearchContext                                                 */
+/*  varlist_QueryMatch                                                        */
 /*!
-    Find the specified search context for the client
+    Match a variable against a query subscription
 
-    The varlist_FindSearchContext function searches through the
-    search contexts of the variable server, looking for one which is
-    owned by the specified client, with the specified context identifier
+    The varlist_QueryMatch function checks if the subscribing client
+    can read the specified variable and that it matches the query.
 
     @param[in]
-        clientPID
-            process identifier of the client requesting the search context
+        pSubscription
+            pointer to the query subscription
 
     @param[in]
-        context
-            identifier of the search context to find
+        pVarID
+            pointer to the variable to match
 
-    @retval pointer to the requested search context
-    @retval NULL if the requested search context does not exist
+    @retval true the variable is covered by the query subscription
+    @retval false the variable is not covered by the query subscription
 
 ==============================================================================*/
-static SearchContext *varlist_FindSearchContext( pid_t clientPID,
-                                                 int context )
+static bool varlist_QueryMatch( QuerySubscription *pSubscription,
+                                VarID *pVarID )
 {
-    SearchContext *p = pSearchContexts;
+    bool match = false;
+    uint64_t generation = PERMSETS_Generation();
 
-    while( p != NULL )
+    if ( ( pSubscription->creds.groupset != 0 ) &&
+         ( pSubscription->generation != generation ) )
     {
-        if( ( p->contextId == context ) &&
-            ( p->clientPID == clientPID ) )
-        {
-            /* found it */
-            break;
-        }
+        /* groups have been assigned bits since the subscription */
+        pSubscription->creds.groupset =
+            PERMSETS_Resolve( pSubscription->creds.creds,
+                              pSubscription->creds.ncreds );
+        pSubscription->generation = generation;
+    }
 
-        p = p->pNext;
+    if ( ( pVarID->pVarStorage != NULL ) &&
+         ( varlist_CheckReadPermissions( &pSubscription->creds, pVarID ) ) &&
+         ( varlist_Match( pVarID, &pSubscription->ctx ) == EOK ) )
+    {
+        match = true;
     }
 
-    return p;
+    return match;
 }
 
 /*============================================================================*/
-/*  varlist_Match                                                             */
+/*  varlist_QueryEvaluate                                                     */
 /*!
-    Match a variable against query parameters
+    Evaluate a variable against all of the query subscriptions
 
-    The varlist_Match function checks if the specified variable
-    matches the query conditions in the specified search context
+    The varlist_QueryEvaluate function updates the handle bitmap of every
+    query subscription for a variable which has been created, or whose
+    flags have changed.
 
     @param[in]
         pVarID
-            pointer to the variable to match
-
-    @param[in]
-        ctx
-            search context containing the search parameters
-
-    @retval EOK the variable was successfully matched against the search context
-    @retval EINVAL invalid arguments
-    @retval ENOENT the variable did not match the search context
+            pointer to the variable to evaluate
 
 ==============================================================================*/
-static int varlist_Match( VarID *pVarID, SearchContext *ctx )
+static void varlist_QueryEvaluate( VarID *pVarID )
 {
-    int result = EINVAL;
-    VarStorage *pVarStorage = NULL;
-    int searchtype;
-    bool found = false;
-    bool match;
+    QuerySubscription *p = pQuerySubscriptions;
+    VAR_HANDLE hVar = pVarID->hVar;
+    uint64_t bit = 1ULL << ( hVar % 64 );
 
-    if ( ( ctx != NULL ) &&
-         ( pVarID != NULL ) )
+    while( p != NULL )
     {
-        /* get a pointer to the variable storage for this variable */
-        pVarStorage = pVarID->pVarStorage;
-        if ( pVarStorage != NULL )
+        if( varlist_QueryMatch( p, pVarID ) == true )
         {
-            found = true;
-
-            searchtype = ctx->query.type;
-
-            /* dont find hidden variables in vars queries */
-            if( pVarStorage->flags & VARFLAG_HIDDEN )
-            {
-                found = false;
-            }
-
-            /* name matching */
-            if( searchtype & QUERY_MATCH )
-            {
-                found &= (strcasestr(pVarID->name, ctx->query.match) != NULL );
-            }
+            p->pHandles[hVar / 64] |= bit;
+        }
+        else
+        {
+            p->pHandles[hVar / 64] &= ~bit;
+        }
 
-            /* regex matching */
-            if( searchtype & QUERY_REGEX )
-            {
-                regex_t regex;
-                regmatch_t match[1];
+        p = p->pNext;
+    }
+}
 
-                if( regcomp(&regex, ctx->query.match, REG_EXTENDED) == 0 )
-                {
-                    found &= (regexec(&regex, pVarID->name, 1, match, 0) == 0 );
-                    regfree(&regex);
-                }
-            }
+/*============================================================================*/
+/*  varlist_QueryNotify                                                       */
+/*!
+    Signal the query subscribers of a modified variable
 
-            /* instance ID matching */
-            if( searchtype & QUERY_INSTANCEID )
-            {
-                found &= (ctx->query.instanceID == pVarID->instanceID );
-            }
+    The varlist_QueryNotify function sends a NOTIFY_MODIFIED signal to
+    the owner of every query subscription which covers the modified
+    variable (or one of its aliases).  Subscriptions belonging to clients
+    which no longer exist are removed.
 
-            /* any flags matching */
-            if( searchtype & QUERY_FLAGS )
-            {
-                match = (ctx->query.flags & pVarStorage->flags ) ? true : false;
+    @param[in]
+        pVarStorage
+            pointer to the storage of the modified variable
 
-                if (searchtype & QUERY_NEGATE_FLAGS)
-                {
-                    match = !match;
-                }
+    @param[in]
+        hVar
+            handle of the variable that has been modified
 
-                found &= match;
-            }
+==============================================================================*/
+static void varlist_QueryNotify( VarStorage *pVarStorage, VAR_HANDLE hVar )
+{
+    QuerySubscription **pp = &pQuerySubscriptions;
+    QuerySubscription *p;
+    VAR_HANDLE hNotify;
+    union sigval val;
 
-            /* all tags matching */
-            if ( searchtype & QUERY_TAGS )
-            {
-                if ( varlist_MatchTags( pVarStorage->tags, ctx->tags ) == EOK )
-                {
-                    match = true;
-                }
-                else
-                {
-                    match = false;
-                }
+    while( *pp != NULL )
+    {
+        p = *pp;
 
-                found &= match;
+        hNotify = varlist_QueryHandle( p, pVarStorage, hVar );
+        if( hNotify != VAR_INVALID )
+        {
+            val.sival_int = hNotify;
+            if( ( sigqueue( p->ctx.clientPID, SIGRTMIN+6, val ) != 0 ) &&
+                ( errno == ESRCH ) )
+            {
+                /* the subscriber has gone away */
+                *pp = p->pNext;
+                varlist_DeleteQuerySubscription( p );
+                continue;
             }
         }
 
-        result = ( found == true ) ? EOK : ENOENT;
+        pp = &p->pNext;
     }
-
-    return result;
 }
 
 /*============================================================================*/
-/*  varlist_MatchTags                                                         */
+/*  varlist_QueryHandle                                                       */
 /*!
-    Match all tags
+    Get the handle to notify for a query subscription
 
-    The varlist_MatchTags function checks if all of the tags in the
-    needle list are found in the haystack list.
+    The varlist_QueryHandle function selects the handle of the modified
+    variable to send to a query subscriber.  The modified handle is used
+    if it matches the query, otherwise the first matching alias of the
+    variable storage is used.
 
     @param[in]
-        pHaystack
-            pointer to the list of tags to search
+        pSubscription
+            pointer to the query subscription
 
     @param[in]
-        pNeedle
-            pointer to the list of tags to find
+        pVarStorage
+            pointer to the storage of the modified variable
 
-    @retval EOK all the tags in the needle list were found in the haystack list
-    @retval EINVAL invalid arguments
-    @retval ENOENT one or more of the tags could not be found
+    @param[in]
+        hVar
+            handle of the variable that has been modified
+
+    @retval handle to send to the subscriber
+    @retval VAR_INVALID the subscription does not cover the variable
 
 ==============================================================================*/
-static int varlist_MatchTags( uint16_t *pHaystack, uint16_t *pNeedle )
+static VAR_HANDLE varlist_QueryHandle( QuerySubscription *pSubscription,
+                                       VarStorage *pVarStorage,
+                                       VAR_HANDLE hVar )
 {
-    int result = EINVAL;
-    int i;
-    int j;
-    bool found;
+    VAR_HANDLE hNotify = VAR_INVALID;
+    uint64_t *pHandles = pSubscription->pHandles;
+    VarAlias *pVarAlias;
+    VAR_HANDLE h;
 
-    if ( ( pHaystack != NULL ) &&
-         ( pNeedle != NULL ) )
+    if ( pHandles[hVar / 64] & ( 1ULL << ( hVar % 64 ) ) )
     {
-        /* assume we have found all needles until we have not */
-        result = EOK;
-
-        /* we must find ALL the needles in the haystack or the search fails */
-        for( i = 0; i < MAX_TAGS_LEN ; i++ )
+        hNotify = hVar;
+    }
+    else
+    {
+        pVarAlias = pVarStorage->pMeta->pAliases;
+        while ( ( pVarAlias != NULL ) && ( hNotify == VAR_INVALID ) )
         {
-            if ( pNeedle[i] == 0 )
-            {
-                break;
-            }
-
-            found = false;
-
-            /* search the haystack for the needle */
-            for ( j = 0; j < MAX_TAGS_LEN; j++ )
+            if ( pVarAlias->pVarID != NULL )
             {
-                if ( pHaystack[j] == 0 )
-                {
-                    break;
-                }
-
-                if ( pHaystack[j] == pNeedle[i] )
+                h = pVarAlias->pVarID->hVar;
+                if ( pHandles[h / 64] & ( 1ULL << ( h % 64 ) ) )
                 {
-                    found = true;
+                    hNotify = h;
                 }
             }
 
-            /* if the needle is not found, the match fails */
-            if ( found == false )
-            {
-                result = ENOENT;
-            }
+            pVarAlias = pVarAlias->pNext;
         }
     }
 
-    return result;
+    return hNotify;
+}
+
+/*============================================================================*/
+/*  varlist_DeleteQuerySubscription                                           */
+/*!
+    Release the resources of a query subscription
+
+    @param[in]
+        p
+            pointer to the query subscription to delete.  It must already
+            have been removed from the query subscription list.
+
+==============================================================================*/
+static void varlist_DeleteQuerySubscription( QuerySubscription *p )
+{
+    varlist_DeleteSearchContext( &p->ctx );
+
+    if ( p->pHandles != NULL )
+    {
+        free( p->pHandles );
+        p->pHandles = NULL;
+    }
+
+    free( p );
+
+    STATS_MemFree( STATS_MEM_SEARCH_CONTEXTS,
+                   1,
+                   sizeof( QuerySubscription ) +
+                   VARLIST_QUERY_BITMAP_WORDS * sizeof( uint64_t ) );
 }
 
 /*============================================================================*/
@@ -4760,6 +8903,14 @@ VarObject *VARLIST_GetObj( VAR_HANDLE hVar )
         pVarStorage = pVarID->pVarStorage;
         if ( pVarStorage != NULL )
         {
+            /* the caller will modify the value directly so it cannot
+               be published in the shared value segment */
+            pVarStorage->directAccess = true;
+
+            /* changes to the value are not tracked, so it cannot be
+               cached by clients */
+            VARVERSIONS_SetCacheable( pVarStorage->storageRef, false );
+
             pVarObject = &pVarStorage->var;
         }
     }
@@ -4767,6 +8918,89 @@ VarObject *VARLIST_GetObj( VAR_HANDLE hVar )
     return pVarObject;
 }
 
+/*============================================================================*/
+/*  VARLIST_PeekObj                                                           */
+/*!
+    Get a read only pointer to a variable's VarObject
+
+    The VARLIST_PeekObj function gets a pointer to the VarObject of the
+    specified variable so its value can be read in place.  Unlike
+    VARLIST_GetObj it does not mark the value as directly modified.
+
+    @param[in]
+        hVar
+            handle of the variable to get
+
+    @retval pointer to the variable's VarObject
+    @retval NULL if the variable does not exist
+
+==============================================================================*/
+const VarObject *VARLIST_PeekObj( VAR_HANDLE hVar )
+{
+    VarID *pVarID;
+    const VarObject *pVarObject = NULL;
+
+    pVarID = varlist_HandleVarID( hVar );
+    if ( ( pVarID != NULL ) &&
+         ( pVarID->pVarStorage != NULL ) )
+    {
+        pVarObject = &pVarID->pVarStorage->var;
+    }
+
+    return pVarObject;
+}
+
+/*============================================================================*/
+/*  varlist_VisitNotification                                                 */
+/*!
+    Pass a notification registration to a VARLIST_ForEachNotification
+    function
+
+    The varlist_VisitNotification function adds the lifetime of the
+    calculated values, which is held with the variable rather than the
+    notification, to the options of a NOTIFY_CALC registration.
+
+    @param[in]
+        hVar
+            handle of the variable the notification was requested on
+
+    @param[in]
+        type
+            notification type
+
+    @param[in]
+        pid
+            process identifier of the notification client
+
+    @param[in]
+        pOptions
+            pointer to the notification subscription options
+
+    @param[in]
+        arg
+            pointer to the NotificationVisit context
+
+    @retval result of the VARLIST_ForEachNotification function
+
+==============================================================================*/
+static int varlist_VisitNotification( VAR_HANDLE hVar,
+                                      NotificationType type,
+                                      pid_t pid,
+                                      const VarNotifyOptions *pOptions,
+                                      void *arg )
+{
+    NotificationVisit *pVisit = (NotificationVisit *)arg;
+    VarNotifyOptions options = *pOptions;
+
+    if ( ( type == NOTIFY_CALC ) &&
+         ( options.flags & NOTIFY_OPT_CACHE_TTL ) )
+    {
+        options.cacheTTL_ms = pVisit->calcTTL / 1000000ULL;
+    }
+
+    return pVisit->fn( hVar, type, pid, &options, pVisit->arg );
+}
+
 /*============================================================================*/
 /*  varlist_GetNotificationPayload                                            */
 /*!
@@ -4835,6 +9069,7 @@ static void *varlist_GetNotificationPayload( VAR_HANDLE hVar,
             {
                 /* copy the string to the notification */
                 strcpy( p, pVarStorage->var.val.str );
+                *size = sizeof(VarNotification) + n + 1;
             }
             else
             {
@@ -4882,14 +9117,9 @@ static void *varlist_GetNotificationPayload( VAR_HANDLE hVar,
 static bool varlist_CheckReadPermissions( VarInfo *pVarInfo,
                                           VarID *pVarID )
 {
-    register size_t n;
-    register size_t m;
-    register size_t i;
-    register size_t j;
-    register bool access = false;
-    register gid_t *p;
-    register gid_t *q;
+    bool access = false;
     VarStorage *pVarStorage = NULL;
+    VarMeta *pMeta;
 
     if ( pVarID != NULL )
     {
@@ -4899,28 +9129,11 @@ static bool varlist_CheckReadPermissions( VarInfo *pVarInfo,
     if ( ( pVarInfo != NULL ) &&
          ( pVarStorage != NULL ) )
     {
-        n = pVarInfo->ncreds;
-        m = pVarStorage->permissions.nreads;
-        p = pVarInfo->creds;
-        q = pVarStorage->permissions.read;
-
-        for(i = 0 ; i < n && !access ; i++ )
-        {
-            if ( ( p[i] == 0 ) || ( p[i] == varserver_uid ) )
-            {
-                access = true;
-            }
-            else
-            {
-                for( j = 0; j < m && !access ; j++ )
-                {
-                    if ( p[i] == q[j])
-                    {
-                        access = true;
-                    }
-                }
-            }
-        }
+        pMeta = pVarStorage->pMeta;
+        access = varlist_CheckPermissionSet( pVarInfo,
+                                             pMeta->readSet,
+                                             pMeta->permissions.read,
+                                             pMeta->permissions.nreads );
     }
 
     return access;
@@ -4952,14 +9165,9 @@ static bool varlist_CheckReadPermissions( VarInfo *pVarInfo,
 static bool varlist_CheckWritePermissions( VarInfo *pVarInfo,
                                            VarID *pVarID )
 {
-    register size_t n;
-    register size_t m;
-    register size_t i;
-    register size_t j;
-    register bool access = false;
-    register gid_t *p;
-    register gid_t *q;
+    bool access = false;
     VarStorage *pVarStorage;
+    VarMeta *pMeta;
 
     if ( ( pVarInfo != NULL ) &&
          ( pVarID != NULL ) )
@@ -4969,35 +9177,137 @@ static bool varlist_CheckWritePermissions( VarInfo *pVarInfo,
         {
             /* client group IDs are always in the varInfo read list
             even when checking for write permissions */
-            n = pVarInfo->ncreds;
-            m = pVarStorage->permissions.nwrites;
-            p = pVarInfo->creds;
-            q = pVarStorage->permissions.write;
+            pMeta = pVarStorage->pMeta;
+            access = varlist_CheckPermissionSet( pVarInfo,
+                                                 pMeta->writeSet,
+                                                 pMeta->permissions.write,
+                                                 pMeta->permissions.nwrites );
+        }
+    }
+
+    return access;
+}
+
+/*============================================================================*/
+/*  varlist_CheckPermissionSet                                                */
+/*!
+    Check a client's credentials against a variable permission list
+
+    The varlist_CheckPermissionSet function intersects the permission
+    set resolved for the client with the permission set of the variable
+    permission list.  The group identifiers are compared one by one
+    only when both sets include a group which has no bit of its own,
+    or when the credentials were not resolved by the server, as for
+    requests generated internally.
+
+    @param[in]
+        pVarInfo
+            pointer to the VarInfo request containing the client's
+            credentials
+
+    @param[in]
+        set
+            permission set of the variable permission list
+
+    @param[in]
+        q
+            pointer to the variable permission list
+
+    @param[in]
+        m
+            number of group identifiers in the variable permission list
+
+    @retval true the client has permission
+    @retval false the client does not have permission
+
+==============================================================================*/
+static bool varlist_CheckPermissionSet( VarInfo *pVarInfo,
+                                        uint64_t set,
+                                        gid_t *q,
+                                        size_t m )
+{
+    register size_t n;
+    register size_t i;
+    register size_t j;
+    register bool access = false;
+    register gid_t *p;
+    uint64_t groupset = pVarInfo->groupset;
+
+    if ( ( groupset & PERMSET_PRIVILEGED ) ||
+         ( groupset & set & PERMSET_GROUPS ) )
+    {
+        access = true;
+    }
+    else if ( ( groupset == 0 ) ||
+              ( groupset & set & PERMSET_OVERFLOW ) )
+    {
+        n = pVarInfo->ncreds;
+        p = pVarInfo->creds;
 
-            for(i = 0 ; i < n && !access ; i++ )
+        for(i = 0 ; i < n && !access ; i++ )
+        {
+            if ( ( p[i] == 0 ) || ( p[i] == varserver_uid ) )
             {
-                if ( ( p[i] == 0 ) || ( p[i] == varserver_uid ) )
-                {
-                    access = true;
-                }
-                else
+                access = true;
+            }
+            else
+            {
+                for( j = 0; j < m && !access ; j++ )
                 {
-                    for( j = 0; j < m && !access ; j++ )
+                    if ( p[i] == q[j])
                     {
-                        if ( p[i] == q[j])
-                        {
-                            access = true;
-                        }
+                        access = true;
                     }
                 }
             }
-
         }
     }
 
     return access;
 }
 
+/*============================================================================*/
+/*  VARLIST_SetGeneration                                                     */
+/*!
+    Set the name resolution generation counter
+
+    The VARLIST_SetGeneration function specifies the location of the
+    name resolution generation counter which is published to clients.
+    The counter is incremented whenever an alias is moved to a
+    different variable.
+
+    @param[in]
+        pCounter
+            pointer to the generation counter
+
+==============================================================================*/
+void VARLIST_SetGeneration( uint64_t *pCounter )
+{
+    pGeneration = pCounter;
+}
+
+/*============================================================================*/
+/*  VARLIST_SetReadOnly                                                       */
+/*!
+    Mark the calling thread as a read-only request worker
+
+    The VARLIST_SetReadOnly function indicates whether the calling thread
+    processes read-only requests concurrently with other threads.  Such
+    a thread does not modify the variable store.  Requests which would
+    need to modify it (for example a GET which must signal a CALC
+    handler) fail with EWOULDBLOCK so they can be completed by the
+    main thread.
+
+    @param[in]
+        readOnly
+            true if the calling thread is a read-only request worker
+
+==============================================================================*/
+void VARLIST_SetReadOnly( bool readOnly )
+{
+    readOnlyThread = readOnly;
+}
+
 /*============================================================================*/
 /*  VARLIST_SetUser                                                           */
 /*!
@@ -5042,10 +9352,10 @@ static VarID *varlist_GetVarID( VarInfo *pVarInfo )
     {
         hVar = pVarInfo->hVar;
 
-        if( ( hVar < VARSERVER_MAX_VARIABLES ) &&
+        if( ( hVar > 0 ) &&
             ( hVar <= (VAR_HANDLE)varcount ) )
         {
-            pVarID = &varstore[hVar];
+            pVarID = varlist_HandleVarID( hVar );
         }
     }
 
@@ -0,0 +1,299 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup varversions varversions
+ * @brief Shared memory variable version segment
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file varversions.c
+
+    Shared Variable Versions
+
+    The Shared Variable Versions module publishes a modification counter
+    for every variable storage in a read-only shared memory segment
+    ( /varserver_versions ).  The counter is incremented each time the
+    variable value is changed, so a client which holds a cached copy of
+    a value can check that it is still current without a round trip
+    to the server.
+
+    Variable handles are mapped to storage references, so aliases
+    share the version of the variable they refer to.  Variables whose
+    values are calculated, or modified directly outside of VARLIST_Set,
+    are marked with the VARVERSION_UNCACHEABLE flag.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <varserver/varclient.h>
+#include "varversions.h"
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! pointer to the shared variable version segment */
+static VarVersions *pVarVersions = NULL;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  VARVERSIONS_Init                                                          */
+/*!
+    Create the shared variable version segment
+
+    The VARVERSIONS_Init function creates the /varserver_versions shared
+    memory object and maps it into the server's address space.
+
+    The versions left by a previous server are normally discarded.  A
+    server which restores the same variable store from the warm standby
+    arena keeps them instead, so a version never goes backwards and a
+    value cached by a client before the restart is never mistaken for
+    a later value with the same version.
+
+    @param[in]
+        shard
+            shard index of the server, which is appended to the name
+            of the shared memory object
+
+    @param[in]
+        keep
+            true to keep the versions left by a previous server
+
+    @retval EOK the shared version segment was created
+    @retval ENOMEM the shared version segment could not be mapped
+    @retval other error from shm_open or ftruncate
+
+==============================================================================*/
+int VARVERSIONS_Init( int shard, bool keep )
+{
+    int result = EINVAL;
+    int fd;
+    void *p;
+    char name[BUFSIZ];
+
+    /* get the name of the shared memory object for this shard */
+    ShardName( name, sizeof( name ), SERVER_VARVERSIONS, shard );
+
+    /* get shared memory file descriptor (NOT a file) */
+    fd = shm_open( name, O_RDWR | O_CREAT, S_IRUSR | S_IWUSR );
+    if ( fd != -1 )
+    {
+        /* extend shared memory object as it is initialized with size 0 */
+        if ( ftruncate( fd, sizeof( VarVersions ) ) != -1 )
+        {
+            /* map shared memory to process address space */
+            p = mmap( NULL,
+                      sizeof( VarVersions ),
+                      PROT_READ | PROT_WRITE,
+                      MAP_SHARED,
+                      fd,
+                      0 );
+            if ( p != MAP_FAILED )
+            {
+                /* discard the versions left over from a previous server
+                   unless its variable store is being resumed */
+                pVarVersions = (VarVersions *)p;
+                if ( keep == false )
+                {
+                    memset( pVarVersions, 0, sizeof( VarVersions ) );
+                }
+                result = EOK;
+            }
+            else
+            {
+                result = ENOMEM;
+            }
+        }
+        else
+        {
+            result = errno;
+        }
+
+        /* close the file descriptor since we don't need it for anything */
+        close( fd );
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARVERSIONS_Map                                                           */
+/*!
+    Map a variable handle to its storage version
+
+    The VARVERSIONS_Map function publishes the mapping between a variable
+    handle and the storage reference whose version it reports.  A new
+    storage reference starts at version 1.  A storage reference of 0
+    removes the mapping so the variable cannot be cached.
+
+    @param[in]
+        hVar
+            handle of the variable to map
+
+    @param[in]
+        storageRef
+            storage reference of the variable value
+
+    @retval EOK the mapping was published
+    @retval ENOTSUP the shared version segment is not available
+    @retval ERANGE the handle or storage reference is out of range
+
+==============================================================================*/
+int VARVERSIONS_Map( VAR_HANDLE hVar, uint32_t storageRef )
+{
+    int result = ENOTSUP;
+
+    if ( pVarVersions != NULL )
+    {
+        if ( ( hVar < VARSERVER_MAX_VERSIONED_HANDLES ) &&
+             ( storageRef < VARSERVER_MAX_VERSIONED_HANDLES ) )
+        {
+            if ( pVarVersions->version[storageRef] == 0 )
+            {
+                __atomic_store_n( &pVarVersions->version[storageRef],
+                                  1,
+                                  __ATOMIC_RELEASE );
+            }
+
+            __atomic_store_n( &pVarVersions->index[hVar],
+                              storageRef,
+                              __ATOMIC_RELEASE );
+            result = EOK;
+        }
+        else
+        {
+            result = ERANGE;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  VARVERSIONS_Increment                                                     */
+/*!
+    Increment the version of a variable storage
+
+    The VARVERSIONS_Increment function is called every time a variable
+    value changes to invalidate any copies of the value cached by
+    clients.  The counter skips 0 when it wraps, and the
+    VARVERSION_UNCACHEABLE flag is preserved.
+
+    @param[in]
+        storageRef
+            storage reference of the modified variable
+
+==============================================================================*/
+void VARVERSIONS_Increment( uint32_t storageRef )
+{
+    uint32_t version;
+    uint32_t count;
+
+    if ( ( pVarVersions != NULL ) &&
+         ( storageRef != 0 ) &&
+         ( storageRef < VARSERVER_MAX_VERSIONED_HANDLES ) )
+    {
+        version = pVarVersions->version[storageRef];
+        count = ( version + 1 ) & ~VARVERSION_UNCACHEABLE;
+        if ( count == 0 )
+        {
+            count = 1;
+        }
+
+        __atomic_store_n( &pVarVersions->version[storageRef],
+                          ( version & VARVERSION_UNCACHEABLE ) | count,
+                          __ATOMIC_RELEASE );
+    }
+}
+
+/*============================================================================*/
+/*  VARVERSIONS_SetCacheable                                                  */
+/*!
+    Allow or prevent client caching of a variable value
+
+    The VARVERSIONS_SetCacheable function sets or clears the
+    VARVERSION_UNCACHEABLE flag on the specified variable storage.
+    The version is also incremented so any value cached before the
+    change is discarded.
+
+    @param[in]
+        storageRef
+            storage reference of the variable
+
+    @param[in]
+        cacheable
+            true if clients may cache the value, false if they may not
+
+==============================================================================*/
+void VARVERSIONS_SetCacheable( uint32_t storageRef, bool cacheable )
+{
+    uint32_t version;
+
+    if ( ( pVarVersions != NULL ) &&
+         ( storageRef != 0 ) &&
+         ( storageRef < VARSERVER_MAX_VERSIONED_HANDLES ) )
+    {
+        version = pVarVersions->version[storageRef];
+        if ( cacheable == true )
+        {
+            version &= ~VARVERSION_UNCACHEABLE;
+        }
+        else
+        {
+            version |= VARVERSION_UNCACHEABLE;
+        }
+
+        __atomic_store_n( &pVarVersions->version[storageRef],
+                          version,
+                          __ATOMIC_RELEASE );
+
+        VARVERSIONS_Increment( storageRef );
+    }
+}
+
+/*! @}
+ * end of varversions group */
@@ -0,0 +1,522 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup workers workers
+ * @brief Read-only request worker pool
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file workers.c
+
+    Read-only Request Workers
+
+    The Read-only Request Workers module runs a pool of threads which
+    process read-only client requests (such as GET, FIND and INFO)
+    concurrently with each other.  Requests which modify the variable
+    store are still processed, one at a time, on the main server thread.
+
+    The variable store is protected by a reader/writer lock.  Workers
+    hold the read lock while they process a request, and the main
+    thread holds the write lock while it processes anything which
+    can modify the store.  The lock prefers writers, so a steady stream
+    of reads cannot starve the main thread.
+
+    A worker which finds that it cannot complete a request without
+    modifying the store (for example a GET of a variable with a CALC
+    handler) hands the request back to the main thread via the deferred
+    request queue.  The main thread is woken using an eventfd.
+
+    When the pool has no workers the lock functions do nothing, and
+    every request is processed on the main thread as before.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <unistd.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/eventfd.h>
+#include <varserver/varclient.h>
+#include "varlist.h"
+#include "workers.h"
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! number of entries in the request queues.  Each client has at most
+    one request in flight, so this never fills if it is at least the
+    maximum number of clients */
+#define WORKERS_QUEUE_SIZE  ( 4096 )
+
+/*==============================================================================
+        Private types
+==============================================================================*/
+
+/*! the WorkQueue object is a bounded queue of client requests */
+typedef struct _WorkQueue
+{
+    /*! mutex protecting the queue */
+    pthread_mutex_t mutex;
+
+    /*! condition signalled when a request is queued */
+    pthread_cond_t cond;
+
+    /*! index of the next request to remove */
+    size_t head;
+
+    /*! number of queued requests */
+    size_t count;
+
+    /*! queued clients */
+    VarClient *clients[WORKERS_QUEUE_SIZE];
+
+} WorkQueue;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static void *workers_Thread( void *arg );
+static int workers_Push( WorkQueue *pQueue, VarClient *pVarClient );
+static VarClient *workers_Pop( WorkQueue *pQueue, bool wait );
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! number of worker threads */
+static size_t numWorkers = 0;
+
+/*! read-only request handler */
+static void (*workerFn)( VarClient *pVarClient ) = NULL;
+
+/*! variable store reader/writer lock */
+static pthread_rwlock_t storeLock;
+
+/*! requests waiting for a worker */
+static WorkQueue requestQueue = { .mutex = PTHREAD_MUTEX_INITIALIZER,
+                                  .cond = PTHREAD_COND_INITIALIZER };
+
+/*! requests handed back to the main thread */
+static WorkQueue deferredQueue = { .mutex = PTHREAD_MUTEX_INITIALIZER,
+                                   .cond = PTHREAD_COND_INITIALIZER };
+
+/*! eventfd used to wake the main thread for deferred requests */
+static int deferredFd = -1;
+
+/*==============================================================================
+        Public function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  WORKERS_Init                                                              */
+/*!
+    Start the read-only request workers
+
+    The WORKERS_Init function creates the store lock and the deferred
+    request eventfd, and starts the worker threads.  It must be called
+    after the server signal mask has been set up, so the workers inherit
+    it and never receive the server's signals.
+
+    @param[in]
+        n
+            number of worker threads to start
+
+    @param[in]
+        fn
+            pointer to the function used to process a read-only request
+
+    @retval EOK the workers were started
+    @retval EINVAL invalid arguments
+    @retval other error from pthread or eventfd
+
+==============================================================================*/
+int WORKERS_Init( size_t n, void (*fn)( VarClient *pVarClient ) )
+{
+    int result = EINVAL;
+    pthread_rwlockattr_t attr;
+    pthread_t thread;
+    size_t i;
+
+    if ( ( n > 0 ) &&
+         ( fn != NULL ) )
+    {
+        workerFn = fn;
+
+        pthread_rwlockattr_init( &attr );
+        pthread_rwlockattr_setkind_np( &attr,
+                            PTHREAD_RWLOCK_PREFER_WRITER_NONRECURSIVE_NP );
+        result = pthread_rwlock_init( &storeLock, &attr );
+        pthread_rwlockattr_destroy( &attr );
+
+        if ( result == EOK )
+        {
+            deferredFd = eventfd( 0, EFD_NONBLOCK | EFD_CLOEXEC );
+            if ( deferredFd == -1 )
+            {
+                result = errno;
+            }
+        }
+
+        for ( i = 0; ( result == EOK ) && ( i < n ); i++ )
+        {
+            result = pthread_create( &thread, NULL, workers_Thread, NULL );
+            if ( result == EOK )
+            {
+                pthread_detach( thread );
+                numWorkers++;
+            }
+        }
+
+        if ( numWorkers > 0 )
+        {
+            /* run with the workers we have */
+            result = EOK;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WORKERS_Count                                                             */
+/*!
+    Get the number of read-only request workers
+
+    @retval number of running worker threads
+
+==============================================================================*/
+size_t WORKERS_Count( void )
+{
+    return numWorkers;
+}
+
+/*============================================================================*/
+/*  WORKERS_Submit                                                            */
+/*!
+    Queue a read-only request for a worker
+
+    The WORKERS_Submit function queues the specified client's request
+    to be processed by one of the worker threads.
+
+    @param[in]
+        pVarClient
+            pointer to the client whose request is to be processed
+
+    @retval EOK the request was queued
+    @retval ENOTSUP there are no worker threads
+    @retval ENOSPC the request queue is full
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int WORKERS_Submit( VarClient *pVarClient )
+{
+    int result = ENOTSUP;
+
+    if ( numWorkers > 0 )
+    {
+        result = workers_Push( &requestQueue, pVarClient );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WORKERS_Defer                                                             */
+/*!
+    Hand a request back to the main thread
+
+    The WORKERS_Defer function is called by a worker which cannot
+    complete a request without modifying the variable store.  The
+    request is queued for the main thread, which is woken via the
+    deferred request eventfd.
+
+    @param[in]
+        pVarClient
+            pointer to the client whose request is to be deferred
+
+    @retval EOK the request was deferred
+    @retval ENOSPC the deferred request queue is full
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+int WORKERS_Defer( VarClient *pVarClient )
+{
+    int result;
+    uint64_t one = 1;
+
+    result = workers_Push( &deferredQueue, pVarClient );
+    if ( result == EOK )
+    {
+        if ( write( deferredFd, &one, sizeof( one ) ) != sizeof( one ) )
+        {
+            /* the counter is already non-zero so the main thread
+               will be woken anyway */
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WORKERS_GetDeferredFd                                                     */
+/*!
+    Get the deferred request eventfd
+
+    The WORKERS_GetDeferredFd function gets the eventfd which becomes
+    readable when requests have been handed back to the main thread.
+
+    @retval file descriptor of the eventfd
+    @retval -1 there are no worker threads
+
+==============================================================================*/
+int WORKERS_GetDeferredFd( void )
+{
+    return deferredFd;
+}
+
+/*============================================================================*/
+/*  WORKERS_NextDeferred                                                      */
+/*!
+    Get the next request handed back to the main thread
+
+    The WORKERS_NextDeferred function removes the next request from the
+    deferred request queue.  It clears the eventfd first, so a request
+    deferred while the queue is being drained wakes the main thread
+    again.
+
+    @retval pointer to the client whose request was deferred
+    @retval NULL there are no more deferred requests
+
+==============================================================================*/
+VarClient *WORKERS_NextDeferred( void )
+{
+    uint64_t count;
+
+    if ( read( deferredFd, &count, sizeof( count ) ) != sizeof( count ) )
+    {
+        /* nothing was signalled since the last read */
+    }
+
+    return workers_Pop( &deferredQueue, false );
+}
+
+/*============================================================================*/
+/*  WORKERS_ReadLock                                                          */
+/*!
+    Acquire shared read access to the variable store
+
+==============================================================================*/
+void WORKERS_ReadLock( void )
+{
+    if ( numWorkers > 0 )
+    {
+        pthread_rwlock_rdlock( &storeLock );
+    }
+}
+
+/*============================================================================*/
+/*  WORKERS_ReadUnlock                                                        */
+/*!
+    Release shared read access to the variable store
+
+==============================================================================*/
+void WORKERS_ReadUnlock( void )
+{
+    if ( numWorkers > 0 )
+    {
+        pthread_rwlock_unlock( &storeLock );
+    }
+}
+
+/*============================================================================*/
+/*  WORKERS_WriteLock                                                         */
+/*!
+    Acquire exclusive access to the variable store
+
+    The WORKERS_WriteLock function waits for any worker requests in
+    progress to complete, and prevents new ones from starting until
+    WORKERS_WriteUnlock is called.
+
+==============================================================================*/
+void WORKERS_WriteLock( void )
+{
+    if ( numWorkers > 0 )
+    {
+        pthread_rwlock_wrlock( &storeLock );
+    }
+}
+
+/*============================================================================*/
+/*  WORKERS_WriteUnlock                                                       */
+/*!
+    Release exclusive access to the variable store
+
+==============================================================================*/
+void WORKERS_WriteUnlock( void )
+{
+    if ( numWorkers > 0 )
+    {
+        pthread_rwlock_unlock( &storeLock );
+    }
+}
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  workers_Thread                                                            */
+/*!
+    Worker thread main loop
+
+    The workers_Thread function waits for read-only requests and
+    processes them using the worker function.
+
+    @param[in]
+        arg
+            unused
+
+    @retval NULL (the function never returns)
+
+==============================================================================*/
+static void *workers_Thread( void *arg )
+{
+    VarClient *pVarClient;
+
+    (void)arg;
+
+    /* this thread may only look at the variable store */
+    VARLIST_SetReadOnly( true );
+
+    for ( ;; )
+    {
+        pVarClient = workers_Pop( &requestQueue, true );
+        if ( pVarClient != NULL )
+        {
+            workerFn( pVarClient );
+        }
+    }
+
+    return NULL;
+}
+
+/*============================================================================*/
+/*  workers_Push                                                              */
+/*!
+    Add a client request to a work queue
+
+    @param[in]
+        pQueue
+            pointer to the queue to add the request to
+
+    @param[in]
+        pVarClient
+            pointer to the client whose request is queued
+
+    @retval EOK the request was queued
+    @retval ENOSPC the queue is full
+    @retval EINVAL invalid arguments
+
+==============================================================================*/
+static int workers_Push( WorkQueue *pQueue, VarClient *pVarClient )
+{
+    int result = EINVAL;
+
+    if ( pVarClient != NULL )
+    {
+        pthread_mutex_lock( &pQueue->mutex );
+
+        if ( pQueue->count < WORKERS_QUEUE_SIZE )
+        {
+            pQueue->clients[( pQueue->head + pQueue->count ) %
+                            WORKERS_QUEUE_SIZE] = pVarClient;
+            pQueue->count++;
+            pthread_cond_signal( &pQueue->cond );
+            result = EOK;
+        }
+        else
+        {
+            result = ENOSPC;
+        }
+
+        pthread_mutex_unlock( &pQueue->mutex );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  workers_Pop                                                               */
+/*!
+    Remove a client request from a work queue
+
+    @param[in]
+        pQueue
+            pointer to the queue to remove the request from
+
+    @param[in]
+        wait
+            true to wait for a request if the queue is empty
+
+    @retval pointer to the client whose request was removed
+    @retval NULL the queue is empty
+
+==============================================================================*/
+static VarClient *workers_Pop( WorkQueue *pQueue, bool wait )
+{
+    VarClient *pVarClient = NULL;
+
+    pthread_mutex_lock( &pQueue->mutex );
+
+    while( ( wait == true ) && ( pQueue->count == 0 ) )
+    {
+        pthread_cond_wait( &pQueue->cond, &pQueue->mutex );
+    }
+
+    if ( pQueue->count > 0 )
+    {
+        pVarClient = pQueue->clients[pQueue->head];
+        pQueue->head = ( pQueue->head + 1 ) % WORKERS_QUEUE_SIZE;
+        pQueue->count--;
+    }
+
+    pthread_mutex_unlock( &pQueue->mutex );
+
+    return pVarClient;
+}
+
+/*! @}
+ * end of workers group */
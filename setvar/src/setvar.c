@@ -37,6 +37,11 @@ SOFTWARE.
     The Set Variable Application sets the value for the specified
     variable in the variable server
 
+    In streaming mode (-s) the application reads name=value lines from
+    its standard input and sets them over a single connection using
+    batched set requests, so a large number of variables can be
+    provisioned without starting a process per variable.
+
 */
 /*============================================================================*/
 
@@ -75,8 +80,34 @@ typedef struct _set_var_state
     /*! user name */
     char *username;
 
+    /*! read name=value lines from the standard input */
+    bool stream;
+
 } SetVarState;
 
+/*! batch of streamed variable assignments waiting to be sent */
+typedef struct _set_var_batch
+{
+    /*! handles of the variables to set */
+    VAR_HANDLE hVars[VARSERVER_MAX_BATCH_ITEMS];
+
+    /*! values of the variables to set */
+    VarObject objs[VARSERVER_MAX_BATCH_ITEMS];
+
+    /*! per-variable results */
+    int results[VARSERVER_MAX_BATCH_ITEMS];
+
+    /*! input lines holding the variable names and string values */
+    char *lines[VARSERVER_MAX_BATCH_ITEMS];
+
+    /*! number of assignments in the batch */
+    size_t n;
+
+    /*! number of assignments which failed */
+    size_t errors;
+
+} SetVarBatch;
+
 /*==============================================================================
         Private file scoped variables
 ==============================================================================*/
@@ -90,6 +121,10 @@ static int ProcessOptions( int argC,
                            SetVarState *pState );
 static void usage( char *name );
 static int SetUser( SetVarState *pState );
+static int SetVarStream( SetVarState *pState );
+static int SetVarAdd( SetVarState *pState, SetVarBatch *pBatch, char *line );
+static int SetVarFlush( SetVarState *pState, SetVarBatch *pBatch );
+static void ReportError( char *name, int result );
 
 /*============================================================================*/
 /*  main                                                                      */
@@ -146,38 +181,23 @@ int main(int argc, char **argv)
                 }
             }
 
-            result = VAR_SetNameValue( state.hVarServer,
-                                       state.varname,
-                                       state.value );
-            if( result != EOK )
+            if ( state.stream == true )
             {
-                switch( result )
-                {
-                    case ENOENT:
-                        fprintf( stderr, "Variable not found\n" );
-                        break;
-
-                    case EACCES:
-                        fprintf( stderr, "writes not allowed\n" );
-                        break;
-
-                    case ENOTSUP:
-                        fprintf( stderr, "Operation not supported\n" );
-                        break;
-
-                    case E2BIG:
-                        fprintf( stderr, "Value exceeds max variable length\n");
-                        break;
-
-                    default:
-                        fprintf(stderr, "SETVAR: %s\n", strerror( result ) );
-                        break;
-
-                }
+                result = SetVarStream( &state );
             }
             else
             {
-                printf("OK\n");
+                result = VAR_SetNameValue( state.hVarServer,
+                                           state.varname,
+                                           state.value );
+                if( result != EOK )
+                {
+                    ReportError( NULL, result );
+                }
+                else
+                {
+                    printf("OK\n");
+                }
             }
 
             if ( userChanged == true )
@@ -224,7 +244,7 @@ static int ProcessOptions( int argC,
 {
     int c;
     int result = EINVAL;
-    const char *options = "hvu:";
+    const char *options = "hvsu:";
     int errcount = 0;
     bool display_help = false;
 
@@ -243,6 +263,10 @@ static int ProcessOptions( int argC,
                     pState->username = optarg;
                     break;
 
+                case 's':
+                    pState->stream = true;
+                    break;
+
                 case 'h':
                     display_help = true;
                     break;
@@ -254,7 +278,11 @@ static int ProcessOptions( int argC,
             }
         }
 
-        if ( optind < argC - 1)
+        if ( pState->stream == true )
+        {
+            result = EOK;
+        }
+        else if ( optind < argC - 1)
         {
             pState->varname = argV[optind++];
             pState->value = argV[optind];
@@ -298,9 +326,11 @@ static void usage( char *name )
 {
     if( name != NULL )
     {
-        printf("usage: %s [-h] [-v] [-u <user>] varname value", name );
+        printf("usage: %s [-h] [-v] [-u <user>] varname value\n", name );
+        printf("       %s [-h] [-v] [-u <user>] -s\n", name );
         printf("-h : display this help\n");
         printf("-v : enable verbose (debugging) output\n");
+        printf("-s : read name=value lines from standard input\n");
         printf("-u : set user name\n");
     }
 }
@@ -350,5 +380,276 @@ static int SetUser( SetVarState *pState )
     return result;
 }
 
+/*============================================================================*/
+/*  SetVarStream                                                              */
+/*!
+    Set variables from the standard input
+
+    The SetVarStream function reads name=value lines from the standard
+    input and sets the named variables in batches of up to
+    VARSERVER_MAX_BATCH_ITEMS per request.  Empty lines and lines
+    starting with '#' are ignored.  An error is reported for each
+    line which could not be applied, and the remaining lines are
+    still processed.
+
+    @param[in]
+        pState
+            pointer to the SetVarState object
+
+    @retval EOK all of the variables were set
+    @retval ENOMEM memory allocation failed
+    @retval EINVAL one or more variables could not be set
+
+==============================================================================*/
+static int SetVarStream( SetVarState *pState )
+{
+    int result = EINVAL;
+    SetVarBatch *pBatch;
+    char *line;
+    size_t len;
+
+    pBatch = calloc( 1, sizeof( SetVarBatch ) );
+    if ( pBatch != NULL )
+    {
+        result = EOK;
+
+        do
+        {
+            line = NULL;
+            len = 0;
+            if ( getline( &line, &len, stdin ) == -1 )
+            {
+                free( line );
+                line = NULL;
+            }
+            else if ( SetVarAdd( pState, pBatch, line ) != EOK )
+            {
+                free( line );
+            }
+
+            if ( ( pBatch->n == VARSERVER_MAX_BATCH_ITEMS ) ||
+                 ( ( line == NULL ) && ( pBatch->n > 0 ) ) )
+            {
+                if ( SetVarFlush( pState, pBatch ) == ENOMEM )
+                {
+                    result = ENOMEM;
+                }
+            }
+        } while ( ( line != NULL ) && ( result == EOK ) );
+
+        if ( ( result == EOK ) && ( pBatch->errors > 0 ) )
+        {
+            result = EINVAL;
+        }
+        else if ( ( result == EOK ) && ( pState->verbose == true ) )
+        {
+            printf("OK\n");
+        }
+
+        /* release any lines left behind by an aborted stream */
+        while ( pBatch->n > 0 )
+        {
+            free( pBatch->lines[--pBatch->n] );
+        }
+
+        free( pBatch );
+    }
+    else
+    {
+        result = ENOMEM;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetVarAdd                                                                 */
+/*!
+    Add a name=value line to the current batch
+
+    The SetVarAdd function parses a name=value line, looks up the
+    variable and converts the value to the variable's type, and adds
+    the assignment to the batch.  The batch takes ownership of the
+    line, which holds the variable name and the value of string
+    variables, until the batch is flushed.
+
+    @param[in]
+        pState
+            pointer to the SetVarState object
+
+    @param[in]
+        pBatch
+            pointer to the batch to add the assignment to
+
+    @param[in]
+        line
+            pointer to the line read from the standard input
+
+    @retval EOK the assignment was added to the batch
+    @retval ENODATA the line is empty or a comment
+    @retval EINVAL the line is not a name=value line
+    @retval ENOENT the variable was not found
+    @retval other error converting the value
+
+==============================================================================*/
+static int SetVarAdd( SetVarState *pState, SetVarBatch *pBatch, char *line )
+{
+    int result = EINVAL;
+    VAR_HANDLE hVar;
+    VarType type;
+    VarObject *pVarObject;
+    char *value;
+
+    /* strip the line terminator */
+    line[strcspn( line, "\r\n" )] = '\0';
+
+    if ( ( line[0] == '\0' ) || ( line[0] == '#' ) )
+    {
+        result = ENODATA;
+    }
+    else if ( ( value = strchr( line, '=' ) ) == NULL )
+    {
+        ReportError( line, EINVAL );
+        pBatch->errors++;
+    }
+    else
+    {
+        *value++ = '\0';
+
+        hVar = VAR_FindByName( pState->hVarServer, line );
+        if ( hVar == VAR_INVALID )
+        {
+            result = ENOENT;
+        }
+        else
+        {
+            result = VAR_GetType( pState->hVarServer, hVar, &type );
+        }
+
+        if ( result == EOK )
+        {
+            /* clear the object so no stale string buffer is reused */
+            pVarObject = &pBatch->objs[pBatch->n];
+            memset( pVarObject, 0, sizeof( VarObject ) );
+            result = VAROBJECT_CreateFromString( value,
+                                                 type,
+                                                 pVarObject,
+                                                 VAROBJECT_OPTION_NONE );
+        }
+
+        if ( result == EOK )
+        {
+            pBatch->hVars[pBatch->n] = hVar;
+            pBatch->lines[pBatch->n] = line;
+            pBatch->n++;
+        }
+        else
+        {
+            ReportError( line, result );
+            pBatch->errors++;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetVarFlush                                                               */
+/*!
+    Send the current batch of assignments to the variable server
+
+    The SetVarFlush function sets all of the variables in the batch
+    with a single batched set request, reports the assignments which
+    failed, and empties the batch.
+
+    @param[in]
+        pState
+            pointer to the SetVarState object
+
+    @param[in]
+        pBatch
+            pointer to the batch to send
+
+    @retval EOK all of the variables in the batch were set
+    @retval other the result of the first variable which failed
+
+==============================================================================*/
+static int SetVarFlush( SetVarState *pState, SetVarBatch *pBatch )
+{
+    int result;
+    size_t i;
+
+    result = VAR_SetMany( pState->hVarServer,
+                          pBatch->hVars,
+                          pBatch->objs,
+                          pBatch->results,
+                          pBatch->n );
+
+    for ( i = 0; i < pBatch->n; i++ )
+    {
+        if ( pBatch->results[i] != EOK )
+        {
+            ReportError( pBatch->lines[i], pBatch->results[i] );
+            pBatch->errors++;
+        }
+
+        free( pBatch->lines[i] );
+        pBatch->lines[i] = NULL;
+    }
+
+    pBatch->n = 0;
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ReportError                                                               */
+/*!
+    Report a failure to set a variable
+
+    The ReportError function describes the result of a failed set
+    request on the standard error stream.
+
+    @param[in]
+        name
+            name of the variable, or NULL to omit it from the message
+
+    @param[in]
+        result
+            the result of the set request
+
+==============================================================================*/
+static void ReportError( char *name, int result )
+{
+    if ( name != NULL )
+    {
+        fprintf( stderr, "%s: ", name );
+    }
+
+    switch( result )
+    {
+        case ENOENT:
+            fprintf( stderr, "Variable not found\n" );
+            break;
+
+        case EACCES:
+            fprintf( stderr, "writes not allowed\n" );
+            break;
+
+        case ENOTSUP:
+            fprintf( stderr, "Operation not supported\n" );
+            break;
+
+        case E2BIG:
+            fprintf( stderr, "Value exceeds max variable length\n");
+            break;
+
+        default:
+            fprintf(stderr, "SETVAR: %s\n", strerror( result ) );
+            break;
+
+    }
+}
+
 /*! @}
  * end of setvar group */
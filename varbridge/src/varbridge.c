@@ -0,0 +1,3249 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup varbridge varbridge
+ * @brief Replicate variables to peer variable servers
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file varbridge.c
+
+    Variable replication bridge
+
+    The varbridge Application mirrors a query-selected set of variables
+    to the variable servers on other nodes.  It subscribes to queued
+    modified notifications for the selected variables, and streams the
+    changes over TCP links to the bridges running on its peers, which
+    apply them using batched sets.  A bridge can send to several peers
+    and receive from several peers at the same time.
+
+    The changes are coalesced for each link: a variable which changes
+    several times before the link is ready to send only has its most
+    recent value sent.  Each link allows a limited window of frames to
+    be waiting for acknowledgement, and stops sending (while continuing
+    to coalesce) when the window is full or the socket is not writable.
+
+    When a link connects (or reconnects) the sending bridge sends the
+    names of the variables it replicates, followed by a snapshot of
+    their definitions and values in the variable server snapshot file
+    format.  The receiving bridge creates any variables it does not
+    have and sets the others to the snapshot values.
+
+    All of the frame fields and delta values are in network byte order.
+    The snapshot image is sent in the snapshot file format of the
+    sending host, and is rejected by a receiver with a different byte
+    order.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <limits.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <time.h>
+#include <signal.h>
+#include <netdb.h>
+#include <mqueue.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/signalfd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <varserver/varserver.h>
+#include <varserver/varclient.h>
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! bridge frame identifier ("VB") */
+#define BRIDGE_MAGIC ( 0x5642 )
+
+/*! bridge protocol version */
+#define BRIDGE_VERSION ( 1 )
+
+/*! length of an encoded frame header */
+#define BRIDGE_FRAME_LEN ( 12 )
+
+/*! maximum length of a frame payload */
+#define BRIDGE_MAX_FRAME ( 16 * 1024 * 1024 )
+
+/*! maximum number of outgoing links */
+#define BRIDGE_MAX_LINKS ( 8 )
+
+/*! maximum number of incoming peer connections */
+#define BRIDGE_MAX_PEERS ( 8 )
+
+/*! maximum number of variables in a delta frame */
+#define BRIDGE_BATCH_SIZE ( 256 )
+
+/*! default number of unacknowledged frames on a link */
+#define BRIDGE_DEFAULT_WINDOW ( 4 )
+
+/*! default interval over which changes are coalesced (ms) */
+#define BRIDGE_DEFAULT_INTERVAL_MS ( 20 )
+
+/*! interval between reconnection attempts (ms) */
+#define BRIDGE_RECONNECT_MS ( 1000 )
+
+/*! size of the variable server working buffer */
+#define BRIDGE_WORKBUF_SIZE ( 256 * 1024 )
+
+/*! amount of data read from a socket at a time */
+#define BRIDGE_READ_SIZE ( 64 * 1024 )
+
+/*! maximum length of a variable name including an instance identifier */
+#define BRIDGE_NAME_LEN ( MAX_NAME_LEN + 16 )
+
+/*! name prefix of the variables created by the server itself */
+#define BRIDGE_SERVER_PREFIX "/varserver/"
+
+/*! bridge frame kinds */
+typedef enum _BridgeFrameKind
+{
+    /*! names of the replicated variables, indexed by delta entries */
+    BRIDGE_FRAME_HELLO = 1,
+
+    /*! snapshot of the replicated variables */
+    BRIDGE_FRAME_SYNC = 2,
+
+    /*! changed variable values */
+    BRIDGE_FRAME_DELTA = 3,
+
+    /*! acknowledgement of all frames up to the sequence number */
+    BRIDGE_FRAME_ACK = 4
+
+} BridgeFrameKind;
+
+/*! The BridgeFrame object is the decoded header of a bridge frame.
+    It is encoded in BRIDGE_FRAME_LEN bytes in network byte order */
+typedef struct _BridgeFrame
+{
+    /*! frame identifier, BRIDGE_MAGIC */
+    uint16_t magic;
+
+    /*! protocol version, BRIDGE_VERSION */
+    uint8_t version;
+
+    /*! BridgeFrameKind */
+    uint8_t kind;
+
+    /*! length of the payload following the header */
+    uint32_t length;
+
+    /*! frame sequence number, or the acknowledged sequence number */
+    uint32_t seq;
+
+} BridgeFrame;
+
+/*! The BridgeBuffer object is a growable byte buffer */
+typedef struct _BridgeBuffer
+{
+    /*! pointer to the buffer data */
+    char *data;
+
+    /*! allocated size of the buffer */
+    size_t size;
+
+    /*! number of bytes in the buffer */
+    size_t len;
+
+    /*! number of bytes already consumed from the buffer */
+    size_t offset;
+
+} BridgeBuffer;
+
+/*! The BridgeVar object is a replicated variable */
+typedef struct _BridgeVar
+{
+    /*! local variable handle */
+    VAR_HANDLE hVar;
+
+    /*! index of the variable in the replicated set */
+    uint32_t index;
+
+    /*! variable name with an instance identifier prefix if it has one */
+    char name[BRIDGE_NAME_LEN];
+
+} BridgeVar;
+
+/*! outgoing link states */
+typedef enum _BridgeLinkState
+{
+    /*! the link is waiting to reconnect */
+    BRIDGE_LINK_DOWN,
+
+    /*! the link is connecting */
+    BRIDGE_LINK_CONNECTING,
+
+    /*! the link is connected */
+    BRIDGE_LINK_UP
+
+} BridgeLinkState;
+
+/*! The BridgeLink object is an outgoing link to a peer bridge */
+typedef struct _BridgeLink
+{
+    /*! peer host name */
+    char *host;
+
+    /*! peer port */
+    char *port;
+
+    /*! socket descriptor */
+    int fd;
+
+    /*! link state */
+    BridgeLinkState state;
+
+    /*! flags indicating which variables are in the pending list */
+    uint8_t *dirty;
+
+    /*! indexes of the variables changed since they were last sent */
+    uint32_t *pending;
+
+    /*! number of entries in the pending list */
+    size_t npending;
+
+    /*! encoded frames waiting to be written */
+    BridgeBuffer out;
+
+    /*! partially received acknowledgement frames */
+    BridgeBuffer in;
+
+    /*! sequence number of the last frame queued */
+    uint32_t seq;
+
+    /*! sequence number of the last frame acknowledged */
+    uint32_t acked;
+
+    /*! time of the next connection attempt (ms) */
+    uint64_t retryTime;
+
+    /*! earliest time the next delta frame can be sent (ms) */
+    uint64_t flushTime;
+
+} BridgeLink;
+
+/*! The BridgePeer object is an incoming connection from a peer bridge */
+typedef struct _BridgePeer
+{
+    /*! socket descriptor, -1 if unused */
+    int fd;
+
+    /*! partially received frames */
+    BridgeBuffer in;
+
+    /*! names of the peer's replicated variables */
+    char (*names)[BRIDGE_NAME_LEN];
+
+    /*! local handles of the peer's replicated variables */
+    VAR_HANDLE *hVars;
+
+    /*! number of entries in the name table */
+    uint32_t count;
+
+    /*! sequence number of the last frame applied */
+    uint32_t seq;
+
+    /*! an acknowledgement is waiting to be sent */
+    bool ackPending;
+
+} BridgePeer;
+
+/*! varbridge state object used to customize the behavior of the
+    application */
+typedef struct _var_bridge_state
+{
+    /*! handle to the variable server */
+    VARSERVER_HANDLE hVarServer;
+
+    /*! query type of the variable selection */
+    int searchType;
+
+    /*! name, prefix or regular expression of the variable selection */
+    char *match;
+
+    /*! tag specification of the variable selection */
+    char *tagspec;
+
+    /*! flags of the variable selection */
+    uint32_t flags;
+
+    /*! instance identifier of the variable selection */
+    uint32_t instanceID;
+
+    /*! replicated variables in index order */
+    BridgeVar *vars;
+
+    /*! replicated variables sorted by name */
+    BridgeVar **byName;
+
+    /*! replicated variables sorted by handle */
+    BridgeVar **byHandle;
+
+    /*! number of replicated variables */
+    size_t nvars;
+
+    /*! outgoing links */
+    BridgeLink links[BRIDGE_MAX_LINKS];
+
+    /*! number of outgoing links */
+    size_t nlinks;
+
+    /*! incoming peer connections */
+    BridgePeer peers[BRIDGE_MAX_PEERS];
+
+    /*! port to listen on for peer connections, NULL for none */
+    char *listenPort;
+
+    /*! listening socket descriptor */
+    int listenfd;
+
+    /*! notification queue descriptor */
+    int mqfd;
+
+    /*! signal descriptor for the queue modified notifications */
+    int sigfd;
+
+    /*! maximum number of messages in the notification queue */
+    long maxmsg;
+
+    /*! notification receive buffer */
+    char *msgbuf;
+
+    /*! size of the notification receive buffer */
+    size_t msgsize;
+
+    /*! buffer for the string and blob values of the notifications */
+    char *valbuf;
+
+    /*! maximum number of unacknowledged frames on a link */
+    uint32_t window;
+
+    /*! interval over which changes are coalesced (ms) */
+    uint32_t interval_ms;
+
+    /*! path of the temporary snapshot file */
+    char snapshotPath[PATH_MAX];
+
+    /*! verbose mode */
+    bool verbose;
+
+} VarBridgeState;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int ProcessOptions( int argC,
+                           char *argV[],
+                           VarBridgeState *pState );
+static void usage( char *name );
+static int AddLink( VarBridgeState *pState, char *peer );
+static int SelectVars( VarBridgeState *pState );
+static int CompareName( const void *p1, const void *p2 );
+static int CompareHandle( const void *p1, const void *p2 );
+static BridgeVar *FindByName( VarBridgeState *pState, const char *name );
+static BridgeVar *FindByHandle( VarBridgeState *pState, VAR_HANDLE hVar );
+static int Listen( VarBridgeState *pState );
+static void Run( VarBridgeState *pState );
+static void DrainQueue( VarBridgeState *pState );
+static void MarkDirty( VarBridgeState *pState, uint32_t index );
+static void MarkAllDirty( BridgeLink *pLink, size_t n );
+static void LinkConnect( VarBridgeState *pState, BridgeLink *pLink );
+static void LinkConnected( VarBridgeState *pState, BridgeLink *pLink );
+static void LinkClose( BridgeLink *pLink );
+static int LinkStart( VarBridgeState *pState, BridgeLink *pLink );
+static int LinkSnapshot( VarBridgeState *pState, BridgeLink *pLink );
+static int LinkFlush( VarBridgeState *pState, BridgeLink *pLink );
+static int LinkRead( BridgeLink *pLink );
+static int LinkWrite( BridgeLink *pLink );
+static void AcceptPeer( VarBridgeState *pState );
+static void PeerClose( BridgePeer *pPeer );
+static int PeerRead( VarBridgeState *pState, BridgePeer *pPeer );
+static int PeerWrite( BridgePeer *pPeer );
+static int ProcessFrame( VarBridgeState *pState,
+                         BridgePeer *pPeer,
+                         BridgeFrame *pFrame,
+                         const char *payload );
+static int ProcessHello( BridgePeer *pPeer,
+                         const char *payload,
+                         uint32_t length );
+static int ProcessSync( VarBridgeState *pState,
+                        BridgePeer *pPeer,
+                        const char *payload,
+                        uint32_t length );
+static int RestoreRecord( VarBridgeState *pState,
+                          const SnapshotRecord *pRecord,
+                          VarObject *pVarObject,
+                          VAR_HANDLE *phVar );
+static int ProcessDelta( VarBridgeState *pState,
+                         BridgePeer *pPeer,
+                         const char *payload,
+                         uint32_t length );
+static void ResolvePeer( VarBridgeState *pState, BridgePeer *pPeer );
+static char *Reserve( BridgeBuffer *pBuf, size_t n );
+static size_t FrameBegin( BridgeBuffer *pBuf );
+static void FrameEnd( BridgeBuffer *pBuf,
+                      size_t start,
+                      uint8_t kind,
+                      uint32_t seq );
+static void Put( char *p, uint64_t value, size_t n );
+static uint64_t Get( const char *p, size_t n );
+static size_t ValueSize( VarType type );
+static int RecordName( const SnapshotRecord *pRecord,
+                       char *buf,
+                       size_t len );
+static const SnapshotRecord *NextRecord( const char *p,
+                                         size_t length,
+                                         size_t *pOffset );
+static uint32_t Checksum( uint32_t hash, const void *p, size_t len );
+static uint64_t Now( void );
+static void SignalHandler( int sig );
+
+/*==============================================================================
+        File scoped variables
+==============================================================================*/
+
+/*! flag cleared by the termination signal handler to stop the bridge */
+static volatile sig_atomic_t running = 1;
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the varbridge application
+
+    The main function starts the varbridge application
+
+    @param[in]
+        argc
+            number of arguments on the command line
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @return none
+
+==============================================================================*/
+int main(int argc, char **argv)
+{
+    VarBridgeState state;
+    int result = EINVAL;
+    size_t i;
+
+    memset( &state, 0, sizeof(VarBridgeState));
+    state.listenfd = -1;
+    state.mqfd = -1;
+    state.sigfd = -1;
+    state.window = BRIDGE_DEFAULT_WINDOW;
+    state.interval_ms = BRIDGE_DEFAULT_INTERVAL_MS;
+    snprintf( state.snapshotPath,
+              sizeof( state.snapshotPath ),
+              "/tmp/varbridge.%d.snap",
+              (int)getpid() );
+
+    for ( i = 0; i < BRIDGE_MAX_PEERS; i++ )
+    {
+        state.peers[i].fd = -1;
+    }
+
+    signal( SIGPIPE, SIG_IGN );
+    signal( SIGINT, SignalHandler );
+    signal( SIGTERM, SignalHandler );
+
+    result = ProcessOptions( argc, argv, &state );
+    if ( result == EOK )
+    {
+        /* get a handle to the VAR server */
+        state.hVarServer = VARSERVER_OpenExt( BRIDGE_WORKBUF_SIZE );
+        if( state.hVarServer != NULL )
+        {
+            if ( state.nlinks > 0 )
+            {
+                result = SelectVars( &state );
+            }
+
+            if ( ( result == EOK ) &&
+                 ( state.listenPort != NULL ) )
+            {
+                result = Listen( &state );
+            }
+
+            if ( result == EOK )
+            {
+                Run( &state );
+            }
+            else
+            {
+                fprintf( stderr, "VARBRIDGE: %s\n", strerror( result ) );
+            }
+
+            /* close the variable server */
+            VARSERVER_Close( state.hVarServer );
+        }
+        else
+        {
+            result = ENOTCONN;
+        }
+    }
+
+    return ( result == EOK ) ? 0 : 1;
+}
+
+/*============================================================================*/
+/*  usage                                                                     */
+/*!
+    Display the application usage
+
+    The usage function dumps the application usage message
+    to stderr.
+
+    @param[in]
+       name
+            pointer to the invoked application name
+
+==============================================================================*/
+static void usage( char *name )
+{
+    if( name != NULL )
+    {
+        fprintf( stderr,
+                 "usage: %s [-h] [-v] [-l port] [-p host:port] "
+                 "[-n name] [-r regex] [-f flags] [-t tags] [-i id] "
+                 "[-w window] [-c ms] [-s path]\n"
+                 " [-h] : display this help\n"
+                 " [-v] : verbose output\n"
+                 " [-l port] : receive changes from peers on this port\n"
+                 " [-p host:port] : send changes to this peer "
+                 "(may be repeated)\n"
+                 " [-n name] : replicate variables matching the name\n"
+                 "             (a name starting with '/' matches a prefix)\n"
+                 " [-r regex] : replicate variables matching the regex\n"
+                 " [-f flags] : replicate variables with these flags\n"
+                 " [-t tags] : replicate variables with these tags\n"
+                 " [-i id] : replicate variables with this instance ID\n"
+                 " [-w window] : unacknowledged frames per link "
+                 "(default %d)\n"
+                 " [-c ms] : change coalescing interval (default %d)\n"
+                 " [-s path] : temporary snapshot file\n",
+                 name,
+                 BRIDGE_DEFAULT_WINDOW,
+                 BRIDGE_DEFAULT_INTERVAL_MS );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessOptions                                                            */
+/*!
+    Process the command line options
+
+    The ProcessOptions function processes the command line options and
+    populates the VarBridgeState object
+
+    @param[in]
+        argC
+            number of arguments
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @return EOK if the options were processed
+    @return EINVAL if the options were invalid
+
+==============================================================================*/
+static int ProcessOptions( int argC,
+                           char *argV[],
+                           VarBridgeState *pState )
+{
+    int c;
+    int result = EINVAL;
+    const char *options = "hvl:p:n:r:f:t:i:w:c:s:";
+
+    if( ( pState != NULL ) &&
+        ( argV != NULL ) )
+    {
+        result = EOK;
+
+        while( ( c = getopt( argC, argV, options ) ) != -1 )
+        {
+            switch( c )
+            {
+                case 'v':
+                    pState->verbose = true;
+                    break;
+
+                case 'l':
+                    pState->listenPort = optarg;
+                    break;
+
+                case 'p':
+                    if ( AddLink( pState, optarg ) != EOK )
+                    {
+                        result = EINVAL;
+                    }
+                    break;
+
+                case 'n':
+                    pState->match = optarg;
+                    pState->searchType |= QUERY_MATCH;
+                    break;
+
+                case 'r':
+                    pState->match = optarg;
+                    pState->searchType |= QUERY_REGEX;
+                    break;
+
+                case 'f':
+                    pState->searchType |= QUERY_FLAGS;
+                    VARSERVER_StrToFlags( optarg, &pState->flags );
+                    break;
+
+                case 't':
+                    pState->searchType |= QUERY_TAGS;
+                    pState->tagspec = optarg;
+                    break;
+
+                case 'i':
+                    pState->searchType |= QUERY_INSTANCEID;
+                    pState->instanceID = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'w':
+                    pState->window = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'c':
+                    pState->interval_ms = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 's':
+                    if ( ( optarg[0] != '/' ) ||
+                         ( strlen( optarg ) >=
+                            sizeof( pState->snapshotPath ) ) )
+                    {
+                        result = EINVAL;
+                    }
+                    else
+                    {
+                        strcpy( pState->snapshotPath, optarg );
+                    }
+                    break;
+
+                case 'h':
+                default:
+                    result = EINVAL;
+                    break;
+            }
+        }
+
+        if ( ( pState->window == 0 ) ||
+             ( ( pState->nlinks == 0 ) && ( pState->listenPort == NULL ) ) )
+        {
+            result = EINVAL;
+        }
+
+        if ( result != EOK )
+        {
+            usage( argV[0] );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AddLink                                                                   */
+/*!
+    Add an outgoing link to a peer bridge
+
+    The AddLink function adds a link to the peer bridge specified
+    as host:port.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        peer
+            peer specification in the form host:port
+
+    @retval EOK the link was added
+    @retval ENOSPC too many links were specified
+    @retval EINVAL the peer specification is invalid
+
+==============================================================================*/
+static int AddLink( VarBridgeState *pState, char *peer )
+{
+    int result = EINVAL;
+    BridgeLink *pLink;
+    char *p;
+
+    p = strrchr( peer, ':' );
+    if ( pState->nlinks >= BRIDGE_MAX_LINKS )
+    {
+        result = ENOSPC;
+    }
+    else if ( ( p != NULL ) &&
+              ( p != peer ) &&
+              ( p[1] != 0 ) )
+    {
+        pLink = &pState->links[pState->nlinks++];
+        *p = 0;
+        pLink->host = peer;
+        pLink->port = p + 1;
+        pLink->fd = -1;
+        pLink->state = BRIDGE_LINK_DOWN;
+        result = EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SelectVars                                                                */
+/*!
+    Select the replicated variables
+
+    The SelectVars function finds the variables which match the
+    selection query, builds the name and handle lookup tables and
+    registers a queued modified notification for each of them.  The
+    server's own variables are never replicated.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @retval EOK the variables were selected
+    @retval ENOENT no variables match the selection
+    @retval ENOMEM memory allocation failure
+    @retval other error creating the notification queue
+
+==============================================================================*/
+static int SelectVars( VarBridgeState *pState )
+{
+    int result;
+    VarQuery query;
+    BridgeVar *pVar;
+    BridgeVar *p;
+    struct mq_attr attr;
+    size_t size = 0;
+    size_t i;
+    int rc;
+
+    memset( &query, 0, sizeof( VarQuery ) );
+    query.type = pState->searchType;
+    query.match = pState->match;
+    query.instanceID = pState->instanceID;
+    query.flags = pState->flags;
+    if ( pState->tagspec != NULL )
+    {
+        strncpy( query.tagspec, pState->tagspec, MAX_TAGSPEC_LEN - 1 );
+    }
+
+    result = VAR_GetFirst( pState->hVarServer, &query, NULL );
+    while ( result == EOK )
+    {
+        if ( strncmp( query.name,
+                      BRIDGE_SERVER_PREFIX,
+                      sizeof( BRIDGE_SERVER_PREFIX ) - 1 ) != 0 )
+        {
+            if ( pState->nvars == size )
+            {
+                size = ( size == 0 ) ? 256 : size * 2;
+                p = realloc( pState->vars, size * sizeof( BridgeVar ) );
+                if ( p == NULL )
+                {
+                    result = ENOMEM;
+                    break;
+                }
+
+                pState->vars = p;
+            }
+
+            pVar = &pState->vars[pState->nvars];
+            pVar->hVar = query.hVar;
+            pVar->index = pState->nvars;
+            if ( query.instanceID != 0 )
+            {
+                snprintf( pVar->name,
+                          sizeof( pVar->name ),
+                          "[%" PRIu32 "]%s",
+                          query.instanceID,
+                          query.name );
+            }
+            else
+            {
+                snprintf( pVar->name, sizeof( pVar->name ), "%s", query.name );
+            }
+
+            pState->nvars++;
+        }
+
+        result = VAR_GetNext( pState->hVarServer, &query, NULL );
+    }
+
+    if ( result == ENOENT )
+    {
+        result = ( pState->nvars > 0 ) ? EOK : ENOENT;
+    }
+
+    if ( result == EOK )
+    {
+        pState->byName = calloc( pState->nvars, sizeof( BridgeVar * ) );
+        pState->byHandle = calloc( pState->nvars, sizeof( BridgeVar * ) );
+        if ( ( pState->byName == NULL ) || ( pState->byHandle == NULL ) )
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if ( result == EOK )
+    {
+        for ( i = 0; i < pState->nvars; i++ )
+        {
+            pState->byName[i] = &pState->vars[i];
+            pState->byHandle[i] = &pState->vars[i];
+        }
+
+        qsort( pState->byName,
+               pState->nvars,
+               sizeof( BridgeVar * ),
+               CompareName );
+        qsort( pState->byHandle,
+               pState->nvars,
+               sizeof( BridgeVar * ),
+               CompareHandle );
+
+        result = VARSERVER_CreateClientQueue( pState->hVarServer, -1, -1 );
+    }
+
+    if ( result == EOK )
+    {
+        pState->mqfd = VARSERVER_ClientQueuefd( pState->hVarServer );
+        if ( ( pState->mqfd != -1 ) &&
+             ( mq_getattr( (mqd_t)pState->mqfd, &attr ) == 0 ) )
+        {
+            pState->maxmsg = attr.mq_maxmsg;
+            pState->msgsize = attr.mq_msgsize;
+            pState->msgbuf = malloc( pState->msgsize + 1 );
+            pState->valbuf = malloc( pState->msgsize );
+        }
+
+        result = ( ( pState->msgbuf != NULL ) &&
+                   ( pState->valbuf != NULL ) ) ? EOK : ENOMEM;
+    }
+
+    if ( result == EOK )
+    {
+        /* the server signals each queued notification */
+        pState->sigfd = VARSERVER_Signalfd( SFD_NONBLOCK | SFD_CLOEXEC );
+        if ( pState->sigfd == -1 )
+        {
+            result = errno;
+        }
+    }
+
+    for ( i = 0; ( result == EOK ) && ( i < pState->nvars ); i++ )
+    {
+        rc = VAR_Notify( pState->hVarServer,
+                         pState->vars[i].hVar,
+                         NOTIFY_MODIFIED_QUEUE );
+        if ( ( rc != EOK ) && ( pState->verbose == true ) )
+        {
+            fprintf( stderr,
+                     "VARBRIDGE: cannot subscribe to %s: %s\n",
+                     pState->vars[i].name,
+                     strerror( rc ) );
+        }
+    }
+
+    if ( ( result == EOK ) && ( pState->verbose == true ) )
+    {
+        printf( "replicating %zu variables\n", pState->nvars );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CompareName                                                               */
+/*!
+    Compare the names of two replicated variables
+
+    The CompareName function is the qsort and bsearch comparison
+    function for the table of replicated variables sorted by name.
+
+    @param[in]
+        p1
+            pointer to the first BridgeVar pointer
+
+    @param[in]
+        p2
+            pointer to the second BridgeVar pointer
+
+    @retval <0, 0, >0 as for strcmp
+
+==============================================================================*/
+static int CompareName( const void *p1, const void *p2 )
+{
+    const BridgeVar *pVar1 = *(BridgeVar * const *)p1;
+    const BridgeVar *pVar2 = *(BridgeVar * const *)p2;
+
+    return strcmp( pVar1->name, pVar2->name );
+}
+
+/*============================================================================*/
+/*  CompareHandle                                                             */
+/*!
+    Compare the handles of two replicated variables
+
+    The CompareHandle function is the qsort and bsearch comparison
+    function for the table of replicated variables sorted by handle.
+
+    @param[in]
+        p1
+            pointer to the first BridgeVar pointer
+
+    @param[in]
+        p2
+            pointer to the second BridgeVar pointer
+
+    @retval -1 the first handle is smaller
+    @retval 0 the handles are equal
+    @retval 1 the first handle is larger
+
+==============================================================================*/
+static int CompareHandle( const void *p1, const void *p2 )
+{
+    const BridgeVar *pVar1 = *(BridgeVar * const *)p1;
+    const BridgeVar *pVar2 = *(BridgeVar * const *)p2;
+
+    return ( pVar1->hVar < pVar2->hVar ) ? -1
+                                         : ( pVar1->hVar > pVar2->hVar );
+}
+
+/*============================================================================*/
+/*  FindByName                                                                */
+/*!
+    Find a replicated variable by name
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        name
+            variable name with an instance identifier prefix if it has one
+
+    @retval pointer to the replicated variable
+    @retval NULL the variable is not replicated
+
+==============================================================================*/
+static BridgeVar *FindByName( VarBridgeState *pState, const char *name )
+{
+    BridgeVar key;
+    BridgeVar *pKey = &key;
+    BridgeVar **ppVar;
+
+    snprintf( key.name, sizeof( key.name ), "%s", name );
+    ppVar = bsearch( &pKey,
+                     pState->byName,
+                     pState->nvars,
+                     sizeof( BridgeVar * ),
+                     CompareName );
+
+    return ( ppVar != NULL ) ? *ppVar : NULL;
+}
+
+/*============================================================================*/
+/*  FindByHandle                                                              */
+/*!
+    Find a replicated variable by handle
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        hVar
+            local variable handle
+
+    @retval pointer to the replicated variable
+    @retval NULL the variable is not replicated
+
+==============================================================================*/
+static BridgeVar *FindByHandle( VarBridgeState *pState, VAR_HANDLE hVar )
+{
+    BridgeVar key;
+    BridgeVar *pKey = &key;
+    BridgeVar **ppVar;
+
+    key.hVar = hVar;
+    ppVar = bsearch( &pKey,
+                     pState->byHandle,
+                     pState->nvars,
+                     sizeof( BridgeVar * ),
+                     CompareHandle );
+
+    return ( ppVar != NULL ) ? *ppVar : NULL;
+}
+
+/*============================================================================*/
+/*  Listen                                                                    */
+/*!
+    Listen for connections from peer bridges
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @retval EOK the bridge is listening
+    @retval other error creating the listening socket
+
+==============================================================================*/
+static int Listen( VarBridgeState *pState )
+{
+    int result;
+    struct addrinfo hints;
+    struct addrinfo *pInfo = NULL;
+    int on = 1;
+    int fd = -1;
+
+    memset( &hints, 0, sizeof( hints ) );
+    hints.ai_family = AF_INET6;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    result = getaddrinfo( NULL, pState->listenPort, &hints, &pInfo );
+    if ( result == 0 )
+    {
+        fd = socket( pInfo->ai_family,
+                     pInfo->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                     pInfo->ai_protocol );
+        if ( ( fd == -1 ) ||
+             ( setsockopt( fd,
+                           SOL_SOCKET,
+                           SO_REUSEADDR,
+                           &on,
+                           sizeof( on ) ) != 0 ) ||
+             ( bind( fd, pInfo->ai_addr, pInfo->ai_addrlen ) != 0 ) ||
+             ( listen( fd, BRIDGE_MAX_PEERS ) != 0 ) )
+        {
+            result = errno;
+        }
+
+        freeaddrinfo( pInfo );
+    }
+    else
+    {
+        result = EINVAL;
+    }
+
+    if ( result == EOK )
+    {
+        pState->listenfd = fd;
+    }
+    else if ( fd != -1 )
+    {
+        close( fd );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Run                                                                       */
+/*!
+    Run the bridge
+
+    The Run function waits for notifications, acknowledgements and
+    peer frames, maintains the outgoing links, and sends the coalesced
+    changes on each link when they are due.  It returns when the bridge
+    receives a termination signal.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+==============================================================================*/
+static void Run( VarBridgeState *pState )
+{
+    struct pollfd fds[2 + BRIDGE_MAX_LINKS + BRIDGE_MAX_PEERS];
+    BridgeLink *pLink;
+    BridgePeer *pPeer;
+    uint64_t now;
+    uint64_t due;
+    int timeout;
+    size_t nfds;
+    size_t i;
+
+    while ( running )
+    {
+        now = Now();
+        due = UINT64_MAX;
+
+        /* maintain the outgoing links */
+        for ( i = 0; i < pState->nlinks; i++ )
+        {
+            pLink = &pState->links[i];
+            if ( ( pLink->state == BRIDGE_LINK_DOWN ) &&
+                 ( now >= pLink->retryTime ) )
+            {
+                LinkConnect( pState, pLink );
+            }
+
+            if ( ( pLink->state == BRIDGE_LINK_UP ) &&
+                 ( pLink->npending > 0 ) &&
+                 ( pLink->out.len == pLink->out.offset ) &&
+                 ( pLink->seq - pLink->acked < pState->window ) )
+            {
+                if ( now >= pLink->flushTime )
+                {
+                    if ( LinkFlush( pState, pLink ) != EOK )
+                    {
+                        LinkClose( pLink );
+                    }
+                }
+                else if ( pLink->flushTime < due )
+                {
+                    due = pLink->flushTime;
+                }
+            }
+
+            if ( ( pLink->state == BRIDGE_LINK_DOWN ) &&
+                 ( pLink->retryTime < due ) )
+            {
+                due = pLink->retryTime;
+            }
+        }
+
+        /* build the poll list */
+        nfds = 0;
+        if ( pState->sigfd != -1 )
+        {
+            fds[nfds].fd = pState->sigfd;
+            fds[nfds++].events = POLLIN;
+        }
+
+        if ( pState->listenfd != -1 )
+        {
+            fds[nfds].fd = pState->listenfd;
+            fds[nfds++].events = POLLIN;
+        }
+
+        for ( i = 0; i < pState->nlinks; i++ )
+        {
+            pLink = &pState->links[i];
+            fds[nfds].fd = ( pLink->state == BRIDGE_LINK_DOWN ) ? -1
+                                                                : pLink->fd;
+            fds[nfds].events = ( pLink->state == BRIDGE_LINK_CONNECTING )
+                               ? POLLOUT
+                               : POLLIN;
+            if ( pLink->out.len > pLink->out.offset )
+            {
+                fds[nfds].events |= POLLOUT;
+            }
+
+            nfds++;
+        }
+
+        for ( i = 0; i < BRIDGE_MAX_PEERS; i++ )
+        {
+            pPeer = &pState->peers[i];
+            fds[nfds].fd = pPeer->fd;
+            fds[nfds++].events = ( pPeer->ackPending == true )
+                                 ? POLLIN | POLLOUT
+                                 : POLLIN;
+        }
+
+        timeout = ( due == UINT64_MAX ) ? -1
+                  : ( due > now )       ? (int)( due - now )
+                                        : 0;
+
+        if ( poll( fds, nfds, timeout ) <= 0 )
+        {
+            continue;
+        }
+
+        nfds = 0;
+        if ( pState->sigfd != -1 )
+        {
+            if ( fds[nfds++].revents & POLLIN )
+            {
+                DrainQueue( pState );
+            }
+        }
+
+        if ( pState->listenfd != -1 )
+        {
+            if ( fds[nfds++].revents & POLLIN )
+            {
+                AcceptPeer( pState );
+            }
+        }
+
+        for ( i = 0; i < pState->nlinks; i++ )
+        {
+            pLink = &pState->links[i];
+            if ( ( pLink->state == BRIDGE_LINK_CONNECTING ) &&
+                 ( fds[nfds].revents != 0 ) )
+            {
+                LinkConnected( pState, pLink );
+            }
+            else if ( pLink->state == BRIDGE_LINK_UP )
+            {
+                if ( ( ( fds[nfds].revents & ( POLLIN | POLLHUP | POLLERR ) ) &&
+                       ( LinkRead( pLink ) != EOK ) ) ||
+                     ( ( fds[nfds].revents & POLLOUT ) &&
+                       ( LinkWrite( pLink ) != EOK ) ) )
+                {
+                    LinkClose( pLink );
+                }
+            }
+
+            nfds++;
+        }
+
+        for ( i = 0; i < BRIDGE_MAX_PEERS; i++ )
+        {
+            pPeer = &pState->peers[i];
+            if ( ( pPeer->fd != -1 ) &&
+                 ( ( ( fds[nfds].revents & ( POLLIN | POLLHUP | POLLERR ) ) &&
+                     ( PeerRead( pState, pPeer ) != EOK ) ) ||
+                   ( ( pPeer->ackPending == true ) &&
+                     ( PeerWrite( pPeer ) != EOK ) ) ) )
+            {
+                PeerClose( pPeer );
+            }
+
+            nfds++;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  DrainQueue                                                                */
+/*!
+    Read the queued modified notifications
+
+    The DrainQueue function reads all of the notifications in the
+    notification queue and adds the changed variables to the pending
+    list of each connected link.  If the queue was full, notifications
+    may have been dropped by the server, so all of the variables are
+    marked as changed.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+==============================================================================*/
+static void DrainQueue( VarBridgeState *pState )
+{
+    VarNotification notification;
+    struct signalfd_siginfo info;
+    BridgeVar *pVar;
+    long count = 0;
+    size_t i;
+    int rc;
+
+    /* discard the notification signals, the queue holds the changes */
+    while ( read( pState->sigfd, &info, sizeof( info ) ) == sizeof( info ) )
+    {
+    }
+
+    do
+    {
+        /* the value is fetched again when it is sent, so only the
+           variable handle is needed */
+        memset( &notification, 0, sizeof( VarNotification ) );
+        notification.obj.val.blob = pState->valbuf;
+        notification.obj.len = pState->msgsize;
+
+        rc = VAR_GetFromQueue( pState->hVarServer,
+                               &notification,
+                               pState->msgbuf,
+                               pState->msgsize + 1 );
+        if ( ( rc == EOK ) || ( rc == E2BIG ) )
+        {
+            count++;
+            pVar = FindByHandle( pState, notification.hVar );
+            if ( pVar != NULL )
+            {
+                MarkDirty( pState, pVar->index );
+            }
+        }
+    } while ( ( rc == EOK ) || ( rc == E2BIG ) );
+
+    if ( count >= pState->maxmsg )
+    {
+        for ( i = 0; i < pState->nlinks; i++ )
+        {
+            if ( pState->links[i].state == BRIDGE_LINK_UP )
+            {
+                MarkAllDirty( &pState->links[i], pState->nvars );
+            }
+        }
+    }
+}
+
+/*============================================================================*/
+/*  MarkDirty                                                                 */
+/*!
+    Add a changed variable to the pending list of each connected link
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        index
+            index of the changed variable
+
+==============================================================================*/
+static void MarkDirty( VarBridgeState *pState, uint32_t index )
+{
+    BridgeLink *pLink;
+    size_t i;
+
+    for ( i = 0; i < pState->nlinks; i++ )
+    {
+        pLink = &pState->links[i];
+        if ( ( pLink->state == BRIDGE_LINK_UP ) &&
+             ( pLink->dirty[index] == 0 ) )
+        {
+            if ( pLink->npending == 0 )
+            {
+                /* start the coalescing interval */
+                pLink->flushTime = Now() + pState->interval_ms;
+            }
+
+            pLink->dirty[index] = 1;
+            pLink->pending[pLink->npending++] = index;
+        }
+    }
+}
+
+/*============================================================================*/
+/*  MarkAllDirty                                                              */
+/*!
+    Add all of the replicated variables to the pending list of a link
+
+    @param[in]
+        pLink
+            pointer to the link
+
+    @param[in]
+        n
+            number of replicated variables
+
+==============================================================================*/
+static void MarkAllDirty( BridgeLink *pLink, size_t n )
+{
+    size_t i;
+
+    for ( i = 0; i < n; i++ )
+    {
+        pLink->dirty[i] = 1;
+        pLink->pending[i] = i;
+    }
+
+    pLink->npending = n;
+}
+
+/*============================================================================*/
+/*  LinkConnect                                                               */
+/*!
+    Start connecting a link to its peer bridge
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pLink
+            pointer to the link
+
+==============================================================================*/
+static void LinkConnect( VarBridgeState *pState, BridgeLink *pLink )
+{
+    struct addrinfo hints;
+    struct addrinfo *pInfo = NULL;
+    int fd = -1;
+
+    memset( &hints, 0, sizeof( hints ) );
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    pLink->retryTime = Now() + BRIDGE_RECONNECT_MS;
+
+    if ( getaddrinfo( pLink->host, pLink->port, &hints, &pInfo ) == 0 )
+    {
+        fd = socket( pInfo->ai_family,
+                     pInfo->ai_socktype | SOCK_NONBLOCK | SOCK_CLOEXEC,
+                     pInfo->ai_protocol );
+        if ( fd != -1 )
+        {
+            if ( connect( fd, pInfo->ai_addr, pInfo->ai_addrlen ) == 0 )
+            {
+                pLink->fd = fd;
+                LinkConnected( pState, pLink );
+            }
+            else if ( errno == EINPROGRESS )
+            {
+                pLink->fd = fd;
+                pLink->state = BRIDGE_LINK_CONNECTING;
+            }
+            else
+            {
+                close( fd );
+            }
+        }
+
+        freeaddrinfo( pInfo );
+    }
+}
+
+/*============================================================================*/
+/*  LinkConnected                                                             */
+/*!
+    Complete the connection of a link
+
+    The LinkConnected function checks the result of a link connection
+    and starts the resynchronization of the peer if it succeeded.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pLink
+            pointer to the link
+
+==============================================================================*/
+static void LinkConnected( VarBridgeState *pState, BridgeLink *pLink )
+{
+    int err = 0;
+    int on = 1;
+    socklen_t len = sizeof( err );
+
+    if ( ( getsockopt( pLink->fd, SOL_SOCKET, SO_ERROR, &err, &len ) == 0 ) &&
+         ( err == 0 ) )
+    {
+        setsockopt( pLink->fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof( on ) );
+        pLink->state = BRIDGE_LINK_UP;
+
+        if ( LinkStart( pState, pLink ) == EOK )
+        {
+            if ( pState->verbose == true )
+            {
+                printf( "connected to %s:%s\n", pLink->host, pLink->port );
+            }
+        }
+        else
+        {
+            LinkClose( pLink );
+        }
+    }
+    else
+    {
+        LinkClose( pLink );
+    }
+}
+
+/*============================================================================*/
+/*  LinkClose                                                                 */
+/*!
+    Close a link
+
+    The LinkClose function closes the link connection and discards
+    any unsent frames and pending changes.  The link is resynchronized
+    when it reconnects.
+
+    @param[in]
+        pLink
+            pointer to the link
+
+==============================================================================*/
+static void LinkClose( BridgeLink *pLink )
+{
+    if ( pLink->fd != -1 )
+    {
+        close( pLink->fd );
+        pLink->fd = -1;
+    }
+
+    pLink->state = BRIDGE_LINK_DOWN;
+    pLink->out.len = 0;
+    pLink->out.offset = 0;
+    pLink->in.len = 0;
+    pLink->in.offset = 0;
+}
+
+/*============================================================================*/
+/*  LinkStart                                                                 */
+/*!
+    Resynchronize a peer bridge
+
+    The LinkStart function clears the pending changes of a newly
+    connected link, and queues the HELLO frame containing the names
+    of the replicated variables followed by the SYNC frame containing
+    a snapshot of their current definitions and values.  The pending
+    changes are cleared before the snapshot is taken, so changes made
+    after the snapshot are sent as deltas.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pLink
+            pointer to the link
+
+    @retval EOK the resynchronization frames were queued
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int LinkStart( VarBridgeState *pState, BridgeLink *pLink )
+{
+    int result = EOK;
+    size_t start;
+    size_t len;
+    size_t i;
+    char *p;
+
+    if ( pLink->dirty == NULL )
+    {
+        pLink->dirty = calloc( pState->nvars, sizeof( uint8_t ) );
+        pLink->pending = calloc( pState->nvars, sizeof( uint32_t ) );
+    }
+
+    if ( ( pLink->dirty == NULL ) || ( pLink->pending == NULL ) )
+    {
+        result = ENOMEM;
+    }
+    else
+    {
+        memset( pLink->dirty, 0, pState->nvars );
+        pLink->npending = 0;
+        pLink->seq = 0;
+        pLink->acked = 0;
+        pLink->out.len = 0;
+        pLink->out.offset = 0;
+
+        /* HELLO: count, then the length and text of each name */
+        start = FrameBegin( &pLink->out );
+        p = Reserve( &pLink->out, sizeof( uint32_t ) );
+        if ( p != NULL )
+        {
+            Put( p, pState->nvars, sizeof( uint32_t ) );
+        }
+
+        for ( i = 0; ( p != NULL ) && ( i < pState->nvars ); i++ )
+        {
+            len = strlen( pState->vars[i].name );
+            p = Reserve( &pLink->out, 1 + len );
+            if ( p != NULL )
+            {
+                Put( p, len, 1 );
+                memcpy( &p[1], pState->vars[i].name, len );
+            }
+        }
+
+        if ( p == NULL )
+        {
+            result = ENOMEM;
+        }
+        else
+        {
+            FrameEnd( &pLink->out, start, BRIDGE_FRAME_HELLO, ++pLink->seq );
+            result = LinkSnapshot( pState, pLink );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LinkSnapshot                                                              */
+/*!
+    Queue a snapshot of the replicated variables on a link
+
+    The LinkSnapshot function asks the variable server for a snapshot
+    and queues a SYNC frame containing a snapshot image with just the
+    replicated variables.  Password variables are never included.  If
+    the snapshot cannot be taken, an empty snapshot image is sent and
+    all of the variables are sent as deltas instead.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pLink
+            pointer to the link
+
+    @retval EOK the SYNC frame was queued
+    @retval ENOMEM memory allocation failure
+
+==============================================================================*/
+static int LinkSnapshot( VarBridgeState *pState, BridgeLink *pLink )
+{
+    int result;
+    SnapshotHeader header;
+    const SnapshotHeader *pHeader;
+    const SnapshotRecord *pRecord;
+    struct stat sb;
+    void *map = MAP_FAILED;
+    char name[BRIDGE_NAME_LEN];
+    size_t start;
+    size_t headerOffset;
+    size_t offset = 0;
+    char *p;
+    int fd = -1;
+
+    memset( &header, 0, sizeof( SnapshotHeader ) );
+    header.magic = SNAPSHOT_MAGIC;
+    header.version = SNAPSHOT_VERSION;
+    header.headerSize = sizeof( SnapshotHeader );
+    header.checksum = SNAPSHOT_FNV_OFFSET;
+
+    start = FrameBegin( &pLink->out );
+    headerOffset = pLink->out.len;
+    p = Reserve( &pLink->out, sizeof( SnapshotHeader ) );
+    result = ( p != NULL ) ? EOK : ENOMEM;
+
+    if ( ( result == EOK ) &&
+         ( VAR_Snapshot( pState->hVarServer,
+                         pState->snapshotPath,
+                         0,
+                         NULL ) == EOK ) )
+    {
+        fd = open( pState->snapshotPath, O_RDONLY | O_CLOEXEC );
+    }
+
+    if ( ( fd != -1 ) &&
+         ( fstat( fd, &sb ) == 0 ) &&
+         ( (size_t)sb.st_size >= sizeof( SnapshotHeader ) ) )
+    {
+        map = mmap( NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0 );
+    }
+
+    if ( fd != -1 )
+    {
+        close( fd );
+        unlink( pState->snapshotPath );
+    }
+
+    if ( map != MAP_FAILED )
+    {
+        pHeader = (const SnapshotHeader *)map;
+        if ( ( pHeader->magic == SNAPSHOT_MAGIC ) &&
+             ( pHeader->version == SNAPSHOT_VERSION ) &&
+             ( pHeader->headerSize == sizeof( SnapshotHeader ) ) &&
+             ( pHeader->length == sb.st_size - sizeof( SnapshotHeader ) ) )
+        {
+            /* copy the records of the replicated variables */
+            while ( ( result == EOK ) &&
+                    ( ( pRecord = NextRecord( (const char *)&pHeader[1],
+                                              pHeader->length,
+                                              &offset ) ) != NULL ) )
+            {
+                if ( ( pRecord->kind == SNAPSHOT_RECORD_VAR ) &&
+                     ( ( pRecord->flags & VARFLAG_PASSWORD ) == 0 ) &&
+                     ( RecordName( pRecord, name, sizeof( name ) ) == EOK ) &&
+                     ( FindByName( pState, name ) != NULL ) )
+                {
+                    p = Reserve( &pLink->out, pRecord->length );
+                    if ( p != NULL )
+                    {
+                        memcpy( p, pRecord, pRecord->length );
+                        header.count++;
+                        header.length += pRecord->length;
+                        header.checksum = Checksum( header.checksum,
+                                                    pRecord,
+                                                    pRecord->length );
+                    }
+                    else
+                    {
+                        result = ENOMEM;
+                    }
+                }
+            }
+        }
+
+        munmap( map, sb.st_size );
+    }
+    else
+    {
+        /* no snapshot, so send the current values as deltas */
+        MarkAllDirty( pLink, pState->nvars );
+        pLink->flushTime = 0;
+    }
+
+    if ( result == EOK )
+    {
+        memcpy( &pLink->out.data[headerOffset],
+                &header,
+                sizeof( SnapshotHeader ) );
+        FrameEnd( &pLink->out, start, BRIDGE_FRAME_SYNC, ++pLink->seq );
+
+        if ( pState->verbose == true )
+        {
+            printf( "sent snapshot of %" PRIu32 " variables to %s:%s\n",
+                    header.count,
+                    pLink->host,
+                    pLink->port );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LinkFlush                                                                 */
+/*!
+    Send the pending changes on a link
+
+    The LinkFlush function gets the current values of up to
+    BRIDGE_BATCH_SIZE pending variables in a single batch, and
+    queues them in a DELTA frame.  Each entry contains the variable
+    index, its type and its value.  Strings and blobs are preceded by
+    their length.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pLink
+            pointer to the link
+
+    @retval EOK the DELTA frame was queued
+    @retval ENOMEM memory allocation failure
+    @retval other error writing the frame
+
+==============================================================================*/
+static int LinkFlush( VarBridgeState *pState, BridgeLink *pLink )
+{
+    int result = EOK;
+    VAR_HANDLE hVars[BRIDGE_BATCH_SIZE];
+    uint32_t index[BRIDGE_BATCH_SIZE];
+    VarObject objs[BRIDGE_BATCH_SIZE];
+    int rc[BRIDGE_BATCH_SIZE];
+    uint32_t value;
+    size_t start;
+    size_t count;
+    size_t sent = 0;
+    size_t size;
+    size_t len;
+    size_t i;
+    char *p;
+    char *pCount;
+
+    count = ( pLink->npending < BRIDGE_BATCH_SIZE ) ? pLink->npending
+                                                    : BRIDGE_BATCH_SIZE;
+
+    /* take the variables from the end of the pending list */
+    memset( objs, 0, sizeof( objs ) );
+    for ( i = 0; i < count; i++ )
+    {
+        index[i] = pLink->pending[--pLink->npending];
+        pLink->dirty[index[i]] = 0;
+        hVars[i] = pState->vars[index[i]].hVar;
+    }
+
+    (void)VAR_GetMany( pState->hVarServer, hVars, objs, rc, count );
+
+    start = FrameBegin( &pLink->out );
+    pCount = Reserve( &pLink->out, sizeof( uint32_t ) );
+    if ( pCount == NULL )
+    {
+        result = ENOMEM;
+    }
+
+    for ( i = 0; ( result == EOK ) && ( i < count ); i++ )
+    {
+        if ( rc[i] != EOK )
+        {
+            continue;
+        }
+
+        size = ValueSize( objs[i].type );
+        len = 0;
+        if ( objs[i].type == VARTYPE_STR )
+        {
+            len = strlen( objs[i].val.str ) + 1;
+            size = sizeof( uint32_t ) + len;
+        }
+        else if ( objs[i].type == VARTYPE_BLOB )
+        {
+            len = objs[i].len;
+            size = sizeof( uint32_t ) + len;
+        }
+
+        if ( size == 0 )
+        {
+            continue;
+        }
+
+        p = Reserve( &pLink->out, sizeof( uint32_t ) + 1 + size );
+        if ( p == NULL )
+        {
+            result = ENOMEM;
+            break;
+        }
+
+        Put( p, index[i], sizeof( uint32_t ) );
+        Put( &p[4], objs[i].type, 1 );
+        p = &p[5];
+
+        switch ( objs[i].type )
+        {
+            case VARTYPE_UINT16:
+                Put( p, objs[i].val.ui, size );
+                break;
+
+            case VARTYPE_INT16:
+                Put( p, (uint16_t)objs[i].val.i, size );
+                break;
+
+            case VARTYPE_UINT32:
+                Put( p, objs[i].val.ul, size );
+                break;
+
+            case VARTYPE_INT32:
+                Put( p, (uint32_t)objs[i].val.l, size );
+                break;
+
+            case VARTYPE_UINT64:
+                Put( p, objs[i].val.ull, size );
+                break;
+
+            case VARTYPE_INT64:
+                Put( p, (uint64_t)objs[i].val.ll, size );
+                break;
+
+            case VARTYPE_FLOAT:
+                memcpy( &value, &objs[i].val.f, sizeof( value ) );
+                Put( p, value, size );
+                break;
+
+            default:
+                Put( p, len, sizeof( uint32_t ) );
+                memcpy( &p[4], objs[i].val.blob, len );
+                break;
+        }
+
+        sent++;
+    }
+
+    /* release the string and blob values allocated by VAR_GetMany */
+    for ( i = 0; i < count; i++ )
+    {
+        if ( ( ( objs[i].type == VARTYPE_STR ) ||
+               ( objs[i].type == VARTYPE_BLOB ) ) &&
+             ( objs[i].val.blob != NULL ) )
+        {
+            free( objs[i].val.blob );
+        }
+    }
+
+    if ( result == EOK )
+    {
+        Put( pCount, sent, sizeof( uint32_t ) );
+        FrameEnd( &pLink->out, start, BRIDGE_FRAME_DELTA, ++pLink->seq );
+        result = LinkWrite( pLink );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LinkRead                                                                  */
+/*!
+    Read the acknowledgements from a link
+
+    The LinkRead function reads the ACK frames sent by the peer bridge
+    and advances the acknowledged sequence number, which opens the
+    link's send window.
+
+    @param[in]
+        pLink
+            pointer to the link
+
+    @retval EOK the acknowledgements were read
+    @retval ECONNRESET the peer closed the connection
+    @retval EBADMSG an invalid frame was received
+    @retval other error reading the socket
+
+==============================================================================*/
+static int LinkRead( BridgeLink *pLink )
+{
+    int result = EOK;
+    BridgeFrame frame;
+    const char *p;
+    ssize_t n;
+    char *buf;
+
+    buf = Reserve( &pLink->in, BRIDGE_READ_SIZE );
+    if ( buf == NULL )
+    {
+        result = ENOMEM;
+    }
+    else
+    {
+        /* the reserved space is only used if data is read */
+        pLink->in.len -= BRIDGE_READ_SIZE;
+        n = recv( pLink->fd, buf, BRIDGE_READ_SIZE, 0 );
+        if ( n > 0 )
+        {
+            pLink->in.len += n;
+        }
+        else if ( n == 0 )
+        {
+            result = ECONNRESET;
+        }
+        else if ( ( errno != EAGAIN ) && ( errno != EINTR ) )
+        {
+            result = errno;
+        }
+    }
+
+    while ( ( result == EOK ) &&
+            ( pLink->in.len - pLink->in.offset >= BRIDGE_FRAME_LEN ) )
+    {
+        p = &pLink->in.data[pLink->in.offset];
+        frame.magic = Get( p, 2 );
+        frame.version = Get( &p[2], 1 );
+        frame.kind = Get( &p[3], 1 );
+        frame.length = Get( &p[4], 4 );
+        frame.seq = Get( &p[8], 4 );
+
+        if ( ( frame.magic != BRIDGE_MAGIC ) ||
+             ( frame.version != BRIDGE_VERSION ) ||
+             ( frame.kind != BRIDGE_FRAME_ACK ) ||
+             ( frame.length != 0 ) )
+        {
+            result = EBADMSG;
+        }
+        else
+        {
+            if ( (int32_t)( frame.seq - pLink->acked ) > 0 )
+            {
+                pLink->acked = frame.seq;
+            }
+
+            pLink->in.offset += BRIDGE_FRAME_LEN;
+        }
+    }
+
+    /* discard the consumed frames */
+    memmove( pLink->in.data,
+             &pLink->in.data[pLink->in.offset],
+             pLink->in.len - pLink->in.offset );
+    pLink->in.len -= pLink->in.offset;
+    pLink->in.offset = 0;
+
+    return result;
+}
+
+/*============================================================================*/
+/*  LinkWrite                                                                 */
+/*!
+    Write the queued frames to a link
+
+    The LinkWrite function writes as much of the queued frame data
+    as the socket will accept.  The remaining data is written when
+    the socket becomes writable.
+
+    @param[in]
+        pLink
+            pointer to the link
+
+    @retval EOK the data was written or the socket is full
+    @retval other error writing the socket
+
+==============================================================================*/
+static int LinkWrite( BridgeLink *pLink )
+{
+    int result = EOK;
+    ssize_t n;
+
+    while ( ( result == EOK ) &&
+            ( pLink->out.offset < pLink->out.len ) )
+    {
+        n = send( pLink->fd,
+                  &pLink->out.data[pLink->out.offset],
+                  pLink->out.len - pLink->out.offset,
+                  MSG_NOSIGNAL );
+        if ( n > 0 )
+        {
+            pLink->out.offset += n;
+        }
+        else if ( ( n == -1 ) && ( errno == EINTR ) )
+        {
+            continue;
+        }
+        else if ( ( n == -1 ) && ( errno == EAGAIN ) )
+        {
+            break;
+        }
+        else
+        {
+            result = ( n == -1 ) ? errno : EIO;
+        }
+    }
+
+    if ( pLink->out.offset == pLink->out.len )
+    {
+        pLink->out.len = 0;
+        pLink->out.offset = 0;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  AcceptPeer                                                                */
+/*!
+    Accept a connection from a peer bridge
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+==============================================================================*/
+static void AcceptPeer( VarBridgeState *pState )
+{
+    BridgePeer *pPeer = NULL;
+    size_t i;
+    int fd;
+
+    fd = accept4( pState->listenfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC );
+    if ( fd != -1 )
+    {
+        for ( i = 0; ( pPeer == NULL ) && ( i < BRIDGE_MAX_PEERS ); i++ )
+        {
+            if ( pState->peers[i].fd == -1 )
+            {
+                pPeer = &pState->peers[i];
+            }
+        }
+
+        if ( pPeer != NULL )
+        {
+            pPeer->fd = fd;
+            pPeer->seq = 0;
+            pPeer->ackPending = false;
+            pPeer->in.len = 0;
+            pPeer->in.offset = 0;
+
+            if ( pState->verbose == true )
+            {
+                printf( "accepted peer connection\n" );
+            }
+        }
+        else
+        {
+            close( fd );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  PeerClose                                                                 */
+/*!
+    Close a peer connection
+
+    @param[in]
+        pPeer
+            pointer to the peer connection
+
+==============================================================================*/
+static void PeerClose( BridgePeer *pPeer )
+{
+    close( pPeer->fd );
+    pPeer->fd = -1;
+
+    free( pPeer->in.data );
+    memset( &pPeer->in, 0, sizeof( BridgeBuffer ) );
+
+    free( pPeer->names );
+    pPeer->names = NULL;
+
+    free( pPeer->hVars );
+    pPeer->hVars = NULL;
+
+    pPeer->count = 0;
+    pPeer->ackPending = false;
+}
+
+/*============================================================================*/
+/*  PeerRead                                                                  */
+/*!
+    Read and process the frames from a peer bridge
+
+    The PeerRead function reads the data available from a peer
+    connection and processes each complete frame.  Each processed
+    frame is acknowledged.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pPeer
+            pointer to the peer connection
+
+    @retval EOK the data was read
+    @retval ECONNRESET the peer closed the connection
+    @retval EBADMSG an invalid frame was received
+    @retval other error reading the socket
+
+==============================================================================*/
+static int PeerRead( VarBridgeState *pState, BridgePeer *pPeer )
+{
+    int result = EOK;
+    BridgeFrame frame;
+    const char *p;
+    ssize_t n;
+    char *buf;
+
+    buf = Reserve( &pPeer->in, BRIDGE_READ_SIZE );
+    if ( buf == NULL )
+    {
+        result = ENOMEM;
+    }
+    else
+    {
+        /* the reserved space is only used if data is read */
+        pPeer->in.len -= BRIDGE_READ_SIZE;
+        n = recv( pPeer->fd, buf, BRIDGE_READ_SIZE, 0 );
+        if ( n > 0 )
+        {
+            pPeer->in.len += n;
+        }
+        else if ( n == 0 )
+        {
+            result = ECONNRESET;
+        }
+        else if ( ( errno != EAGAIN ) && ( errno != EINTR ) )
+        {
+            result = errno;
+        }
+    }
+
+    while ( ( result == EOK ) &&
+            ( pPeer->in.len - pPeer->in.offset >= BRIDGE_FRAME_LEN ) )
+    {
+        p = &pPeer->in.data[pPeer->in.offset];
+        frame.magic = Get( p, 2 );
+        frame.version = Get( &p[2], 1 );
+        frame.kind = Get( &p[3], 1 );
+        frame.length = Get( &p[4], 4 );
+        frame.seq = Get( &p[8], 4 );
+
+        if ( ( frame.magic != BRIDGE_MAGIC ) ||
+             ( frame.version != BRIDGE_VERSION ) ||
+             ( frame.length > BRIDGE_MAX_FRAME ) )
+        {
+            result = EBADMSG;
+        }
+        else if ( pPeer->in.len - pPeer->in.offset <
+                    BRIDGE_FRAME_LEN + (size_t)frame.length )
+        {
+            /* wait for the rest of the frame */
+            break;
+        }
+        else
+        {
+            result = ProcessFrame( pState,
+                                   pPeer,
+                                   &frame,
+                                   &p[BRIDGE_FRAME_LEN] );
+            pPeer->in.offset += BRIDGE_FRAME_LEN + frame.length;
+            pPeer->seq = frame.seq;
+            pPeer->ackPending = true;
+        }
+    }
+
+    /* discard the consumed frames */
+    memmove( pPeer->in.data,
+             &pPeer->in.data[pPeer->in.offset],
+             pPeer->in.len - pPeer->in.offset );
+    pPeer->in.len -= pPeer->in.offset;
+    pPeer->in.offset = 0;
+
+    return result;
+}
+
+/*============================================================================*/
+/*  PeerWrite                                                                 */
+/*!
+    Acknowledge the frames received from a peer bridge
+
+    The PeerWrite function sends a single ACK frame for all of the
+    frames processed since the last acknowledgement.
+
+    @param[in]
+        pPeer
+            pointer to the peer connection
+
+    @retval EOK the acknowledgement was sent or the socket is full
+    @retval other error writing the socket
+
+==============================================================================*/
+static int PeerWrite( BridgePeer *pPeer )
+{
+    int result = EOK;
+    char buf[BRIDGE_FRAME_LEN];
+    ssize_t n;
+
+    Put( buf, BRIDGE_MAGIC, 2 );
+    Put( &buf[2], BRIDGE_VERSION, 1 );
+    Put( &buf[3], BRIDGE_FRAME_ACK, 1 );
+    Put( &buf[4], 0, 4 );
+    Put( &buf[8], pPeer->seq, 4 );
+
+    n = send( pPeer->fd, buf, sizeof( buf ), MSG_NOSIGNAL | MSG_DONTWAIT );
+    if ( n == (ssize_t)sizeof( buf ) )
+    {
+        pPeer->ackPending = false;
+    }
+    else if ( ( n != -1 ) ||
+              ( ( errno != EAGAIN ) && ( errno != EINTR ) ) )
+    {
+        /* a partial acknowledgement cannot be completed */
+        result = ( n == -1 ) ? errno : EIO;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessFrame                                                              */
+/*!
+    Process a frame from a peer bridge
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pPeer
+            pointer to the peer connection
+
+    @param[in]
+        pFrame
+            pointer to the decoded frame header
+
+    @param[in]
+        payload
+            pointer to the frame payload
+
+    @retval EOK the frame was processed
+    @retval EBADMSG the frame is invalid
+
+==============================================================================*/
+static int ProcessFrame( VarBridgeState *pState,
+                         BridgePeer *pPeer,
+                         BridgeFrame *pFrame,
+                         const char *payload )
+{
+    int result;
+
+    switch ( pFrame->kind )
+    {
+        case BRIDGE_FRAME_HELLO:
+            result = ProcessHello( pPeer, payload, pFrame->length );
+            if ( result == EOK )
+            {
+                ResolvePeer( pState, pPeer );
+            }
+            break;
+
+        case BRIDGE_FRAME_SYNC:
+            result = ProcessSync( pState, pPeer, payload, pFrame->length );
+            break;
+
+        case BRIDGE_FRAME_DELTA:
+            result = ProcessDelta( pState, pPeer, payload, pFrame->length );
+            break;
+
+        default:
+            result = EBADMSG;
+            break;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessHello                                                              */
+/*!
+    Process a HELLO frame from a peer bridge
+
+    The ProcessHello function stores the names of the peer's
+    replicated variables.  Delta entries refer to the variables by
+    their position in this table.
+
+    @param[in]
+        pPeer
+            pointer to the peer connection
+
+    @param[in]
+        payload
+            pointer to the frame payload
+
+    @param[in]
+        length
+            length of the frame payload
+
+    @retval EOK the frame was processed
+    @retval ENOMEM memory allocation failure
+    @retval EBADMSG the frame is invalid
+
+==============================================================================*/
+static int ProcessHello( BridgePeer *pPeer,
+                         const char *payload,
+                         uint32_t length )
+{
+    int result = EBADMSG;
+    uint32_t count;
+    uint32_t offset = sizeof( uint32_t );
+    uint32_t i;
+    size_t len;
+
+    free( pPeer->names );
+    free( pPeer->hVars );
+    pPeer->names = NULL;
+    pPeer->hVars = NULL;
+    pPeer->count = 0;
+
+    if ( length >= sizeof( uint32_t ) )
+    {
+        count = Get( payload, sizeof( uint32_t ) );
+        result = ( count <= length ) ? EOK : EBADMSG;
+        if ( ( result == EOK ) && ( count > 0 ) )
+        {
+            pPeer->names = calloc( count, BRIDGE_NAME_LEN );
+            pPeer->hVars = calloc( count, sizeof( VAR_HANDLE ) );
+            if ( ( pPeer->names == NULL ) || ( pPeer->hVars == NULL ) )
+            {
+                result = ENOMEM;
+            }
+        }
+
+        for ( i = 0; ( result == EOK ) && ( i < count ); i++ )
+        {
+            len = ( offset < length ) ? (uint8_t)payload[offset] : 0;
+            if ( ( len == 0 ) ||
+                 ( len >= BRIDGE_NAME_LEN ) ||
+                 ( offset + 1 + len > length ) )
+            {
+                result = EBADMSG;
+            }
+            else
+            {
+                memcpy( pPeer->names[i], &payload[offset + 1], len );
+                pPeer->hVars[i] = VAR_INVALID;
+                offset += 1 + len;
+            }
+        }
+
+        if ( result == EOK )
+        {
+            pPeer->count = count;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessSync                                                               */
+/*!
+    Process a SYNC frame from a peer bridge
+
+    The ProcessSync function validates the snapshot image, creates
+    the variables which do not exist, and sets the values of the
+    others in batches.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pPeer
+            pointer to the peer connection
+
+    @param[in]
+        payload
+            pointer to the frame payload
+
+    @param[in]
+        length
+            length of the frame payload
+
+    @retval EOK the frame was processed
+    @retval EBADMSG the snapshot image is corrupt
+    @retval ENOTSUP the snapshot image format is not supported
+
+==============================================================================*/
+static int ProcessSync( VarBridgeState *pState,
+                        BridgePeer *pPeer,
+                        const char *payload,
+                        uint32_t length )
+{
+    int result = EBADMSG;
+    SnapshotHeader header;
+    const SnapshotRecord *pRecord;
+    VAR_HANDLE hVars[BRIDGE_BATCH_SIZE];
+    VarObject objs[BRIDGE_BATCH_SIZE];
+    size_t offset = 0;
+    size_t count = 0;
+    size_t created = 0;
+    size_t set = 0;
+
+    if ( length >= sizeof( SnapshotHeader ) )
+    {
+        memcpy( &header, payload, sizeof( SnapshotHeader ) );
+        payload += sizeof( SnapshotHeader );
+        length -= sizeof( SnapshotHeader );
+
+        if ( header.magic != SNAPSHOT_MAGIC )
+        {
+            result = EBADMSG;
+        }
+        else if ( ( header.version != SNAPSHOT_VERSION ) ||
+                  ( header.headerSize != sizeof( SnapshotHeader ) ) )
+        {
+            result = ENOTSUP;
+        }
+        else if ( ( header.length == length ) &&
+                  ( Checksum( SNAPSHOT_FNV_OFFSET, payload, length ) ==
+                        header.checksum ) )
+        {
+            result = EOK;
+        }
+    }
+
+    while ( ( result == EOK ) &&
+            ( ( pRecord = NextRecord( payload, length, &offset ) ) != NULL ) )
+    {
+        if ( RestoreRecord( pState,
+                            pRecord,
+                            &objs[count],
+                            &hVars[count] ) == EOK )
+        {
+            if ( hVars[count] == VAR_INVALID )
+            {
+                created++;
+            }
+            else if ( ++count == BRIDGE_BATCH_SIZE )
+            {
+                (void)VAR_SetMany( pState->hVarServer,
+                                   hVars,
+                                   objs,
+                                   NULL,
+                                   count );
+                set += count;
+                count = 0;
+            }
+        }
+    }
+
+    if ( ( result == EOK ) && ( count > 0 ) )
+    {
+        (void)VAR_SetMany( pState->hVarServer, hVars, objs, NULL, count );
+        set += count;
+    }
+
+    if ( result == EOK )
+    {
+        /* find the variables which have been created */
+        ResolvePeer( pState, pPeer );
+
+        if ( pState->verbose == true )
+        {
+            printf( "synchronized %zu variables, created %zu\n",
+                    set,
+                    created );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RestoreRecord                                                             */
+/*!
+    Restore a variable from a snapshot record
+
+    The RestoreRecord function creates the variable described by a
+    snapshot record if it does not exist.  If it exists, the record
+    value is prepared in a var object so it can be set in a batch.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pRecord
+            pointer to a validated snapshot record
+
+    @param[out]
+        pVarObject
+            pointer to a var object to receive the record value
+
+    @param[out]
+        phVar
+            pointer to a location to store the handle of the existing
+            variable, or VAR_INVALID if the variable was created
+
+    @retval EOK the variable was created or its value prepared
+    @retval EBADMSG the record contents are not valid
+    @retval other the variable could not be created
+
+==============================================================================*/
+static int RestoreRecord( VarBridgeState *pState,
+                          const SnapshotRecord *pRecord,
+                          VarObject *pVarObject,
+                          VAR_HANDLE *phVar )
+{
+    int result = EBADMSG;
+    VarInfo info;
+    char name[BRIDGE_NAME_LEN];
+    const char *data;
+    const char *tagspec;
+    size_t i;
+
+    tagspec = (const char *)&pRecord[1] +
+              pRecord->nameLen +
+              pRecord->targetLen;
+    data = tagspec + pRecord->tagspecLen;
+
+    memset( pVarObject, 0, sizeof( VarObject ) );
+    pVarObject->type = pRecord->type;
+    pVarObject->len = pRecord->len;
+
+    if ( ( pRecord->kind == SNAPSHOT_RECORD_VAR ) &&
+         ( pRecord->type > VARTYPE_INVALID ) &&
+         ( pRecord->type < VARTYPE_END_MARKER ) &&
+         ( pRecord->nreads <= VARSERVER_MAX_UIDS ) &&
+         ( pRecord->nwrites <= VARSERVER_MAX_UIDS ) &&
+         ( RecordName( pRecord, name, sizeof( name ) ) == EOK ) )
+    {
+        result = EOK;
+        if ( pRecord->type == VARTYPE_STR )
+        {
+            if ( ( pRecord->dataLen > 0 ) &&
+                 ( pRecord->dataLen <= pRecord->len + 1 ) &&
+                 ( data[pRecord->dataLen - 1] == 0 ) )
+            {
+                pVarObject->val.str = (char *)data;
+            }
+            else
+            {
+                result = EBADMSG;
+            }
+        }
+        else if ( pRecord->type == VARTYPE_BLOB )
+        {
+            if ( pRecord->dataLen == pRecord->len )
+            {
+                pVarObject->val.blob = (void *)data;
+            }
+            else
+            {
+                result = EBADMSG;
+            }
+        }
+        else
+        {
+            memcpy( &pVarObject->val,
+                    &pRecord->value,
+                    sizeof( pRecord->value ) );
+        }
+    }
+
+    if ( result == EOK )
+    {
+        *phVar = VAR_FindByName( pState->hVarServer, name );
+        if ( *phVar == VAR_INVALID )
+        {
+            memset( &info, 0, sizeof( VarInfo ) );
+            strncpy( info.name,
+                     (const char *)&pRecord[1],
+                     MAX_NAME_LEN );
+            info.instanceID = pRecord->instanceID;
+            info.guid = pRecord->guid;
+            info.flags = pRecord->flags & ~( VARFLAG_DIRTY | VARFLAG_ALIAS );
+            info.var = *pVarObject;
+            memcpy( info.formatspec, pRecord->formatspec, MAX_FORMATSPEC_LEN );
+            info.formatspec[MAX_FORMATSPEC_LEN - 1] = 0;
+            strncpy( info.tagspec, tagspec, MAX_TAGSPEC_LEN - 1 );
+
+            info.permissions.nreads = pRecord->nreads;
+            info.permissions.nwrites = pRecord->nwrites;
+            for ( i = 0; i < VARSERVER_MAX_UIDS; i++ )
+            {
+                info.permissions.read[i] = pRecord->read[i];
+                info.permissions.write[i] = pRecord->write[i];
+            }
+
+            result = VARSERVER_CreateVar( pState->hVarServer, &info );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ProcessDelta                                                              */
+/*!
+    Process a DELTA frame from a peer bridge
+
+    The ProcessDelta function decodes the changed values and sets
+    them in batches.  Entries for variables which do not exist on
+    this node are skipped.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pPeer
+            pointer to the peer connection
+
+    @param[in]
+        payload
+            pointer to the frame payload
+
+    @param[in]
+        length
+            length of the frame payload
+
+    @retval EOK the frame was processed
+    @retval EBADMSG the frame is invalid
+
+==============================================================================*/
+static int ProcessDelta( VarBridgeState *pState,
+                         BridgePeer *pPeer,
+                         const char *payload,
+                         uint32_t length )
+{
+    int result = EBADMSG;
+    VAR_HANDLE hVars[BRIDGE_BATCH_SIZE];
+    VarObject objs[BRIDGE_BATCH_SIZE];
+    uint32_t offset = sizeof( uint32_t );
+    uint32_t count;
+    uint32_t index;
+    uint32_t value;
+    uint32_t i;
+    size_t n = 0;
+    size_t size;
+    VarType type;
+    const char *p;
+
+    if ( length >= sizeof( uint32_t ) )
+    {
+        count = Get( payload, sizeof( uint32_t ) );
+        result = EOK;
+
+        for ( i = 0; ( result == EOK ) && ( i < count ); i++ )
+        {
+            result = EBADMSG;
+            if ( length - offset < sizeof( uint32_t ) + 1 )
+            {
+                break;
+            }
+
+            p = &payload[offset];
+            index = Get( p, sizeof( uint32_t ) );
+            type = Get( &p[4], 1 );
+            p = &p[5];
+            offset += 5;
+
+            size = ValueSize( type );
+            if ( ( ( type == VARTYPE_STR ) || ( type == VARTYPE_BLOB ) ) &&
+                 ( length - offset >= sizeof( uint32_t ) ) )
+            {
+                size = sizeof( uint32_t ) + Get( p, sizeof( uint32_t ) );
+            }
+
+            if ( ( size == 0 ) || ( size > length - offset ) )
+            {
+                break;
+            }
+
+            offset += size;
+            result = EOK;
+
+            if ( ( index >= pPeer->count ) ||
+                 ( pPeer->hVars[index] == VAR_INVALID ) )
+            {
+                /* the variable does not exist on this node */
+                continue;
+            }
+
+            memset( &objs[n], 0, sizeof( VarObject ) );
+            objs[n].type = type;
+            objs[n].len = size;
+
+            switch ( type )
+            {
+                case VARTYPE_UINT16:
+                    objs[n].val.ui = Get( p, size );
+                    break;
+
+                case VARTYPE_INT16:
+                    objs[n].val.i = (int16_t)Get( p, size );
+                    break;
+
+                case VARTYPE_UINT32:
+                    objs[n].val.ul = Get( p, size );
+                    break;
+
+                case VARTYPE_INT32:
+                    objs[n].val.l = (int32_t)Get( p, size );
+                    break;
+
+                case VARTYPE_UINT64:
+                    objs[n].val.ull = Get( p, size );
+                    break;
+
+                case VARTYPE_INT64:
+                    objs[n].val.ll = (int64_t)Get( p, size );
+                    break;
+
+                case VARTYPE_FLOAT:
+                    value = Get( p, size );
+                    memcpy( &objs[n].val.f, &value, sizeof( value ) );
+                    break;
+
+                default:
+                    objs[n].len = size - sizeof( uint32_t );
+                    objs[n].val.blob = (void *)&p[4];
+                    if ( ( type == VARTYPE_STR ) &&
+                         ( ( objs[n].len == 0 ) ||
+                           ( p[size - 1] != 0 ) ) )
+                    {
+                        result = EBADMSG;
+                    }
+                    break;
+            }
+
+            if ( result == EOK )
+            {
+                hVars[n] = pPeer->hVars[index];
+                if ( ++n == BRIDGE_BATCH_SIZE )
+                {
+                    (void)VAR_SetMany( pState->hVarServer,
+                                       hVars,
+                                       objs,
+                                       NULL,
+                                       n );
+                    n = 0;
+                }
+            }
+        }
+    }
+
+    if ( n > 0 )
+    {
+        (void)VAR_SetMany( pState->hVarServer, hVars, objs, NULL, n );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ResolvePeer                                                               */
+/*!
+    Find the local variables replicated by a peer bridge
+
+    The ResolvePeer function looks up the local handle of each of the
+    peer's replicated variables which has not been found yet.
+
+    @param[in]
+        pState
+            pointer to the varbridge state object
+
+    @param[in]
+        pPeer
+            pointer to the peer connection
+
+==============================================================================*/
+static void ResolvePeer( VarBridgeState *pState, BridgePeer *pPeer )
+{
+    uint32_t i;
+
+    for ( i = 0; i < pPeer->count; i++ )
+    {
+        if ( pPeer->hVars[i] == VAR_INVALID )
+        {
+            pPeer->hVars[i] = VAR_FindByName( pState->hVarServer,
+                                              pPeer->names[i] );
+        }
+    }
+}
+
+/*============================================================================*/
+/*  Reserve                                                                   */
+/*!
+    Reserve space at the end of a buffer
+
+    The Reserve function grows a buffer if necessary, and adds the
+    specified number of bytes to its length.
+
+    @param[in]
+        pBuf
+            pointer to the buffer
+
+    @param[in]
+        n
+            number of bytes to reserve
+
+    @retval pointer to the reserved space
+    @retval NULL memory allocation failure
+
+==============================================================================*/
+static char *Reserve( BridgeBuffer *pBuf, size_t n )
+{
+    char *p = NULL;
+    size_t size;
+
+    if ( pBuf->len + n > pBuf->size )
+    {
+        size = ( pBuf->size == 0 ) ? BRIDGE_READ_SIZE : pBuf->size;
+        while ( size < pBuf->len + n )
+        {
+            size *= 2;
+        }
+
+        p = realloc( pBuf->data, size );
+        if ( p != NULL )
+        {
+            pBuf->data = p;
+            pBuf->size = size;
+        }
+    }
+
+    if ( pBuf->len + n <= pBuf->size )
+    {
+        p = &pBuf->data[pBuf->len];
+        pBuf->len += n;
+    }
+    else
+    {
+        p = NULL;
+    }
+
+    return p;
+}
+
+/*============================================================================*/
+/*  FrameBegin                                                                */
+/*!
+    Start a frame
+
+    The FrameBegin function reserves space for a frame header at the
+    end of a buffer.  The header is completed by FrameEnd once the
+    payload has been added.
+
+    @param[in]
+        pBuf
+            pointer to the buffer
+
+    @retval offset of the frame in the buffer
+
+==============================================================================*/
+static size_t FrameBegin( BridgeBuffer *pBuf )
+{
+    size_t start = pBuf->len;
+
+    if ( Reserve( pBuf, BRIDGE_FRAME_LEN ) == NULL )
+    {
+        start = SIZE_MAX;
+    }
+
+    return start;
+}
+
+/*============================================================================*/
+/*  FrameEnd                                                                  */
+/*!
+    Complete a frame
+
+    The FrameEnd function writes the frame header of a frame started
+    with FrameBegin.
+
+    @param[in]
+        pBuf
+            pointer to the buffer
+
+    @param[in]
+        start
+            offset of the frame returned by FrameBegin
+
+    @param[in]
+        kind
+            BridgeFrameKind of the frame
+
+    @param[in]
+        seq
+            frame sequence number
+
+==============================================================================*/
+static void FrameEnd( BridgeBuffer *pBuf,
+                      size_t start,
+                      uint8_t kind,
+                      uint32_t seq )
+{
+    char *p;
+
+    if ( start <= pBuf->len - BRIDGE_FRAME_LEN )
+    {
+        p = &pBuf->data[start];
+        Put( p, BRIDGE_MAGIC, 2 );
+        Put( &p[2], BRIDGE_VERSION, 1 );
+        Put( &p[3], kind, 1 );
+        Put( &p[4], pBuf->len - start - BRIDGE_FRAME_LEN, 4 );
+        Put( &p[8], seq, 4 );
+    }
+}
+
+/*============================================================================*/
+/*  Put                                                                       */
+/*!
+    Encode an integer in network byte order
+
+    @param[out]
+        p
+            pointer to the location to store the encoded integer
+
+    @param[in]
+        value
+            value to encode
+
+    @param[in]
+        n
+            number of bytes to encode
+
+==============================================================================*/
+static void Put( char *p, uint64_t value, size_t n )
+{
+    while ( n > 0 )
+    {
+        p[--n] = (char)( value & 0xFF );
+        value >>= 8;
+    }
+}
+
+/*============================================================================*/
+/*  Get                                                                       */
+/*!
+    Decode an integer in network byte order
+
+    @param[in]
+        p
+            pointer to the encoded integer
+
+    @param[in]
+        n
+            number of bytes to decode
+
+    @retval the decoded value
+
+==============================================================================*/
+static uint64_t Get( const char *p, size_t n )
+{
+    uint64_t value = 0;
+    size_t i;
+
+    for ( i = 0; i < n; i++ )
+    {
+        value = ( value << 8 ) | (uint8_t)p[i];
+    }
+
+    return value;
+}
+
+/*============================================================================*/
+/*  ValueSize                                                                 */
+/*!
+    Get the encoded size of a numeric value
+
+    @param[in]
+        type
+            variable type
+
+    @retval number of bytes in the encoded value
+    @retval 0 the type is not numeric
+
+==============================================================================*/
+static size_t ValueSize( VarType type )
+{
+    size_t size;
+
+    switch ( type )
+    {
+        case VARTYPE_UINT16:
+        case VARTYPE_INT16:
+            size = sizeof( uint16_t );
+            break;
+
+        case VARTYPE_UINT32:
+        case VARTYPE_INT32:
+        case VARTYPE_FLOAT:
+            size = sizeof( uint32_t );
+            break;
+
+        case VARTYPE_UINT64:
+        case VARTYPE_INT64:
+            size = sizeof( uint64_t );
+            break;
+
+        default:
+            size = 0;
+            break;
+    }
+
+    return size;
+}
+
+/*============================================================================*/
+/*  RecordName                                                                */
+/*!
+    Get the name of the variable in a snapshot record
+
+    The RecordName function gets the variable name of a snapshot record
+    with an instance identifier prefix if it has one, in the same form
+    as the names of the replicated variables.
+
+    @param[in]
+        pRecord
+            pointer to a validated snapshot record
+
+    @param[out]
+        buf
+            pointer to the buffer to receive the name
+
+    @param[in]
+        len
+            size of the buffer
+
+    @retval EOK the name was stored
+    @retval E2BIG the name is too long
+
+==============================================================================*/
+static int RecordName( const SnapshotRecord *pRecord,
+                       char *buf,
+                       size_t len )
+{
+    int n;
+
+    if ( pRecord->instanceID != 0 )
+    {
+        n = snprintf( buf,
+                      len,
+                      "[%" PRIu32 "]%s",
+                      pRecord->instanceID,
+                      (const char *)&pRecord[1] );
+    }
+    else
+    {
+        n = snprintf( buf, len, "%s", (const char *)&pRecord[1] );
+    }
+
+    return ( ( n >= 0 ) && ( (size_t)n < len ) ) ? EOK : E2BIG;
+}
+
+/*============================================================================*/
+/*  NextRecord                                                                */
+/*!
+    Get the next record of a snapshot image
+
+    The NextRecord function validates the next record of a snapshot
+    image and advances the offset past it.  The record and each of
+    its strings must be complete.
+
+    @param[in]
+        p
+            pointer to the first record
+
+    @param[in]
+        length
+            total length of the records
+
+    @param[in,out]
+        pOffset
+            pointer to the offset of the next record
+
+    @retval pointer to the next record
+    @retval NULL there are no more records or the record is corrupt
+
+==============================================================================*/
+static const SnapshotRecord *NextRecord( const char *p,
+                                         size_t length,
+                                         size_t *pOffset )
+{
+    const SnapshotRecord *pRecord = NULL;
+    const SnapshotRecord *pNext;
+    const char *name;
+    size_t offset = *pOffset;
+    size_t len;
+
+    if ( ( offset < length ) &&
+         ( length - offset >= sizeof( SnapshotRecord ) ) )
+    {
+        pNext = (const SnapshotRecord *)&p[offset];
+        len = sizeof( SnapshotRecord ) +
+              pNext->nameLen +
+              pNext->targetLen +
+              pNext->tagspecLen +
+              (size_t)pNext->dataLen;
+
+        name = (const char *)&pNext[1];
+
+        if ( ( pNext->length >= len ) &&
+             ( pNext->length <= length - offset ) &&
+             ( ( pNext->length % SNAPSHOT_ALIGN ) == 0 ) &&
+             ( pNext->nameLen > 0 ) &&
+             ( pNext->targetLen > 0 ) &&
+             ( pNext->tagspecLen > 0 ) &&
+             ( name[pNext->nameLen - 1] == 0 ) &&
+             ( name[pNext->nameLen + pNext->targetLen - 1] == 0 ) &&
+             ( name[pNext->nameLen +
+                    pNext->targetLen +
+                    pNext->tagspecLen - 1] == 0 ) )
+        {
+            pRecord = pNext;
+            *pOffset = offset + pNext->length;
+        }
+    }
+
+    return pRecord;
+}
+
+/*============================================================================*/
+/*  Checksum                                                                  */
+/*!
+    Update a snapshot checksum
+
+    The Checksum function adds the specified data to an FNV-1a
+    checksum, as used by the snapshot file format.
+
+    @param[in]
+        hash
+            current checksum value
+
+    @param[in]
+        p
+            pointer to the data to add
+
+    @param[in]
+        len
+            number of bytes to add
+
+    @retval the updated checksum value
+
+==============================================================================*/
+static uint32_t Checksum( uint32_t hash, const void *p, size_t len )
+{
+    const uint8_t *pData = (const uint8_t *)p;
+    size_t i;
+
+    for ( i = 0; i < len; i++ )
+    {
+        hash ^= pData[i];
+        hash *= SNAPSHOT_FNV_PRIME;
+    }
+
+    return hash;
+}
+
+/*============================================================================*/
+/*  Now                                                                       */
+/*!
+    Get the monotonic time
+
+    @retval the monotonic time in milliseconds
+
+==============================================================================*/
+static uint64_t Now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return (uint64_t)ts.tv_sec * 1000ULL + (uint64_t)ts.tv_nsec / 1000000ULL;
+}
+
+/*============================================================================*/
+/*  SignalHandler                                                             */
+/*!
+    Handle a termination signal
+
+    @param[in]
+        sig
+            the received signal
+
+==============================================================================*/
+static void SignalHandler( int sig )
+{
+    (void)sig;
+    running = 0;
+}
+
+/*! @}
+ * end of varbridge group */
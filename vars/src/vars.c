@@ -54,6 +54,7 @@ SOFTWARE.
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <string.h>
 #include <unistd.h>
 #include <stdbool.h>
@@ -95,6 +96,12 @@ typedef struct _varsState
     /* tagspec */
     char *tagspec;
 
+    /*! dump name=value lines for the matching variables */
+    bool dump;
+
+    /*! number of variables using the most server memory to list */
+    size_t largest;
+
 } VarsState;
 
 /*==============================================================================
@@ -105,11 +112,15 @@ static int ProcessOptions( int argC,
                            char *argV[],
                            VarsState *pState );
 static int SetUser( VarsState *pState );
+static int PrintLargest( VarsState *pState );
 
 /*==============================================================================
        Definitions
 ==============================================================================*/
 
+/*! size of the working buffer used to retrieve pages of query results */
+#define VARS_WORKBUF_SIZE ( 256 * 1024 )
+
 /*==============================================================================
       File Scoped Variables
 ==============================================================================*/
@@ -154,7 +165,7 @@ int main(int argC, char *argV[])
         uid = getuid();
 
         /* get a handle to the variable server for transition events */
-        pState->hVarServer = VARSERVER_Open();
+        pState->hVarServer = VARSERVER_OpenExt( VARS_WORKBUF_SIZE );
         if ( pState->hVarServer != NULL )
         {
             /* Process Options */
@@ -179,14 +190,33 @@ int main(int argC, char *argV[])
                     }
                 }
 
-                /* make the query */
-                (void)VARQUERY_Search( pState->hVarServer,
-                                    pState->searchType,
-                                    pState->searchText,
-                                    pState->tagspec,
-                                    pState->instanceID,
-                                    pState->flags,
-                                    pState->fd );
+                if ( pState->largest > 0 )
+                {
+                    /* list the variables using the most memory */
+                    (void)PrintLargest( pState );
+                }
+                else if ( pState->dump == true )
+                {
+                    /* stream the matching variables and their values */
+                    (void)VARQUERY_Dump( pState->hVarServer,
+                                         pState->searchType,
+                                         pState->searchText,
+                                         pState->tagspec,
+                                         pState->instanceID,
+                                         pState->flags,
+                                         pState->fd );
+                }
+                else
+                {
+                    /* make the query */
+                    (void)VARQUERY_Search( pState->hVarServer,
+                                        pState->searchType,
+                                        pState->searchText,
+                                        pState->tagspec,
+                                        pState->instanceID,
+                                        pState->flags,
+                                        pState->fd );
+                }
 
                 if ( userChanged == true )
                 {
@@ -225,13 +255,16 @@ static void usage( char *cmdname )
         fprintf(stderr,
                 "usage: %s [-n name] [-v] [-h]\n"
                 " [-n name] : variable name search term\n"
+                "             (a name starting with '/' matches a path prefix)\n"
                 " [-r regex] : variable name search by a regular expression\n"
                 " [-f flagslist] : variable flags search term\n"
                 " [-F flagslist]: negative variable flags search. Supercedes -f\n"
                 " [-i instanceID]: instance identifier search term\n"
                 " [-h] : display this help\n"
                 " [-v] : output values\n"
-                " [-T] : output type\n",
+                " [-T] : output type\n"
+                " [-s] : dump name=value lines (setvar -s input format)\n"
+                " [-L count] : list the variables using the most memory\n",
                 cmdname );
     }
 }
@@ -266,7 +299,7 @@ static int ProcessOptions( int argC,
 {
     int c;
     int result = EOK;
-    const char *options = "hvTn:r:f:F:i:u:t:";
+    const char *options = "hvTsn:r:f:F:i:u:t:L:";
 
     if( ( pState != NULL ) &&
         ( argV != NULL ) )
@@ -288,6 +321,10 @@ static int ProcessOptions( int argC,
                     pState->searchType |= QUERY_SHOWTYPE;
                     break;
 
+                case 's':
+                    pState->dump = true;
+                    break;
+
                 case 'n':
                     pState->searchText = optarg;
                     pState->searchType |= QUERY_MATCH;
@@ -317,6 +354,10 @@ static int ProcessOptions( int argC,
                     pState->username = optarg;
                     break;
 
+                case 'L':
+                    pState->largest = strtoul( optarg, NULL, 0 );
+                    break;
+
                 case 'h':
                     usage( argV[0] );
                     result = EINVAL;
@@ -377,5 +418,66 @@ static int SetUser( VarsState *pState )
     return result;
 }
 
+/*============================================================================*/
+/*  PrintLargest                                                              */
+/*!
+    List the variables using the most server memory
+
+    The PrintLargest function writes the number of bytes of server
+    memory used by each of the largest variables, and its name, to the
+    output, largest first.
+
+    @param[in]
+        pState
+            pointer to the VarsState object which contains the number
+            of variables to list
+
+    @retval EOK the variables were listed
+    @retval ENOMEM memory allocation failure
+    @retval other error from VARSERVER_GetLargestVars
+
+==============================================================================*/
+static int PrintLargest( VarsState *pState )
+{
+    int result = ENOMEM;
+    VarMemUsage *pUsage;
+    char name[MAX_NAME_LEN+1];
+    size_t count = 0;
+    size_t i;
+
+    pUsage = calloc( pState->largest, sizeof( VarMemUsage ) );
+    if ( pUsage != NULL )
+    {
+        result = VARSERVER_GetLargestVars( pState->hVarServer,
+                                           pUsage,
+                                           pState->largest,
+                                           &count );
+        for ( i = 0; ( result == EOK ) && ( i < count ); i++ )
+        {
+            if ( VAR_GetName( pState->hVarServer,
+                              pUsage[i].hVar,
+                              name,
+                              sizeof( name ) ) != EOK )
+            {
+                name[0] = 0;
+            }
+
+            dprintf( pState->fd,
+                     "%10" PRIu64 " %s\n",
+                     pUsage[i].bytes,
+                     name );
+        }
+
+        free( pUsage );
+    }
+
+    if ( result != EOK )
+    {
+        fprintf( stderr, "vars: %s\n", strerror( result ) );
+    }
+
+    return result;
+}
+
 /*! @}
  * end of vars group */
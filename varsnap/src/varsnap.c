@@ -0,0 +1,315 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup varsnap varsnap
+ * @brief Write a snapshot of the variable store
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file varsnap.c
+
+    Write a variable store snapshot
+
+    The varsnap Application requests the variable server to write a
+    binary snapshot of its variables to a file.  The snapshot can be
+    restored when the variable server is started using its -r option.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <varserver/varserver.h>
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! varsnap state object used to customize the behavior of the application */
+typedef struct _var_snap_state
+{
+    /*! handle to the variable server */
+    VARSERVER_HANDLE hVarServer;
+
+    /*! path of the snapshot file */
+    char *path;
+
+    /*! snapshot options */
+    uint32_t options;
+
+    /*! verbose mode */
+    bool verbose;
+
+} VarSnapState;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int ProcessOptions( int argC,
+                           char *argV[],
+                           VarSnapState *pState );
+static void usage( char *name );
+static int GetAbsolutePath( char *path, char *buf, size_t len );
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the varsnap application
+
+    The main function starts the varsnap application
+
+    @param[in]
+        argc
+            number of arguments on the command line
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @return none
+
+==============================================================================*/
+int main(int argc, char **argv)
+{
+    VarSnapState state;
+    int result = EINVAL;
+    char path[PATH_MAX];
+    size_t count = 0;
+
+    memset( &state, 0, sizeof(VarSnapState));
+
+    result = ProcessOptions( argc, argv, &state );
+    if ( result == EOK )
+    {
+        /* the snapshot is written by the server, so it needs
+           an absolute path */
+        result = GetAbsolutePath( state.path, path, sizeof( path ) );
+    }
+
+    if ( result == EOK )
+    {
+        /* get a handle to the VAR server */
+        state.hVarServer = VARSERVER_Open();
+        if( state.hVarServer != NULL )
+        {
+            result = VAR_Snapshot( state.hVarServer,
+                                   path,
+                                   state.options,
+                                   &count );
+            if ( result == EOK )
+            {
+                if ( state.verbose == true )
+                {
+                    printf( "%zu variables written to %s\n", count, path );
+                }
+            }
+            else
+            {
+                fprintf( stderr, "VARSNAP: %s\n", strerror( result ) );
+            }
+
+            /* close the variable server */
+            VARSERVER_Close( state.hVarServer );
+        }
+        else
+        {
+            result = ENOTCONN;
+        }
+    }
+
+    return ( result == EOK ) ? 0 : 1;
+}
+
+/*============================================================================*/
+/*  usage                                                                     */
+/*!
+    Display the application usage
+
+    The usage function dumps the application usage message
+    to stderr.
+
+    @param[in]
+       name
+            pointer to the invoked application name
+
+==============================================================================*/
+static void usage( char *name )
+{
+    if( name != NULL )
+    {
+        fprintf( stderr,
+                 "usage: %s [-h] [-v] [-d] <filename>\n"
+                 " [-h] : display this help\n"
+                 " [-v] : verbose output\n"
+                 " [-d] : only save non-volatile variables which are dirty\n",
+                 name );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessOptions                                                            */
+/*!
+    Process the command line options
+
+    The ProcessOptions function processes the command line options and
+    populates the VarSnapState object
+
+    @param[in]
+        argC
+            number of arguments
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @param[in]
+        pState
+            pointer to the varsnap state object
+
+    @return EOK if the options were processed
+    @return EINVAL if the options were invalid
+
+==============================================================================*/
+static int ProcessOptions( int argC,
+                           char *argV[],
+                           VarSnapState *pState )
+{
+    int c;
+    int result = EINVAL;
+    const char *options = "hvd";
+
+    if( ( pState != NULL ) &&
+        ( argV != NULL ) )
+    {
+        result = EOK;
+
+        while( ( c = getopt( argC, argV, options ) ) != -1 )
+        {
+            switch( c )
+            {
+                case 'v':
+                    pState->verbose = true;
+                    break;
+
+                case 'd':
+                    pState->options |= VAR_SNAPSHOT_DIRTY;
+                    break;
+
+                case 'h':
+                default:
+                    result = EINVAL;
+                    break;
+            }
+        }
+
+        if ( optind < argC )
+        {
+            pState->path = argV[optind];
+        }
+        else
+        {
+            result = EINVAL;
+        }
+
+        if ( result != EOK )
+        {
+            usage( argV[0] );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  GetAbsolutePath                                                           */
+/*!
+    Get the absolute path of the snapshot file
+
+    The GetAbsolutePath function prefixes a relative path with the
+    current working directory.
+
+    @param[in]
+        path
+            pointer to the snapshot file path
+
+    @param[out]
+        buf
+            pointer to the buffer to store the absolute path
+
+    @param[in]
+        len
+            size of the output buffer
+
+    @retval EOK the absolute path was generated
+    @retval ENAMETOOLONG the path is too long
+    @retval other error from getcwd
+
+==============================================================================*/
+static int GetAbsolutePath( char *path, char *buf, size_t len )
+{
+    int result = EOK;
+    char cwd[PATH_MAX];
+    int n;
+
+    if ( path[0] == '/' )
+    {
+        n = snprintf( buf, len, "%s", path );
+    }
+    else if ( getcwd( cwd, sizeof( cwd ) ) != NULL )
+    {
+        n = snprintf( buf, len, "%s/%s", cwd, path );
+    }
+    else
+    {
+        n = 0;
+        result = errno;
+    }
+
+    if ( ( result == EOK ) &&
+         ( (size_t)n >= len ) )
+    {
+        result = ENAMETOOLONG;
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of varsnap group */
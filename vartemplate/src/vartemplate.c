@@ -39,6 +39,10 @@ SOFTWARE.
     values before outputting the result to the specified output
     file
 
+    The template is compiled once.  In watch mode (-w) the application
+    keeps running and renders the template again each time one of its
+    variables is modified.
+
 */
 /*============================================================================*/
 
@@ -48,11 +52,13 @@ SOFTWARE.
 
 #include <stdio.h>
 #include <stdint.h>
+#include <stdbool.h>
 #include <string.h>
 #include <errno.h>
 #include <stdlib.h>
 #include <unistd.h>
 #include <fcntl.h>
+#include <poll.h>
 #include <sys/stat.h>
 #include <varserver/varserver.h>
 #include <varserver/vartemplate.h>
@@ -74,6 +80,12 @@ int main( int argc, char **argv );
         Private function declarations
 ==============================================================================*/
 void usage( void );
+static int RenderOutput( VARSERVER_HANDLE hVarServer,
+                         VarTemplate *pVarTemplate,
+                         int fd_out );
+static int WatchTemplate( VARSERVER_HANDLE hVarServer,
+                          VarTemplate *pVarTemplate,
+                          int fd_out );
 
 /*==============================================================================
         Function definitions
@@ -106,9 +118,11 @@ int main(int argc, char **argv)
     int fd_out = STDOUT_FILENO;
     int c;
     int result = EINVAL;
+    bool watch = false;
     VARSERVER_HANDLE hVarServer;
+    VarTemplate *pVarTemplate = NULL;
 
-    while( ( c = getopt( argc, argv, "o:h" ) ) != -1 )
+    while( ( c = getopt( argc, argv, "o:wh" ) ) != -1 )
     {
         switch( c )
         {
@@ -117,6 +131,10 @@ int main(int argc, char **argv)
                 fd_out = open( outputFile, O_CREAT | O_WRONLY, 0600 );
                 break;
 
+            case 'w':
+                watch = true;
+                break;
+
             case 'h':
                 usage();
                 break;
@@ -140,8 +158,25 @@ int main(int argc, char **argv)
         if( ( fd_in >= 0 ) &&
             ( hVarServer != NULL ) )
         {
-            /* render the template to the output */
-            result = TEMPLATE_FileToFile( hVarServer, fd_in, fd_out );
+            /* compile the template once */
+            TEMPLATE_Compile( hVarServer, fd_in, &pVarTemplate );
+            close( fd_in );
+        }
+
+        if( pVarTemplate != NULL )
+        {
+            if( watch == true )
+            {
+                /* render the template whenever its variables change */
+                result = WatchTemplate( hVarServer, pVarTemplate, fd_out );
+            }
+            else
+            {
+                /* render the template to the output */
+                result = RenderOutput( hVarServer, pVarTemplate, fd_out );
+            }
+
+            TEMPLATE_Free( &pVarTemplate );
         }
 
         /* close the output file */
@@ -158,6 +193,135 @@ int main(int argc, char **argv)
     return result == EOK ? 0 : 1;
 }
 
+/*============================================================================*/
+/*  RenderOutput                                                              */
+/*!
+    Render the compiled template to the output
+
+    The RenderOutput function renders the compiled template to the
+    output.  If the output is a regular file its previous content is
+    replaced.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pVarTemplate
+            pointer to the compiled template
+
+    @param[in]
+        fd_out
+            output file descriptor
+
+    @retval EOK the template was rendered
+    @retval other error from TEMPLATE_Render
+
+==============================================================================*/
+static int RenderOutput( VARSERVER_HANDLE hVarServer,
+                         VarTemplate *pVarTemplate,
+                         int fd_out )
+{
+    struct stat sb;
+
+    if( ( fstat( fd_out, &sb ) == 0 ) &&
+        ( S_ISREG( sb.st_mode ) ) )
+    {
+        /* replace the previous output */
+        if( ftruncate( fd_out, 0 ) == 0 )
+        {
+            lseek( fd_out, 0, SEEK_SET );
+        }
+    }
+
+    return TEMPLATE_Render( hVarServer, pVarTemplate, fd_out );
+}
+
+/*============================================================================*/
+/*  WatchTemplate                                                             */
+/*!
+    Render the compiled template each time one of its variables changes
+
+    The WatchTemplate function requests modification notifications for
+    the variables of the compiled template, renders it, and then renders
+    it again each time one of its variables is modified.  Notifications
+    which arrive together are handled with a single render.  It only
+    returns if waiting for a notification fails.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        pVarTemplate
+            pointer to the compiled template
+
+    @param[in]
+        fd_out
+            output file descriptor
+
+    @retval EIO waiting for a notification failed
+    @retval other error requesting the notifications
+
+==============================================================================*/
+static int WatchTemplate( VARSERVER_HANDLE hVarServer,
+                          VarTemplate *pVarTemplate,
+                          int fd_out )
+{
+    int result = EINVAL;
+    struct pollfd pfd;
+    bool changed;
+    int32_t sigval;
+    int sig;
+
+    /* block the notification signals before requesting them */
+    pfd.fd = VARSERVER_Signalfd( 0 );
+    pfd.events = POLLIN;
+    if( pfd.fd != -1 )
+    {
+        result = TEMPLATE_Notify( hVarServer, pVarTemplate );
+    }
+
+    if( result == EOK )
+    {
+        RenderOutput( hVarServer, pVarTemplate, fd_out );
+    }
+
+    while( result == EOK )
+    {
+        /* wait for a notification, then collect any others
+           which are already pending */
+        changed = false;
+        do
+        {
+            sig = VARSERVER_WaitSignalfd( pfd.fd, &sigval );
+            if( sig == -1 )
+            {
+                result = ( errno == EINTR ) ? EOK : EIO;
+            }
+            else if( ( sig == SIG_VAR_MODIFIED ) &&
+                     ( TEMPLATE_HasVar( pVarTemplate,
+                                        (VAR_HANDLE)sigval ) == true ) )
+            {
+                changed = true;
+            }
+        } while( ( result == EOK ) &&
+                 ( poll( &pfd, 1, 0 ) == 1 ) );
+
+        if( changed == true )
+        {
+            RenderOutput( hVarServer, pVarTemplate, fd_out );
+        }
+    }
+
+    if( pfd.fd != -1 )
+    {
+        close( pfd.fd );
+    }
+
+    return result;
+}
+
 /*============================================================================*/
 /*  usage                                                                     */
 /*!
@@ -169,7 +333,10 @@ int main(int argc, char **argv)
 ==============================================================================*/
 void usage( void )
 {
-    printf("usage: print_template [-o output_file] [-h]\n" );
+    printf("usage: vartemplate [-o output_file] [-w] [-h] template_file\n" );
+    printf("-o : write the output to output_file\n" );
+    printf("-w : render again whenever a template variable changes\n" );
+    printf("-h : display this help\n" );
     exit( 0 );
 }
 
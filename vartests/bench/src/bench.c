@@ -0,0 +1,2334 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup bench Variable Server Benchmark
+ * @brief Variable Server latency and throughput benchmark
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file bench.c
+
+    Variable Server Benchmark
+
+    The bench client measures the performance of a running variable
+    server using a number of concurrent client processes.  It measures:
+
+    - get/set round trip latency for each variable type
+    - notification fan-out latency from VAR_Set to receipt of the
+      modified signal, and to VAR_GetFromQueue for queued notifications
+    - VAR_FindByName latency on large sets of variable names
+    - VARQUERY_Search latency on large sets of variables
+
+    The results are written as a JSON document so they can be collected
+    and compared across releases.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <time.h>
+#include <inttypes.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <varserver/varserver.h>
+#include <varserver/varquery.h>
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+#ifndef BENCH_VERSION
+/*! version of the variable server being benchmarked */
+#define BENCH_VERSION "unknown"
+#endif
+
+/*! maximum number of concurrent benchmark clients */
+#define BENCH_MAX_CLIENTS ( 64 )
+
+/*! maximum number of name set sizes */
+#define BENCH_MAX_SIZES ( 8 )
+
+/*! number of variables created per VARSERVER_CreateVars call */
+#define BENCH_CREATE_BATCH ( 1024 )
+
+/*! length of the benchmark string values */
+#define BENCH_STR_LEN ( 64 )
+
+/*! length of the benchmark blob values */
+#define BENCH_BLOB_LEN ( 256 )
+
+/*! number of groups the name set variables are spread across */
+#define BENCH_GROUPS ( 100 )
+
+/*! time to wait for a notification before giving up (ms) */
+#define BENCH_NOTIFY_TIMEOUT_MS ( 1000 )
+
+/*! time to wait for the clients to become ready (ms) */
+#define BENCH_READY_TIMEOUT_MS ( 5000 )
+
+/*! nanoseconds per second */
+#define NS_PER_SEC ( 1000000000ULL )
+
+struct benchState;
+
+/*! benchmark client function */
+typedef int (*BenchFn)( struct benchState *pState,
+                        VARSERVER_HANDLE hVarServer,
+                        int client,
+                        uint64_t *pSamples,
+                        size_t n,
+                        size_t *pCount );
+
+/*! benchmark test definition */
+typedef struct benchTest
+{
+    /*! name of the test */
+    char *name;
+
+    /*! type of the variables used by the test */
+    VarType type;
+
+    /*! number of samples collected by each client */
+    size_t n;
+
+    /*! size of the name set used by the test (0 if none) */
+    size_t variables;
+
+    /*! optional per-client setup run before the clients are released */
+    BenchFn setup;
+
+    /*! per-client measurement function */
+    BenchFn run;
+
+    /*! optional driver run by the parent while the clients are running */
+    int (*driver)( struct benchState *pState, size_t n );
+
+} BenchTest;
+
+/*! shared state for synchronizing the benchmark processes */
+typedef struct benchShared
+{
+    /*! number of clients which have completed their setup */
+    uint32_t ready;
+
+    /*! number of notifications received for the current change */
+    uint32_t acks;
+
+    /*! time the current change was made (ns) */
+    uint64_t setTime;
+
+    /*! number of samples collected by each client */
+    size_t count[BENCH_MAX_CLIENTS];
+
+    /*! number of errors seen by each client */
+    size_t errors[BENCH_MAX_CLIENTS];
+
+} BenchShared;
+
+/*! Benchmark state */
+typedef struct benchState
+{
+    /*! variable server handle */
+    VARSERVER_HANDLE hVarServer;
+
+    /*! show program usage */
+    bool usage;
+
+    /*! number of concurrent client processes */
+    int clients;
+
+    /*! number of get/set and find iterations per client */
+    size_t iterations;
+
+    /*! number of notifications sent by the fan-out tests */
+    size_t notifications;
+
+    /*! number of searches per client */
+    size_t searches;
+
+    /*! sizes of the name sets used by the find and search tests */
+    size_t sizes[BENCH_MAX_SIZES];
+
+    /*! number of name set sizes */
+    size_t nsizes;
+
+    /*! number of name set variables which currently exist */
+    size_t population;
+
+    /*! output file name (NULL for stdout) */
+    char *outfile;
+
+    /*! output stream for the results */
+    FILE *fp;
+
+    /*! number of results written */
+    size_t nresults;
+
+    /*! process shared synchronization state */
+    BenchShared *pShared;
+
+    /*! process shared sample buffer */
+    uint64_t *pSamples;
+
+    /*! number of samples available per client */
+    size_t maxSamples;
+
+    /*! read end of the pipe used to release the clients */
+    int startfd;
+
+    /*! type of the variables used by the running test */
+    VarType type;
+
+    /*! variable being used by the fan-out driver */
+    VAR_HANDLE hNotifyVar;
+
+    /*! variable being used by a benchmark client */
+    VAR_HANDLE hTestVar;
+
+} BenchState;
+
+/*==============================================================================
+        Private file scoped variables
+==============================================================================*/
+
+/*! Benchmark state object */
+static BenchState state;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+int main(int argc, char **argv);
+static void usage( char *cmdname );
+static int ProcessOptions( int argC, char *argV[], BenchState *pState );
+static int ParseSizes( char *sizes, BenchState *pState );
+static int Setup( BenchState *pState );
+static void Cleanup( BenchState *pState );
+static uint64_t Now( void );
+
+static int CreateVar( VARSERVER_HANDLE hVarServer,
+                      char *name,
+                      VarType type,
+                      VAR_HANDLE *pVarHandle );
+static int CreateNameSet( BenchState *pState, size_t n );
+static void NameSetName( size_t idx, char *name, size_t len );
+static void TestVarName( int client,
+                         VarType type,
+                         char *name,
+                         size_t len );
+static int SetupObject( VarObject *pVarObject, VarType type, char *buf );
+
+static int RunTest( BenchState *pState, BenchTest *pTest );
+static int RunClient( BenchState *pState, BenchTest *pTest, int client );
+static int WaitReady( BenchState *pState, pid_t *pids, int n );
+static int ReportResult( BenchState *pState,
+                         BenchTest *pTest,
+                         uint64_t elapsed );
+static int CompareSamples( const void *a, const void *b );
+
+static int RunRoundTripTests( BenchState *pState );
+static int RunNotifyTests( BenchState *pState );
+static int RunNameSetTests( BenchState *pState );
+
+static int SetupRoundTrip( BenchState *pState,
+                           VARSERVER_HANDLE hVarServer,
+                           int client,
+                           uint64_t *pSamples,
+                           size_t n,
+                           size_t *pCount );
+static int RunSet( BenchState *pState,
+                   VARSERVER_HANDLE hVarServer,
+                   int client,
+                   uint64_t *pSamples,
+                   size_t n,
+                   size_t *pCount );
+static int RunGet( BenchState *pState,
+                   VARSERVER_HANDLE hVarServer,
+                   int client,
+                   uint64_t *pSamples,
+                   size_t n,
+                   size_t *pCount );
+static int SetupNotify( BenchState *pState,
+                        VARSERVER_HANDLE hVarServer,
+                        int client,
+                        uint64_t *pSamples,
+                        size_t n,
+                        size_t *pCount );
+static int SetupNotifyQueue( BenchState *pState,
+                             VARSERVER_HANDLE hVarServer,
+                             int client,
+                             uint64_t *pSamples,
+                             size_t n,
+                             size_t *pCount );
+static int RunNotify( BenchState *pState,
+                      VARSERVER_HANDLE hVarServer,
+                      int client,
+                      uint64_t *pSamples,
+                      size_t n,
+                      size_t *pCount );
+static int DriveNotify( BenchState *pState, size_t n );
+static int RunFind( BenchState *pState,
+                    VARSERVER_HANDLE hVarServer,
+                    int client,
+                    uint64_t *pSamples,
+                    size_t n,
+                    size_t *pCount );
+static int RunSearchPrefix( BenchState *pState,
+                            VARSERVER_HANDLE hVarServer,
+                            int client,
+                            uint64_t *pSamples,
+                            size_t n,
+                            size_t *pCount );
+static int RunSearchRegex( BenchState *pState,
+                           VARSERVER_HANDLE hVarServer,
+                           int client,
+                           uint64_t *pSamples,
+                           size_t n,
+                           size_t *pCount );
+static int RunSearch( BenchState *pState,
+                      VARSERVER_HANDLE hVarServer,
+                      int client,
+                      int searchType,
+                      char *match,
+                      uint64_t *pSamples,
+                      size_t n,
+                      size_t *pCount );
+
+/*==============================================================================
+        Private function definitions
+==============================================================================*/
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the bench application
+
+    The main function starts the bench application
+
+    @param[in]
+        argc
+            number of arguments on the command line
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @return none
+
+==============================================================================*/
+int main(int argc, char **argv)
+{
+    int rc;
+    int result = 1;
+
+    /* clear the state object */
+    memset( &state, 0, sizeof( BenchState ) );
+
+    /* set up some default state values */
+    state.clients = 4;
+    state.iterations = 10000;
+    state.notifications = 1000;
+    state.searches = 10;
+    state.sizes[0] = 10000;
+    state.sizes[1] = 60000;
+    state.nsizes = 2;
+
+    /* process the command line options */
+    if( ( ProcessOptions( argc, argv, &state ) != EOK ) ||
+        ( state.usage == true ) )
+    {
+        usage( argv[0] );
+        exit( 1 );
+    }
+
+    rc = Setup( &state );
+    if( rc == EOK )
+    {
+        fprintf( state.fp,
+                 "{\n"
+                 "  \"benchmark\": \"varserver\",\n"
+                 "  \"version\": \"%s\",\n"
+                 "  \"timestamp\": %" PRIu64 ",\n"
+                 "  \"clients\": %d,\n"
+                 "  \"iterations\": %zu,\n"
+                 "  \"results\": [",
+                 BENCH_VERSION,
+                 (uint64_t)time( NULL ),
+                 state.clients,
+                 state.iterations );
+
+        rc = RunRoundTripTests( &state );
+        if( rc == EOK )
+        {
+            rc = RunNotifyTests( &state );
+        }
+
+        if( rc == EOK )
+        {
+            rc = RunNameSetTests( &state );
+        }
+
+        fprintf( state.fp, "\n  ]\n}\n" );
+    }
+
+    if( rc == EOK )
+    {
+        result = 0;
+    }
+    else
+    {
+        fprintf( stderr, "BENCH: Failed (%d) %s\n", rc, strerror( rc ) );
+    }
+
+    Cleanup( &state );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  usage                                                                     */
+/*!
+    Display the application usage
+
+    The usage function dumps the application usage message to stderr.
+
+    @param[in]
+       cmdname
+            pointer to the invoked command name
+
+    @return none
+
+==============================================================================*/
+static void usage( char *cmdname )
+{
+    if( cmdname != NULL )
+    {
+        fprintf(stderr,
+                "usage: %s [-h] [-c clients] [-n iterations]"
+                " [-f notifications] [-q searches] [-s sizes]"
+                " [-o output]\n"
+                " [-h] : display this help\n"
+                " [-c] : number of concurrent client processes (default 4)\n"
+                " [-n] : get/set/find iterations per client (default 10000)\n"
+                " [-f] : notifications per fan-out test (default 1000)\n"
+                " [-q] : searches per client (default 10)\n"
+                " [-s] : comma separated name set sizes "
+                "(default 10000,60000)\n"
+                " [-o] : write the JSON results to a file\n",
+                cmdname );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessOptions                                                            */
+/*!
+    Process the command line options
+
+    The ProcessOptions function processes the command line options and
+    populates the BenchState object
+
+    @param[in]
+        argC
+            number of arguments
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @retval EOK - the options were processed successfully
+    @retval EINVAL - invalid arguments
+
+==============================================================================*/
+static int ProcessOptions( int argC, char *argV[], BenchState *pState )
+{
+    int c;
+    int result = EINVAL;
+    const char *options = "hc:n:f:q:s:o:";
+
+    if( ( pState != NULL ) &&
+        ( argV != NULL ) )
+    {
+        result = EOK;
+
+        while( ( c = getopt( argC, argV, options ) ) != -1 )
+        {
+            switch( c )
+            {
+                case 'h':
+                    pState->usage = true;
+                    break;
+
+                case 'c':
+                    pState->clients = atoi( optarg );
+                    break;
+
+                case 'n':
+                    pState->iterations = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'f':
+                    pState->notifications = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 'q':
+                    pState->searches = strtoul( optarg, NULL, 0 );
+                    break;
+
+                case 's':
+                    result = ParseSizes( optarg, pState );
+                    break;
+
+                case 'o':
+                    pState->outfile = optarg;
+                    break;
+
+                default:
+                    result = EINVAL;
+                    break;
+            }
+        }
+
+        if( ( pState->clients < 1 ) ||
+            ( pState->clients > BENCH_MAX_CLIENTS ) ||
+            ( pState->iterations == 0 ) ||
+            ( pState->notifications == 0 ) ||
+            ( pState->searches == 0 ) )
+        {
+            result = EINVAL;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  ParseSizes                                                                */
+/*!
+    Parse the list of name set sizes
+
+    The ParseSizes function parses a comma separated list of name set
+    sizes.  The sizes must be in ascending order since each name set
+    is built by extending the previous one.
+
+    @param[in]
+        sizes
+            comma separated list of name set sizes
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @retval EOK - the sizes were parsed successfully
+    @retval EINVAL - invalid size list
+
+==============================================================================*/
+static int ParseSizes( char *sizes, BenchState *pState )
+{
+    int result = EOK;
+    char *p = sizes;
+    char *end;
+    size_t n;
+
+    pState->nsizes = 0;
+
+    while( ( result == EOK ) && ( *p != '\0' ) )
+    {
+        n = strtoul( p, &end, 0 );
+        if( ( end == p ) ||
+            ( n == 0 ) ||
+            ( pState->nsizes == BENCH_MAX_SIZES ) ||
+            ( ( pState->nsizes > 0 ) &&
+              ( n <= pState->sizes[pState->nsizes - 1] ) ) )
+        {
+            result = EINVAL;
+        }
+        else
+        {
+            pState->sizes[pState->nsizes++] = n;
+            p = ( *end == ',' ) ? end + 1 : end;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Setup                                                                     */
+/*!
+    Set up the benchmark
+
+    The Setup function opens the output stream and the variable server,
+    and allocates the process shared synchronization and sample buffers.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @retval EOK - the benchmark was set up successfully
+    @retval ENOMEM - memory allocation failed
+    @retval other - error from fopen or VARSERVER_Open
+
+==============================================================================*/
+static int Setup( BenchState *pState )
+{
+    int result = EOK;
+    size_t len;
+
+    pState->fp = stdout;
+    if( pState->outfile != NULL )
+    {
+        pState->fp = fopen( pState->outfile, "w" );
+        if( pState->fp == NULL )
+        {
+            result = errno;
+        }
+    }
+
+    if( result == EOK )
+    {
+        pState->hVarServer = VARSERVER_Open();
+        if( pState->hVarServer == NULL )
+        {
+            result = ENOTCONN;
+        }
+    }
+
+    if( result == EOK )
+    {
+        pState->maxSamples = pState->iterations;
+        if( pState->notifications > pState->maxSamples )
+        {
+            pState->maxSamples = pState->notifications;
+        }
+
+        if( pState->searches > pState->maxSamples )
+        {
+            pState->maxSamples = pState->searches;
+        }
+
+        pState->pShared = mmap( NULL,
+                                sizeof( BenchShared ),
+                                PROT_READ | PROT_WRITE,
+                                MAP_SHARED | MAP_ANONYMOUS,
+                                -1,
+                                0 );
+
+        len = pState->maxSamples * pState->clients * sizeof( uint64_t );
+        pState->pSamples = mmap( NULL,
+                                 len,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_SHARED | MAP_ANONYMOUS,
+                                 -1,
+                                 0 );
+
+        if( ( pState->pShared == MAP_FAILED ) ||
+            ( pState->pSamples == MAP_FAILED ) )
+        {
+            pState->pShared = NULL;
+            pState->pSamples = NULL;
+            result = ENOMEM;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  Cleanup                                                                   */
+/*!
+    Clean up the benchmark resources
+
+    The Cleanup function closes the variable server and output stream
+    and releases the shared buffers.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+==============================================================================*/
+static void Cleanup( BenchState *pState )
+{
+    if( pState->hVarServer != NULL )
+    {
+        VARSERVER_Close( pState->hVarServer );
+        pState->hVarServer = NULL;
+    }
+
+    if( ( pState->fp != NULL ) &&
+        ( pState->fp != stdout ) )
+    {
+        fclose( pState->fp );
+    }
+
+    pState->fp = NULL;
+}
+
+/*============================================================================*/
+/*  Now                                                                       */
+/*!
+    Get the current monotonic time
+
+    @retval the current CLOCK_MONOTONIC time in nanoseconds
+
+==============================================================================*/
+static uint64_t Now( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+
+    return (uint64_t)ts.tv_sec * NS_PER_SEC + (uint64_t)ts.tv_nsec;
+}
+
+/*============================================================================*/
+/*  CreateVar                                                                 */
+/*!
+    Create a benchmark variable
+
+    The CreateVar function creates a volatile benchmark variable of the
+    specified type.  A variable which already exists (for example from
+    a previous run) is reused.
+
+    @param[in]
+        hVarServer
+            handle to the variable server
+
+    @param[in]
+        name
+            name of the variable to create
+
+    @param[in]
+        type
+            type of variable to create
+
+    @param[out]
+        pVarHandle
+            location to store the variable handle
+
+    @retval EOK - the variable is available
+    @retval other - the variable could not be created
+
+==============================================================================*/
+static int CreateVar( VARSERVER_HANDLE hVarServer,
+                      char *name,
+                      VarType type,
+                      VAR_HANDLE *pVarHandle )
+{
+    int result;
+    VarInfo info;
+
+    memset( &info, 0, sizeof( VarInfo ) );
+    strncpy( info.name, name, MAX_NAME_LEN );
+    info.flags = VARFLAG_VOLATILE;
+    info.var.type = type;
+
+    if( type == VARTYPE_STR )
+    {
+        info.var.len = BENCH_STR_LEN;
+    }
+    else if( type == VARTYPE_BLOB )
+    {
+        info.var.len = BENCH_BLOB_LEN;
+    }
+
+    result = VARSERVER_CreateVar( hVarServer, &info );
+    if( ( result == EOK ) || ( result == EEXIST ) )
+    {
+        *pVarHandle = VAR_FindByName( hVarServer, name );
+        result = ( *pVarHandle == VAR_INVALID ) ? ENOENT : EOK;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  NameSetName                                                               */
+/*!
+    Generate the name of a name set variable
+
+    @param[in]
+        idx
+            index of the variable in the name set
+
+    @param[out]
+        name
+            buffer to store the name
+
+    @param[in]
+        len
+            size of the name buffer
+
+==============================================================================*/
+static void NameSetName( size_t idx, char *name, size_t len )
+{
+    snprintf( name, len, "/bench/names/g%zu/v%zu", idx % BENCH_GROUPS, idx );
+}
+
+/*============================================================================*/
+/*  TestVarName                                                               */
+/*!
+    Generate the name of a client round trip test variable
+
+    @param[in]
+        client
+            index of the benchmark client
+
+    @param[in]
+        type
+            type of the test variable
+
+    @param[out]
+        name
+            buffer to store the name
+
+    @param[in]
+        len
+            size of the name buffer
+
+==============================================================================*/
+static void TestVarName( int client,
+                         VarType type,
+                         char *name,
+                         size_t len )
+{
+    char typeName[32];
+
+    VARSERVER_TypeToTypeName( type, typeName, sizeof( typeName ) );
+    snprintf( name, len, "/bench/rt/%d/%s", client, typeName );
+}
+
+/*============================================================================*/
+/*  CreateNameSet                                                             */
+/*!
+    Grow the name set to the specified size
+
+    The CreateNameSet function creates the name set variables which do
+    not yet exist, using VARSERVER_CreateVars to create them in bulk.
+    Variables left over from a previous run are reused.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        n
+            required size of the name set
+
+    @retval EOK - the name set was created
+    @retval ENOMEM - memory allocation failed
+    @retval other - the variables could not be created
+
+==============================================================================*/
+static int CreateNameSet( BenchState *pState, size_t n )
+{
+    int result = EOK;
+    VarInfo *pVarInfo;
+    int *results;
+    size_t count;
+    size_t i;
+    int rc;
+
+    pVarInfo = calloc( BENCH_CREATE_BATCH, sizeof( VarInfo ) );
+    results = calloc( BENCH_CREATE_BATCH, sizeof( int ) );
+    if( ( pVarInfo == NULL ) || ( results == NULL ) )
+    {
+        result = ENOMEM;
+    }
+
+    while( ( result == EOK ) && ( pState->population < n ) )
+    {
+        count = n - pState->population;
+        if( count > BENCH_CREATE_BATCH )
+        {
+            count = BENCH_CREATE_BATCH;
+        }
+
+        memset( pVarInfo, 0, count * sizeof( VarInfo ) );
+        for( i = 0; i < count; i++ )
+        {
+            NameSetName( pState->population + i,
+                         pVarInfo[i].name,
+                         sizeof( pVarInfo[i].name ) );
+            pVarInfo[i].flags = VARFLAG_VOLATILE;
+            pVarInfo[i].var.type = VARTYPE_UINT32;
+        }
+
+        VARSERVER_CreateVars( pState->hVarServer, pVarInfo, results, count );
+        for( i = 0; i < count; i++ )
+        {
+            rc = results[i];
+            if( ( rc != EOK ) && ( rc != EEXIST ) )
+            {
+                result = rc;
+            }
+        }
+
+        pState->population += count;
+    }
+
+    free( pVarInfo );
+    free( results );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupObject                                                               */
+/*!
+    Set up a VarObject for a round trip test
+
+    The SetupObject function initializes a VarObject of the specified
+    type with a test value.  String and blob objects use the
+    caller-supplied buffer, which must be at least BENCH_BLOB_LEN bytes.
+
+    @param[in]
+        pVarObject
+            pointer to the VarObject to initialize
+
+    @param[in]
+        type
+            type of the VarObject
+
+    @param[in]
+        buf
+            buffer for string and blob data
+
+    @retval EOK - the object was initialized
+    @retval ENOTSUP - unsupported type
+
+==============================================================================*/
+static int SetupObject( VarObject *pVarObject, VarType type, char *buf )
+{
+    int result = EOK;
+
+    memset( pVarObject, 0, sizeof( VarObject ) );
+    pVarObject->type = type;
+
+    switch( type )
+    {
+        case VARTYPE_UINT32:
+            pVarObject->len = sizeof( uint32_t );
+            pVarObject->val.ul = 0x5A5A5A5A;
+            break;
+
+        case VARTYPE_UINT64:
+            pVarObject->len = sizeof( uint64_t );
+            pVarObject->val.ull = 0x5A5A5A5A5A5A5A5AULL;
+            break;
+
+        case VARTYPE_FLOAT:
+            pVarObject->len = sizeof( float );
+            pVarObject->val.f = 3.14159;
+            break;
+
+        case VARTYPE_STR:
+            memset( buf, 'x', BENCH_STR_LEN - 1 );
+            buf[BENCH_STR_LEN - 1] = '\0';
+            pVarObject->val.str = buf;
+            pVarObject->len = BENCH_STR_LEN;
+            break;
+
+        case VARTYPE_BLOB:
+            memset( buf, 0xA5, BENCH_BLOB_LEN );
+            pVarObject->val.blob = buf;
+            pVarObject->len = BENCH_BLOB_LEN;
+            break;
+
+        default:
+            result = ENOTSUP;
+            break;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunTest                                                                   */
+/*!
+    Run a benchmark test
+
+    The RunTest function forks one process per benchmark client.  Each
+    client opens its own connection to the variable server and runs the
+    test setup function.  Once all the clients are ready they are released
+    together, and each runs the measurement function, storing its latency
+    samples in the shared sample buffer.  The optional driver function is
+    run in the parent while the clients are running.  When all the clients
+    have exited the merged result is written to the output.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        pTest
+            pointer to the test to run
+
+    @retval EOK - the test was run
+    @retval other - the test could not be run
+
+==============================================================================*/
+static int RunTest( BenchState *pState, BenchTest *pTest )
+{
+    int result = EOK;
+    pid_t pids[BENCH_MAX_CLIENTS];
+    int startfd[2];
+    uint64_t start = 0;
+    uint64_t elapsed;
+    int status;
+    int n = 0;
+    int rc;
+    int i;
+
+    memset( pState->pShared, 0, sizeof( BenchShared ) );
+
+    /* the clients are released when the write end of the pipe is closed */
+    if( pipe( startfd ) != 0 )
+    {
+        result = errno;
+    }
+
+    /* make sure buffered output is not duplicated into the clients */
+    fflush( pState->fp );
+    pState->startfd = startfd[0];
+
+    while( ( result == EOK ) && ( n < pState->clients ) )
+    {
+        pids[n] = fork();
+        if( pids[n] == 0 )
+        {
+            close( startfd[1] );
+            result = RunClient( pState, pTest, n );
+            _exit( ( result == EOK ) ? 0 : 1 );
+        }
+        else if( pids[n] < 0 )
+        {
+            result = errno;
+        }
+        else
+        {
+            n++;
+        }
+    }
+
+    if( result == EOK )
+    {
+        result = WaitReady( pState, pids, n );
+    }
+
+    if( ( result == EOK ) && ( pTest->n > 0 ) )
+    {
+        /* release the clients */
+        start = Now();
+        close( startfd[1] );
+        startfd[1] = -1;
+
+        if( pTest->driver != NULL )
+        {
+            result = pTest->driver( pState, pTest->n );
+        }
+    }
+
+    if( startfd[1] != -1 )
+    {
+        close( startfd[1] );
+    }
+
+    for( i = 0; i < n; i++ )
+    {
+        if( ( waitpid( pids[i], &status, 0 ) == pids[i] ) &&
+            ( ( !WIFEXITED( status ) ) || ( WEXITSTATUS( status ) != 0 ) ) )
+        {
+            result = ( result == EOK ) ? ECHILD : result;
+        }
+    }
+
+    elapsed = Now() - start;
+    close( startfd[0] );
+
+    if( result == EOK )
+    {
+        rc = ReportResult( pState, pTest, elapsed );
+        if( rc != EOK )
+        {
+            result = rc;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunClient                                                                 */
+/*!
+    Run a benchmark client
+
+    The RunClient function runs in the forked client process.  It opens
+    a connection to the variable server, runs the test setup, signals
+    that it is ready, and waits to be released before running the
+    measurement function.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        pTest
+            pointer to the test to run
+
+    @param[in]
+        client
+            index of the benchmark client
+
+    @retval EOK - the client completed the test
+    @retval other - the client failed
+
+==============================================================================*/
+static int RunClient( BenchState *pState, BenchTest *pTest, int client )
+{
+    int result = EOK;
+    VARSERVER_HANDLE hVarServer;
+    uint64_t *pSamples;
+    size_t count = 0;
+    char c;
+
+    /* the parent connection is not usable from the child */
+    pState->hVarServer = NULL;
+    pState->type = pTest->type;
+
+    pSamples = &pState->pSamples[client * pState->maxSamples];
+
+    hVarServer = VARSERVER_Open();
+    if( hVarServer == NULL )
+    {
+        result = ENOTCONN;
+    }
+
+    if( ( result == EOK ) && ( pTest->setup != NULL ) )
+    {
+        result = pTest->setup( pState,
+                               hVarServer,
+                               client,
+                               pSamples,
+                               pTest->n,
+                               &count );
+    }
+
+    if( result == EOK )
+    {
+        __atomic_add_fetch( &pState->pShared->ready, 1, __ATOMIC_SEQ_CST );
+
+        /* wait for the parent to close the start pipe */
+        while( read( pState->startfd, &c, 1 ) > 0 );
+
+        count = 0;
+        result = pTest->run( pState,
+                             hVarServer,
+                             client,
+                             pSamples,
+                             pTest->n,
+                             &count );
+        pState->pShared->count[client] = count;
+    }
+
+    if( hVarServer != NULL )
+    {
+        VARSERVER_Close( hVarServer );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  WaitReady                                                                 */
+/*!
+    Wait for the benchmark clients to become ready
+
+    The WaitReady function waits for all the benchmark clients to complete
+    their setup.  It fails if a client exits or does not become ready in
+    time.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        pids
+            array of client process identifiers
+
+    @param[in]
+        n
+            number of clients
+
+    @retval EOK - all the clients are ready
+    @retval ECHILD - a client exited during setup
+    @retval ETIMEDOUT - the clients did not become ready in time
+
+==============================================================================*/
+static int WaitReady( BenchState *pState, pid_t *pids, int n )
+{
+    int result = ETIMEDOUT;
+    uint64_t deadline = Now() + BENCH_READY_TIMEOUT_MS * 1000000ULL;
+    uint32_t ready;
+    int status;
+    int i;
+
+    while( ( result == ETIMEDOUT ) && ( Now() < deadline ) )
+    {
+        ready = __atomic_load_n( &pState->pShared->ready, __ATOMIC_SEQ_CST );
+        if( ready == (uint32_t)n )
+        {
+            result = EOK;
+        }
+        else
+        {
+            for( i = 0; i < n; i++ )
+            {
+                if( waitpid( pids[i], &status, WNOHANG ) == pids[i] )
+                {
+                    /* the client has already been reaped */
+                    pids[i] = -1;
+                    result = ECHILD;
+                }
+            }
+
+            usleep( 1000 );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  CompareSamples                                                            */
+/*!
+    Compare two latency samples for qsort
+
+    @param[in]
+        a
+            pointer to the first sample
+
+    @param[in]
+        b
+            pointer to the second sample
+
+    @retval -1 - a < b
+    @retval 0 - a == b
+    @retval 1 - a > b
+
+==============================================================================*/
+static int CompareSamples( const void *a, const void *b )
+{
+    uint64_t x = *(const uint64_t *)a;
+    uint64_t y = *(const uint64_t *)b;
+
+    return ( x < y ) ? -1 : ( x > y ) ? 1 : 0;
+}
+
+/*============================================================================*/
+/*  ReportResult                                                              */
+/*!
+    Write the result of a benchmark test
+
+    The ReportResult function merges the latency samples from all the
+    clients and writes the latency distribution and throughput of the
+    test to the output as a JSON object.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        pTest
+            pointer to the test which was run
+
+    @param[in]
+        elapsed
+            wall clock duration of the test (ns)
+
+    @retval EOK - the result was written
+    @retval ENOMEM - memory allocation failed
+
+==============================================================================*/
+static int ReportResult( BenchState *pState,
+                         BenchTest *pTest,
+                         uint64_t elapsed )
+{
+    int result = EOK;
+    BenchShared *pShared = pState->pShared;
+    uint64_t *pSamples = NULL;
+    uint64_t sum = 0;
+    size_t total = 0;
+    size_t errors = 0;
+    size_t count;
+    size_t i;
+    char typeName[32];
+    double rate = 0.0;
+
+    for( i = 0; i < (size_t)pState->clients; i++ )
+    {
+        total += pShared->count[i];
+        errors += pShared->errors[i];
+    }
+
+    if( total > 0 )
+    {
+        pSamples = malloc( total * sizeof( uint64_t ) );
+        if( pSamples == NULL )
+        {
+            result = ENOMEM;
+        }
+    }
+
+    if( result == EOK )
+    {
+        total = 0;
+        for( i = 0; i < (size_t)pState->clients; i++ )
+        {
+            count = pShared->count[i];
+            memcpy( &pSamples[total],
+                    &pState->pSamples[i * pState->maxSamples],
+                    count * sizeof( uint64_t ) );
+            total += count;
+        }
+
+        for( i = 0; i < total; i++ )
+        {
+            sum += pSamples[i];
+        }
+
+        if( total > 0 )
+        {
+            qsort( pSamples, total, sizeof( uint64_t ), CompareSamples );
+        }
+
+        if( elapsed > 0 )
+        {
+            rate = (double)total * NS_PER_SEC / (double)elapsed;
+        }
+
+        VARSERVER_TypeToTypeName( pTest->type, typeName, sizeof( typeName ) );
+
+        fprintf( pState->fp,
+                 "%s\n    {\"test\": \"%s\", \"type\": \"%s\", "
+                 "\"clients\": %d, \"variables\": %zu, "
+                 "\"samples\": %zu, \"errors\": %zu, "
+                 "\"ops_per_sec\": %.1f, "
+                 "\"min_ns\": %" PRIu64 ", \"mean_ns\": %" PRIu64 ", "
+                 "\"p50_ns\": %" PRIu64 ", \"p90_ns\": %" PRIu64 ", "
+                 "\"p99_ns\": %" PRIu64 ", \"max_ns\": %" PRIu64 "}",
+                 ( pState->nresults > 0 ) ? "," : "",
+                 pTest->name,
+                 typeName,
+                 pState->clients,
+                 pTest->variables,
+                 total,
+                 errors,
+                 rate,
+                 total ? pSamples[0] : 0,
+                 total ? sum / total : 0,
+                 total ? pSamples[( total - 1 ) * 50 / 100] : 0,
+                 total ? pSamples[( total - 1 ) * 90 / 100] : 0,
+                 total ? pSamples[( total - 1 ) * 99 / 100] : 0,
+                 total ? pSamples[total - 1] : 0 );
+
+        fflush( pState->fp );
+        pState->nresults++;
+    }
+
+    free( pSamples );
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunRoundTripTests                                                         */
+/*!
+    Run the get/set round trip tests
+
+    The RunRoundTripTests function creates a test variable of each type
+    for each client, and measures the VAR_Set and VAR_Get latency of
+    each type.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @retval EOK - the tests were run
+    @retval other - the tests could not be run
+
+==============================================================================*/
+static int RunRoundTripTests( BenchState *pState )
+{
+    int result = EOK;
+    static const VarType types[] =
+    {
+        VARTYPE_UINT32,
+        VARTYPE_UINT64,
+        VARTYPE_FLOAT,
+        VARTYPE_STR,
+        VARTYPE_BLOB
+    };
+    BenchTest test;
+    VAR_HANDLE hVar;
+    char name[MAX_NAME_LEN + 1];
+    size_t i;
+    int client;
+
+    for( i = 0; ( result == EOK ) && ( i < sizeof(types)/sizeof(types[0]) );
+         i++ )
+    {
+        for( client = 0;
+             ( result == EOK ) && ( client < pState->clients );
+             client++ )
+        {
+            TestVarName( client, types[i], name, sizeof( name ) );
+            result = CreateVar( pState->hVarServer, name, types[i], &hVar );
+        }
+
+        memset( &test, 0, sizeof( BenchTest ) );
+        test.type = types[i];
+        test.n = pState->iterations;
+        test.setup = SetupRoundTrip;
+
+        if( result == EOK )
+        {
+            test.name = "set";
+            test.run = RunSet;
+            result = RunTest( pState, &test );
+        }
+
+        if( result == EOK )
+        {
+            test.name = "get";
+            test.run = RunGet;
+            result = RunTest( pState, &test );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunNotifyTests                                                            */
+/*!
+    Run the notification fan-out tests
+
+    The RunNotifyTests function measures the time from a VAR_Set call
+    in the parent to the receipt of the change by every client, first
+    using the modified signal, and then using the notification queue.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @retval EOK - the tests were run
+    @retval other - the tests could not be run
+
+==============================================================================*/
+static int RunNotifyTests( BenchState *pState )
+{
+    int result;
+    BenchTest test;
+
+    memset( &test, 0, sizeof( BenchTest ) );
+    test.type = VARTYPE_UINT32;
+    test.n = pState->notifications;
+    test.run = RunNotify;
+    test.driver = DriveNotify;
+
+    result = CreateVar( pState->hVarServer,
+                        "/bench/notify/signal",
+                        VARTYPE_UINT32,
+                        &pState->hNotifyVar );
+    if( result == EOK )
+    {
+        test.name = "notify_signal";
+        test.setup = SetupNotify;
+        result = RunTest( pState, &test );
+    }
+
+    if( result == EOK )
+    {
+        result = CreateVar( pState->hVarServer,
+                            "/bench/notify/queue",
+                            VARTYPE_UINT32,
+                            &pState->hNotifyVar );
+    }
+
+    if( result == EOK )
+    {
+        test.name = "notify_queue";
+        test.setup = SetupNotifyQueue;
+        result = RunTest( pState, &test );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunNameSetTests                                                           */
+/*!
+    Run the name lookup and search tests
+
+    The RunNameSetTests function grows the name set to each of the
+    configured sizes in turn, and measures the VAR_FindByName and
+    VARQUERY_Search latency at each size.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @retval EOK - the tests were run
+    @retval other - the tests could not be run
+
+==============================================================================*/
+static int RunNameSetTests( BenchState *pState )
+{
+    int result = EOK;
+    BenchTest test;
+    size_t i;
+
+    for( i = 0; ( result == EOK ) && ( i < pState->nsizes ); i++ )
+    {
+        result = CreateNameSet( pState, pState->sizes[i] );
+
+        memset( &test, 0, sizeof( BenchTest ) );
+        test.type = VARTYPE_UINT32;
+        test.variables = pState->sizes[i];
+
+        if( result == EOK )
+        {
+            test.name = "find";
+            test.n = pState->iterations;
+            test.run = RunFind;
+            result = RunTest( pState, &test );
+        }
+
+        if( result == EOK )
+        {
+            test.name = "search_prefix";
+            test.n = pState->searches;
+            test.run = RunSearchPrefix;
+            result = RunTest( pState, &test );
+        }
+
+        if( result == EOK )
+        {
+            test.name = "search_regex";
+            test.n = pState->searches;
+            test.run = RunSearchRegex;
+            result = RunTest( pState, &test );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupRoundTrip                                                            */
+/*!
+    Set up a client for the round trip tests
+
+    The SetupRoundTrip function looks up the client's test variable
+    for the type being tested.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        hVarServer
+            handle to the client's variable server connection
+
+    @param[in]
+        client
+            index of the benchmark client
+
+    @param[in]
+        pSamples
+            unused
+
+    @param[in]
+        n
+            unused
+
+    @param[in]
+        pCount
+            unused
+
+    @retval EOK - the client was set up
+    @retval ENOENT - the test variable was not found
+
+==============================================================================*/
+static int SetupRoundTrip( BenchState *pState,
+                           VARSERVER_HANDLE hVarServer,
+                           int client,
+                           uint64_t *pSamples,
+                           size_t n,
+                           size_t *pCount )
+{
+    char name[MAX_NAME_LEN + 1];
+
+    (void)pSamples;
+    (void)n;
+    (void)pCount;
+
+    TestVarName( client, pState->type, name, sizeof( name ) );
+    pState->hTestVar = VAR_FindByName( hVarServer, name );
+
+    return ( pState->hTestVar == VAR_INVALID ) ? ENOENT : EOK;
+}
+
+/*============================================================================*/
+/*  RunSet                                                                    */
+/*!
+    Measure the VAR_Set latency
+
+    The RunSet function repeatedly sets the client's test variable to
+    a changing value and records the latency of each VAR_Set call.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        hVarServer
+            handle to the client's variable server connection
+
+    @param[in]
+        client
+            index of the benchmark client
+
+    @param[out]
+        pSamples
+            location to store the latency samples
+
+    @param[in]
+        n
+            number of samples to collect
+
+    @param[out]
+        pCount
+            location to store the number of samples collected
+
+    @retval EOK - the measurement completed
+    @retval ENOTSUP - unsupported variable type
+
+==============================================================================*/
+static int RunSet( BenchState *pState,
+                   VARSERVER_HANDLE hVarServer,
+                   int client,
+                   uint64_t *pSamples,
+                   size_t n,
+                   size_t *pCount )
+{
+    int result;
+    VarObject obj;
+    char buf[BENCH_BLOB_LEN];
+    uint64_t t0;
+    size_t i;
+
+    result = SetupObject( &obj, pState->type, buf );
+    for( i = 0; ( result == EOK ) && ( i < n ); i++ )
+    {
+        /* change the value so every set is a real update */
+        obj.val.ull = i;
+        if( pState->type == VARTYPE_FLOAT )
+        {
+            obj.val.f = (float)i;
+        }
+        else if( ( pState->type == VARTYPE_STR ) ||
+                 ( pState->type == VARTYPE_BLOB ) )
+        {
+            obj.val.str = buf;
+            buf[0] = 'a' + ( i % 26 );
+        }
+
+        t0 = Now();
+        if( VAR_Set( hVarServer, pState->hTestVar, &obj ) != EOK )
+        {
+            pState->pShared->errors[client]++;
+        }
+
+        pSamples[(*pCount)++] = Now() - t0;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunGet                                                                    */
+/*!
+    Measure the VAR_Get latency
+
+    The RunGet function repeatedly gets the client's test variable
+    and records the latency of each VAR_Get call.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        hVarServer
+            handle to the client's variable server connection
+
+    @param[in]
+        client
+            index of the benchmark client
+
+    @param[out]
+        pSamples
+            location to store the latency samples
+
+    @param[in]
+        n
+            number of samples to collect
+
+    @param[out]
+        pCount
+            location to store the number of samples collected
+
+    @retval EOK - the measurement completed
+    @retval ENOTSUP - unsupported variable type
+
+==============================================================================*/
+static int RunGet( BenchState *pState,
+                   VARSERVER_HANDLE hVarServer,
+                   int client,
+                   uint64_t *pSamples,
+                   size_t n,
+                   size_t *pCount )
+{
+    int result;
+    VarObject obj;
+    char buf[BENCH_BLOB_LEN];
+    uint64_t t0;
+    size_t i;
+
+    result = SetupObject( &obj, pState->type, buf );
+    for( i = 0; ( result == EOK ) && ( i < n ); i++ )
+    {
+        /* restore the buffer size which VAR_Get may have updated */
+        obj.len = ( pState->type == VARTYPE_STR ) ? BENCH_STR_LEN
+                : ( pState->type == VARTYPE_BLOB ) ? BENCH_BLOB_LEN
+                : obj.len;
+
+        t0 = Now();
+        if( VAR_Get( hVarServer, pState->hTestVar, &obj ) != EOK )
+        {
+            pState->pShared->errors[client]++;
+        }
+
+        pSamples[(*pCount)++] = Now() - t0;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupNotify                                                               */
+/*!
+    Set up a client for the modified signal fan-out test
+
+    The SetupNotify function blocks the variable server signals and
+    registers the client for modified signals from the fan-out test
+    variable.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        hVarServer
+            handle to the client's variable server connection
+
+    @param[in]
+        client
+            unused
+
+    @param[in]
+        pSamples
+            unused
+
+    @param[in]
+        n
+            unused
+
+    @param[in]
+        pCount
+            unused
+
+    @retval EOK - the client was set up
+    @retval ENOENT - the test variable was not found
+    @retval other - the notification could not be registered
+
+==============================================================================*/
+static int SetupNotify( BenchState *pState,
+                        VARSERVER_HANDLE hVarServer,
+                        int client,
+                        uint64_t *pSamples,
+                        size_t n,
+                        size_t *pCount )
+{
+    int result = ENOENT;
+
+    (void)client;
+    (void)pSamples;
+    (void)n;
+    (void)pCount;
+
+    /* block the notification signals before registering for them */
+    (void)VARSERVER_SigMask();
+
+    pState->hTestVar = VAR_FindByName( hVarServer, "/bench/notify/signal" );
+    if( pState->hTestVar != VAR_INVALID )
+    {
+        result = VAR_Notify( hVarServer, pState->hTestVar, NOTIFY_MODIFIED );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetupNotifyQueue                                                          */
+/*!
+    Set up a client for the notification queue fan-out test
+
+    The SetupNotifyQueue function creates the client notification queue
+    and registers the client for queued notifications from the fan-out
+    test variable.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        hVarServer
+            handle to the client's variable server connection
+
+    @param[in]
+        client
+            unused
+
+    @param[in]
+        pSamples
+            unused
+
+    @param[in]
+        n
+            unused
+
+    @param[in]
+        pCount
+            unused
+
+    @retval EOK - the client was set up
+    @retval ENOENT - the test variable was not found
+    @retval other - the notification could not be registered
+
+==============================================================================*/
+static int SetupNotifyQueue( BenchState *pState,
+                             VARSERVER_HANDLE hVarServer,
+                             int client,
+                             uint64_t *pSamples,
+                             size_t n,
+                             size_t *pCount )
+{
+    int result = ENOENT;
+
+    (void)client;
+    (void)pSamples;
+    (void)n;
+    (void)pCount;
+
+    /* block the notification signals before registering for them */
+    (void)VARSERVER_SigMask();
+
+    pState->hTestVar = VAR_FindByName( hVarServer, "/bench/notify/queue" );
+    if( pState->hTestVar != VAR_INVALID )
+    {
+        result = VARSERVER_CreateClientQueue( hVarServer,
+                                              10,
+                                              sizeof( VarNotification ) );
+    }
+
+    if( result == EOK )
+    {
+        result = VAR_Notify( hVarServer,
+                             pState->hTestVar,
+                             NOTIFY_MODIFIED_QUEUE );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunNotify                                                                 */
+/*!
+    Measure the notification fan-out latency
+
+    The RunNotify function waits for change notifications for the
+    fan-out test variable.  For each one received it records the time
+    since the driver called VAR_Set and acknowledges the change so the
+    driver can make the next one.  Queued notifications are timed when
+    they have been read using VAR_GetFromQueue.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        hVarServer
+            handle to the client's variable server connection
+
+    @param[in]
+        client
+            index of the benchmark client
+
+    @param[out]
+        pSamples
+            location to store the latency samples
+
+    @param[in]
+        n
+            number of samples to collect
+
+    @param[out]
+        pCount
+            location to store the number of samples collected
+
+    @retval EOK - the measurement completed
+
+==============================================================================*/
+static int RunNotify( BenchState *pState,
+                      VARSERVER_HANDLE hVarServer,
+                      int client,
+                      uint64_t *pSamples,
+                      size_t n,
+                      size_t *pCount )
+{
+    BenchShared *pShared = pState->pShared;
+    VarNotification notification;
+    struct timespec timeout;
+    siginfo_t info;
+    sigset_t mask;
+    char *buf = NULL;
+    size_t len = 0;
+    uint64_t t;
+    int sig;
+
+    mask = VARSERVER_SigMask();
+    VARSERVER_GetWorkingBuffer( hVarServer, &buf, &len );
+
+    timeout.tv_sec = BENCH_NOTIFY_TIMEOUT_MS / 1000;
+    timeout.tv_nsec = ( BENCH_NOTIFY_TIMEOUT_MS % 1000 ) * 1000000L;
+
+    while( *pCount < n )
+    {
+        sig = sigtimedwait( &mask, &info, &timeout );
+        if( sig == SIG_VAR_MODIFIED )
+        {
+            t = Now();
+            pSamples[(*pCount)++] =
+                t - __atomic_load_n( &pShared->setTime, __ATOMIC_SEQ_CST );
+            __atomic_add_fetch( &pShared->acks, 1, __ATOMIC_SEQ_CST );
+        }
+        else if( sig == SIG_VAR_QUEUE_MODIFIED )
+        {
+            memset( &notification, 0, sizeof( VarNotification ) );
+            while( ( *pCount < n ) &&
+                   ( VAR_GetFromQueue( hVarServer,
+                                       &notification,
+                                       buf,
+                                       len ) == EOK ) )
+            {
+                t = Now();
+                pSamples[(*pCount)++] =
+                    t - __atomic_load_n( &pShared->setTime,
+                                         __ATOMIC_SEQ_CST );
+                __atomic_add_fetch( &pShared->acks, 1, __ATOMIC_SEQ_CST );
+            }
+        }
+        else if( sig == -1 )
+        {
+            /* the driver has stopped or a notification was lost */
+            pShared->errors[client] += n - *pCount;
+            break;
+        }
+    }
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  DriveNotify                                                               */
+/*!
+    Drive the notification fan-out test
+
+    The DriveNotify function runs in the parent process.  It sets the
+    fan-out test variable n times, recording the time of each change,
+    and waits for every client to acknowledge each change before making
+    the next one.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        n
+            number of changes to make
+
+    @retval EOK - the changes were made
+    @retval ETIMEDOUT - the clients did not acknowledge a change in time
+    @retval other - the variable could not be set
+
+==============================================================================*/
+static int DriveNotify( BenchState *pState, size_t n )
+{
+    int result = EOK;
+    BenchShared *pShared = pState->pShared;
+    VarObject obj;
+    uint64_t deadline;
+    uint32_t acks;
+    size_t i;
+
+    memset( &obj, 0, sizeof( VarObject ) );
+    obj.type = VARTYPE_UINT32;
+    obj.len = sizeof( uint32_t );
+
+    for( i = 0; ( result == EOK ) && ( i < n ); i++ )
+    {
+        /* use a value which differs from any previous run */
+        obj.val.ul = (uint32_t)Now();
+
+        __atomic_store_n( &pShared->acks, 0, __ATOMIC_SEQ_CST );
+        __atomic_store_n( &pShared->setTime, Now(), __ATOMIC_SEQ_CST );
+
+        result = VAR_Set( pState->hVarServer, pState->hNotifyVar, &obj );
+
+        deadline = Now() + BENCH_NOTIFY_TIMEOUT_MS * 1000000ULL;
+        do
+        {
+            acks = __atomic_load_n( &pShared->acks, __ATOMIC_SEQ_CST );
+            if( acks >= (uint32_t)pState->clients )
+            {
+                break;
+            }
+
+            sched_yield();
+        } while( ( result == EOK ) && ( Now() < deadline ) );
+
+        if( ( result == EOK ) && ( acks < (uint32_t)pState->clients ) )
+        {
+            result = ETIMEDOUT;
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  RunFind                                                                   */
+/*!
+    Measure the VAR_FindByName latency
+
+    The RunFind function looks up pseudo-randomly chosen names from the
+    name set and records the latency of each VAR_FindByName call.
+    Each client visits the names in a different order.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        hVarServer
+            handle to the client's variable server connection
+
+    @param[in]
+        client
+            index of the benchmark client
+
+    @param[out]
+        pSamples
+            location to store the latency samples
+
+    @param[in]
+        n
+            number of samples to collect
+
+    @param[out]
+        pCount
+            location to store the number of samples collected
+
+    @retval EOK - the measurement completed
+
+==============================================================================*/
+static int RunFind( BenchState *pState,
+                    VARSERVER_HANDLE hVarServer,
+                    int client,
+                    uint64_t *pSamples,
+                    size_t n,
+                    size_t *pCount )
+{
+    char name[MAX_NAME_LEN + 1];
+    uint64_t t0;
+    size_t idx;
+    size_t i;
+
+    for( i = 0; i < n; i++ )
+    {
+        idx = ( i * 7919 + (size_t)client * 104729 ) % pState->population;
+        NameSetName( idx, name, sizeof( name ) );
+
+        t0 = Now();
+        if( VAR_FindByName( hVarServer, name ) == VAR_INVALID )
+        {
+            pState->pShared->errors[client]++;
+        }
+
+        pSamples[(*pCount)++] = Now() - t0;
+    }
+
+    return EOK;
+}
+
+/*============================================================================*/
+/*  RunSearchPrefix                                                           */
+/*!
+    Measure the latency of a prefix search
+
+    The RunSearchPrefix function repeatedly searches for the variables
+    in one group of the name set (one in BENCH_GROUPS of the name set).
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        hVarServer
+            handle to the client's variable server connection
+
+    @param[in]
+        client
+            index of the benchmark client
+
+    @param[out]
+        pSamples
+            location to store the latency samples
+
+    @param[in]
+        n
+            number of samples to collect
+
+    @param[out]
+        pCount
+            location to store the number of samples collected
+
+    @retval EOK - the measurement completed
+    @retval other - the output device could not be opened
+
+==============================================================================*/
+static int RunSearchPrefix( BenchState *pState,
+                            VARSERVER_HANDLE hVarServer,
+                            int client,
+                            uint64_t *pSamples,
+                            size_t n,
+                            size_t *pCount )
+{
+    return RunSearch( pState,
+                      hVarServer,
+                      client,
+                      QUERY_MATCH,
+                      "/bench/names/g7/",
+                      pSamples,
+                      n,
+                      pCount );
+}
+
+/*============================================================================*/
+/*  RunSearchRegex                                                            */
+/*!
+    Measure the latency of a regular expression search
+
+    The RunSearchRegex function repeatedly searches all the variables
+    using a regular expression which matches one in ten of the name set.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        hVarServer
+            handle to the client's variable server connection
+
+    @param[in]
+        client
+            index of the benchmark client
+
+    @param[out]
+        pSamples
+            location to store the latency samples
+
+    @param[in]
+        n
+            number of samples to collect
+
+    @param[out]
+        pCount
+            location to store the number of samples collected
+
+    @retval EOK - the measurement completed
+    @retval other - the output device could not be opened
+
+==============================================================================*/
+static int RunSearchRegex( BenchState *pState,
+                           VARSERVER_HANDLE hVarServer,
+                           int client,
+                           uint64_t *pSamples,
+                           size_t n,
+                           size_t *pCount )
+{
+    return RunSearch( pState,
+                      hVarServer,
+                      client,
+                      QUERY_REGEX,
+                      "^/bench/names/.*7$",
+                      pSamples,
+                      n,
+                      pCount );
+}
+
+/*============================================================================*/
+/*  RunSearch                                                                 */
+/*!
+    Measure the VARQUERY_Search latency
+
+    The RunSearch function repeatedly runs the specified search, writing
+    the search output to /dev/null, and records the latency of each
+    VARQUERY_Search call.
+
+    @param[in]
+        pState
+            pointer to the BenchState object
+
+    @param[in]
+        hVarServer
+            handle to the client's variable server connection
+
+    @param[in]
+        client
+            index of the benchmark client
+
+    @param[in]
+        searchType
+            type of search to perform
+
+    @param[in]
+        match
+            search match string
+
+    @param[out]
+        pSamples
+            location to store the latency samples
+
+    @param[in]
+        n
+            number of samples to collect
+
+    @param[out]
+        pCount
+            location to store the number of samples collected
+
+    @retval EOK - the measurement completed
+    @retval other - the output device could not be opened
+
+==============================================================================*/
+static int RunSearch( BenchState *pState,
+                      VARSERVER_HANDLE hVarServer,
+                      int client,
+                      int searchType,
+                      char *match,
+                      uint64_t *pSamples,
+                      size_t n,
+                      size_t *pCount )
+{
+    int result = EOK;
+    uint64_t t0;
+    size_t i;
+    int fd;
+
+    fd = open( "/dev/null", O_WRONLY );
+    if( fd == -1 )
+    {
+        result = errno;
+    }
+
+    for( i = 0; ( result == EOK ) && ( i < n ); i++ )
+    {
+        t0 = Now();
+        if( VARQUERY_Search( hVarServer,
+                             searchType,
+                             match,
+                             NULL,
+                             0,
+                             0,
+                             fd ) != EOK )
+        {
+            pState->pShared->errors[client]++;
+        }
+
+        pSamples[(*pCount)++] = Now() - t0;
+    }
+
+    if( fd != -1 )
+    {
+        close( fd );
+    }
+
+    return result;
+}
+
+/*! @}
+ * end of bench group */
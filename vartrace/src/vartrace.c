@@ -0,0 +1,584 @@
+/*==============================================================================
+MIT License
+
+Copyright (c) 2023 Trevor Monk
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+==============================================================================*/
+
+/*!
+ * @defgroup vartrace vartrace
+ * @brief Dump the variable server request trace ring
+ * @{
+ */
+
+/*============================================================================*/
+/*!
+@file vartrace.c
+
+    Dump the request trace ring
+
+    The vartrace Application reads the variable server's shared request
+    trace ring and prints its records.  It can dump the records currently
+    in the ring, or follow the ring and print new records as they are
+    written.  It can also switch tracing on and off via the
+    /varserver/trace/enable variable.
+
+*/
+/*============================================================================*/
+
+/*==============================================================================
+        Includes
+==============================================================================*/
+
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <getopt.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <sys/mman.h>
+#include <varserver/varserver.h>
+#include <varserver/varclient.h>
+
+/*==============================================================================
+        Private definitions
+==============================================================================*/
+
+/*! interval between trace ring polls when following the ring (us) */
+#define VARTRACE_POLL_INTERVAL_US ( 10000 )
+
+/*! vartrace state object used to customize the behavior of the application */
+typedef struct _var_trace_state
+{
+    /*! pointer to the read-only mapping of the trace ring */
+    TraceRing *pTraceRing;
+
+    /*! enable tracing */
+    bool enable;
+
+    /*! disable tracing */
+    bool disable;
+
+    /*! follow the trace ring */
+    bool follow;
+
+    /*! number of the most recent records to dump, 0 for all */
+    uint64_t count;
+
+} VarTraceState;
+
+/*==============================================================================
+        Private function declarations
+==============================================================================*/
+
+static int ProcessOptions( int argC,
+                           char *argV[],
+                           VarTraceState *pState );
+static void usage( char *name );
+static int SetTraceEnable( bool enable );
+static int OpenTraceRing( VarTraceState *pState );
+static bool ReadRecord( TraceRing *pTraceRing,
+                        uint64_t idx,
+                        TraceRecord *pRecord );
+static void PrintRecord( TraceRing *pTraceRing, TraceRecord *pRecord );
+static const char *SignalName( int sig );
+static uint64_t DumpRecords( VarTraceState *pState, uint64_t cursor );
+
+/*============================================================================*/
+/*  main                                                                      */
+/*!
+    Main entry point for the vartrace application
+
+    The main function starts the vartrace application
+
+    @param[in]
+        argc
+            number of arguments on the command line
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @return none
+
+==============================================================================*/
+int main(int argc, char **argv)
+{
+    VarTraceState state;
+    int result = EINVAL;
+    uint64_t cursor;
+    uint64_t head;
+
+    memset( &state, 0, sizeof(VarTraceState));
+
+    result = ProcessOptions( argc, argv, &state );
+    if ( ( result == EOK ) &&
+         ( ( state.enable == true ) || ( state.disable == true ) ) )
+    {
+        result = SetTraceEnable( state.enable );
+        if ( result != EOK )
+        {
+            fprintf( stderr, "VARTRACE: %s\n", strerror( result ) );
+        }
+    }
+
+    if ( ( result == EOK ) &&
+         ( ( state.enable == false && state.disable == false ) ||
+           ( state.follow == true ) ||
+           ( state.count != 0 ) ) )
+    {
+        result = OpenTraceRing( &state );
+        if ( result == EOK )
+        {
+            head = __atomic_load_n( &state.pTraceRing->head,
+                                    __ATOMIC_ACQUIRE );
+
+            /* start with the oldest record still in the ring,
+               or the most recent records if a count was given */
+            cursor = ( head > VARSERVER_TRACE_RING_SIZE )
+                     ? head - VARSERVER_TRACE_RING_SIZE
+                     : 0;
+            if ( ( state.count != 0 ) && ( head - cursor > state.count ) )
+            {
+                cursor = head - state.count;
+            }
+
+            cursor = DumpRecords( &state, cursor );
+
+            while ( state.follow == true )
+            {
+                usleep( VARTRACE_POLL_INTERVAL_US );
+                cursor = DumpRecords( &state, cursor );
+            }
+        }
+        else
+        {
+            fprintf( stderr,
+                     "VARTRACE: cannot open trace ring: %s\n",
+                     strerror( result ) );
+        }
+    }
+
+    return ( result == EOK ) ? 0 : 1;
+}
+
+/*============================================================================*/
+/*  usage                                                                     */
+/*!
+    Display the application usage
+
+    The usage function dumps the application usage message
+    to stderr.
+
+    @param[in]
+       name
+            pointer to the invoked application name
+
+==============================================================================*/
+static void usage( char *name )
+{
+    if( name != NULL )
+    {
+        fprintf( stderr,
+                 "usage: %s [-h] [-e] [-d] [-f] [-n count]\n"
+                 " [-h] : display this help\n"
+                 " [-e] : enable request tracing\n"
+                 " [-d] : disable request tracing\n"
+                 " [-f] : follow the trace ring and print new records\n"
+                 " [-n] : only dump the most recent count records\n",
+                 name );
+    }
+}
+
+/*============================================================================*/
+/*  ProcessOptions                                                            */
+/*!
+    Process the command line options
+
+    The ProcessOptions function processes the command line options and
+    populates the VarTraceState object
+
+    @param[in]
+        argC
+            number of arguments
+            (including the command itself)
+
+    @param[in]
+        argv
+            array of pointers to the command line arguments
+
+    @param[in]
+        pState
+            pointer to the vartrace state object
+
+    @return EOK if the options were processed
+    @return EINVAL if the options were invalid
+
+==============================================================================*/
+static int ProcessOptions( int argC,
+                           char *argV[],
+                           VarTraceState *pState )
+{
+    int c;
+    int result = EINVAL;
+    const char *options = "hedfn:";
+
+    if( ( pState != NULL ) &&
+        ( argV != NULL ) )
+    {
+        result = EOK;
+
+        while( ( c = getopt( argC, argV, options ) ) != -1 )
+        {
+            switch( c )
+            {
+                case 'e':
+                    pState->enable = true;
+                    break;
+
+                case 'd':
+                    pState->disable = true;
+                    break;
+
+                case 'f':
+                    pState->follow = true;
+                    break;
+
+                case 'n':
+                    pState->count = strtoull( optarg, NULL, 0 );
+                    break;
+
+                case 'h':
+                default:
+                    result = EINVAL;
+                    break;
+            }
+        }
+
+        if ( ( pState->enable == true ) && ( pState->disable == true ) )
+        {
+            result = EINVAL;
+        }
+
+        if ( result != EOK )
+        {
+            usage( argV[0] );
+        }
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  SetTraceEnable                                                            */
+/*!
+    Switch request tracing on or off
+
+    The SetTraceEnable function sets the variable server's trace
+    enable variable.
+
+    @param[in]
+        enable
+            true to enable tracing, false to disable it
+
+    @retval EOK the trace enable variable was set
+    @retval ENOTCONN the variable server is not available
+    @retval other error from VAR_SetNameValue
+
+==============================================================================*/
+static int SetTraceEnable( bool enable )
+{
+    int result = ENOTCONN;
+    VARSERVER_HANDLE hVarServer;
+
+    hVarServer = VARSERVER_Open();
+    if ( hVarServer != NULL )
+    {
+        result = VAR_SetNameValue( hVarServer,
+                                   SERVER_TRACE_ENABLE,
+                                   enable ? "1" : "0" );
+
+        VARSERVER_Close( hVarServer );
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  OpenTraceRing                                                             */
+/*!
+    Map the shared trace ring
+
+    The OpenTraceRing function maps the variable server's shared
+    trace ring read-only into the vartrace address space.
+
+    @param[in]
+        pState
+            pointer to the vartrace state object
+
+    @retval EOK the trace ring was mapped
+    @retval ENOMEM the trace ring could not be mapped
+    @retval other error from shm_open
+
+==============================================================================*/
+static int OpenTraceRing( VarTraceState *pState )
+{
+    int result = EINVAL;
+    int fd;
+    void *p;
+
+    fd = shm_open( SERVER_TRACERING, O_RDONLY, 0 );
+    if ( fd != -1 )
+    {
+        p = mmap( NULL, sizeof( TraceRing ), PROT_READ, MAP_SHARED, fd, 0 );
+        if ( p != MAP_FAILED )
+        {
+            pState->pTraceRing = (TraceRing *)p;
+            result = EOK;
+        }
+        else
+        {
+            result = ENOMEM;
+        }
+
+        close( fd );
+    }
+    else
+    {
+        result = errno;
+    }
+
+    return result;
+}
+
+/*============================================================================*/
+/*  DumpRecords                                                               */
+/*!
+    Print the trace records from the cursor to the head of the ring
+
+    The DumpRecords function prints the trace records which have been
+    written since the cursor.  If the server has overwritten records
+    which had not been read, the number of lost records is reported
+    and the dump continues from the oldest record still in the ring.
+
+    @param[in]
+        pState
+            pointer to the vartrace state object
+
+    @param[in]
+        cursor
+            index of the next record to print
+
+    @retval index of the next record to print
+
+==============================================================================*/
+static uint64_t DumpRecords( VarTraceState *pState, uint64_t cursor )
+{
+    TraceRing *pTraceRing = pState->pTraceRing;
+    TraceRecord record;
+    uint64_t head;
+
+    head = __atomic_load_n( &pTraceRing->head, __ATOMIC_ACQUIRE );
+    if ( head < cursor )
+    {
+        /* the server has been restarted */
+        cursor = 0;
+    }
+
+    if ( head - cursor > VARSERVER_TRACE_RING_SIZE )
+    {
+        fprintf( stderr,
+                 "-- %" PRIu64 " records lost --\n",
+                 head - cursor - VARSERVER_TRACE_RING_SIZE );
+        cursor = head - VARSERVER_TRACE_RING_SIZE;
+    }
+
+    while ( cursor < head )
+    {
+        if ( ReadRecord( pTraceRing, cursor, &record ) == true )
+        {
+            PrintRecord( pTraceRing, &record );
+        }
+
+        cursor++;
+    }
+
+    fflush( stdout );
+
+    return cursor;
+}
+
+/*============================================================================*/
+/*  ReadRecord                                                                */
+/*!
+    Read a trace record
+
+    The ReadRecord function copies a trace record out of the ring.  The
+    copy is discarded if the record does not hold the requested entry,
+    or if the server overwrote it while it was being copied.
+
+    @param[in]
+        pTraceRing
+            pointer to the trace ring
+
+    @param[in]
+        idx
+            free running index of the record to read
+
+    @param[out]
+        pRecord
+            location to store the record
+
+    @retval true the record was read
+    @retval false the record has been overwritten
+
+==============================================================================*/
+static bool ReadRecord( TraceRing *pTraceRing,
+                        uint64_t idx,
+                        TraceRecord *pRecord )
+{
+    TraceRecord *pSrc;
+    uint64_t seq;
+
+    pSrc = &pTraceRing->records[idx & ( VARSERVER_TRACE_RING_SIZE - 1 )];
+
+    seq = __atomic_load_n( &pSrc->seq, __ATOMIC_ACQUIRE );
+    memcpy( pRecord, pSrc, sizeof( TraceRecord ) );
+    __atomic_thread_fence( __ATOMIC_ACQUIRE );
+
+    return ( seq == idx + 1 ) &&
+           ( __atomic_load_n( &pSrc->seq, __ATOMIC_RELAXED ) == seq );
+}
+
+/*============================================================================*/
+/*  PrintRecord                                                               */
+/*!
+    Print a trace record
+
+    The PrintRecord function prints a single trace record on one line:
+
+    timestamp event type client handle result duration
+
+    The timestamp is the CLOCK_MONOTONIC time in seconds, and the
+    duration is in microseconds.
+
+    @param[in]
+        pTraceRing
+            pointer to the trace ring holding the request names
+
+    @param[in]
+        pRecord
+            pointer to the record to print
+
+==============================================================================*/
+static void PrintRecord( TraceRing *pTraceRing, TraceRecord *pRecord )
+{
+    const char *event = "?";
+    const char *type = "?";
+    char name[VARSERVER_TRACE_NAME_LEN];
+
+    switch ( pRecord->event )
+    {
+        case TRACE_EVENT_REQUEST:
+            event = "REQ";
+            if ( pRecord->type < VARSERVER_TRACE_MAX_REQUESTS )
+            {
+                memcpy( name,
+                        pTraceRing->requestNames[pRecord->type],
+                        sizeof( name ) );
+                name[sizeof( name ) - 1] = '\0';
+                type = name;
+            }
+            break;
+
+        case TRACE_EVENT_SIGNAL:
+            event = "SIG";
+            type = SignalName( pRecord->type );
+            break;
+
+        case TRACE_EVENT_QUEUE:
+            event = "QUE";
+            type = "MODIFIED_QUEUE";
+            break;
+
+        default:
+            break;
+    }
+
+    printf( "%" PRIu64 ".%06" PRIu64 " %s %-24s client=%-5" PRId32
+            " hVar=%-6" PRIu32 " result=%-4" PRId32 " %" PRIu32 ".%03"
+            PRIu32 "us\n",
+            pRecord->timestamp / UINT64_C( 1000000000 ),
+            ( pRecord->timestamp / 1000 ) % 1000000,
+            event,
+            type,
+            pRecord->clientid,
+            (uint32_t)pRecord->hVar,
+            pRecord->result,
+            pRecord->duration / 1000,
+            pRecord->duration % 1000 );
+}
+
+/*============================================================================*/
+/*  SignalName                                                                */
+/*!
+    Get the name of a variable server notification signal
+
+    @param[in]
+        sig
+            signal number
+
+    @retval name of the signal
+
+==============================================================================*/
+static const char *SignalName( int sig )
+{
+    const char *name = "UNKNOWN";
+
+    if ( sig == SIG_VAR_MODIFIED )
+    {
+        name = "MODIFIED";
+    }
+    else if ( sig == SIG_VAR_CALC )
+    {
+        name = "CALC";
+    }
+    else if ( sig == SIG_VAR_VALIDATE )
+    {
+        name = "VALIDATE";
+    }
+    else if ( sig == SIG_VAR_PRINT )
+    {
+        name = "PRINT";
+    }
+    else if ( sig == SIG_VAR_QUEUE_MODIFIED )
+    {
+        name = "QUEUE_MODIFIED";
+    }
+
+    return name;
+}
+
+/*! @}
+ * end of vartrace group */